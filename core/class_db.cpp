@@ -371,6 +371,20 @@ Object *ClassDB::instance(const StringName &p_class) {
     return ti->creation_func();
 }
 
+Object *(*ClassDB::get_creation_func(const StringName &p_class))() {
+
+    RWLockRead _rw_lockr_(lock);
+
+    auto iter = classes.find(p_class);
+    if (iter == classes.end() || iter->second.disabled)
+        return nullptr;
+#ifdef TOOLS_ENABLED
+    if (iter->second.api == API_EDITOR && !Engine::get_singleton()->is_editor_hint())
+        return nullptr;
+#endif
+    return iter->second.creation_func;
+}
+
 bool ClassDB::can_instance(const StringName &p_class) {
 
     RWLockRead _rw_lockr_(lock);
@@ -873,44 +887,62 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
     while (check) {
         auto iter = check->property_setget.find(p_property);
         if (iter!=check->property_setget.end()) {
-            const PropertySetGet &psg(iter->second);
-            if (!psg.setter) {
-                if (r_valid)
-                    *r_valid = false;
-                return true; // return true but do nothing
-            }
+            set_property_direct(p_object, iter->second, p_value, r_valid);
+            return true;
+        }
 
-            Callable::CallError ce;
+        check = check->inherits_ptr;
+    }
 
-            if (psg.index >= 0) {
-                Variant index = psg.index;
-                const Variant *arg[2] = { &index, &p_value };
-                // p_object->call(psg.setter,arg,2,ce);
-                if (psg._setptr) {
-                    psg._setptr->call(p_object, arg, 2, ce);
-                } else {
-                    p_object->call(psg.setter, arg, 2, ce);
-                }
+    return false;
+}
 
-            } else {
-                const Variant *arg[1] = { &p_value };
-                if (psg._setptr) {
-                    psg._setptr->call(p_object, arg, 1, ce);
-                } else {
-                    p_object->call(psg.setter, arg, 1, ce);
-                }
-            }
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
 
-            if (r_valid)
-                *r_valid = ce.error == Callable::CallError::CALL_OK;
+    auto iter = classes.find(p_class);
+    ClassInfo *check = iter != classes.end() ? &iter->second : nullptr;
+    while (check) {
+        auto iter2 = check->property_setget.find(p_property);
+        if (iter2 != check->property_setget.end())
+            return &iter2->second;
 
-            return true;
+        check = check->inherits_ptr;
+    }
+    return nullptr;
+}
+
+void ClassDB::set_property_direct(Object *p_object, const PropertySetGet &p_setget, const Variant &p_value, bool *r_valid) {
+
+    const PropertySetGet &psg(p_setget);
+    if (!psg.setter) {
+        if (r_valid)
+            *r_valid = false;
+        return; // do nothing
+    }
+
+    Callable::CallError ce;
+
+    if (psg.index >= 0) {
+        Variant index = psg.index;
+        const Variant *arg[2] = { &index, &p_value };
+        // p_object->call(psg.setter,arg,2,ce);
+        if (psg._setptr) {
+            psg._setptr->call(p_object, arg, 2, ce);
+        } else {
+            p_object->call(psg.setter, arg, 2, ce);
         }
 
-        check = check->inherits_ptr;
+    } else {
+        const Variant *arg[1] = { &p_value };
+        if (psg._setptr) {
+            psg._setptr->call(p_object, arg, 1, ce);
+        } else {
+            p_object->call(psg.setter, arg, 1, ce);
+        }
     }
 
-    return false;
+    if (r_valid)
+        *r_valid = ce.error == Callable::CallError::CALL_OK;
 }
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
 
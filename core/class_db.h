@@ -271,6 +271,9 @@ public:
     static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
     static bool can_instance(const StringName &p_class);
     static Object *instance(const StringName &p_class);
+    //! Function instance() calls to create p_class, nullptr if p_class is not a registered class that can be instanced.
+    //! Compatibility class names are not resolved.
+    static Object *(*get_creation_func(const StringName &p_class))();
     static APIType get_api_type(const StringName &p_class);
 
     static uint64_t get_api_hash(APIType p_api);
@@ -286,6 +289,10 @@ public:
     static void set_property_default_value(StringName p_class, const StringName &p_name, const Variant &p_default);
     static void get_property_list(StringName p_class, Vector<PropertyInfo> *p_list, bool p_no_inheritance = false, const Object *p_validator = nullptr);
     static bool set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid = nullptr);
+    //! Setter registration of p_property in p_class or its ancestors, nullptr if there is none. Lets callers that set
+    //! the same property many times resolve it once and use set_property_direct.
+    static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
+    static void set_property_direct(Object *p_object, const PropertySetGet &p_setget, const Variant &p_value, bool *r_valid = nullptr);
     static bool get_property(Object *p_object, const StringName &p_property, Variant &r_value);
     static bool has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance = false);
     static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
@@ -36,6 +36,7 @@
 #include "core/typedefs.h"
 #include "core/error_macros.h"
 
+#include "EASTL/deque.h"
 #include "EASTL/functional.h"
 
 class GODOT_EXPORT CommandQueueMT {
@@ -49,6 +50,7 @@ class GODOT_EXPORT CommandQueueMT {
     struct CommandBase {
         eastl::function<void()> callable;
         SyncSemaphore *sync_sem = nullptr;
+        bool done = false;
         void call() {
             callable();
         }
@@ -59,122 +61,49 @@ class GODOT_EXPORT CommandQueueMT {
     };
 
     enum {
-        COMMAND_MEM_SIZE_KB = 256,
-        COMMAND_MEM_SIZE = COMMAND_MEM_SIZE_KB * 1024,
+        // commands are stored in blocks of this many entries, the queue grows a block at a time instead of
+        // making the producer wait for the consumer when it's full
+        COMMAND_BLOCK_SIZE = 256,
         SYNC_SEMAPHORES = 8
     };
 
-    uint8_t *command_mem = (uint8_t*)memalloc(COMMAND_MEM_SIZE);
-    uint32_t read_ptr = 0;
-    uint32_t write_ptr = 0;
-    uint32_t dealloc_ptr = 0;
+    // growing or shrinking a deque at its ends keeps references to the other elements valid, so a command can
+    // be executed outside of the lock while more are pushed
+    eastl::deque<CommandBase, wrap_allocator, COMMAND_BLOCK_SIZE> commands;
+    // index of the first command not yet taken for execution, the ones before it are running or done
+    uint32_t read_idx = 0;
     SyncSemaphore sync_sems[SYNC_SEMAPHORES];
     Mutex mutex;
     Semaphore *sync = nullptr;
 
-    CommandBase *allocate() {
-
-        // alloc size is size+T+safeguard
-        uint32_t alloc_size = ((sizeof(CommandBase) + 8 - 1) & ~(8 - 1)) + 8;
-
-    tryagain:
-
-        if (write_ptr < dealloc_ptr) {
-            // behind dealloc_ptr, check that there is room
-            if ((dealloc_ptr - write_ptr) <= alloc_size) {
-
-                // There is no more room, try to deallocate something
-                if (dealloc_one()) {
-                    goto tryagain;
-                }
-                return nullptr;
-            }
-        } else {
-            // ahead of dealloc_ptr, check that there is room
-
-            if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
-                // no room at the end, wrap down;
-
-                if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
-
-                    // There is no more room, try to deallocate something
-                    if (dealloc_one()) {
-                        goto tryagain;
-                    }
-                    return nullptr;
-                }
-
-                // if this happens, it's a bug
-                ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < 8, nullptr);
-                // zero means, wrap to beginning
-
-                uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-                *p = 0;
-                write_ptr = 0;
-                goto tryagain;
-            }
-        }
-        // Allocate the size and the 'in use' bit.
-        // First bit used to mark if command is still in use (1)
-        // or if it has been destroyed and can be deallocated (0).
-        uint32_t size = (sizeof(CommandBase) + 8 - 1) & ~(8 - 1);
-        uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-        *p = (size << 1) | 1;
-        write_ptr += 8;
-        // allocate the command
-        CommandBase *cmd = memnew_placement(&command_mem[write_ptr], CommandBase);
-        write_ptr += size;
-        return cmd;
-    }
-
-    CommandBase *allocate_and_lock() {
-
-        lock();
-        CommandBase *ret;
-
-        while ((ret = allocate()) == nullptr) {
-
-            unlock();
-            // sleep a little until fetch happened and some room is made
-            wait_for_flush();
-            lock();
-        }
-
-        return ret;
+    CommandBase &allocate() {
+        commands.emplace_back();
+        return commands.back();
     }
 
     bool flush_one(bool p_lock = true) {
         if (p_lock) lock();
-    tryagain:
 
         // tried to read an empty queue
-        if (read_ptr == write_ptr) {
+        if (read_idx == commands.size()) {
             if (p_lock) unlock();
             return false;
         }
 
-        uint32_t size_ptr = read_ptr;
-        uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
-
-        if (size == 0) {
-            //end of ringbuffer, wrap
-            read_ptr = 0;
-            goto tryagain;
-        }
-
-        read_ptr += 8;
-
-        CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
-
-        read_ptr += size;
+        CommandBase &cmd = commands[read_idx++];
 
         if (p_lock) unlock();
-        cmd->call();
+        cmd.call();
         if (p_lock) lock();
 
-        cmd->post();
-        cmd->~CommandBase();
-        *(uint32_t *)&command_mem[size_ptr] &= ~1;
+        cmd.post();
+        cmd.callable = nullptr;
+        cmd.done = true;
+        // commands can finish out of order when several threads flush, only finished ones are released
+        while (read_idx != 0 && commands.front().done) {
+            commands.pop_front();
+            read_idx--;
+        }
 
         if (p_lock) unlock();
         return true;
@@ -184,13 +113,12 @@ class GODOT_EXPORT CommandQueueMT {
     void unlock();
     void wait_for_flush();
     SyncSemaphore *_alloc_sync_sem();
-    bool dealloc_one();
 
 public:
 
     void push(eastl::function<void()> func) {
-        auto cmd = allocate_and_lock();
-        cmd->callable = eastl::move(func);
+        lock();
+        allocate().callable = eastl::move(func);
         unlock();
         if (sync)
             sync->post();
@@ -198,9 +126,10 @@ public:
 
     void push_and_sync(eastl::function<void()> func) {
         SyncSemaphore *ss = _alloc_sync_sem();
-        auto cmd = allocate_and_lock();
-        cmd->callable = eastl::move(func);
-        cmd->sync_sem = ss;
+        lock();
+        CommandBase &cmd = allocate();
+        cmd.callable = eastl::move(func);
+        cmd.sync_sem = ss;
         unlock();
         if (sync)
             sync->post();
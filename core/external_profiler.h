@@ -1,13 +1,26 @@
 #define RMT_USE_OPENGL 1
 
+#include "core/frame_profiler.h"
+
+// The built-in FrameProfiler zones are always available, Tracy zones are added to them when it is compiled in.
+#define FRAME_PROFILER_CONCAT_IMPL(a, b) a##b
+#define FRAME_PROFILER_CONCAT(a, b) FRAME_PROFILER_CONCAT_IMPL(a, b)
+#define FRAME_PROFILER_ZONE(name_str) FrameProfilerZone FRAME_PROFILER_CONCAT(_frame_profiler_zone_, __LINE__)(name_str);
+#define FRAME_PROFILER_PLOT(name, value)                        \
+    do {                                                        \
+        if (FrameProfiler::is_capturing())                      \
+            FrameProfiler::record_counter(name, double(value)); \
+    } while (false)
+
 #ifdef TRACY_ENABLE
 #include "thirdparty/tracy/Tracy.hpp"
 
-#define SCOPE_PROFILE(name) ZoneScopedN(#name)
+#define SCOPE_PROFILE(name) ZoneScopedN(#name) FRAME_PROFILER_ZONE(#name)
 #define SCOPE_PROFILE_GPU(name) ZoneScoped
-#define SCOPE_AUTONAMED ZoneScoped
+#define SCOPE_AUTONAMED ZoneScoped FRAME_PROFILER_ZONE(__FUNCTION__)
 #define PROFILER_STARTFRAME(name) FrameMarkStart(name)
 #define PROFILER_ENDFRAME(name) FrameMarkEnd(name)
+#define PROFILER_PLOT(name,value) TracyPlot(name,value); FRAME_PROFILER_PLOT(name, value)
 //#define TRACE_MEMORY
 #ifdef TRACE_MEMORY
 #define TRACE_ALLOC(p,sz) TracyAlloc(p,sz)
@@ -17,12 +30,13 @@
 #define TRACE_FREE(p)
 #endif
 #else
-#define SCOPE_PROFILE(name)
+#define SCOPE_PROFILE(name) FRAME_PROFILER_ZONE(#name)
 #define SCOPE_PROFILE_GPU(name)
-#define SCOPE_AUTONAMED
+#define SCOPE_AUTONAMED FRAME_PROFILER_ZONE(__FUNCTION__)
 #define PROFILER_FLIP()
 #define PROFILER_STARTFRAME(name)
 #define PROFILER_ENDFRAME(name)
+#define PROFILER_PLOT(name,value) FRAME_PROFILER_PLOT(name, value)
 #define TRACE_ALLOC(p,sz)
 #define TRACE_FREE(p)
 
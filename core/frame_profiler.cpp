@@ -0,0 +1,325 @@
+/*************************************************************************/
+/*  frame_profiler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "frame_profiler.h"
+
+#include "core/hash_map.h"
+#include "core/os/file_access.h"
+#include "core/os/memory.h"
+#include "core/os/mutex.h"
+#include "core/print_string.h"
+#include "core/string.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "core/vector.h"
+
+#include <chrono>
+
+std::atomic<bool> FrameProfiler::capturing { false };
+
+namespace {
+
+enum : uint32_t {
+    RING_SIZE = 1 << 14, // events a thread can record between two collections, power of two
+    RING_MASK = RING_SIZE - 1,
+};
+
+struct Event {
+    const char *name;
+    uint64_t begin;
+    union {
+        uint64_t end; // zones
+        double value; // counters
+    };
+    bool is_counter;
+};
+
+struct CapturedEvent {
+    Event event;
+    uint32_t tid;
+};
+
+// Single producer, single consumer: only the owning thread writes events, only the collector reads them.
+struct ThreadRing {
+    Event events[RING_SIZE];
+    std::atomic<uint32_t> write_pos { 0 };
+    std::atomic<uint32_t> read_pos { 0 };
+    std::atomic<bool> retired { false }; // the owning thread exited, freed by the collector once drained
+    uint32_t tid = 0;
+};
+
+struct ProfilerState {
+    Mutex mutex; // guards everything below
+    Vector<ThreadRing *> rings;
+    HashMap<uint32_t, String> thread_names;
+    Vector<CapturedEvent> captured;
+    String path;
+    uint64_t epoch = 0;
+    uint64_t frame_begin = 0;
+    int frames_left = 0;
+    uint32_t next_tid = 1;
+    std::atomic<uint64_t> dropped { 0 };
+};
+
+ProfilerState &_state() {
+    static ProfilerState state;
+    return state;
+}
+
+struct ThreadSlot {
+    ThreadRing *ring = nullptr;
+    ~ThreadSlot() {
+        if (ring)
+            ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+thread_local String t_thread_name;
+
+ThreadRing *_get_ring() {
+
+    if (likely(t_slot.ring))
+        return t_slot.ring;
+
+    ThreadRing *ring = memnew(ThreadRing);
+    ProfilerState &state = _state();
+    MutexLock lock(state.mutex);
+    ring->tid = state.next_tid++;
+    state.thread_names[ring->tid] = t_thread_name.empty() ? "Thread " + itos(ring->tid) : t_thread_name;
+    state.rings.push_back(ring);
+    t_slot.ring = ring;
+    return ring;
+}
+
+void _push(const Event &p_event) {
+
+    ThreadRing *ring = _get_ring();
+    uint32_t write_pos = ring->write_pos.load(std::memory_order_relaxed);
+    if (write_pos - ring->read_pos.load(std::memory_order_acquire) >= RING_SIZE) {
+        _state().dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring->events[write_pos & RING_MASK] = p_event;
+    ring->write_pos.store(write_pos + 1, std::memory_order_release);
+}
+
+// Moves the recorded events of all threads into state.captured, the mutex has to be held.
+void _collect(ProfilerState &state) {
+
+    for (size_t i = 0; i < state.rings.size();) {
+        ThreadRing *ring = state.rings[i];
+        const bool retired = ring->retired.load(std::memory_order_acquire);
+        const uint32_t write_pos = ring->write_pos.load(std::memory_order_acquire);
+        uint32_t read_pos = ring->read_pos.load(std::memory_order_relaxed);
+        for (; read_pos != write_pos; read_pos++) {
+            state.captured.push_back(CapturedEvent { ring->events[read_pos & RING_MASK], ring->tid });
+        }
+        ring->read_pos.store(read_pos, std::memory_order_release);
+
+        if (retired) {
+            memdelete(ring);
+            state.rings.erase_unsorted(state.rings.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void _append_json_string(String &r_out, StringView p_str) {
+
+    r_out.push_back('"');
+    for (char c : p_str) {
+        if (c == '"' || c == '\\') {
+            r_out.push_back('\\');
+            r_out.push_back(c);
+        } else if (uint8_t(c) < 32) {
+            r_out.append_sprintf("\\u%04x", c);
+        } else {
+            r_out.push_back(c);
+        }
+    }
+    r_out.push_back('"');
+}
+
+// Writes state.captured as a Chrome trace, times are microseconds from the start of the capture.
+void _write_trace(ProfilerState &state) {
+
+    Error err;
+    FileAccess *f = FileAccess::open(state.path, FileAccess::WRITE, &err);
+    ERR_FAIL_COND_MSG(!f, "Cannot write frame profiler capture to '" + state.path + "'.");
+
+    String out;
+    out.reserve(1 << 16);
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separate = [&]() {
+        if (!first)
+            out += ",\n";
+        first = false;
+    };
+
+    for (const auto &E : state.thread_names) {
+        separate();
+        out.append_sprintf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", E.first);
+        _append_json_string(out, E.second);
+        out += "}}";
+    }
+
+    size_t written = 0;
+    for (const CapturedEvent &captured : state.captured) {
+        const Event &e = captured.event;
+        if (e.begin < state.epoch)
+            continue; // recorded before the capture started
+        separate();
+        out += "{\"name\":";
+        _append_json_string(out, e.name);
+        const double ts = double(e.begin - state.epoch) / 1000.0;
+        if (e.is_counter) {
+            out.append_sprintf(",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}", captured.tid, ts, e.value);
+        } else {
+            const double dur = double(e.end - e.begin) / 1000.0;
+            out.append_sprintf(",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", captured.tid, ts, dur);
+        }
+        written++;
+
+        if (out.size() >= (1 << 16)) {
+            f->store_string(out);
+            out.clear();
+        }
+    }
+    out += "\n]}\n";
+    f->store_string(out);
+    memdelete(f);
+
+    print_line(FormatVE("Frame profiler: wrote %zu events to '%s'.", written, state.path.c_str()));
+    const uint64_t dropped = state.dropped.load(std::memory_order_relaxed);
+    if (dropped) {
+        WARN_PRINT(FormatVE("Frame profiler: %llu events were dropped, threads recorded more than %u events in a frame.", (unsigned long long)dropped, RING_SIZE));
+    }
+}
+
+void _finish_capture(ProfilerState &state) {
+
+    FrameProfiler::record_zone("Frame", state.frame_begin, FrameProfiler::get_ticks_nsec());
+    _collect(state);
+    _write_trace(state);
+    state.captured.clear();
+    state.captured.shrink_to_fit();
+}
+
+} // namespace
+
+uint64_t FrameProfiler::get_ticks_nsec() {
+
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) + 1;
+}
+
+void FrameProfiler::record_zone(const char *p_name, uint64_t p_begin_nsec, uint64_t p_end_nsec) {
+
+    if (!is_capturing())
+        return;
+    Event e;
+    e.name = p_name;
+    e.begin = p_begin_nsec;
+    e.end = p_end_nsec;
+    e.is_counter = false;
+    _push(e);
+}
+
+void FrameProfiler::record_counter(const char *p_name, double p_value) {
+
+    if (!is_capturing())
+        return;
+    Event e;
+    e.name = p_name;
+    e.begin = get_ticks_nsec();
+    e.value = p_value;
+    e.is_counter = true;
+    _push(e);
+}
+
+void FrameProfiler::set_thread_name(StringView p_name) {
+
+    t_thread_name = p_name;
+    if (t_slot.ring) {
+        ProfilerState &state = _state();
+        MutexLock lock(state.mutex);
+        state.thread_names[t_slot.ring->tid] = t_thread_name;
+    }
+}
+
+Error FrameProfiler::start_capture(int p_frames, StringView p_path) {
+
+    ERR_FAIL_COND_V(p_frames <= 0, ERR_INVALID_PARAMETER);
+    ERR_FAIL_COND_V(p_path.empty(), ERR_INVALID_PARAMETER);
+
+    ProfilerState &state = _state();
+    MutexLock lock(state.mutex);
+    ERR_FAIL_COND_V_MSG(is_capturing(), ERR_BUSY, "A frame profiler capture is already running.");
+
+    _collect(state); // leftovers from an earlier capture
+    state.captured.clear();
+    state.path = p_path;
+    state.frames_left = p_frames;
+    state.dropped.store(0, std::memory_order_relaxed);
+    state.epoch = state.frame_begin = get_ticks_nsec();
+    capturing.store(true, std::memory_order_relaxed);
+    return OK;
+}
+
+void FrameProfiler::stop_capture() {
+
+    ProfilerState &state = _state();
+    MutexLock lock(state.mutex);
+    if (!is_capturing())
+        return;
+    _finish_capture(state);
+    capturing.store(false, std::memory_order_relaxed);
+}
+
+void FrameProfiler::frame_mark() {
+
+    if (!is_capturing())
+        return;
+
+    ProfilerState &state = _state();
+    MutexLock lock(state.mutex);
+    if (--state.frames_left > 0) {
+        const uint64_t now = get_ticks_nsec();
+        record_zone("Frame", state.frame_begin, now);
+        state.frame_begin = now;
+        _collect(state);
+        return;
+    }
+    _finish_capture(state);
+    capturing.store(false, std::memory_order_relaxed);
+}
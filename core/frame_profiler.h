@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  frame_profiler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/error_list.h"
+#include "core/forward_decls.h"
+#include "core/typedefs.h"
+
+#include <atomic>
+
+/**
+ * Frame profiler that is always compiled in, also in release and server builds.
+ *
+ * While a capture is running every thread records finished zones and counter values into its own ring buffer
+ * without taking locks; the main thread collects them once per frame and, after the requested number of frames,
+ * writes the capture as a Chrome trace that chrome://tracing and ui.perfetto.dev can open.
+ * Outside of a capture a zone costs a relaxed atomic load.
+ *
+ * Zone and counter names are not copied, they have to stay valid for the lifetime of the process (string literals,
+ * __FUNCTION__). Use the SCOPE_PROFILE, SCOPE_AUTONAMED and PROFILER_PLOT macros from core/external_profiler.h
+ * instead of calling this directly.
+ */
+class GODOT_EXPORT FrameProfiler {
+    static std::atomic<bool> capturing;
+
+public:
+    _FORCE_INLINE_ static bool is_capturing() { return capturing.load(std::memory_order_relaxed); }
+    //! Monotonic time in nanoseconds, never 0.
+    static uint64_t get_ticks_nsec();
+
+    static void record_zone(const char *p_name, uint64_t p_begin_nsec, uint64_t p_end_nsec);
+    static void record_counter(const char *p_name, double p_value);
+    //! Name shown for the calling thread in captures, Thread::set_name forwards here.
+    static void set_thread_name(StringView p_name);
+
+    //! Starts recording, the trace is written to p_path once p_frames frames have ended.
+    static Error start_capture(int p_frames, StringView p_path);
+    //! Ends the capture early and writes what was recorded so far.
+    static void stop_capture();
+    //! Called by the main loop at the end of every frame.
+    static void frame_mark();
+};
+
+class FrameProfilerZone {
+    const char *name;
+    uint64_t begin;
+
+public:
+    explicit FrameProfilerZone(const char *p_name) :
+            name(p_name),
+            begin(FrameProfiler::is_capturing() ? FrameProfiler::get_ticks_nsec() : 0) {}
+    ~FrameProfilerZone() {
+        if (begin)
+            FrameProfiler::record_zone(name, begin, FrameProfiler::get_ticks_nsec());
+    }
+
+    FrameProfilerZone(const FrameProfilerZone &) = delete;
+    FrameProfilerZone &operator=(const FrameProfilerZone &) = delete;
+};
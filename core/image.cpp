@@ -36,6 +36,7 @@
 #include "core/io/resource_loader.h"
 #include "core/math/math_funcs.h"
 #include "core/method_bind.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/plugin_interfaces/ImageLoaderInterface.h"
 #include "core/plugin_interfaces/PluginDeclarations.h"
 #include "core/print_string.h"
@@ -716,6 +717,30 @@ Image::Format Image::get_format() const {
     return format;
 }
 
+enum {
+    // resampling jobs writing less than this stay on the calling thread
+    IMAGE_PARALLEL_MIN_BYTES = 256 * 1024
+};
+
+// Calls p_func(from, to) for bands of consecutive rows covering [0, p_rows). When the job writes at least
+// IMAGE_PARALLEL_MIN_BYTES the bands are spread over the worker threads, every band owns its destination rows.
+template <class F>
+static void _process_row_bands(uint32_t p_rows, uint64_t p_bytes, const F &p_func) {
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    uint32_t bands = 1;
+    if (p_bytes >= IMAGE_PARALLEL_MIN_BYTES) {
+        bands = MIN(p_rows, uint32_t(pool->get_thread_count() + 1) * 4);
+    }
+    if (bands <= 1) {
+        p_func(0, p_rows);
+        return;
+    }
+    pool->parallel_for(bands, [&](uint32_t p_band) {
+        p_func(uint32_t(uint64_t(p_rows) * p_band / bands), uint32_t(uint64_t(p_rows) * (p_band + 1) / bands));
+    });
+}
+
 static double _bicubic_interp_kernel(double x) {
 
     x = ABS(x);
@@ -730,88 +755,77 @@ static double _bicubic_interp_kernel(double x) {
     return bc;
 }
 
+struct CubicTaps {
+    int ofs[4];
+    double weight[4];
+};
+
+// The cubic kernel only depends on the destination column (or row), so it's evaluated once per column.
+static void _make_cubic_taps(uint32_t p_dst_size, uint32_t p_src_size, Vector<CubicTaps> &r_taps) {
+
+    double fac = (double)p_src_size / p_dst_size;
+    int max = p_src_size - 1;
+    r_taps.resize(p_dst_size);
+    for (uint32_t i = 0; i < p_dst_size; i++) {
+        double o = (double)i * fac - 0.5f;
+        int o1 = (int)o;
+        double d = o - (double)o1;
+        for (int n = -1; n < 3; n++) {
+            r_taps[i].ofs[n + 1] = CLAMP(o1 + n, 0, max);
+            r_taps[i].weight[n + 1] = _bicubic_interp_kernel(d - (double)n);
+        }
+    }
+}
+
 template <int CC, class T>
 static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
 
-    // get source image size
-    int width = p_src_width;
-    int height = p_src_height;
-    double xfac = (double)width / p_dst_width;
-    double yfac = (double)height / p_dst_height;
-    // coordinates of source points and coefficients
-    double ox, oy, dx, dy, k1, k2;
-    int ox1, oy1, ox2, oy2;
-    // destination pixel values
-    // width and height decreased by 1
-    int ymax = height - 1;
-    int xmax = width - 1;
-    // temporary pointer
-
-    for (uint32_t y = 0; y < p_dst_height; y++) {
-        // Y coordinates
-        oy = (double)y * yfac - 0.5f;
-        oy1 = (int)oy;
-        dy = oy - (double)oy1;
-
-        for (uint32_t x = 0; x < p_dst_width; x++) {
-            // X coordinates
-            ox = (double)x * xfac - 0.5f;
-            ox1 = (int)ox;
-            dx = ox - (double)ox1;
-
-            // initial pixel value
-
-            T *__restrict dst = ((T *)p_dst) + (y * p_dst_width + x) * CC;
-
-            double color[CC];
-            for (int i = 0; i < CC; i++) {
-                color[i] = 0;
-            }
+    Vector<CubicTaps> x_taps;
+    Vector<CubicTaps> y_taps;
+    _make_cubic_taps(p_dst_width, p_src_width, x_taps);
+    _make_cubic_taps(p_dst_height, p_src_height, y_taps);
 
-            for (int n = -1; n < 3; n++) {
-                // get Y coefficient
-                k1 = _bicubic_interp_kernel(dy - (double)n);
+    const T *__restrict src = (const T *)p_src;
 
-                oy2 = oy1 + n;
-                if (oy2 < 0)
-                    oy2 = 0;
-                if (oy2 > ymax)
-                    oy2 = ymax;
+    _process_row_bands(p_dst_height, uint64_t(p_dst_width) * p_dst_height * CC * sizeof(T), [&](uint32_t p_from, uint32_t p_to) {
+        for (uint32_t y = p_from; y < p_to; y++) {
 
-                for (int m = -1; m < 3; m++) {
-                    // get X coefficient
-                    k2 = k1 * _bicubic_interp_kernel((double)m - dx);
+            const CubicTaps &ty = y_taps[y];
+            T *__restrict dst = ((T *)p_dst) + y * p_dst_width * CC;
 
-                    ox2 = ox1 + m;
-                    if (ox2 < 0)
-                        ox2 = 0;
-                    if (ox2 > xmax)
-                        ox2 = xmax;
+            for (uint32_t x = 0; x < p_dst_width; x++) {
 
-                    // get pixel of original image
-                    const T *__restrict p = ((T *)p_src) + (oy2 * p_src_width + ox2) * CC;
+                const CubicTaps &tx = x_taps[x];
+                double color[CC] = {};
 
-                    for (int i = 0; i < CC; i++) {
-                        if (sizeof(T) == 2) { //half float
-                            color[i] = Math::half_to_float(p[i]);
-                        } else {
-                            color[i] += p[i] * k2;
+                for (int n = 0; n < 4; n++) {
+                    const T *__restrict row = src + ty.ofs[n] * p_src_width * CC;
+                    for (int m = 0; m < 4; m++) {
+                        double k = ty.weight[n] * tx.weight[m];
+                        const T *__restrict p = row + tx.ofs[m] * CC;
+                        for (int i = 0; i < CC; i++) {
+                            if (sizeof(T) == 2) { //half float
+                                color[i] += Math::half_to_float(p[i]) * k;
+                            } else {
+                                color[i] += p[i] * k;
+                            }
                         }
                     }
                 }
-            }
 
-            for (int i = 0; i < CC; i++) {
-                if (sizeof(T) == 1) { //byte
-                    dst[i] = CLAMP(Math::fast_ftoi(color[i]), 0, 255);
-                } else if (sizeof(T) == 2) { //half float
-                    dst[i] = Math::make_half_float(color[i]);
-                } else {
-                    dst[i] = color[i];
+                for (int i = 0; i < CC; i++) {
+                    if (sizeof(T) == 1) { //byte
+                        dst[i] = CLAMP(Math::fast_ftoi(color[i]), 0, 255);
+                    } else if (sizeof(T) == 2) { //half float
+                        dst[i] = Math::make_half_float(color[i]);
+                    } else {
+                        dst[i] = color[i];
+                    }
                 }
+                dst += CC;
             }
         }
-    }
+    });
 }
 
 template <int CC, class T>
@@ -824,110 +838,115 @@ static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict
 
     };
 
-    for (uint32_t i = 0; i < p_dst_height; i++) {
-
-        uint32_t src_yofs_up_fp = (i * p_src_height * FRAC_LEN / p_dst_height);
-        uint32_t src_yofs_frac = src_yofs_up_fp & FRAC_MASK;
-        uint32_t src_yofs_up = src_yofs_up_fp >> FRAC_BITS;
-
-        uint32_t src_yofs_down = (i + 1) * p_src_height / p_dst_height;
-        if (src_yofs_down >= p_src_height)
-            src_yofs_down = p_src_height - 1;
-
-        //src_yofs_up*=CC;
-        //src_yofs_down*=CC;
+    struct Tap {
+        uint32_t left;
+        uint32_t right;
+        int32_t frac;
+    };
 
-        uint32_t y_ofs_up = src_yofs_up * p_src_width * CC;
-        uint32_t y_ofs_down = src_yofs_down * p_src_width * CC;
+    // horizontal sample positions are the same for every row
+    Vector<Tap> x_taps;
+    x_taps.resize(p_dst_width);
+    for (uint32_t j = 0; j < p_dst_width; j++) {
 
-        for (uint32_t j = 0; j < p_dst_width; j++) {
+        uint64_t src_xofs_left_fp = uint64_t(j) * p_src_width * FRAC_LEN / p_dst_width;
+        uint32_t src_xofs_right = uint64_t(j + 1) * p_src_width / p_dst_width;
+        if (src_xofs_right >= p_src_width)
+            src_xofs_right = p_src_width - 1;
 
-            uint32_t src_xofs_left_fp = (j * p_src_width * FRAC_LEN / p_dst_width);
-            uint32_t src_xofs_frac = src_xofs_left_fp & FRAC_MASK;
-            uint32_t src_xofs_left = src_xofs_left_fp >> FRAC_BITS;
-            uint32_t src_xofs_right = (j + 1) * p_src_width / p_dst_width;
-            if (src_xofs_right >= p_src_width)
-                src_xofs_right = p_src_width - 1;
+        x_taps[j].left = uint32_t(src_xofs_left_fp >> FRAC_BITS) * CC;
+        x_taps[j].right = src_xofs_right * CC;
+        x_taps[j].frac = src_xofs_left_fp & FRAC_MASK;
+    }
 
-            src_xofs_left *= CC;
-            src_xofs_right *= CC;
+    _process_row_bands(p_dst_height, uint64_t(p_dst_width) * p_dst_height * CC * sizeof(T), [&](uint32_t p_from, uint32_t p_to) {
+        for (uint32_t i = p_from; i < p_to; i++) {
 
-            for (uint32_t l = 0; l < CC; l++) {
+            uint64_t src_yofs_up_fp = uint64_t(i) * p_src_height * FRAC_LEN / p_dst_height;
+            int32_t src_yofs_frac = src_yofs_up_fp & FRAC_MASK;
+            uint32_t src_yofs_up = src_yofs_up_fp >> FRAC_BITS;
 
-                if (sizeof(T) == 1) { //uint8
-                    uint32_t p00 = p_src[y_ofs_up + src_xofs_left + l] << FRAC_BITS;
-                    uint32_t p10 = p_src[y_ofs_up + src_xofs_right + l] << FRAC_BITS;
-                    uint32_t p01 = p_src[y_ofs_down + src_xofs_left + l] << FRAC_BITS;
-                    uint32_t p11 = p_src[y_ofs_down + src_xofs_right + l] << FRAC_BITS;
+            uint32_t src_yofs_down = uint64_t(i + 1) * p_src_height / p_dst_height;
+            if (src_yofs_down >= p_src_height)
+                src_yofs_down = p_src_height - 1;
 
-                    uint32_t interp_up = p00 + (((p10 - p00) * src_xofs_frac) >> FRAC_BITS);
-                    uint32_t interp_down = p01 + (((p11 - p01) * src_xofs_frac) >> FRAC_BITS);
-                    uint32_t interp = interp_up + (((interp_down - interp_up) * src_yofs_frac) >> FRAC_BITS);
-                    interp >>= FRAC_BITS;
-                    p_dst[i * p_dst_width * CC + j * CC + l] = interp;
-                } else if (sizeof(T) == 2) { //half float
+            const T *__restrict up = ((const T *)p_src) + src_yofs_up * p_src_width * CC;
+            const T *__restrict down = ((const T *)p_src) + src_yofs_down * p_src_width * CC;
+            T *__restrict dst = ((T *)p_dst) + i * p_dst_width * CC;
 
-                    float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
-                    float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-                    const T *src = ((const T *)p_src);
-                    T *dst = ((T *)p_dst);
+            for (uint32_t j = 0; j < p_dst_width; j++) {
 
-                    float p00 = Math::half_to_float(src[y_ofs_up + src_xofs_left + l]);
-                    float p10 = Math::half_to_float(src[y_ofs_up + src_xofs_right + l]);
-                    float p01 = Math::half_to_float(src[y_ofs_down + src_xofs_left + l]);
-                    float p11 = Math::half_to_float(src[y_ofs_down + src_xofs_right + l]);
+                const Tap &tap = x_taps[j];
 
-                    float interp_up = p00 + (p10 - p00) * xofs_frac;
-                    float interp_down = p01 + (p11 - p01) * xofs_frac;
-                    float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
+                for (uint32_t l = 0; l < CC; l++) {
 
-                    dst[i * p_dst_width * CC + j * CC + l] = Math::make_half_float(interp);
-                } else if (sizeof(T) == 4) { //float
+                    if (sizeof(T) == 1) { //uint8
+                        int32_t p00 = int32_t(up[tap.left + l]) << FRAC_BITS;
+                        int32_t p10 = int32_t(up[tap.right + l]) << FRAC_BITS;
+                        int32_t p01 = int32_t(down[tap.left + l]) << FRAC_BITS;
+                        int32_t p11 = int32_t(down[tap.right + l]) << FRAC_BITS;
 
-                    float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
-                    float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-                    const T *src = ((const T *)p_src);
-                    T *dst = ((T *)p_dst);
+                        int32_t interp_up = p00 + (((p10 - p00) * tap.frac) >> FRAC_BITS);
+                        int32_t interp_down = p01 + (((p11 - p01) * tap.frac) >> FRAC_BITS);
+                        int32_t interp = interp_up + (((interp_down - interp_up) * src_yofs_frac) >> FRAC_BITS);
+                        dst[l] = interp >> FRAC_BITS;
+                    } else {
+                        float xofs_frac = float(tap.frac) / (1 << FRAC_BITS);
+                        float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
+                        float p00, p10, p01, p11;
 
-                    float p00 = src[y_ofs_up + src_xofs_left + l];
-                    float p10 = src[y_ofs_up + src_xofs_right + l];
-                    float p01 = src[y_ofs_down + src_xofs_left + l];
-                    float p11 = src[y_ofs_down + src_xofs_right + l];
+                        if (sizeof(T) == 2) { //half float
+                            p00 = Math::half_to_float(up[tap.left + l]);
+                            p10 = Math::half_to_float(up[tap.right + l]);
+                            p01 = Math::half_to_float(down[tap.left + l]);
+                            p11 = Math::half_to_float(down[tap.right + l]);
+                        } else { //float
+                            p00 = up[tap.left + l];
+                            p10 = up[tap.right + l];
+                            p01 = down[tap.left + l];
+                            p11 = down[tap.right + l];
+                        }
 
-                    float interp_up = p00 + (p10 - p00) * xofs_frac;
-                    float interp_down = p01 + (p11 - p01) * xofs_frac;
-                    float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
+                        float interp_up = p00 + (p10 - p00) * xofs_frac;
+                        float interp_down = p01 + (p11 - p01) * xofs_frac;
+                        float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
 
-                    dst[i * p_dst_width * CC + j * CC + l] = interp;
+                        if (sizeof(T) == 2)
+                            dst[l] = Math::make_half_float(interp);
+                        else
+                            dst[l] = interp;
+                    }
                 }
+                dst += CC;
             }
         }
-    }
+    });
 }
 
 template <int CC, class T>
 static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
 
-    for (uint32_t i = 0; i < p_dst_height; i++) {
-
-        uint32_t src_yofs = i * p_src_height / p_dst_height;
-        uint32_t y_ofs = src_yofs * p_src_width * CC;
-
-        for (uint32_t j = 0; j < p_dst_width; j++) {
-
-            uint32_t src_xofs = j * p_src_width / p_dst_width;
-            src_xofs *= CC;
+    Vector<uint32_t> x_ofs;
+    x_ofs.resize(p_dst_width);
+    for (uint32_t j = 0; j < p_dst_width; j++) {
+        x_ofs[j] = uint32_t(uint64_t(j) * p_src_width / p_dst_width) * CC;
+    }
 
-            for (uint32_t l = 0; l < CC; l++) {
+    _process_row_bands(p_dst_height, uint64_t(p_dst_width) * p_dst_height * CC * sizeof(T), [&](uint32_t p_from, uint32_t p_to) {
+        for (uint32_t i = p_from; i < p_to; i++) {
 
-                const T *src = ((const T *)p_src);
-                T *dst = ((T *)p_dst);
+            uint32_t src_yofs = uint64_t(i) * p_src_height / p_dst_height;
+            const T *__restrict src = ((const T *)p_src) + src_yofs * p_src_width * CC;
+            T *__restrict dst = ((T *)p_dst) + i * p_dst_width * CC;
 
-                T p = src[y_ofs + src_xofs + l];
-                dst[i * p_dst_width * CC + j * CC + l] = p;
+            for (uint32_t j = 0; j < p_dst_width; j++) {
+                for (uint32_t l = 0; l < CC; l++) {
+                    dst[l] = src[x_ofs[j] + l];
+                }
+                dst += CC;
             }
         }
-    }
+    });
 }
 
 #define LANCZOS_TYPE 3
@@ -936,6 +955,48 @@ static float _lanczos(float p_x) {
     return Math::abs(p_x) >= LANCZOS_TYPE ? 0 : Math::sincn(p_x) * Math::sincn(p_x / LANCZOS_TYPE);
 }
 
+// Lanczos kernels for every destination column (or row) of one pass, stored with a fixed stride.
+struct LanczosTaps {
+    Vector<int32_t> start;
+    Vector<int32_t> count;
+    Vector<float> weights;
+    Vector<float> weight_sum;
+    int32_t stride;
+};
+
+static void _make_lanczos_taps(int32_t p_src_size, int32_t p_dst_size, LanczosTaps &r_taps) {
+
+    float scale = float(p_src_size) / float(p_dst_size);
+
+    float scale_factor = M_MAX(scale, 1); // A larger kernel is required only when downscaling
+    int32_t half_kernel = int32_t(LANCZOS_TYPE * scale_factor);
+
+    r_taps.stride = half_kernel * 2;
+    r_taps.start.resize(p_dst_size);
+    r_taps.count.resize(p_dst_size);
+    r_taps.weights.resize(size_t(p_dst_size) * r_taps.stride);
+    r_taps.weight_sum.resize(p_dst_size);
+
+    for (int32_t i = 0; i < p_dst_size; i++) {
+
+        // The corresponding point on the source image
+        float src_pos = (i + 0.5f) * scale; // Offset by 0.5 so it uses the pixel's center
+        int32_t start = M_MAX(0, int32_t(src_pos) - half_kernel + 1);
+        int32_t end = MIN(p_src_size - 1, int32_t(src_pos) + half_kernel);
+
+        float *kernel = &r_taps.weights[size_t(i) * r_taps.stride];
+        float weight = 0;
+        for (int32_t target = start; target <= end; target++) {
+            kernel[target - start] = _lanczos((target + 0.5f - src_pos) / scale_factor);
+            weight += kernel[target - start];
+        }
+
+        r_taps.start[i] = start;
+        r_taps.count[i] = end - start + 1;
+        r_taps.weight_sum[i] = weight;
+    }
+}
+
 template <int CC, class T>
 static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
 
@@ -949,104 +1010,77 @@ static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict
 
     { // FIRST PASS (horizontal)
 
-        float x_scale = float(src_width) / float(dst_width);
-
-        float scale_factor = M_MAX(x_scale, 1); // A larger kernel is required only when downscaling
-        int32_t half_kernel = int32_t(LANCZOS_TYPE * scale_factor);
-
-        float *kernel = memnew_arr(float, half_kernel * 2);
-
-        for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
+        LanczosTaps taps;
+        _make_lanczos_taps(src_width, dst_width, taps);
 
-            // The corresponding point on the source image
-            float src_x = (buffer_x + 0.5f) * x_scale; // Offset by 0.5 so it uses the pixel's center
-            int32_t start_x = M_MAX(0, int32_t(src_x) - half_kernel + 1);
-            int32_t end_x = MIN(src_width - 1, int32_t(src_x) + half_kernel);
+        _process_row_bands(src_height, uint64_t(buffer_size) * sizeof(float), [&](uint32_t p_from, uint32_t p_to) {
+            for (int32_t buffer_y = p_from; buffer_y < int32_t(p_to); buffer_y++) {
 
-            // Create the kernel used by all the pixels of the column
-            for (int32_t target_x = start_x; target_x <= end_x; target_x++)
-                kernel[target_x - start_x] = _lanczos((target_x + 0.5f - src_x) / scale_factor);
+                const T *__restrict src_row = ((const T *)p_src) + buffer_y * src_width * CC;
+                float *__restrict dst_data = buffer + buffer_y * dst_width * CC;
 
-            for (int32_t buffer_y = 0; buffer_y < src_height; buffer_y++) {
+                for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
 
-                float pixel[CC] = { 0 };
-                float weight = 0;
+                    const float *kernel = &taps.weights[size_t(buffer_x) * taps.stride];
+                    const T *__restrict src_data = src_row + taps.start[buffer_x] * CC;
+                    float pixel[CC] = { 0 };
 
-                for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
-
-                    float lanczos_val = kernel[target_x - start_x];
-                    weight += lanczos_val;
-
-                    const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
-
-                    for (uint32_t i = 0; i < CC; i++) {
-                        if (sizeof(T) == 2) //half float
-                            pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
-                        else
-                            pixel[i] += src_data[i] * lanczos_val;
+                    for (int32_t k = 0; k < taps.count[buffer_x]; k++) {
+                        for (uint32_t i = 0; i < CC; i++) {
+                            if (sizeof(T) == 2) //half float
+                                pixel[i] += Math::half_to_float(src_data[i]) * kernel[k];
+                            else
+                                pixel[i] += src_data[i] * kernel[k];
+                        }
+                        src_data += CC;
                     }
-                }
 
-                float *dst_data = ((float *)buffer) + (buffer_y * dst_width + buffer_x) * CC;
-
-                for (uint32_t i = 0; i < CC; i++)
-                    dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
+                    for (uint32_t i = 0; i < CC; i++)
+                        dst_data[i] = pixel[i] / taps.weight_sum[buffer_x]; // Normalize the sum of all the samples
+                    dst_data += CC;
+                }
             }
-        }
-
-        memdelete_arr(kernel);
+        });
     } // End of first pass
 
     { // SECOND PASS (vertical + result)
 
-        float y_scale = float(src_height) / float(dst_height);
-
-        float scale_factor = M_MAX(y_scale, 1);
-        int32_t half_kernel = int(LANCZOS_TYPE * scale_factor);
-
-        float *kernel = memnew_arr(float, half_kernel * 2);
-
-        for (int32_t dst_y = 0; dst_y < dst_height; dst_y++) {
-
-            float buffer_y = (dst_y + 0.5f) * y_scale;
-            int32_t start_y = M_MAX(0, int32_t(buffer_y) - half_kernel + 1);
-            int32_t end_y = MIN(src_height - 1, int32_t(buffer_y) + half_kernel);
+        LanczosTaps taps;
+        _make_lanczos_taps(src_height, dst_height, taps);
 
-            for (int32_t target_y = start_y; target_y <= end_y; target_y++)
-                kernel[target_y - start_y] = _lanczos((target_y + 0.5f - buffer_y) / scale_factor);
+        _process_row_bands(dst_height, uint64_t(dst_width) * dst_height * CC * sizeof(T), [&](uint32_t p_from, uint32_t p_to) {
+            for (int32_t dst_y = p_from; dst_y < int32_t(p_to); dst_y++) {
 
-            for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
+                const float *kernel = &taps.weights[size_t(dst_y) * taps.stride];
+                const float *buffer_rows = buffer + taps.start[dst_y] * dst_width * CC;
+                T *__restrict dst_data = ((T *)p_dst) + dst_y * dst_width * CC;
 
-                float pixel[CC] = { 0 };
-                float weight = 0;
+                for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
 
-                for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
+                    float pixel[CC] = { 0 };
 
-                    float lanczos_val = kernel[target_y - start_y];
-                    weight += lanczos_val;
-
-                    float *buffer_data = ((float *)buffer) + (target_y * dst_width + dst_x) * CC;
-
-                    for (uint32_t i = 0; i < CC; i++)
-                        pixel[i] += buffer_data[i] * lanczos_val;
-                }
+                    for (int32_t k = 0; k < taps.count[dst_y]; k++) {
 
-                T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
+                        const float *buffer_data = buffer_rows + (k * dst_width + dst_x) * CC;
 
-                for (uint32_t i = 0; i < CC; i++) {
-                    pixel[i] /= weight;
+                        for (uint32_t i = 0; i < CC; i++)
+                            pixel[i] += buffer_data[i] * kernel[k];
+                    }
 
-                    if (sizeof(T) == 1) //byte
-                        dst_data[i] = CLAMP<T>(Math::fast_ftoi(pixel[i]), 0, 255);
-                    else if (sizeof(T) == 2) //half float
-                        dst_data[i] = Math::make_half_float(pixel[i]);
-                    else // float
-                        dst_data[i] = pixel[i];
+                    for (uint32_t i = 0; i < CC; i++) {
+                        pixel[i] /= taps.weight_sum[dst_y];
+
+                        if (sizeof(T) == 1) //byte
+                            dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
+                        else if (sizeof(T) == 2) //half float
+                            dst_data[i] = Math::make_half_float(pixel[i]);
+                        else // float
+                            dst_data[i] = pixel[i];
+                    }
+                    dst_data += CC;
                 }
             }
-        }
-
-        memdelete_arr(kernel);
+        });
     } // End of second pass
 
     memdelete_arr(buffer);
@@ -1429,7 +1463,7 @@ bool Image::_can_modify(Format p_format) const {
 template <class Component, int CC, bool renormalize,
         void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
         void (*renormalize_func)(Component *)>
-static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height, uint32_t p_row_from = 0, uint32_t p_row_to = UINT32_MAX) {
 
     //fast power of 2 mipmap generation
     uint32_t dst_w = M_MAX(p_width >> 1, 1);
@@ -1438,7 +1472,8 @@ static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint3
     int right_step = (p_width == 1) ? 0 : CC;
     int down_step = (p_height == 1) ? 0 : (p_width * CC);
 
-    for (uint32_t i = 0; i < dst_h; i++) {
+    p_row_to = MIN(p_row_to, dst_h);
+    for (uint32_t i = p_row_from; i < p_row_to; i++) {
 
         const Component *rup_ptr = &p_src[i * 2 * down_step];
         const Component *rdown_ptr = rup_ptr + down_step;
@@ -1462,6 +1497,51 @@ static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint3
     }
 }
 
+struct MipmapLevel {
+    int ofs;
+    int width;
+    int height;
+};
+
+enum {
+    MIPMAP_STRIP_SHIFT = 4
+};
+
+/**
+ * Generates a whole mipmap chain in one pass. The base level is cut into strips of 2^MIPMAP_STRIP_SHIFT rows and
+ * every strip is reduced through the first MIPMAP_STRIP_SHIFT levels while its rows are still in cache, each
+ * level reading only rows the same strip produced. Strips are spread over the worker threads, the small
+ * remaining levels are generated one after another.
+ */
+template <class Component, int CC, bool renormalize,
+        void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
+        void (*renormalize_func)(Component *)>
+static void _generate_mipmap_chain(uint8_t *p_data, const MipmapLevel *p_levels, int p_count) {
+
+    auto level_data = [p_data, p_levels](int p_level) {
+        return reinterpret_cast<Component *>(p_data + p_levels[p_level].ofs);
+    };
+
+    const int strip_levels = MIN(p_count, int(MIPMAP_STRIP_SHIFT));
+    const uint32_t strip_rows = 1 << MIPMAP_STRIP_SHIFT;
+    const uint32_t strips = (p_levels[0].height + strip_rows - 1) / strip_rows;
+    const uint64_t bytes = uint64_t(p_levels[0].width) * p_levels[0].height * CC * sizeof(Component) / 4;
+
+    _process_row_bands(strips, bytes, [&](uint32_t p_from, uint32_t p_to) {
+        for (uint32_t strip = p_from; strip < p_to; strip++) {
+            for (int l = 1; l <= strip_levels; l++) {
+                _generate_po2_mipmap<Component, CC, renormalize, average_func, renormalize_func>(level_data(l - 1), level_data(l),
+                        p_levels[l - 1].width, p_levels[l - 1].height, (strip * strip_rows) >> l, ((strip + 1) * strip_rows) >> l);
+            }
+        }
+    });
+
+    for (int l = strip_levels + 1; l <= p_count; l++) {
+        _generate_po2_mipmap<Component, CC, renormalize, average_func, renormalize_func>(level_data(l - 1), level_data(l),
+                p_levels[l - 1].width, p_levels[l - 1].height);
+    }
+}
+
 void Image::expand_x2_hq2x() {
 
     ERR_FAIL_COND(!_can_modify(format));
@@ -1616,88 +1696,82 @@ Error Image::generate_mipmaps(bool p_renormalize) {
 
     PoolVector<uint8_t>::Write wp = data.write();
 
-    int prev_ofs = 0;
-    int prev_h = height;
-    int prev_w = width;
-
+    FixedVector<MipmapLevel, 32, true> levels;
+    levels.push_back({ 0, width, height });
     for (int i = 1; i <= mmcount; i++) {
+        MipmapLevel level;
+        _get_mipmap_offset_and_size(i, level.ofs, level.width, level.height);
+        levels.push_back(level);
+    }
 
-        int ofs, w, h;
-        _get_mipmap_offset_and_size(i, ofs, w, h);
-
-        switch (format) {
+    switch (format) {
 
-            case FORMAT_L8:
-            case FORMAT_R8: _generate_po2_mipmap<uint8_t, 1, false, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
-            case FORMAT_LA8:
-            case FORMAT_RG8: _generate_po2_mipmap<uint8_t, 2, false, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h); break;
-            case FORMAT_RGB8:
-                if (p_renormalize)
-                    _generate_po2_mipmap<uint8_t, 3, true, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<uint8_t, 3, false, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
+        case FORMAT_L8:
+        case FORMAT_R8: _generate_mipmap_chain<uint8_t, 1, false, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount); break;
+        case FORMAT_LA8:
+        case FORMAT_RG8: _generate_mipmap_chain<uint8_t, 2, false, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount); break;
+        case FORMAT_RGB8:
+            if (p_renormalize)
+                _generate_mipmap_chain<uint8_t, 3, true, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<uint8_t, 3, false, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            case FORMAT_RGBA8:
-                if (p_renormalize)
-                    _generate_po2_mipmap<uint8_t, 4, true, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<uint8_t, 4, false, average_4_uint8, renormalize_uint8>(&wp[prev_ofs], &wp[ofs], prev_w, prev_h);
-                break;
-            case FORMAT_RF:
-                _generate_po2_mipmap<float, 1, false, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-                break;
-            case FORMAT_RGF:
-                _generate_po2_mipmap<float, 2, false, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-                break;
-            case FORMAT_RGBF:
-                if (p_renormalize)
-                    _generate_po2_mipmap<float, 3, true, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<float, 3, false, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+            break;
+        case FORMAT_RGBA8:
+            if (p_renormalize)
+                _generate_mipmap_chain<uint8_t, 4, true, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<uint8_t, 4, false, average_4_uint8, renormalize_uint8>(wp.ptr(), levels.data(), mmcount);
+            break;
+        case FORMAT_RF:
+            _generate_mipmap_chain<float, 1, false, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
+            break;
+        case FORMAT_RGF:
+            _generate_mipmap_chain<float, 2, false, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
+            break;
+        case FORMAT_RGBF:
+            if (p_renormalize)
+                _generate_mipmap_chain<float, 3, true, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<float, 3, false, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            case FORMAT_RGBAF:
-                if (p_renormalize)
-                    _generate_po2_mipmap<float, 4, true, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<float, 4, false, average_4_float, renormalize_float>(reinterpret_cast<const float *>(&wp[prev_ofs]), reinterpret_cast<float *>(&wp[ofs]), prev_w, prev_h);
+            break;
+        case FORMAT_RGBAF:
+            if (p_renormalize)
+                _generate_mipmap_chain<float, 4, true, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<float, 4, false, average_4_float, renormalize_float>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            case FORMAT_RH:
-                _generate_po2_mipmap<uint16_t, 1, false, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-                break;
-            case FORMAT_RGH:
-                _generate_po2_mipmap<uint16_t, 2, false, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-                break;
-            case FORMAT_RGBH:
-                if (p_renormalize)
-                    _generate_po2_mipmap<uint16_t, 3, true, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<uint16_t, 3, false, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+            break;
+        case FORMAT_RH:
+            _generate_mipmap_chain<uint16_t, 1, false, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
+            break;
+        case FORMAT_RGH:
+            _generate_mipmap_chain<uint16_t, 2, false, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
+            break;
+        case FORMAT_RGBH:
+            if (p_renormalize)
+                _generate_mipmap_chain<uint16_t, 3, true, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<uint16_t, 3, false, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            case FORMAT_RGBAH:
-                if (p_renormalize)
-                    _generate_po2_mipmap<uint16_t, 4, true, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<uint16_t, 4, false, average_4_half, renormalize_half>(reinterpret_cast<const uint16_t *>(&wp[prev_ofs]), reinterpret_cast<uint16_t *>(&wp[ofs]), prev_w, prev_h);
+            break;
+        case FORMAT_RGBAH:
+            if (p_renormalize)
+                _generate_mipmap_chain<uint16_t, 4, true, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<uint16_t, 4, false, average_4_half, renormalize_half>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            case FORMAT_RGBE9995:
-                if (p_renormalize)
-                    _generate_po2_mipmap<uint32_t, 1, true, average_4_rgbe9995, renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
-                else
-                    _generate_po2_mipmap<uint32_t, 1, false, average_4_rgbe9995, renormalize_rgbe9995>(reinterpret_cast<const uint32_t *>(&wp[prev_ofs]), reinterpret_cast<uint32_t *>(&wp[ofs]), prev_w, prev_h);
+            break;
+        case FORMAT_RGBE9995:
+            if (p_renormalize)
+                _generate_mipmap_chain<uint32_t, 1, true, average_4_rgbe9995, renormalize_rgbe9995>(wp.ptr(), levels.data(), mmcount);
+            else
+                _generate_mipmap_chain<uint32_t, 1, false, average_4_rgbe9995, renormalize_rgbe9995>(wp.ptr(), levels.data(), mmcount);
 
-                break;
-            default: {
-            }
+            break;
+        default: {
         }
-
-        prev_ofs = ofs;
-        prev_w = w;
-        prev_h = h;
     }
 
     mipmaps = true;
@@ -30,7 +30,10 @@
 
 #include "compression.h"
 
+#include "core/hash_set.h"
+#include "core/hashfuncs.h"
 #include "core/io/zip_io.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
 
 #include "thirdparty/misc/fastlz.h"
@@ -38,6 +41,128 @@
 #include <zlib.h>
 #include <zstd.h>
 
+#include <atomic>
+
+namespace {
+
+// zstd contexts are expensive to create (several hundred KB of tables), so every thread keeps its own pair
+// and resets it between calls instead.
+struct ZstdThreadContexts {
+    ZSTD_CCtx *cctx = nullptr;
+    ZSTD_DCtx *dctx = nullptr;
+
+    ~ZstdThreadContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+thread_local ZstdThreadContexts zstd_thread_contexts;
+
+void _setup_cctx(ZSTD_CCtx *p_cctx, const CompressionDictionary *p_dict, int p_level) {
+
+    ZSTD_CCtx_reset(p_cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(p_cctx, ZSTD_c_compressionLevel, p_level);
+    if (Compression::zstd_long_distance_matching) {
+        ZSTD_CCtx_setParameter(p_cctx, ZSTD_c_enableLongDistanceMatching, 1);
+        ZSTD_CCtx_setParameter(p_cctx, ZSTD_c_windowLog, Compression::zstd_window_log_size);
+    }
+    if (p_dict && p_dict->is_valid()) {
+        ZSTD_CCtx_refCDict(p_cctx, (const ZSTD_CDict *)p_dict->_get_cdict());
+    }
+}
+
+void _setup_dctx(ZSTD_DCtx *p_dctx, const CompressionDictionary *p_dict) {
+
+    ZSTD_DCtx_reset(p_dctx, ZSTD_reset_session_and_parameters);
+    if (Compression::zstd_long_distance_matching) {
+        ZSTD_DCtx_setParameter(p_dctx, ZSTD_d_windowLogMax, Compression::zstd_window_log_size);
+    }
+    if (p_dict && p_dict->is_valid()) {
+        ZSTD_DCtx_refDDict(p_dctx, (const ZSTD_DDict *)p_dict->_get_ddict());
+    }
+}
+
+ZSTD_CCtx *_get_thread_cctx(const CompressionDictionary *p_dict) {
+
+    ZstdThreadContexts &contexts = zstd_thread_contexts;
+    if (!contexts.cctx) {
+        contexts.cctx = ZSTD_createCCtx();
+        ERR_FAIL_COND_V(!contexts.cctx, nullptr);
+    }
+    _setup_cctx(contexts.cctx, p_dict, Compression::zstd_level);
+    return contexts.cctx;
+}
+
+ZSTD_DCtx *_get_thread_dctx(const CompressionDictionary *p_dict) {
+
+    ZstdThreadContexts &contexts = zstd_thread_contexts;
+    if (!contexts.dctx) {
+        contexts.dctx = ZSTD_createDCtx();
+        ERR_FAIL_COND_V(!contexts.dctx, nullptr);
+    }
+    _setup_dctx(contexts.dctx, p_dict);
+    return contexts.dctx;
+}
+
+} // namespace
+
+Error CompressionDictionary::create(const uint8_t *p_data, int p_size, int p_level) {
+
+    clear();
+    ERR_FAIL_COND_V(!p_data || p_size <= 0, ERR_INVALID_PARAMETER);
+
+    cdict = ZSTD_createCDict(p_data, p_size, p_level < 0 ? Compression::zstd_level : p_level);
+    ddict = ZSTD_createDDict(p_data, p_size);
+    if (!cdict || !ddict) {
+        clear();
+        ERR_FAIL_V_MSG(ERR_INVALID_DATA, "Failed to prepare zstd dictionary.");
+    }
+    id = ZSTD_getDictID_fromDict(p_data, p_size);
+    return OK;
+}
+
+void CompressionDictionary::clear() {
+
+    ZSTD_freeCDict((ZSTD_CDict *)cdict);
+    ZSTD_freeDDict((ZSTD_DDict *)ddict);
+    cdict = nullptr;
+    ddict = nullptr;
+    id = 0;
+}
+
+Vector<uint8_t> CompressionDictionary::build_from_samples(const Vector<Vector<uint8_t>> &p_samples, int p_max_size) {
+
+    ERR_FAIL_COND_V(p_max_size <= 0, Vector<uint8_t>());
+
+    // pick samples starting with the last one, then lay them out in the original order
+    struct Picked {
+        int sample;
+        int length;
+    };
+    HashSet<uint64_t> seen;
+    Vector<Picked> picked;
+    int total = 0;
+    for (int i = int(p_samples.size()) - 1; i >= 0 && total < p_max_size; i--) {
+        const Vector<uint8_t> &sample = p_samples[i];
+        if (sample.empty() || !seen.insert(hash_djb2_buffer64(sample.data(), int(sample.size()))).second) {
+            continue;
+        }
+        // the sample that doesn't fit anymore contributes its beginning, where headers usually are
+        const int length = MIN(int(sample.size()), p_max_size - total);
+        picked.push_back(Picked { i, length });
+        total += length;
+    }
+
+    Vector<uint8_t> content;
+    content.reserve(total);
+    for (auto iter = picked.rbegin(); iter != picked.rend(); ++iter) {
+        const Vector<uint8_t> &sample = p_samples[iter->sample];
+        content.insert(content.end(), sample.begin(), sample.begin() + iter->length);
+    }
+    return content;
+}
+
 int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
 
     switch (p_mode) {
@@ -79,16 +204,7 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,
 
         }
         case MODE_ZSTD: {
-            ZSTD_CCtx *cctx = ZSTD_createCCtx();
-            ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, zstd_level);
-            if (zstd_long_distance_matching) {
-                ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
-                ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, zstd_window_log_size);
-            }
-            int max_dst_size = get_max_compressed_buffer_size(p_src_size, MODE_ZSTD);
-            int ret = ZSTD_compressCCtx(cctx, p_dst, max_dst_size, p_src, p_src_size, zstd_level);
-            ZSTD_freeCCtx(cctx);
-            return ret;
+            return compress_zstd(p_dst, p_src, p_src_size, nullptr);
         }
     }
 
@@ -172,19 +288,196 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
             return total;
         }
         case MODE_ZSTD: {
-            ZSTD_DCtx *dctx = ZSTD_createDCtx();
-            if (zstd_long_distance_matching) {
-                ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, zstd_window_log_size);
-            }
-            int ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
-            ZSTD_freeDCtx(dctx);
-            return ret;
+            return decompress_zstd(p_dst, p_dst_max_size, p_src, p_src_size, nullptr);
         }
     }
 
     ERR_FAIL_V(-1);
 }
 
+int Compression::compress_zstd(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dict) {
+
+    ZSTD_CCtx *cctx = _get_thread_cctx(p_dict);
+    ERR_FAIL_COND_V(!cctx, -1);
+    const size_t ret = ZSTD_compress2(cctx, p_dst, ZSTD_compressBound(p_src_size), p_src, p_src_size);
+    ERR_FAIL_COND_V_MSG(ZSTD_isError(ret), -1, ZSTD_getErrorName(ret));
+    return int(ret);
+}
+
+int Compression::decompress_zstd(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dict) {
+
+    ZSTD_DCtx *dctx = _get_thread_dctx(p_dict);
+    ERR_FAIL_COND_V(!dctx, -1);
+    const size_t ret = ZSTD_decompressDCtx(dctx, p_dst, p_dst_max_size, p_src, p_src_size);
+    if (ZSTD_isError(ret)) {
+        return -1;
+    }
+    return int(ret);
+}
+
+int Compression::compress_zstd_parallel(Vector<uint8_t> &r_dst, const uint8_t *p_src, int p_src_size, int p_chunk_size) {
+
+    ERR_FAIL_COND_V(p_src_size < 0 || p_chunk_size <= 0, -1);
+
+    const int chunk_count = (p_src_size + p_chunk_size - 1) / p_chunk_size;
+    if (chunk_count <= 1) {
+        r_dst.resize(get_max_compressed_buffer_size(p_src_size, MODE_ZSTD));
+        const int size = compress_zstd(r_dst.data(), p_src, p_src_size, nullptr);
+        r_dst.resize(M_MAX(size, 0));
+        return size;
+    }
+
+    // every chunk becomes an independent frame, with the content size recorded so it can be decompressed in parallel too
+    Vector<Vector<uint8_t>> frames;
+    frames.resize(chunk_count);
+    std::atomic<bool> failed(false);
+    WorkerThreadPool::get_singleton()->parallel_for(chunk_count, [&](uint32_t p_chunk) {
+        const int offset = int(p_chunk) * p_chunk_size;
+        const int size = MIN(p_chunk_size, p_src_size - offset);
+        Vector<uint8_t> &frame = frames[p_chunk];
+        frame.resize(get_max_compressed_buffer_size(size, MODE_ZSTD));
+        int written = compress_zstd(frame.data(), p_src + offset, size, nullptr);
+        if (written < 0) {
+            failed = true;
+            written = 0;
+        }
+        frame.resize(written);
+    });
+    ERR_FAIL_COND_V(failed, -1);
+
+    size_t total = 0;
+    for (const Vector<uint8_t> &frame : frames) {
+        total += frame.size();
+    }
+    r_dst.resize(total);
+    uint8_t *w = r_dst.data();
+    for (const Vector<uint8_t> &frame : frames) {
+        memcpy(w, frame.data(), frame.size());
+        w += frame.size();
+    }
+    return int(total);
+}
+
+int Compression::decompress_zstd_parallel(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size) {
+
+    struct Frame {
+        int src_offset;
+        int src_size;
+        int dst_offset;
+        int dst_size;
+    };
+    Vector<Frame> frames;
+    int src_offset = 0;
+    int dst_offset = 0;
+    while (src_offset < p_src_size) {
+        const size_t src_size = ZSTD_findFrameCompressedSize(p_src + src_offset, p_src_size - src_offset);
+        const unsigned long long dst_size = ZSTD_getFrameContentSize(p_src + src_offset, p_src_size - src_offset);
+        if (ZSTD_isError(src_size) || dst_size == ZSTD_CONTENTSIZE_UNKNOWN || dst_size == ZSTD_CONTENTSIZE_ERROR ||
+                dst_size > (unsigned long long)(p_dst_max_size - dst_offset)) {
+            // not something compress_zstd_parallel() wrote, let the regular path deal with it
+            return decompress(p_dst, p_dst_max_size, p_src, p_src_size, MODE_ZSTD);
+        }
+        frames.push_back(Frame { src_offset, int(src_size), dst_offset, int(dst_size) });
+        src_offset += int(src_size);
+        dst_offset += int(dst_size);
+    }
+    if (frames.size() <= 1) {
+        return decompress(p_dst, p_dst_max_size, p_src, p_src_size, MODE_ZSTD);
+    }
+
+    std::atomic<bool> failed(false);
+    WorkerThreadPool::get_singleton()->parallel_for(frames.size(), [&](uint32_t p_frame) {
+        const Frame &frame = frames[p_frame];
+        const int ret = decompress_zstd(p_dst + frame.dst_offset, frame.dst_size, p_src + frame.src_offset, frame.src_size, nullptr);
+        if (ret != frame.dst_size) {
+            failed = true;
+        }
+    });
+    ERR_FAIL_COND_V(failed, -1);
+    return dst_offset;
+}
+
+ZstdCompressStream::~ZstdCompressStream() {
+
+    ZSTD_freeCCtx((ZSTD_CCtx *)stream);
+}
+
+static Error _zstd_stream_compress(ZSTD_CCtx *p_cctx, const uint8_t *p_src, int p_size, ZSTD_EndDirective p_end, Vector<uint8_t> &r_out) {
+
+    ZSTD_inBuffer in = { p_src, size_t(p_size), 0 };
+    const size_t out_step = ZSTD_CStreamOutSize();
+    while (true) {
+        const size_t base = r_out.size();
+        r_out.resize(base + out_step);
+        ZSTD_outBuffer out = { r_out.data() + base, out_step, 0 };
+        const size_t remaining = ZSTD_compressStream2(p_cctx, &out, &in, p_end);
+        r_out.resize(base + out.pos);
+        ERR_FAIL_COND_V_MSG(ZSTD_isError(remaining), FAILED, ZSTD_getErrorName(remaining));
+        if (p_end == ZSTD_e_end ? remaining == 0 : in.pos == in.size) {
+            return OK;
+        }
+    }
+}
+
+Error ZstdCompressStream::begin(const CompressionDictionary *p_dict, int p_level) {
+
+    if (!stream) {
+        stream = ZSTD_createCCtx();
+        ERR_FAIL_COND_V(!stream, ERR_OUT_OF_MEMORY);
+    }
+    _setup_cctx((ZSTD_CCtx *)stream, p_dict, p_level < 0 ? Compression::zstd_level : p_level);
+    return OK;
+}
+
+Error ZstdCompressStream::write(const uint8_t *p_src, int p_size, Vector<uint8_t> &r_out) {
+
+    ERR_FAIL_COND_V_MSG(!stream, ERR_UNCONFIGURED, "begin() must be called before writing.");
+    return _zstd_stream_compress((ZSTD_CCtx *)stream, p_src, p_size, ZSTD_e_continue, r_out);
+}
+
+Error ZstdCompressStream::finish(Vector<uint8_t> &r_out) {
+
+    ERR_FAIL_COND_V_MSG(!stream, ERR_UNCONFIGURED, "begin() must be called before finishing.");
+    return _zstd_stream_compress((ZSTD_CCtx *)stream, nullptr, 0, ZSTD_e_end, r_out);
+}
+
+ZstdDecompressStream::~ZstdDecompressStream() {
+
+    ZSTD_freeDCtx((ZSTD_DCtx *)stream);
+}
+
+Error ZstdDecompressStream::begin(const CompressionDictionary *p_dict) {
+
+    if (!stream) {
+        stream = ZSTD_createDCtx();
+        ERR_FAIL_COND_V(!stream, ERR_OUT_OF_MEMORY);
+    }
+    _setup_dctx((ZSTD_DCtx *)stream, p_dict);
+    frame_finished = false;
+    return OK;
+}
+
+Error ZstdDecompressStream::write(const uint8_t *p_src, int p_size, Vector<uint8_t> &r_out) {
+
+    ERR_FAIL_COND_V_MSG(!stream, ERR_UNCONFIGURED, "begin() must be called before writing.");
+
+    ZSTD_inBuffer in = { p_src, size_t(p_size), 0 };
+    const size_t out_step = ZSTD_DStreamOutSize();
+    while (true) {
+        const size_t base = r_out.size();
+        r_out.resize(base + out_step);
+        ZSTD_outBuffer out = { r_out.data() + base, out_step, 0 };
+        const size_t ret = ZSTD_decompressStream((ZSTD_DCtx *)stream, &out, &in);
+        r_out.resize(base + out.pos);
+        ERR_FAIL_COND_V_MSG(ZSTD_isError(ret), ERR_FILE_CORRUPT, ZSTD_getErrorName(ret));
+        frame_finished = ret == 0;
+        // a full output buffer may mean more decoded data is pending even with all input consumed
+        if (in.pos == in.size && out.pos < out.size) {
+            return OK;
+        }
+    }
+}
+
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
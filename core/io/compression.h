@@ -30,27 +30,113 @@
 
 #pragma once
 
+#include "core/error_list.h"
 #include "core/typedefs.h"
+#include "core/vector.h"
 
-class Compression {
+/**
+ * Prepared zstd dictionary, shared by any number of threads and streams once created.
+ * Dictionaries make small payloads (single resources, network packets) compress far better, the same
+ * dictionary content must be used to decompress.
+ */
+class GODOT_EXPORT CompressionDictionary {
+    void *cdict = nullptr;
+    void *ddict = nullptr;
+    uint32_t id = 0;
 
 public:
-	static int zlib_level;
-	static int gzip_level;
-	static int zstd_level;
-	static bool zstd_long_distance_matching;
-	static int zstd_window_log_size;
-
-	enum Mode {
-		MODE_FASTLZ,
-		MODE_DEFLATE,
-		MODE_ZSTD,
-		MODE_GZIP
-	};
-
-	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
-	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
-	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
-
-	Compression();
+    //! Prepares p_data (either a zstd dictionary or raw content) for use with the given level, -1 uses Compression::zstd_level.
+    Error create(const uint8_t *p_data, int p_size, int p_level = -1);
+    void clear();
+    bool is_valid() const { return cdict != nullptr; }
+    //! Dictionary id stored in frames, 0 for raw content dictionaries.
+    uint32_t get_id() const { return id; }
+
+    /**
+     * Builds raw dictionary content of at most p_max_size bytes from typical payloads.
+     * Samples are appended from last to first with duplicates skipped, zstd favours content near the end of a
+     * dictionary so the last samples should be the most representative ones.
+     */
+    static Vector<uint8_t> build_from_samples(const Vector<Vector<uint8_t>> &p_samples, int p_max_size = 64 * 1024);
+
+    const void *_get_cdict() const { return cdict; }
+    const void *_get_ddict() const { return ddict; }
+
+    CompressionDictionary() = default;
+    CompressionDictionary(const CompressionDictionary &) = delete;
+    CompressionDictionary &operator=(const CompressionDictionary &) = delete;
+    ~CompressionDictionary() { clear(); }
+};
+
+class GODOT_EXPORT Compression {
+
+public:
+    static int zlib_level;
+    static int gzip_level;
+    static int zstd_level;
+    static bool zstd_long_distance_matching;
+    static int zstd_window_log_size;
+
+    enum Mode {
+        MODE_FASTLZ,
+        MODE_DEFLATE,
+        MODE_ZSTD,
+        MODE_GZIP
+    };
+
+    static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+    static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
+    static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+
+    //! zstd compression using a prepared dictionary, p_dst must hold get_max_compressed_buffer_size(p_src_size) bytes.
+    static int compress_zstd(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dict);
+    static int decompress_zstd(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, const CompressionDictionary *p_dict);
+
+    /**
+     * Compresses a large buffer by splitting it in p_chunk_size chunks compressed on the WorkerThreadPool.
+     * The result is a sequence of regular zstd frames, so it can be read back with decompress() or
+     * decompress_zstd_parallel(). Returns the compressed size or -1 on failure.
+     */
+    static int compress_zstd_parallel(Vector<uint8_t> &r_dst, const uint8_t *p_src, int p_src_size, int p_chunk_size = 1 << 20);
+    //! Decompresses the frames written by compress_zstd_parallel() in parallel, falls back to decompress() for other data.
+    static int decompress_zstd_parallel(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size);
+
+    Compression();
+};
+
+/**
+ * Incremental zstd compression, for data that is produced piece by piece or too large to hold twice in memory.
+ * Output is appended to the vector passed to write()/finish(), the result is a single zstd frame.
+ */
+class GODOT_EXPORT ZstdCompressStream {
+    void *stream = nullptr;
+
+public:
+    //! p_dict is referenced, not copied, and must outlive the stream.
+    Error begin(const CompressionDictionary *p_dict = nullptr, int p_level = -1);
+    Error write(const uint8_t *p_src, int p_size, Vector<uint8_t> &r_out);
+    //! Ends the frame, begin() has to be called again before further writes.
+    Error finish(Vector<uint8_t> &r_out);
+
+    ZstdCompressStream() = default;
+    ZstdCompressStream(const ZstdCompressStream &) = delete;
+    ZstdCompressStream &operator=(const ZstdCompressStream &) = delete;
+    ~ZstdCompressStream();
+};
+
+//! Incremental zstd decompression, accepts compressed data in pieces of any size.
+class GODOT_EXPORT ZstdDecompressStream {
+    void *stream = nullptr;
+    bool frame_finished = false;
+
+public:
+    Error begin(const CompressionDictionary *p_dict = nullptr);
+    Error write(const uint8_t *p_src, int p_size, Vector<uint8_t> &r_out);
+    //! True once the end of a frame was decoded and no partial frame is pending.
+    bool is_frame_finished() const { return frame_finished; }
+
+    ZstdDecompressStream() = default;
+    ZstdDecompressStream(const ZstdDecompressStream &) = delete;
+    ZstdDecompressStream &operator=(const ZstdDecompressStream &) = delete;
+    ~ZstdDecompressStream();
 };
@@ -30,6 +30,7 @@
 
 #include "file_access_compressed.h"
 
+#include "core/os/worker_thread_pool.h"
 #include "core/string.h"
 #include "core/vector.h"
 
@@ -157,18 +158,29 @@ void FileAccessCompressed::close() {
             f->store_32(0); //compressed sizes, will update later
         }
 
-        Vector<int> block_sizes;
-        for (int i = 0; i < bc; i++) {
-
-            int bl = i == (bc - 1) ? write_max % block_size : block_size;
-            uint8_t *bp = &write_ptr[i * block_size];
+        // blocks are independent, so they are compressed in batches on the worker pool and stored in order afterwards
+        Vector<Vector<uint8_t>> cblocks;
+        cblocks.resize(bc);
+        const int batch_size = 16;
+        WorkerThreadPool::get_singleton()->parallel_for((bc + batch_size - 1) / batch_size, [&](uint32_t p_batch) {
+            const int end = MIN(bc, int(p_batch + 1) * batch_size);
+            for (int i = p_batch * batch_size; i < end; i++) {
+
+                int bl = i == (bc - 1) ? write_max % block_size : block_size;
+                const uint8_t *bp = &write_ptr[i * block_size];
+
+                Vector<uint8_t> &cblock = cblocks[i];
+                cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
+                int s = Compression::compress(cblock.data(), bp, bl, cmode);
+                cblock.resize(M_MAX(s, 0));
+            }
+        });
 
-            Vector<uint8_t> cblock;
-            cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-            int s = Compression::compress(cblock.data(), bp, bl, cmode);
+        Vector<int> block_sizes;
+        for (const Vector<uint8_t> &cblock : cblocks) {
 
-            f->store_buffer(cblock.data(), s);
-            block_sizes.push_back(s);
+            f->store_buffer(cblock.data(), cblock.size());
+            block_sizes.push_back(cblock.size());
         }
 
         f->seek(16); //ok write block sizes
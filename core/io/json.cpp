@@ -27,456 +27,633 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
-
 #include "json.h"
 
+#include "core/dictionary.h"
 #include "core/print_string.h"
-#include "core/list.h"
+#include "core/string_utils.h"
 #include "core/vector.h"
-#include "core/dictionary.h"
-#include "core/string_utils.inl"
 #include "EASTL/sort.h"
 
-const char *JSON::tk_name[TK_MAX] = {
-    "'{'",
-    "'}'",
-    "'['",
-    "']'",
-    "identifier",
-    "string",
-    "number",
-    "':'",
-    "','",
-    "EOF",
-};
+#include <cstring>
+
+namespace {
+
+/* Word at a time scanning, used to skip over the bytes that need no attention in bulk. */
 
-static String _make_indent(StringView p_indent, int p_size) {
+constexpr uint64_t _repeat_byte(uint8_t p_byte) {
+    return 0x0101010101010101ULL * p_byte;
+}
+
+_FORCE_INLINE_ uint64_t _load_word(const char *p_ptr) {
+    uint64_t word;
+    memcpy(&word, p_ptr, sizeof(word));
+    return word;
+}
 
-    String indent_text;
-    indent_text.reserve(p_size*p_indent.size());
-    if (!p_indent.empty()) {
-        for (int i = 0; i < p_size; i++)
-            indent_text.append(p_indent);
+// Non-zero if any byte of p_word equals p_byte.
+_FORCE_INLINE_ uint64_t _has_byte(uint64_t p_word, uint8_t p_byte) {
+    const uint64_t v = p_word ^ _repeat_byte(p_byte);
+    return (v - _repeat_byte(0x01)) & ~v & _repeat_byte(0x80);
+}
+
+// End of the run starting at p_ptr that contains no quote, backslash or newline.
+const char *_scan_plain_string(const char *p_ptr, const char *p_end) {
+    while (p_end - p_ptr >= 8) {
+        const uint64_t word = _load_word(p_ptr);
+        if (_has_byte(word, '"') | _has_byte(word, '\\') | _has_byte(word, '\n'))
+            break;
+        p_ptr += 8;
+    }
+    while (p_ptr < p_end && *p_ptr != '"' && *p_ptr != '\\' && *p_ptr != '\n') {
+        p_ptr++;
     }
-    return indent_text;
+    return p_ptr;
 }
 
-String JSON::_print_var(const Variant &p_var, StringView p_indent, int p_cur_indent, bool p_sort_keys) {
+void _append_utf8(String &r_str, uint32_t p_code) {
+    if (p_code < 0x80) {
+        r_str.push_back(char(p_code));
+    } else if (p_code < 0x800) {
+        r_str.push_back(char(0xC0 | (p_code >> 6)));
+        r_str.push_back(char(0x80 | (p_code & 0x3F)));
+    } else if (p_code < 0x10000) {
+        r_str.push_back(char(0xE0 | (p_code >> 12)));
+        r_str.push_back(char(0x80 | ((p_code >> 6) & 0x3F)));
+        r_str.push_back(char(0x80 | (p_code & 0x3F)));
+    } else {
+        r_str.push_back(char(0xF0 | (p_code >> 18)));
+        r_str.push_back(char(0x80 | ((p_code >> 12) & 0x3F)));
+        r_str.push_back(char(0x80 | ((p_code >> 6) & 0x3F)));
+        r_str.push_back(char(0x80 | (p_code & 0x3F)));
+    }
+}
 
-    String colon(":");
-    String end_statement;
+// Exactly representable powers of ten, used by the fast float path.
+const double json_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-    if (!p_indent.empty()) {
-        colon += " ";
-        end_statement += "\n";
+/**
+ * Recursive descent parser working on the UTF-8 input in place. Values are built directly, strings are copied
+ * in runs between escapes.
+ */
+class JSONParser {
+    const char *ptr;
+    const char *end;
+    int &line;
+    String &err_str;
+
+    Error _error(const char *p_message) {
+        err_str = p_message;
+        return ERR_PARSE_ERROR;
     }
 
-    switch (p_var.get_type()) {
+    // What was found instead of the expected token, either p_message or an invalid character.
+    Error _unexpected(char p_found, const char *p_message) {
+        const bool is_token = p_found == 0 || strchr("{}[]:,\"-", p_found) || (p_found >= '0' && p_found <= '9') ||
+                              (p_found >= 'a' && p_found <= 'z') || (p_found >= 'A' && p_found <= 'Z');
+        return _error(is_token ? p_message : "Unexpected character.");
+    }
 
-        case VariantType::NIL: return "null";
-        case VariantType::BOOL: return p_var.as<bool>() ? "true" : "false";
-        case VariantType::INT: return itos(p_var.as<int>());
-        case VariantType::FLOAT: return rtos(p_var.as<float>());
-        case VariantType::POOL_INT_ARRAY:
-        case VariantType::POOL_REAL_ARRAY:
-        case VariantType::POOL_STRING_ARRAY:
-        case VariantType::ARRAY: {
-
-            String s("[");
-            s += end_statement;
-            Array a = p_var.as<Array>();
-            for (int i = 0; i < a.size(); i++) {
-                if (i > 0) {
-                    s += ",";
-                    s += end_statement;
-                }
-                s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(a[i], p_indent, p_cur_indent + 1, p_sort_keys);
+    // First byte that is not whitespace, without consuming it. 0 at the end of the input.
+    char _peek() {
+        while (ptr < end) {
+            const uint8_t c = uint8_t(*ptr);
+            if (c > 32)
+                return char(c);
+            if (c == 0)
+                return 0;
+            if (c == '\n')
+                line++;
+            ptr++;
+            // indentation comes in runs
+            while (end - ptr >= 8 && (_load_word(ptr) == _repeat_byte(' ') || _load_word(ptr) == _repeat_byte('\t'))) {
+                ptr += 8;
             }
-            s += end_statement + _make_indent(p_indent, p_cur_indent) + "]";
-            return s;
         }
-        case VariantType::DICTIONARY: {
-
-            String s("{");
-            s += end_statement;
-            Dictionary d = p_var.as<Dictionary>();
-            Vector<Variant> keys(d.get_key_list());
-
-            if (p_sort_keys)
-                eastl::sort(keys.begin(),keys.end());
+        return 0;
+    }
 
-            for (const Variant &E : keys) {
+    bool _read_hex4(uint32_t &r_value) {
+        r_value = 0;
+        for (int i = 0; i < 4; i++) {
+            if (ptr == end || *ptr == 0) {
+                _error("Unterminated String");
+                return false;
+            }
+            const char c = *ptr++;
+            uint32_t v;
+            if (c >= '0' && c <= '9') {
+                v = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                v = c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                v = c - 'A' + 10;
+            } else {
+                _error("Malformed hex constant in string");
+                return false;
+            }
+            r_value = (r_value << 4) | v;
+        }
+        return true;
+    }
 
-                if (&E != &keys.front()) {
-                    s += ",";
-                    s += end_statement;
-                }
-                s += _make_indent(p_indent, p_cur_indent + 1) + _print_var(E, p_indent, p_cur_indent + 1, p_sort_keys);
-                s += colon;
-                s += _print_var(d[E], p_indent, p_cur_indent + 1, p_sort_keys);
+    // The opening quote was consumed.
+    Error _parse_string(String &r_str) {
+        while (true) {
+            const char *run_end = _scan_plain_string(ptr, end);
+            r_str.append(ptr, run_end);
+            ptr = run_end;
+            if (ptr == end)
+                return _error("Unterminated String");
+
+            const char c = *ptr++;
+            if (c == '"')
+                return OK;
+            if (c == '\n') {
+                line++;
+                r_str.push_back(c);
+                continue;
             }
 
-            s += end_statement + _make_indent(p_indent, p_cur_indent) + "}";
-            return s;
+            // escape sequence
+            if (ptr == end || *ptr == 0)
+                return _error("Unterminated String");
+            const char next = *ptr++;
+            switch (next) {
+                case 'b': r_str.push_back('\b'); break;
+                case 't': r_str.push_back('\t'); break;
+                case 'n': r_str.push_back('\n'); break;
+                case 'f': r_str.push_back('\f'); break;
+                case 'r': r_str.push_back('\r'); break;
+                case 'u': {
+                    uint32_t code;
+                    if (!_read_hex4(code))
+                        return ERR_PARSE_ERROR;
+                    if (code >= 0xD800 && code < 0xDC00 && end - ptr >= 6 && ptr[0] == '\\' && ptr[1] == 'u') {
+                        // high surrogate, combined with the low surrogate escape that should follow
+                        const char *low_begin = ptr;
+                        ptr += 2;
+                        uint32_t low;
+                        if (!_read_hex4(low))
+                            return ERR_PARSE_ERROR;
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            ptr = low_begin; // decoded on its own
+                        }
+                    }
+                    if (code >= 0xD800 && code < 0xE000)
+                        code = 0xFFFD; // unpaired surrogate
+                    _append_utf8(r_str, code);
+                } break;
+                default: {
+                    r_str.push_back(next); // '"', '\\', '/' and anything else stand for themselves
+                } break;
+            }
         }
-    default: return "\"" + StringUtils::json_escape(p_var.as<String>()) + "\"";
     }
-}
 
-String JSON::print(const Variant &p_var, StringView p_indent, bool p_sort_keys) {
+    Error _parse_number(Variant &r_value) {
+        const char *begin = ptr;
+        bool negative = false;
+        if (*ptr == '-') {
+            negative = true;
+            ptr++;
+            if (ptr == end || *ptr < '0' || *ptr > '9')
+                return _error("Expected digit after '-'.");
+        }
 
-    return _print_var(p_var, p_indent, 0, p_sort_keys);
-}
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exp10 = 0;
+        bool truncated = false;
+        while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*ptr - '0');
+                digits += mantissa != 0;
+            } else {
+                truncated = true;
+                exp10++;
+            }
+            ptr++;
+        }
+        if (ptr < end && *ptr == '.') {
+            ptr++;
+            while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*ptr - '0');
+                    digits += mantissa != 0;
+                    exp10--;
+                } else {
+                    truncated = true;
+                }
+                ptr++;
+            }
+        }
+        if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+            const char *exp_begin = ptr++;
+            bool exp_negative = false;
+            if (ptr < end && (*ptr == '-' || *ptr == '+')) {
+                exp_negative = *ptr == '-';
+                ptr++;
+            }
+            if (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                int exp_value = 0;
+                while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+                    if (exp_value < 100000)
+                        exp_value = exp_value * 10 + (*ptr - '0');
+                    ptr++;
+                }
+                exp10 += exp_negative ? -exp_value : exp_value;
+            } else {
+                ptr = exp_begin; // not an exponent, left for the caller to complain about
+            }
+        }
 
-Error JSON::_get_token(const CharType *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str) {
+        if (!truncated && mantissa <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+            // exact with a single rounding, see Clinger's fast path
+            double v = double(mantissa);
+            v = exp10 < 0 ? v / json_pow10[-exp10] : v * json_pow10[exp10];
+            r_value = negative ? -v : v;
+            return OK;
+        }
 
-    while (p_len > 0) {
-        switch (p_str[index].toLatin1()) {
+        // always uses '.' as the decimal point, unlike strtod under some locales
+        r_value = StringUtils::to_double(StringView(begin, ptr - begin));
+        return OK;
+    }
 
-            case '\n': {
+    Error _parse_array(Array &r_array) {
+        char c = _peek();
+        if (c == ']') {
+            ptr++;
+            return OK;
+        }
+        while (true) {
+            if (c == 0)
+                return _error("Expected ']'");
 
-                line++;
-                index++;
-                break;
-            }
-            case 0: {
-                r_token.type = TK_EOF;
-                return OK;
-            }
-            case '{': {
+            Variant v;
+            Error err = parse_value(v);
+            if (err != OK)
+                return err;
+            r_array.emplace_back(eastl::move(v));
 
-                r_token.type = TK_CURLY_BRACKET_OPEN;
-                index++;
+            c = _peek();
+            if (c == ']') {
+                ptr++;
                 return OK;
             }
-            case '}': {
-
-                r_token.type = TK_CURLY_BRACKET_CLOSE;
-                index++;
+            if (c == 0)
+                return _error("Expected ']'");
+            if (c != ',')
+                return _unexpected(c, "Expected ','");
+            ptr++;
+
+            c = _peek();
+            if (c == ']') { // a trailing comma has always been accepted
+                ptr++;
                 return OK;
             }
-            case '[': {
+        }
+    }
 
-                r_token.type = TK_BRACKET_OPEN;
-                index++;
+    Error _parse_object(Dictionary &r_object) {
+        char c = _peek();
+        while (true) {
+            if (c == '}') {
+                ptr++;
                 return OK;
             }
-            case ']': {
+            if (c == 0)
+                return _error("Expected '}'");
+            if (c != '"')
+                return _unexpected(c, "Expected key");
+            ptr++;
+
+            String key;
+            Error err = _parse_string(key);
+            if (err != OK)
+                return err;
 
-                r_token.type = TK_BRACKET_CLOSE;
-                index++;
-                return OK;
-            }
-            case ':': {
+            c = _peek();
+            if (c != ':')
+                return _unexpected(c, "Expected ':'");
+            ptr++;
+            if (_peek() == 0)
+                return _error("Expected '}'");
+
+            Variant v;
+            err = parse_value(v);
+            if (err != OK)
+                return err;
+            r_object[Variant(key)] = eastl::move(v);
 
-                r_token.type = TK_COLON;
-                index++;
+            c = _peek();
+            if (c == '}') {
+                ptr++;
                 return OK;
             }
-            case ',': {
+            if (c == 0)
+                return _error("Expected '}'");
+            if (c != ',')
+                return _unexpected(c, "Expected '}' or ','");
+            ptr++;
+            c = _peek();
+        }
+    }
 
-                r_token.type = TK_COMMA;
-                index++;
-                return OK;
+public:
+    Error parse_value(Variant &r_value) {
+        const char c = _peek();
+        switch (c) {
+            case '{': {
+                ptr++;
+                Dictionary d;
+                Error err = _parse_object(d);
+                r_value = eastl::move(d);
+                return err;
+            }
+            case '[': {
+                ptr++;
+                Array a;
+                Error err = _parse_array(a);
+                r_value = eastl::move(a);
+                return err;
             }
             case '"': {
+                ptr++;
+                String str;
+                Error err = _parse_string(str);
+                r_value = Variant(str);
+                return err;
+            }
+            case 0: return _error("Expected value, got EOF.");
+            case '}': return _error("Expected value, got '}'.");
+            case ']': return _error("Expected value, got ']'.");
+            case ':': return _error("Expected value, got ':'.");
+            case ',': return _error("Expected value, got ','.");
+            default: break;
+        }
 
-                index++;
-                UIString str;
-                while (true) {
-                    if (p_str[index] == nullptr) {
-                        r_err_str = "Unterminated String";
-                        return ERR_PARSE_ERROR;
-                    } else if (p_str[index] == '"') {
-                        index++;
-                        break;
-                    } else if (p_str[index] == '\\') {
-                        //escaped characters...
-                        index++;
-                        CharType next = p_str[index];
-                        if (next == nullptr) {
-                            r_err_str = "Unterminated String";
-                            return ERR_PARSE_ERROR;
-                        }
-                        CharType res = 0;
-
-                        switch (next.toLatin1()) {
-
-                            case 'b': res = 8; break;
-                            case 't': res = 9; break;
-                            case 'n': res = 10; break;
-                            case 'f': res = 12; break;
-                            case 'r': res = 13; break;
-                            case 'u': {
-                                //hexnumbarh - oct is deprecated
-                                uint16_t accval=0;
-                                for (int j = 0; j < 4; j++) {
-                                    CharType c = p_str[index + j + 1];
-                                    if (c == nullptr) {
-                                        r_err_str = "Unterminated String";
-                                        return ERR_PARSE_ERROR;
-                                    }
-                                    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) {
-
-                                        r_err_str = "Malformed hex constant in string";
-                                        return ERR_PARSE_ERROR;
-                                    }
-                                    uint16_t v;
-                                    if (c >= '0' && c <= '9') {
-                                        v = c.digitValue();
-                                    } else if (c >= 'a' && c <= 'f') {
-                                        v = c.toLatin1() - 'a';
-                                        v += 10;
-                                    } else if (c >= 'A' && c <= 'F') {
-                                        v = c.toLatin1() - 'A';
-                                        v += 10;
-                                    } else {
-                                        ERR_PRINT("BUG");
-                                        v = 0;
-                                    }
-
-                                    accval <<= 4;
-                                    accval |= v;
-                                }
-                                res = QChar(accval);
-                                index += 4; //will add at the end anyway
-
-                            } break;
-                            //case '\"': res='\"'; break;
-                            //case '\\': res='\\'; break;
-                            //case '/': res='/'; break;
-                            default: {
-                                res = next;
-                                //r_err_str="Invalid escape sequence";
-                                //return ERR_PARSE_ERROR;
-                            } break;
-                        }
-
-                        str += res;
-
-                    } else {
-                        if (p_str[index] == '\n')
-                            line++;
-                        str += p_str[index];
-                    }
-                    index++;
-                }
-
-                r_token.type = TK_STRING;
-                r_token.value = Variant(StringUtils::to_utf8(str));
-                return OK;
+        if (c == '-' || (c >= '0' && c <= '9'))
+            return _parse_number(r_value);
 
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            const char *begin = ptr;
+            while (ptr < end && ((*ptr >= 'a' && *ptr <= 'z') || (*ptr >= 'A' && *ptr <= 'Z'))) {
+                ptr++;
+            }
+            const StringView id(begin, ptr - begin);
+            if (id == "true") {
+                r_value = true;
+            } else if (id == "false") {
+                r_value = false;
+            } else if (id == "null") {
+                r_value = Variant();
+            } else {
+                err_str = "Expected 'true','false' or 'null', got '" + String(id) + "'.";
+                return ERR_PARSE_ERROR;
             }
-            default: {
+            return OK;
+        }
 
-                if (p_str[index] <= 32) {
-                    index++;
-                    break;
-                }
+        return _error("Unexpected character.");
+    }
 
-                if (p_str[index] == '-' || (p_str[index] >= '0' && p_str[index] <= '9')) {
-                    //a number
-                    const CharType *rptr;
-                    double number = StringUtils::to_double(&p_str[index], &rptr);
-                    index += (rptr - &p_str[index]);
-                    r_token.type = TK_NUMBER;
-                    r_token.value = number;
-                    return OK;
+    JSONParser(StringView p_json, int &r_line, String &r_err_str) :
+            ptr(p_json.data()),
+            end(p_json.data() + p_json.size()),
+            line(r_line),
+            err_str(r_err_str) {}
+};
 
-                } else if ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
+} // namespace
 
-                    UIString id;
+/* JSONWriter */
 
-                    while ((p_str[index] >= 'A' && p_str[index] <= 'Z') || (p_str[index] >= 'a' && p_str[index] <= 'z')) {
+void JSONWriter::_write_indent(int p_level) {
 
-                        id += p_str[index];
-                        index++;
-                    }
+    for (int i = 0; i < p_level; i++) {
+        buffer.append(indent);
+    }
+}
 
-                    r_token.type = TK_IDENTIFIER;
-                    r_token.value = Variant(StringUtils::to_utf8(id));
-                    return OK;
-                } else {
-                    r_err_str = "Unexpected character.";
-                    return ERR_PARSE_ERROR;
-                }
-            }
+void JSONWriter::_write_string(StringView p_str) {
+
+    // same escapes as StringUtils::json_escape
+    buffer.push_back('"');
+    const char *run = p_str.data();
+    const char *end = p_str.data() + p_str.size();
+    for (const char *c = run; c < end; c++) {
+        const char *escaped;
+        switch (*c) {
+            case '\\': escaped = "\\\\"; break;
+            case '\b': escaped = "\\b"; break;
+            case '\f': escaped = "\\f"; break;
+            case '\n': escaped = "\\n"; break;
+            case '\r': escaped = "\\r"; break;
+            case '\t': escaped = "\\t"; break;
+            case '\v': escaped = "\\v"; break;
+            case '"': escaped = "\\\""; break;
+            default: continue;
         }
+        buffer.append(run, c);
+        buffer.append(escaped);
+        run = c + 1;
     }
-
-    return ERR_PARSE_ERROR;
+    buffer.append(run, end);
+    buffer.push_back('"');
 }
 
-Error JSON::_parse_value(Variant &value, Token &token, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
-
-    if (token.type == TK_CURLY_BRACKET_OPEN) {
-
-        Dictionary d;
-        Error err = _parse_object(d, p_str, index, p_len, line, r_err_str);
-        if (err)
-            return err;
-        value = d;
-        return OK;
-    } else if (token.type == TK_BRACKET_OPEN) {
-
-        Array a;
-        Error err = _parse_array(a, p_str, index, p_len, line, r_err_str);
-        if (err)
-            return err;
-        value = a;
-        return OK;
+void JSONWriter::_write_array(const Array &p_array, int p_level) {
 
-    } else if (token.type == TK_IDENTIFIER) {
-
-        String id = token.value.as<String>();
-        if (id == "true")
-            value = true;
-        else if (id == "false")
-            value = false;
-        else if (id == "null")
-            value = Variant();
-        else {
-            r_err_str = "Expected 'true','false' or 'null', got '" + id + "'.";
-            return ERR_PARSE_ERROR;
+    buffer.push_back('[');
+    if (!indent.empty())
+        buffer.push_back('\n');
+    for (int i = 0; i < p_array.size(); i++) {
+        if (i > 0) {
+            buffer.push_back(',');
+            if (!indent.empty())
+                buffer.push_back('\n');
         }
-        return OK;
-
-    } else if (token.type == TK_NUMBER) {
-
-        value = token.value;
-        return OK;
-    } else if (token.type == TK_STRING) {
-
-        value = token.value;
-        return OK;
-    } else {
-        r_err_str = "Expected value, got " + String(tk_name[token.type]) + ".";
-        return ERR_PARSE_ERROR;
+        _write_indent(p_level + 1);
+        _write_variant(p_array[i], p_level + 1);
     }
+    if (!indent.empty())
+        buffer.push_back('\n');
+    _write_indent(p_level);
+    buffer.push_back(']');
 }
 
-Error JSON::_parse_array(Array &array, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
-
-    Token token;
-    bool need_comma = false;
+void JSONWriter::_write_dictionary(const Dictionary &p_dictionary, int p_level) {
 
-    while (index < p_len) {
+    const char *colon = indent.empty() ? ":" : ": ";
+    buffer.push_back('{');
+    if (!indent.empty())
+        buffer.push_back('\n');
 
-        Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-        if (err != OK)
-            return err;
-
-        if (token.type == TK_BRACKET_CLOSE) {
-
-            return OK;
+    auto write_entry = [&](const Variant &p_key, const Variant &p_value, bool p_first) {
+        if (!p_first) {
+            buffer.push_back(',');
+            if (!indent.empty())
+                buffer.push_back('\n');
         }
+        _write_indent(p_level + 1);
+        _write_variant(p_key, p_level + 1);
+        buffer.append(colon);
+        _write_variant(p_value, p_level + 1);
+    };
+
+    if (sort_keys) {
+        Vector<Variant> keys(p_dictionary.get_key_list());
+        eastl::sort(keys.begin(), keys.end());
+        for (size_t i = 0; i < keys.size(); i++) {
+            write_entry(keys[i], p_dictionary[keys[i]], i == 0);
+        }
+    } else {
+        bool first = true;
+        for (const Variant *key = p_dictionary.next(); key; key = p_dictionary.next(key)) {
+            write_entry(*key, p_dictionary[*key], first);
+            first = false;
+        }
+    }
 
-        if (need_comma) {
-
-            if (token.type != TK_COMMA) {
+    if (!indent.empty())
+        buffer.push_back('\n');
+    _write_indent(p_level);
+    buffer.push_back('}');
+}
 
-                r_err_str = "Expected ','";
-                return ERR_PARSE_ERROR;
-            } else {
-                need_comma = false;
-                continue;
-            }
-        }
+void JSONWriter::_write_variant(const Variant &p_var, int p_level) {
 
-        Variant v;
-        err = _parse_value(v, token, p_str, index, p_len, line, r_err_str);
-        if (err)
-            return err;
+    switch (p_var.get_type()) {
 
-        array.push_back(v);
-        need_comma = true;
+        case VariantType::NIL: buffer.append("null"); break;
+        case VariantType::BOOL: buffer.append(p_var.as<bool>() ? "true" : "false"); break;
+        case VariantType::INT: buffer.append_sprintf("%lld", (long long)p_var.as<int64_t>()); break;
+        case VariantType::FLOAT: buffer.append(rtos(p_var.as<float>())); break;
+        case VariantType::ARRAY: _write_array(p_var.as<Array>(), p_level); break;
+        case VariantType::POOL_INT_ARRAY:
+        case VariantType::POOL_REAL_ARRAY:
+        case VariantType::POOL_STRING_ARRAY: _write_array(p_var.as<Array>(), p_level); break;
+        case VariantType::DICTIONARY: _write_dictionary(p_var.as<Dictionary>(), p_level); break;
+        default: _write_string(p_var.as<String>()); break;
     }
-
-    r_err_str = "Expected ']'";
-    return ERR_PARSE_ERROR;
 }
 
-Error JSON::_parse_object(Dictionary &object, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str) {
+void JSONWriter::_begin_item() {
 
-    bool at_key = true;
-    String key;
-    Token token;
-    bool need_comma = false;
+    if (levels.empty())
+        return;
+    Level &level = levels.back();
+    if (level.is_object) {
+        ERR_FAIL_COND_MSG(!level.after_key, "JSONWriter: a value inside an object needs a key.");
+        level.after_key = false;
+        return;
+    }
+    if (level.has_items) {
+        buffer.push_back(',');
+        if (!indent.empty())
+            buffer.push_back('\n');
+    }
+    level.has_items = true;
+    _write_indent(levels.size());
+}
 
-    while (index < p_len) {
+void JSONWriter::clear() {
 
-        if (at_key) {
+    buffer.clear();
+    levels.clear();
+}
 
-            Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-            if (err != OK)
-                return err;
+String JSONWriter::take_text() {
 
-            if (token.type == TK_CURLY_BRACKET_CLOSE) {
+    String text(eastl::move(buffer));
+    clear();
+    return text;
+}
 
-                return OK;
-            }
+void JSONWriter::begin_object() {
 
-            if (need_comma) {
+    _begin_item();
+    buffer.push_back('{');
+    if (!indent.empty())
+        buffer.push_back('\n');
+    levels.push_back(Level { true });
+}
 
-                if (token.type != TK_COMMA) {
+void JSONWriter::end_object() {
 
-                    r_err_str = "Expected '}' or ','";
-                    return ERR_PARSE_ERROR;
-                } else {
-                    need_comma = false;
-                    continue;
-                }
-            }
+    ERR_FAIL_COND_MSG(levels.empty() || !levels.back().is_object, "JSONWriter: end_object() without begin_object().");
+    levels.pop_back();
+    if (!indent.empty())
+        buffer.push_back('\n');
+    _write_indent(levels.size());
+    buffer.push_back('}');
+}
 
-            if (token.type != TK_STRING) {
+void JSONWriter::begin_array() {
 
-                r_err_str = "Expected key";
-                return ERR_PARSE_ERROR;
-            }
+    _begin_item();
+    buffer.push_back('[');
+    if (!indent.empty())
+        buffer.push_back('\n');
+    levels.push_back(Level { false });
+}
 
-            key = token.value.as<String>();
-            err = _get_token(p_str, index, p_len, token, line, r_err_str);
-            if (err != OK)
-                return err;
-            if (token.type != TK_COLON) {
+void JSONWriter::end_array() {
 
-                r_err_str = "Expected ':'";
-                return ERR_PARSE_ERROR;
-            }
-            at_key = false;
-        } else {
+    ERR_FAIL_COND_MSG(levels.empty() || levels.back().is_object, "JSONWriter: end_array() without begin_array().");
+    levels.pop_back();
+    if (!indent.empty())
+        buffer.push_back('\n');
+    _write_indent(levels.size());
+    buffer.push_back(']');
+}
 
-            Error err = _get_token(p_str, index, p_len, token, line, r_err_str);
-            if (err != OK)
-                return err;
+void JSONWriter::key(StringView p_key) {
 
-            Variant v;
-            err = _parse_value(v, token, p_str, index, p_len, line, r_err_str);
-            if (err)
-                return err;
-            object[Variant(key)] = Variant(v);
-            need_comma = true;
-            at_key = true;
-        }
+    ERR_FAIL_COND_MSG(levels.empty() || !levels.back().is_object, "JSONWriter: keys are only valid inside an object.");
+    Level &level = levels.back();
+    if (level.has_items) {
+        buffer.push_back(',');
+        if (!indent.empty())
+            buffer.push_back('\n');
     }
+    level.has_items = true;
+    level.after_key = true;
+    _write_indent(levels.size());
+    _write_string(p_key);
+    buffer.append(indent.empty() ? ":" : ": ");
+}
 
-    r_err_str = "Expected '}'";
-    return ERR_PARSE_ERROR;
+void JSONWriter::value(const Variant &p_value) {
+
+    _begin_item();
+    _write_variant(p_value, levels.size());
 }
 
-Error JSON::parse(const String &p_json, Variant &r_ret, String &r_err_str, int &r_err_line) {
-    UIString enc(UIString::fromUtf8(p_json.c_str()));
-    const CharType *str = enc.constData();
-    int idx = 0;
-    int len = p_json.length();
-    Token token;
-    r_err_line = 0;
+JSONWriter::JSONWriter(StringView p_indent, bool p_sort_keys) :
+        indent(p_indent),
+        sort_keys(p_sort_keys) {
+}
 
-    Error err = _get_token(str, idx, len, token, r_err_line, r_err_str);
-    if (err)
-        return err;
+/* JSON */
 
-    err = _parse_value(r_ret, token, str, idx, len, r_err_line, r_err_str);
+String JSON::print(const Variant &p_var, StringView p_indent, bool p_sort_keys) {
+
+    JSONWriter writer(p_indent, p_sort_keys);
+    writer.value(p_var);
+    return writer.take_text();
+}
 
-    return err;
+Error JSON::parse(StringView p_json, Variant &r_ret, String &r_err_str, int &r_err_line) {
+
+    r_err_line = 0;
+    JSONParser parser(p_json, r_err_line, r_err_str);
+    return parser.parse_value(r_ret);
 }
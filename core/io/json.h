@@ -33,47 +33,55 @@
 #include "core/variant.h"
 #include "core/string.h"
 #include "core/error_list.h"
+#include "core/vector.h"
 
-class GODOT_EXPORT JSON {
-
-    enum TokenType {
-        TK_CURLY_BRACKET_OPEN,
-        TK_CURLY_BRACKET_CLOSE,
-        TK_BRACKET_OPEN,
-        TK_BRACKET_CLOSE,
-        TK_IDENTIFIER,
-        TK_STRING,
-        TK_NUMBER,
-        TK_COLON,
-        TK_COMMA,
-        TK_EOF,
-        TK_MAX
-    };
-
-    enum Expecting {
+/**
+ * Writes JSON text into a buffer that is kept between uses, so producing a message does not allocate once the
+ * buffer has grown to its typical size. Values can be written whole with value(), or the document can be
+ * streamed with the begin/end and key calls without first building a Dictionary or Array.
+ * The output matches JSON::print for the same indent and key sorting.
+ */
+class GODOT_EXPORT JSONWriter {
 
-        EXPECT_OBJECT,
-        EXPECT_OBJECT_KEY,
-        EXPECT_COLON,
-        EXPECT_OBJECT_VALUE,
+    struct Level {
+        bool is_object;
+        bool has_items = false;
+        bool after_key = false;
     };
 
-    struct Token {
+    String buffer;
+    String indent;
+    Vector<Level> levels;
+    bool sort_keys;
 
-        TokenType type;
-        Variant value;
-    };
+    void _write_indent(int p_level);
+    void _begin_item();
+    void _write_string(StringView p_str);
+    void _write_variant(const Variant &p_var, int p_level);
+    void _write_array(const Array &p_array, int p_level);
+    void _write_dictionary(const Dictionary &p_dictionary, int p_level);
 
-    static const char *tk_name[TK_MAX];
+public:
+    //! Empties the buffer, keeping its memory for the next document.
+    void clear();
+    const String &get_text() const { return buffer; }
+    //! Moves the text out, the next document starts with an empty buffer.
+    String take_text();
 
-    static String _print_var(const Variant &p_var, StringView p_indent, int p_cur_indent, bool p_sort_keys);
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+    //! Key of the next value, only valid inside an object.
+    void key(StringView p_key);
+    void value(const Variant &p_value);
 
-    static Error _get_token(const CharType *p_str, int &index, int p_len, Token &r_token, int &line, String &r_err_str);
-    static Error _parse_value(Variant &value, Token &token, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
-    static Error _parse_array(Array &array, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
-    static Error _parse_object(Dictionary &object, const CharType *p_str, int &index, int p_len, int &line, String &r_err_str);
+    explicit JSONWriter(StringView p_indent = {}, bool p_sort_keys = true);
+};
 
+class GODOT_EXPORT JSON {
 public:
     static String print(const Variant &p_var, StringView p_indent = {}, bool p_sort_keys = true);
-    static Error parse(const String &p_json, Variant &r_ret, String &r_err_str, int &r_err_line);
+    //! Parses UTF-8 text directly, numbers are returned as floats.
+    static Error parse(StringView p_json, Variant &r_ret, String &r_err_str, int &r_err_line);
 };
@@ -566,11 +566,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
             if (count) {
                 data.resize(count);
-                PoolVector<uint8_t>::Write w = data.write();
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i] = buf[i];
-                }
+                memcpy(data.write().ptr(), buf, count);
             }
 
             r_variant = data;
@@ -594,13 +590,9 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
             PoolVector<int> data;
 
             if (count) {
-                //const int*rbuf=(const int*)buf;
+                // the encoded elements are little endian, same as every platform we run on
                 data.resize(count);
-                PoolVector<int>::Write w = data.write();
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i] = decode_uint32(&buf[i * 4]);
-                }
+                memcpy(data.write().ptr(), buf, count * 4);
             }
             r_variant = Variant(data);
             if (r_len) {
@@ -620,13 +612,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
             PoolVector<float> data;
 
             if (count) {
-                //const float*rbuf=(const float*)buf;
                 data.resize(count);
-                PoolVector<float>::Write w = data.write();
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i] = decode_float(&buf[i * 4]);
-                }
+                memcpy(data.write().ptr(), buf, count * 4);
             }
             r_variant = data;
 
@@ -678,13 +665,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
             if (count) {
                 varray.resize(count);
-                PoolVector<Vector2>::Write w = varray.write();
-
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i].x = decode_float(buf + i * 4 * 2 + 4 * 0);
-                    w[i].y = decode_float(buf + i * 4 * 2 + 4 * 1);
-                }
+                memcpy(varray.write().ptr(), buf, count * 4 * 2);
 
                 int adv = 4 * 2 * count;
 
@@ -713,14 +694,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
             if (count) {
                 varray.resize(count);
-                PoolVector<Vector3>::Write w = varray.write();
-
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i].x = decode_float(buf + i * 4 * 3 + 4 * 0);
-                    w[i].y = decode_float(buf + i * 4 * 3 + 4 * 1);
-                    w[i].z = decode_float(buf + i * 4 * 3 + 4 * 2);
-                }
+                memcpy(varray.write().ptr(), buf, count * 4 * 3);
 
                 int adv = 4 * 3 * count;
 
@@ -749,15 +723,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
             if (count) {
                 carray.resize(count);
-                PoolVector<Color>::Write w = carray.write();
-
-                for (int32_t i = 0; i < count; i++) {
-
-                    w[i].r = decode_float(buf + i * 4 * 4 + 4 * 0);
-                    w[i].g = decode_float(buf + i * 4 * 4 + 4 * 1);
-                    w[i].b = decode_float(buf + i * 4 * 4 + 4 * 2);
-                    w[i].a = decode_float(buf + i * 4 * 4 + 4 * 3);
-                }
+                memcpy(carray.write().ptr(), buf, count * 4 * 4);
 
                 int adv = 4 * 4 * count;
 
@@ -813,7 +779,7 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
         } break;
         case VariantType::FLOAT: {
 
-            double d = p_variant.as<float>();
+            double d = p_variant.as<double>();
             float f = d;
             if (double(f) != d) {
                 flags |= ENCODE_FLAG_64; //always encode real as double
@@ -1297,21 +1263,7 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
             for (int i = 0; i < len; i++) {
 
-                String utf8(data.get(i));
-
-                if (buf) {
-                    encode_uint32(utf8.length(), buf);
-                    buf += 4;
-                    memcpy(buf, utf8.data(), utf8.length());
-                    buf += utf8.length();
-                }
-
-                r_len += 4 + utf8.length() + 1;
-                while (r_len % 4) {
-                    r_len++; //pad
-                    if (buf)
-                        *(buf++) = 0;
-                }
+                _encode_string(data.get(i), buf, r_len);
             }
 
         } break;
@@ -1406,3 +1358,812 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
     return OK;
 }
+
+namespace {
+
+// Output of the single pass encoders. Math types and packed arrays are stored with their in-memory
+// (little endian) layout, so they are copied in bulk.
+struct VariantArena {
+    Vector<uint8_t> &data;
+
+    explicit VariantArena(Vector<uint8_t> &p_data) :
+            data(p_data) {}
+
+    uint8_t *grow(size_t p_size) {
+        const size_t ofs = data.size();
+        data.resize(ofs + p_size);
+        return data.data() + ofs;
+    }
+    void put_u8(uint8_t p_value) { data.push_back(p_value); }
+    void put_u32(uint32_t p_value) { encode_uint32(p_value, grow(4)); }
+    void put_u64(uint64_t p_value) { encode_uint64(p_value, grow(8)); }
+    void put_bytes(const void *p_src, size_t p_size) {
+        if (p_size) {
+            memcpy(grow(p_size), p_src, p_size);
+        }
+    }
+    template <class T, int N>
+    void put_floats(const T &p_value) {
+        static_assert(sizeof(T) == N * sizeof(float), "Type must consist of N floats.");
+        put_bytes(&p_value, sizeof(T));
+    }
+    void put_varuint(uint64_t p_value) {
+        while (p_value >= 0x80) {
+            data.push_back(uint8_t(p_value) | 0x80);
+            p_value >>= 7;
+        }
+        data.push_back(uint8_t(p_value));
+    }
+    void put_varint(int64_t p_value) { put_varuint((uint64_t(p_value) << 1) ^ uint64_t(p_value >> 63)); }
+
+    // encode_variant layout: 32 bit length, data, zero padding to 4 bytes
+    void put_padded_string(StringView p_string) {
+        put_u32(p_string.size());
+        put_bytes(p_string.data(), p_string.size());
+        if (p_string.size() % 4) {
+            grow(4 - p_string.size() % 4); // resize zero fills
+        }
+    }
+    void put_compact_string(StringView p_string) {
+        put_varuint(p_string.size());
+        put_bytes(p_string.data(), p_string.size());
+    }
+};
+
+template <class T>
+void _put_pool_array(VariantArena &p_arena, const PoolVector<T> &p_array, bool p_compact) {
+
+    const int count = p_array.size();
+    if (p_compact) {
+        p_arena.put_varuint(count);
+    } else {
+        p_arena.put_u32(count);
+    }
+    if (count) {
+        p_arena.put_bytes(p_array.read().ptr(), count * sizeof(T));
+    }
+}
+
+// Object that can't be encoded (freed, or sent by the debugger while breaking) is sent as null.
+bool _is_valid_object(const Variant &p_variant) {
+#ifdef DEBUG_ENABLED
+    Object *obj = p_variant.as<Object *>();
+    return obj && gObjectDB().instance_validate(obj);
+#else
+    return true;
+#endif
+}
+
+Error _encode_arena(const Variant &p_variant, VariantArena &p_arena, bool p_full_objects) {
+
+    const VariantType type = p_variant.get_type();
+    switch (type) {
+
+        case VariantType::NIL:
+        case VariantType::_RID: {
+            p_arena.put_u32(uint32_t(type));
+        } break;
+        case VariantType::BOOL: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_u32(p_variant.as<bool>());
+        } break;
+        case VariantType::INT: {
+            int64_t val = p_variant.as<int64_t>();
+            if (val > (int64_t)INT_MAX || val < (int64_t)INT_MIN) {
+                p_arena.put_u32(uint32_t(type) | ENCODE_FLAG_64);
+                p_arena.put_u64(val);
+            } else {
+                p_arena.put_u32(uint32_t(type));
+                p_arena.put_u32(uint32_t(int32_t(val)));
+            }
+        } break;
+        case VariantType::FLOAT: {
+            double d = p_variant.as<double>();
+            float f = d;
+            if (double(f) != d) {
+                p_arena.put_u32(uint32_t(type) | ENCODE_FLAG_64);
+                encode_double(d, p_arena.grow(8));
+            } else {
+                p_arena.put_u32(uint32_t(type));
+                p_arena.put_floats<float, 1>(f);
+            }
+        } break;
+        case VariantType::STRING: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_padded_string(p_variant.as<String>());
+        } break;
+        case VariantType::STRING_NAME: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_padded_string(p_variant.as<StringName>());
+        } break;
+
+        // math types
+        case VariantType::VECTOR2: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Vector2, 2>(p_variant.as<Vector2>());
+        } break;
+        case VariantType::RECT2: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Rect2, 4>(p_variant.as<Rect2>());
+        } break;
+        case VariantType::VECTOR3: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Vector3, 3>(p_variant.as<Vector3>());
+        } break;
+        case VariantType::TRANSFORM2D: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Transform2D, 6>(p_variant.as<Transform2D>());
+        } break;
+        case VariantType::PLANE: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Plane, 4>(p_variant.as<Plane>());
+        } break;
+        case VariantType::QUAT: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Quat, 4>(p_variant.as<Quat>());
+        } break;
+        case VariantType::AABB: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<AABB, 6>(p_variant.as<AABB>());
+        } break;
+        case VariantType::BASIS: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Basis, 9>(p_variant.as<Basis>());
+        } break;
+        case VariantType::TRANSFORM: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Transform, 12>(p_variant.as<Transform>());
+        } break;
+        case VariantType::COLOR: {
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_floats<Color, 4>(p_variant.as<Color>());
+        } break;
+
+        case VariantType::NODE_PATH: {
+            NodePath np = p_variant.as<NodePath>();
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_u32(uint32_t(np.get_name_count()) | 0x80000000); //for compatibility with the old format
+            p_arena.put_u32(np.get_subname_count());
+            p_arena.put_u32(np.is_absolute() ? 1 : 0);
+            for (int i = 0; i < np.get_name_count(); i++) {
+                p_arena.put_padded_string(np.get_name(i));
+            }
+            for (int i = 0; i < np.get_subname_count(); i++) {
+                p_arena.put_padded_string(np.get_subname(i));
+            }
+        } break;
+        case VariantType::OBJECT: {
+            if (!_is_valid_object(p_variant)) {
+                p_arena.put_u32(uint32_t(VariantType::NIL));
+                break;
+            }
+            Object *obj = p_variant.as<Object *>();
+            if (!p_full_objects) {
+                p_arena.put_u32(uint32_t(type) | ENCODE_FLAG_OBJECT_AS_ID);
+                p_arena.put_u64(obj ? obj->get_instance_id() : ObjectID(0ULL));
+                break;
+            }
+            p_arena.put_u32(uint32_t(type));
+            if (!obj) {
+                p_arena.put_u32(0);
+                break;
+            }
+            p_arena.put_padded_string(StringView(obj->get_class()));
+
+            Vector<PropertyInfo> props;
+            obj->get_property_list(&props);
+            // the count is patched in once the stored properties are known
+            const size_t count_ofs = p_arena.data.size();
+            p_arena.put_u32(0);
+            uint32_t pc = 0;
+            for (const PropertyInfo &E : props) {
+                if (!(E.usage & PROPERTY_USAGE_STORAGE))
+                    continue;
+                p_arena.put_padded_string(E.name);
+                Error err = _encode_arena(obj->get(E.name), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+                pc++;
+            }
+            encode_uint32(pc, &p_arena.data[count_ofs]);
+        } break;
+        case VariantType::DICTIONARY: {
+            Dictionary d = p_variant.as<Dictionary>();
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_u32(uint32_t(d.size()));
+            for (const Variant &E : d.get_key_list()) {
+                const Variant *v = d.getptr(E);
+                Error err = _encode_arena(v ? E : Variant("[Deleted Object]"), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+                err = _encode_arena(v ? *v : Variant(), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+        case VariantType::ARRAY: {
+            Array arr = p_variant.as<Array>();
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_u32(uint32_t(arr.size()));
+            for (int i = 0; i < arr.size(); i++) {
+                Error err = _encode_arena(arr.get(i), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+
+        // arrays
+        case VariantType::POOL_BYTE_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            PoolVector<uint8_t> data = p_variant.as<PoolVector<uint8_t>>();
+            _put_pool_array(p_arena, data, false);
+            if (data.size() % 4) {
+                p_arena.grow(4 - data.size() % 4);
+            }
+        } break;
+        case VariantType::POOL_INT_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            _put_pool_array(p_arena, p_variant.as<PoolVector<int>>(), false);
+        } break;
+        case VariantType::POOL_REAL_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            _put_pool_array(p_arena, p_variant.as<PoolVector<real_t>>(), false);
+        } break;
+        case VariantType::POOL_STRING_ARRAY: {
+            PoolVector<String> data = p_variant.as<PoolVector<String>>();
+            p_arena.put_u32(uint32_t(type));
+            p_arena.put_u32(data.size());
+            PoolVector<String>::Read r = data.read();
+            for (int i = 0; i < data.size(); i++) {
+                p_arena.put_padded_string(r[i]);
+            }
+        } break;
+        case VariantType::POOL_VECTOR2_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Vector2>>(), false);
+        } break;
+        case VariantType::POOL_VECTOR3_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Vector3>>(), false);
+        } break;
+        case VariantType::POOL_COLOR_ARRAY: {
+            p_arena.put_u32(uint32_t(type));
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Color>>(), false);
+        } break;
+        default: {
+            ERR_FAIL_V(ERR_BUG);
+        }
+    }
+    return OK;
+}
+
+#define COMPACT_TYPE_MASK 0x1F
+// BOOL value, 64 bit FLOAT, OBJECT as id, absolute NODE_PATH
+#define COMPACT_FLAG 0x20
+
+Error _encode_compact(const Variant &p_variant, VariantArena &p_arena, bool p_full_objects) {
+
+    const VariantType type = p_variant.get_type();
+    const uint8_t tag = uint8_t(type);
+    switch (type) {
+
+        case VariantType::NIL:
+        case VariantType::_RID: {
+            p_arena.put_u8(tag);
+        } break;
+        case VariantType::BOOL: {
+            p_arena.put_u8(tag | (p_variant.as<bool>() ? COMPACT_FLAG : 0));
+        } break;
+        case VariantType::INT: {
+            p_arena.put_u8(tag);
+            p_arena.put_varint(p_variant.as<int64_t>());
+        } break;
+        case VariantType::FLOAT: {
+            double d = p_variant.as<double>();
+            float f = d;
+            if (double(f) != d) {
+                p_arena.put_u8(tag | COMPACT_FLAG);
+                encode_double(d, p_arena.grow(8));
+            } else {
+                p_arena.put_u8(tag);
+                p_arena.put_floats<float, 1>(f);
+            }
+        } break;
+        case VariantType::STRING: {
+            p_arena.put_u8(tag);
+            p_arena.put_compact_string(p_variant.as<String>());
+        } break;
+        case VariantType::STRING_NAME: {
+            p_arena.put_u8(tag);
+            p_arena.put_compact_string(p_variant.as<StringName>());
+        } break;
+
+        // math types
+        case VariantType::VECTOR2: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Vector2, 2>(p_variant.as<Vector2>());
+        } break;
+        case VariantType::RECT2: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Rect2, 4>(p_variant.as<Rect2>());
+        } break;
+        case VariantType::VECTOR3: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Vector3, 3>(p_variant.as<Vector3>());
+        } break;
+        case VariantType::TRANSFORM2D: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Transform2D, 6>(p_variant.as<Transform2D>());
+        } break;
+        case VariantType::PLANE: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Plane, 4>(p_variant.as<Plane>());
+        } break;
+        case VariantType::QUAT: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Quat, 4>(p_variant.as<Quat>());
+        } break;
+        case VariantType::AABB: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<AABB, 6>(p_variant.as<AABB>());
+        } break;
+        case VariantType::BASIS: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Basis, 9>(p_variant.as<Basis>());
+        } break;
+        case VariantType::TRANSFORM: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Transform, 12>(p_variant.as<Transform>());
+        } break;
+        case VariantType::COLOR: {
+            p_arena.put_u8(tag);
+            p_arena.put_floats<Color, 4>(p_variant.as<Color>());
+        } break;
+
+        case VariantType::NODE_PATH: {
+            NodePath np = p_variant.as<NodePath>();
+            p_arena.put_u8(tag | (np.is_absolute() ? COMPACT_FLAG : 0));
+            p_arena.put_varuint(np.get_name_count());
+            p_arena.put_varuint(np.get_subname_count());
+            for (int i = 0; i < np.get_name_count(); i++) {
+                p_arena.put_compact_string(np.get_name(i));
+            }
+            for (int i = 0; i < np.get_subname_count(); i++) {
+                p_arena.put_compact_string(np.get_subname(i));
+            }
+        } break;
+        case VariantType::OBJECT: {
+            if (!_is_valid_object(p_variant)) {
+                p_arena.put_u8(uint8_t(VariantType::NIL));
+                break;
+            }
+            Object *obj = p_variant.as<Object *>();
+            if (!p_full_objects) {
+                p_arena.put_u8(tag | COMPACT_FLAG);
+                p_arena.put_varuint(obj ? uint64_t(obj->get_instance_id()) : 0);
+                break;
+            }
+            p_arena.put_u8(tag);
+            if (!obj) {
+                p_arena.put_varuint(0);
+                break;
+            }
+            p_arena.put_compact_string(StringView(obj->get_class()));
+
+            Vector<PropertyInfo> props;
+            obj->get_property_list(&props);
+            int pc = 0;
+            for (const PropertyInfo &E : props) {
+                if (E.usage & PROPERTY_USAGE_STORAGE)
+                    pc++;
+            }
+            p_arena.put_varuint(pc);
+            for (const PropertyInfo &E : props) {
+                if (!(E.usage & PROPERTY_USAGE_STORAGE))
+                    continue;
+                p_arena.put_compact_string(E.name);
+                Error err = _encode_compact(obj->get(E.name), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+        case VariantType::DICTIONARY: {
+            Dictionary d = p_variant.as<Dictionary>();
+            p_arena.put_u8(tag);
+            p_arena.put_varuint(d.size());
+            for (const Variant &E : d.get_key_list()) {
+                const Variant *v = d.getptr(E);
+                Error err = _encode_compact(v ? E : Variant("[Deleted Object]"), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+                err = _encode_compact(v ? *v : Variant(), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+        case VariantType::ARRAY: {
+            Array arr = p_variant.as<Array>();
+            p_arena.put_u8(tag);
+            p_arena.put_varuint(arr.size());
+            for (int i = 0; i < arr.size(); i++) {
+                Error err = _encode_compact(arr.get(i), p_arena, p_full_objects);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+
+        // arrays
+        case VariantType::POOL_BYTE_ARRAY: {
+            p_arena.put_u8(tag);
+            _put_pool_array(p_arena, p_variant.as<PoolVector<uint8_t>>(), true);
+        } break;
+        case VariantType::POOL_INT_ARRAY: {
+            PoolVector<int> data = p_variant.as<PoolVector<int>>();
+            p_arena.put_u8(tag);
+            p_arena.put_varuint(data.size());
+            PoolVector<int>::Read r = data.read();
+            for (int i = 0; i < data.size(); i++) {
+                p_arena.put_varint(r[i]);
+            }
+        } break;
+        case VariantType::POOL_REAL_ARRAY: {
+            p_arena.put_u8(tag);
+            _put_pool_array(p_arena, p_variant.as<PoolVector<real_t>>(), true);
+        } break;
+        case VariantType::POOL_STRING_ARRAY: {
+            PoolVector<String> data = p_variant.as<PoolVector<String>>();
+            p_arena.put_u8(tag);
+            p_arena.put_varuint(data.size());
+            PoolVector<String>::Read r = data.read();
+            for (int i = 0; i < data.size(); i++) {
+                p_arena.put_compact_string(r[i]);
+            }
+        } break;
+        case VariantType::POOL_VECTOR2_ARRAY: {
+            p_arena.put_u8(tag);
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Vector2>>(), true);
+        } break;
+        case VariantType::POOL_VECTOR3_ARRAY: {
+            p_arena.put_u8(tag);
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Vector3>>(), true);
+        } break;
+        case VariantType::POOL_COLOR_ARRAY: {
+            p_arena.put_u8(tag);
+            _put_pool_array(p_arena, p_variant.as<PoolVector<Color>>(), true);
+        } break;
+        default: {
+            ERR_FAIL_V(ERR_BUG);
+        }
+    }
+    return OK;
+}
+
+struct CompactReader {
+    const uint8_t *ptr;
+    const uint8_t *end;
+
+    size_t left() const { return size_t(end - ptr); }
+
+    bool read_varuint(uint64_t &r_value) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64 && ptr < end; shift += 7) {
+            const uint8_t b = *ptr++;
+            value |= uint64_t(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                r_value = value;
+                return true;
+            }
+        }
+        return false;
+    }
+    bool read_varint(int64_t &r_value) {
+        uint64_t value;
+        if (!read_varuint(value))
+            return false;
+        r_value = int64_t(value >> 1) ^ -int64_t(value & 1);
+        return true;
+    }
+    // element counts can't exceed the bytes left, which rejects absurd sizes before allocating
+    bool read_count(int &r_count, size_t p_min_element_size) {
+        uint64_t count;
+        if (!read_varuint(count) || count > INT_MAX || count * p_min_element_size > left())
+            return false;
+        r_count = int(count);
+        return true;
+    }
+    bool read_bytes(void *r_dst, size_t p_size) {
+        if (p_size > left())
+            return false;
+        memcpy(r_dst, ptr, p_size);
+        ptr += p_size;
+        return true;
+    }
+    bool read_string(String &r_string) {
+        int len;
+        if (!read_count(len, 1))
+            return false;
+        r_string.assign((const char *)ptr, len);
+        ptr += len;
+        return true;
+    }
+    template <class T>
+    bool read_floats(Variant &r_variant) {
+        T value;
+        if (!read_bytes(&value, sizeof(T)))
+            return false;
+        r_variant = value;
+        return true;
+    }
+    template <class T>
+    bool read_pool_array(Variant &r_variant) {
+        int count;
+        if (!read_count(count, sizeof(T)))
+            return false;
+        PoolVector<T> data;
+        if (count) {
+            data.resize(count);
+            read_bytes(data.write().ptr(), count * sizeof(T));
+        }
+        r_variant = Variant(data);
+        return true;
+    }
+};
+
+Error _decode_compact(Variant &r_variant, CompactReader &r, bool p_allow_objects) {
+
+    ERR_FAIL_COND_V(!r.left(), ERR_INVALID_DATA);
+    const uint8_t tag = *r.ptr++;
+    ERR_FAIL_COND_V((tag & COMPACT_TYPE_MASK) >= int(VariantType::VARIANT_MAX), ERR_INVALID_DATA);
+    const bool flag = tag & COMPACT_FLAG;
+    bool ok = true;
+
+    switch (VariantType(tag & COMPACT_TYPE_MASK)) {
+        case VariantType::NIL: {
+            r_variant = Variant();
+        } break;
+        case VariantType::_RID: {
+            r_variant = RID();
+        } break;
+        case VariantType::BOOL: {
+            r_variant = flag;
+        } break;
+        case VariantType::INT: {
+            int64_t val;
+            ok = r.read_varint(val);
+            r_variant = val;
+        } break;
+        case VariantType::FLOAT: {
+            if (flag) {
+                ok = r.left() >= 8;
+                if (ok) {
+                    r_variant = decode_double(r.ptr);
+                    r.ptr += 8;
+                }
+            } else {
+                float f;
+                ok = r.read_bytes(&f, 4);
+                r_variant = f;
+            }
+        } break;
+        case VariantType::STRING: {
+            String str;
+            ok = r.read_string(str);
+            r_variant = str;
+        } break;
+        case VariantType::STRING_NAME: {
+            String str;
+            ok = r.read_string(str);
+            r_variant = StringName(str);
+        } break;
+        case VariantType::VECTOR2: ok = r.read_floats<Vector2>(r_variant); break;
+        case VariantType::RECT2: ok = r.read_floats<Rect2>(r_variant); break;
+        case VariantType::VECTOR3: ok = r.read_floats<Vector3>(r_variant); break;
+        case VariantType::TRANSFORM2D: ok = r.read_floats<Transform2D>(r_variant); break;
+        case VariantType::PLANE: ok = r.read_floats<Plane>(r_variant); break;
+        case VariantType::QUAT: ok = r.read_floats<Quat>(r_variant); break;
+        case VariantType::AABB: ok = r.read_floats<AABB>(r_variant); break;
+        case VariantType::BASIS: ok = r.read_floats<Basis>(r_variant); break;
+        case VariantType::TRANSFORM: ok = r.read_floats<Transform>(r_variant); break;
+        case VariantType::COLOR: ok = r.read_floats<Color>(r_variant); break;
+        case VariantType::NODE_PATH: {
+            int name_count, subname_count;
+            ok = r.read_count(name_count, 1) && r.read_count(subname_count, 1);
+            Vector<StringName> names;
+            Vector<StringName> subnames;
+            String str;
+            for (int i = 0; ok && i < name_count + subname_count; i++) {
+                ok = r.read_string(str);
+                (i < name_count ? names : subnames).emplace_back(str);
+            }
+            if (ok) {
+                r_variant = NodePath(eastl::move(names), eastl::move(subnames), flag);
+            }
+        } break;
+        case VariantType::OBJECT: {
+            if (flag) {
+                uint64_t id;
+                ok = r.read_varuint(id);
+                if (!ok)
+                    break;
+                if (id == 0) {
+                    r_variant = Variant((Object *)nullptr);
+                } else {
+                    Ref<EncodedObjectAsID> obj_as_id(make_ref_counted<EncodedObjectAsID>());
+                    obj_as_id->set_object_id(ObjectID(id));
+                    r_variant = obj_as_id;
+                }
+                break;
+            }
+            ERR_FAIL_COND_V(!p_allow_objects, ERR_UNAUTHORIZED);
+            String str;
+            ok = r.read_string(str);
+            if (!ok)
+                break;
+            if (str.empty()) {
+                r_variant = Variant((Object *)nullptr);
+                break;
+            }
+            Object *obj = ClassDB::instance(StringName(str));
+            ERR_FAIL_COND_V(!obj, ERR_UNAVAILABLE);
+            // hold the reference from the start, so failing halfway doesn't leak the object
+            REF ref(object_cast<RefCounted>(obj));
+
+            int count;
+            ok = r.read_count(count, 2);
+            for (int i = 0; ok && i < count; i++) {
+                Variant value;
+                ok = r.read_string(str);
+                if (!ok)
+                    break;
+                Error err = _decode_compact(value, r, p_allow_objects);
+                if (err != OK) {
+                    if (!ref) {
+                        memdelete(obj);
+                    }
+                    return err;
+                }
+                obj->set(StringName(str), value);
+            }
+            if (!ok && !ref) {
+                memdelete(obj);
+            } else if (ok) {
+                r_variant = ref ? Variant(ref) : Variant(obj);
+            }
+        } break;
+        case VariantType::DICTIONARY: {
+            int count;
+            ok = r.read_count(count, 2);
+            Dictionary d;
+            for (int i = 0; ok && i < count; i++) {
+                Variant key, value;
+                Error err = _decode_compact(key, r, p_allow_objects);
+                if (err == OK)
+                    err = _decode_compact(value, r, p_allow_objects);
+                ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+                d[key] = value;
+            }
+            r_variant = d;
+        } break;
+        case VariantType::ARRAY: {
+            int count;
+            ok = r.read_count(count, 1);
+            Array arr;
+            if (ok) {
+                arr.resize(count);
+            }
+            for (int i = 0; ok && i < count; i++) {
+                Variant v;
+                Error err = _decode_compact(v, r, p_allow_objects);
+                ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+                arr[i] = v;
+            }
+            r_variant = arr;
+        } break;
+        case VariantType::POOL_BYTE_ARRAY: ok = r.read_pool_array<uint8_t>(r_variant); break;
+        case VariantType::POOL_INT_ARRAY: {
+            int count;
+            ok = r.read_count(count, 1);
+            PoolVector<int> data;
+            if (ok && count) {
+                data.resize(count);
+                PoolVector<int>::Write w = data.write();
+                for (int i = 0; ok && i < count; i++) {
+                    int64_t val;
+                    ok = r.read_varint(val);
+                    w[i] = int(val);
+                }
+            }
+            r_variant = data;
+        } break;
+        case VariantType::POOL_REAL_ARRAY: ok = r.read_pool_array<real_t>(r_variant); break;
+        case VariantType::POOL_STRING_ARRAY: {
+            int count;
+            ok = r.read_count(count, 1);
+            PoolVector<String> data;
+            if (ok && count) {
+                data.resize(count);
+                PoolVector<String>::Write w = data.write();
+                for (int i = 0; ok && i < count; i++) {
+                    ok = r.read_string(w[i]);
+                }
+            }
+            r_variant = data;
+        } break;
+        case VariantType::POOL_VECTOR2_ARRAY: ok = r.read_pool_array<Vector2>(r_variant); break;
+        case VariantType::POOL_VECTOR3_ARRAY: ok = r.read_pool_array<Vector3>(r_variant); break;
+        case VariantType::POOL_COLOR_ARRAY: ok = r.read_pool_array<Color>(r_variant); break;
+        default: {
+            ERR_FAIL_V(ERR_INVALID_DATA);
+        }
+    }
+
+    ERR_FAIL_COND_V(!ok, ERR_INVALID_DATA);
+    return OK;
+}
+
+} // namespace
+
+Error encode_variant(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects) {
+
+    const size_t start = r_buffer.size();
+    VariantArena arena(r_buffer);
+    Error err = _encode_arena(p_variant, arena, p_full_objects);
+    if (err != OK) {
+        r_buffer.resize(start);
+    }
+    return err;
+}
+
+Error encode_variant_compact(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects) {
+
+    const size_t start = r_buffer.size();
+    VariantArena arena(r_buffer);
+    Error err = _encode_compact(p_variant, arena, p_full_objects);
+    if (err != OK) {
+        r_buffer.resize(start);
+    }
+    return err;
+}
+
+Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_objects) {
+
+    ERR_FAIL_COND_V(!p_buffer || p_len < 1, ERR_INVALID_DATA);
+    CompactReader reader { p_buffer, p_buffer + p_len };
+    Error err = _decode_compact(r_variant, reader, p_allow_objects);
+    if (err == OK && r_len) {
+        *r_len = int(reader.ptr - p_buffer);
+    }
+    return err;
+}
+
+Error decode_packed_array_view(EncodedPackedArray &r_view, const uint8_t *p_buffer, int p_len, int *r_len) {
+
+    ERR_FAIL_COND_V(p_len < 8, ERR_INVALID_DATA);
+    const uint32_t type = decode_uint32(p_buffer);
+    int element_size = 0;
+    switch (VariantType(type & ENCODE_MASK)) {
+        case VariantType::POOL_BYTE_ARRAY: element_size = 1; break;
+        case VariantType::POOL_INT_ARRAY: element_size = 4; break;
+        case VariantType::POOL_REAL_ARRAY: element_size = 4; break;
+        case VariantType::POOL_VECTOR2_ARRAY: element_size = 4 * 2; break;
+        case VariantType::POOL_VECTOR3_ARRAY: element_size = 4 * 3; break;
+        case VariantType::POOL_COLOR_ARRAY: element_size = 4 * 4; break;
+        default: {
+            ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Encoded variant is not a packed array of fixed size elements.");
+        }
+    }
+
+    const int32_t count = decode_uint32(p_buffer + 4);
+    ERR_FAIL_MUL_OF(count, element_size, ERR_INVALID_DATA);
+    ERR_FAIL_COND_V(count < 0 || count * element_size > p_len - 8, ERR_INVALID_DATA);
+
+    r_view.type = VariantType(type & ENCODE_MASK);
+    r_view.count = count;
+    r_view.data = p_buffer + 8;
+    r_view.element_size = element_size;
+    if (r_len) {
+        const int size = count * element_size;
+        *r_len = 8 + size + (size % 4 ? 4 - size % 4 : 0);
+    }
+    return OK;
+}
@@ -32,6 +32,7 @@
 
 #include "core/reference.h"
 #include "core/typedefs.h"
+#include "core/vector.h"
 
 /**
   * Miscellaneous helpers for marshalling data types, and encoding
@@ -199,3 +200,32 @@ public:
 
 GODOT_EXPORT Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false);
 GODOT_EXPORT Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects = false);
+/**
+ * Single pass version of encode_variant, appends the encoded variant to r_buffer.
+ * Passing the same vector for every call makes it act as an arena, its capacity is kept so steady state
+ * encoding doesn't allocate.
+ */
+GODOT_EXPORT Error encode_variant(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects = false);
+
+/**
+ * Compact encoding, not compatible with encode_variant. One tag byte per value, varint integers, lengths and
+ * counts, no padding, bools inside the tag byte. Meant for network messages and save games where both sides
+ * use the same engine version.
+ */
+GODOT_EXPORT Error encode_variant_compact(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects = false);
+GODOT_EXPORT Error decode_variant_compact(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false);
+
+//! Packed array encoded by encode_variant, with its elements still in the encoded buffer.
+struct EncodedPackedArray {
+    VariantType type = VariantType::NIL;
+    int count = 0;
+    //! Little endian element data, borrowed from the decoded buffer. Not aligned, use memcpy to read it.
+    const uint8_t *data = nullptr;
+    int element_size = 0;
+};
+
+/**
+ * Decodes the header of a packed array (POOL_*_ARRAY except POOL_STRING_ARRAY) encoded by encode_variant
+ * without copying its elements, so callers can consume or upload them in place.
+ */
+GODOT_EXPORT Error decode_packed_array_view(EncodedPackedArray &r_view, const uint8_t *p_buffer, int p_len, int *r_len = nullptr);
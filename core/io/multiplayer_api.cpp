@@ -31,6 +31,7 @@
 #include "multiplayer_api.h"
 
 #include "core/io/marshalls.h"
+#include "core/io/multiplayer_replicator.h"
 #include "core/callable_method_pointer.h"
 #include "core/method_bind.h"
 #include "scene/main/node.h"
@@ -263,7 +264,10 @@ void MultiplayerAPI::poll() {
     if (not network_peer || network_peer->get_connection_status() == NetworkedMultiplayerPeer::CONNECTION_DISCONNECTED)
         return;
 
-    network_peer->poll();
+    {
+        MemoryTagScope mem_tag(MEM_TAG_NETWORK);
+        network_peer->poll();
+    }
 
     if (not network_peer) // It's possible that polling might have resulted in a disconnection, so check here.
         return;
@@ -288,6 +292,11 @@ void MultiplayerAPI::poll() {
             break; // It's also possible that a packet or RPC caused a disconnection, so also check here.
         }
     }
+
+    if (network_peer && network_peer->is_server()) {
+        MemoryTagScope mem_tag(MEM_TAG_NETWORK);
+        replicator->poll();
+    }
 }
 
 void MultiplayerAPI::clear() {
@@ -296,6 +305,7 @@ void MultiplayerAPI::clear() {
     path_send_cache.clear();
     packet_cache.clear();
     last_send_cache_id = 1;
+    replicator->clear();
 }
 
 void MultiplayerAPI::set_root_node(Node *p_node) {
@@ -391,6 +401,16 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 
             _process_raw(p_from, p_packet, p_packet_len);
         } break;
+
+        case NETWORK_COMMAND_REPLICATION_SNAPSHOT: {
+
+            replicator->process_snapshot(p_from, p_packet, p_packet_len);
+        } break;
+
+        case NETWORK_COMMAND_REPLICATION_ACK: {
+
+            replicator->process_ack(p_from, p_packet, p_packet_len);
+        } break;
     }
 }
 
@@ -672,24 +692,23 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
 
     if (p_set) {
         // Set argument.
-        Error err = encode_variant(*p_arg[0], nullptr, len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+        packet_cache.resize(ofs);
+        Error err = encode_variant(*p_arg[0], packet_cache, allow_object_decoding || network_peer->is_object_decoding_allowed());
         ERR_FAIL_COND_MSG(err != OK, "Unable to encode RSET value. THIS IS LIKELY A BUG IN THE ENGINE!");
-        MAKE_ROOM(ofs + len)
-        encode_variant(*p_arg[0], &packet_cache[ofs], len, allow_object_decoding || network_peer->is_object_decoding_allowed());
-        ofs += len;
+        ofs = packet_cache.size();
 
     } else {
         // Call arguments.
         MAKE_ROOM(ofs + 1)
         packet_cache[ofs] = p_argcount;
         ofs += 1;
+        // arguments are appended to packet_cache in a single pass
+        packet_cache.resize(ofs);
         for (int i = 0; i < p_argcount; i++) {
-            Error err = encode_variant(*p_arg[i], nullptr, len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+            Error err = encode_variant(*p_arg[i], packet_cache, allow_object_decoding || network_peer->is_object_decoding_allowed());
             ERR_FAIL_COND_MSG(err != OK, "Unable to encode RPC argument. THIS IS LIKELY A BUG IN THE ENGINE!");
-            MAKE_ROOM(ofs + len)
-            encode_variant(*p_arg[i], &packet_cache[ofs], len, allow_object_decoding || network_peer->is_object_decoding_allowed());
-            ofs += len;
         }
+        ofs = packet_cache.size();
     }
 
     m_debug_data->record_rpc_call(ofs);
@@ -740,6 +759,14 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
     }
 }
 
+void MultiplayerAPI::_send_packet(int p_to, NetworkedMultiplayerPeer::TransferMode p_mode, const uint8_t *p_packet, int p_packet_len) {
+
+    m_debug_data->record_rpc_call(p_packet_len);
+    network_peer->set_transfer_mode(p_mode);
+    network_peer->set_target_peer(p_to);
+    network_peer->put_packet(p_packet, p_packet_len);
+}
+
 void MultiplayerAPI::_add_peer(int p_id) {
     connected_peers.insert(p_id);
     path_get_cache.emplace(p_id, PathGetCache());
@@ -759,6 +786,7 @@ void MultiplayerAPI::_del_peer(int p_id) {
         auto psc = path_send_cache.find(E);
         psc->second.confirmed_peers.erase(p_id);
     }
+    replicator->remove_peer(p_id);
     emit_signal("network_peer_disconnected", p_id);
 }
 void MultiplayerAPI::_connected_to_server() {
@@ -984,6 +1012,53 @@ bool MultiplayerAPI::is_object_decoding_allowed() const {
     return allow_object_decoding;
 }
 
+void MultiplayerAPI::replicate_property(Node *p_node, const StringName &p_property, float p_quantization_step) {
+    replicator->add_property(p_node, p_property, p_quantization_step);
+}
+
+void MultiplayerAPI::set_replication_position_property(Node *p_node, const StringName &p_property) {
+    replicator->set_position_property(p_node, p_property);
+}
+
+void MultiplayerAPI::stop_replicating(Node *p_node) {
+    replicator->remove_node(p_node);
+}
+
+bool MultiplayerAPI::is_replicated(Node *p_node) const {
+    return replicator->has_node(p_node);
+}
+
+void MultiplayerAPI::set_replication_tick_rate(int p_rate) {
+    ERR_FAIL_COND(p_rate < 0);
+    replicator->set_tick_rate(p_rate);
+}
+
+int MultiplayerAPI::get_replication_tick_rate() const {
+    return replicator->get_tick_rate();
+}
+
+void MultiplayerAPI::set_replication_interest_radius(float p_radius) {
+    replicator->set_interest_radius(p_radius);
+}
+
+float MultiplayerAPI::get_replication_interest_radius() const {
+    return replicator->get_interest_radius();
+}
+
+void MultiplayerAPI::set_peer_interest_origin(int p_peer_id, const Vector3 &p_origin) {
+    replicator->set_peer_interest_origin(p_peer_id, p_origin);
+}
+
+void MultiplayerAPI::send_replication_snapshot() {
+    replicator->send_snapshot();
+}
+
+int MultiplayerAPI::get_replication_tick() const {
+    if (network_peer && network_peer->is_server())
+        return replicator->get_tick();
+    return replicator->get_applied_tick();
+}
+
 void MultiplayerAPI::profiling_start() {
     m_debug_data->profiling_start();
 }
@@ -1027,9 +1102,23 @@ void MultiplayerAPI::_bind_methods() {
     MethodBinder::bind_method(D_METHOD("set_allow_object_decoding", {"enable"}), &MultiplayerAPI::set_allow_object_decoding);
     MethodBinder::bind_method(D_METHOD("is_object_decoding_allowed"), &MultiplayerAPI::is_object_decoding_allowed);
 
+    MethodBinder::bind_method(D_METHOD("replicate_property", {"node", "property", "quantization_step"}), &MultiplayerAPI::replicate_property, {DEFVAL(0.0f)});
+    MethodBinder::bind_method(D_METHOD("set_replication_position_property", {"node", "property"}), &MultiplayerAPI::set_replication_position_property);
+    MethodBinder::bind_method(D_METHOD("stop_replicating", {"node"}), &MultiplayerAPI::stop_replicating);
+    MethodBinder::bind_method(D_METHOD("is_replicated", {"node"}), &MultiplayerAPI::is_replicated);
+    MethodBinder::bind_method(D_METHOD("set_replication_tick_rate", {"rate"}), &MultiplayerAPI::set_replication_tick_rate);
+    MethodBinder::bind_method(D_METHOD("get_replication_tick_rate"), &MultiplayerAPI::get_replication_tick_rate);
+    MethodBinder::bind_method(D_METHOD("set_replication_interest_radius", {"radius"}), &MultiplayerAPI::set_replication_interest_radius);
+    MethodBinder::bind_method(D_METHOD("get_replication_interest_radius"), &MultiplayerAPI::get_replication_interest_radius);
+    MethodBinder::bind_method(D_METHOD("set_peer_interest_origin", {"id", "origin"}), &MultiplayerAPI::set_peer_interest_origin);
+    MethodBinder::bind_method(D_METHOD("send_replication_snapshot"), &MultiplayerAPI::send_replication_snapshot);
+    MethodBinder::bind_method(D_METHOD("get_replication_tick"), &MultiplayerAPI::get_replication_tick);
+
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "allow_object_decoding"), "set_allow_object_decoding", "is_object_decoding_allowed");
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "refuse_new_network_connections"), "set_refuse_new_network_connections", "is_refusing_new_network_connections");
     ADD_PROPERTY(PropertyInfo(VariantType::OBJECT, "network_peer", PropertyHint::ResourceType, "NetworkedMultiplayerPeer", 0), "set_network_peer", "get_network_peer");
+    ADD_PROPERTY(PropertyInfo(VariantType::INT, "replication_tick_rate", PropertyHint::Range, "0,240,1"), "set_replication_tick_rate", "get_replication_tick_rate");
+    ADD_PROPERTY(PropertyInfo(VariantType::FLOAT, "replication_interest_radius", PropertyHint::Range, "0,100000,0.1,or_greater"), "set_replication_interest_radius", "get_replication_interest_radius");
     ADD_PROPERTY_DEFAULT("refuse_new_network_connections", false);
 
     ADD_SIGNAL(MethodInfo("network_peer_connected", PropertyInfo(VariantType::INT, "id")));
@@ -1053,6 +1142,7 @@ void MultiplayerAPI::_bind_methods() {
 MultiplayerAPI::MultiplayerAPI() {
     rpc_sender_id = 0;
     root_node = nullptr;
+    replicator = memnew_args(MultiplayerReplicator, this);
 
     //! @note m_debug_data can be a nullptr in non DEBUG_ENABLED builds, all calls on the pointer will be no-ops
     //! in such case.
@@ -1065,4 +1155,5 @@ MultiplayerAPI::MultiplayerAPI() {
 MultiplayerAPI::~MultiplayerAPI() {
     delete m_debug_data;
     clear();
+    memdelete(replicator);
 }
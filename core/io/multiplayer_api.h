@@ -37,12 +37,16 @@
 #include "core/set.h"
 #include "core/string.h"
 
+class MultiplayerReplicator;
+
 enum MultiplayerAPI_NetworkCommands {
     NETWORK_COMMAND_REMOTE_CALL,
     NETWORK_COMMAND_REMOTE_SET,
     NETWORK_COMMAND_SIMPLIFY_PATH,
     NETWORK_COMMAND_CONFIRM_PATH,
     NETWORK_COMMAND_RAW,
+    NETWORK_COMMAND_REPLICATION_SNAPSHOT,
+    NETWORK_COMMAND_REPLICATION_ACK,
 };
 enum MultiplayerAPI_RPCMode : int8_t {
 
@@ -60,6 +64,8 @@ class GODOT_EXPORT MultiplayerAPI : public RefCounted {
 
     GDCLASS(MultiplayerAPI, RefCounted)
 
+    friend class MultiplayerReplicator;
+
 public:
     struct ProfilingInfo {
         ObjectID node;
@@ -95,6 +101,7 @@ private:
     int last_send_cache_id;
     Vector<uint8_t> packet_cache;
     Node *root_node;
+    MultiplayerReplicator *replicator;
     bool allow_object_decoding = false;
 
 protected:
@@ -110,6 +117,7 @@ protected:
 
     void _send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
     bool _send_confirm_path(const NodePath& p_path, PathSentCache *psc, int p_target);
+    void _send_packet(int p_to, NetworkedMultiplayerPeer::TransferMode p_mode, const uint8_t *p_packet, int p_packet_len);
 
 
 public:
@@ -144,6 +152,19 @@ public:
     void set_allow_object_decoding(bool p_enable);
     bool is_object_decoding_allowed() const;
 
+    // Snapshot replication, see MultiplayerReplicator.
+    void replicate_property(Node *p_node, const StringName &p_property, float p_quantization_step = 0);
+    void set_replication_position_property(Node *p_node, const StringName &p_property);
+    void stop_replicating(Node *p_node);
+    bool is_replicated(Node *p_node) const;
+    void set_replication_tick_rate(int p_rate);
+    int get_replication_tick_rate() const;
+    void set_replication_interest_radius(float p_radius);
+    float get_replication_interest_radius() const;
+    void set_peer_interest_origin(int p_peer_id, const Vector3 &p_origin);
+    void send_replication_snapshot();
+    int get_replication_tick() const;
+
     void profiling_start();
     void profiling_end();
 
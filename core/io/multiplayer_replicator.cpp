@@ -0,0 +1,787 @@
+/*************************************************************************/
+/*  multiplayer_replicator.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "multiplayer_replicator.h"
+
+#include "core/color.h"
+#include "core/io/marshalls.h"
+#include "core/io/multiplayer_api.h"
+#include "core/math/quat.h"
+#include "core/math/transform.h"
+#include "core/math/transform_2d.h"
+#include "core/object_db.h"
+#include "core/os/os.h"
+#include "scene/main/node.h"
+
+#include "EASTL/sort.h"
+
+namespace {
+
+static_assert(int(VariantType::VARIANT_MAX) <= 32, "Replicated value types are written with 5 bits.");
+
+// Bits are appended least significant first.
+class BitWriter {
+    Vector<uint8_t> &data;
+    uint64_t acc = 0;
+    int bits = 0;
+
+public:
+    explicit BitWriter(Vector<uint8_t> &r_data) :
+            data(r_data) {}
+
+    void write(uint32_t p_value, int p_bits) {
+        acc |= uint64_t(p_value & (p_bits == 32 ? 0xFFFFFFFFu : ((1u << p_bits) - 1))) << bits;
+        bits += p_bits;
+        while (bits >= 8) {
+            data.push_back(uint8_t(acc));
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    // Four bits at a time with a continuation bit, so small values take 5 bits.
+    void write_varuint(uint64_t p_value) {
+        do {
+            uint32_t chunk = p_value & 0xF;
+            p_value >>= 4;
+            write(chunk | (p_value ? 0x10 : 0), 5);
+        } while (p_value);
+    }
+    void write_varint(int64_t p_value) {
+        write_varuint((uint64_t(p_value) << 1) ^ uint64_t(p_value >> 63));
+    }
+    void write_float(float p_value) {
+        uint32_t u;
+        memcpy(&u, &p_value, 4);
+        write(u, 32);
+    }
+    void flush() {
+        if (bits > 0) {
+            data.push_back(uint8_t(acc));
+        }
+        acc = 0;
+        bits = 0;
+    }
+};
+
+class BitReader {
+    const uint8_t *data;
+    size_t size;
+    size_t pos = 0;
+
+public:
+    bool error = false;
+
+    BitReader(const uint8_t *p_data, size_t p_size) :
+            data(p_data),
+            size(p_size) {}
+
+    uint32_t read(int p_bits) {
+        uint32_t r = 0;
+        int got = 0;
+        while (got < p_bits) {
+            size_t byte = pos >> 3;
+            if (byte >= size) {
+                error = true;
+                return 0;
+            }
+            int ofs = pos & 7;
+            int take = MIN(8 - ofs, p_bits - got);
+            r |= uint32_t((data[byte] >> ofs) & ((1u << take) - 1)) << got;
+            got += take;
+            pos += take;
+        }
+        return r;
+    }
+    uint64_t read_varuint() {
+        uint64_t r = 0;
+        for (int shift = 0; shift < 64 && !error; shift += 4) {
+            uint32_t chunk = read(5);
+            r |= uint64_t(chunk & 0xF) << shift;
+            if (!(chunk & 0x10))
+                return r;
+        }
+        error = true;
+        return 0;
+    }
+    int64_t read_varint() {
+        uint64_t u = read_varuint();
+        return int64_t(u >> 1) ^ -int64_t(u & 1);
+    }
+    float read_float() {
+        uint32_t u = read(32);
+        float f;
+        memcpy(&f, &u, 4);
+        return f;
+    }
+    size_t get_bytes_left() const {
+        return pos >= size * 8 ? 0 : size - (pos + 7) / 8;
+    }
+};
+
+// Floating point vector types are packed component-wise, everything else goes through encode_variant_compact.
+int _component_count(VariantType p_type) {
+    switch (p_type) {
+        case VariantType::FLOAT:
+            return 1;
+        case VariantType::VECTOR2:
+            return 2;
+        case VariantType::VECTOR3:
+            return 3;
+        case VariantType::QUAT:
+        case VariantType::COLOR:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+int _get_components(const Variant &p_value, float r_components[4]) {
+    switch (p_value.get_type()) {
+        case VariantType::FLOAT: {
+            r_components[0] = p_value.as<float>();
+            return 1;
+        }
+        case VariantType::VECTOR2: {
+            Vector2 v = p_value.as<Vector2>();
+            r_components[0] = v.x;
+            r_components[1] = v.y;
+            return 2;
+        }
+        case VariantType::VECTOR3: {
+            Vector3 v = p_value.as<Vector3>();
+            r_components[0] = v.x;
+            r_components[1] = v.y;
+            r_components[2] = v.z;
+            return 3;
+        }
+        case VariantType::QUAT: {
+            Quat q = p_value.as<Quat>();
+            r_components[0] = q.x;
+            r_components[1] = q.y;
+            r_components[2] = q.z;
+            r_components[3] = q.w;
+            return 4;
+        }
+        case VariantType::COLOR: {
+            Color c = p_value.as<Color>();
+            r_components[0] = c.r;
+            r_components[1] = c.g;
+            r_components[2] = c.b;
+            r_components[3] = c.a;
+            return 4;
+        }
+        default:
+            return 0;
+    }
+}
+
+Variant _make_value(VariantType p_type, const float p_components[4]) {
+    switch (p_type) {
+        case VariantType::FLOAT:
+            return p_components[0];
+        case VariantType::VECTOR2:
+            return Vector2(p_components[0], p_components[1]);
+        case VariantType::VECTOR3:
+            return Vector3(p_components[0], p_components[1], p_components[2]);
+        case VariantType::QUAT:
+            return Quat(p_components[0], p_components[1], p_components[2], p_components[3]);
+        case VariantType::COLOR:
+            return Color(p_components[0], p_components[1], p_components[2], p_components[3]);
+        default:
+            return Variant();
+    }
+}
+
+_FORCE_INLINE_ int64_t _quantized_index(float p_value, float p_step) {
+    return llround(double(p_value) / p_step);
+}
+
+_FORCE_INLINE_ float _dequantize(int64_t p_index, float p_step) {
+    return float(double(p_index) * p_step);
+}
+
+// Rounds the value the same way the receiving side reconstructs it, so both keep identical baselines.
+Variant _quantize(const Variant &p_value, float p_step) {
+    float c[4];
+    int count = _get_components(p_value, c);
+    if (!count)
+        return p_value;
+    for (int i = 0; i < count; i++) {
+        c[i] = p_step > 0 ? _dequantize(_quantized_index(c[i], p_step), p_step) : c[i];
+    }
+    return _make_value(p_value.get_type(), c);
+}
+
+Vector3 _to_position(const Variant &p_value, bool &r_valid) {
+    r_valid = true;
+    switch (p_value.get_type()) {
+        case VariantType::VECTOR3:
+            return p_value.as<Vector3>();
+        case VariantType::VECTOR2: {
+            Vector2 v = p_value.as<Vector2>();
+            return Vector3(v.x, v.y, 0);
+        }
+        case VariantType::TRANSFORM:
+            return p_value.as<Transform>().origin;
+        case VariantType::TRANSFORM2D: {
+            Vector2 v = p_value.as<Transform2D>().get_origin();
+            return Vector3(v.x, v.y, 0);
+        }
+        default:
+            r_valid = false;
+            return Vector3();
+    }
+}
+
+void _write_value(BitWriter &w, const Variant &p_value, const Variant &p_base, float p_step) {
+
+    VariantType type = p_value.get_type();
+    w.write(uint32_t(type), 5);
+
+    float c[4];
+    int count = _get_components(p_value, c);
+    if (type == VariantType::NIL) {
+        return;
+    } else if (type == VariantType::BOOL) {
+        w.write(p_value.as<bool>(), 1);
+    } else if (type == VariantType::INT) {
+        uint64_t base = p_base.get_type() == VariantType::INT ? p_base.as<int64_t>() : 0;
+        w.write_varint(int64_t(uint64_t(p_value.as<int64_t>()) - base));
+    } else if (count) {
+        float base[4] = { 0, 0, 0, 0 };
+        if (p_base.get_type() == type) {
+            _get_components(p_base, base);
+        }
+        for (int i = 0; i < count; i++) {
+            bool changed = c[i] != base[i];
+            w.write(changed, 1);
+            if (!changed)
+                continue;
+            if (p_step > 0) {
+                w.write_varint(_quantized_index(c[i], p_step) - _quantized_index(base[i], p_step));
+            } else {
+                w.write_float(c[i]);
+            }
+        }
+    } else {
+        // reused between calls, so encoding doesn't allocate once it has grown
+        static thread_local Vector<uint8_t> buf;
+        buf.clear();
+        encode_variant_compact(p_value, buf);
+        w.write_varuint(buf.size());
+        for (uint8_t b : buf) {
+            w.write(b, 8);
+        }
+    }
+}
+
+Variant _read_value(BitReader &r, const Variant &p_base, float p_step) {
+
+    VariantType type = VariantType(r.read(5));
+    if (r.error || type >= VariantType::VARIANT_MAX) {
+        r.error = true;
+        return Variant();
+    }
+
+    if (type == VariantType::NIL) {
+        return Variant();
+    } else if (type == VariantType::BOOL) {
+        return bool(r.read(1));
+    } else if (type == VariantType::INT) {
+        uint64_t base = p_base.get_type() == VariantType::INT ? p_base.as<int64_t>() : 0;
+        return int64_t(base + uint64_t(r.read_varint()));
+    }
+
+    int count = _component_count(type);
+    if (count) {
+        float c[4] = { 0, 0, 0, 0 };
+        if (p_base.get_type() == type) {
+            _get_components(p_base, c);
+        }
+        for (int i = 0; i < count; i++) {
+            if (!r.read(1))
+                continue;
+            if (p_step > 0) {
+                c[i] = _dequantize(_quantized_index(c[i], p_step) + r.read_varint(), p_step);
+            } else {
+                c[i] = r.read_float();
+            }
+        }
+        return _make_value(type, c);
+    }
+
+    uint64_t len = r.read_varuint();
+    if (r.error || len > r.get_bytes_left()) {
+        r.error = true;
+        return Variant();
+    }
+    FixedVector<uint8_t, 64, true> buf;
+    buf.resize(len);
+    for (uint64_t i = 0; i < len; i++) {
+        buf[i] = r.read(8);
+    }
+    Variant value;
+    if (decode_variant_compact(value, buf.data(), int(len)) != OK) {
+        r.error = true;
+    }
+    return value;
+}
+
+bool _sorted_contains(const Vector<uint32_t> &p_ids, uint32_t p_id) {
+    auto iter = eastl::lower_bound(p_ids.begin(), p_ids.end(), p_id);
+    return iter != p_ids.end() && *iter == p_id;
+}
+
+} // namespace
+
+void MultiplayerReplicator::Snapshot::clear() {
+    tick = 0;
+    ids.clear();
+    offsets.clear();
+    values.clear();
+    steps.clear();
+    positions.clear();
+    has_position.clear();
+}
+
+int MultiplayerReplicator::Snapshot::find(uint32_t p_id) const {
+    auto iter = eastl::lower_bound(ids.begin(), ids.end(), p_id);
+    if (iter == ids.end() || *iter != p_id)
+        return -1;
+    return int(iter - ids.begin());
+}
+
+void MultiplayerReplicator::add_property(Node *p_node, const StringName &p_property, float p_quantization_step) {
+
+    ERR_FAIL_NULL(p_node);
+    ERR_FAIL_COND_MSG(!multiplayer->root_node || !p_node->is_inside_tree(), "Replicated nodes must be inside the tree of the multiplayer root node.");
+    ERR_FAIL_COND(p_quantization_step < 0);
+
+    auto iter = nodes.find(p_node->get_instance_id());
+    if (iter == nodes.end()) {
+        ReplicatedNode rn;
+        rn.path = multiplayer->root_node->get_path().rel_path_to(p_node->get_path());
+        iter = nodes.emplace(p_node->get_instance_id(), eastl::move(rn)).first;
+    }
+    for (Property &prop : iter->second.properties) {
+        if (prop.name == p_property) {
+            prop.quantization_step = p_quantization_step;
+            return;
+        }
+    }
+    iter->second.properties.push_back(Property { p_property, p_quantization_step });
+}
+
+void MultiplayerReplicator::set_position_property(Node *p_node, const StringName &p_property) {
+
+    ERR_FAIL_NULL(p_node);
+    auto iter = nodes.find(p_node->get_instance_id());
+    ERR_FAIL_COND_MSG(iter == nodes.end(), "Node has no replicated properties.");
+    iter->second.position_property = p_property;
+}
+
+void MultiplayerReplicator::remove_node(Node *p_node) {
+
+    ERR_FAIL_NULL(p_node);
+    nodes.erase(p_node->get_instance_id());
+}
+
+bool MultiplayerReplicator::has_node(Node *p_node) const {
+
+    return p_node && nodes.contains(p_node->get_instance_id());
+}
+
+void MultiplayerReplicator::set_peer_interest_origin(int p_peer, const Vector3 &p_origin) {
+
+    PeerState &state = peers[p_peer];
+    state.interest_origin = p_origin;
+    state.has_interest_origin = true;
+}
+
+void MultiplayerReplicator::_capture(Snapshot &r_snapshot) {
+
+    r_snapshot.clear();
+
+    struct Entry {
+        uint32_t id;
+        Node *node;
+        const ReplicatedNode *rn;
+        bool operator<(const Entry &p_other) const { return id < p_other.id; }
+    };
+    Vector<Entry> order;
+    order.reserve(nodes.size());
+    for (auto iter = nodes.begin(); iter != nodes.end();) {
+        Node *node = object_cast<Node>(gObjectDB().get_instance(iter->first));
+        if (!node) {
+            iter = nodes.erase(iter); // Freed without being unregistered.
+            continue;
+        }
+        ReplicatedNode &rn = iter->second;
+        if (rn.net_id == 0) {
+            auto psc = multiplayer->path_send_cache.find(rn.path);
+            if (psc == multiplayer->path_send_cache.end()) {
+                psc = multiplayer->path_send_cache.emplace(eastl::make_pair(rn.path, MultiplayerAPI::PathSentCache { {}, multiplayer->last_send_cache_id++ })).first;
+            }
+            rn.net_id = psc->second.id;
+        }
+        if (node->is_inside_tree()) {
+            order.push_back(Entry { rn.net_id, node, &rn });
+        }
+        ++iter;
+    }
+    eastl::sort(order.begin(), order.end());
+
+    for (const Entry &E : order) {
+        const ReplicatedNode &rn = *E.rn;
+        Node *node = E.node;
+
+        r_snapshot.ids.push_back(E.id);
+        r_snapshot.offsets.push_back(r_snapshot.values.size());
+        for (const Property &prop : rn.properties) {
+            r_snapshot.values.push_back(_quantize(node->get(prop.name), prop.quantization_step));
+            r_snapshot.steps.push_back(prop.quantization_step);
+        }
+
+        bool has_position = false;
+        Vector3 position;
+        if (rn.position_property != StringName()) {
+            position = _to_position(node->get(rn.position_property), has_position);
+        }
+        r_snapshot.positions.push_back(position);
+        r_snapshot.has_position.push_back(has_position);
+    }
+    r_snapshot.offsets.push_back(r_snapshot.values.size());
+}
+
+bool MultiplayerReplicator::_is_interested(const PeerState &p_state, const Snapshot &p_snapshot, int p_index) const {
+
+    if (interest_radius <= 0 || !p_state.has_interest_origin || !p_snapshot.has_position[p_index])
+        return true;
+    return p_snapshot.positions[p_index].distance_squared_to(p_state.interest_origin) <= interest_radius * interest_radius;
+}
+
+void MultiplayerReplicator::_send_to_peer(int p_peer, PeerState &p_state, const Snapshot &p_snapshot) {
+
+    // Delta against the last acknowledged tick, when both its snapshot and what was sent for it are still known.
+    uint32_t base_tick = p_state.acked_tick;
+    const Snapshot *base = nullptr;
+    const SentFrame *base_frame = nullptr;
+    if (base_tick != 0 && tick - base_tick < SNAPSHOT_HISTORY) {
+        base = &snapshots[base_tick % SNAPSHOT_HISTORY];
+        base_frame = &p_state.frames[base_tick % SNAPSHOT_HISTORY];
+        if (base->tick != base_tick || base_frame->tick != base_tick) {
+            base = nullptr;
+        }
+    }
+    if (!base) {
+        base_tick = 0;
+    }
+
+    SentFrame &frame = p_state.frames[tick % SNAPSHOT_HISTORY];
+    frame.tick = tick;
+    frame.ids.clear();
+
+    packet.resize(9);
+    packet[0] = NETWORK_COMMAND_REPLICATION_SNAPSHOT;
+    encode_uint32(tick, &packet[1]);
+    encode_uint32(base_tick, &packet[5]);
+
+    FixedVector<int, 256, true> included;
+    for (int i = 0; i < p_snapshot.ids.size(); i++) {
+        const Map<int, bool> *confirmed = pending_confirmations[i];
+        if (confirmed) {
+            auto F = confirmed->find(p_peer);
+            if (F == confirmed->end() || !F->second)
+                continue; // The peer can't resolve the id yet.
+        }
+        if (_is_interested(p_state, p_snapshot, i)) {
+            included.push_back(i);
+            frame.ids.push_back(p_snapshot.ids[i]);
+        }
+    }
+
+    BitWriter w(packet);
+    w.write_varuint(included.size());
+    uint32_t prev_id = 0;
+    for (int idx : included) {
+        uint32_t id = p_snapshot.ids[idx];
+        uint32_t ofs = p_snapshot.offsets[idx];
+        uint32_t count = p_snapshot.offsets[idx + 1] - ofs;
+
+        int base_idx = -1;
+        if (base && _sorted_contains(base_frame->ids, id)) {
+            base_idx = base->find(id);
+            if (base_idx >= 0 && base->offsets[base_idx + 1] - base->offsets[base_idx] != count) {
+                base_idx = -1; // Registration changed, send the full state.
+            }
+        }
+
+        w.write_varuint(id - prev_id);
+        prev_id = id;
+        w.write(base_idx >= 0, 1);
+
+        if (base_idx < 0) {
+            w.write_varuint(count);
+            for (uint32_t k = 0; k < count; k++) {
+                w.write_float(p_snapshot.steps[ofs + k]);
+                w.write(1, 1);
+                _write_value(w, p_snapshot.values[ofs + k], Variant(), p_snapshot.steps[ofs + k]);
+            }
+            continue;
+        }
+
+        uint32_t base_ofs = base->offsets[base_idx];
+        for (uint32_t k = 0; k < count; k++) {
+            const Variant &value = p_snapshot.values[ofs + k];
+            const Variant &base_value = base->values[base_ofs + k];
+            bool changed = value.get_type() != base_value.get_type() || value != base_value;
+            w.write(changed, 1);
+            if (changed) {
+                _write_value(w, value, base_value, p_snapshot.steps[ofs + k]);
+            }
+        }
+    }
+    w.flush();
+
+    multiplayer->_send_packet(p_peer, NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE, packet.data(), packet.size());
+}
+
+void MultiplayerReplicator::send_snapshot() {
+
+    ERR_FAIL_COND_MSG(!multiplayer->network_peer || !multiplayer->network_peer->is_server(), "Only the server sends replication snapshots.");
+    ERR_FAIL_COND(!multiplayer->root_node);
+
+    ++tick;
+    Snapshot &snapshot = snapshots[tick % SNAPSHOT_HISTORY];
+    _capture(snapshot);
+    snapshot.tick = tick;
+
+    // Peers learn ids through the same path cache as RPCs, nodes are only sent to peers that confirmed them.
+    pending_confirmations.resize(snapshot.ids.size());
+    for (int i = 0; i < snapshot.ids.size(); i++) {
+        pending_confirmations[i] = nullptr;
+    }
+    for (auto &E : nodes) {
+        int idx = snapshot.find(E.second.net_id);
+        if (idx < 0)
+            continue;
+        auto psc = multiplayer->path_send_cache.find(E.second.path);
+        if (psc != multiplayer->path_send_cache.end() && !multiplayer->_send_confirm_path(E.second.path, &psc->second, 0)) {
+            pending_confirmations[idx] = &psc->second.confirmed_peers;
+        }
+    }
+
+    for (int peer : multiplayer->connected_peers) {
+        _send_to_peer(peer, peers[peer], snapshot);
+    }
+}
+
+void MultiplayerReplicator::poll() {
+
+    if (nodes.empty() || tick_rate <= 0 || multiplayer->connected_peers.empty())
+        return;
+
+    uint64_t now = OS::get_singleton()->get_ticks_usec();
+    if (last_tick_usec != 0 && now - last_tick_usec < 1000000 / uint64_t(tick_rate))
+        return;
+    last_tick_usec = now;
+    send_snapshot();
+}
+
+ObjectID MultiplayerReplicator::_resolve(int p_from, uint32_t p_id) {
+
+    auto iter = resolved_ids.find(p_id);
+    if (iter != resolved_ids.end() && gObjectDB().get_instance(iter->second)) {
+        return iter->second;
+    }
+
+    auto E = multiplayer->path_get_cache.find(p_from);
+    if (E == multiplayer->path_get_cache.end())
+        return ObjectID();
+    auto F = E->second.nodes.find(p_id);
+    if (F == E->second.nodes.end())
+        return ObjectID();
+    Node *node = multiplayer->root_node->get_node_or_null(F->second.path);
+    if (!node)
+        return ObjectID();
+
+    resolved_ids[p_id] = node->get_instance_id();
+    return node->get_instance_id();
+}
+
+void MultiplayerReplicator::_apply(int p_from, const Snapshot &p_frame) {
+
+    // Only what changed since the last applied tick is set, it is not necessarily the delta's baseline.
+    const Snapshot *prev = &received[applied_tick % SNAPSHOT_HISTORY];
+    if (applied_tick == 0 || prev->tick != applied_tick) {
+        prev = nullptr;
+    }
+
+    for (int i = 0; i < p_frame.ids.size(); i++) {
+        ObjectID id = _resolve(p_from, p_frame.ids[i]);
+        auto iter = nodes.find(id);
+        if (iter == nodes.end())
+            continue; // Not replicated on this side (yet).
+        Node *node = object_cast<Node>(gObjectDB().get_instance(id));
+        if (!node)
+            continue;
+
+        const Vector<Property> &props = iter->second.properties;
+        uint32_t ofs = p_frame.offsets[i];
+        uint32_t count = p_frame.offsets[i + 1] - ofs;
+        ERR_CONTINUE_MSG(count != props.size(), "Replicated properties of '" + String(iter->second.path) + "' differ between server and client.");
+
+        int prev_idx = prev ? prev->find(p_frame.ids[i]) : -1;
+        for (uint32_t k = 0; k < count; k++) {
+            const Variant &value = p_frame.values[ofs + k];
+            if (prev_idx >= 0) {
+                const Variant &old = prev->values[prev->offsets[prev_idx] + k];
+                if (old.get_type() == value.get_type() && old == value)
+                    continue;
+            }
+            node->set(props[k].name, value);
+        }
+    }
+}
+
+void MultiplayerReplicator::process_snapshot(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+    ERR_FAIL_COND_MSG(p_packet_len < 9, "Invalid packet received. Size too small.");
+    ERR_FAIL_COND_MSG(p_from != 1, "Invalid packet received. Replication snapshots can only come from the server.");
+
+    uint32_t snapshot_tick = decode_uint32(&p_packet[1]);
+    uint32_t base_tick = decode_uint32(&p_packet[5]);
+    ERR_FAIL_COND_MSG(snapshot_tick == 0 || base_tick >= snapshot_tick || (base_tick != 0 && snapshot_tick - base_tick >= SNAPSHOT_HISTORY), "Invalid packet received. Bad replication ticks.");
+
+    Snapshot &slot = received[snapshot_tick % SNAPSHOT_HISTORY];
+    if (slot.tick >= snapshot_tick)
+        return; // Duplicate or very late.
+
+    const Snapshot *base = nullptr;
+    if (base_tick != 0) {
+        base = &received[base_tick % SNAPSHOT_HISTORY];
+        if (base->tick != base_tick)
+            return; // Baseline is gone, the server switches to a newer one once newer acks arrive.
+    }
+
+    Snapshot &frame = decoding;
+    frame.clear();
+
+    BitReader r(p_packet + 9, p_packet_len - 9);
+    uint64_t node_count = r.read_varuint();
+    ERR_FAIL_COND_MSG(node_count > uint64_t(p_packet_len) * 8, "Invalid packet received. Bad replication node count.");
+
+    uint32_t id = 0;
+    for (uint64_t i = 0; i < node_count && !r.error; i++) {
+        id += uint32_t(r.read_varuint());
+        bool has_base = r.read(1);
+        int base_idx = -1;
+        uint32_t count;
+        if (has_base) {
+            base_idx = base ? base->find(id) : -1;
+            ERR_FAIL_COND_MSG(base_idx < 0, "Invalid packet received. Replication baseline does not contain the node.");
+            count = base->offsets[base_idx + 1] - base->offsets[base_idx];
+        } else {
+            count = uint32_t(r.read_varuint());
+            ERR_FAIL_COND_MSG(count > 255, "Invalid packet received. Too many replicated properties.");
+        }
+
+        frame.ids.push_back(id);
+        frame.offsets.push_back(frame.values.size());
+        for (uint32_t k = 0; k < count; k++) {
+            float step;
+            Variant base_value;
+            if (has_base) {
+                step = base->steps[base->offsets[base_idx] + k];
+                base_value = base->values[base->offsets[base_idx] + k];
+            } else {
+                step = r.read_float();
+            }
+            frame.steps.push_back(step);
+            frame.values.push_back(r.read(1) ? _read_value(r, base_value, step) : base_value);
+        }
+    }
+    ERR_FAIL_COND_MSG(r.error, "Invalid packet received. Malformed replication snapshot.");
+    frame.offsets.push_back(frame.values.size());
+    frame.tick = snapshot_tick;
+    eastl::swap(slot, frame);
+
+    // Acknowledge every stored tick, the server picks the newest one it hears about as the next baseline.
+    uint8_t ack[5];
+    ack[0] = NETWORK_COMMAND_REPLICATION_ACK;
+    encode_uint32(snapshot_tick, &ack[1]);
+    multiplayer->_send_packet(p_from, NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE, ack, sizeof(ack));
+
+    if (snapshot_tick > applied_tick) {
+        _apply(p_from, slot);
+        applied_tick = snapshot_tick;
+    }
+}
+
+void MultiplayerReplicator::process_ack(int p_from, const uint8_t *p_packet, int p_packet_len) {
+
+    ERR_FAIL_COND_MSG(p_packet_len < 5, "Invalid packet received. Size too small.");
+
+    uint32_t acked = decode_uint32(&p_packet[1]);
+    auto iter = peers.find(p_from);
+    if (iter == peers.end() || acked > tick)
+        return;
+    if (acked > iter->second.acked_tick) {
+        iter->second.acked_tick = acked;
+    }
+}
+
+void MultiplayerReplicator::remove_peer(int p_peer) {
+
+    peers.erase(p_peer);
+}
+
+void MultiplayerReplicator::clear() {
+
+    for (auto &E : nodes) {
+        E.second.net_id = 0;
+    }
+    for (Snapshot &s : snapshots) {
+        s.clear();
+    }
+    for (Snapshot &s : received) {
+        s.clear();
+    }
+    peers.clear();
+    resolved_ids.clear();
+    tick = 0;
+    applied_tick = 0;
+    last_tick_usec = 0;
+}
+
+MultiplayerReplicator::MultiplayerReplicator(MultiplayerAPI *p_multiplayer) :
+        multiplayer(p_multiplayer) {
+}
@@ -0,0 +1,151 @@
+/*************************************************************************/
+/*  multiplayer_replicator.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/hash_map.h"
+#include "core/map.h"
+#include "core/math/vector3.h"
+#include "core/node_path.h"
+#include "core/object_id.h"
+#include "core/string_name.h"
+#include "core/variant.h"
+#include "core/vector.h"
+
+class MultiplayerAPI;
+class Node;
+
+/**
+ * Snapshot based state replication, owned by MultiplayerAPI.
+ *
+ * Both sides register the same nodes and properties. The server captures the registered properties once per
+ * tick, then sends every peer the nodes within its interest radius as a bit-packed delta against the last
+ * snapshot that peer acknowledged. Nodes are referenced by the path cache ids that RPCs use, so a node is
+ * only sent to a peer once that peer confirmed its path.
+ */
+class MultiplayerReplicator {
+
+public:
+    enum {
+        SNAPSHOT_HISTORY = 32, // Ticks a peer can lag behind before it gets full states again.
+    };
+
+private:
+    struct Property {
+        StringName name;
+        float quantization_step;
+    };
+
+    struct ReplicatedNode {
+        NodePath path; // Relative to the multiplayer root node.
+        Vector<Property> properties;
+        StringName position_property;
+        uint32_t net_id = 0; // Path cache id, assigned on the first tick.
+    };
+
+    // The state of a set of nodes at one tick, ids are sorted and index the flat value array through offsets.
+    struct Snapshot {
+        uint32_t tick = 0;
+        Vector<uint32_t> ids;
+        Vector<uint32_t> offsets;
+        Vector<Variant> values;
+        Vector<float> steps; // Quantization step of every value.
+        Vector<Vector3> positions;
+        Vector<bool> has_position;
+
+        void clear();
+        int find(uint32_t p_id) const;
+    };
+
+    // Nodes sent to a peer at a tick, used to know what the peer has when it acknowledges that tick.
+    struct SentFrame {
+        uint32_t tick = 0;
+        Vector<uint32_t> ids;
+    };
+
+    struct PeerState {
+        SentFrame frames[SNAPSHOT_HISTORY];
+        uint32_t acked_tick = 0;
+        Vector3 interest_origin;
+        bool has_interest_origin = false;
+    };
+
+    MultiplayerAPI *multiplayer;
+    HashMap<ObjectID, ReplicatedNode> nodes;
+
+    // Server side.
+    Snapshot snapshots[SNAPSHOT_HISTORY];
+    HashMap<int, PeerState> peers;
+    uint32_t tick = 0;
+    uint64_t last_tick_usec = 0;
+    int tick_rate = 20;
+    float interest_radius = 0;
+    Vector<uint8_t> packet;
+    Vector<const Map<int, bool> *> pending_confirmations; // Per snapshot node, null when every peer knows its id.
+
+    // Client side.
+    Snapshot received[SNAPSHOT_HISTORY];
+    uint32_t applied_tick = 0;
+    HashMap<uint32_t, ObjectID> resolved_ids;
+    Snapshot decoding;
+
+    void _capture(Snapshot &r_snapshot);
+    void _send_to_peer(int p_peer, PeerState &p_state, const Snapshot &p_snapshot);
+    bool _is_interested(const PeerState &p_state, const Snapshot &p_snapshot, int p_index) const;
+    ObjectID _resolve(int p_from, uint32_t p_id);
+    void _apply(int p_from, const Snapshot &p_frame);
+
+public:
+    void add_property(Node *p_node, const StringName &p_property, float p_quantization_step);
+    void set_position_property(Node *p_node, const StringName &p_property);
+    void remove_node(Node *p_node);
+    bool has_node(Node *p_node) const;
+
+    void set_tick_rate(int p_rate) { tick_rate = p_rate; }
+    int get_tick_rate() const { return tick_rate; }
+    void set_interest_radius(float p_radius) { interest_radius = p_radius; }
+    float get_interest_radius() const { return interest_radius; }
+    void set_peer_interest_origin(int p_peer, const Vector3 &p_origin);
+
+    uint32_t get_tick() const { return tick; }
+    uint32_t get_applied_tick() const { return applied_tick; }
+
+    //! Sends a snapshot when a tick is due, called by MultiplayerAPI::poll on the server.
+    void poll();
+    void send_snapshot();
+    void process_snapshot(int p_from, const uint8_t *p_packet, int p_packet_len);
+    void process_ack(int p_from, const uint8_t *p_packet, int p_packet_len);
+    void remove_peer(int p_peer);
+    //! Forgets everything tied to the current connection, registrations are kept.
+    void clear();
+
+    explicit MultiplayerReplicator(MultiplayerAPI *p_multiplayer);
+};
@@ -40,3 +40,14 @@ NetSocket *NetSocket::create() {
     ERR_PRINT("Unable to create network socket, platform not supported");
     return nullptr;
 }
+
+NetSocketPoller *(*NetSocketPoller::_create)() = nullptr;
+
+NetSocketPoller *NetSocketPoller::create() {
+
+    if (_create)
+        return _create();
+
+    ERR_PRINT("Unable to create network socket poller, platform not supported");
+    return nullptr;
+}
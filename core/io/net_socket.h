@@ -32,6 +32,7 @@
 
 #include "core/io/ip.h"
 #include "core/reference.h"
+#include "core/vector.h"
 
 class NetSocket : public RefCounted {
 
@@ -76,3 +77,43 @@ public:
     virtual Error join_multicast_group(const IP_Address &p_multi_address, StringView p_if_name) = 0;
     virtual Error leave_multicast_group(const IP_Address &p_multi_address, StringView p_if_name) = 0;
 };
+
+/**
+ * Readiness multiplexer for many sockets (epoll on Linux, poll elsewhere), so a server only touches the
+ * sockets that have something to do instead of polling each of them every frame.
+ *
+ * Sockets stay registered until they are removed or closed, closing a socket unregisters it from every
+ * poller it was added to. Like NetSocket itself, a poller is not thread safe.
+ */
+class NetSocketPoller : public RefCounted {
+
+protected:
+    static NetSocketPoller *(*_create)();
+
+public:
+    static NetSocketPoller *create();
+
+    struct Event {
+        void *userdata;
+        bool readable;
+        bool writable;
+        bool error; //!< Hang-up or socket error, the owner should read or close to find out which.
+    };
+
+    //! Registers an open socket, p_userdata is reported back in the events for it.
+    virtual Error add(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) = 0;
+    //! Changes the readiness type and userdata of a registered socket.
+    virtual Error modify(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) = 0;
+    virtual void remove(const Ref<NetSocket> &p_sock) = 0;
+    //! Adds the socket, or updates its registration if it is already added.
+    Error watch(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) {
+        return has(p_sock) ? modify(p_sock, p_type, p_userdata) : add(p_sock, p_type, p_userdata);
+    }
+    virtual bool has(const Ref<NetSocket> &p_sock) const = 0;
+    virtual int get_socket_count() const = 0;
+    /**
+     * Appends an event for every ready socket to r_events, waiting at most p_timeout milliseconds (0 returns
+     * immediately, -1 waits forever). Returns ERR_BUSY when nothing became ready.
+     */
+    virtual Error wait(Vector<Event> &r_events, int p_timeout) = 0;
+};
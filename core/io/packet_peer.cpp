@@ -106,25 +106,16 @@ Error PacketPeer::get_var(Variant &r_variant, bool p_allow_objects) {
 
 Error PacketPeer::put_var(const Variant &p_packet, bool p_full_objects) {
 
-    int len;
-    Error err = encode_variant(p_packet, nullptr, len, p_full_objects || allow_object_decoding); // compute len first
-    if (err)
-        return err;
-
-    if (len == 0)
-        return OK;
+    // encode_buffer keeps its capacity, so encoding is a single pass without allocations once it has grown
+    encode_buffer.clear();
+    Error err = encode_variant(p_packet, encode_buffer, p_full_objects || allow_object_decoding);
+    ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to encode Variant.");
 
+    const int len = encode_buffer.size();
     ERR_FAIL_COND_V_MSG(len > encode_buffer_max_size, ERR_OUT_OF_MEMORY,
             "Failed to encode variant, encode size is bigger then encode_buffer_max_size. Consider raising it via "
             "'set_encode_buffer_max_size'.");
 
-    if (unlikely(encode_buffer.size() < len)) {
-        encode_buffer.resize(next_power_of_2(len));
-    }
-
-    err = encode_variant(p_packet, encode_buffer.data(), len, p_full_objects || allow_object_decoding);
-    ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to encode Variant.");
-
     return put_packet(encode_buffer.data(), len);
 }
 
@@ -204,6 +204,21 @@ Error PacketPeerUDP::wait() {
     return _sock->poll(NetSocket::POLL_TYPE_IN, -1);
 }
 
+Error PacketPeerUDP::add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata) {
+
+    ERR_FAIL_COND_V(not p_poller, ERR_INVALID_PARAMETER);
+    ERR_FAIL_COND_V(!is_listening(), ERR_UNCONFIGURED);
+
+    return p_poller->watch(_sock, NetSocket::POLL_TYPE_IN, p_userdata);
+}
+
+void PacketPeerUDP::remove_from_poller(const Ref<NetSocketPoller> &p_poller) {
+
+    ERR_FAIL_COND(not p_poller);
+    if (_sock)
+        p_poller->remove(_sock);
+}
+
 Error PacketPeerUDP::_poll() {
 
     ERR_FAIL_COND_V(not _sock, ERR_UNAVAILABLE);
@@ -71,6 +71,9 @@ public:
 
     void close();
     Error wait();
+    //! The socket becomes readable in p_poller when packets arrive, until close() is called.
+    Error add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata);
+    void remove_from_poller(const Ref<NetSocketPoller> &p_poller);
     bool is_listening() const;
     IP_Address get_packet_address() const;
     int get_packet_port() const;
@@ -35,6 +35,7 @@
 #include "core/io/file_access_compressed.h"
 #include "core/io/marshalls.h"
 #include "core/io/resource_loader.h"
+#include "core/io/resource_payload_streamer.h"
 #include "core/os/dir_access.h"
 #include "core/math/quat.h"
 #include "core/math/transform.h"
@@ -44,6 +45,7 @@
 #include "core/rid.h"
 #include "core/version.h"
 #include "core/object_tooling.h"
+#include "core/os/worker_thread_pool.h"
 
 #include "EASTL/sort.h"
 #include "core/resource/resource_manager.h"
@@ -102,18 +104,47 @@ enum {
     VARIANT_VECTOR3I = 47,
     VARIANT_INT64_ARRAY = 48,
     VARIANT_FLOAT64_ARRAY = 49,
+    VARIANT_PAYLOAD = 50,
     OBJECT_EMPTY = 0,
     OBJECT_EXTERNAL_RESOURCE = 1,
     OBJECT_INTERNAL_RESOURCE = 2,
     OBJECT_EXTERNAL_RESOURCE_INDEX = 3,
     //version 2: added 64 bits support for float and int
     //version 3: changed nodepath encoding
-    FORMAT_VERSION = 3,
+    //version 4: flat string table, block sizes and data relative offsets in the index, payload table
+    FORMAT_VERSION = 4,
     FORMAT_VERSION_CAN_RENAME_DEPS = 1,
     FORMAT_VERSION_NO_NODEPATH_PROPERTY = 3,
+    FORMAT_VERSION_INDEXED = 4,
+    //packed arrays at least this big are moved out of the resource blocks into the payload section
+    PAYLOAD_MIN_SIZE = 16384,
+    PAYLOAD_ALIGNMENT = 16,
 
     };
 
+static void _swap_elements(uint8_t *p_data, uint64_t p_count, uint32_t p_size) {
+
+    switch (p_size) {
+        case 2: {
+            uint16_t *d = (uint16_t *)p_data;
+            for (uint64_t i = 0; i < p_count; i++)
+                d[i] = BSWAP16(d[i]);
+        } break;
+        case 4: {
+            uint32_t *d = (uint32_t *)p_data;
+            for (uint64_t i = 0; i < p_count; i++)
+                d[i] = BSWAP32(d[i]);
+        } break;
+        case 8: {
+            uint64_t *d = (uint64_t *)p_data;
+            for (uint64_t i = 0; i < p_count; i++)
+                d[i] = BSWAP64(d[i]);
+        } break;
+        default: {
+        }
+    }
+}
+
 void ResourceInteractiveLoaderBinary::_advance_padding(uint32_t p_len) {
 
     uint32_t extra = 4 - (p_len % 4);
@@ -140,9 +171,10 @@ StringName ResourceInteractiveLoaderBinary::_get_string() {
     return string_map[id];
 }
 
-Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
+template <class Reader>
+static Error _parse_variant(Reader &r, Variant &r_v) {
 
-    uint32_t type = f->get_32();
+    uint32_t type = r.get_32();
     print_bl("find property of type: " + itos(type));
 
     switch (type) {
@@ -153,135 +185,135 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_BOOL: {
 
-            r_v = bool(f->get_32());
+            r_v = bool(r.get_32());
         } break;
         case VARIANT_INT: {
 
-            r_v = int(f->get_32());
+            r_v = int(r.get_32());
         } break;
         case VARIANT_INT64: {
 
-            r_v = int64_t(f->get_64());
+            r_v = int64_t(r.get_64());
         } break;
         case VARIANT_FLOAT: {
 
-            r_v = f->get_real();
+            r_v = r.get_real();
         } break;
         case VARIANT_DOUBLE: {
 
-            r_v = f->get_double();
+            r_v = r.get_double();
         } break;
         case VARIANT_STRING: {
 
-            r_v = get_unicode_string();
+            r_v = r.get_unicode_string();
         } break;
         case VARIANT_VECTOR2: {
 
             Vector2 v;
-            v.x = f->get_real();
-            v.y = f->get_real();
+            v.x = r.get_real();
+            v.y = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_RECT2: {
 
             Rect2 v;
-            v.position.x = f->get_real();
-            v.position.y = f->get_real();
-            v.size.x = f->get_real();
-            v.size.y = f->get_real();
+            v.position.x = r.get_real();
+            v.position.y = r.get_real();
+            v.size.x = r.get_real();
+            v.size.y = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_VECTOR3: {
 
             Vector3 v;
-            v.x = f->get_real();
-            v.y = f->get_real();
-            v.z = f->get_real();
+            v.x = r.get_real();
+            v.y = r.get_real();
+            v.z = r.get_real();
             r_v = v;
         } break;
         case VARIANT_PLANE: {
 
             Plane v;
-            v.normal.x = f->get_real();
-            v.normal.y = f->get_real();
-            v.normal.z = f->get_real();
-            v.d = f->get_real();
+            v.normal.x = r.get_real();
+            v.normal.y = r.get_real();
+            v.normal.z = r.get_real();
+            v.d = r.get_real();
             r_v = v;
         } break;
         case VARIANT_QUAT: {
             Quat v;
-            v.x = f->get_real();
-            v.y = f->get_real();
-            v.z = f->get_real();
-            v.w = f->get_real();
+            v.x = r.get_real();
+            v.y = r.get_real();
+            v.z = r.get_real();
+            v.w = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_AABB: {
 
             AABB v;
-            v.position.x = f->get_real();
-            v.position.y = f->get_real();
-            v.position.z = f->get_real();
-            v.size.x = f->get_real();
-            v.size.y = f->get_real();
-            v.size.z = f->get_real();
+            v.position.x = r.get_real();
+            v.position.y = r.get_real();
+            v.position.z = r.get_real();
+            v.size.x = r.get_real();
+            v.size.y = r.get_real();
+            v.size.z = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_MATRIX32: {
 
             Transform2D v;
-            v.elements[0].x = f->get_real();
-            v.elements[0].y = f->get_real();
-            v.elements[1].x = f->get_real();
-            v.elements[1].y = f->get_real();
-            v.elements[2].x = f->get_real();
-            v.elements[2].y = f->get_real();
+            v.elements[0].x = r.get_real();
+            v.elements[0].y = r.get_real();
+            v.elements[1].x = r.get_real();
+            v.elements[1].y = r.get_real();
+            v.elements[2].x = r.get_real();
+            v.elements[2].y = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_MATRIX3: {
 
             Basis v;
-            v.elements[0].x = f->get_real();
-            v.elements[0].y = f->get_real();
-            v.elements[0].z = f->get_real();
-            v.elements[1].x = f->get_real();
-            v.elements[1].y = f->get_real();
-            v.elements[1].z = f->get_real();
-            v.elements[2].x = f->get_real();
-            v.elements[2].y = f->get_real();
-            v.elements[2].z = f->get_real();
+            v.elements[0].x = r.get_real();
+            v.elements[0].y = r.get_real();
+            v.elements[0].z = r.get_real();
+            v.elements[1].x = r.get_real();
+            v.elements[1].y = r.get_real();
+            v.elements[1].z = r.get_real();
+            v.elements[2].x = r.get_real();
+            v.elements[2].y = r.get_real();
+            v.elements[2].z = r.get_real();
             r_v = v;
 
         } break;
         case VARIANT_TRANSFORM: {
 
             Transform v;
-            v.basis.elements[0].x = f->get_real();
-            v.basis.elements[0].y = f->get_real();
-            v.basis.elements[0].z = f->get_real();
-            v.basis.elements[1].x = f->get_real();
-            v.basis.elements[1].y = f->get_real();
-            v.basis.elements[1].z = f->get_real();
-            v.basis.elements[2].x = f->get_real();
-            v.basis.elements[2].y = f->get_real();
-            v.basis.elements[2].z = f->get_real();
-            v.origin.x = f->get_real();
-            v.origin.y = f->get_real();
-            v.origin.z = f->get_real();
+            v.basis.elements[0].x = r.get_real();
+            v.basis.elements[0].y = r.get_real();
+            v.basis.elements[0].z = r.get_real();
+            v.basis.elements[1].x = r.get_real();
+            v.basis.elements[1].y = r.get_real();
+            v.basis.elements[1].z = r.get_real();
+            v.basis.elements[2].x = r.get_real();
+            v.basis.elements[2].y = r.get_real();
+            v.basis.elements[2].z = r.get_real();
+            v.origin.x = r.get_real();
+            v.origin.y = r.get_real();
+            v.origin.z = r.get_real();
             r_v = v;
         } break;
         case VARIANT_COLOR: {
 
             Color v;
-            v.r = f->get_real();
-            v.g = f->get_real();
-            v.b = f->get_real();
-            v.a = f->get_real();
+            v.r = r.get_real();
+            v.g = r.get_real();
+            v.b = r.get_real();
+            v.a = r.get_real();
             r_v = v;
 
         } break;
@@ -292,18 +324,18 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
             Vector<StringName> subnames;
             bool absolute;
 
-            int name_count = f->get_16();
-            uint32_t subname_count = f->get_16();
+            int name_count = r.get_16();
+            uint32_t subname_count = r.get_16();
             absolute = subname_count & 0x8000;
             subname_count &= 0x7FFF;
-            if (ver_format < FORMAT_VERSION_NO_NODEPATH_PROPERTY) {
+            if (r.ver_format < FORMAT_VERSION_NO_NODEPATH_PROPERTY) {
                 subname_count += 1; // has a property field, so we should count it as well
             }
 
             for (int i = 0; i < name_count; i++)
-                names.push_back(_get_string());
+                names.push_back(r.get_string());
             for (uint32_t i = 0; i < subname_count; i++)
-                subnames.push_back(_get_string());
+                subnames.push_back(r.get_string());
 
             NodePath np = NodePath(eastl::move(names), eastl::move(subnames), absolute);
 
@@ -312,95 +344,33 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_RID: {
 
-            r_v = f->get_32();
+            r_v = r.get_32();
         } break;
         case VARIANT_OBJECT: {
 
-            uint32_t objtype = f->get_32();
+            Error err = r.parse_object(r_v);
+            if (err != OK)
+                return err;
 
-            switch (objtype) {
-
-                case OBJECT_EMPTY: {
-                    //do none
-
-                } break;
-                case OBJECT_INTERNAL_RESOURCE: {
-                    uint32_t index = f->get_32();
-                    String path = res_path + "::" + ::to_string(index);
-                    RES res(gResourceManager().load(path));
-                    if (not res) {
-                        WARN_PRINT("Couldn't load resource: " + path);
-                    }
-                    r_v = res;
-
-                } break;
-                case OBJECT_EXTERNAL_RESOURCE: {
-                    //old file format, still around for compatibility
-
-                    String exttype = get_unicode_string();
-                    String path = get_unicode_string();
-
-                    if (!StringUtils::contains(path,"://") && PathUtils::is_rel_path(path)) {
-                        // path is relative to file being loaded, so convert to a resource path
-                        path = ProjectSettings::get_singleton()->localize_path(PathUtils::plus_file(PathUtils::get_base_dir(res_path),path));
-                    }
-
-                    if (remaps.contains(path)) {
-                        path = remaps[path];
-                    }
-
-                    RES res(gResourceManager().load(path, exttype));
-
-                    if (not res) {
-                        WARN_PRINT(("Couldn't load resource: " + path));
-                    }
-                    r_v = res;
-
-                } break;
-                case OBJECT_EXTERNAL_RESOURCE_INDEX: {
-                    //new file format, just refers to an index in the external list
-                    int erindex = f->get_32();
-
-                    if (erindex < 0 || erindex >= external_resources.size()) {
-                        WARN_PRINT("Broken external resource! (index out of size)");
-                        r_v = Variant();
-                    } else {
-
-                        String exttype = external_resources[erindex].type;
-                        String path = external_resources[erindex].path;
-
-                        if (!StringUtils::contains(path,"://") && PathUtils::is_rel_path(path)) {
-                            // path is relative to file being loaded, so convert to a resource path
-                            path = ProjectSettings::get_singleton()->localize_path(PathUtils::plus_file(PathUtils::get_base_dir(res_path),path));
-                        }
-
-                        RES res(gResourceManager().load(path, exttype));
-
-                        if (not res) {
-                            WARN_PRINT(("Couldn't load resource: " + path));
-                        }
-                        r_v = res;
-                    }
+        } break;
+        case VARIANT_PAYLOAD: {
 
-                } break;
-                default: {
-
-                    ERR_FAIL_V(ERR_FILE_CORRUPT);
-                } break;
-            }
+            Error err = r.get_payload(r.get_32(), r_v);
+            if (err != OK)
+                return err;
 
         } break;
         case VARIANT_DICTIONARY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
             Dictionary d; //last bit means shared
             len &= 0x7FFFFFFF;
             for (uint32_t i = 0; i < len; i++) {
                 Variant key;
-                Error err = parse_variant(key);
+                Error err = _parse_variant(r, key);
                 ERR_FAIL_COND_V_MSG(err, ERR_FILE_CORRUPT, "Error when trying to parse Variant.");
                 Variant value;
-                err = parse_variant(value);
+                err = _parse_variant(r, value);
                 ERR_FAIL_COND_V_MSG(err, ERR_FILE_CORRUPT, "Error when trying to parse Variant.");
                 d[key] = value;
             }
@@ -408,13 +378,13 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
             Array a; //last bit means shared
             len &= 0x7FFFFFFF;
             a.resize(len);
             for (uint32_t i = 0; i < len; i++) {
                 Variant val;
-                Error err = parse_variant(val);
+                Error err = _parse_variant(r, val);
                 ERR_FAIL_COND_V_MSG(err, ERR_FILE_CORRUPT, "Error when trying to parse Variant.");
                 a[i] = val;
             }
@@ -423,61 +393,61 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_RAW_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<uint8_t> array;
             array.resize(len);
             PoolVector<uint8_t>::Write w = array.write();
-            f->get_buffer(w.ptr(), len);
-            _advance_padding(len);
+            r.get_elements(w.ptr(), len, 1);
+            r.advance_padding(len);
             w.release();
             r_v = array;
 
         } break;
         case VARIANT_INT32_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<int> array;
             array.resize(len);
             PoolVector<int>::Write w = array.write();
-            f->get_buffer((uint8_t *)w.ptr(), len * 4);
+            r.get_elements((uint8_t *)w.ptr(), len, 4);
             w.release();
             r_v = array;
         } break;
         case VARIANT_FLOAT32_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<real_t> array;
             array.resize(len);
             PoolVector<real_t>::Write w = array.write();
-            f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t));
+            r.get_elements((uint8_t *)w.ptr(), len, sizeof(real_t));
 
             w.release();
             r_v = array;
         } break;
         case VARIANT_STRING_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
             PoolVector<String> array;
             array.resize(len);
             PoolVector<String>::Write w = array.write();
             for (uint32_t i = 0; i < len; i++)
-                w[i] = get_unicode_string();
+                w[i] = r.get_unicode_string();
             w.release();
             r_v = array;
 
         } break;
         case VARIANT_VECTOR2_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<Vector2> array;
             array.resize(len);
             PoolVector<Vector2>::Write w = array.write();
             if constexpr (sizeof(Vector2) == 8) {
-                f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 2);
+                r.get_elements((uint8_t *)w.ptr(), len * 2, sizeof(real_t));
 
             } else {
                 ERR_FAIL_V_MSG(ERR_UNAVAILABLE, "Vector2 size is NOT 8!");
@@ -488,13 +458,13 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_VECTOR3_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<Vector3> array;
             array.resize(len);
             PoolVector<Vector3>::Write w = array.write();
             if constexpr (sizeof(Vector3) == 12) {
-                f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 3);
+                r.get_elements((uint8_t *)w.ptr(), len * 3, sizeof(real_t));
 
             } else {
                 ERR_FAIL_V_MSG(ERR_UNAVAILABLE, "Vector3 size is NOT 12!");
@@ -505,13 +475,13 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
         } break;
         case VARIANT_COLOR_ARRAY: {
 
-            uint32_t len = f->get_32();
+            uint32_t len = r.get_32();
 
             PoolVector<Color> array;
             array.resize(len);
             PoolVector<Color>::Write w = array.write();
             if constexpr (sizeof(Color) == 16) {
-                f->get_buffer((uint8_t *)w.ptr(), len * sizeof(real_t) * 4);
+                r.get_elements((uint8_t *)w.ptr(), len * 4, sizeof(real_t));
 
 
             } else {
@@ -528,6 +498,280 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
     return OK; //never reach anyway
 }
 
+/**
+ * Readers used by _parse_variant:
+ * FileVariantReader reads format 3 and older files straight from the FileAccess, resolving resources through
+ * the ResourceManager as they are found. BlockVariantReader decodes an in-memory resource block of a format 4
+ * file, it only does read-only lookups into tables built before decoding, so blocks can be decoded concurrently.
+ */
+struct ResourceInteractiveLoaderBinary::FileVariantReader {
+
+    ResourceInteractiveLoaderBinary *loader;
+    FileAccess *f;
+    uint32_t ver_format;
+
+    explicit FileVariantReader(ResourceInteractiveLoaderBinary *p_loader) :
+            loader(p_loader), f(p_loader->f), ver_format(p_loader->ver_format) {}
+
+    uint8_t get_8() { return f->get_8(); }
+    uint16_t get_16() { return f->get_16(); }
+    uint32_t get_32() { return f->get_32(); }
+    uint64_t get_64() { return f->get_64(); }
+    real_t get_real() { return f->get_real(); }
+    double get_double() { return f->get_double(); }
+    void get_elements(uint8_t *p_dst, uint32_t p_count, uint32_t p_size) { f->get_buffer(p_dst, p_count * p_size); }
+    void advance_padding(uint32_t p_len) { loader->_advance_padding(p_len); }
+    StringName get_string() { return loader->_get_string(); }
+    String get_unicode_string() { return loader->get_unicode_string(); }
+
+    Error get_payload(uint32_t /*p_index*/, Variant & /*r_v*/) {
+        ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Payload reference in a file without payload table.");
+    }
+
+    Error parse_object(Variant &r_v) {
+
+        uint32_t objtype = f->get_32();
+
+        switch (objtype) {
+
+            case OBJECT_EMPTY: {
+                //do none
+
+            } break;
+            case OBJECT_INTERNAL_RESOURCE: {
+                uint32_t index = f->get_32();
+                String path = loader->res_path + "::" + ::to_string(index);
+                RES res(gResourceManager().load(path));
+                if (not res) {
+                    WARN_PRINT("Couldn't load resource: " + path);
+                }
+                r_v = res;
+
+            } break;
+            case OBJECT_EXTERNAL_RESOURCE: {
+                //old file format, still around for compatibility
+
+                String exttype = loader->get_unicode_string();
+                String path = loader->get_unicode_string();
+
+                if (!StringUtils::contains(path,"://") && PathUtils::is_rel_path(path)) {
+                    // path is relative to file being loaded, so convert to a resource path
+                    path = ProjectSettings::get_singleton()->localize_path(PathUtils::plus_file(PathUtils::get_base_dir(loader->res_path),path));
+                }
+
+                if (loader->remaps.contains(path)) {
+                    path = loader->remaps[path];
+                }
+
+                RES res(gResourceManager().load(path, exttype));
+
+                if (not res) {
+                    WARN_PRINT(("Couldn't load resource: " + path));
+                }
+                r_v = res;
+
+            } break;
+            case OBJECT_EXTERNAL_RESOURCE_INDEX: {
+                //new file format, just refers to an index in the external list
+                int erindex = f->get_32();
+
+                if (erindex < 0 || erindex >= loader->external_resources.size()) {
+                    WARN_PRINT("Broken external resource! (index out of size)");
+                    r_v = Variant();
+                } else {
+
+                    String exttype = loader->external_resources[erindex].type;
+                    String path = loader->external_resources[erindex].path;
+
+                    if (!StringUtils::contains(path,"://") && PathUtils::is_rel_path(path)) {
+                        // path is relative to file being loaded, so convert to a resource path
+                        path = ProjectSettings::get_singleton()->localize_path(PathUtils::plus_file(PathUtils::get_base_dir(loader->res_path),path));
+                    }
+
+                    RES res(gResourceManager().load(path, exttype));
+
+                    if (not res) {
+                        WARN_PRINT(("Couldn't load resource: " + path));
+                    }
+                    r_v = res;
+                }
+
+            } break;
+            default: {
+
+                ERR_FAIL_V(ERR_FILE_CORRUPT);
+            } break;
+        }
+
+        return OK;
+    }
+};
+
+struct ResourceInteractiveLoaderBinary::BlockVariantReader {
+
+    const ResourceInteractiveLoaderBinary *loader;
+    const HashMap<int, RES> *internal;
+    const uint8_t *ptr;
+    const uint8_t *end;
+    uint32_t ver_format;
+    bool swap;
+    bool overrun = false;
+
+    BlockVariantReader(const ResourceInteractiveLoaderBinary *p_loader, const HashMap<int, RES> *p_internal, const uint8_t *p_block, uint32_t p_size) :
+            loader(p_loader),
+            internal(p_internal),
+            ptr(p_block),
+            end(p_block + p_size),
+            ver_format(p_loader->ver_format),
+            swap(p_loader->big_endian) {}
+
+    bool _can_read(uint64_t p_bytes) {
+        if (uint64_t(end - ptr) < p_bytes) {
+            overrun = true;
+            ptr = end;
+            return false;
+        }
+        return true;
+    }
+
+    uint8_t get_8() {
+        return _can_read(1) ? *ptr++ : 0;
+    }
+    uint16_t get_16() {
+        uint16_t v = 0;
+        if (_can_read(2)) {
+            memcpy(&v, ptr, 2);
+            ptr += 2;
+        }
+        return swap ? BSWAP16(v) : v;
+    }
+    uint32_t get_32() {
+        uint32_t v = 0;
+        if (_can_read(4)) {
+            memcpy(&v, ptr, 4);
+            ptr += 4;
+        }
+        return swap ? BSWAP32(v) : v;
+    }
+    uint64_t get_64() {
+        uint64_t v = 0;
+        if (_can_read(8)) {
+            memcpy(&v, ptr, 8);
+            ptr += 8;
+        }
+        return swap ? BSWAP64(v) : v;
+    }
+    double get_double() {
+        uint64_t v = get_64();
+        double d;
+        memcpy(&d, &v, 8);
+        return d;
+    }
+    real_t get_real() {
+        // Matches FileAccess::store_real, which writes real_t at its native size.
+        if constexpr (sizeof(real_t) == 8) {
+            return get_double();
+        } else {
+            uint32_t v = get_32();
+            float fl;
+            memcpy(&fl, &v, 4);
+            return fl;
+        }
+    }
+    void get_elements(uint8_t *p_dst, uint32_t p_count, uint32_t p_size) {
+        uint64_t bytes = uint64_t(p_count) * p_size;
+        if (!_can_read(bytes)) {
+            return;
+        }
+        memcpy(p_dst, ptr, bytes);
+        ptr += bytes;
+        if (swap) {
+            _swap_elements(p_dst, p_count, p_size);
+        }
+    }
+    void advance_padding(uint32_t p_len) {
+        uint32_t extra = 4 - (p_len % 4);
+        if (extra < 4 && _can_read(extra)) {
+            ptr += extra;
+        }
+    }
+    const char *_get_chars(uint32_t p_len, size_t &r_length) {
+        if (!_can_read(p_len)) {
+            r_length = 0;
+            return "";
+        }
+        const char *s = (const char *)ptr;
+        ptr += p_len;
+        r_length = strnlen(s, p_len);
+        return s;
+    }
+    StringName get_string() {
+        uint32_t id = get_32();
+        if (id & 0x80000000) {
+            size_t len;
+            const char *s = _get_chars(id & 0x7FFFFFFF, len);
+            return len ? StringName(StringView(s, len)) : StringName();
+        }
+        if (id >= uint32_t(loader->string_map.size())) {
+            overrun = true;
+            return StringName();
+        }
+        return loader->string_map[id];
+    }
+    String get_unicode_string() {
+        size_t len;
+        const char *s = _get_chars(get_32(), len);
+        return String(s, len);
+    }
+
+    Error get_payload(uint32_t p_index, Variant &r_v) {
+        ERR_FAIL_COND_V_MSG(p_index >= uint32_t(loader->payloads.size()), ERR_FILE_CORRUPT, "Payload index out of range.");
+        r_v = loader->payloads[p_index];
+        return OK;
+    }
+
+    Error parse_object(Variant &r_v) {
+
+        uint32_t objtype = get_32();
+
+        switch (objtype) {
+
+            case OBJECT_EMPTY: {
+            } break;
+            case OBJECT_INTERNAL_RESOURCE: {
+                uint32_t index = get_32();
+                auto iter = internal->find(int(index));
+                if (iter == internal->end()) {
+                    WARN_PRINT("Couldn't load resource: " + loader->res_path + "::" + ::to_string(index));
+                } else {
+                    r_v = iter->second;
+                }
+            } break;
+            case OBJECT_EXTERNAL_RESOURCE_INDEX: {
+                // External resources were all loaded by the earlier stages.
+                uint32_t erindex = get_32();
+                if (erindex >= uint32_t(loader->external_cache.size())) {
+                    WARN_PRINT("Broken external resource! (index out of size)");
+                    r_v = Variant();
+                } else {
+                    r_v = loader->external_cache[erindex];
+                }
+            } break;
+            default: {
+                ERR_FAIL_V(ERR_FILE_CORRUPT);
+            }
+        }
+
+        return OK;
+    }
+};
+
+Error ResourceInteractiveLoaderBinary::parse_variant(Variant &r_v) {
+
+    FileVariantReader reader(this);
+    return _parse_variant(reader, r_v);
+}
+
 void ResourceInteractiveLoaderBinary::set_local_path(StringView p_local_path) {
 
     res_path = p_local_path;
@@ -565,6 +809,7 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
         } else {
             resource_cache.push_back(res);
+            external_cache[s] = res;
         }
 
         stage++;
@@ -579,6 +824,21 @@ Error ResourceInteractiveLoaderBinary::poll() {
         ERR_FAIL_COND_V(s >= internal_resources.size(), error);
     }
 
+    if (ver_format < FORMAT_VERSION_INDEXED) {
+        return _poll_internal_v3(s);
+    }
+
+    if (decoded_resources.empty()) {
+        error = _decode_resources();
+        if (error != OK) {
+            return error;
+        }
+    }
+    return _poll_internal_decoded(s);
+}
+
+Error ResourceInteractiveLoaderBinary::_poll_internal_v3(int s) {
+
     bool main = s == (internal_resources.size() - 1);
 
     //maybe it is loaded already
@@ -671,6 +931,241 @@ Error ResourceInteractiveLoaderBinary::poll() {
 
     return OK;
 }
+static VariantType _payload_variant_type(uint32_t p_type) {
+
+    switch (p_type) {
+        case VARIANT_RAW_ARRAY: return VariantType::POOL_BYTE_ARRAY;
+        case VARIANT_INT32_ARRAY: return VariantType::POOL_INT_ARRAY;
+        case VARIANT_FLOAT32_ARRAY: return VariantType::POOL_REAL_ARRAY;
+        case VARIANT_VECTOR2_ARRAY: return VariantType::POOL_VECTOR2_ARRAY;
+        case VARIANT_VECTOR3_ARRAY: return VariantType::POOL_VECTOR3_ARRAY;
+        case VARIANT_COLOR_ARRAY: return VariantType::POOL_COLOR_ARRAY;
+        default: return VariantType::NIL;
+    }
+}
+
+/**
+ * Loads everything a format 4 file needs to build its resources in three phases:
+ * all resource blocks are read with a single call and large packed arrays are read straight into their
+ * final storage, then every resource object is instanced so internal references can be resolved, finally
+ * the blocks are decoded in parallel. The decoded properties are applied in order by the following stages.
+ */
+Error ResourceInteractiveLoaderBinary::_decode_resources() {
+
+    // offsets and sizes come from the file, nothing is allocated for data the file can't contain
+    const uint64_t file_len = f->get_len();
+    ERR_FAIL_COND_V_MSG(data_ofs > file_len, ERR_FILE_CORRUPT, "Premature end of file (EOF): " + local_path + ".");
+    const uint64_t data_len = file_len - data_ofs;
+
+    uint64_t blocks_size = 0;
+    for (const IntResource &ir : internal_resources) {
+        ERR_FAIL_COND_V_MSG(ir.offset > data_len || ir.size > data_len - ir.offset, ERR_FILE_CORRUPT, "Resource block out of range: " + local_path + ".");
+        blocks_size = M_MAX(blocks_size, ir.offset + ir.size);
+    }
+
+    Vector<uint8_t> blocks;
+    blocks.resize(blocks_size);
+    f->seek(data_ofs);
+    if (uint64_t(f->get_buffer(blocks.data(), blocks_size)) != blocks_size) {
+        ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Premature end of file (EOF): " + local_path + ".");
+    }
+
+    if (payload_table_ofs) {
+
+        const uint64_t payload_entry_size = 16;
+        ERR_FAIL_COND_V_MSG(data_len < 4 || payload_table_ofs > data_len - 4, ERR_FILE_CORRUPT, "Broken payload table: " + local_path + ".");
+        f->seek(data_ofs + payload_table_ofs);
+        uint32_t payload_count = f->get_32();
+        ERR_FAIL_COND_V_MSG(payload_count > (data_len - payload_table_ofs - 4) / payload_entry_size, ERR_FILE_CORRUPT, "Broken payload table: " + local_path + ".");
+        struct PayloadEntry {
+            uint32_t type;
+            uint32_t count;
+            uint64_t offset;
+        };
+        Vector<PayloadEntry> entries;
+        entries.reserve(payload_count);
+        for (uint32_t i = 0; i < payload_count && !f->eof_reached(); i++) {
+            PayloadEntry pe;
+            pe.type = f->get_32();
+            pe.count = f->get_32();
+            pe.offset = f->get_64();
+            entries.push_back(pe);
+        }
+        ERR_FAIL_COND_V_MSG(entries.size() != payload_count, ERR_FILE_CORRUPT, "Broken payload table: " + local_path + ".");
+
+        const uint64_t lazy_min_size = ResourcePayloadStreamer::get_singleton()->get_lazy_min_size();
+
+        payloads.resize(payload_count);
+        for (uint32_t i = 0; i < payload_count; i++) {
+            VariantType vt = _payload_variant_type(entries[i].type);
+            ERR_FAIL_COND_V_MSG(vt == VariantType::NIL, ERR_FILE_CORRUPT, "Unknown payload type: " + ::to_string(entries[i].type) + ".");
+            const uint64_t payload_size = uint64_t(entries[i].count) * StreamedPayload::get_element_size(vt);
+            ERR_FAIL_COND_V_MSG(entries[i].offset > data_len || payload_size > data_len - entries[i].offset, ERR_FILE_CORRUPT, "Payload out of range: " + local_path + ".");
+
+            if (lazy_payloads && payload_size >= lazy_min_size) {
+                payloads[i] = StreamedPayload::create(file_path, data_ofs + entries[i].offset, vt, entries[i].count, big_endian);
+                continue;
+            }
+            f->seek(data_ofs + entries[i].offset);
+            payloads[i] = StreamedPayload::read_array(f, vt, entries[i].count, big_endian);
+        }
+        ERR_FAIL_COND_V_MSG(f->eof_reached(), ERR_FILE_CORRUPT, "Premature end of file (EOF): " + local_path + ".");
+    }
+
+    HashMap<int, RES> internal_map;
+    decoded_resources.resize(internal_resources.size());
+
+    for (int i = 0; i < internal_resources.size(); i++) {
+
+        const IntResource &ir = internal_resources[i];
+        DecodedResource &dr = decoded_resources[i];
+        bool main = i == (internal_resources.size() - 1);
+
+        if (!main) {
+
+            dr.path = ir.path;
+            if (StringUtils::begins_with(dr.path, "local://")) {
+                dr.path = StringUtils::replace_first(dr.path, "local://", "");
+                dr.subindex = StringUtils::to_int(dr.path);
+                dr.path = res_path + "::" + dr.path;
+            }
+
+            if (ResourceCache::has(dr.path)) {
+                //already loaded, references go to the cached one
+                dr.cached = true;
+                dr.res = RES(ResourceCache::get(dr.path));
+                if (dr.subindex != 0) {
+                    internal_map[dr.subindex] = dr.res;
+                }
+                continue;
+            }
+        } else if (!ResourceCache::has(res_path)) {
+            dr.path = res_path;
+        }
+
+        BlockVariantReader reader(this, &internal_map, blocks.data() + ir.offset, ir.size);
+        String t = reader.get_unicode_string();
+
+        Object *obj = ClassDB::instance(StringName(t));
+        if (!obj) {
+            ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource of unrecognized type in file: " + t + ".");
+        }
+
+        Resource *r = object_cast<Resource>(obj);
+        if (!r) {
+            const char *obj_class = obj->get_class();
+            memdelete(obj); //bye
+            ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, local_path + ":Resource type in resource field not a resource, type is: " + obj_class + ".");
+        }
+
+        dr.res = RES(r);
+        if (dr.subindex != 0) {
+            internal_map[dr.subindex] = dr.res;
+        }
+    }
+
+    Vector<Error> errors;
+    errors.resize(decoded_resources.size(), OK);
+
+    WorkerThreadPool::get_singleton()->parallel_for(decoded_resources.size(), [&](uint32_t p_index) {
+
+        DecodedResource &dr = decoded_resources[p_index];
+        if (dr.cached) {
+            return;
+        }
+
+        const IntResource &ir = internal_resources[p_index];
+        BlockVariantReader reader(this, &internal_map, blocks.data() + ir.offset, ir.size);
+        reader.get_unicode_string(); //type, already instanced
+
+        uint32_t pc = reader.get_32();
+        dr.properties.reserve(MIN(pc, ir.size / 8));
+
+        for (uint32_t i = 0; i < pc; i++) {
+
+            StringName name = reader.get_string();
+            if (name == StringName()) {
+                errors[p_index] = ERR_FILE_CORRUPT;
+                return;
+            }
+
+            Variant value;
+            Error err = _parse_variant(reader, value);
+            if (err != OK || reader.overrun) {
+                errors[p_index] = ERR_FILE_CORRUPT;
+                return;
+            }
+            dr.properties.emplace_back(eastl::move(name), eastl::move(value));
+        }
+    });
+
+    payloads.clear();
+
+    for (int i = 0; i < errors.size(); i++) {
+        if (errors[i] != OK) {
+            decoded_resources.clear();
+            ERR_FAIL_V_MSG(errors[i], local_path + ": Corrupt resource block: " + internal_resources[i].path + ".");
+        }
+    }
+
+    return OK;
+}
+
+Error ResourceInteractiveLoaderBinary::_poll_internal_decoded(int p_index) {
+
+    DecodedResource &dr = decoded_resources[p_index];
+    bool main = p_index == (internal_resources.size() - 1);
+
+    if (dr.cached) {
+        //already loaded, don't do anything
+        stage++;
+        error = OK;
+        return error;
+    }
+
+    RES res(eastl::move(dr.res));
+
+    res->set_path(dr.path);
+    res->set_subindex(dr.subindex);
+
+    StreamedPayloadOwner *owner = lazy_payloads ? dynamic_cast<StreamedPayloadOwner *>(res.get()) : nullptr;
+
+    for (eastl::pair<StringName, Variant> &property : dr.properties) {
+        if (lazy_payloads && StreamedPayload::is_streamed(property.second)) {
+            if (owner && owner->_set_streamed_property(property.first, property.second)) {
+                continue;
+            }
+            //resource can't defer it, read it now
+            Error err = StreamedPayload::resolve(property.second);
+            if (err != OK) {
+                error = err;
+                ERR_FAIL_V_MSG(error, local_path + ": Failed to read data of property " + property.first + ".");
+            }
+        }
+        res->set(property.first, property.second);
+    }
+    dr.properties.clear();
+
+    Object_set_edited(res.get(), false);
+    stage++;
+
+    resource_cache.push_back(res);
+
+    if (main) {
+
+        f->close();
+        decoded_resources.clear();
+        resource = res;
+        resource->set_as_translation_remapped(translation_remapped);
+        error = ERR_FILE_EOF;
+
+    } else {
+        error = OK;
+    }
+
+    return OK;
+}
+
 int ResourceInteractiveLoaderBinary::get_stage() const {
 
     return stage;
@@ -757,10 +1252,13 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
         ERR_FAIL_MSG("Unrecognized binary resource file: " + local_path + ".");
     }
 
-    bool big_endian = f->get_32();
+    //payloads are read straight from the file later, which compressed files can't do
+    lazy_payloads = f == p_f && !file_path.empty() && ResourcePayloadStreamer::get_singleton()->is_lazy_loading_enabled();
+
+    big_endian = f->get_32();
     bool use_real64 = f->get_32();
 
-    f->set_endian_swap(big_endian != 0); //read big endian if saved as big endian
+    f->set_endian_swap(big_endian); //read big endian if saved as big endian
 
     uint32_t ver_major = f->get_32();
     uint32_t ver_minor = f->get_32();
@@ -786,14 +1284,44 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
     print_bl("type: " + type);
 
     importmd_ofs = f->get_64();
-    for (int i = 0; i < 14; i++)
+    payload_table_ofs = f->get_64(); //reserved and zero before format 4
+    for (int i = 0; i < 12; i++)
         f->get_32(); //skip a few reserved fields
 
     uint32_t string_table_size = f->get_32();
-    string_map.reserve(string_table_size);
-    for (uint32_t i = 0; i < string_table_size; i++) {
+    if (ver_format >= FORMAT_VERSION_INDEXED) {
+        //one blob of zero terminated strings
+        uint32_t blob_size = f->get_32();
+        // every string takes at least its terminator
+        if (blob_size > f->get_len() - f->get_position() || string_table_size > blob_size) {
+            error = ERR_FILE_CORRUPT;
+            f->close();
+            ERR_FAIL_MSG("Broken string table: " + local_path + ".");
+        }
+        string_map.reserve(string_table_size);
+        str_buf.resize(blob_size + 1);
+        f->get_buffer((uint8_t *)str_buf.data(), blob_size);
+        str_buf[blob_size] = 0;
+        _advance_padding(blob_size);
+
+        const char *s = str_buf.data();
+        const char *end = s + blob_size;
+        for (uint32_t i = 0; i < string_table_size && s < end; i++) {
+            size_t len = strlen(s);
+            string_map.emplace_back(StringView(s, len));
+            s += len + 1;
+        }
+        if (uint32_t(string_map.size()) != string_table_size) {
+            error = ERR_FILE_CORRUPT;
+            f->close();
+            ERR_FAIL_MSG("Broken string table: " + local_path + ".");
+        }
+    } else {
+        string_map.reserve(string_table_size);
+        for (uint32_t i = 0; i < string_table_size; i++) {
 
-        string_map.emplace_back(get_unicode_string());
+            string_map.emplace_back(get_unicode_string());
+        }
     }
 
     print_bl("strings: " + itos(string_table_size));
@@ -808,6 +1336,7 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 
         external_resources.push_back(er);
     }
+    external_cache.resize(external_resources.size());
 
     print_bl("ext resources: " + itos(ext_resources_size));
     uint32_t int_resources_size = f->get_32();
@@ -817,8 +1346,12 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
         IntResource ir;
         ir.path = get_unicode_string();
         ir.offset = f->get_64();
+        if (ver_format >= FORMAT_VERSION_INDEXED) {
+            ir.size = f->get_32(); //offset is relative to the data section
+        }
         internal_resources.push_back(ir);
     }
+    data_ofs = f->get_position();
 
     print_bl("int resources: " + itos(int_resources_size));
 
@@ -895,6 +1428,7 @@ Ref<ResourceInteractiveLoader> ResourceFormatLoaderBinary::load_interactive(Stri
     StringView path = !p_original_path.empty() ? p_original_path : p_path;
     ria->local_path = ProjectSettings::get_singleton()->localize_path(path);
     ria->res_path = ria->local_path;
+    ria->file_path = p_path;
     //ria->set_local_path( Globals::get_singleton()->localize_path(p_path) );
     ria->open(f);
 
@@ -1068,8 +1602,7 @@ Error ResourceFormatLoaderBinary::rename_dependencies(StringView _path, const Ha
     fw->store_64(0); //metadata offset
 
     for (int i = 0; i < 14; i++) {
-        fw->store_32(0);
-        f->get_32();
+        fw->store_32(f->get_32()); //reserved, format 4 keeps the payload table offset here
     }
 
     //string table
@@ -1077,10 +1610,20 @@ Error ResourceFormatLoaderBinary::rename_dependencies(StringView _path, const Ha
 
     fw->store_32(string_table_size);
 
-    for (uint32_t i = 0; i < string_table_size; i++) {
+    if (ver_format >= FORMAT_VERSION_INDEXED) {
+        uint32_t blob_size = f->get_32();
+        uint32_t padded_size = (blob_size + 3) & ~3;
+        Vector<uint8_t> blob;
+        blob.resize(padded_size);
+        f->get_buffer(blob.data(), padded_size);
+        fw->store_32(blob_size);
+        fw->store_buffer(blob.data(), padded_size);
+    } else {
+        for (uint32_t i = 0; i < string_table_size; i++) {
 
-        String s = get_ustring(f);
-        save_ustring(fw, s);
+            String s = get_ustring(f);
+            save_ustring(fw, s);
+        }
     }
 
     //external resources
@@ -1122,7 +1665,13 @@ Error ResourceFormatLoaderBinary::rename_dependencies(StringView _path, const Ha
         String path = get_ustring(f);
         uint64_t offset = f->get_64();
         save_ustring(fw, path);
-        fw->store_64(offset + size_diff);
+        if (ver_format >= FORMAT_VERSION_INDEXED) {
+            //offsets are relative to the data section, which moves as a whole
+            fw->store_64(offset);
+            fw->store_32(f->get_32());
+        } else {
+            fw->store_64(offset + size_diff);
+        }
     }
 
     //rest of file
@@ -1151,6 +1700,31 @@ Error ResourceFormatLoaderBinary::rename_dependencies(StringView _path, const Ha
     return OK;
 }
 
+Error ResourceFormatLoaderBinary::convert_file_to_current_format(StringView p_src_path, StringView p_dst_path) {
+
+    Error err;
+    FileAccess *f = FileAccess::open(p_src_path, FileAccess::READ, &err);
+
+    ERR_FAIL_COND_V_MSG(err != OK, ERR_CANT_OPEN, "Cannot open file '" + String(p_src_path) + "'.");
+
+    Ref<ResourceInteractiveLoaderBinary> ria(make_ref_counted<ResourceInteractiveLoaderBinary>());
+    ria->local_path = ProjectSettings::get_singleton()->localize_path(p_src_path);
+    ria->res_path = ria->local_path;
+    ria->open(f);
+    ERR_FAIL_COND_V(ria->error != OK, ria->error);
+
+    err = ria->poll();
+    while (err == OK) {
+        err = ria->poll();
+    }
+
+    ERR_FAIL_COND_V(err != ERR_FILE_EOF, ERR_FILE_CORRUPT);
+    RES res(ria->get_resource());
+    ERR_FAIL_COND_V(not res, ERR_FILE_CORRUPT);
+
+    return ResourceFormatSaverBinary::singleton->save(p_dst_path, res);
+}
+
 String ResourceFormatLoaderBinary::get_resource_type(StringView p_path) const {
 
     FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
@@ -1181,10 +1755,22 @@ void ResourceFormatSaverBinaryInstance::_pad_buffer(FileAccess *f, int p_bytes)
 
 void ResourceFormatSaverBinaryInstance::_write_variant(const Variant &p_property) {
 
-    write_variant(f, p_property, resource_set, external_resources, string_map);
+    write_variant(f, p_property, resource_set, external_resources, string_map, &payloads);
 }
 
-void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, HashMap<RES, int> &external_resources, HashMap<StringName, int> &string_map) {
+// Stores a reference to the payload section instead of the array itself when it is large enough.
+static bool _store_as_payload(FileAccess *f, const Variant &p_property, uint64_t p_bytes, Vector<Variant> *r_payloads) {
+
+    if (!r_payloads || p_bytes < PAYLOAD_MIN_SIZE) {
+        return false;
+    }
+    f->store_32(VARIANT_PAYLOAD);
+    f->store_32(r_payloads->size());
+    r_payloads->push_back(p_property);
+    return true;
+}
+
+void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, HashMap<RES, int> &external_resources, HashMap<StringName, int> &string_map, Vector<Variant> *r_payloads) {
 
     switch (p_property.get_type()) {
 
@@ -1423,8 +2009,8 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
                     continue;
                 */
 
-                write_variant(f, E, resource_set, external_resources, string_map);
-                write_variant(f, d[E], resource_set, external_resources, string_map);
+                write_variant(f, E, resource_set, external_resources, string_map, r_payloads);
+                write_variant(f, d[E], resource_set, external_resources, string_map, r_payloads);
             }
 
         } break;
@@ -1435,15 +2021,17 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
             f->store_32(uint32_t(a.size()));
             for (int i = 0; i < a.size(); i++) {
 
-                write_variant(f, a[i], resource_set, external_resources, string_map);
+                write_variant(f, a[i], resource_set, external_resources, string_map, r_payloads);
             }
 
         } break;
         case VariantType::POOL_BYTE_ARRAY: {
 
-            f->store_32(VARIANT_RAW_ARRAY);
             PoolVector<uint8_t> arr = p_property.as<PoolVector<uint8_t>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(uint8_t), r_payloads))
+                break;
+            f->store_32(VARIANT_RAW_ARRAY);
             f->store_32(len);
             PoolVector<uint8_t>::Read r = arr.read();
             f->store_buffer(r.ptr(), len);
@@ -1452,9 +2040,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
         } break;
         case VariantType::POOL_INT_ARRAY: {
 
-            f->store_32(VARIANT_INT32_ARRAY);
             PoolVector<int> arr = p_property.as<PoolVector<int>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(int), r_payloads))
+                break;
+            f->store_32(VARIANT_INT32_ARRAY);
             f->store_32(len);
             PoolVector<int>::Read r = arr.read();
             for (int i = 0; i < len; i++)
@@ -1463,9 +2053,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
         } break;
         case VariantType::POOL_REAL_ARRAY: {
 
-            f->store_32(VARIANT_FLOAT32_ARRAY);
             PoolVector<real_t> arr = p_property.as<PoolVector<real_t>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(real_t), r_payloads))
+                break;
+            f->store_32(VARIANT_FLOAT32_ARRAY);
             f->store_32(len);
             PoolVector<real_t>::Read r = arr.read();
             for (int i = 0; i < len; i++) {
@@ -1487,9 +2079,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
         } break;
         case VariantType::POOL_VECTOR3_ARRAY: {
 
-            f->store_32(VARIANT_VECTOR3_ARRAY);
             PoolVector<Vector3> arr = p_property.as<PoolVector<Vector3>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(Vector3), r_payloads))
+                break;
+            f->store_32(VARIANT_VECTOR3_ARRAY);
             f->store_32(len);
             PoolVector<Vector3>::Read r = arr.read();
             for (int i = 0; i < len; i++) {
@@ -1501,9 +2095,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
         } break;
         case VariantType::POOL_VECTOR2_ARRAY: {
 
-            f->store_32(VARIANT_VECTOR2_ARRAY);
             PoolVector<Vector2> arr = p_property.as<PoolVector<Vector2>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(Vector2), r_payloads))
+                break;
+            f->store_32(VARIANT_VECTOR2_ARRAY);
             f->store_32(len);
             PoolVector<Vector2>::Read r = arr.read();
             for (int i = 0; i < len; i++) {
@@ -1514,9 +2110,11 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
         } break;
         case VariantType::POOL_COLOR_ARRAY: {
 
-            f->store_32(VARIANT_COLOR_ARRAY);
             PoolVector<Color> arr = p_property.as<PoolVector<Color>>();
             int len = arr.size();
+            if (_store_as_payload(f, p_property, uint64_t(len) * sizeof(Color), r_payloads))
+                break;
+            f->store_32(VARIANT_COLOR_ARRAY);
             f->store_32(len);
             PoolVector<Color>::Read r = arr.read();
             for (int i = 0; i < len; i++) {
@@ -1534,6 +2132,65 @@ void ResourceFormatSaverBinaryInstance::write_variant(FileAccess *f, const Varia
     }
 }
 
+template <class T, class C>
+static uint32_t _store_payload_array(FileAccess *f, const Variant &p_payload, bool p_swap) {
+
+    PoolVector<T> arr = p_payload.as<PoolVector<T>>();
+    typename PoolVector<T>::Read r = arr.read();
+    if (!p_swap || sizeof(C) == 1) {
+        f->store_buffer((const uint8_t *)r.ptr(), arr.size() * sizeof(T));
+        return arr.size();
+    }
+
+    //stored value by value so FileAccess swaps them
+    const C *c = (const C *)r.ptr();
+    const size_t count = arr.size() * sizeof(T) / sizeof(C);
+    for (size_t i = 0; i < count; i++) {
+        if constexpr (eastl::is_same<C, double>::value) {
+            f->store_double(c[i]);
+        } else if constexpr (eastl::is_same<C, float>::value) {
+            f->store_float(c[i]);
+        } else {
+            f->store_32(c[i]);
+        }
+    }
+    return arr.size();
+}
+
+uint32_t ResourceFormatSaverBinaryInstance::_write_payload(const Variant &p_payload, uint32_t &r_count) {
+
+    switch (p_payload.get_type()) {
+        case VariantType::POOL_BYTE_ARRAY: {
+            r_count = _store_payload_array<uint8_t, uint8_t>(f, p_payload, big_endian);
+            return VARIANT_RAW_ARRAY;
+        }
+        case VariantType::POOL_INT_ARRAY: {
+            r_count = _store_payload_array<int, uint32_t>(f, p_payload, big_endian);
+            return VARIANT_INT32_ARRAY;
+        }
+        case VariantType::POOL_REAL_ARRAY: {
+            r_count = _store_payload_array<real_t, real_t>(f, p_payload, big_endian);
+            return VARIANT_FLOAT32_ARRAY;
+        }
+        case VariantType::POOL_VECTOR2_ARRAY: {
+            r_count = _store_payload_array<Vector2, real_t>(f, p_payload, big_endian);
+            return VARIANT_VECTOR2_ARRAY;
+        }
+        case VariantType::POOL_VECTOR3_ARRAY: {
+            r_count = _store_payload_array<Vector3, real_t>(f, p_payload, big_endian);
+            return VARIANT_VECTOR3_ARRAY;
+        }
+        case VariantType::POOL_COLOR_ARRAY: {
+            r_count = _store_payload_array<Color, float>(f, p_payload, big_endian);
+            return VARIANT_COLOR_ARRAY;
+        }
+        default: {
+            r_count = 0;
+            ERR_FAIL_V_MSG(VARIANT_NIL, "Invalid payload.");
+        }
+    }
+}
+
 void ResourceFormatSaverBinaryInstance::_find_resources(const Variant &p_variant, bool p_main) {
 
     switch (p_variant.get_type()) {
@@ -1704,7 +2361,9 @@ Error ResourceFormatSaverBinaryInstance::save(StringView p_path, const RES &p_re
 
     save_unicode_string(f, p_resource->get_class());
     f->store_64(0); //offset to import metadata
-    for (int i = 0; i < 14; i++)
+    uint64_t payload_table_pos = f->get_position();
+    f->store_64(0); //offset to payload table, relative to the data section
+    for (int i = 0; i < 12; i++)
         f->store_32(0); // reserved
 
     Vector<ResourceData> resources;
@@ -1753,9 +2412,15 @@ Error ResourceFormatSaverBinaryInstance::save(StringView p_path, const RES &p_re
     }
 
     f->store_32(strings.size()); //string table size
-    for (int i = 0; i < strings.size(); i++) {
-        save_unicode_string(f, strings[i].asCString());
+    uint32_t strings_size = 0;
+    for (const StringName &str : strings) {
+        strings_size += strlen(str.asCString()) + 1;
+    }
+    f->store_32(strings_size);
+    for (const StringName &str : strings) {
+        f->store_buffer((const uint8_t *)str.asCString(), strlen(str.asCString()) + 1);
     }
+    _pad_buffer(f, strings_size);
 
     // save external resource table
     f->store_32(external_resources.size()); //amount of external resources
@@ -1817,15 +2482,17 @@ Error ResourceFormatSaverBinaryInstance::save(StringView p_path, const RES &p_re
         }
         ofs_pos.push_back(f->get_position());
         f->store_64(0); //offset in 64 bits
+        f->store_32(0); //size of the resource block
     }
 
+    const uint64_t data_ofs = f->get_position();
     Vector<uint64_t> ofs_table;
-    ofs_table.reserve(resources.size());
+    ofs_table.reserve(resources.size() + 1);
 
-    //now actually save the resources
+    //now actually save the resources, back to back
     for(ResourceData &rd : resources ) {
 
-        ofs_table.push_back(f->get_position());
+        ofs_table.push_back(f->get_position() - data_ofs);
         save_unicode_string(f, rd.type);
         f->store_32(rd.properties.size());
 
@@ -1835,12 +2502,49 @@ Error ResourceFormatSaverBinaryInstance::save(StringView p_path, const RES &p_re
             _write_variant(p.value); //, F->get().pi
         }
     }
+    ofs_table.push_back(f->get_position() - data_ofs);
+
+    //large packed arrays collected while writing the resources
+    uint64_t payload_table_ofs = 0;
+    if (!payloads.empty()) {
+
+        struct PayloadEntry {
+            uint32_t type;
+            uint32_t count;
+            uint64_t offset;
+        };
+        Vector<PayloadEntry> entries;
+        entries.reserve(payloads.size());
+
+        for (const Variant &payload : payloads) {
+            while ((f->get_position() - data_ofs) % PAYLOAD_ALIGNMENT) {
+                f->store_8(0);
+            }
+            PayloadEntry pe;
+            pe.offset = f->get_position() - data_ofs;
+            pe.type = _write_payload(payload, pe.count);
+            entries.push_back(pe);
+        }
 
-    for (int i = 0; i < ofs_table.size(); i++) {
+        payload_table_ofs = f->get_position() - data_ofs;
+        f->store_32(entries.size());
+        for (const PayloadEntry &pe : entries) {
+            f->store_32(pe.type);
+            f->store_32(pe.count);
+            f->store_64(pe.offset);
+        }
+        payloads.clear();
+    }
+
+    for (int i = 0; i < ofs_pos.size(); i++) {
         f->seek(ofs_pos[i]);
         f->store_64(ofs_table[i]);
+        f->store_32(ofs_table[i + 1] - ofs_table[i]);
     }
 
+    f->seek(payload_table_pos);
+    f->store_64(payload_table_ofs);
+
     f->seek_end();
 
     f->store_buffer((const uint8_t *)"RSRC", 4); //magic at end
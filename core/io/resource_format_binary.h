@@ -47,21 +47,41 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
     struct IntResource {
         String path;
         uint64_t offset;
+        uint32_t size = 0;
     };
+    //! Resource block of a format 4 file, decoded up front and applied to the object stage by stage.
+    struct DecodedResource {
+        RES res;
+        String path;
+        int subindex = 0;
+        bool cached = false;
+        Vector<eastl::pair<StringName, Variant>> properties;
+    };
+    struct FileVariantReader;
+    struct BlockVariantReader;
 
     HashMap<String, String> remaps;
     Vector<char> str_buf;
     Vector<StringName> string_map;
     Vector<IntResource> internal_resources;
     Vector<ExtResource> external_resources;
+    Vector<RES> external_cache;
+    Vector<DecodedResource> decoded_resources;
+    Vector<Variant> payloads;
     List<RES> resource_cache;
     String local_path;
     String res_path;
+    String file_path;
     String type;
     Ref<Resource> resource;
     uint32_t ver_format;
     FileAccess *f=nullptr;
     uint64_t importmd_ofs;
+    uint64_t data_ofs = 0;
+    uint64_t payload_table_ofs = 0;
+    bool big_endian = false;
+    //! Large payloads are left in the file and handed to resources as StreamedPayload.
+    bool lazy_payloads = false;
     Error error = OK;
     int stage = 0;
     bool translation_remapped = false;
@@ -71,6 +91,9 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
     void _advance_padding(uint32_t p_len);
 
     Error parse_variant(Variant &r_v);
+    Error _decode_resources();
+    Error _poll_internal_v3(int p_index);
+    Error _poll_internal_decoded(int p_index);
 
 public:
     void set_local_path(StringView p_local_path) override;
@@ -98,6 +121,9 @@ public:
     String get_resource_type(StringView p_path) const override;
     void get_dependencies(StringView p_path, Vector<String> &p_dependencies, bool p_add_types = false) override;
     Error rename_dependencies(StringView p_path, const HashMap<String, String> &p_map) override;
+
+    //! Loads a binary resource of any supported format version and saves it again in the current one.
+    static Error convert_file_to_current_format(StringView p_src_path, StringView p_dst_path);
 };
 
 class ResourceFormatSaverBinaryInstance {
@@ -131,16 +157,19 @@ class ResourceFormatSaverBinaryInstance {
 
     HashMap<RES, int> external_resources;
     List<RES> saved_resources;
+    Vector<Variant> payloads;
 
     static void _pad_buffer(FileAccess *f, int p_bytes);
     void _write_variant(const Variant &p_property);
+    uint32_t _write_payload(const Variant &p_payload, uint32_t &r_count);
     void _find_resources(const Variant &p_variant, bool p_main = false);
     static void save_unicode_string(FileAccess *f, StringView p_string, bool p_bit_on_len = false);
     int get_string_index(const StringName &p_string);
 
 public:
     Error save(StringView p_path, const RES &p_resource, uint32_t p_flags = 0);
-    static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, HashMap<RES, int> &external_resources, HashMap<StringName, int> &string_map);
+    //! When r_payloads is given, large packed arrays are collected there and only referenced from the stream.
+    static void write_variant(FileAccess *f, const Variant &p_property, Set<RES> &resource_set, HashMap<RES, int> &external_resources, HashMap<StringName, int> &string_map, Vector<Variant> *r_payloads = nullptr);
 };
 
 class ResourceFormatSaverBinary : public ResourceFormatSaver {
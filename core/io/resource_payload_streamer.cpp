@@ -0,0 +1,491 @@
+/*************************************************************************/
+/*  resource_payload_streamer.cpp                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "resource_payload_streamer.h"
+
+#include "core/class_db.h"
+#include "core/color.h"
+#include "core/engine.h"
+#include "core/external_profiler.h"
+#include "core/math/vector2.h"
+#include "core/math/vector3.h"
+#include "core/os/file_access.h"
+#include "core/os/memory.h"
+#include "core/os/thread.h"
+#include "core/pool_vector.h"
+
+IMPL_GDCLASS(StreamedPayload)
+
+Ref<StreamedPayload> StreamedPayload::create(StringView p_path, uint64_t p_offset, VariantType p_type, uint32_t p_count, bool p_big_endian) {
+
+    ERR_FAIL_COND_V(get_element_size(p_type) == 0, Ref<StreamedPayload>());
+
+    Ref<StreamedPayload> payload(make_ref_counted<StreamedPayload>());
+    payload->path = p_path;
+    payload->offset = p_offset;
+    payload->type = p_type;
+    payload->count = p_count;
+    payload->big_endian = p_big_endian;
+    return payload;
+}
+
+uint32_t StreamedPayload::get_element_size(VariantType p_type) {
+
+    switch (p_type) {
+        case VariantType::POOL_BYTE_ARRAY: return 1;
+        case VariantType::POOL_INT_ARRAY: return sizeof(int);
+        case VariantType::POOL_REAL_ARRAY: return sizeof(real_t);
+        case VariantType::POOL_VECTOR2_ARRAY: return sizeof(Vector2);
+        case VariantType::POOL_VECTOR3_ARRAY: return sizeof(Vector3);
+        case VariantType::POOL_COLOR_ARRAY: return sizeof(Color);
+        default: return 0;
+    }
+}
+
+template <class T, class C>
+static Variant _read_array(FileAccess *p_f, uint32_t p_count, bool p_swap) {
+
+    PoolVector<T> array;
+    array.resize(p_count);
+    {
+        typename PoolVector<T>::Write w = array.write();
+        const uint64_t bytes = uint64_t(p_count) * sizeof(T);
+        p_f->get_buffer((uint8_t *)w.ptr(), bytes);
+        if (p_swap && sizeof(C) > 1) {
+            C *components = (C *)w.ptr();
+            for (uint64_t i = 0; i < bytes / sizeof(C); i++) {
+                if (sizeof(C) == 4) {
+                    uint32_t v;
+                    memcpy(&v, &components[i], 4);
+                    v = BSWAP32(v);
+                    memcpy(&components[i], &v, 4);
+                } else {
+                    uint64_t v;
+                    memcpy(&v, &components[i], 8);
+                    v = BSWAP64(v);
+                    memcpy(&components[i], &v, 8);
+                }
+            }
+        }
+    }
+    return Variant(array);
+}
+
+Variant StreamedPayload::read_array(FileAccess *p_f, VariantType p_type, uint32_t p_count, bool p_big_endian) {
+
+    switch (p_type) {
+        case VariantType::POOL_BYTE_ARRAY: return _read_array<uint8_t, uint8_t>(p_f, p_count, false);
+        case VariantType::POOL_INT_ARRAY: return _read_array<int, uint32_t>(p_f, p_count, p_big_endian);
+        case VariantType::POOL_REAL_ARRAY: return _read_array<real_t, real_t>(p_f, p_count, p_big_endian);
+        case VariantType::POOL_VECTOR2_ARRAY: return _read_array<Vector2, real_t>(p_f, p_count, p_big_endian);
+        case VariantType::POOL_VECTOR3_ARRAY: return _read_array<Vector3, real_t>(p_f, p_count, p_big_endian);
+        case VariantType::POOL_COLOR_ARRAY: return _read_array<Color, float>(p_f, p_count, p_big_endian);
+        default: {
+            ERR_FAIL_V_MSG(Variant(), "Packed array type can't be streamed.");
+        }
+    }
+}
+
+bool StreamedPayload::is_streamed(const Variant &p_value) {
+
+    switch (p_value.get_type()) {
+        case VariantType::OBJECT: {
+            return refFromVariant<StreamedPayload>(p_value) != nullptr;
+        }
+        case VariantType::ARRAY: {
+            Array a = p_value.as<Array>();
+            for (int i = 0; i < a.size(); i++) {
+                if (is_streamed(a[i]))
+                    return true;
+            }
+        } break;
+        case VariantType::DICTIONARY: {
+            Dictionary d = p_value.as<Dictionary>();
+            for (int i = 0; i < d.size(); i++) {
+                if (is_streamed(d.get_value_at_index(i)))
+                    return true;
+            }
+        } break;
+        default: {
+        }
+    }
+    return false;
+}
+
+Error StreamedPayload::resolve(Variant &r_value) {
+
+    switch (r_value.get_type()) {
+        case VariantType::OBJECT: {
+            Ref<StreamedPayload> payload = refFromVariant<StreamedPayload>(r_value);
+            if (payload) {
+                Variant loaded = payload->load();
+                if (loaded.get_type() == VariantType::NIL) {
+                    return ERR_FILE_CORRUPT;
+                }
+                r_value = loaded;
+            }
+        } break;
+        case VariantType::ARRAY: {
+            Array a = r_value.as<Array>();
+            for (int i = 0; i < a.size(); i++) {
+                Error err = resolve(a[i]);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+        case VariantType::DICTIONARY: {
+            Dictionary d = r_value.as<Dictionary>();
+            for (const Variant &key : d.get_key_list()) {
+                Error err = resolve(d[key]);
+                if (err != OK)
+                    return err;
+            }
+        } break;
+        default: {
+        }
+    }
+    return OK;
+}
+
+Variant StreamedPayload::load() const {
+
+    SCOPE_AUTONAMED
+
+    Error err;
+    FileAccessRef f = FileAccess::open(path, FileAccess::READ, &err);
+    ERR_FAIL_COND_V_MSG(!f, Variant(), "Cannot open file '" + path + "' to read streamed data.");
+
+    f->seek(offset);
+    Variant v = read_array(f, type, count, big_endian);
+    ERR_FAIL_COND_V_MSG(f->eof_reached(), Variant(), "Premature end of file (EOF): " + path + ".");
+    return v;
+}
+
+void StreamedPayloadOwner::_payload_defer() {
+
+    ResourcePayloadStreamer *streamer = ResourcePayloadStreamer::get_singleton();
+    std::lock_guard<std::mutex> lock(streamer->mutex);
+    if (payload_state == PAYLOAD_NONE) {
+        payload_state = PAYLOAD_UNLOADED;
+    }
+}
+
+void StreamedPayloadOwner::_payload_release() {
+
+    ResourcePayloadStreamer *streamer = ResourcePayloadStreamer::get_singleton();
+    std::unique_lock<std::mutex> lock(streamer->mutex);
+    while (payload_state == PAYLOAD_READING || payload_state == PAYLOAD_APPLYING || payload_state == PAYLOAD_EVICTING) {
+        streamer->state_changed.wait(lock);
+    }
+    streamer->_remove_pending_locked(this);
+    if (payload_state == PAYLOAD_RESIDENT) {
+        streamer->evictable.erase(this);
+        streamer->resident_size -= payload_resident_size;
+    }
+    payload_resident_size = 0;
+    payload_state = PAYLOAD_NONE;
+}
+
+StreamedPayloadOwner::PayloadState StreamedPayloadOwner::get_payload_state() const {
+
+    std::lock_guard<std::mutex> lock(ResourcePayloadStreamer::get_singleton()->mutex);
+    return payload_state;
+}
+
+ResourcePayloadStreamer *ResourcePayloadStreamer::get_singleton() {
+
+    static ResourcePayloadStreamer streamer;
+    return &streamer;
+}
+
+void ResourcePayloadStreamer::_thread_function(void *p_user) {
+
+    ResourcePayloadStreamer *streamer = (ResourcePayloadStreamer *)p_user;
+    Thread::set_name("ResourcePayloadStreamer");
+
+    std::unique_lock<std::mutex> lock(streamer->mutex);
+    while (!streamer->exit_thread) {
+        if (streamer->queue.empty()) {
+            streamer->work_available.wait(lock);
+            continue;
+        }
+        StreamedPayloadOwner *owner = streamer->queue.front();
+        streamer->queue.pop_front();
+        streamer->_read_locked(owner, lock);
+    }
+}
+
+// Reads p_owner with the lock released, the owner ends up in the finished list or back in PAYLOAD_NONE on error.
+void ResourcePayloadStreamer::_read_locked(StreamedPayloadOwner *p_owner, std::unique_lock<std::mutex> &p_lock) {
+
+    p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_READING;
+    p_lock.unlock();
+    Error err;
+    {
+        SCOPE_PROFILE(payload_read);
+        err = p_owner->_payload_read();
+    }
+    p_lock.lock();
+
+    if (err != OK) {
+        ERR_PRINT("Failed to read streamed resource data.");
+        p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_NONE;
+    } else {
+        p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_READ;
+        finished.push_back(p_owner);
+    }
+    state_changed.notify_all();
+}
+
+void ResourcePayloadStreamer::_apply_locked(StreamedPayloadOwner *p_owner, std::unique_lock<std::mutex> &p_lock) {
+
+    finished.erase_first(p_owner);
+    p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_APPLYING;
+    p_lock.unlock();
+    uint64_t size = p_owner->_payload_apply();
+    p_lock.lock();
+
+    p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_RESIDENT;
+    p_owner->payload_resident_size = size;
+    p_owner->payload_last_use = ++use_counter;
+    if (p_owner->_payload_evictable()) {
+        evictable.insert(p_owner);
+    }
+    resident_size += size;
+    state_changed.notify_all();
+}
+
+void ResourcePayloadStreamer::_remove_pending_locked(StreamedPayloadOwner *p_owner) {
+
+    if (p_owner->payload_state == StreamedPayloadOwner::PAYLOAD_QUEUED) {
+        auto iter = eastl::find(queue.begin(), queue.end(), p_owner);
+        if (iter != queue.end()) {
+            queue.erase(iter);
+        }
+    } else if (p_owner->payload_state == StreamedPayloadOwner::PAYLOAD_READ) {
+        finished.erase_first(p_owner);
+    }
+}
+
+void ResourcePayloadStreamer::_enforce_budget_locked(std::unique_lock<std::mutex> &p_lock) {
+
+    if (budget == 0) {
+        return;
+    }
+
+    HashSet<StreamedPayloadOwner *> pinned;
+    while (resident_size > budget) {
+
+        StreamedPayloadOwner *oldest = nullptr;
+        for (StreamedPayloadOwner *owner : evictable) {
+            if (!pinned.contains(owner) && (!oldest || owner->payload_last_use < oldest->payload_last_use)) {
+                oldest = owner;
+            }
+        }
+        if (!oldest) {
+            break; // everything left is in use or can't be evicted
+        }
+
+        oldest->payload_state = StreamedPayloadOwner::PAYLOAD_EVICTING;
+        p_lock.unlock();
+        bool evicted = oldest->_payload_evict();
+        p_lock.lock();
+
+        if (evicted) {
+            evictable.erase(oldest);
+            resident_size -= oldest->payload_resident_size;
+            oldest->payload_resident_size = 0;
+            oldest->payload_state = StreamedPayloadOwner::PAYLOAD_UNLOADED;
+        } else {
+            oldest->payload_state = StreamedPayloadOwner::PAYLOAD_RESIDENT;
+            pinned.insert(oldest);
+        }
+        state_changed.notify_all();
+    }
+}
+
+void ResourcePayloadStreamer::set_lazy_loading(bool p_enabled, uint64_t p_min_size) {
+
+    lazy_loading = p_enabled;
+    lazy_min_size = p_min_size;
+}
+
+bool ResourcePayloadStreamer::is_lazy_loading_enabled() const {
+
+    return lazy_loading && !Engine::get_singleton()->is_editor_hint();
+}
+
+void ResourcePayloadStreamer::request(StreamedPayloadOwner *p_owner, bool p_high_priority) {
+
+    ERR_FAIL_NULL(p_owner);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (p_owner->payload_state == StreamedPayloadOwner::PAYLOAD_QUEUED) {
+        if (p_high_priority && queue.front() != p_owner) {
+            queue.erase(eastl::find(queue.begin(), queue.end(), p_owner));
+            queue.push_front(p_owner);
+        }
+        return;
+    }
+    if (p_owner->payload_state != StreamedPayloadOwner::PAYLOAD_UNLOADED) {
+        return;
+    }
+
+    if (!thread && !thread_failed) {
+        exit_thread = false;
+        thread = Thread::create(&ResourcePayloadStreamer::_thread_function, this);
+        thread_failed = thread == nullptr;
+    }
+
+    if (!thread) {
+        // no threads on this platform, read right away and let poll() apply it
+        _read_locked(p_owner, lock);
+        return;
+    }
+
+    p_owner->payload_state = StreamedPayloadOwner::PAYLOAD_QUEUED;
+    if (p_high_priority) {
+        queue.push_front(p_owner);
+    } else {
+        queue.push_back(p_owner);
+    }
+    lock.unlock();
+    work_available.notify_one();
+}
+
+void ResourcePayloadStreamer::prefetch(const RES &p_resource, bool p_high_priority) {
+
+    StreamedPayloadOwner *owner = dynamic_cast<StreamedPayloadOwner *>(p_resource.get());
+    if (owner) {
+        request(owner, p_high_priority);
+    }
+}
+
+void ResourcePayloadStreamer::ensure(StreamedPayloadOwner *p_owner) {
+
+    ERR_FAIL_NULL(p_owner);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (p_owner->payload_state != StreamedPayloadOwner::PAYLOAD_NONE && p_owner->payload_state != StreamedPayloadOwner::PAYLOAD_RESIDENT) {
+        // applying creates server objects and emits signals, like poll() it has to run on the main thread
+        ERR_FAIL_COND_MSG(Thread::get_caller_id() != Thread::get_main_id(), "Streamed resource data can only be made live on the main thread, use request() from other threads.");
+    }
+    while (true) {
+        switch (p_owner->payload_state) {
+            case StreamedPayloadOwner::PAYLOAD_NONE: {
+                return;
+            }
+            case StreamedPayloadOwner::PAYLOAD_RESIDENT: {
+                p_owner->payload_last_use = ++use_counter;
+                return;
+            }
+            case StreamedPayloadOwner::PAYLOAD_QUEUED: {
+                _remove_pending_locked(p_owner);
+                _read_locked(p_owner, lock);
+            } break;
+            case StreamedPayloadOwner::PAYLOAD_UNLOADED: {
+                _read_locked(p_owner, lock);
+            } break;
+            case StreamedPayloadOwner::PAYLOAD_READ: {
+                _apply_locked(p_owner, lock);
+            } break;
+            case StreamedPayloadOwner::PAYLOAD_READING:
+            case StreamedPayloadOwner::PAYLOAD_APPLYING:
+            case StreamedPayloadOwner::PAYLOAD_EVICTING: {
+                state_changed.wait(lock);
+            } break;
+        }
+    }
+}
+
+void ResourcePayloadStreamer::touch(StreamedPayloadOwner *p_owner) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    p_owner->payload_last_use = ++use_counter;
+}
+
+void ResourcePayloadStreamer::poll() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!finished.empty()) {
+        _apply_locked(finished.front(), lock);
+    }
+    _enforce_budget_locked(lock);
+}
+
+void ResourcePayloadStreamer::set_budget(uint64_t p_bytes) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = p_bytes;
+}
+
+uint64_t ResourcePayloadStreamer::get_budget() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+uint64_t ResourcePayloadStreamer::get_resident_size() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return resident_size;
+}
+
+int ResourcePayloadStreamer::get_pending_count() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + finished.size();
+}
+
+void ResourcePayloadStreamer::finish() {
+
+    Thread *to_join = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exit_thread = true;
+        eastl::swap(to_join, thread);
+        for (StreamedPayloadOwner *owner : queue) {
+            owner->payload_state = StreamedPayloadOwner::PAYLOAD_UNLOADED;
+        }
+        queue.clear();
+    }
+    work_available.notify_all();
+
+    if (to_join) {
+        Thread::wait_to_finish(to_join);
+        memdelete(to_join);
+    }
+}
+
+ResourcePayloadStreamer::~ResourcePayloadStreamer() {
+
+    finish();
+}
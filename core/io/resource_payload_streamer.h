@@ -0,0 +1,205 @@
+/*************************************************************************/
+/*  resource_payload_streamer.h                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/deque.h"
+#include "core/hash_set.h"
+#include "core/reference.h"
+#include "core/resource.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+#include <condition_variable>
+#include <mutex>
+
+class FileAccess;
+class Thread;
+
+/**
+ * Large packed array that was left in its file by the loader, holds everything needed to read it later.
+ * Property values containing these are only handed to resources that accept them through
+ * StreamedPayloadOwner::_set_streamed_property, everything else receives the loaded arrays.
+ */
+class GODOT_EXPORT StreamedPayload : public RefCounted {
+    GDCLASS(StreamedPayload, RefCounted)
+
+    String path;
+    uint64_t offset = 0;
+    uint32_t count = 0;
+    VariantType type = VariantType::NIL;
+    bool big_endian = false;
+
+public:
+    static Ref<StreamedPayload> create(StringView p_path, uint64_t p_offset, VariantType p_type, uint32_t p_count, bool p_big_endian);
+
+    //! Size in bytes of one element of a packed array type, 0 for types that can't be streamed.
+    static uint32_t get_element_size(VariantType p_type);
+    //! Reads p_count elements of a packed array type at the current position of p_f.
+    static Variant read_array(FileAccess *p_f, VariantType p_type, uint32_t p_count, bool p_big_endian);
+
+    //! True if p_value is a payload or an array/dictionary containing one.
+    static bool is_streamed(const Variant &p_value);
+    //! Replaces every payload in p_value, including nested ones, with the loaded array.
+    static Error resolve(Variant &r_value);
+
+    VariantType get_array_type() const { return type; }
+    uint32_t get_count() const { return count; }
+    uint64_t get_size() const { return uint64_t(count) * get_element_size(type); }
+    const String &get_path() const { return path; }
+
+    //! Reads the array from its file, can be called from any thread.
+    Variant load() const;
+};
+
+/**
+ * Interface for resources that can keep their heavy data on disk until it is needed.
+ *
+ * The owner receives StreamedPayload values through _set_streamed_property and calls _payload_defer.
+ * ResourcePayloadStreamer later reads the data on its own thread through _payload_read and makes it live on
+ * the main thread through _payload_apply; ResourcePayloadStreamer::ensure does both right away, also on the
+ * main thread, when the data is needed immediately. Owners that can read their data again return true from
+ * _payload_evictable and may drop it in _payload_evict when the streaming budget is exceeded.
+ */
+class GODOT_EXPORT StreamedPayloadOwner {
+    friend class ResourcePayloadStreamer;
+
+public:
+    enum PayloadState {
+        PAYLOAD_NONE, // nothing deferred, the owner holds all its data
+        PAYLOAD_UNLOADED,
+        PAYLOAD_QUEUED,
+        PAYLOAD_READING,
+        PAYLOAD_READ,
+        PAYLOAD_APPLYING,
+        PAYLOAD_RESIDENT,
+        PAYLOAD_EVICTING,
+    };
+
+private:
+    // guarded by the streamer mutex
+    PayloadState payload_state = PAYLOAD_NONE;
+    uint64_t payload_resident_size = 0;
+    uint64_t payload_last_use = 0;
+
+protected:
+    //! Reads deferred data into staging storage, called without any engine lock held and possibly from the
+    //! streaming thread, so it must not touch servers.
+    virtual Error _payload_read() = 0;
+    //! Makes the staged data live, returns the amount of memory it keeps resident.
+    virtual uint64_t _payload_apply() = 0;
+    //! Whether _payload_evict may ever succeed, only such owners are considered when the budget is exceeded.
+    virtual bool _payload_evictable() const { return false; }
+    //! Drops resident data so it is read again next time, returns false if that is not possible right now.
+    virtual bool _payload_evict() { return false; }
+
+    //! Marks the owner as having data on disk, to be called once the streamed properties are stored.
+    void _payload_defer();
+    //! Cancels pending work and waits for running reads, owners call it from their destructor and before
+    //! replacing deferred data with data set directly.
+    void _payload_release();
+
+public:
+    //! Called by loaders for properties whose value contains StreamedPayload objects, return false to
+    //! receive the loaded value through a regular set() instead.
+    virtual bool _set_streamed_property(const StringName &p_name, const Variant &p_value) { return false; }
+
+    PayloadState get_payload_state() const;
+
+    virtual ~StreamedPayloadOwner() = default;
+};
+
+/**
+ * Reads deferred resource payloads on a background thread and keeps the resident ones within a budget.
+ *
+ * Requests are served in order, high priority ones first. Reads that finished are applied by poll(), which
+ * the main loop calls once per frame; poll() then evicts the least recently used owners that support it
+ * while the resident size is over the budget.
+ */
+class GODOT_EXPORT ResourcePayloadStreamer {
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable state_changed;
+    Deque<StreamedPayloadOwner *> queue;
+    Vector<StreamedPayloadOwner *> finished;
+    HashSet<StreamedPayloadOwner *> evictable; // resident owners that support eviction
+    Thread *thread = nullptr;
+    uint64_t budget = 0;
+    uint64_t resident_size = 0;
+    uint64_t use_counter = 0;
+    uint64_t lazy_min_size = 65536;
+    bool lazy_loading = false;
+    bool exit_thread = false;
+    bool thread_failed = false;
+
+    static void _thread_function(void *p_user);
+    void _read_locked(StreamedPayloadOwner *p_owner, std::unique_lock<std::mutex> &p_lock);
+    void _apply_locked(StreamedPayloadOwner *p_owner, std::unique_lock<std::mutex> &p_lock);
+    void _remove_pending_locked(StreamedPayloadOwner *p_owner);
+    void _enforce_budget_locked(std::unique_lock<std::mutex> &p_lock);
+
+    friend class StreamedPayloadOwner;
+
+public:
+    static ResourcePayloadStreamer *get_singleton();
+
+    //! Lets loaders leave payloads of at least p_min_size bytes on disk.
+    void set_lazy_loading(bool p_enabled, uint64_t p_min_size);
+    //! True when loaders should leave large payloads on disk, never in the editor.
+    bool is_lazy_loading_enabled() const;
+    uint64_t get_lazy_min_size() const { return lazy_min_size; }
+
+    //! Queues a background read of p_owner's deferred data, can be called from any thread.
+    void request(StreamedPayloadOwner *p_owner, bool p_high_priority = false);
+    //! Queues a background read if p_resource has deferred data.
+    void prefetch(const RES &p_resource, bool p_high_priority = false);
+    //! Makes p_owner's data live before returning, reading it on the calling thread if it wasn't yet.
+    //! Main thread only, unless the data is already resident.
+    void ensure(StreamedPayloadOwner *p_owner);
+    //! Marks p_owner as used, the least recently used owners are evicted first.
+    void touch(StreamedPayloadOwner *p_owner);
+
+    //! Applies finished reads and enforces the budget, called from the main thread.
+    void poll();
+
+    //! Resident size in bytes above which owners get evicted, 0 disables eviction.
+    void set_budget(uint64_t p_bytes);
+    uint64_t get_budget() const;
+    uint64_t get_resident_size() const;
+    int get_pending_count() const;
+
+    //! Stops the streaming thread, queued requests go back to unloaded.
+    void finish();
+
+    ResourcePayloadStreamer() = default;
+    ~ResourcePayloadStreamer();
+};
@@ -332,6 +332,21 @@ uint16_t StreamPeerTCP::get_connected_port() const {
     return peer_port;
 }
 
+Error StreamPeerTCP::add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata, NetSocket::PollType p_type) {
+
+    ERR_FAIL_COND_V(not p_poller, ERR_INVALID_PARAMETER);
+    ERR_FAIL_COND_V(not _sock || !_sock->is_open(), ERR_UNCONFIGURED);
+
+    return p_poller->watch(_sock, p_type, p_userdata);
+}
+
+void StreamPeerTCP::remove_from_poller(const Ref<NetSocketPoller> &p_poller) {
+
+    ERR_FAIL_COND(not p_poller);
+    if (_sock)
+        p_poller->remove(_sock);
+}
+
 Error StreamPeerTCP::_connect(StringView p_address, int p_port) {
 
     IP_Address ip;
@@ -79,6 +79,13 @@ public:
 
     void set_no_delay(bool p_enabled);
 
+    /**
+     * Registers the connection with p_poller, or changes what it waits for when already registered. A connecting
+     * peer should wait for POLL_TYPE_OUT. The registration ends when the peer disconnects.
+     */
+    Error add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata, NetSocket::PollType p_type = NetSocket::POLL_TYPE_IN);
+    void remove_from_poller(const Ref<NetSocketPoller> &p_poller);
+
     // Read/Write from StreamPeer
     Error put_data(const uint8_t *p_data, int p_bytes) override;
     Error put_partial_data(const uint8_t *p_data, int p_bytes, int &r_sent) override;
@@ -114,6 +114,20 @@ Ref<StreamPeerTCP> TCP_Server::take_connection() {
     return conn;
 }
 
+Error TCP_Server::add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata) {
+
+    ERR_FAIL_COND_V(not p_poller, ERR_INVALID_PARAMETER);
+    ERR_FAIL_COND_V(!is_listening(), ERR_UNCONFIGURED);
+
+    return p_poller->watch(_sock, NetSocket::POLL_TYPE_IN, p_userdata);
+}
+
+void TCP_Server::remove_from_poller(const Ref<NetSocketPoller> &p_poller) {
+
+    ERR_FAIL_COND(not p_poller);
+    p_poller->remove(_sock);
+}
+
 void TCP_Server::stop() {
 
     if (_sock) {
@@ -57,6 +57,9 @@ public:
     bool is_listening() const;
     bool is_connection_available() const;
     Ref<StreamPeerTCP> take_connection();
+    //! The listening socket becomes readable in p_poller when a connection is available, until stop() is called.
+    Error add_to_poller(const Ref<NetSocketPoller> &p_poller, void *p_userdata);
+    void remove_from_poller(const Ref<NetSocketPoller> &p_poller);
 
     void stop(); // Stop listening
 
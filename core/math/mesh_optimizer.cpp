@@ -0,0 +1,595 @@
+/*************************************************************************/
+/*  mesh_optimizer.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "mesh_optimizer.h"
+
+#include "core/error_macros.h"
+#include "core/math/aabb.h"
+#include "core/math/math_funcs.h"
+
+#include "EASTL/sort.h"
+
+namespace {
+
+// Cache size used for scoring in optimize_vertex_cache, a bit larger than real hardware caches.
+constexpr int VERTEX_CACHE_SIZE = 32;
+// Cache size used when measuring, close to what GPUs actually have.
+constexpr int FIFO_CACHE_SIZE = 16;
+
+bool _indices_valid(Span<const int> p_indices, int p_vertex_count) {
+
+    for (int idx : p_indices) {
+        if (idx < 0 || idx >= p_vertex_count)
+            return false;
+    }
+    return true;
+}
+
+// Triangles using every vertex, stored contiguously per vertex.
+struct VertexAdjacency {
+    Vector<int> offsets;
+    Vector<int> counts;
+    Vector<int> triangles;
+
+    void build(Span<const int> p_indices, int p_vertex_count) {
+
+        offsets.assign(p_vertex_count + 1, 0);
+        counts.assign(p_vertex_count, 0);
+        for (int idx : p_indices) {
+            counts[idx]++;
+        }
+        for (int v = 0; v < p_vertex_count; v++) {
+            offsets[v + 1] = offsets[v] + counts[v];
+        }
+        triangles.resize(p_indices.size());
+        eastl::fill(counts.begin(), counts.end(), 0);
+        for (size_t i = 0; i < p_indices.size(); i++) {
+            int v = p_indices[i];
+            triangles[offsets[v] + counts[v]++] = int(i / 3);
+        }
+    }
+    Span<const int> operator[](int p_vertex) const {
+        return Span<const int>(triangles.data() + offsets[p_vertex], counts[p_vertex]);
+    }
+};
+
+// Vertex score from "Linear-Speed Vertex Cache Optimisation" (Tom Forsyth).
+float _vertex_score(int p_cache_pos, int p_live_triangles) {
+
+    if (p_live_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (p_cache_pos >= 0) {
+        if (p_cache_pos < 3) {
+            // used by the last triangle, a fixed score keeps the order from degenerating into strips
+            score = 0.75f;
+        } else {
+            score = Math::pow(1.0f - (p_cache_pos - 3) * (1.0f / (VERTEX_CACHE_SIZE - 3)), 1.5f);
+        }
+    }
+    // prefer vertices with few triangles left, finishing them frees the cache
+    return score + 2.0f / Math::sqrt(float(p_live_triangles));
+}
+
+// Sum of squared distances to a set of area weighted planes.
+struct Quadric {
+    float a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+    float b0 = 0, b1 = 0, b2 = 0, c = 0;
+    float weight = 0;
+
+    void add_plane(const Vector3 &p_normal, float p_d, float p_weight) {
+
+        a00 += p_weight * p_normal.x * p_normal.x;
+        a11 += p_weight * p_normal.y * p_normal.y;
+        a22 += p_weight * p_normal.z * p_normal.z;
+        a01 += p_weight * p_normal.x * p_normal.y;
+        a02 += p_weight * p_normal.x * p_normal.z;
+        a12 += p_weight * p_normal.y * p_normal.z;
+        b0 += p_weight * p_normal.x * p_d;
+        b1 += p_weight * p_normal.y * p_d;
+        b2 += p_weight * p_normal.z * p_d;
+        c += p_weight * p_d * p_d;
+        weight += p_weight;
+    }
+    void add(const Quadric &p_q) {
+
+        a00 += p_q.a00;
+        a11 += p_q.a11;
+        a22 += p_q.a22;
+        a01 += p_q.a01;
+        a02 += p_q.a02;
+        a12 += p_q.a12;
+        b0 += p_q.b0;
+        b1 += p_q.b1;
+        b2 += p_q.b2;
+        c += p_q.c;
+        weight += p_q.weight;
+    }
+    //! Weighted mean of the squared distances from p_point to the planes.
+    float error(const Vector3 &p_point) const {
+
+        const Vector3 &p = p_point;
+        float r = p.x * (a00 * p.x + 2 * (a01 * p.y + a02 * p.z + b0)) +
+                  p.y * (a11 * p.y + 2 * (a12 * p.z + b1)) +
+                  p.z * (a22 * p.z + 2 * b2) + c;
+        return weight > 0 ? Math::abs(r) / weight : 0.0f;
+    }
+};
+
+struct Collapse {
+    int from;
+    int to;
+    float cost;
+};
+
+// True when moving p_from onto p_to turns any remaining triangle around p_from upside down.
+bool _collapse_flips(const Vector<int> &p_indices, const VertexAdjacency &p_adjacency, const Vector<Vector3> &p_positions, int p_from, int p_to) {
+
+    for (int t : p_adjacency[p_from]) {
+        const int *tri = &p_indices[t * 3];
+        if (tri[0] == p_to || tri[1] == p_to || tri[2] == p_to)
+            continue; // removed by the collapse
+
+        Vector3 p[3] = { p_positions[tri[0]], p_positions[tri[1]], p_positions[tri[2]] };
+        Vector3 before = (p[1] - p[0]).cross(p[2] - p[0]);
+        for (int k = 0; k < 3; k++) {
+            if (tri[k] == p_from) {
+                p[k] = p_positions[p_to];
+            }
+        }
+        Vector3 after = (p[1] - p[0]).cross(p[2] - p[0]);
+        if (before.length_squared() > 0 && before.dot(after) <= 0)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void MeshOptimizer::optimize_vertex_cache(Span<int> r_indices, int p_vertex_count) {
+
+    ERR_FAIL_COND(r_indices.size() % 3 != 0);
+    ERR_FAIL_COND(!_indices_valid(r_indices, p_vertex_count));
+
+    const int triangle_count = r_indices.size() / 3;
+    if (triangle_count < 2)
+        return;
+
+    // the first counts[v] entries of a vertex' adjacency are its triangles that were not emitted yet
+    VertexAdjacency adjacency;
+    adjacency.build(r_indices, p_vertex_count);
+
+    Vector<int> cache_pos(p_vertex_count, -1);
+    Vector<float> vertex_score(p_vertex_count);
+    for (int v = 0; v < p_vertex_count; v++) {
+        vertex_score[v] = _vertex_score(-1, adjacency.counts[v]);
+    }
+
+    auto triangle_score = [&](int t) {
+        return vertex_score[r_indices[t * 3]] + vertex_score[r_indices[t * 3 + 1]] + vertex_score[r_indices[t * 3 + 2]];
+    };
+
+    int best = 0;
+    float best_score = -1.0f;
+    for (int t = 0; t < triangle_count; t++) {
+        float score = triangle_score(t);
+        if (score > best_score) {
+            best_score = score;
+            best = t;
+        }
+    }
+
+    Vector<uint8_t> emitted(triangle_count, 0);
+    Vector<int> output;
+    output.reserve(r_indices.size());
+
+    int cache[VERTEX_CACHE_SIZE + 3];
+    int new_cache[VERTEX_CACHE_SIZE + 3];
+    int cache_count = 0;
+    int next_unemitted = 0;
+
+    for (int emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+
+        if (best < 0) {
+            // dead end, nothing in the cache has triangles left
+            while (emitted[next_unemitted]) {
+                next_unemitted++;
+            }
+            best = next_unemitted;
+        }
+
+        const int tri[3] = { r_indices[best * 3], r_indices[best * 3 + 1], r_indices[best * 3 + 2] };
+        output.push_back(tri[0]);
+        output.push_back(tri[1]);
+        output.push_back(tri[2]);
+        emitted[best] = 1;
+
+        for (int v : tri) {
+            int *live = adjacency.triangles.data() + adjacency.offsets[v];
+            int &live_count = adjacency.counts[v];
+            for (int i = 0; i < live_count; i++) {
+                if (live[i] == best) {
+                    live[i] = live[--live_count];
+                    break;
+                }
+            }
+        }
+
+        // the triangle's vertices move to the front of the cache
+        int new_count = 0;
+        for (int v : tri) {
+            new_cache[new_count++] = v;
+        }
+        for (int i = 0; i < cache_count; i++) {
+            int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                new_cache[new_count++] = v;
+            }
+        }
+        for (int i = VERTEX_CACHE_SIZE; i < new_count; i++) {
+            int v = new_cache[i];
+            cache_pos[v] = -1;
+            vertex_score[v] = _vertex_score(-1, adjacency.counts[v]);
+        }
+        cache_count = MIN(new_count, VERTEX_CACHE_SIZE);
+        for (int i = 0; i < cache_count; i++) {
+            int v = new_cache[i];
+            cache[i] = v;
+            cache_pos[v] = i;
+            vertex_score[v] = _vertex_score(i, adjacency.counts[v]);
+        }
+
+        // only triangles touching the cache can score high enough to be worth considering
+        best = -1;
+        best_score = -1.0f;
+        for (int i = 0; i < cache_count; i++) {
+            for (int t : adjacency[cache[i]]) {
+                float score = triangle_score(t);
+                if (score > best_score) {
+                    best_score = score;
+                    best = t;
+                }
+            }
+        }
+    }
+
+    eastl::copy(output.begin(), output.end(), r_indices.begin());
+}
+
+void MeshOptimizer::optimize_overdraw(Span<int> r_indices, Span<const Vector3> p_positions) {
+
+    ERR_FAIL_COND(r_indices.size() % 3 != 0);
+    ERR_FAIL_COND(!_indices_valid(r_indices, p_positions.size()));
+
+    const int triangle_count = r_indices.size() / 3;
+    if (triangle_count < 2)
+        return;
+
+    // a triangle whose three vertices all miss the cache starts a new cluster, reordering whole clusters keeps
+    // the cache efficiency of the order within them
+    Vector<int> cluster_start;
+    {
+        Vector<uint32_t> timestamps(p_positions.size(), 0);
+        uint32_t time = FIFO_CACHE_SIZE + 1;
+        for (int t = 0; t < triangle_count; t++) {
+            int misses = 0;
+            for (int k = 0; k < 3; k++) {
+                int v = r_indices[t * 3 + k];
+                if (time - timestamps[v] > FIFO_CACHE_SIZE) {
+                    timestamps[v] = time++;
+                    misses++;
+                }
+            }
+            if (t == 0 || misses == 3) {
+                cluster_start.push_back(t);
+            }
+        }
+    }
+    const int cluster_count = cluster_start.size();
+    if (cluster_count < 2)
+        return;
+    cluster_start.push_back(triangle_count);
+
+    Vector3 mesh_center;
+    float mesh_area = 0;
+    for (int t = 0; t < triangle_count; t++) {
+        const Vector3 &a = p_positions[r_indices[t * 3]];
+        const Vector3 &b = p_positions[r_indices[t * 3 + 1]];
+        const Vector3 &c = p_positions[r_indices[t * 3 + 2]];
+        float area = (b - a).cross(c - a).length();
+        mesh_center += (a + b + c) * (area / 3.0f);
+        mesh_area += area;
+    }
+    if (mesh_area <= 0)
+        return;
+    mesh_center /= mesh_area;
+
+    // clusters facing away from the center are likely to occlude the rest, so they are drawn first
+    struct ClusterKey {
+        float key;
+        int cluster;
+    };
+    Vector<ClusterKey> keys;
+    keys.reserve(cluster_count);
+    for (int i = 0; i < cluster_count; i++) {
+        Vector3 center;
+        Vector3 normal;
+        float area = 0;
+        for (int t = cluster_start[i]; t < cluster_start[i + 1]; t++) {
+            const Vector3 &a = p_positions[r_indices[t * 3]];
+            const Vector3 &b = p_positions[r_indices[t * 3 + 1]];
+            const Vector3 &c = p_positions[r_indices[t * 3 + 2]];
+            Vector3 n = (b - a).cross(c - a);
+            float tri_area = n.length();
+            center += (a + b + c) * (tri_area / 3.0f);
+            normal += n;
+            area += tri_area;
+        }
+        float key = 0;
+        if (area > 0 && normal.length_squared() > 0) {
+            key = (center / area - mesh_center).dot(normal.normalized());
+        }
+        keys.push_back({ key, i });
+    }
+    eastl::sort(keys.begin(), keys.end(), [](const ClusterKey &a, const ClusterKey &b) {
+        return a.key != b.key ? a.key > b.key : a.cluster < b.cluster;
+    });
+
+    Vector<int> output;
+    output.reserve(r_indices.size());
+    for (const ClusterKey &k : keys) {
+        output.insert(output.end(), r_indices.begin() + cluster_start[k.cluster] * 3, r_indices.begin() + cluster_start[k.cluster + 1] * 3);
+    }
+    eastl::copy(output.begin(), output.end(), r_indices.begin());
+}
+
+int MeshOptimizer::optimize_vertex_fetch(Span<int> r_indices, int p_vertex_count, Vector<int> &r_remap) {
+
+    ERR_FAIL_COND_V(!_indices_valid(r_indices, p_vertex_count), 0);
+
+    r_remap.assign(p_vertex_count, -1);
+    int next = 0;
+    for (int &idx : r_indices) {
+        if (r_remap[idx] < 0) {
+            r_remap[idx] = next++;
+        }
+        idx = r_remap[idx];
+    }
+    return next;
+}
+
+Vector<int> MeshOptimizer::simplify(Span<const int> p_indices, Span<const Vector3> p_positions, int p_target_index_count, float p_max_error, float *r_error) {
+
+    Vector<int> result(p_indices.begin(), p_indices.end());
+    if (r_error) {
+        *r_error = 0;
+    }
+    ERR_FAIL_COND_V(p_indices.size() % 3 != 0, result);
+    const int vertex_count = p_positions.size();
+    ERR_FAIL_COND_V(!_indices_valid(p_indices, vertex_count), result);
+
+    if (int(result.size()) <= p_target_index_count || vertex_count == 0)
+        return result;
+
+    // work in a unit sized box so errors and thresholds don't depend on the mesh scale
+    AABB bounds(p_positions[0], Vector3());
+    for (const Vector3 &p : p_positions) {
+        bounds.expand_to(p);
+    }
+    const float scale = bounds.get_longest_axis_size();
+    if (scale <= 0)
+        return result;
+    Vector<Vector3> positions;
+    positions.reserve(vertex_count);
+    for (const Vector3 &p : p_positions) {
+        positions.push_back((p - bounds.position) / scale);
+    }
+
+    // vertices sharing a position with others lie on an attribute seam, they are locked along with vertices on
+    // open or non-manifold edges
+    Vector<int> canonical(vertex_count);
+    Vector<uint8_t> locked(vertex_count, 0);
+    {
+        Vector<int> order(vertex_count);
+        for (int v = 0; v < vertex_count; v++) {
+            order[v] = v;
+        }
+        eastl::sort(order.begin(), order.end(), [&p_positions](int a, int b) {
+            const Vector3 &pa = p_positions[a];
+            const Vector3 &pb = p_positions[b];
+            if (pa.x != pb.x)
+                return pa.x < pb.x;
+            if (pa.y != pb.y)
+                return pa.y < pb.y;
+            if (pa.z != pb.z)
+                return pa.z < pb.z;
+            return a < b;
+        });
+        canonical[order[0]] = order[0];
+        for (int i = 1; i < vertex_count; i++) {
+            int v = order[i];
+            int prev = order[i - 1];
+            if (p_positions[v] == p_positions[prev]) {
+                canonical[v] = canonical[prev];
+                locked[v] = 1;
+                locked[prev] = 1;
+            } else {
+                canonical[v] = v;
+            }
+        }
+
+        Vector<uint64_t> half_edges;
+        half_edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint64_t a = uint32_t(result[i + e]);
+                uint64_t b = uint32_t(result[i + (e + 1) % 3]);
+                half_edges.push_back((a << 32) | b);
+            }
+        }
+        eastl::sort(half_edges.begin(), half_edges.end());
+        for (size_t i = 0; i < half_edges.size(); i++) {
+            uint64_t edge = half_edges[i];
+            uint32_t a = uint32_t(edge >> 32);
+            uint32_t b = uint32_t(edge);
+            bool duplicate = (i > 0 && half_edges[i - 1] == edge) || (i + 1 < half_edges.size() && half_edges[i + 1] == edge);
+            bool open = !eastl::binary_search(half_edges.begin(), half_edges.end(), (uint64_t(b) << 32) | a);
+            if (duplicate || open) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+    }
+
+    Vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const Vector3 &a = positions[result[i]];
+        const Vector3 &b = positions[result[i + 1]];
+        const Vector3 &c = positions[result[i + 2]];
+        Vector3 normal = (b - a).cross(c - a);
+        float length = normal.length();
+        if (length <= 0)
+            continue;
+        normal /= length;
+        Quadric q;
+        q.add_plane(normal, -normal.dot(a), length * 0.5f);
+        for (int k = 0; k < 3; k++) {
+            quadrics[canonical[result[i + k]]].add(q);
+        }
+    }
+
+    const float error_limit = p_max_error / scale;
+    const float error_limit_sq = error_limit * error_limit;
+    float max_error_sq = 0;
+
+    VertexAdjacency adjacency;
+    Vector<Collapse> collapses;
+    Vector<int> remap(vertex_count);
+    Vector<uint8_t> pass_locked;
+
+    // every pass collapses the cheapest edges that don't touch each other's triangles, then rebuilds the topology
+    while (int(result.size()) > p_target_index_count) {
+
+        adjacency.build(result, vertex_count);
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                int a = result[i + e];
+                int b = result[i + (e + 1) % 3];
+                if (a >= b)
+                    continue; // every interior edge is seen twice, in opposite directions
+                if (!locked[a]) {
+                    collapses.push_back({ a, b, quadrics[a].error(positions[b]) });
+                }
+                if (!locked[b]) {
+                    collapses.push_back({ b, a, quadrics[b].error(positions[a]) });
+                }
+            }
+        }
+        if (collapses.empty())
+            break;
+        eastl::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+            return a.cost != b.cost ? a.cost < b.cost : (a.from != b.from ? a.from < b.from : a.to < b.to);
+        });
+
+        const int triangles_to_remove = (int(result.size()) - p_target_index_count + 2) / 3;
+        int removed = 0;
+        bool collapsed = false;
+        for (int v = 0; v < vertex_count; v++) {
+            remap[v] = v;
+        }
+        pass_locked.assign(vertex_count, 0);
+
+        for (const Collapse &c : collapses) {
+            if (c.cost > error_limit_sq || removed >= triangles_to_remove)
+                break;
+            if (pass_locked[c.from] || pass_locked[c.to])
+                continue;
+            if (_collapse_flips(result, adjacency, positions, c.from, c.to))
+                continue;
+
+            remap[c.from] = c.to;
+            quadrics[canonical[c.to]].add(quadrics[c.from]);
+            max_error_sq = M_MAX(max_error_sq, c.cost);
+            collapsed = true;
+
+            for (int t : adjacency[c.from]) {
+                const int *tri = &result[t * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                    removed++;
+                }
+                for (int k = 0; k < 3; k++) {
+                    pass_locked[tri[k]] = 1;
+                }
+            }
+        }
+        if (!collapsed)
+            break;
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            int a = remap[result[i]];
+            int b = remap[result[i + 1]];
+            int c = remap[result[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (r_error) {
+        *r_error = Math::sqrt(max_error_sq) * scale;
+    }
+    return result;
+}
+
+float MeshOptimizer::get_acmr(Span<const int> p_indices, int p_vertex_count, int p_cache_size) {
+
+    ERR_FAIL_COND_V(!_indices_valid(p_indices, p_vertex_count), 0.0f);
+    if (p_indices.size() < 3)
+        return 0.0f;
+
+    Vector<uint32_t> timestamps(p_vertex_count, 0);
+    uint32_t time = p_cache_size + 1;
+    int misses = 0;
+    for (int v : p_indices) {
+        if (time - timestamps[v] > uint32_t(p_cache_size)) {
+            timestamps[v] = time++;
+            misses++;
+        }
+    }
+    return float(misses) / (p_indices.size() / 3);
+}
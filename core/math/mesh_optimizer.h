@@ -0,0 +1,59 @@
+/*************************************************************************/
+/*  mesh_optimizer.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/math/vector3.h"
+#include "core/vector.h"
+
+/**
+ * Triangle list optimizations applied to meshes at import: index reordering for the post-transform vertex cache
+ * and for overdraw, vertex reordering for fetch locality, and quadric error simplification used to build LODs.
+ */
+class GODOT_EXPORT MeshOptimizer {
+public:
+    //! Reorders triangles so that consecutive triangles reuse vertices still in the post-transform cache.
+    static void optimize_vertex_cache(Span<int> r_indices, int p_vertex_count);
+    //! Splits the (cache optimized) triangle order in clusters at cache flushes and sorts the clusters so that
+    //! the outer, outward facing parts of the mesh are drawn first.
+    static void optimize_overdraw(Span<int> r_indices, Span<const Vector3> p_positions);
+    //! Fills r_remap with new vertex positions in order of first use and rewrites r_indices to them, unused
+    //! vertices are mapped to -1. Returns the number of used vertices.
+    static int optimize_vertex_fetch(Span<int> r_indices, int p_vertex_count, Vector<int> &r_remap);
+
+    //! Collapses edges until at most p_target_index_count indices remain, or until a collapse would move the
+    //! surface by more than p_max_error. Vertices on open borders and attribute seams are never moved.
+    //! r_error receives the largest error introduced, in the units of p_positions.
+    static Vector<int> simplify(Span<const int> p_indices, Span<const Vector3> p_positions, int p_target_index_count, float p_max_error, float *r_error = nullptr);
+
+    //! Average number of vertex cache misses per triangle for a FIFO cache of p_cache_size entries.
+    static float get_acmr(Span<const int> p_indices, int p_vertex_count, int p_cache_size = 16);
+};
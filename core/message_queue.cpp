@@ -32,6 +32,7 @@
 
 
 #include "core_string_names.h"
+#include "core/external_profiler.h"
 #include "core/project_settings.h"
 #include "core/print_string.h"
 #include "core/os/mutex.h"
@@ -286,6 +287,7 @@ void MessageQueue::_call_function(const Callable& p_callable, const Variant* p_a
 
 void MessageQueue::flush()
 {
+    SCOPE_PROFILE(message_queue_flush);
     if (buffer_end > buffer_max_used)
     {
         buffer_max_used = buffer_end;
@@ -677,7 +677,10 @@ Variant Object::call(const StringName &p_method, const Variant **p_args, int p_a
     Variant ret;
     OBJ_DEBUG_LOCK
     if (script_instance) {
-        ret = script_instance->call(p_method, p_args, p_argcount, r_error);
+        {
+            MemoryTagScope mem_tag(MEM_TAG_SCRIPT);
+            ret = script_instance->call(p_method, p_args, p_argcount, r_error);
+        }
         //force jumptable
         switch (r_error.error) {
 
@@ -711,6 +714,7 @@ void Object::notification(int p_notification, bool p_reversed) {
     _notificationv(p_notification, p_reversed);
 
     if (script_instance) {
+        MemoryTagScope mem_tag(MEM_TAG_SCRIPT);
         script_instance->notification(p_notification);
     }
 }
@@ -30,22 +30,163 @@
 
 #include "memory.h"
 
-#include "core/safe_refcount.h"
 #include "core/error_macros.h"
 #include "core/external_profiler.h"
 
+#include <atomic>
+#include <cassert>
 #include <cstdio>
 #include <cstdlib>
-#include <cassert>
+#include <cstring>
+#include <mutex>
+
 #ifndef PAD_ALIGN
 #define PAD_ALIGN 16 //must always be greater than this at much
 #endif
 
+namespace {
+
+struct AllocHeader {
+    uint64_t size : 48;
+    uint64_t size_class : 8;
+    uint64_t tag : 8;
+    uint64_t reserved; // owned by callers that request p_pad_align
+};
+static_assert(sizeof(AllocHeader) == PAD_ALIGN, "Allocation header must keep user memory aligned");
+
+// Block sizes, header included. Class 0 marks blocks that are served directly by the backend.
+constexpr uint32_t SIZE_CLASS_COUNT = 13;
+constexpr uint32_t size_class_bytes[SIZE_CLASS_COUNT] = { 0, 32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512 };
+constexpr uint32_t MAX_SMALL_BLOCK = 512;
+// Upper bound of memory each thread keeps cached per size class.
+constexpr uint32_t THREAD_CACHE_BYTES_PER_CLASS = 64 * 1024;
+
+struct SizeClassTable {
+    uint8_t lookup[MAX_SMALL_BLOCK / 16 + 1];
+    uint16_t cache_limit[SIZE_CLASS_COUNT];
+
+    constexpr SizeClassTable() : lookup(), cache_limit() {
+        uint8_t cls = 1;
+        for (uint32_t i = 0; i <= MAX_SMALL_BLOCK / 16; ++i) {
+            while (size_class_bytes[cls] < i * 16)
+                ++cls;
+            lookup[i] = cls;
+        }
+        for (uint32_t i = 1; i < SIZE_CLASS_COUNT; ++i)
+            cache_limit[i] = uint16_t(THREAD_CACHE_BYTES_PER_CLASS / size_class_bytes[i]);
+    }
+};
+constexpr SizeClassTable size_classes;
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+struct ThreadMemStats {
+    // Only ever written by the owning thread, so plain relaxed load/store pairs are enough.
+    std::atomic<int64_t> usage[MEM_TAG_MAX];
+    std::atomic<int64_t> allocs[MEM_TAG_MAX];
+    ThreadMemStats *next;
+};
+
+enum ThreadCacheState : uint8_t {
+    CACHE_UNINITIALIZED,
+    CACHE_ACTIVE,
+    CACHE_DESTROYED
+};
+
+// Trivially destructible, so it stays accessible while other thread_local destructors are still freeing memory.
+struct ThreadMemState {
+    FreeBlock *free_lists[SIZE_CLASS_COUNT];
+    uint16_t free_counts[SIZE_CLASS_COUNT];
+    ThreadMemStats stats;
+    MemoryTag tag;
+    ThreadCacheState state;
+};
+
+MemoryBackend g_backend = { ::malloc, ::realloc, ::free };
+
+std::mutex g_stats_lock; // guards g_thread_stats list
+ThreadMemStats *g_thread_stats = nullptr;
+// Totals of threads that have already exited, and of allocations made after a thread's cache was torn down.
+std::atomic<int64_t> g_retired_usage[MEM_TAG_MAX];
+std::atomic<int64_t> g_retired_allocs[MEM_TAG_MAX];
+std::atomic<uint64_t> g_max_usage { 0 };
+
+thread_local ThreadMemState t_mem_state;
+
+void flush_free_lists(ThreadMemState &st) {
+    for (uint32_t cls = 1; cls < SIZE_CLASS_COUNT; ++cls) {
+        FreeBlock *blk = st.free_lists[cls];
+        while (blk) {
+            FreeBlock *next = blk->next;
+            g_backend.free(blk);
+            blk = next;
+        }
+        st.free_lists[cls] = nullptr;
+        st.free_counts[cls] = 0;
+    }
+}
 
-#ifdef DEBUG_ENABLED
-static uint64_t mem_usage=0;
-static uint64_t max_usage=0;
-#endif
+struct ThreadMemGuard {
+    bool armed = false;
+
+    ~ThreadMemGuard() {
+        ThreadMemState &st = t_mem_state;
+        if (st.state != CACHE_ACTIVE)
+            return;
+        flush_free_lists(st);
+
+        std::lock_guard<std::mutex> lock(g_stats_lock);
+        ThreadMemStats **link = &g_thread_stats;
+        while (*link && *link != &st.stats)
+            link = &(*link)->next;
+        if (*link)
+            *link = st.stats.next;
+        for (int i = 0; i < MEM_TAG_MAX; ++i) {
+            g_retired_usage[i].fetch_add(st.stats.usage[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            g_retired_allocs[i].fetch_add(st.stats.allocs[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        st.state = CACHE_DESTROYED;
+    }
+};
+
+thread_local ThreadMemGuard t_mem_guard;
+
+_ALWAYS_INLINE_ ThreadMemState &thread_mem_state() {
+    ThreadMemState &st = t_mem_state;
+    if (unlikely(st.state == CACHE_UNINITIALIZED)) {
+        st.state = CACHE_ACTIVE;
+        t_mem_guard.armed = true; // registers the guard's destructor for this thread
+        std::lock_guard<std::mutex> lock(g_stats_lock);
+        st.stats.next = g_thread_stats;
+        g_thread_stats = &st.stats;
+    }
+    return st;
+}
+
+_ALWAYS_INLINE_ void record_usage(ThreadMemState &st, uint8_t p_tag, int64_t p_bytes, int64_t p_count) {
+    if (likely(st.state == CACHE_ACTIVE)) {
+        std::atomic<int64_t> &usage = st.stats.usage[p_tag];
+        std::atomic<int64_t> &allocs = st.stats.allocs[p_tag];
+        usage.store(usage.load(std::memory_order_relaxed) + p_bytes, std::memory_order_relaxed);
+        allocs.store(allocs.load(std::memory_order_relaxed) + p_count, std::memory_order_relaxed);
+    } else {
+        g_retired_usage[p_tag].fetch_add(p_bytes, std::memory_order_relaxed);
+        g_retired_allocs[p_tag].fetch_add(p_count, std::memory_order_relaxed);
+    }
+}
+
+int64_t sum_stats(int p_tag, bool p_allocs) {
+    int64_t total = (p_allocs ? g_retired_allocs : g_retired_usage)[p_tag].load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(g_stats_lock);
+    for (ThreadMemStats *ts = g_thread_stats; ts; ts = ts->next) {
+        total += (p_allocs ? ts->allocs : ts->usage)[p_tag].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // end of anonymous namespace
 
 void *operator new(size_t p_size, const char *p_description) {
 
@@ -74,36 +215,42 @@ void operator delete(void *p_mem, void *p_pointer, size_t check, const char *p_d
 }
 #endif
 
-uint64_t Memory::alloc_count = 0;
-
 void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
-#ifdef DEBUG_ENABLED
-    bool prepad = true;
-#else
-    bool prepad = p_pad_align;
-#endif
-
-    void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
-
-    assert(mem);
 
-    atomic_increment(&alloc_count);
+    return alloc_static(p_bytes, t_mem_state.tag, p_pad_align);
+}
 
-    TRACE_ALLOC(mem, p_bytes + (prepad ? PAD_ALIGN : 0));
-    if (prepad) {
-        uint64_t *s = (uint64_t *)mem;
-        *s = p_bytes;
+void *Memory::alloc_static(size_t p_bytes, MemoryTag p_tag, bool p_pad_align) {
 
-        uint8_t *s8 = (uint8_t *)mem;
+    ThreadMemState &st = thread_mem_state();
+    const size_t total = p_bytes + PAD_ALIGN;
+    uint8_t cls = 0;
+    void *mem;
 
-#ifdef DEBUG_ENABLED
-        atomic_add(&mem_usage, p_bytes);
-        atomic_exchange_if_greater(&max_usage, mem_usage);
-#endif
-        return s8 + PAD_ALIGN;
+    if (total <= MAX_SMALL_BLOCK) {
+        cls = size_classes.lookup[(total + 15) / 16];
+        FreeBlock *blk = st.free_lists[cls];
+        if (blk) {
+            st.free_lists[cls] = blk->next;
+            st.free_counts[cls]--;
+            mem = blk;
+        } else {
+            mem = g_backend.alloc(size_class_bytes[cls]);
+        }
     } else {
-        return mem;
+        mem = g_backend.alloc(total);
     }
+
+    assert(mem);
+    TRACE_ALLOC(mem, total);
+
+    AllocHeader *hdr = (AllocHeader *)mem;
+    hdr->size = p_bytes;
+    hdr->size_class = cls;
+    hdr->tag = p_tag;
+    record_usage(st, p_tag, int64_t(p_bytes), 1);
+
+    return (uint8_t *)mem + PAD_ALIGN;
 }
 
 void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
@@ -111,90 +258,102 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
     if (p_memory == nullptr) {
         return alloc_static(p_bytes, p_pad_align);
     }
-
-    uint8_t *mem = (uint8_t *)p_memory;
-
-#ifdef DEBUG_ENABLED
-    bool prepad = true;
-#else
-    bool prepad = p_pad_align;
-#endif
-
-    if (prepad) {
-        mem -= PAD_ALIGN;
-        uint64_t *s = (uint64_t *)mem;
-
-#ifdef DEBUG_ENABLED
-        if (p_bytes > *s) {
-            atomic_add(&mem_usage, p_bytes - *s);
-            atomic_exchange_if_greater(&max_usage, mem_usage);
-        } else {
-            atomic_sub(&mem_usage, *s - p_bytes);
+    if (p_bytes == 0) {
+        free_static(p_memory, p_pad_align);
+        return nullptr;
+    }
+    AllocHeader *hdr = (AllocHeader *)((uint8_t *)p_memory - PAD_ALIGN);
+    const size_t old_size = hdr->size;
+    const size_t total = p_bytes + PAD_ALIGN;
+    ThreadMemState &st = thread_mem_state();
+
+    if (hdr->size_class != 0) {
+        if (total <= size_class_bytes[hdr->size_class]) {
+            // still fits the block it lives in
+            hdr->size = p_bytes;
+            record_usage(st, hdr->tag, int64_t(p_bytes) - int64_t(old_size), 0);
+            return p_memory;
         }
-#endif
+        uint8_t *res = (uint8_t *)alloc_static(p_bytes, MemoryTag(hdr->tag), p_pad_align);
+        ((AllocHeader *)(res - PAD_ALIGN))->reserved = hdr->reserved;
+        memcpy(res, p_memory, MIN(old_size, p_bytes));
+        free_static(p_memory, p_pad_align);
+        return res;
+    }
 
-        TRACE_FREE(mem);
-        if (p_bytes == 0) {
-            free(mem);
-            return nullptr;
-        } else {
-            *s = p_bytes;
-            mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
-            TRACE_ALLOC(mem, p_bytes + PAD_ALIGN);
+    TRACE_FREE(hdr);
+    uint8_t *mem = (uint8_t *)g_backend.realloc(hdr, total);
+    assert(mem);
+    if (unlikely(!mem))
+        return nullptr;
+    TRACE_ALLOC(mem, total);
 
-            assert(mem);
-            if(unlikely(!mem))
-                return nullptr;
+    hdr = (AllocHeader *)mem;
+    hdr->size = p_bytes;
+    record_usage(st, hdr->tag, int64_t(p_bytes) - int64_t(old_size), 0);
 
-            s = (uint64_t *)mem;
+    return mem + PAD_ALIGN;
+}
 
-            *s = p_bytes;
+void Memory::free_static(void *p_ptr, bool p_pad_align) {
 
-            return mem + PAD_ALIGN;
-        }
-    } else {
+    assert(p_ptr);
+    if (unlikely(p_ptr == nullptr))
+        return;
+
+    AllocHeader *hdr = (AllocHeader *)((uint8_t *)p_ptr - PAD_ALIGN);
+    ThreadMemState &st = thread_mem_state();
+    const uint8_t cls = hdr->size_class;
 
-        TRACE_FREE(mem);
-        mem = (uint8_t *)realloc(mem, p_bytes);
-        TRACE_ALLOC(mem, p_bytes);
-        assert(mem != nullptr || p_bytes == 0);
-        if(unlikely(mem == nullptr && p_bytes > 0))
-            return nullptr;
+    record_usage(st, hdr->tag, -int64_t(hdr->size), -1);
+    TRACE_FREE(hdr);
 
-        return mem;
+    if (cls != 0 && st.state == CACHE_ACTIVE && st.free_counts[cls] < size_classes.cache_limit[cls]) {
+        FreeBlock *blk = (FreeBlock *)hdr;
+        blk->next = st.free_lists[cls];
+        st.free_lists[cls] = blk;
+        st.free_counts[cls]++;
+        return;
     }
+    g_backend.free(hdr);
 }
 
-void Memory::free_static(void *p_ptr, bool p_pad_align) {
+void Memory::set_backend(const MemoryBackend &p_backend) {
 
-    assert(p_ptr);
-    if(unlikely(p_ptr == nullptr))
-        return;
+    g_backend = p_backend;
+}
 
-    uint8_t *mem = (uint8_t *)p_ptr;
+void Memory::flush_thread_cache() {
 
-#ifdef DEBUG_ENABLED
-    bool prepad = true;
-#else
-    bool prepad = p_pad_align;
-#endif
+    ThreadMemState &st = t_mem_state;
+    if (st.state == CACHE_ACTIVE)
+        flush_free_lists(st);
+}
 
-    atomic_decrement(&alloc_count);
+MemoryTag Memory::get_thread_tag() {
 
-    if (prepad) {
-        mem -= PAD_ALIGN;
+    return t_mem_state.tag;
+}
 
-#ifdef DEBUG_ENABLED
-        uint64_t *s = (uint64_t *)mem;
-        atomic_sub(&mem_usage, *s);
-#endif
+void Memory::set_thread_tag(MemoryTag p_tag) {
 
-        free(mem);
-    } else {
+    t_mem_state.tag = p_tag;
+}
 
-        free(mem);
-    }
-    TRACE_FREE(mem);
+const char *Memory::get_tag_name(MemoryTag p_tag) {
+
+    static const char *names[MEM_TAG_MAX] = {
+        "general",
+        "scene",
+        "resource",
+        "rendering",
+        "physics",
+        "audio",
+        "script",
+        "network",
+    };
+    ERR_FAIL_INDEX_V(p_tag, MEM_TAG_MAX, "");
+    return names[p_tag];
 }
 
 uint64_t Memory::get_mem_available() {
@@ -203,17 +362,42 @@ uint64_t Memory::get_mem_available() {
 }
 
 uint64_t Memory::get_mem_usage() {
-#ifdef DEBUG_ENABLED
-    return mem_usage;
-#else
-    return 0;
-#endif
+
+    int64_t total = 0;
+    for (int i = 0; i < MEM_TAG_MAX; ++i)
+        total += sum_stats(i, false);
+    uint64_t usage = total > 0 ? uint64_t(total) : 0;
+
+    uint64_t prev_max = g_max_usage.load(std::memory_order_relaxed);
+    while (usage > prev_max && !g_max_usage.compare_exchange_weak(prev_max, usage, std::memory_order_relaxed)) {
+    }
+    return usage;
 }
 
 uint64_t Memory::get_mem_max_usage() {
-#ifdef DEBUG_ENABLED
-    return max_usage;
-#else
-    return 0;
-#endif
+
+    get_mem_usage();
+    return g_max_usage.load(std::memory_order_relaxed);
+}
+
+uint64_t Memory::get_alloc_count() {
+
+    int64_t total = 0;
+    for (int i = 0; i < MEM_TAG_MAX; ++i)
+        total += sum_stats(i, true);
+    return total > 0 ? uint64_t(total) : 0;
+}
+
+uint64_t Memory::get_tag_usage(MemoryTag p_tag) {
+
+    ERR_FAIL_INDEX_V(p_tag, MEM_TAG_MAX, 0);
+    int64_t total = sum_stats(p_tag, false);
+    return total > 0 ? uint64_t(total) : 0;
+}
+
+uint64_t Memory::get_tag_alloc_count(MemoryTag p_tag) {
+
+    ERR_FAIL_INDEX_V(p_tag, MEM_TAG_MAX, 0);
+    int64_t total = sum_stats(p_tag, true);
+    return total > 0 ? uint64_t(total) : 0;
 }
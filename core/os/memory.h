@@ -34,20 +34,69 @@
 #include <stdint.h>
 #include <cstddef>
 
-class GODOT_EXPORT Memory {
+/// Subsystem tags used to attribute allocations in memory statistics.
+enum MemoryTag : uint8_t {
+    MEM_TAG_GENERAL,
+    MEM_TAG_SCENE,
+    MEM_TAG_RESOURCE,
+    MEM_TAG_RENDERING,
+    MEM_TAG_PHYSICS,
+    MEM_TAG_AUDIO,
+    MEM_TAG_SCRIPT,
+    MEM_TAG_NETWORK,
+    MEM_TAG_MAX
+};
 
-    static uint64_t alloc_count;
+/// Raw block provider used by Memory, defaults to malloc/realloc/free.
+struct MemoryBackend {
+    void *(*alloc)(size_t p_bytes);
+    void *(*realloc)(void *p_ptr, size_t p_bytes);
+    void (*free)(void *p_ptr);
+};
 
+/**
+ * Engine allocator.
+ * Every block carries a 16 byte header: the first 8 bytes hold the requested size, size class and tag, the second
+ * 8 bytes are reserved for callers passing p_pad_align (CowData refcount/size, memnew_arr element count).
+ * Small blocks are recycled through per-thread size class caches, so the common alloc/free pair never touches a lock
+ * or an atomic. Usage statistics are kept per-thread and per-tag in every build, and summed when queried.
+ */
+class GODOT_EXPORT Memory {
 public:
     Memory() = delete;
 
     static void *alloc_static(size_t p_bytes, bool p_pad_align = false);
+    static void *alloc_static(size_t p_bytes, MemoryTag p_tag, bool p_pad_align = false);
     static void *realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align = false);
     static void free_static(void *p_ptr, bool p_pad_align = false);
 
+    //! Must be called before the first allocation is made, blocks are always returned to the backend that made them.
+    static void set_backend(const MemoryBackend &p_backend);
+    //! Returns cached small blocks of the calling thread to the backend.
+    static void flush_thread_cache();
+
+    static MemoryTag get_thread_tag();
+    static void set_thread_tag(MemoryTag p_tag);
+    static const char *get_tag_name(MemoryTag p_tag);
+
     static uint64_t get_mem_available();
     static uint64_t get_mem_usage();
+    //! Peak usage is sampled whenever usage is queried, so it is only as accurate as the polling rate.
     static uint64_t get_mem_max_usage();
+    static uint64_t get_alloc_count();
+    static uint64_t get_tag_usage(MemoryTag p_tag);
+    static uint64_t get_tag_alloc_count(MemoryTag p_tag);
+};
+
+/// Tags all allocations made by the current thread within its lifetime.
+class MemoryTagScope {
+    MemoryTag prev_tag;
+
+public:
+    explicit MemoryTagScope(MemoryTag p_tag) : prev_tag(Memory::get_thread_tag()) { Memory::set_thread_tag(p_tag); }
+    ~MemoryTagScope() { Memory::set_thread_tag(prev_tag); }
+    MemoryTagScope(const MemoryTagScope &) = delete;
+    MemoryTagScope &operator=(const MemoryTagScope &) = delete;
 };
 
 class GODOT_EXPORT DefaultAllocator {
@@ -68,7 +117,7 @@ public:
         return Memory::alloc_static(n, false);
     }
     void* allocate(size_t n, size_t /*alignment*/, size_t /*offset*/, int /*flags*/ = 0) {
-        return Memory::alloc_static(n, true);
+        return Memory::alloc_static(n, false);
     }
     void  deallocate(void* p, size_t /*n*/) {
         return Memory::free_static(p, false);
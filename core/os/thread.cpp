@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "thread.h"
+#include "core/frame_profiler.h"
 #include "core/string.h"
 
 Thread *(*Thread::create_func)(ThreadCreateCallback, void *, const Settings &) = nullptr;
@@ -62,6 +63,7 @@ void Thread::wait_to_finish(Thread *p_thread) {
 
 Error Thread::set_name(StringView p_name) {
 
+    FrameProfiler::set_thread_name(p_name);
     if (set_name_func)
         return set_name_func(p_name);
 
@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "worker_thread_pool.h"
+
+#include "core/external_profiler.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+
+#include <atomic>
+
+WorkerThreadPool *WorkerThreadPool::get_singleton() {
+
+    static WorkerThreadPool pool;
+    return &pool;
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+    WorkerThreadPool *pool = (WorkerThreadPool *)p_user;
+    Thread::set_name("WorkerThreadPool");
+
+    std::unique_lock<std::mutex> lock(pool->task_mutex);
+    while (true) {
+        if (pool->_run_one_locked(lock))
+            continue;
+        if (pool->exit_threads)
+            break;
+        pool->task_available.wait(lock);
+    }
+}
+
+void WorkerThreadPool::_start_threads() {
+
+    int count = requested_thread_count;
+    if (count < 0) {
+        count = OS::get_singleton() ? OS::get_singleton()->get_processor_count() - 1 : 1;
+        count = M_MAX(count, 1);
+    }
+
+    exit_threads = false;
+    threads.reserve(count);
+    for (int i = 0; i < count; i++) {
+        Thread *thread = Thread::create(&WorkerThreadPool::_thread_function, this);
+        if (!thread)
+            break; // threads are not supported, tasks will run on the caller
+        threads.push_back(thread);
+    }
+}
+
+bool WorkerThreadPool::_run_one_locked(std::unique_lock<std::mutex> &p_lock) {
+
+    if (task_queue.empty())
+        return false;
+
+    Task task = eastl::move(task_queue.front());
+    task_queue.pop_front();
+
+    p_lock.unlock();
+    {
+        SCOPE_PROFILE(worker_task);
+        task.func();
+    }
+    task.func = nullptr; // release captures outside of the lock
+    p_lock.lock();
+
+    pending_tasks.erase(task.id);
+    task_finished.notify_all();
+    return true;
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_task(eastl::function<void()> &&p_func, bool p_high_priority) {
+
+    std::unique_lock<std::mutex> lock(task_mutex);
+    if (threads.empty()) {
+        _start_threads();
+    }
+    TaskID id = ++last_task_id;
+
+    if (threads.empty()) {
+        lock.unlock();
+        p_func();
+        return id;
+    }
+
+    pending_tasks.insert(id);
+    if (p_high_priority) {
+        task_queue.push_front(Task { eastl::move(p_func), id });
+    } else {
+        task_queue.push_back(Task { eastl::move(p_func), id });
+    }
+    lock.unlock();
+
+    task_available.notify_one();
+    return id;
+}
+
+bool WorkerThreadPool::is_task_completed(TaskID p_task) const {
+
+    std::lock_guard<std::mutex> lock(task_mutex);
+    return !pending_tasks.contains(p_task);
+}
+
+void WorkerThreadPool::wait_for_task_completion(TaskID p_task) {
+
+    std::unique_lock<std::mutex> lock(task_mutex);
+    while (pending_tasks.contains(p_task)) {
+        if (!_run_one_locked(lock)) {
+            task_finished.wait(lock);
+        }
+    }
+}
+
+void WorkerThreadPool::parallel_for(uint32_t p_count, const eastl::function<void(uint32_t)> &p_func) {
+
+    if (p_count == 0)
+        return;
+
+    std::atomic<uint32_t> next_index { 0 };
+    auto process = [&]() {
+        for (uint32_t i = next_index++; i < p_count; i = next_index++) {
+            p_func(i);
+        }
+    };
+
+    uint32_t helper_count = MIN(uint32_t(get_thread_count()), p_count - 1);
+    FixedVector<TaskID, 32, true> helpers;
+    for (uint32_t i = 0; i < helper_count; i++) {
+        helpers.push_back(add_task(process, true));
+    }
+
+    process();
+
+    for (TaskID id : helpers) {
+        wait_for_task_completion(id);
+    }
+}
+
+int WorkerThreadPool::get_thread_count() {
+
+    std::lock_guard<std::mutex> lock(task_mutex);
+    if (threads.empty()) {
+        _start_threads();
+    }
+    return threads.size();
+}
+
+void WorkerThreadPool::set_thread_count(int p_count) {
+
+    finish();
+    std::lock_guard<std::mutex> lock(task_mutex);
+    requested_thread_count = p_count;
+}
+
+void WorkerThreadPool::finish() {
+
+    Vector<Thread *> to_join;
+    {
+        std::lock_guard<std::mutex> lock(task_mutex);
+        exit_threads = true;
+        to_join = eastl::move(threads);
+        threads.clear();
+    }
+    task_available.notify_all();
+
+    for (Thread *thread : to_join) {
+        Thread::wait_to_finish(thread);
+        memdelete(thread);
+    }
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+    finish();
+}
@@ -0,0 +1,96 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/deque.h"
+#include "core/hash_set.h"
+#include "core/typedefs.h"
+#include "core/vector.h"
+
+#include "EASTL/functional.h"
+
+#include <condition_variable>
+#include <mutex>
+
+class Thread;
+
+/**
+ * Shared pool of worker threads for engine jobs that should not run on the main thread.
+ * Tasks are executed in submission order, high priority tasks are placed in front of the queue.
+ * Threads waiting on a task help by executing queued tasks, so waiting from inside a task does not deadlock.
+ */
+class GODOT_EXPORT WorkerThreadPool {
+public:
+    using TaskID = uint64_t;
+    enum : TaskID {
+        INVALID_TASK_ID = 0
+    };
+
+private:
+    struct Task {
+        eastl::function<void()> func;
+        TaskID id;
+    };
+
+    mutable std::mutex task_mutex;
+    std::condition_variable task_available;
+    std::condition_variable task_finished;
+    Deque<Task> task_queue;
+    HashSet<TaskID> pending_tasks;
+    Vector<Thread *> threads;
+    TaskID last_task_id = INVALID_TASK_ID;
+    int requested_thread_count = -1;
+    bool exit_threads = false;
+
+    static void _thread_function(void *p_user);
+    void _start_threads();
+    bool _run_one_locked(std::unique_lock<std::mutex> &p_lock);
+
+public:
+    static WorkerThreadPool *get_singleton();
+
+    TaskID add_task(eastl::function<void()> &&p_func, bool p_high_priority = false);
+    bool is_task_completed(TaskID p_task) const;
+    void wait_for_task_completion(TaskID p_task);
+
+    //! Calls p_func for every index in [0,p_count) using the pool and the calling thread, returns when all are done.
+    void parallel_for(uint32_t p_count, const eastl::function<void(uint32_t)> &p_func);
+
+    int get_thread_count();
+    //! Restarts the pool with p_count worker threads, 0 runs everything on the caller, -1 picks one per extra core.
+    void set_thread_count(int p_count);
+    //! Waits for queued tasks and joins all threads, further tasks restart the pool.
+    void finish();
+
+    WorkerThreadPool() = default;
+    ~WorkerThreadPool();
+};
@@ -31,98 +31,65 @@
 #include "pool_vector.h"
 #include "core/math/vector2.h"
 #include "core/math/vector3.h"
-#include "core/os/mutex.h"
 
 template class EXPORT_TEMPLATE_DEFINE(GODOT_EXPORT) PoolVector<Vector2>;
 template class EXPORT_TEMPLATE_DEFINE(GODOT_EXPORT) PoolVector<Vector3>;
 template class EXPORT_TEMPLATE_DEFINE(GODOT_EXPORT) PoolVector<unsigned char>;
 
 
-MemoryPool::Alloc *MemoryPool::allocs = nullptr;
-MemoryPool::Alloc *MemoryPool::free_list = nullptr;
-uint32_t MemoryPool::alloc_count = 0;
-uint32_t MemoryPool::allocs_used = 0;
-Mutex *MemoryPool::alloc_mutex = nullptr;
+uint64_t MemoryPool::allocs_used = 0;
+uint64_t MemoryPool::total_memory = 0;
+uint64_t MemoryPool::max_memory = 0;
 
-size_t MemoryPool::total_memory = 0;
-size_t MemoryPool::max_memory = 0;
-
-void MemoryPool::setup(uint32_t p_max_allocs) {
-
-    allocs = memnew_arr(Alloc, p_max_allocs);
-    alloc_count = p_max_allocs;
-    allocs_used = 0;
-
-    for (uint32_t i = 0; i < alloc_count - 1; i++) {
-
-        allocs[i].free_list = &allocs[i + 1];
-    }
-
-    free_list = &allocs[0];
-
-    alloc_mutex = memnew(Mutex);
+void MemoryPool::setup() {
 }
 
 void MemoryPool::cleanup() {
 
-    memdelete_arr(allocs);
-    memdelete(alloc_mutex);
-
-    ERR_FAIL_COND_MSG(allocs_used > 0, "There are still MemoryPool allocs in use at exit!"); 
+    ERR_FAIL_COND_MSG(allocs_used > 0, "There are still MemoryPool allocs in use at exit!");
 }
 
-bool MemoryPool::do_alloc_block(MemoryPool::Alloc *&alloc)
-{
-    MemoryPool::alloc_mutex->lock();
-    if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-        MemoryPool::alloc_mutex->unlock();
-        ERR_FAIL_V_MSG(false,"All memory pool allocations are in use, can't COW.");
-    }
-
-    MemoryPool::Alloc *old_alloc = alloc;
+MemoryPool::Alloc *MemoryPool::allocate(uint32_t p_capacity, size_t p_elem_size) {
 
-    //take one from the free list
-    alloc = MemoryPool::free_list;
-    MemoryPool::free_list = alloc->free_list;
-    //increment the used counter
-    MemoryPool::allocs_used++;
-
-    //copy the alloc data
-    alloc->size = old_alloc ? old_alloc->size : 0;
+    Alloc *alloc = reinterpret_cast<Alloc *>(memalloc(HEADER_SIZE + p_elem_size * p_capacity));
+    CRASH_COND_MSG(!alloc, "Out of memory.");
     alloc->refcount.init();
+    alloc->size = 0;
+    alloc->capacity = p_capacity;
     alloc->lock = 0;
-
 #ifdef DEBUG_ENABLED
-    MemoryPool::total_memory += alloc->size;
-    if (MemoryPool::total_memory > MemoryPool::max_memory) {
-        MemoryPool::max_memory = MemoryPool::total_memory;
-    }
+    atomic_increment(&allocs_used);
+    update_total_memory(int64_t(p_elem_size * p_capacity));
 #endif
+    return alloc;
+}
+
+MemoryPool::Alloc *MemoryPool::reallocate(Alloc *p_alloc, uint32_t p_capacity, size_t p_elem_size) {
 
-    MemoryPool::alloc_mutex->unlock();
-    alloc->mem = memalloc(alloc->size);
-    return true;
+#ifdef DEBUG_ENABLED
+    update_total_memory(int64_t(p_elem_size * p_capacity) - int64_t(p_elem_size * p_alloc->capacity));
+#endif
+    Alloc *alloc = reinterpret_cast<Alloc *>(memrealloc(p_alloc, HEADER_SIZE + p_elem_size * p_capacity));
+    CRASH_COND_MSG(!alloc, "Out of memory.");
+    alloc->capacity = p_capacity;
+    return alloc;
 }
 
-void MemoryPool::releaseBlock(MemoryPool::Alloc *alloc) {
-    memfree(alloc->mem);
-    alloc->mem = nullptr;
-    alloc->size = 0;
-    alloc_mutex->lock();
-    alloc->free_list = free_list;
-    free_list = alloc;
-    allocs_used--;
-    alloc_mutex->unlock();
+void MemoryPool::release(Alloc *p_alloc, size_t p_elem_size) {
+
+#ifdef DEBUG_ENABLED
+    atomic_decrement(&allocs_used);
+    update_total_memory(-int64_t(p_elem_size * p_alloc->capacity));
+#else
+    (void)p_elem_size;
+#endif
+    memfree(p_alloc);
 }
 
 #ifdef DEBUG_ENABLED
-void MemoryPool::doUpdate(int delta)
-{
-    alloc_mutex->lock();
-    total_memory += delta;
-    if (total_memory > max_memory) {
-        max_memory = total_memory;
-    }
-    alloc_mutex->unlock();
+void MemoryPool::update_total_memory(int64_t p_delta) {
+
+    uint64_t total = atomic_add(&total_memory, p_delta);
+    atomic_exchange_if_greater(&max_memory, total);
 }
 #endif
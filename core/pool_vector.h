@@ -39,6 +39,9 @@
 #include "core/vector.h"
 
 #include "EASTL/type_traits.h"
+#include "EASTL/span.h"
+
+#include <new>
 
 class Object;
 namespace std {
@@ -46,43 +49,43 @@ class recursive_mutex;
 }
 using Mutex = std::recursive_mutex;
 
+/**
+ * Backing storage for PoolVector.
+ *
+ * Every buffer is a single allocation: a small refcounted header followed by the elements, so there is no
+ * global allocation table or mutex involved in allocating, sharing or releasing buffers.
+ * Memory statistics are only tracked in debug builds.
+ */
 struct GODOT_EXPORT MemoryPool {
 
     struct Alloc {
 
         SafeRefCount refcount;
-        uint32_t lock = 0;
-        void *mem = nullptr;
-        size_t size = 0;
-        Alloc *free_list = nullptr;
+        uint32_t size; // in elements
+        uint32_t capacity; // in elements
+        uint32_t lock; // number of live Read/Write accessors, a locked vector can't be resized
     };
+    // keeps the element storage 16 byte aligned
+    static constexpr size_t HEADER_SIZE = (sizeof(Alloc) + 15) & ~size_t(15);
 
     //avoid accessing these directly, must be public for template access
-    static Alloc *allocs;
-    static Alloc *free_list;
-    static uint32_t alloc_count;
-    static uint32_t allocs_used;
-    static Mutex *alloc_mutex;
-    static size_t total_memory;
-    static size_t max_memory;
-
-    static void setup(uint32_t p_max_allocs = (1 << 16));
+    static uint64_t allocs_used;
+    static uint64_t total_memory;
+    static uint64_t max_memory;
+
+    static void setup();
     static void cleanup();
-    static bool do_alloc_block(Alloc *&alloc);
-    static void updateTotalMemory(int delta) {
-#ifdef DEBUG_ENABLED
-        doUpdate(delta);
-#else
-        (void)delta;
-#endif
-    }
-    static void decTotalMemory(const Alloc *alloc) {
-        updateTotalMemory(-int(alloc->size));
-    }
-    static void releaseBlock(Alloc *alloc);
+
+    static Alloc *allocate(uint32_t p_capacity, size_t p_elem_size);
+    //! Only valid for buffers holding trivially copyable elements.
+    static Alloc *reallocate(Alloc *p_alloc, uint32_t p_capacity, size_t p_elem_size);
+    static void release(Alloc *p_alloc, size_t p_elem_size);
+
+    static _FORCE_INLINE_ void *get_data(Alloc *p_alloc) { return reinterpret_cast<uint8_t *>(p_alloc) + HEADER_SIZE; }
+
 private:
 #ifdef DEBUG_ENABLED
-    static void doUpdate(int delta);
+    static void update_total_memory(int64_t p_delta);
 #endif
 };
 
@@ -92,6 +95,75 @@ class PoolVector {
 
     MemoryPool::Alloc *alloc;
 
+    static constexpr bool is_trivial = eastl::is_trivially_copyable<T>::value && eastl::is_trivially_destructible<T>::value;
+
+    static _FORCE_INLINE_ T *_data(MemoryPool::Alloc *p_alloc) { return reinterpret_cast<T *>(MemoryPool::get_data(p_alloc)); }
+
+    static void _construct(T *p_dst, uint32_t p_count) {
+        if constexpr (eastl::is_trivially_default_constructible<T>::value) {
+            return; // same as default initialization, contents are undefined until written
+        } else if constexpr (std::is_base_of<Object, T>::value) {
+            for (uint32_t i = 0; i < p_count; i++) {
+                memnew_placement(&p_dst[i], T);
+            }
+        } else {
+            for (uint32_t i = 0; i < p_count; i++) {
+                memnew_placement_basic(&p_dst[i], T);
+            }
+        }
+    }
+
+    static void _destroy(T *p_elems, uint32_t p_count) {
+        if constexpr (!eastl::is_trivially_destructible<T>::value) {
+            for (uint32_t i = 0; i < p_count; i++) {
+                p_elems[i].~T();
+            }
+        }
+    }
+
+    static void _release(MemoryPool::Alloc *p_alloc) {
+
+        if (!p_alloc->refcount.unref())
+            return;
+        //last reference, must be disposed
+        _destroy(_data(p_alloc), p_alloc->size);
+        MemoryPool::release(p_alloc, sizeof(T));
+    }
+
+    //! Makes this vector the only owner of a buffer that can hold at least p_capacity elements.
+    void _make_unique(uint32_t p_capacity) {
+
+        if (alloc->refcount.get() == 1) {
+            if (p_capacity <= alloc->capacity)
+                return;
+            if constexpr (is_trivial) {
+                alloc = MemoryPool::reallocate(alloc, p_capacity, sizeof(T));
+                return;
+            }
+        }
+
+        MemoryPool::Alloc *old_alloc = alloc;
+        MemoryPool::Alloc *new_alloc = MemoryPool::allocate(M_MAX(p_capacity, old_alloc->size), sizeof(T));
+        new_alloc->size = old_alloc->size;
+
+        T *dst = _data(new_alloc);
+        T *src = _data(old_alloc);
+        if constexpr (is_trivial) {
+            memcpy(dst, src, sizeof(T) * old_alloc->size);
+        } else if (old_alloc->refcount.get() == 1) {
+            // sole owner, elements can be moved instead of copied
+            for (uint32_t i = 0; i < old_alloc->size; i++) {
+                memnew_placement_basic(&dst[i], T(eastl::move(src[i])));
+            }
+        } else {
+            for (uint32_t i = 0; i < old_alloc->size; i++) {
+                memnew_placement_basic(&dst[i], T(src[i]));
+            }
+        }
+        alloc = new_alloc;
+        _release(old_alloc);
+    }
+
     void _copy_on_write() {
 
         if (!alloc)
@@ -103,48 +175,7 @@ class PoolVector {
         if (alloc->refcount.get() == 1)
             return; //nothing to do
 
-        //must allocate something
-        MemoryPool::Alloc *old_alloc = alloc;
-        if(!MemoryPool::do_alloc_block(alloc))
-            return;
-
-        {
-            Write w;
-            w._ref(alloc);
-            Read r;
-            r._ref(old_alloc);
-
-            int cur_elements = int(alloc->size / sizeof(T));
-            T *dst = (T *)w.ptr();
-            const T *src = (const T *)r.ptr();
-            if constexpr (std::is_base_of<Object, T>::value) {
-                for (int i = 0; i < cur_elements; i++) {
-                    memnew_placement(&dst[i], T(src[i]));
-                }
-            } else {
-                for (int i = 0; i < cur_elements; i++) {
-                    memnew_placement_basic(&dst[i], T(src[i]));
-                }
-            }
-        }
-        if (old_alloc->refcount.unref()) {
-            //this should never happen but..
-            MemoryPool::decTotalMemory(old_alloc);
-            {
-                Write w;
-                w._ref(old_alloc);
-
-                if constexpr(!std::is_trivially_destructible<T>::value) {
-                    int cur_elements = int(old_alloc->size / sizeof(T));
-                    T *elems = (T *)w.ptr();
-                    for (int i = 0; i < cur_elements; i++) {
-                        elems[i].~T();
-                    }
-                }
-            }
-
-            MemoryPool::releaseBlock(old_alloc);
-        }
+        _make_unique(alloc->size);
     }
 
     void _reference(const PoolVector &p_pool_vector) {
@@ -168,68 +199,43 @@ class PoolVector {
         if (!alloc)
             return;
 
-        if (!alloc->refcount.unref()) {
-            alloc = nullptr;
-            return;
-        }
-
-        //must be disposed!
-
-        {
-            int cur_elements = int(alloc->size / sizeof(T));
-
-            // Don't use write() here because it could otherwise provoke COW,
-            // which is not desirable here because we are destroying the last reference anyways
-            Write w;
-            // Reference to still prevent other threads from touching the alloc
-            w._ref(alloc);
-            if constexpr(!std::is_trivially_destructible<T>::value) {
-                for (int i = 0; i < cur_elements; i++) {
-                    w[i].~T();
-                }
-            }
-        }
-
-        MemoryPool::decTotalMemory(alloc);
-
-        MemoryPool::releaseBlock(alloc);
+        _release(alloc);
         alloc = nullptr;
     }
+
     class Access {
         friend class PoolVector;
 
     protected:
-        MemoryPool::Alloc *alloc;
-        T *mem;
+        T *mem = nullptr;
+        MemoryPool::Alloc *alloc = nullptr;
 
         _FORCE_INLINE_ void _ref(MemoryPool::Alloc *p_alloc) {
+            if (!p_alloc)
+                return;
+            mem = _data(p_alloc);
             alloc = p_alloc;
-            if (alloc) {
-                if (atomic_increment(&alloc->lock) == 1) {
-                }
+            atomic_increment(&alloc->lock);
+        }
 
-                mem = (T *)alloc->mem;
-            }
+        _FORCE_INLINE_ void _ref(const Access &p_from) {
+            _ref(p_from.alloc);
         }
 
-        _FORCE_INLINE_ void _unref() {
+        _FORCE_INLINE_ bool _same(const Access &p_other) const { return mem == p_other.mem; }
 
+        _FORCE_INLINE_ void _unref() {
             if (alloc) {
-                if (atomic_decrement(&alloc->lock) == 0) {
-                }
-
-                mem = nullptr;
+                atomic_decrement(&alloc->lock);
                 alloc = nullptr;
             }
-        }
-
-        Access() {
-            alloc = nullptr;
             mem = nullptr;
         }
 
+        Access() = default;
+
     public:
-        virtual ~Access() {
+        ~Access() {
             _unref();
         }
 
@@ -242,21 +248,22 @@ public:
     using ValueType = T;
 
 
+    //! Read access to the elements, valid as long as the vector it came from is not resized or destroyed.
     class Read : public Access {
     public:
         const T &operator[](uint32_t p_index) const { return this->mem[p_index]; }
         const T *ptr() const { return this->mem; }
 
         Read &operator=(const Read &p_read) {
-            if (this->alloc == p_read.alloc)
+            if (this->_same(p_read))
                 return *this;
             this->_unref();
-            this->_ref(p_read.alloc);
+            this->_ref(p_read);
             return *this;
         }
 
         Read(const Read &p_read) {
-            this->_ref(p_read.alloc);
+            this->_ref(p_read);
         }
 
         Read() = default;
@@ -268,15 +275,15 @@ public:
         [[nodiscard]] T *ptr() const { return this->mem; }
 
         Write &operator=(const Write &p_read) {
-            if (this->alloc == p_read.alloc)
+            if (this->_same(p_read))
                 return *this;
             this->_unref();
-            this->_ref(p_read.alloc);
+            this->_ref(p_read);
             return *this;
         }
 
         Write(const Write &p_read) {
-            this->_ref(p_read.alloc);
+            this->_ref(p_read);
         }
 
         Write() = default;
@@ -285,9 +292,7 @@ public:
     [[nodiscard]] Read read() const {
 
         Read r;
-        if (alloc) {
-            r._ref(alloc);
-        }
+        r._ref(alloc);
         return r;
     }
     [[nodiscard]] Write write() {
@@ -299,6 +304,8 @@ public:
         }
         return w;
     }
+    //! Unguarded read view, same lifetime rules as Read but without any bookkeeping.
+    [[nodiscard]] const T *ptr() const { return alloc ? _data(alloc) : nullptr; }
 
     template <class MC>
     void fill_with(const MC &p_mc) {
@@ -317,16 +324,17 @@ public:
 
         int s = size();
         ERR_FAIL_INDEX(p_index, s);
-        Write w = write();
-        for (int i = p_index; i < s - 1; i++) {
+        {
+            Write w = write();
+            for (int i = p_index; i < s - 1; i++) {
 
-            w[i] = w[i + 1];
+                w[i] = eastl::move(w[i + 1]);
+            }
         }
-        w = Write();
         resize(s - 1);
     }
     [[nodiscard]] bool contains(const T &v) const {
-        auto rd=read();
+        const T *rd = ptr();
         for(int i=0,fin=size(); i<fin; ++i)
             if(rd[i]==v)
                 return true;
@@ -343,10 +351,12 @@ public:
         int ds = p_arr.size();
         if (ds == 0)
             return;
+        // keep p_arr alive, it might share the buffer with this vector
+        PoolVector<T> src(p_arr);
         int bs = size();
         resize(bs + ds);
         Write w = write();
-        Read r = p_arr.read();
+        const T *r = src.ptr();
         for (int i = 0; i < ds; i++)
             w[bs + i] = r[i];
     }
@@ -362,41 +372,40 @@ public:
         ERR_FAIL_INDEX_V(p_from, size(), PoolVector<T>());
         ERR_FAIL_INDEX_V(p_to, size(), PoolVector<T>());
 
-        PoolVector<T> slice;
-        int span = 1 + p_to - p_from;
-        slice.resize(span);
-        Read r = read();
-        Write w = slice.write();
-        for (int i = 0; i < span; ++i) {
-            w[i] = r[p_from + i];
-        }
-
-        return slice;
+        return PoolVector<T>(eastl::span<const T>(ptr() + p_from, 1 + p_to - p_from));
     }
 
     Error insert(int p_pos, const T &p_val) {
 
         int s = size();
         ERR_FAIL_INDEX_V(p_pos, s + 1, ERR_INVALID_PARAMETER);
+        T val(p_val); // p_val might point into this vector
         resize(s + 1);
         {
             Write w = write();
             for (int i = s; i > p_pos; i--)
-                w[i] = w[i - 1];
-            w[p_pos] = p_val;
+                w[i] = eastl::move(w[i - 1]);
+            w[p_pos] = eastl::move(val);
         }
 
         return OK;
     }
     bool is_locked() const { return alloc && alloc->lock > 0; }
+    //! Number of PoolVector instances sharing this buffer.
+    uint32_t get_refcount() const { return alloc ? alloc->refcount.get() : 0; }
 
     const T & operator[](int p_index) const;
 
     [[nodiscard]] eastl::span<const T> toSpan() const {
-        return { read().ptr(),size_t(size())};
+        return { ptr(),size_t(size())};
+    }
+    [[nodiscard]] Vector<T> toVector() const {
+        return Vector<T>(ptr(), ptr() + size());
     }
 
     Error resize(int p_size);
+    //! Preallocates storage, so that growing up to p_capacity elements doesn't reallocate.
+    Error reserve(int p_capacity);
 
     PoolVector & operator=(const PoolVector &p_pool_vector) { _reference(p_pool_vector); return *this; }
     PoolVector & operator=(PoolVector &&p_pool_vector) noexcept {
@@ -416,17 +425,34 @@ public:
             wr[idx++] = eastl::move(v);
         }
     }
+    explicit PoolVector(eastl::span<const T> from) : PoolVector() {
+        if (from.empty())
+            return;
+        alloc = MemoryPool::allocate(from.size(), sizeof(T));
+        alloc->size = from.size();
+        T *dst = _data(alloc);
+        if constexpr (is_trivial) {
+            memcpy(dst, from.data(), sizeof(T) * from.size());
+        } else {
+            for (size_t i = 0; i < from.size(); i++) {
+                memnew_placement_basic(&dst[i], T(from[i]));
+            }
+        }
+    }
     PoolVector(const PoolVector &p_pool_vector) {
         alloc = nullptr;
         _reference(p_pool_vector);
     }
+    PoolVector(PoolVector &&p_pool_vector) noexcept : alloc(p_pool_vector.alloc) {
+        p_pool_vector.alloc = nullptr;
+    }
     ~PoolVector() { pv_unreference(); }
 };
 
 template <class T>
 int PoolVector<T>::size() const {
 
-    return alloc ? int(alloc->size / sizeof(T)) : 0;
+    return alloc ? int(alloc->size) : 0;
 }
 
 template <class T>
@@ -453,8 +479,15 @@ void PoolVector<T>::set(int p_index, const T &p_val) {
 template <class T>
 void PoolVector<T>::push_back(const T &p_val) {
 
-    resize(size() + 1);
-    set(size() - 1, p_val);
+    int s = size();
+    if (alloc && alloc->refcount.get() == 1 && uint32_t(s) == alloc->capacity) {
+        // grow geometrically, so that repeated appends are amortized O(1)
+        reserve(s + M_MAX(s / 2, 4));
+    }
+    T val(p_val); // p_val might point into this vector
+    if (resize(s + 1) != OK)
+        return;
+    _data(alloc)[s] = eastl::move(val);
 }
 
 template <class T>
@@ -462,8 +495,22 @@ const T & PoolVector<T>::operator[](int p_index) const {
 
     CRASH_BAD_INDEX(p_index, size());
 
-    Read r = read();
-    return r[p_index];
+    return _data(alloc)[p_index];
+}
+
+template <class T>
+Error PoolVector<T>::reserve(int p_capacity) {
+
+    ERR_FAIL_COND_V(p_capacity < 0, ERR_INVALID_PARAMETER);
+    if (p_capacity == 0 || (alloc && alloc->capacity >= uint32_t(p_capacity) && alloc->refcount.get() == 1))
+        return OK;
+    ERR_FAIL_COND_V_MSG(is_locked(), ERR_LOCKED, "Can't resize PoolVector if locked."); //can't resize if locked!
+    if (!alloc) {
+        alloc = MemoryPool::allocate(p_capacity, sizeof(T));
+        return OK;
+    }
+    _make_unique(p_capacity);
+    return OK;
 }
 
 template <class T>
@@ -482,66 +529,44 @@ Error PoolVector<T>::resize(int p_size) {
 
         if (p_size == 0)
             return OK; //nothing to do here
-        if(!MemoryPool::do_alloc_block(alloc))
-            return ERR_OUT_OF_MEMORY;
+        alloc = MemoryPool::allocate(p_size, sizeof(T));
     } else {
-
+        if (alloc->size == uint32_t(p_size))
+            return OK; //nothing to do
         ERR_FAIL_COND_V_MSG(alloc->lock > 0, ERR_LOCKED, "Can't resize PoolVector if locked."); //can't resize if locked!
     }
 
-    size_t new_size = sizeof(T) * p_size;
-
-    if (alloc->size == new_size)
-        return OK; //nothing to do
-
     if (p_size == 0) {
         pv_unreference();
         return OK;
     }
 
-    _copy_on_write(); // make it unique
-
-    MemoryPool::updateTotalMemory(int(int64_t(new_size)-int64_t(alloc->size)));
-
-    int cur_elements = int(alloc->size / sizeof(T));
-
-    if (p_size > cur_elements) {
+    uint32_t cur_elements = alloc->size;
 
-        if (alloc->size == 0) {
-            alloc->mem = memalloc(new_size);
-        } else {
-            alloc->mem = memrealloc(alloc->mem, new_size);
-        }
+    if (uint32_t(p_size) > cur_elements) {
 
-        alloc->size = new_size;
-
-        Write w = write();
-        if constexpr(std::is_base_of<Object, T>::value) {
-            for (int i = cur_elements; i < p_size; ++i) {
-                memnew_placement(&w[i], T);
-            }
-        } else {
-            for (int i = cur_elements; i < p_size; ++i) {
-                memnew_placement_basic(&w[i], T);
-            }
-        }
+        _make_unique(p_size);
+        _construct(_data(alloc) + cur_elements, p_size - cur_elements);
+        alloc->size = p_size;
 
     } else {
 
-        {
-            Write w = write();
-            if constexpr (!std::is_trivially_destructible<T>::value) {
-                for (int i = p_size; i < cur_elements; i++) {
-                    w[i].~T();
-                }
-            }
+        if (alloc->refcount.get() != 1) {
+            // shared, copy only the elements that are kept
+            MemoryPool::Alloc *old_alloc = alloc;
+            alloc = nullptr;
+            *this = PoolVector<T>(eastl::span<const T>(_data(old_alloc), p_size));
+            _release(old_alloc);
+            return OK;
         }
 
-        if (new_size == 0) {
-            MemoryPool::releaseBlock(alloc);
-        } else {
-            alloc->mem = memrealloc(alloc->mem, new_size);
-            alloc->size = new_size;
+        _destroy(_data(alloc) + p_size, cur_elements - p_size);
+        alloc->size = p_size;
+        if constexpr (is_trivial) {
+            // give memory back when shrinking a lot
+            if (uint32_t(p_size) < alloc->capacity / 2) {
+                alloc = MemoryPool::reallocate(alloc, p_size, sizeof(T));
+            }
         }
     }
 
@@ -52,6 +52,7 @@
 #include "core/io/resource_format_binary.h"
 #include "core/io/resource_importer.h"
 #include "core/io/resource_loader.h"
+#include "core/io/resource_payload_streamer.h"
 #include "core/io/stream_peer_ssl.h"
 #include "core/io/tcp_server.h"
 #include "core/io/translation_loader_po.h"
@@ -68,6 +69,7 @@
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
@@ -123,6 +125,7 @@ void register_core_types() {
     ResourceFormatLoaderBinary::initialize_class();
     ResourceFormatImporter::initialize_class();
     ResourceFormatLoaderImage::initialize_class();
+    StreamedPayload::initialize_class();
 
     resource_format_po = make_ref_counted<TranslationLoaderPO>();
     gResourceManager().add_resource_format_loader(resource_format_po);
@@ -254,6 +257,14 @@ void register_core_settings() {
 
     GLOBAL_DEF("network/ssl/certificates", "");
     ProjectSettings::get_singleton()->set_custom_property_info("network/ssl/certificates", PropertyInfo(VariantType::STRING, "network/ssl/certificates", PropertyHint::File, "*.crt"));
+
+    bool lazy_payloads = GLOBAL_T_DEF("memory/streaming/lazy_payloads", false, bool);
+    int lazy_payload_min_size = GLOBAL_T_DEF("memory/streaming/lazy_payload_min_size_kb", 64, int);
+    ProjectSettings::get_singleton()->set_custom_property_info("memory/streaming/lazy_payload_min_size_kb", PropertyInfo(VariantType::INT, "memory/streaming/lazy_payload_min_size_kb", PropertyHint::Range, "16,65536,1,or_greater"));
+    int payload_budget = GLOBAL_T_DEF("memory/streaming/payload_budget_mb", 512, int);
+    ProjectSettings::get_singleton()->set_custom_property_info("memory/streaming/payload_budget_mb", PropertyInfo(VariantType::INT, "memory/streaming/payload_budget_mb", PropertyHint::Range, "0,65536,1,or_greater"));
+    ResourcePayloadStreamer::get_singleton()->set_lazy_loading(lazy_payloads, uint64_t(lazy_payload_min_size) * 1024);
+    ResourcePayloadStreamer::get_singleton()->set_budget(uint64_t(payload_budget) * 1024 * 1024);
 }
 
 void register_core_singletons() {
@@ -288,6 +299,9 @@ void register_core_singletons() {
 
 void unregister_core_types() {
 
+    ResourcePayloadStreamer::get_singleton()->finish();
+    WorkerThreadPool::get_singleton()->finish();
+
     memdelete(_resource_manger);
     memdelete(_os);
     memdelete(_engine);
@@ -10,6 +10,7 @@
 #include "core/os/file_access.h"
 #include "core/script_language.h"
 #include "core/class_db.h"
+#include "core/external_profiler.h"
 #include "core/os/mutex.h"
 #include "core/os/rw_lock.h"
 #include "core/io/resource_importer.h"
@@ -508,6 +509,8 @@ void ResourceManager::get_recognized_extensions_for_type(StringView p_type, Vect
 }
 RES ResourceManager::load(StringView p_path, StringView p_type_hint, bool p_no_cache, Error* r_error) {
 
+    SCOPE_PROFILE(resource_load);
+    MemoryTagScope mem_tag(MEM_TAG_RESOURCE);
     if (r_error)
         *r_error = ERR_CANT_OPEN;
 
@@ -57,60 +57,79 @@
 
 struct StreamFile : public VariantParserStream {
 
+    enum {
+        BLOCK_SIZE = 64 * 1024
+    };
+
     FileAccess *f;
+    uint8_t *block = nullptr;
 
-    char get_char() override;
     bool is_utf8() const override;
-    bool is_eof() const override;
+    uint64_t get_position() const override;
+    bool _refill() override;
 
     StreamFile(FileAccess *fl = nullptr) : f(fl) {}
+    ~StreamFile() override {
+        if (block) {
+            memfree(block);
+        }
+    }
 };
 
 struct StreamString : public VariantParserStream {
 
     String s;
-    int pos=0;
 
-    char get_char() override;
     bool is_utf8() const override;
-    bool is_eof() const override;
+    uint64_t get_position() const override;
+    bool _refill() override;
 
-    StreamString(const String &str) : s(str) {}
-    StreamString(String &&str) noexcept : s(eastl::move(str)) {}
+    StreamString(const String &str) : s(str) { _reset(); }
+    StreamString(String &&str) noexcept : s(eastl::move(str)) { _reset(); }
+
+private:
+    void _reset() {
+        // the whole string is the window, nothing is ever copied
+        buf_pos = s.data();
+        buf_end = s.data() + s.size();
+    }
 };
 
-char StreamFile::get_char() {
+bool StreamFile::_refill() {
 
-    return f->get_8();
+    if (!block) {
+        block = (uint8_t *)memalloc(BLOCK_SIZE);
+    }
+    int read = f->get_buffer(block, BLOCK_SIZE);
+    if (read <= 0) {
+        return false;
+    }
+    buf_pos = (const char *)block;
+    buf_end = buf_pos + read;
+    return true;
 }
 
 bool StreamFile::is_utf8() const {
 
     return true;
 }
-bool StreamFile::is_eof() const {
 
-    return f->eof_reached();
+uint64_t StreamFile::get_position() const {
+
+    // data still buffered was read from the file, but not consumed yet
+    return f->get_position() - (buf_end - buf_pos);
 }
 
-char StreamString::get_char() {
-    if (pos > s.length()) {
-        return 0;
-    } else if (pos == s.length()) {
-        // You need to try to read again when you have reached the end for EOF to be reported,
-        // so this works the same as files (like StreamFile does)
-        pos++;
-        return 0;
-    } else {
-        return s[pos++];
-    }
+bool StreamString::_refill() {
+    return false;
 }
 
 bool StreamString::is_utf8() const {
     return false;
 }
-bool StreamString::is_eof() const {
-    return pos > s.length();
+
+uint64_t StreamString::get_position() const {
+    return buf_pos - s.data();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -135,6 +154,117 @@ const char *VariantParser::tk_name[TK_MAX] = {
     "ERROR"
 };
 
+namespace {
+
+struct ScannedNumber {
+    double real;
+    int64_t integer;
+    bool is_float;
+};
+
+// Exactly representable powers of ten, used by the fast float path.
+const double vp_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Scans a number starting with p_first directly from the stream, the first character after it is left in
+ * p_stream->saved. Accepts the same syntax as before: [-]digits[.digits][e[+-]digits].
+ *
+ * The value is accumulated while scanning; when the mantissa fits in 53 bits and the decimal exponent is
+ * within +-22 the result is exact with a single multiplication or division (Clinger's fast path), otherwise
+ * the scanned text is handed to StringUtils::to_double. Integers that don't fit in int64 are read as floats.
+ */
+void _scan_number(VariantParserStream *p_stream, char p_first, ScannedNumber &r_number) {
+
+    eastl::fixed_string<char, 64, true> text;
+    char c = p_first;
+    bool negative = false;
+    if (c == '-') {
+        negative = true;
+        text.push_back(c);
+        c = p_stream->get_char();
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool truncated = false;
+    bool is_float = false;
+
+    while (c >= '0' && c <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (c - '0');
+            digits += mantissa != 0;
+        } else {
+            truncated = true;
+        }
+        text.push_back(c);
+        c = p_stream->get_char();
+    }
+    if (c == '.') {
+        is_float = true;
+        text.push_back(c);
+        c = p_stream->get_char();
+        while (c >= '0' && c <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (c - '0');
+                digits += mantissa != 0;
+                exp10--;
+            } else {
+                truncated = true;
+            }
+            text.push_back(c);
+            c = p_stream->get_char();
+        }
+    }
+    if (c == 'e') {
+        is_float = true;
+        text.push_back(c);
+        c = p_stream->get_char();
+        bool exp_negative = false;
+        if (c == '-' || c == '+') {
+            exp_negative = c == '-';
+            text.push_back(c);
+            c = p_stream->get_char();
+        }
+        int exp_value = 0;
+        while (c >= '0' && c <= '9') {
+            if (exp_value < 100000) {
+                exp_value = exp_value * 10 + (c - '0');
+            }
+            text.push_back(c);
+            c = p_stream->get_char();
+        }
+        exp10 += exp_negative ? -exp_value : exp_value;
+    }
+
+    p_stream->saved = c;
+
+    if (!is_float) {
+        // Integers outside of the int64 range are read as floats.
+        const uint64_t limit = negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX);
+        if (!truncated && mantissa <= limit) {
+            r_number.is_float = false;
+            r_number.integer = negative ? int64_t(0 - mantissa) : int64_t(mantissa);
+            return;
+        }
+    }
+    r_number.is_float = true;
+
+    if (!truncated && mantissa <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        double v = double(mantissa);
+        v = exp10 < 0 ? v / vp_pow10[-exp10] : v * vp_pow10[exp10];
+        r_number.real = negative ? -v : v;
+    } else {
+        // Not strtod, which follows the process locale.
+        r_number.real = StringUtils::to_double(StringView(text.data(), text.size()));
+    }
+}
+
+} // namespace
+
 Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, int &line, String &r_err_str) {
     bool string_name = false;
     eastl::fixed_string<char, 128, true> tmp_str_buf; // static variable to prevent constat alloc/dealloc
@@ -265,6 +395,17 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
                 String str;
                 while (true) {
 
+                    // append runs of plain characters straight from the stream window
+                    const char *run = p_stream->buf_pos;
+                    const char *run_end = run;
+                    while (run_end < p_stream->buf_end && *run_end != '"' && *run_end != '\\' && *run_end != '\n' && *run_end != 0) {
+                        ++run_end;
+                    }
+                    if (run_end != run) {
+                        str.append(run, run_end);
+                        p_stream->buf_pos = run_end;
+                    }
+
                     char ch = p_stream->get_char();
 
                     if (ch == 0) {
@@ -357,82 +498,15 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
 
                 if (cchar == '-' || (cchar >= '0' && cchar <= '9')) {
                     //a number
-
-                    tmp_str_buf="";
-#define READING_SIGN 0
-#define READING_INT 1
-#define READING_DEC 2
-#define READING_EXP 3
-#define READING_DONE 4
-                    int reading = READING_INT;
-
-                    if (cchar == '-') {
-                        tmp_str_buf += '-';
-                        cchar = p_stream->get_char();
-                    }
-
-                    char c = cchar;
-                    bool exp_sign = false;
-                    bool exp_beg = false;
-                    bool is_float = false;
-
-                    while (true) {
-
-                        switch (reading) {
-                            case READING_INT: {
-
-                                if (c >= '0' && c <= '9') {
-                                    //pass
-                                } else if (c == '.') {
-                                    reading = READING_DEC;
-                                    is_float = true;
-                                } else if (c == 'e') {
-                                    reading = READING_EXP;
-                                    is_float = true;
-                                } else {
-                                    reading = READING_DONE;
-                                }
-
-                            } break;
-                            case READING_DEC: {
-
-                                if (c >= '0' && c <= '9') {
-
-                                } else if (c == 'e') {
-                                    reading = READING_EXP;
-                                } else {
-                                    reading = READING_DONE;
-                                }
-
-                            } break;
-                            case READING_EXP: {
-
-                                if (c >= '0' && c <= '9') {
-                                    exp_beg = true;
-
-                                } else if ((c == '-' || c == '+') && !exp_sign && !exp_beg) {
-                                    exp_sign = true;
-
-                                } else {
-                                    reading = READING_DONE;
-                                }
-                            } break;
-                        }
-
-                        if (reading == READING_DONE)
-                            break;
-                        tmp_str_buf.push_back(c);
-                        c = p_stream->get_char();
-                    }
-
-                    p_stream->saved = c;
+                    ScannedNumber number;
+                    _scan_number(p_stream, cchar, number);
 
                     r_token.type = TK_NUMBER;
 
-                    if (is_float)
-                        r_token.value = StringUtils::to_double(tmp_str_buf);
+                    if (number.is_float)
+                        r_token.value = number.real;
                     else
-                        r_token.value = StringUtils::to_int(tmp_str_buf);
+                        r_token.value = number.integer;
                     return OK;
 
                 } else if ((cchar >= 'A' && cchar <= 'Z') || (cchar >= 'a' && cchar <= 'z') || cchar == '_') {
@@ -465,12 +539,48 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
     return ERR_PARSE_ERROR;
 }
 
-template <class T>
-Error VariantParser::_parse_construct(VariantParserStream *p_stream, Vector<T> &r_construct, int &line, String &r_err_str) {
+namespace {
 
-    Token token;
-    get_token(p_stream, token, line, r_err_str);
-    if (token.type != TK_PARENTHESIS_OPEN) {
+// Returns the next character that is not blank or part of a comment, 0 at the end of data.
+char _next_significant_char(VariantParserStream *p_stream, int &line) {
+
+    while (true) {
+        char c;
+        if (p_stream->saved) {
+            c = p_stream->saved;
+            p_stream->saved = 0;
+        } else {
+            c = p_stream->get_char();
+            if (p_stream->is_eof()) {
+                return 0;
+            }
+        }
+
+        if (c == '\n') {
+            line++;
+        } else if (c == ';') {
+            while (true) {
+                char ch = p_stream->get_char();
+                if (p_stream->is_eof()) {
+                    return 0;
+                }
+                if (ch == '\n')
+                    break;
+            }
+        } else if (c == 0 || c > 32) {
+            return c;
+        }
+    }
+}
+
+/**
+ * Parses a parenthesized, comma separated list of numbers directly from the stream, without going through
+ * tokens and Variants. Every number is passed to p_sink.
+ */
+template <class Sink>
+Error _parse_number_list(VariantParserStream *p_stream, int &line, String &r_err_str, Sink &&p_sink) {
+
+    if (_next_significant_char(p_stream, line) != '(') {
         r_err_str = "Expected '(' in constructor";
         return ERR_PARSE_ERROR;
     }
@@ -478,34 +588,81 @@ Error VariantParser::_parse_construct(VariantParserStream *p_stream, Vector<T> &
     bool first = true;
     while (true) {
 
+        char c = _next_significant_char(p_stream, line);
         if (!first) {
-            get_token(p_stream, token, line, r_err_str);
-            if (token.type == TK_COMMA) {
-                //do none
-            } else if (token.type == TK_PARENTHESIS_CLOSE) {
+            if (c == ',') {
+                c = _next_significant_char(p_stream, line);
+            } else if (c == ')') {
                 break;
             } else {
                 r_err_str = "Expected ',' or ')' in constructor";
                 return ERR_PARSE_ERROR;
             }
         }
-        get_token(p_stream, token, line, r_err_str);
 
-        if (first && token.type == TK_PARENTHESIS_CLOSE) {
+        if (first && c == ')') {
             break;
         }
-        if (token.type != TK_NUMBER) {
+        if (c != '-' && (c < '0' || c > '9')) {
             r_err_str = "Expected float in constructor";
             return ERR_PARSE_ERROR;
         }
 
-        r_construct.push_back(token.value.as<T>());
+        ScannedNumber number;
+        _scan_number(p_stream, c, number);
+        p_sink(number);
         first = false;
     }
 
     return OK;
 }
 
+template <class T>
+_FORCE_INLINE_ T _number_as(const ScannedNumber &p_number) {
+    return p_number.is_float ? T(p_number.real) : T(p_number.integer);
+}
+
+} // namespace
+
+template <class T>
+Error VariantParser::_parse_construct(VariantParserStream *p_stream, Vector<T> &r_construct, int &line, String &r_err_str) {
+
+    return _parse_number_list(p_stream, line, r_err_str, [&r_construct](const ScannedNumber &p_number) {
+        r_construct.push_back(_number_as<T>(p_number));
+    });
+}
+
+// Parses Pool*Array constructors straight into the array storage, each element of T is made of N components of type C.
+template <class T, class C, int N>
+Error VariantParser::_parse_typed_array(VariantParserStream *p_stream, PoolVector<T> &r_array, int &line, String &r_err_str) {
+
+    static_assert(sizeof(T) == sizeof(C) * N, "Array element must be tightly packed components");
+
+    int capacity = 0;
+    int components = 0;
+    C *dst = nullptr;
+    typename PoolVector<T>::Write w;
+
+    Error err = _parse_number_list(p_stream, line, r_err_str, [&](const ScannedNumber &p_number) {
+        if (components == capacity * N) {
+            w.release();
+            capacity = M_MAX(capacity * 2, 64);
+            r_array.resize(capacity);
+            w = r_array.write();
+            dst = reinterpret_cast<C *>(w.ptr());
+        }
+        dst[components++] = _number_as<C>(p_number);
+    });
+    w.release();
+    if (err != OK) {
+        return err;
+    }
+
+    // incomplete trailing elements are dropped, as they always were
+    r_array.resize(components / N);
+    return OK;
+}
+
 Error VariantParser::parse_value(Token &token, Variant &value, VariantParserStream *p_stream, int &line, String &r_err_str, ResourceParser *p_res_parser) {
     using namespace eastl; // for _sv suffix
     /*	{
@@ -918,21 +1075,10 @@ Error VariantParser::parse_value(Token &token, Variant &value, VariantParserStre
             }
         } else if (id == "PoolByteArray" || id == "ByteArray") {
 
-            Vector<uint8_t> args;
-            Error err = _parse_construct<uint8_t>(p_stream, args, line, r_err_str);
-			if (err) {
-                return err;
-			}
-
             PoolVector<uint8_t> arr;
-            {
-                int len = args.size();
-                arr.resize(len);
-                PoolVector<uint8_t>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = args[i];
-                }
-            }
+            Error err = _parse_typed_array<uint8_t, uint8_t, 1>(p_stream, arr, line, r_err_str);
+            if (err)
+                return err;
 
             value = arr;
 
@@ -940,42 +1086,22 @@ Error VariantParser::parse_value(Token &token, Variant &value, VariantParserStre
 
         } else if (id == "PoolIntArray" || id == "IntArray") {
 
-            Vector<int> args;
-            Error err = _parse_construct<int>(p_stream, args, line, r_err_str);
+            PoolVector<int> arr;
+            Error err = _parse_typed_array<int, int, 1>(p_stream, arr, line, r_err_str);
             if (err)
                 return err;
 
-            PoolVector<int> arr;
-            {
-                int len = args.size();
-                arr.resize(len);
-                PoolVector<int>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = int(args[i]);
-                }
-            }
-
             value = arr;
 
             return OK;
 
         } else if (id == "PoolRealArray" || id == "FloatArray") {
 
-            Vector<float> args;
-            Error err = _parse_construct<float>(p_stream, args, line, r_err_str);
+            PoolVector<float> arr;
+            Error err = _parse_typed_array<float, float, 1>(p_stream, arr, line, r_err_str);
             if (err)
                 return err;
 
-            PoolVector<float> arr;
-            {
-                int len = args.size();
-                arr.resize(len);
-                PoolVector<float>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = args[i];
-                }
-            }
-
             value = arr;
 
             return OK;
@@ -1032,63 +1158,33 @@ Error VariantParser::parse_value(Token &token, Variant &value, VariantParserStre
 
         } else if (id == StringView("PoolVector2Array") || id == "Vector2Array") {
 
-            Vector<float> args;
-            Error err = _parse_construct<float>(p_stream, args, line, r_err_str);
+            PoolVector<Vector2> arr;
+            Error err = _parse_typed_array<Vector2, real_t, 2>(p_stream, arr, line, r_err_str);
             if (err)
                 return err;
 
-            PoolVector<Vector2> arr;
-            {
-                int len = args.size() / 2;
-                arr.resize(len);
-                PoolVector<Vector2>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = Vector2(args[i * 2 + 0], args[i * 2 + 1]);
-                }
-            }
-
             value = Variant(arr);
 
             return OK;
 
         } else if (id == "PoolVector3Array" || id == "Vector3Array") {
 
-            Vector<float> args;
-            Error err = _parse_construct<float>(p_stream, args, line, r_err_str);
+            PoolVector<Vector3> arr;
+            Error err = _parse_typed_array<Vector3, real_t, 3>(p_stream, arr, line, r_err_str);
             if (err)
                 return err;
 
-            PoolVector<Vector3> arr;
-            {
-                int len = args.size() / 3;
-                arr.resize(len);
-                PoolVector<Vector3>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = Vector3(args[i * 3 + 0], args[i * 3 + 1], args[i * 3 + 2]);
-                }
-            }
-
             value = arr;
 
             return OK;
 
         } else if (id == "PoolColorArray" || id == "ColorArray") {
 
-            Vector<float> args;
-            Error err = _parse_construct<float>(p_stream, args, line, r_err_str);
+            PoolVector<Color> arr;
+            Error err = _parse_typed_array<Color, float, 4>(p_stream, arr, line, r_err_str);
             if (err)
                 return err;
 
-            PoolVector<Color> arr;
-            {
-                int len = args.size() / 4;
-                arr.resize(len);
-                PoolVector<Color>::Write w = arr.write();
-                for (int i = 0; i < len; i++) {
-                    w[i] = Color(args[i * 4 + 0], args[i * 4 + 1], args[i * 4 + 2], args[i * 4 + 3]);
-                }
-            }
-
             value = arr;
 
             return OK;
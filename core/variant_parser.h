@@ -38,14 +38,41 @@
 
 struct VariantParserStream {
 
-    virtual char get_char() = 0;
+    // Characters are served from the window [buf_pos, buf_end), derived streams refill it in large blocks, so
+    // reading a character doesn't need a virtual call.
+    const char *buf_pos = nullptr;
+    const char *buf_end = nullptr;
+    bool eof = false;
+
+    _FORCE_INLINE_ char get_char() {
+        if (likely(buf_pos < buf_end)) {
+            return *buf_pos++;
+        }
+        return _get_char_slow();
+    }
+    //! True after an attempt was made to read past the end of data.
+    bool is_eof() const { return eof; }
     virtual bool is_utf8() const = 0;
-    virtual bool is_eof() const = 0;
+    //! Position of the next character that will be read from the underlying data.
+    virtual uint64_t get_position() const = 0;
 
     char saved = 0;
 
     VariantParserStream() {}
     virtual ~VariantParserStream() {}
+
+protected:
+    //! Makes more data available in the window, returns false at the end of data.
+    virtual bool _refill() = 0;
+
+private:
+    char _get_char_slow() {
+        if (eof || !_refill()) {
+            eof = true;
+            return 0;
+        }
+        return *buf_pos++;
+    }
 };
 
 class GODOT_EXPORT VariantParser {
@@ -107,6 +134,8 @@ private:
 
     template <class T>
     static Error _parse_construct(VariantParserStream *p_stream, Vector<T> &r_construct, int &line, String &r_err_str);
+    template <class T, class C, int N>
+    static Error _parse_typed_array(VariantParserStream *p_stream, PoolVector<T> &r_array, int &line, String &r_err_str);
 
     static Error _parse_dictionary(Dictionary &object, VariantParserStream *p_stream, int &line, String &r_err_str, ResourceParser *p_res_parser = nullptr);
     static Error _parse_array(Array &array, VariantParserStream *p_stream, int &line, String &r_err_str, ResourceParser *p_res_parser = nullptr);
@@ -35,6 +35,7 @@
 #include "core/self_list.h"
 #include "scene/resources/mesh.h"
 #include "servers/rendering/rasterizer.h"
+#include "servers/rendering/texture_streaming_dummy.h"
 #include "servers/rendering_server.h"
 
 class RasterizerSceneDummy : public RasterizerScene {
@@ -140,6 +141,8 @@ public:
         AABB aabb;
         Vector<PoolVector<uint8_t> > blend_shapes;
         Vector<AABB> bone_aabbs;
+        Vector<float> lod_errors;
+        Vector<PoolVector<uint8_t> > lod_index_arrays;
     };
 
     struct DummyMesh : public RID_Data {
@@ -161,6 +164,7 @@ public:
     void texture_allocate(RID p_texture, int p_width, int p_height, int p_depth_3d, Image::Format p_format, RenderingServer::TextureType p_type = RS::TEXTURE_TYPE_2D, uint32_t p_flags = RS::TEXTURE_FLAGS_DEFAULT) {
         DummyTexture *t = texture_owner.getornull(p_texture);
         ERR_FAIL_COND(!t);
+        texture_streamer.remove(p_texture);
         t->width = p_width;
         t->height = p_height;
         t->flags = p_flags;
@@ -230,6 +234,19 @@ public:
         return t->path;
     }
 
+    TextureStreamingBackendDummy texture_streaming_backend;
+    TextureStreamer texture_streamer { &texture_streaming_backend };
+    uint64_t frame = 0;
+
+    void texture_set_mip_streaming(RID p_texture, StringView p_path) {
+        ERR_FAIL_COND(!texture_owner.owns(p_texture));
+        if (p_path.empty()) {
+            texture_streamer.remove(p_texture);
+            return;
+        }
+        texture_streamer.add(p_texture, p_path);
+    }
+
     void texture_set_shrink_all_x2_on_set_data(bool p_enable) {}
 
     void texture_debug_usage(List<RS::TextureInfo> *r_info) {}
@@ -249,7 +266,7 @@ public:
     /* SKY API */
 
     RID sky_create() { return RID(); }
-    void sky_set_texture(RID p_sky, RID p_cube_map, int p_radiance_size) {}
+    void sky_set_texture(RID p_sky, RID p_cube_map, int p_radiance_size) { texture_streamer.load_full(p_cube_map); }
 
     /* SHADER API */
 
@@ -345,12 +362,14 @@ public:
     int mesh_surface_get_array_len(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, 0)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), 0);
 
         return m->surfaces[p_surface].vertex_count;
     }
     int mesh_surface_get_array_index_len(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, 0)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), 0);
 
         return m->surfaces[p_surface].index_count;
     }
@@ -358,12 +377,14 @@ public:
     PoolVector<uint8_t> mesh_surface_get_array(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, PoolVector<uint8_t>())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), PoolVector<uint8_t>());
 
         return m->surfaces[p_surface].array;
     }
     PoolVector<uint8_t> mesh_surface_get_index_array(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, PoolVector<uint8_t>())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), PoolVector<uint8_t>());
 
         return m->surfaces[p_surface].index_array;
     }
@@ -371,12 +392,14 @@ public:
     uint32_t mesh_surface_get_format(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, 0)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), 0);
 
         return m->surfaces[p_surface].format;
     }
     RS::PrimitiveType mesh_surface_get_primitive_type(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, RS::PRIMITIVE_POINTS)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), RS::PRIMITIVE_POINTS);
 
         return m->surfaces[p_surface].primitive;
     }
@@ -384,22 +407,58 @@ public:
     AABB mesh_surface_get_aabb(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, AABB())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), AABB());
 
         return m->surfaces[p_surface].aabb;
     }
     Vector<PoolVector<uint8_t> > mesh_surface_get_blend_shapes(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, Vector<PoolVector<uint8_t> >())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), Vector<PoolVector<uint8_t> >());
 
         return m->surfaces[p_surface].blend_shapes;
     }
     Vector<AABB> mesh_surface_get_skeleton_aabb(RID p_mesh, int p_surface) const {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND_V(!m, Vector<AABB>())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), Vector<AABB>());
 
         return m->surfaces[p_surface].bone_aabbs;
     }
 
+    void mesh_surface_set_lods(RID p_mesh, int p_surface, const Vector<float> &p_lod_errors, const Vector<PoolVector<uint8_t> > &p_lod_index_arrays) {
+        DummyMesh *m = mesh_owner.getornull(p_mesh);
+        ERR_FAIL_COND(!m);
+        ERR_FAIL_INDEX(p_surface, m->surfaces.size());
+        ERR_FAIL_COND(p_lod_errors.size() != p_lod_index_arrays.size());
+
+        m->surfaces[p_surface].lod_errors = p_lod_errors;
+        m->surfaces[p_surface].lod_index_arrays = p_lod_index_arrays;
+    }
+    int mesh_surface_get_lod_count(RID p_mesh, int p_surface) const {
+        DummyMesh *m = mesh_owner.getornull(p_mesh);
+        ERR_FAIL_COND_V(!m, 0)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), 0);
+
+        return m->surfaces[p_surface].lod_errors.size();
+    }
+    float mesh_surface_get_lod_error(RID p_mesh, int p_surface, int p_lod) const {
+        DummyMesh *m = mesh_owner.getornull(p_mesh);
+        ERR_FAIL_COND_V(!m, 0)
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), 0);
+        ERR_FAIL_INDEX_V(p_lod, m->surfaces[p_surface].lod_errors.size(), 0);
+
+        return m->surfaces[p_surface].lod_errors[p_lod];
+    }
+    PoolVector<uint8_t> mesh_surface_get_lod_index_array(RID p_mesh, int p_surface, int p_lod) const {
+        DummyMesh *m = mesh_owner.getornull(p_mesh);
+        ERR_FAIL_COND_V(!m, PoolVector<uint8_t>())
+        ERR_FAIL_INDEX_V(p_surface, m->surfaces.size(), PoolVector<uint8_t>());
+        ERR_FAIL_INDEX_V(p_lod, m->surfaces[p_surface].lod_index_arrays.size(), PoolVector<uint8_t>());
+
+        return m->surfaces[p_surface].lod_index_arrays[p_lod];
+    }
+
     void mesh_remove_surface(RID p_mesh, int p_index) {
         DummyMesh *m = mesh_owner.getornull(p_mesh);
         ERR_FAIL_COND(!m);
@@ -730,6 +789,8 @@ public:
         if (texture_owner.owns(p_rid)) {
             // delete the texture
             DummyTexture *texture = texture_owner.get(p_rid);
+            texture_streamer.remove(p_rid);
+            texture_streaming_backend.forget(p_rid);
             texture_owner.free(p_rid);
             memdelete(texture);
         }
@@ -738,7 +799,7 @@ public:
 
     bool has_os_feature(const String &p_feature) const { return false; }
 
-    void update_dirty_resources() {}
+    void update_dirty_resources() { texture_streamer.update(++frame); }
 
     void set_debug_generate_wireframes(bool p_generate) {}
 
@@ -199,6 +199,8 @@ RasterizerStorageGLES3::Texture *RasterizerCanvasGLES3::_bind_canvas_texture(con
         tex_return = state.current_tex_ptr;
     } else if (p_texture.is_valid()) {
 
+        // canvas items have no screen size to pick a level from, streamed textures get full detail
+        storage->texture_streamer.request(p_texture, -1);
         RasterizerStorageGLES3::Texture *texture = storage->texture_owner.getornull(p_texture);
 
         if (!texture) {
@@ -240,6 +242,7 @@ RasterizerStorageGLES3::Texture *RasterizerCanvasGLES3::_bind_canvas_texture(con
 
     } else if (p_normal_map.is_valid()) {
 
+        storage->texture_streamer.request(p_normal_map, -1);
         RasterizerStorageGLES3::Texture *normal_map = storage->texture_owner.getornull(p_normal_map);
 
         if (!normal_map) {
@@ -1450,6 +1453,7 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
 
                     glActiveTexture(GL_TEXTURE2 + i);
 
+                    storage->texture_streamer.request(textures[i], -1);
                     RasterizerStorageGLES3::Texture *t = storage->texture_owner.getornull(textures[i]);
                     if (!t) {
 
@@ -1684,6 +1688,7 @@ void RasterizerCanvasGLES3::canvas_render_items(Item *p_item_list, int p_z, cons
                     }
 
                     glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 1);
+                    storage->texture_streamer.request(light->texture, -1);
                     RasterizerStorageGLES3::Texture *t = storage->texture_owner.getornull(light->texture);
                     if (!t) {
                         glBindTexture(GL_TEXTURE_2D, storage->resources.white_tex);
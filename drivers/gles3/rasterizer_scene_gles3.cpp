@@ -1481,9 +1481,19 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 #endif
                     if (s->index_array_len > 0) {
 
-                glDrawElements(gl_primitive[s->primitive], s->index_array_len, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, nullptr);
+                // levels are sorted from finest to coarsest, draw the coarsest one that is still accurate enough
+                int index_count = s->index_array_len;
+                uintptr_t byte_offset = 0;
+                for (const RasterizerStorageGLES3::Surface::LOD &lod : s->lods) {
+                    if (lod.error > e->instance->lod_max_error)
+                        break;
+                    index_count = lod.index_count;
+                    byte_offset = lod.byte_offset;
+                }
 
-                storage->info.render.vertices_count += s->index_array_len;
+                glDrawElements(gl_primitive[s->primitive], index_count, (s->array_len >= (1 << 16)) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, (const void *)byte_offset);
+
+                storage->info.render.vertices_count += index_count;
 
             } else {
 
@@ -1550,6 +1560,7 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 
                 if (c.texture.is_valid() && storage->texture_owner.owns(c.texture)) {
 
+                    storage->texture_streamer.request(c.texture, -1);
                     RasterizerStorageGLES3::Texture *t = storage->texture_owner.get(c.texture);
 
                     if (t->redraw_if_visible) {
@@ -2248,6 +2259,12 @@ void RasterizerSceneGLES3::_add_geometry(RasterizerStorageGLES3::Geometry *p_geo
 
 void RasterizerSceneGLES3::_add_geometry_with_material(RasterizerStorageGLES3::Geometry *p_geometry, InstanceBase *p_instance, RasterizerStorageGLES3::GeometryOwner *p_owner, RasterizerStorageGLES3::Material *p_material, bool p_depth_pass, bool p_shadow_pass) {
 
+    if (!p_depth_pass) {
+        for (const RID &texture : p_material->textures) {
+            storage->texture_streamer.request(texture, state.stream_screen_size);
+        }
+    }
+
     bool has_base_alpha = (p_material->shader->spatial.uses_alpha && !p_material->shader->spatial.uses_alpha_scissor) || p_material->shader->spatial.uses_screen_texture || p_material->shader->spatial.uses_depth_texture;
     bool has_blend_alpha = p_material->shader->spatial.blend_mode != RasterizerStorageGLES3::Shader::Node3D::BLEND_MODE_MIX;
     bool has_alpha = has_base_alpha || has_blend_alpha;
@@ -2383,6 +2400,7 @@ void RasterizerSceneGLES3::_draw_sky(RasterizerStorageGLES3::Sky *p_sky, const C
 
     ERR_FAIL_COND(!p_sky);
 
+    storage->texture_streamer.request(p_sky->panorama, -1);
     RasterizerStorageGLES3::Texture *tex = storage->texture_owner.getornull(p_sky->panorama);
 
     ERR_FAIL_COND(!tex);
@@ -3074,9 +3092,14 @@ void RasterizerSceneGLES3::_fill_render_list(InstanceBase **p_cull_result, int p
 
     //fill list
 
+    const bool report_mips = !p_depth_pass && storage->texture_streamer.get_texture_count() > 0;
+
     for (int i = 0; i < p_cull_count; i++) {
 
         InstanceBase *inst = p_cull_result[i];
+        if (report_mips) {
+            state.stream_screen_size = _get_stream_screen_size(inst);
+        }
         switch (inst->base_type) {
 
             case RS::INSTANCE_MESH: {
@@ -3155,6 +3178,23 @@ void RasterizerSceneGLES3::_fill_render_list(InstanceBase **p_cull_result, int p
     }
 }
 
+float RasterizerSceneGLES3::_get_stream_screen_size(InstanceBase *p_instance) const {
+
+    AABB aabb;
+    switch (p_instance->base_type) {
+        case RS::INSTANCE_MESH: {
+            aabb = storage->mesh_get_aabb(p_instance->base, p_instance->skeleton);
+        } break;
+        case RS::INSTANCE_MULTIMESH: {
+            aabb = storage->multimesh_get_aabb(p_instance->base);
+        } break;
+        default: {
+            return -1; // no useful bounds, ask for full detail
+        }
+    }
+    return state.stream_view.get_screen_size(p_instance->transform.xform(aabb));
+}
+
 void RasterizerSceneGLES3::_blur_effect_buffer() {
 
     //blur diffuse into effect mipmaps using separatable convolution
@@ -3964,6 +4004,7 @@ void RasterizerSceneGLES3::_post_process(Environment *env, const CameraMatrix &p
     if (env->adjustments_enabled) {
 
         state.tonemap_shader.set_conditional(TonemapShaderGLES3::USE_BCS, true);
+        storage->texture_streamer.request(env->color_correction, -1);
         RasterizerStorageGLES3::Texture *tex = storage->texture_owner.getornull(env->color_correction);
         if (tex) {
             state.tonemap_shader.set_conditional(TonemapShaderGLES3::USE_COLOR_CORRECTION, true);
@@ -4153,6 +4194,7 @@ void RasterizerSceneGLES3::render_scene(const Transform &p_cam_transform, const
 
     bool use_mrt = false;
 
+    state.stream_view.setup(p_cam_transform, p_cam_projection, storage->frame.current_rt->height);
     render_list.clear();
     _fill_render_list(p_cull_result, p_cull_count, false, false);
     //
@@ -4917,6 +4959,7 @@ void RasterizerSceneGLES3::set_debug_draw_mode(RS::ViewportDebugDraw p_debug_dra
 void RasterizerSceneGLES3::initialize() {
 
     render_pass = 0;
+    state.stream_screen_size = -1;
 
     state.scene_shader.init();
 
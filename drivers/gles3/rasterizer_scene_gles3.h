@@ -210,6 +210,10 @@ public:
         bool prepared_depth_texture;
         bool bound_depth_texture;
 
+        // camera of the scene being rendered, used to report the mip levels streamed textures need
+        TextureStreamingView stream_view;
+        float stream_screen_size;
+
         RS::ViewportDebugDraw debug_draw;
     } state;
 
@@ -766,6 +770,7 @@ public:
     void _copy_texture_to_front_buffer(GLuint p_texture); //used for debug
 
     void _fill_render_list(InstanceBase **p_cull_result, int p_cull_count, bool p_depth_pass, bool p_shadow_pass);
+    float _get_stream_screen_size(InstanceBase *p_instance) const;
 
     void _blur_effect_buffer();
     void _render_mrts(Environment *env, const CameraMatrix &p_cam_projection);
@@ -36,6 +36,7 @@
 #include "core/engine.h"
 #include "core/project_settings.h"
 #include "core/string_utils.h"
+#include "servers/rendering/shader_cache.h"
 #include "glad/glad.h"
 
 /* TEXTURE API */
@@ -588,6 +589,7 @@ void RasterizerStorageGLES3::texture_allocate(RID p_texture, int p_width, int p_
 
     Texture *texture = texture_owner.get(p_texture);
     ERR_FAIL_COND(!texture);
+    texture_streamer.remove(p_texture);
     texture->width = p_width;
     texture->height = p_height;
     texture->depth = p_depth_3d;
@@ -1388,6 +1390,34 @@ const String &RasterizerStorageGLES3::texture_get_path(RID p_texture) const {
     ERR_FAIL_COND_V(!texture, null_string);
     return texture->path;
 }
+
+void RasterizerStorageGLES3::texture_set_mip_streaming(RID p_texture, StringView p_path) {
+
+    Texture *texture = texture_owner.get(p_texture);
+    ERR_FAIL_COND(!texture);
+    ERR_FAIL_COND(!texture->active || texture->type != RS::TEXTURE_TYPE_2D);
+
+    if (p_path.empty()) {
+        texture_streamer.remove(p_texture);
+        return;
+    }
+    Error err = texture_streamer.add(p_texture, p_path);
+    ERR_FAIL_COND_MSG(err != OK, "Can't stream the mipmaps of texture: " + String(p_path) + ".");
+}
+
+void RasterizerStorageGLES3::_texture_stream_apply(RID p_texture, int p_base_mip, const Ref<Image> &p_mips) {
+
+    Texture *texture = texture_owner.get(p_texture);
+    ERR_FAIL_COND(!texture);
+
+    // a new texture object makes the driver release the levels that were dropped, width and height keep the
+    // full size so sampling and size queries don't change
+    glDeleteTextures(1, &texture->tex_id);
+    glGenTextures(1, &texture->tex_id);
+    texture->alloc_width = p_mips->get_width();
+    texture->alloc_height = p_mips->get_height();
+    texture_set_data(p_texture, p_mips);
+}
 void RasterizerStorageGLES3::texture_debug_usage(Vector<RenderingServer::TextureInfo> *r_info) {
 
     List<RID> textures;
@@ -1650,6 +1680,9 @@ void RasterizerStorageGLES3::sky_set_texture(RID p_sky, RID p_panorama, int p_ra
     if (!sky->panorama.is_valid())
         return; //cleared
 
+    // the radiance maps are baked from the panorama once, so it needs all its levels now
+    texture_streamer.load_full(p_panorama);
+
     Texture *texture = texture_owner.getornull(sky->panorama);
     if (!texture) {
         sky->panorama = RID();
@@ -3932,6 +3965,98 @@ const Vector<AABB> &RasterizerStorageGLES3::mesh_surface_get_skeleton_aabb(RID p
     return mesh->surfaces[p_surface]->skeleton_bone_aabb;
 }
 
+void RasterizerStorageGLES3::mesh_surface_set_lods(RID p_mesh, int p_surface, const Vector<float> &p_lod_errors, const Vector<PoolVector<uint8_t>> &p_lod_index_arrays) {
+
+    Mesh *mesh = mesh_owner.getornull(p_mesh);
+    ERR_FAIL_COND(!mesh);
+    ERR_FAIL_INDEX(p_surface, mesh->surfaces.size());
+    ERR_FAIL_COND(p_lod_errors.size() != p_lod_index_arrays.size());
+
+    Surface *surface = mesh->surfaces[p_surface];
+    ERR_FAIL_COND_MSG(!surface->index_id, "LODs require an indexed surface.");
+
+    const int index_size = surface->array_len >= (1 << 16) ? 4 : 2;
+    uint32_t total_size = surface->index_array_byte_size;
+    Vector<Surface::LOD> lods;
+    lods.reserve(p_lod_errors.size());
+    for (size_t i = 0; i < p_lod_errors.size(); i++) {
+        ERR_FAIL_COND(p_lod_index_arrays[i].size() % index_size != 0);
+        lods.push_back({ p_lod_errors[i], int(p_lod_index_arrays[i].size() / index_size), total_size });
+        total_size += p_lod_index_arrays[i].size();
+    }
+
+    // the levels are appended to the existing index buffer, keeping its name means the vertex arrays that
+    // reference it stay valid
+    glBindVertexArray(0);
+    GLuint base_copy;
+    glGenBuffers(1, &base_copy);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, base_copy);
+    glBufferData(GL_COPY_WRITE_BUFFER, surface->index_array_byte_size, nullptr, GL_STREAM_COPY);
+    glBindBuffer(GL_COPY_READ_BUFFER, surface->index_id);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, surface->index_array_byte_size);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, surface->index_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, total_size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, base_copy);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, surface->index_array_byte_size);
+    for (size_t i = 0; i < lods.size(); i++) {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, lods[i].byte_offset, p_lod_index_arrays[i].size(), p_lod_index_arrays[i].read().ptr());
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &base_copy);
+
+    const int old_lod_size = surface->lods.empty() ? 0 : surface->lods.back().byte_offset + surface->lods.back().index_count * index_size - surface->index_array_byte_size;
+    const int size_change = int(total_size) - surface->index_array_byte_size - old_lod_size;
+    surface->total_data_size += size_change;
+    info.vertex_mem += size_change;
+    surface->lods = eastl::move(lods);
+}
+
+int RasterizerStorageGLES3::mesh_surface_get_lod_count(RID p_mesh, int p_surface) const {
+
+    const Mesh *mesh = mesh_owner.getornull(p_mesh);
+    ERR_FAIL_COND_V(!mesh, 0);
+    ERR_FAIL_INDEX_V(p_surface, mesh->surfaces.size(), 0);
+
+    return mesh->surfaces[p_surface]->lods.size();
+}
+
+float RasterizerStorageGLES3::mesh_surface_get_lod_error(RID p_mesh, int p_surface, int p_lod) const {
+
+    const Mesh *mesh = mesh_owner.getornull(p_mesh);
+    ERR_FAIL_COND_V(!mesh, 0);
+    ERR_FAIL_INDEX_V(p_surface, mesh->surfaces.size(), 0);
+    ERR_FAIL_INDEX_V(p_lod, mesh->surfaces[p_surface]->lods.size(), 0);
+
+    return mesh->surfaces[p_surface]->lods[p_lod].error;
+}
+
+PoolVector<uint8_t> RasterizerStorageGLES3::mesh_surface_get_lod_index_array(RID p_mesh, int p_surface, int p_lod) const {
+
+    const Mesh *mesh = mesh_owner.getornull(p_mesh);
+    ERR_FAIL_COND_V(!mesh, PoolVector<uint8_t>());
+    ERR_FAIL_INDEX_V(p_surface, mesh->surfaces.size(), PoolVector<uint8_t>());
+    const Surface *surface = mesh->surfaces[p_surface];
+    ERR_FAIL_INDEX_V(p_lod, surface->lods.size(), PoolVector<uint8_t>());
+
+    const Surface::LOD &lod = surface->lods[p_lod];
+    const int byte_size = lod.index_count * (surface->array_len >= (1 << 16) ? 4 : 2);
+
+    PoolVector<uint8_t> ret;
+    ret.resize(byte_size);
+    if (byte_size > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, surface->index_id);
+        {
+            PoolVector<uint8_t>::Write w = ret.write();
+            glGetBufferSubData(GL_COPY_READ_BUFFER, lod.byte_offset, byte_size, w.ptr());
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    return ret;
+}
+
 void RasterizerStorageGLES3::mesh_remove_surface(RID p_mesh, int p_surface) {
 
     Mesh *mesh = mesh_owner.getornull(p_mesh);
@@ -7715,6 +7840,7 @@ bool RasterizerStorageGLES3::free(RID p_rid) {
         // delete the texture
         Texture *texture = texture_owner.get(p_rid);
         ERR_FAIL_COND_V(texture->render_target, true); //can't free the render target texture, dude
+        texture_streamer.remove(p_rid);
         info.texture_mem -= texture->total_data_size;
         texture_owner.free(p_rid);
         memdelete(texture);
@@ -8252,6 +8378,12 @@ void RasterizerStorageGLES3::initialize() {
 
     config.force_vertex_shading = GLOBAL_GET("rendering/quality/shading/force_vertex_shading").as<bool>();
 
+    ShaderCache::set_enabled(GLOBAL_GET("rendering/misc/shader_cache/enabled").as<bool>());
+
+    texture_streamer.set_enabled(GLOBAL_GET("rendering/misc/texture_streaming/enabled").as<bool>());
+    texture_streamer.set_budget(uint64_t(GLOBAL_GET("rendering/misc/texture_streaming/budget_mb").as<int>()) * 1024 * 1024);
+    texture_streamer.set_min_resident_size(GLOBAL_GET("rendering/misc/texture_streaming/min_resident_size").as<int>());
+
     String renderer = (const char *)glGetString(GL_RENDERER);
 
     config.use_depth_prepass = GLOBAL_GET("rendering/quality/depth_prepass/enable").as<bool>();
@@ -8273,6 +8405,7 @@ void RasterizerStorageGLES3::initialize() {
 
 void RasterizerStorageGLES3::finalize() {
 
+    texture_streamer.finish();
     glDeleteTextures(1, &resources.white_tex);
     glDeleteTextures(1, &resources.black_tex);
     glDeleteTextures(1, &resources.normal_tex);
@@ -8285,6 +8418,7 @@ void RasterizerStorageGLES3::update_dirty_resources() {
     update_dirty_shaders();
     update_dirty_materials();
     update_particles();
+    texture_streamer.update(frame.count);
 }
 
 RasterizerStorageGLES3::RasterizerStorageGLES3() {
@@ -33,6 +33,7 @@
 #include "core/self_list.h"
 #include "servers/rendering/rasterizer.h"
 #include "servers/rendering/shader_language.h"
+#include "servers/rendering/texture_streaming.h"
 #include "shader_compiler_gles3.h"
 #include "shader_gles3.h"
 
@@ -53,7 +54,7 @@ class RasterizerSceneGLES3;
 
 void glTexStorage2DCustom(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLenum format, GLenum type);
 
-class RasterizerStorageGLES3 : public RasterizerStorage {
+class RasterizerStorageGLES3 : public RasterizerStorage, public TextureStreamingBackend {
 public:
     RasterizerCanvasGLES3 *canvas;
     RasterizerSceneGLES3 *scene;
@@ -328,6 +329,10 @@ public:
     void texture_set_path(RID p_texture, StringView p_path) override;
     const String &texture_get_path(RID p_texture) const override;
 
+    TextureStreamer texture_streamer { this };
+    void texture_set_mip_streaming(RID p_texture, StringView p_path) override;
+    void _texture_stream_apply(RID p_texture, int p_base_mip, const Ref<Image> &p_mips) override;
+
     void texture_set_shrink_all_x2_on_set_data(bool p_enable) override;
 
     void texture_debug_usage(Vector<RenderingServer::TextureInfo> *r_info) override;
@@ -580,11 +585,18 @@ public:
             GLuint vertex_id;
             GLuint array_id;
         };
+        // Simplified index ranges stored after the surface indices in index_id.
+        struct LOD {
+            float error;
+            int index_count;
+            uint32_t byte_offset;
+        };
 
         Attrib attribs[RS::ARRAY_MAX];
         Vector<AABB> skeleton_bone_aabb;
         Vector<bool> skeleton_bone_used;
         Vector<BlendShape> blend_shapes;
+        Vector<LOD> lods;
 
         AABB aabb;
         Mesh *mesh;
@@ -701,6 +713,11 @@ public:
     Vector<Vector<uint8_t>> mesh_surface_get_blend_shapes(RID p_mesh, int p_surface) const override;
     const Vector<AABB> &mesh_surface_get_skeleton_aabb(RID p_mesh, int p_surface) const override;
 
+    void mesh_surface_set_lods(RID p_mesh, int p_surface, const Vector<float> &p_lod_errors, const Vector<PoolVector<uint8_t>> &p_lod_index_arrays) override;
+    int mesh_surface_get_lod_count(RID p_mesh, int p_surface) const override;
+    float mesh_surface_get_lod_error(RID p_mesh, int p_surface, int p_lod) const override;
+    PoolVector<uint8_t> mesh_surface_get_lod_index_array(RID p_mesh, int p_surface, int p_lod) const override;
+
     void mesh_remove_surface(RID p_mesh, int p_surface) override;
     int mesh_get_surface_count(RID p_mesh) const override;
 
@@ -34,6 +34,7 @@
 #include "core/project_settings.h"
 #include "core/print_string.h"
 #include "core/string_utils.h"
+#include "servers/rendering/shader_cache.h"
 
 #define SL ShaderLanguage
 
@@ -545,6 +546,7 @@ String ShaderCompilerGLES3::_dump_node_code(SL::Node *p_node, int p_level, Gener
 
             if (p_assigning && p_actions.write_flag_pointers.contains(vnode->name)) {
                 *p_actions.write_flag_pointers[vnode->name] = true;
+                used_write_flags.insert(vnode->name);
             }
 
             if (p_default_actions.usage_defines.contains(vnode->name) && !used_name_defines.contains(vnode->name)) {
@@ -616,6 +618,7 @@ String ShaderCompilerGLES3::_dump_node_code(SL::Node *p_node, int p_level, Gener
 
             if (p_assigning && p_actions.write_flag_pointers.contains(anode->name)) {
                 *p_actions.write_flag_pointers[anode->name] = true;
+                used_write_flags.insert(anode->name);
             }
 
             if (p_default_actions.usage_defines.contains(anode->name) && !used_name_defines.contains(anode->name)) {
@@ -822,8 +825,196 @@ String ShaderCompilerGLES3::_dump_node_code(SL::Node *p_node, int p_level, Gener
     return code;
 }
 
+// Bump whenever GeneratedCode or the generated GLSL changes in a way that makes old cache entries invalid.
+static constexpr int SHADER_COMPILER_CACHE_VERSION = 1;
+
+static void _put_names(ShaderCache::Writer &w, const HashSet<StringName> &p_names) {
+
+    w.put_u32(p_names.size());
+    for (const StringName &n : p_names) {
+        w.put_string(n.asCString());
+    }
+}
+
+static void _put_strings(ShaderCache::Writer &w, const Vector<String> &p_strings) {
+
+    w.put_u32(p_strings.size());
+    for (const String &s : p_strings) {
+        w.put_string(s);
+    }
+}
+
+static bool _get_strings(ShaderCache::Reader &r, Vector<String> &r_strings) {
+
+    uint32_t count = r.get_u32();
+    for (uint32_t i = 0; i < count && !r.has_failed(); i++) {
+        r_strings.emplace_back(r.get_string());
+    }
+    return !r.has_failed();
+}
+
+void ShaderCompilerGLES3::_store_in_cache(StringView p_key, const GeneratedCode &p_gen_code) {
+
+    if (!ShaderCache::is_enabled()) {
+        return;
+    }
+
+    ShaderCache::Writer w;
+
+    _put_strings(w, p_gen_code.defines);
+    w.put_u32(p_gen_code.texture_uniforms.size());
+    for (size_t i = 0; i < p_gen_code.texture_uniforms.size(); i++) {
+        w.put_string(p_gen_code.texture_uniforms[i].asCString());
+        w.put_u32(p_gen_code.texture_types[i]);
+        w.put_u32(p_gen_code.texture_hints[i]);
+    }
+    w.put_u32(p_gen_code.uniform_offsets.size());
+    for (uint32_t ofs : p_gen_code.uniform_offsets) {
+        w.put_u32(ofs);
+    }
+    w.put_u32(p_gen_code.uniform_total_size);
+    w.put_string(p_gen_code.uniforms);
+    w.put_string(p_gen_code.vertex_global);
+    w.put_string(p_gen_code.vertex);
+    w.put_string(p_gen_code.fragment_global);
+    w.put_string(p_gen_code.fragment);
+    w.put_string(p_gen_code.light);
+    w.put_u32(p_gen_code.uses_fragment_time);
+    w.put_u32(p_gen_code.uses_vertex_time);
+
+    // Side effects on the identifier actions, replayed on a cache hit.
+    const SL::ShaderNode *shader = parser.get_shader();
+    w.put_u32(shader->render_modes.size());
+    for (const StringName &mode : shader->render_modes) {
+        w.put_string(mode.asCString());
+    }
+    _put_names(w, used_flag_pointers);
+    _put_names(w, used_write_flags);
+
+    w.put_u32(shader->uniforms.size());
+    for (const eastl::pair<const StringName, SL::ShaderNode::Uniform> &E : shader->uniforms) {
+        const SL::ShaderNode::Uniform &u = E.second;
+        w.put_string(E.first.asCString());
+        w.put_u32(u.order);
+        w.put_u32(u.texture_order);
+        w.put_u32(u.type);
+        w.put_u32(u.precision);
+        w.put_u32(u.hint);
+        for (float range : u.hint_range) {
+            w.put_float(range);
+        }
+        w.put_u32(u.default_value.size());
+        for (const SL::ConstantNode::Value &v : u.default_value) {
+            w.put_u32(v.uint);
+        }
+    }
+
+    ShaderCache::save(p_key, w.get_data());
+}
+
+bool ShaderCompilerGLES3::_load_from_cache(const Vector<uint8_t> &p_data, IdentifierActions *p_actions, GeneratedCode &r_gen_code) {
+
+    ShaderCache::Reader r(p_data);
+    GeneratedCode gen;
+
+    if (!_get_strings(r, gen.defines)) {
+        return false;
+    }
+    uint32_t texture_count = r.get_u32();
+    for (uint32_t i = 0; i < texture_count && !r.has_failed(); i++) {
+        gen.texture_uniforms.emplace_back(StringName(r.get_string()));
+        gen.texture_types.push_back(SL::DataType(r.get_u32()));
+        gen.texture_hints.push_back(SL::ShaderNode::Uniform::Hint(r.get_u32()));
+    }
+    uint32_t offset_count = r.get_u32();
+    for (uint32_t i = 0; i < offset_count && !r.has_failed(); i++) {
+        gen.uniform_offsets.push_back(r.get_u32());
+    }
+    gen.uniform_total_size = r.get_u32();
+    gen.uniforms = r.get_string();
+    gen.vertex_global = r.get_string();
+    gen.vertex = r.get_string();
+    gen.fragment_global = r.get_string();
+    gen.fragment = r.get_string();
+    gen.light = r.get_string();
+    gen.uses_fragment_time = r.get_u32() != 0;
+    gen.uses_vertex_time = r.get_u32() != 0;
+
+    Vector<String> render_modes;
+    Vector<String> usage_flags;
+    Vector<String> write_flags;
+    if (!_get_strings(r, render_modes) || !_get_strings(r, usage_flags) || !_get_strings(r, write_flags)) {
+        return false;
+    }
+
+    HashMap<StringName, SL::ShaderNode::Uniform> uniforms;
+    uint32_t uniform_count = r.get_u32();
+    for (uint32_t i = 0; i < uniform_count && !r.has_failed(); i++) {
+        StringName name(r.get_string());
+        SL::ShaderNode::Uniform u;
+        u.order = r.get_u32();
+        u.texture_order = r.get_u32();
+        u.type = SL::DataType(r.get_u32());
+        u.precision = SL::DataPrecision(r.get_u32());
+        u.hint = SL::ShaderNode::Uniform::Hint(r.get_u32());
+        for (float &range : u.hint_range) {
+            range = r.get_float();
+        }
+        uint32_t value_count = r.get_u32();
+        for (uint32_t j = 0; j < value_count && !r.has_failed(); j++) {
+            SL::ConstantNode::Value v;
+            v.uint = r.get_u32();
+            u.default_value.push_back(v);
+        }
+        uniforms.emplace(name, eastl::move(u));
+    }
+
+    if (r.has_failed() || !r.is_at_end()) {
+        return false;
+    }
+
+    // Everything was read, only now touch the caller visible state.
+    for (const String &mode : render_modes) {
+        StringName sn(mode);
+        if (p_actions->render_mode_flags.contains(sn)) {
+            *p_actions->render_mode_flags[sn] = true;
+        }
+        if (p_actions->render_mode_values.contains(sn)) {
+            Pair<int *, int> &p = p_actions->render_mode_values[sn];
+            *p.first = p.second;
+        }
+    }
+    for (const String &flag : usage_flags) {
+        auto iter = p_actions->usage_flag_pointers.find(StringName(flag));
+        if (iter != p_actions->usage_flag_pointers.end()) {
+            *iter->second = true;
+        }
+    }
+    for (const String &flag : write_flags) {
+        auto iter = p_actions->write_flag_pointers.find(StringName(flag));
+        if (iter != p_actions->write_flag_pointers.end()) {
+            *iter->second = true;
+        }
+    }
+    for (eastl::pair<const StringName, SL::ShaderNode::Uniform> &E : uniforms) {
+        p_actions->uniforms->emplace(E.first, eastl::move(E.second));
+    }
+
+    r_gen_code = eastl::move(gen);
+    return true;
+}
+
 Error ShaderCompilerGLES3::compile(RS::ShaderMode p_mode, const String &p_code, IdentifierActions *p_actions, const String &p_path, GeneratedCode &r_gen_code) {
 
+    String cache_key = ShaderCache::make_key(cache_tag, int(p_mode), p_code);
+    Vector<uint8_t> cached;
+    if (ShaderCache::load(cache_key, cached)) {
+        if (_load_from_cache(cached, p_actions, r_gen_code)) {
+            return OK;
+        }
+        WARN_PRINT("Discarding corrupt shader cache entry for '" + p_path + "'.");
+    }
+
     Error err = parser.compile(p_code, ShaderTypes::get_singleton()->get_functions(p_mode),
             ShaderTypes::get_singleton()->get_modes(p_mode), ShaderTypes::get_singleton()->get_types());
 
@@ -851,6 +1042,7 @@ Error ShaderCompilerGLES3::compile(RS::ShaderMode p_mode, const String &p_code,
     used_name_defines.clear();
     used_rmode_defines.clear();
     used_flag_pointers.clear();
+    used_write_flags.clear();
 
     _dump_node_code(parser.get_shader(), 1, r_gen_code, *p_actions, actions[(int)p_mode], false);
 
@@ -862,6 +1054,8 @@ Error ShaderCompilerGLES3::compile(RS::ShaderMode p_mode, const String &p_code,
         r_gen_code.uniform_total_size += md; //pad just in case
     }
 
+    _store_in_cache(cache_key, r_gen_code);
+
     return OK;
 }
 
@@ -1031,6 +1225,9 @@ ShaderCompilerGLES3::ShaderCompilerGLES3() {
         spatial_rendermode_defs["specular_schlick_ggx"] = "#define SPECULAR_BLINN\n";
     }
 
+    cache_tag = "gles3:" + ::to_string(SHADER_COMPILER_CACHE_VERSION) + (force_lambert ? ":lambert" : "") + (force_blinn ? ":blinn" : "");
+    ShaderCache::set_backend_tag(cache_tag);
+
     spatial_rendermode_defs["specular_blinn"] = "#define SPECULAR_BLINN\n";
     spatial_rendermode_defs["specular_phong"] = "#define SPECULAR_PHONG\n";
     spatial_rendermode_defs["specular_toon"] = "#define SPECULAR_TOON\n";
@@ -89,10 +89,16 @@ private:
 
     HashSet<StringName> used_name_defines;
     HashSet<StringName> used_flag_pointers;
+    HashSet<StringName> used_write_flags;
     HashSet<StringName> used_rmode_defines;
     HashSet<StringName> internal_functions;
 
     DefaultIdentifierActions actions[int(RenderingServerEnums::ShaderMode::MAX)];
+    //! Identifies the code generator configuration in shader cache keys.
+    String cache_tag;
+
+    void _store_in_cache(StringView p_key, const GeneratedCode &p_gen_code);
+    bool _load_from_cache(const Vector<uint8_t> &p_data, IdentifierActions *p_actions, GeneratedCode &r_gen_code);
 
 public:
     Error compile(RS::ShaderMode p_mode, const String &p_code, IdentifierActions *p_actions, const String &p_path, GeneratedCode &r_gen_code);
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "net_socket_posix.h"
+#include "core/hash_map.h"
 #include "core/print_string.h"
 #include "core/string_utils.h"
 
@@ -73,6 +74,11 @@ int sock;
 
 #include <netinet/tcp.h>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define NET_SOCKET_EPOLL
+#endif
+
 // BSD calls this flag IPV6_JOIN_GROUP
 #if !defined(IPV6_ADD_MEMBERSHIP) && defined(IPV6_JOIN_GROUP)
 #define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
@@ -88,6 +94,7 @@ int sock;
 #define SOCK_IOCTL ioctl
 #define SOCK_CLOSE ::close
 #define SOCK_CONNECT(p_sock, p_addr, p_addr_len) ::connect(p_sock, p_addr, p_addr_len)
+#define SOCK_POLL ::poll
 
 /* Windows */
 #elif defined(WINDOWS_ENABLED)
@@ -104,6 +111,7 @@ int sock;
 // connect is broken on windows under certain conditions, reasons unknown:
 // See https://github.com/godotengine/webrtc-native/issues/6
 #define SOCK_CONNECT(p_sock, p_addr, p_addr_len) ::WSAConnect(p_sock, p_addr, p_addr_len, nullptr, nullptr, nullptr, nullptr)
+#define SOCK_POLL WSAPoll
 
 // Workaround missing flag in MinGW
 #if defined(__MINGW32__) && !defined(SIO_UDP_NETRESET)
@@ -178,6 +186,7 @@ GODOT_EXPORT void NetSocketPosix::make_default() {
     }
 #endif
     _create = _create_func;
+    NetSocketPollerPosix::_create = NetSocketPollerPosix::_create_func;
 }
 
 GODOT_EXPORT void NetSocketPosix::cleanup() {
@@ -186,6 +195,7 @@ GODOT_EXPORT void NetSocketPosix::cleanup() {
         WSACleanup();
     }
     _create = nullptr;
+    NetSocketPollerPosix::_create = nullptr;
 #endif
 }
 
@@ -392,6 +402,11 @@ Error NetSocketPosix::open(Type p_sock_type, IP::Type &ip_type) {
 
 void NetSocketPosix::close() {
 
+    // Unregister before the descriptor is released, it could be reused by a new socket right away.
+    while (!_pollers.empty()) {
+        _pollers.back()->_remove(this);
+    }
+
     if (_sock->sock != SOCK_EMPTY)
         SOCK_CLOSE(_sock->sock);
 
@@ -765,3 +780,224 @@ Error NetSocketPosix::join_multicast_group(const IP_Address &p_multi_address, St
 Error NetSocketPosix::leave_multicast_group(const IP_Address &p_multi_address, StringView p_if_name) {
     return _change_multicast_group(p_multi_address, p_if_name, false);
 }
+
+struct POLLER_HOLDER {
+    HashMap<NetSocketPosix *, void *> userdata;
+#if defined(NET_SOCKET_EPOLL)
+    int epoll_fd = -1;
+    Vector<struct epoll_event> ready;
+#else
+    // Parallel arrays handed to poll() as is, sockets are swapped with the last one on removal.
+    Vector<struct pollfd> fds;
+    Vector<NetSocketPosix *> owners;
+#endif
+};
+
+#if defined(NET_SOCKET_EPOLL)
+static uint32_t _get_epoll_events(NetSocket::PollType p_type) {
+    switch (p_type) {
+        case NetSocket::POLL_TYPE_IN:
+            return EPOLLIN;
+        case NetSocket::POLL_TYPE_OUT:
+            return EPOLLOUT;
+        case NetSocket::POLL_TYPE_IN_OUT:
+            return EPOLLIN | EPOLLOUT;
+    }
+    return EPOLLIN;
+}
+#else
+static short _get_poll_events(NetSocket::PollType p_type) {
+    switch (p_type) {
+        case NetSocket::POLL_TYPE_IN:
+            return POLLIN;
+        case NetSocket::POLL_TYPE_OUT:
+            return POLLOUT;
+        case NetSocket::POLL_TYPE_IN_OUT:
+            return POLLIN | POLLOUT;
+    }
+    return POLLIN;
+}
+#endif
+
+NetSocketPoller *NetSocketPollerPosix::_create_func() {
+    return memnew(NetSocketPollerPosix);
+}
+
+NetSocketPosix *NetSocketPollerPosix::_get_socket(const Ref<NetSocket> &p_sock) const {
+    // Every socket on this platform is a NetSocketPosix, see NetSocketPosix::make_default().
+    return static_cast<NetSocketPosix *>(p_sock.get());
+}
+
+void NetSocketPollerPosix::_remove(NetSocketPosix *p_sock) {
+
+    auto iter = _poller->userdata.find(p_sock);
+    if (iter == _poller->userdata.end())
+        return;
+    _poller->userdata.erase(iter);
+    p_sock->_pollers.erase_first_unsorted(this);
+
+#if defined(NET_SOCKET_EPOLL)
+    epoll_ctl(_poller->epoll_fd, EPOLL_CTL_DEL, p_sock->_sock->sock, nullptr);
+#else
+    int idx = 0;
+    for (; idx < _poller->owners.size(); ++idx) {
+        if (_poller->owners[idx] == p_sock)
+            break;
+    }
+    _poller->fds[idx] = _poller->fds.back();
+    _poller->owners[idx] = _poller->owners.back();
+    _poller->fds.pop_back();
+    _poller->owners.pop_back();
+#endif
+}
+
+Error NetSocketPollerPosix::add(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) {
+
+    ERR_FAIL_COND_V(!p_sock || !p_sock->is_open(), ERR_UNCONFIGURED);
+    NetSocketPosix *sock = _get_socket(p_sock);
+    ERR_FAIL_COND_V(_poller->userdata.contains(sock), ERR_ALREADY_EXISTS);
+
+#if defined(NET_SOCKET_EPOLL)
+    struct epoll_event ev;
+    ev.events = _get_epoll_events(p_type);
+    ev.data.ptr = sock;
+    if (epoll_ctl(_poller->epoll_fd, EPOLL_CTL_ADD, sock->_sock->sock, &ev) != 0) {
+        print_verbose("Unable to add socket to epoll set, errno: " + itos(errno));
+        return FAILED;
+    }
+#else
+    struct pollfd pfd;
+    pfd.fd = sock->_sock->sock;
+    pfd.events = _get_poll_events(p_type);
+    pfd.revents = 0;
+    _poller->fds.push_back(pfd);
+    _poller->owners.push_back(sock);
+#endif
+
+    _poller->userdata[sock] = p_userdata;
+    sock->_pollers.push_back(this);
+    return OK;
+}
+
+Error NetSocketPollerPosix::modify(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) {
+
+    ERR_FAIL_COND_V(!p_sock, ERR_INVALID_PARAMETER);
+    NetSocketPosix *sock = _get_socket(p_sock);
+    auto iter = _poller->userdata.find(sock);
+    ERR_FAIL_COND_V(iter == _poller->userdata.end(), ERR_DOES_NOT_EXIST);
+
+#if defined(NET_SOCKET_EPOLL)
+    struct epoll_event ev;
+    ev.events = _get_epoll_events(p_type);
+    ev.data.ptr = sock;
+    if (epoll_ctl(_poller->epoll_fd, EPOLL_CTL_MOD, sock->_sock->sock, &ev) != 0) {
+        print_verbose("Unable to modify socket in epoll set, errno: " + itos(errno));
+        return FAILED;
+    }
+#else
+    for (int i = 0; i < _poller->owners.size(); ++i) {
+        if (_poller->owners[i] == sock) {
+            _poller->fds[i].events = _get_poll_events(p_type);
+            break;
+        }
+    }
+#endif
+
+    iter->second = p_userdata;
+    return OK;
+}
+
+void NetSocketPollerPosix::remove(const Ref<NetSocket> &p_sock) {
+
+    ERR_FAIL_COND(!p_sock);
+    _remove(_get_socket(p_sock));
+}
+
+bool NetSocketPollerPosix::has(const Ref<NetSocket> &p_sock) const {
+
+    return p_sock && _poller->userdata.contains(_get_socket(p_sock));
+}
+
+int NetSocketPollerPosix::get_socket_count() const {
+
+    return int(_poller->userdata.size());
+}
+
+Error NetSocketPollerPosix::wait(Vector<Event> &r_events, int p_timeout) {
+
+    if (_poller->userdata.empty())
+        return ERR_BUSY;
+
+#if defined(NET_SOCKET_EPOLL)
+    ERR_FAIL_COND_V(_poller->epoll_fd == -1, ERR_UNCONFIGURED);
+
+    // Level triggered: if more sockets are ready than fit, the rest are reported by the next call.
+    _poller->ready.resize(MIN(_poller->userdata.size(), size_t(1024)));
+    int ret = epoll_wait(_poller->epoll_fd, _poller->ready.data(), int(_poller->ready.size()), p_timeout);
+    if (ret < 0) {
+        if (errno == EINTR)
+            return ERR_BUSY;
+        print_verbose("Error when waiting on epoll set, errno: " + itos(errno));
+        return FAILED;
+    }
+    if (ret == 0)
+        return ERR_BUSY;
+
+    r_events.reserve(r_events.size() + ret);
+    for (int i = 0; i < ret; ++i) {
+        const struct epoll_event &ev = _poller->ready[i];
+        Event event;
+        event.userdata = _poller->userdata[(NetSocketPosix *)ev.data.ptr];
+        event.readable = ev.events & EPOLLIN;
+        event.writable = ev.events & EPOLLOUT;
+        event.error = ev.events & (EPOLLERR | EPOLLHUP);
+        r_events.push_back(event);
+    }
+    return OK;
+#else
+    int ret = SOCK_POLL(_poller->fds.data(), _poller->fds.size(), p_timeout);
+    if (ret < 0) {
+        print_verbose("Error when polling sockets.");
+        return FAILED;
+    }
+    if (ret == 0)
+        return ERR_BUSY;
+
+    r_events.reserve(r_events.size() + ret);
+    for (int i = 0; i < _poller->fds.size() && ret > 0; ++i) {
+        const struct pollfd &pfd = _poller->fds[i];
+        if (!pfd.revents)
+            continue;
+        Event event;
+        event.userdata = _poller->userdata[_poller->owners[i]];
+        event.readable = pfd.revents & POLLIN;
+        event.writable = pfd.revents & POLLOUT;
+        event.error = pfd.revents & (POLLERR | POLLHUP | POLLNVAL);
+        r_events.push_back(event);
+        --ret;
+    }
+    return OK;
+#endif
+}
+
+NetSocketPollerPosix::NetSocketPollerPosix() :
+        _poller(new POLLER_HOLDER) {
+#if defined(NET_SOCKET_EPOLL)
+    _poller->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_poller->epoll_fd == -1) {
+        ERR_PRINT("Unable to create epoll instance, errno: " + itos(errno));
+    }
+#endif
+}
+
+NetSocketPollerPosix::~NetSocketPollerPosix() {
+    while (!_poller->userdata.empty()) {
+        _remove(_poller->userdata.begin()->first);
+    }
+#if defined(NET_SOCKET_EPOLL)
+    if (_poller->epoll_fd != -1)
+        ::close(_poller->epoll_fd);
+#endif
+    delete _poller;
+    _poller = nullptr;
+}
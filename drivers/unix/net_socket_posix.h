@@ -34,12 +34,17 @@
 
 
 struct SOCKET_HOLDER;
+class NetSocketPollerPosix;
+
 class NetSocketPosix : public NetSocket {
 
+    friend class NetSocketPollerPosix;
+
 private:
     SOCKET_HOLDER *_sock;
     IP::Type _ip_type;
     bool _is_stream;
+    Vector<NetSocketPollerPosix *> _pollers; // Pollers this socket is registered with, see close().
 
     enum NetError {
         ERR_NET_WOULD_BLOCK,
@@ -90,3 +95,29 @@ public:
     GODOT_EXPORT NetSocketPosix();
     GODOT_EXPORT ~NetSocketPosix() override;
 };
+
+struct POLLER_HOLDER;
+class NetSocketPollerPosix : public NetSocketPoller {
+
+    friend class NetSocketPosix;
+
+private:
+    POLLER_HOLDER *_poller;
+
+    NetSocketPosix *_get_socket(const Ref<NetSocket> &p_sock) const;
+    void _remove(NetSocketPosix *p_sock);
+
+protected:
+    static NetSocketPoller *_create_func();
+
+public:
+    Error add(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) override;
+    Error modify(const Ref<NetSocket> &p_sock, NetSocket::PollType p_type, void *p_userdata) override;
+    void remove(const Ref<NetSocket> &p_sock) override;
+    bool has(const Ref<NetSocket> &p_sock) const override;
+    int get_socket_count() const override;
+    Error wait(Vector<Event> &r_events, int p_timeout) override;
+
+    NetSocketPollerPosix();
+    ~NetSocketPollerPosix() override;
+};
@@ -33,6 +33,7 @@
 #include <utility>
 
 #include "core/callable_method_pointer.h"
+#include "core/class_db.h"
 #include "core/method_bind.h"
 #include "core/crypto/crypto_core.h"
 #include "core/io/config_file.h"
@@ -49,7 +50,10 @@
 #include "editor_node.h"
 #include "editor_settings.h"
 #include "scene/resources/resource_format_text.h"
+#include "scene/resources/shader.h"
 #include "scene/resources/theme.h"
+#include "servers/rendering/shader_cache.h"
+#include "servers/rendering_server.h"
 
 #include "EASTL/sort.h"
 
@@ -60,6 +64,7 @@ IMPL_GDCLASS(EditorExportPlugin)
 IMPL_GDCLASS(EditorExport)
 IMPL_GDCLASS(EditorExportPlatformPC)
 IMPL_GDCLASS(EditorExportTextSceneToBinaryPlugin)
+IMPL_GDCLASS(EditorExportShaderCachePlugin)
 namespace  {
 
     struct SavedData {
@@ -1751,3 +1756,96 @@ EditorExportTextSceneToBinaryPlugin::EditorExportTextSceneToBinaryPlugin() {
 
     GLOBAL_DEF("editor/convert_text_resources_to_binary_on_export", false);
 }
+
+void EditorExportShaderCachePlugin::_find_shaders(const Variant &p_value, Vector<Ref<Shader>> &r_shaders) {
+
+    switch (p_value.get_type()) {
+        case VariantType::OBJECT: {
+            RES res(refFromVariant<Resource>(p_value));
+            if (!res || visited.contains(res->get_instance_id()))
+                return;
+            visited.insert(res->get_instance_id());
+
+            Ref<Shader> shader = dynamic_ref_cast<Shader>(res);
+            if (shader) {
+                r_shaders.push_back(shader);
+                return;
+            }
+            Vector<PropertyInfo> properties;
+            res->get_property_list(&properties);
+            for (const PropertyInfo &pi : properties) {
+                if (pi.usage & PROPERTY_USAGE_STORAGE) {
+                    _find_shaders(res->get(pi.name), r_shaders);
+                }
+            }
+        } break;
+        case VariantType::ARRAY: {
+            Array arr = p_value.as<Array>();
+            for (int i = 0; i < arr.size(); i++) {
+                _find_shaders(arr.get(i), r_shaders);
+            }
+        } break;
+        case VariantType::DICTIONARY: {
+            Dictionary d = p_value.as<Dictionary>();
+            for (const Variant &key : d.get_key_list()) {
+                _find_shaders(d[key], r_shaders);
+            }
+        } break;
+        default: {
+        }
+    }
+}
+
+void EditorExportShaderCachePlugin::_export_shader(const Ref<Shader> &p_shader) {
+
+    String code = p_shader->get_code();
+    if (code.empty())
+        return;
+    String key = ShaderCache::make_key(backend_tag, int(p_shader->get_mode()), code);
+    if (exported_keys.contains(key))
+        return;
+    exported_keys.insert(key);
+
+    // Compile through a scratch shader, the backend stores the entry on a miss; asking for the parameters forces the
+    // compile to happen now instead of at the next draw.
+    RenderingServer *rs = RenderingServer::get_singleton();
+    RID rid = rs->shader_create();
+    rs->shader_set_code(rid, code);
+    Vector<PropertyInfo> params;
+    rs->shader_get_param_list(rid, &params);
+    rs->free(rid);
+
+    Vector<uint8_t> data = FileAccess::get_file_as_array(ShaderCache::get_entry_path(ShaderCache::get_cache_dir(), key));
+    if (data.empty())
+        return; // failed to compile, the exported game reports it
+    add_file(ShaderCache::get_entry_path(ShaderCache::EXPORT_DIR, key), data, false);
+}
+
+void EditorExportShaderCachePlugin::_export_begin(const Set<String> &p_features, bool p_debug, StringView p_path, int p_flags) {
+
+    exported_keys.clear();
+    visited.clear();
+    backend_tag.clear();
+    // Only the project's own shaders are shipped, the editor's cache also holds editor-only ones.
+    if (GLOBAL_GET("rendering/misc/shader_cache/enabled").as<bool>() && ShaderCache::is_enabled())
+        backend_tag = ShaderCache::get_backend_tag();
+}
+
+void EditorExportShaderCachePlugin::_export_file(StringView p_path, StringView p_type, const Set<String> &p_features) {
+
+    if (backend_tag.empty())
+        return;
+    StringName type(p_type);
+    if (!ClassDB::is_parent_class(type, "Shader") && !ClassDB::is_parent_class(type, "Material") &&
+            !ClassDB::is_parent_class(type, "Mesh") && !ClassDB::is_parent_class(type, "PackedScene"))
+        return;
+
+    RES res = gResourceManager().load(p_path);
+    if (!res)
+        return;
+    Vector<Ref<Shader>> shaders;
+    _find_shaders(Variant(res), shaders);
+    for (const Ref<Shader> &shader : shaders) {
+        _export_shader(shader);
+    }
+}
@@ -411,3 +411,19 @@ public:
     void _export_file(StringView p_path, StringView p_type, const Set<String> &p_features) override;
     EditorExportTextSceneToBinaryPlugin();
 };
+
+class EditorExportShaderCachePlugin : public EditorExportPlugin {
+
+    GDCLASS(EditorExportShaderCachePlugin,EditorExportPlugin)
+
+    String backend_tag;
+    Set<String> exported_keys;
+    Set<ObjectID> visited;
+
+    void _find_shaders(const Variant &p_value, Vector<Ref<Shader>> &r_shaders);
+    void _export_shader(const Ref<Shader> &p_shader);
+
+public:
+    void _export_begin(const Set<String> &p_features, bool p_debug, StringView p_path, int p_flags) override;
+    void _export_file(StringView p_path, StringView p_type, const Set<String> &p_features) override;
+};
@@ -3875,6 +3875,7 @@ void EditorNode::register_editor_types() {
     EditorExport::initialize_class();
     EditorExportPlatformPC::initialize_class();
     EditorExportTextSceneToBinaryPlugin::initialize_class();
+    EditorExportShaderCachePlugin::initialize_class();
     PropertySelector::initialize_class();
     GroupDialog::initialize_class();
     GroupsEditor::initialize_class();
@@ -7267,6 +7268,7 @@ EditorNode::EditorNode() {
             make_ref_counted<EditorExportTextSceneToBinaryPlugin>());
 
     EditorExport::get_singleton()->add_export_plugin(export_text_to_binary_plugin);
+    EditorExport::get_singleton()->add_export_plugin(make_ref_counted<EditorExportShaderCachePlugin>());
 
     _edit_current();
     current = nullptr;
@@ -228,6 +228,10 @@ bool ResourceImporterScene::get_option_visibility(
         return false;
     }
 
+    if (p_option == "meshes/generate_lods" && !p_options.at("meshes/optimize").as<bool>()) {
+        return false;
+    }
+
     return true;
 }
 
@@ -1207,6 +1211,10 @@ void ResourceImporterScene::get_import_options(Vector<ResourceImporterInterface:
     r_options->push_back(ImportOption(
             PropertyInfo(VariantType::FLOAT, "meshes/lightmap_texel_size", PropertyHint::Range, "0.001,100,0.001"),
             0.1));
+    r_options->push_back(ImportOption(PropertyInfo(VariantType::BOOL, "meshes/optimize", PropertyHint::None, "",
+                                              PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED),
+            true));
+    r_options->push_back(ImportOption(PropertyInfo(VariantType::BOOL, "meshes/generate_lods"), true));
     r_options->push_back(ImportOption(PropertyInfo(VariantType::BOOL, "external_files/store_in_subdir"), false));
     r_options->push_back(ImportOption(PropertyInfo(VariantType::BOOL, "animation/import", PropertyHint::None, "",
                                               PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED),
@@ -1415,6 +1423,8 @@ Error ResourceImporterScene::import(StringView p_source_file, StringView p_save_
     float anim_optimizer_angerr = p_options.at("animation/optimizer/max_angular_error").as<float>();
     float anim_optimizer_maxang = p_options.at("animation/optimizer/max_angle").as<float>();
     int light_bake_mode = p_options.at("meshes/light_baking").as<int>();
+    bool optimize_meshes = p_options.at("meshes/optimize").as<bool>();
+    bool generate_lods = p_options.at("meshes/generate_lods").as<bool>();
 
     Map<Ref<Mesh>, List<Ref<Shape>>> collision_map;
 
@@ -1474,7 +1484,7 @@ Error ResourceImporterScene::import(StringView p_source_file, StringView p_save_
         }
     }
 
-    if (light_bake_mode == 2 /* || generate LOD */) {
+    if (light_bake_mode == 2 || optimize_meshes) {
 
         Map<Ref<ArrayMesh>, Transform> meshes;
         _find_meshes(scene, meshes);
@@ -1506,6 +1516,29 @@ Error ResourceImporterScene::import(StringView p_source_file, StringView p_save_
                 step++;
             }
         }
+
+        // after unwrapping, which rebuilds the surfaces and would undo the new order
+        if (optimize_meshes) {
+
+            EditorProgress progress2(("optimize_meshes"), TTR("Optimizing Meshes"), meshes.size());
+            int step = 0;
+            for (eastl::pair<const Ref<ArrayMesh>, Transform> &E : meshes) {
+
+                Ref<ArrayMesh> mesh = E.first;
+                String name(mesh->get_name());
+                if (name.empty()) {
+                    name = "Mesh " + itos(step);
+                }
+
+                progress2.step(TTR("Optimizing Mesh: ") + StringView(name), step);
+
+                Error err2 = mesh->optimize_surfaces(generate_lods);
+                if (err2 != OK) {
+                    EditorNode::add_io_error(StringName("Mesh '" + name + "' could not be optimized."));
+                }
+                step++;
+            }
+        }
     }
 
     if (external_animations || external_materials || external_meshes) {
@@ -40,6 +40,7 @@
 #include "core/io/image_loader.h"
 #include "core/io/ip.h"
 #include "core/io/resource_loader.h"
+#include "core/io/resource_payload_streamer.h"
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
 #include "core/os/os.h"
@@ -58,6 +59,7 @@
 #include "main/performance.h"
 #include "main/splash.gen.h"
 #include "main/splash_editor.gen.h"
+#include "main/tests/benchmark_runner.h"
 #include "main/tests/test_main.h"
 #include "modules/register_module_types.h"
 #include "plugins/plugin_registry_interface.h"
@@ -162,6 +164,8 @@ static int frame_delay = 0;
 static bool disable_render_loop = false;
 static int fixed_fps = -1;
 static bool print_fps = false;
+static int profile_frames = 0;
+static String profile_output("frame_profile.json");
 
 /* Helper methods */
 
@@ -314,6 +318,8 @@ void Main::print_help(const String &p_binary) {
     OS::get_singleton()->print("  --disable-crash-handler          Disable crash handler when supported by the platform code.\n");
     OS::get_singleton()->print("  --fixed-fps <fps>                Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
     OS::get_singleton()->print("  --print-fps                      Print the frames per second to the stdout.\n");
+    OS::get_singleton()->print("  --profile-frames <n>             Record <n> frames with the built-in frame profiler and write them as a Chrome trace.\n");
+    OS::get_singleton()->print("  --profile-output <file>          File the --profile-frames trace is written to (default: frame_profile.json).\n");
     OS::get_singleton()->print("\n");
 
     OS::get_singleton()->print("Standalone tools:\n");
@@ -321,6 +327,10 @@ void Main::print_help(const String &p_binary) {
     
     OS::get_singleton()->print("  -s, --script <script>            Run a script.\n");
     OS::get_singleton()->print("  --check-only                     Only parse for errors and quit (use with --script).\n");
+    OS::get_singleton()->print("  --benchmark                      Run the engine benchmarks and print the results as JSON, then quit.\n");
+    OS::get_singleton()->print("  --benchmark-filter <text>        Only run the benchmarks whose name contains <text>.\n");
+    OS::get_singleton()->print("  --benchmark-output <file>        Write the benchmark results to <file> instead of stdout.\n");
+    OS::get_singleton()->print("  --benchmark-repetitions <n>      Number of timed samples per benchmark (default: 20).\n");
 #ifdef TOOLS_ENABLED
     OS::get_singleton()->print("  --export <preset> <path>         Export the project using the given preset and matching release template. The preset name should match one defined in export_presets.cfg.\n");
     OS::get_singleton()->print("                                   <path> should be absolute or relative to the project directory, and include the filename for the binary (e.g. 'builds/game.exe'). The target directory should exist.\n");
@@ -908,6 +918,22 @@ Error Main::setup(bool p_second_phase) {
             }
         } else if (*I == "--print-fps") {
             print_fps = true;
+        } else if (*I == "--profile-frames") {
+            if (N != args.end()) {
+                profile_frames = StringUtils::to_int(*N);
+                ++N;
+            } else {
+                os->print("Missing profile-frames argument, aborting.\n");
+                goto error;
+            }
+        } else if (*I == "--profile-output") {
+            if (N != args.end()) {
+                profile_output = *N;
+                ++N;
+            } else {
+                os->print("Missing profile-output argument, aborting.\n");
+                goto error;
+            }
         } else if (*I == "--disable-crash-handler") {
             os->disable_crash_handler();
         } else if (*I == "--skip-breakpoints") {
@@ -963,7 +989,7 @@ Error Main::setup(bool p_second_phase) {
 #endif
     }
 
-    GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
+    GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 256);
 
     project_settings->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc",
             PropertyInfo(VariantType::INT, "memory/limits/multithreaded_server/rid_pool_prealloc", PropertyHint::Range,
@@ -1556,6 +1582,11 @@ bool Main::start() {
 
     ERR_FAIL_COND_V(!_start_success, false);
 
+    if (profile_frames > 0) {
+        FrameProfiler::set_thread_name("Main");
+        FrameProfiler::start_capture(profile_frames, profile_output);
+    }
+
     bool hasicon = false;
     String doc_tool;
     Vector<String> removal_docs;
@@ -1564,6 +1595,10 @@ bool Main::start() {
     String script;
     String test;
     bool check_only = false;
+    bool benchmark = false;
+    String benchmark_filter;
+    String benchmark_output;
+    int benchmark_repetitions = 20;
 #ifdef TOOLS_ENABLED
     bool doc_base = true;
     String _export_preset;
@@ -1582,6 +1617,8 @@ bool Main::start() {
         //parameters that do not have an argument to the right
         if (*i == "--check-only") {
             check_only = true;
+        } else if (*i == "--benchmark") {
+            benchmark = true;
 #ifdef TOOLS_ENABLED
         } else if (*i == "--no-docbase") {
             doc_base = false;
@@ -1614,6 +1651,12 @@ bool Main::start() {
                 script = *next;
             } else if (*i == "--test") {
                 test = *next;
+            } else if (*i == "--benchmark-filter") {
+                benchmark_filter = *next;
+            } else if (*i == "--benchmark-output") {
+                benchmark_output = *next;
+            } else if (*i == "--benchmark-repetitions") {
+                benchmark_repetitions = StringUtils::to_int(*next);
 #ifdef TOOLS_ENABLED
             } else if (*i == "--doctool") {
                 doc_tool = *next;
@@ -1709,6 +1752,11 @@ bool Main::start() {
         game_path = T_GLOBAL_DEF("application/run/main_scene", String());
     }
 
+    if (benchmark) {
+        OS::get_singleton()->set_exit_code(benchmarks_run(benchmark_filter, benchmark_output, benchmark_repetitions));
+        return false;
+    }
+
     MainLoop *main_loop = nullptr;
     if (editor) {
         main_loop = memnew(SceneTree);
@@ -2172,11 +2220,15 @@ bool Main::iteration() {
 
         message_queue->flush();
 
-        PhysicsServer3D::get_singleton()->step(frame_slice * time_scale);
-        NavigationServer::get_singleton_mut()->step(frame_slice * time_scale);
+        {
+            SCOPE_PROFILE(physics_step);
+            MemoryTagScope mem_tag(MEM_TAG_PHYSICS);
+            PhysicsServer3D::get_singleton()->step(frame_slice * time_scale);
+            NavigationServer::get_singleton_mut()->step(frame_slice * time_scale);
 
-        PhysicsServer2D::get_singleton()->end_sync();
-        PhysicsServer2D::get_singleton()->step(frame_slice * time_scale);
+            PhysicsServer2D::get_singleton()->end_sync();
+            PhysicsServer2D::get_singleton()->step(frame_slice * time_scale);
+        }
 
         message_queue->flush();
 
@@ -2194,9 +2246,12 @@ bool Main::iteration() {
     }
     message_queue->flush();
 
+    ResourcePayloadStreamer::get_singleton()->poll(); // apply resource data streamed in since the last frame
+
     RenderingServer::get_singleton()->sync(); //sync if still drawing from previous frames.
 
     if (OS::get_singleton()->can_draw() && !disable_render_loop) {
+        SCOPE_PROFILE(render_draw);
 
         if ((!force_redraw_requested) && OS::get_singleton()->is_in_low_processor_usage_mode()) {
             if (RenderingServer::get_singleton()->has_changed()) {
@@ -2227,6 +2282,10 @@ bool Main::iteration() {
         script_debugger->idle_poll();
     }
 
+    for (int i = 0; i < MEM_TAG_MAX; ++i) {
+        PROFILER_PLOT(Memory::get_tag_name(MemoryTag(i)), int64_t(Memory::get_tag_usage(MemoryTag(i))));
+    }
+
     frames++;
     Engine::get_singleton()->_idle_frames++;
 
@@ -2250,6 +2309,8 @@ bool Main::iteration() {
         frames = 0;
     }
 
+    FrameProfiler::frame_mark();
+
     iterating--;
 
     if (fixed_fps != -1)
@@ -2287,6 +2348,7 @@ void Main::force_redraw() {
 void Main::cleanup() {
 
     ERR_FAIL_COND(!_start_success);
+    FrameProfiler::stop_capture(); // quitting before the requested number of frames
     if (script_debugger) {
         // Flush any remaining messages
         script_debugger->idle_poll();
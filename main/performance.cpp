@@ -82,6 +82,14 @@ void Performance::_bind_methods() {
     BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS)
     BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT)
     BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY)
+    BIND_ENUM_CONSTANT(MEMORY_ALLOCATION_COUNT)
+    BIND_ENUM_CONSTANT(MEMORY_SCENE)
+    BIND_ENUM_CONSTANT(MEMORY_RESOURCE)
+    BIND_ENUM_CONSTANT(MEMORY_RENDERING)
+    BIND_ENUM_CONSTANT(MEMORY_PHYSICS)
+    BIND_ENUM_CONSTANT(MEMORY_AUDIO)
+    BIND_ENUM_CONSTANT(MEMORY_SCRIPT)
+    BIND_ENUM_CONSTANT(MEMORY_NETWORK)
 
     BIND_ENUM_CONSTANT(MONITOR_MAX)
 }
@@ -129,6 +137,14 @@ StringView Performance::get_monitor_name(Monitor p_monitor) const {
         "physics_3d/collision_pairs",
         "physics_3d/islands",
         "audio/output_latency",
+        "memory/allocations",
+        "memory/scene",
+        "memory/resource",
+        "memory/rendering",
+        "memory/physics",
+        "memory/audio",
+        "memory/script",
+        "memory/network",
 
     };
 
@@ -169,6 +185,14 @@ float Performance::get_monitor(Monitor p_monitor) const {
         case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_COLLISION_PAIRS);
         case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
         case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+        case MEMORY_ALLOCATION_COUNT: return Memory::get_alloc_count();
+        case MEMORY_SCENE: return Memory::get_tag_usage(MEM_TAG_SCENE);
+        case MEMORY_RESOURCE: return Memory::get_tag_usage(MEM_TAG_RESOURCE);
+        case MEMORY_RENDERING: return Memory::get_tag_usage(MEM_TAG_RENDERING);
+        case MEMORY_PHYSICS: return Memory::get_tag_usage(MEM_TAG_PHYSICS);
+        case MEMORY_AUDIO: return Memory::get_tag_usage(MEM_TAG_AUDIO);
+        case MEMORY_SCRIPT: return Memory::get_tag_usage(MEM_TAG_SCRIPT);
+        case MEMORY_NETWORK: return Memory::get_tag_usage(MEM_TAG_NETWORK);
 
         default: {
         }
@@ -213,6 +237,14 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
         MONITOR_TYPE_QUANTITY,
         MONITOR_TYPE_QUANTITY,
         MONITOR_TYPE_TIME,
+        MONITOR_TYPE_QUANTITY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
+        MONITOR_TYPE_MEMORY,
 
     };
 
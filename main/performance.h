@@ -81,6 +81,14 @@ public:
         PHYSICS_3D_ISLAND_COUNT,
         //physics
         AUDIO_OUTPUT_LATENCY,
+        MEMORY_ALLOCATION_COUNT,
+        MEMORY_SCENE,
+        MEMORY_RESOURCE,
+        MEMORY_RENDERING,
+        MEMORY_PHYSICS,
+        MEMORY_AUDIO,
+        MEMORY_SCRIPT,
+        MEMORY_NETWORK,
         MONITOR_MAX
     };
 
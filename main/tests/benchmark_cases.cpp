@@ -0,0 +1,545 @@
+/*************************************************************************/
+/*  benchmark_cases.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "benchmark_runner.h"
+
+#include "core/dictionary.h"
+#include "core/image.h"
+#include "core/io/json.h"
+#include "core/math/audio_frame.h"
+#include "core/method_info.h"
+#include "core/object_db.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/resource/resource_manager.h"
+#include "core/string_name.h"
+#include "core/string_utils.h"
+#include "core/variant.h"
+#include "scene/3d/mesh_instance_3d.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "scene/resources/mesh.h"
+#include "scene/resources/navigation_mesh.h"
+#include "scene/resources/packed_scene.h"
+#include "scene/resources/primitive_meshes.h"
+#include "servers/navigation_server.h"
+#include "servers/physics_server_3d.h"
+
+namespace {
+
+/* Core */
+
+void _variant_less_int(BenchmarkRun &p_run) {
+    Variant a(int64_t(12345));
+    Variant b(int64_t(678));
+    p_run.measure([&]() {
+        Variant r = Variant::evaluate(Variant::OP_LESS, a, b);
+        benchmark_keep(r);
+    });
+}
+
+void _variant_equal_string(BenchmarkRun &p_run) {
+    // same length and prefix, so the comparison has to look at the contents
+    Variant a(String("benchmark_string_value_a"));
+    Variant b(String("benchmark_string_value_b"));
+    p_run.measure([&]() {
+        Variant r = Variant::evaluate(Variant::OP_EQUAL, a, b);
+        benchmark_keep(r);
+    });
+}
+
+void _variant_roundtrip_vector3(BenchmarkRun &p_run) {
+    Vector3 value(1, 2, 3);
+    p_run.measure([&]() {
+        Variant v(value);
+        value = v.as<Vector3>();
+        benchmark_keep(value);
+    });
+}
+
+void _string_name_intern(BenchmarkRun &p_run) {
+    // names that are already interned, the common case of StringName(String) in engine code
+    enum { NAME_COUNT = 1024 };
+    Vector<String> strings;
+    Vector<StringName> keep_alive;
+    for (int i = 0; i < NAME_COUNT; i++) {
+        strings.push_back("benchmark_name_" + itos(i));
+        keep_alive.emplace_back(StringName(strings.back()));
+    }
+    uint32_t i = 0;
+    p_run.measure([&]() {
+        StringName name(strings[i++ & (NAME_COUNT - 1)]);
+        benchmark_keep(name);
+    });
+}
+
+void _object_db_get_instance(BenchmarkRun &p_run) {
+    enum { OBJECT_COUNT = 4096 };
+    Vector<Object *> objects;
+    Vector<ObjectID> ids;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        objects.push_back(memnew(Object));
+        ids.push_back(objects.back()->get_instance_id());
+    }
+    uint32_t i = 0;
+    p_run.measure([&]() {
+        Object *obj = ObjectDB::get_instance(ids[i++ & (OBJECT_COUNT - 1)]);
+        benchmark_keep(obj);
+    });
+    for (Object *obj : objects) {
+        memdelete(obj);
+    }
+}
+
+void _object_create_free(BenchmarkRun &p_run) {
+    p_run.measure([]() {
+        Object *obj = memnew(Object);
+        benchmark_keep(obj);
+        memdelete(obj);
+    });
+}
+
+void _signal_emit(BenchmarkRun &p_run) {
+    Object *emitter = memnew(Object);
+    Object *receiver = memnew(Object);
+    const StringName signal("benchmark_signal");
+    emitter->add_user_signal(MethodInfo(signal));
+    emitter->connect(signal, Callable(receiver->get_instance_id(), "get_instance_id"));
+    p_run.measure([&]() {
+        emitter->emit_signal(signal);
+    });
+    memdelete(emitter);
+    memdelete(receiver);
+}
+
+// Telemetry like document of about a megabyte.
+Variant _make_json_document() {
+    Array records;
+    for (int i = 0; i < 4096; i++) {
+        Dictionary record;
+        record["id"] = i;
+        record["name"] = "entity_" + itos(i);
+        Array position;
+        position.push_back(i * 0.25);
+        position.push_back(-i * 1.5);
+        position.push_back(1e-3 * i);
+        record["position"] = position;
+        record["active"] = (i & 1) == 0;
+        record["tags"] = Array();
+        record["description"] = String("A \"quoted\" description with some unicode: \xc3\xa9\xe2\x82\xac and a newline\n");
+        records.push_back(record);
+    }
+    Dictionary doc;
+    doc["version"] = 3;
+    doc["records"] = records;
+    return doc;
+}
+
+void _json_parse(BenchmarkRun &p_run) {
+    const String text = JSON::print(_make_json_document(), "\t");
+    p_run.measure([&]() {
+        Variant result;
+        String err_str;
+        int err_line;
+        JSON::parse(text, result, err_str, err_line);
+        benchmark_keep(result);
+    });
+}
+
+void _json_print(BenchmarkRun &p_run) {
+    const Variant doc = _make_json_document();
+    p_run.measure([&]() {
+        String text = JSON::print(doc, "\t");
+        benchmark_keep(text);
+    });
+}
+
+void _json_writer_reuse(BenchmarkRun &p_run) {
+    // unsorted and without indent, the way messages are sent over the network
+    const Variant doc = _make_json_document();
+    JSONWriter writer({}, false);
+    p_run.measure([&]() {
+        writer.clear();
+        writer.value(doc);
+        benchmark_keep(writer.get_text());
+    });
+}
+
+/* Scene */
+
+Ref<PackedScene> _make_scene() {
+    enum { CHILD_COUNT = 64 };
+    Ref<SphereMesh> mesh(make_ref_counted<SphereMesh>());
+    Node3D *root = memnew(Node3D);
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        MeshInstance3D *mi = memnew(MeshInstance3D);
+        mi->set_name("Mesh" + itos(i));
+        mi->set_mesh(mesh);
+        mi->set_translation(Vector3(i % 8, 0, i / 8));
+        root->add_child(mi);
+        mi->set_owner(root);
+    }
+    Ref<PackedScene> scene(make_ref_counted<PackedScene>());
+    Error err = scene->pack(root);
+    memdelete(root);
+    ERR_FAIL_COND_V(err != OK, Ref<PackedScene>());
+    return scene;
+}
+
+void _scene_instance(BenchmarkRun &p_run) {
+    Ref<PackedScene> scene = _make_scene();
+    ERR_FAIL_COND(!scene);
+    p_run.measure([&]() {
+        Node *node = scene->instance();
+        memdelete(node);
+    });
+}
+
+void _scene_instance_many(BenchmarkRun &p_run) {
+    // one operation is one instance, made in groups of 16
+    Ref<PackedScene> scene = _make_scene();
+    ERR_FAIL_COND(!scene);
+    Vector<Node *> nodes;
+    int left = 0;
+    p_run.measure([&]() {
+        if (left == 0) {
+            for (Node *node : nodes) {
+                memdelete(node);
+            }
+            nodes = scene->instance_many(16);
+            left = nodes.size();
+        }
+        left--;
+    });
+    for (Node *node : nodes) {
+        memdelete(node);
+    }
+}
+
+/* Servers */
+
+void _physics_step(BenchmarkRun &p_run) {
+    enum { BODY_COUNT = 512 };
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    if (!ps) {
+        p_run.skip("no 3D physics server");
+        return;
+    }
+
+    RID space = ps->space_create();
+    ps->space_set_active(space, true);
+    RID plane = ps->shape_create(PhysicsServer3D::SHAPE_PLANE);
+    ps->shape_set_data(plane, Plane(Vector3(0, 1, 0), 0));
+    RID box = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+    ps->shape_set_data(box, Vector3(0.5f, 0.5f, 0.5f));
+
+    Vector<RID> bodies;
+    RID floor = ps->body_create(PhysicsServer3D::BODY_MODE_STATIC);
+    ps->body_set_space(floor, space);
+    ps->body_add_shape(floor, plane);
+    bodies.push_back(floor);
+    for (int i = 0; i < BODY_COUNT; i++) {
+        RID body = ps->body_create(PhysicsServer3D::BODY_MODE_RIGID);
+        ps->body_set_space(body, space);
+        ps->body_add_shape(body, box);
+        // stacked columns, so bodies keep colliding instead of falling asleep on the floor
+        ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform(Basis(), Vector3(i % 8 * 1.1f, 0.5f + i / 64 * 1.05f, (i / 8) % 8 * 1.1f)));
+        bodies.push_back(body);
+    }
+
+    p_run.measure([&]() {
+        ps->step(1.0f / 60.0f);
+    });
+
+    for (RID body : bodies) {
+        ps->free_rid(body);
+    }
+    ps->free_rid(box);
+    ps->free_rid(plane);
+    ps->free_rid(space);
+}
+
+void _navigation_path(BenchmarkRun &p_run) {
+    enum { GRID_SIZE = 64 };
+    NavigationServer *nav = NavigationServer::get_singleton_mut();
+    if (!nav) {
+        p_run.skip("no navigation server");
+        return;
+    }
+
+    Ref<NavigationMesh> navmesh(make_ref_counted<NavigationMesh>());
+    Vector<Vector3> vertices;
+    for (int z = 0; z <= GRID_SIZE; z++) {
+        for (int x = 0; x <= GRID_SIZE; x++) {
+            vertices.push_back(Vector3(x, 0, z));
+        }
+    }
+    navmesh->set_vertices(eastl::move(vertices));
+    for (int z = 0; z < GRID_SIZE; z++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            // leave holes so paths have to go around them
+            if (x % 8 == 4 && z % 8 != 0)
+                continue;
+            const int v = z * (GRID_SIZE + 1) + x;
+            navmesh->add_polygon({ v, v + 1, v + GRID_SIZE + 2, v + GRID_SIZE + 1 });
+        }
+    }
+
+    RID map = nav->map_create();
+    nav->map_set_active(map, true);
+    RID region = nav->region_create();
+    nav->region_set_map(region, map);
+    nav->region_set_navmesh(region, navmesh);
+    // applies the commands and builds the map
+    nav->step(0);
+    nav->step(0);
+
+    uint32_t i = 0;
+    p_run.measure([&]() {
+        i++;
+        Vector3 from(0.5f, 0, (i * 7) % GRID_SIZE + 0.5f);
+        Vector3 to(GRID_SIZE - 0.5f, 0, (i * 13) % GRID_SIZE + 0.5f);
+        Vector<Vector3> path = nav->map_get_path(map, from, to, true);
+        benchmark_keep(path);
+    });
+
+    nav->free(region);
+    nav->free(map);
+    nav->step(0);
+}
+
+void _audio_mix(BenchmarkRun &p_run) {
+    // one operation mixes 1024 frames of a looping 16 bit stereo sample, resampled to the mix rate
+    enum {
+        SAMPLE_RATE = 44100,
+        MIX_FRAMES = 1024,
+    };
+    Vector<uint8_t> data;
+    data.resize(SAMPLE_RATE * 4);
+    int16_t *pcm = reinterpret_cast<int16_t *>(data.data());
+    for (int i = 0; i < SAMPLE_RATE; i++) {
+        pcm[i * 2 + 0] = int16_t(Math::sin(i * 0.0627f) * 12000);
+        pcm[i * 2 + 1] = int16_t(Math::sin(i * 0.0313f) * 12000);
+    }
+    Ref<AudioStreamSample> sample(make_ref_counted<AudioStreamSample>());
+    sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+    sample->set_mix_rate(SAMPLE_RATE);
+    sample->set_stereo(true);
+    sample->set_data(data);
+    sample->set_loop_mode(AudioStreamSample::LOOP_FORWARD);
+    sample->set_loop_end(SAMPLE_RATE);
+
+    Ref<AudioStreamPlayback> playback = sample->instance_playback();
+    playback->start();
+    Vector<AudioFrame> buffer;
+    buffer.resize(MIX_FRAMES);
+    p_run.measure([&]() {
+        playback->mix(buffer.data(), 1.0f, MIX_FRAMES);
+        benchmark_keep(buffer[0]);
+    });
+}
+
+/* Resources */
+
+Ref<Image> _make_image(int p_size) {
+    PoolVector<uint8_t> data;
+    data.resize(p_size * p_size * 4);
+    {
+        PoolVector<uint8_t>::Write w = data.write();
+        for (int i = 0; i < p_size * p_size; i++) {
+            const int x = i % p_size;
+            const int y = i / p_size;
+            w[i * 4 + 0] = uint8_t(x * 255 / p_size);
+            w[i * 4 + 1] = uint8_t(y * 255 / p_size);
+            w[i * 4 + 2] = uint8_t(x ^ y);
+            w[i * 4 + 3] = 255;
+        }
+    }
+    return make_ref_counted<Image>(p_size, p_size, false, Image::FORMAT_RGBA8, data);
+}
+
+void _image_resize(BenchmarkRun &p_run) {
+    Ref<Image> source = _make_image(1024);
+    p_run.measure([&]() {
+        Ref<Image> img = dynamic_ref_cast<Image>(source->duplicate());
+        img->resize(512, 512, Image::INTERPOLATE_BILINEAR);
+        benchmark_keep(img);
+    });
+}
+
+// Large enough for the resamplers to spread the work over the worker threads, p_threads 0 keeps it on the caller.
+void _image_resize_cubic(BenchmarkRun &p_run, int p_threads) {
+    Ref<Image> source = _make_image(1024);
+    WorkerThreadPool::get_singleton()->set_thread_count(p_threads);
+    p_run.measure([&]() {
+        Ref<Image> img = dynamic_ref_cast<Image>(source->duplicate());
+        img->resize(2048, 2048, Image::INTERPOLATE_CUBIC);
+        benchmark_keep(img);
+    });
+    WorkerThreadPool::get_singleton()->set_thread_count(-1);
+}
+
+void _image_resize_cubic_serial(BenchmarkRun &p_run) {
+    _image_resize_cubic(p_run, 0);
+}
+
+void _image_resize_cubic_threaded(BenchmarkRun &p_run) {
+    _image_resize_cubic(p_run, -1);
+}
+
+void _image_mipmaps(BenchmarkRun &p_run, int p_threads) {
+    Ref<Image> source = _make_image(2048);
+    WorkerThreadPool::get_singleton()->set_thread_count(p_threads);
+    p_run.measure([&]() {
+        Ref<Image> img = dynamic_ref_cast<Image>(source->duplicate());
+        img->generate_mipmaps();
+        benchmark_keep(img);
+    });
+    WorkerThreadPool::get_singleton()->set_thread_count(-1);
+}
+
+void _image_mipmaps_serial(BenchmarkRun &p_run) {
+    _image_mipmaps(p_run, 0);
+}
+
+void _image_mipmaps_threaded(BenchmarkRun &p_run) {
+    _image_mipmaps(p_run, -1);
+}
+
+void _image_compress(BenchmarkRun &p_run) {
+    Ref<Image> source = _make_image(512);
+    Ref<Image> probe = dynamic_ref_cast<Image>(source->duplicate());
+    if (probe->compress(COMPRESS_ETC2) != OK) {
+        p_run.skip("ETC2 compression is not available");
+        return;
+    }
+    p_run.measure([&]() {
+        Ref<Image> img = dynamic_ref_cast<Image>(source->duplicate());
+        img->compress(COMPRESS_ETC2);
+        benchmark_keep(img);
+    });
+}
+
+Ref<ArrayMesh> _make_mesh() {
+    Ref<SphereMesh> sphere(make_ref_counted<SphereMesh>());
+    sphere->set_radial_segments(128);
+    sphere->set_rings(64);
+    Ref<ArrayMesh> mesh(make_ref_counted<ArrayMesh>());
+    mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, sphere->get_mesh_arrays());
+    return mesh;
+}
+
+String _resource_path(const char *p_extension) {
+    return PathUtils::plus_file(OS::get_singleton()->get_cache_path(), String("benchmark_mesh.") + p_extension);
+}
+
+void _remove_file(const String &p_path) {
+    DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+    da->remove(p_path);
+    memdelete(da);
+}
+
+void _resource_save(BenchmarkRun &p_run, const char *p_extension) {
+    Ref<ArrayMesh> mesh = _make_mesh();
+    const String path = _resource_path(p_extension);
+    if (gResourceManager().save(path, mesh) != OK) {
+        p_run.skip("cannot write " + path);
+        return;
+    }
+    p_run.measure([&]() {
+        gResourceManager().save(path, mesh);
+    });
+    _remove_file(path);
+}
+
+void _resource_load(BenchmarkRun &p_run, const char *p_extension) {
+    const String path = _resource_path(p_extension);
+    if (gResourceManager().save(path, _make_mesh()) != OK) {
+        p_run.skip("cannot write " + path);
+        return;
+    }
+    p_run.measure([&]() {
+        RES res = gResourceManager().load(path, "", true);
+        benchmark_keep(res);
+    });
+    _remove_file(path);
+}
+
+void _resource_save_binary(BenchmarkRun &p_run) {
+    _resource_save(p_run, "res");
+}
+
+void _resource_load_binary(BenchmarkRun &p_run) {
+    _resource_load(p_run, "res");
+}
+
+void _resource_save_text(BenchmarkRun &p_run) {
+    _resource_save(p_run, "tres");
+}
+
+void _resource_load_text(BenchmarkRun &p_run) {
+    _resource_load(p_run, "tres");
+}
+
+const BenchmarkCase benchmark_cases[] = {
+    { "core/variant_less_int", _variant_less_int },
+    { "core/variant_equal_string", _variant_equal_string },
+    { "core/variant_roundtrip_vector3", _variant_roundtrip_vector3 },
+    { "core/string_name_intern", _string_name_intern },
+    { "core/object_db_get_instance", _object_db_get_instance },
+    { "core/object_create_free", _object_create_free },
+    { "core/signal_emit", _signal_emit },
+    { "core/json_parse_1mb", _json_parse },
+    { "core/json_print_1mb", _json_print },
+    { "core/json_writer_reuse_1mb", _json_writer_reuse },
+    { "scene/instance_64_nodes", _scene_instance },
+    { "scene/instance_many_64_nodes", _scene_instance_many },
+    { "physics/step_512_boxes", _physics_step },
+    { "navigation/path_64x64_grid", _navigation_path },
+    { "audio/mix_1024_frames", _audio_mix },
+    { "image/resize_1024_to_512", _image_resize },
+    { "image/resize_cubic_1024_to_2048_serial", _image_resize_cubic_serial },
+    { "image/resize_cubic_1024_to_2048_threaded", _image_resize_cubic_threaded },
+    { "image/mipmaps_2048_serial", _image_mipmaps_serial },
+    { "image/mipmaps_2048_threaded", _image_mipmaps_threaded },
+    { "image/compress_etc2_512", _image_compress },
+    { "resource/save_binary_mesh", _resource_save_binary },
+    { "resource/load_binary_mesh", _resource_load_binary },
+    { "resource/save_text_mesh", _resource_save_text },
+    { "resource/load_text_mesh", _resource_load_text },
+    { nullptr, nullptr }
+};
+
+} // namespace
+
+const BenchmarkCase *benchmarks_get_cases() {
+    return benchmark_cases;
+}
@@ -0,0 +1,114 @@
+/*************************************************************************/
+/*  benchmark_runner.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "benchmark_runner.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "core/version.h"
+
+#include "EASTL/sort.h"
+
+namespace {
+
+// Nearest rank percentile of sorted samples.
+double _percentile(const Vector<double> &p_sorted, double p_fraction) {
+    int rank = int(Math::ceil(p_fraction * p_sorted.size())) - 1;
+    return p_sorted[CLAMP(rank, 0, int(p_sorted.size()) - 1)];
+}
+
+} // namespace
+
+int benchmarks_run(const String &p_filter, const String &p_output, int p_repetitions) {
+
+    ERR_FAIL_COND_V_MSG(p_repetitions <= 0, 1, "Benchmark repetitions must be positive.");
+
+    String json;
+    json += "{\n";
+    json.append_sprintf("  \"engine\": \"%s\",\n", VERSION_FULL_BUILD);
+    json.append_sprintf("  \"processor_count\": %d,\n", OS::get_singleton()->get_processor_count());
+    json.append_sprintf("  \"repetitions\": %d,\n", p_repetitions);
+    json += "  \"unit\": \"ns/op\",\n";
+    json += "  \"benchmarks\": [";
+
+    int count = 0;
+    for (const BenchmarkCase *c = benchmarks_get_cases(); c->name; c++) {
+        if (!p_filter.empty() && !StringUtils::contains(c->name, p_filter))
+            continue;
+
+        // progress goes to stderr, stdout may be the result
+        OS::get_singleton()->printerr(FormatVE("Benchmark %s...\n", c->name));
+        BenchmarkRun run(p_repetitions);
+        c->func(run);
+
+        json += count ? ",\n" : "\n";
+        count++;
+        json.append_sprintf("    {\"name\": \"%s\", ", c->name);
+        if (!run.skip_reason.empty() || run.samples.empty()) {
+            String reason = run.skip_reason.empty() ? String("nothing was measured") : run.skip_reason;
+            json.append_sprintf("\"skipped\": \"%s\"}", StringUtils::json_escape(reason).c_str());
+            continue;
+        }
+
+        Vector<double> &sorted = run.samples;
+        eastl::sort(sorted.begin(), sorted.end());
+        double sum = 0;
+        for (double s : sorted) {
+            sum += s;
+        }
+        json.append_sprintf("\"samples\": %d, \"batch\": %llu, \"mean\": %.3f, \"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+                int(sorted.size()), (unsigned long long)run.batch, sum / sorted.size(), sorted.front(),
+                _percentile(sorted, 0.5), _percentile(sorted, 0.9), _percentile(sorted, 0.99), sorted.back());
+    }
+    json += "\n  ]\n}\n";
+
+    if (count == 0) {
+        OS::get_singleton()->printerr(FormatVE("No benchmark matches '%s'.\n", p_filter.c_str()));
+        return 1;
+    }
+
+    if (p_output.empty()) {
+        OS::get_singleton()->print(json);
+        return 0;
+    }
+
+    Error err;
+    FileAccess *f = FileAccess::open(p_output, FileAccess::WRITE, &err);
+    ERR_FAIL_COND_V_MSG(!f, 1, "Cannot write benchmark results to '" + p_output + "'.");
+    f->store_string(json);
+    memdelete(f);
+    print_line(FormatVE("Benchmark results written to '%s'.", p_output.c_str()));
+    return 0;
+}
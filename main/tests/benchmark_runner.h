@@ -0,0 +1,124 @@
+/*************************************************************************/
+/*  benchmark_runner.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/error_macros.h"
+#include "core/frame_profiler.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+/**
+ * Single benchmark execution. The benchmark function prepares its data and then passes the operation to
+ * measure(), which runs it in batches long enough to time reliably: a few warmup batches, then the requested
+ * number of repetitions, each one giving a nanoseconds per operation sample.
+ */
+class BenchmarkRun {
+    friend int benchmarks_run(const String &, const String &, int);
+
+    enum : uint64_t {
+        MIN_SAMPLE_NSEC = 2000000, // shorter batches are dominated by timer resolution
+        TIME_BUDGET_NSEC = 10000000000, // slow benchmarks stop after this, with at least MIN_SAMPLES samples
+        MIN_SAMPLES = 5,
+        WARMUP_BATCHES = 3,
+    };
+
+    Vector<double> samples;
+    uint64_t batch = 0;
+    int repetitions;
+    String skip_reason;
+
+    explicit BenchmarkRun(int p_repetitions) :
+            repetitions(p_repetitions) {}
+
+    template <class F>
+    static uint64_t _time_batch(F &p_op, uint64_t p_batch) {
+        const uint64_t begin = FrameProfiler::get_ticks_nsec();
+        for (uint64_t i = 0; i < p_batch; i++) {
+            p_op();
+        }
+        return FrameProfiler::get_ticks_nsec() - begin;
+    }
+
+public:
+    template <class F>
+    void measure(F &&p_op) {
+        ERR_FAIL_COND_MSG(batch != 0, "A benchmark can only measure once.");
+
+        batch = 1;
+        while (batch < (uint64_t(1) << 32)) {
+            const uint64_t nsec = _time_batch(p_op, batch);
+            if (nsec >= MIN_SAMPLE_NSEC)
+                break;
+            // aim a bit over the minimum, at most growing 100x per step in case the first runs were cold
+            const uint64_t estimate = nsec ? batch * MIN_SAMPLE_NSEC * 5 / (nsec * 4) + 1 : batch * 100;
+            batch = MIN(estimate, batch * 100);
+        }
+        for (int i = 0; i < WARMUP_BATCHES; i++) {
+            _time_batch(p_op, batch);
+        }
+
+        const uint64_t begin = FrameProfiler::get_ticks_nsec();
+        samples.reserve(repetitions);
+        for (int i = 0; i < repetitions; i++) {
+            samples.push_back(double(_time_batch(p_op, batch)) / double(batch));
+            if (samples.size() >= MIN_SAMPLES && FrameProfiler::get_ticks_nsec() - begin > TIME_BUDGET_NSEC)
+                break;
+        }
+    }
+    //! Reports the benchmark as skipped, e.g. when the feature it measures is not compiled in.
+    void skip(StringView p_reason) { skip_reason = p_reason; }
+};
+
+//! Keeps the compiler from optimizing away the computation of p_value.
+template <class T>
+_FORCE_INLINE_ void benchmark_keep(const T &p_value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&p_value) : "memory");
+#else
+    static const volatile void *sink;
+    sink = &p_value;
+#endif
+}
+
+struct BenchmarkCase {
+    const char *name;
+    void (*func)(BenchmarkRun &);
+};
+
+//! All registered benchmarks, terminated by an entry with a null name.
+const BenchmarkCase *benchmarks_get_cases();
+
+/**
+ * Runs the benchmarks whose name contains p_filter (all when empty) and writes the results as JSON to p_output,
+ * or stdout when it is empty. Returns the process exit code.
+ */
+int benchmarks_run(const String &p_filter, const String &p_output, int p_repetitions);
@@ -775,7 +775,7 @@ Error Main::setup(bool p_second_phase) {
 #endif
     }
 
-    GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
+    GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 256);
     ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc",
             PropertyInfo(VariantType::INT, "memory/limits/multithreaded_server/rid_pool_prealloc", PropertyHint::Range,
                     "0,500,1")); // No negative and limit to 500 due to crashes
@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  test_compression.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_compression.h"
+#include "test_check.h"
+
+#include "core/io/compression.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/vector.h"
+
+namespace TestCompression {
+
+// text-like data with repeated structure, roughly what serialized resources look like
+static Vector<uint8_t> _make_payload(int p_size, uint32_t p_seed) {
+
+    static const char *words[] = { "position", "rotation", "scale", "material", "resource_local_to_scene", "Vector3(", "0.5", "1.0", ", ", "\n" };
+    Vector<uint8_t> data;
+    data.reserve(p_size);
+    uint32_t seed = p_seed;
+    while (int(data.size()) < p_size) {
+        seed = seed * 1664525 + 1013904223;
+        const char *word = words[(seed >> 16) % 10];
+        for (const char *c = word; *c && int(data.size()) < p_size; c++) {
+            data.push_back(uint8_t(*c));
+        }
+        data.push_back(uint8_t('0' + (seed >> 28)));
+    }
+    data.resize(p_size);
+    return data;
+}
+
+static bool _test_modes() {
+
+    const Vector<uint8_t> src = _make_payload(100000, 1);
+    const Compression::Mode modes[] = { Compression::MODE_FASTLZ, Compression::MODE_DEFLATE, Compression::MODE_ZSTD, Compression::MODE_GZIP };
+    const char *names[] = { "FastLZ", "Deflate", "zstd", "gzip" };
+    bool passed = true;
+    for (int i = 0; i < 4; i++) {
+        Vector<uint8_t> comp;
+        comp.resize(Compression::get_max_compressed_buffer_size(src.size(), modes[i]));
+        // repeat so the zstd path runs on an already cached context
+        int size = 0;
+        for (int j = 0; j < 2; j++) {
+            size = Compression::compress(comp.data(), src.data(), src.size(), modes[i]);
+        }
+        Vector<uint8_t> dst;
+        dst.resize(src.size());
+        int out = Compression::decompress(dst.data(), dst.size(), comp.data(), size, modes[i]);
+        CHECK(size > 0 && out == int(src.size()) && dst == src);
+        print_line(FormatVE("%-8s %7d -> %7d bytes", names[i], int(src.size()), size));
+    }
+    return passed;
+}
+
+static bool _test_dictionary() {
+
+    // many small packets sharing structure, the case dictionaries are meant for
+    Vector<Vector<uint8_t>> samples;
+    for (int i = 0; i < 64; i++) {
+        samples.push_back(_make_payload(300, 100 + i));
+    }
+    Vector<uint8_t> content = CompressionDictionary::build_from_samples(samples, 16 * 1024);
+    CompressionDictionary dict;
+    bool passed = true;
+    CHECK(dict.create(content.data(), content.size()) == OK);
+    if (!passed) {
+        return false;
+    }
+
+    int plain_total = 0;
+    int dict_total = 0;
+    for (int i = 0; i < 32; i++) {
+        Vector<uint8_t> packet = _make_payload(300, 1000 + i);
+        Vector<uint8_t> comp;
+        comp.resize(Compression::get_max_compressed_buffer_size(packet.size()));
+        plain_total += Compression::compress(comp.data(), packet.data(), packet.size());
+        int size = Compression::compress_zstd(comp.data(), packet.data(), packet.size(), &dict);
+        dict_total += size;
+
+        Vector<uint8_t> dst;
+        dst.resize(packet.size());
+        CHECK(Compression::decompress_zstd(dst.data(), dst.size(), comp.data(), size, &dict) == int(packet.size()) && dst == packet);
+    }
+    CHECK(dict_total < plain_total);
+    print_line(FormatVE("Dictionary: 32 packets %d bytes without, %d bytes with dictionary", plain_total, dict_total));
+    return passed;
+}
+
+static bool _test_stream() {
+
+    const Vector<uint8_t> src = _make_payload(1 << 20, 7);
+    ZstdCompressStream cs;
+    Vector<uint8_t> comp;
+    bool passed = true;
+    CHECK(cs.begin() == OK);
+    // odd piece sizes to cross internal block boundaries
+    for (size_t ofs = 0; passed && ofs < src.size(); ofs += 7777) {
+        CHECK(cs.write(src.data() + ofs, int(MIN(size_t(7777), src.size() - ofs)), comp) == OK);
+    }
+    CHECK(cs.finish(comp) == OK);
+
+    ZstdDecompressStream ds;
+    Vector<uint8_t> dst;
+    CHECK(ds.begin() == OK);
+    for (size_t ofs = 0; passed && ofs < comp.size(); ofs += 1000) {
+        CHECK(ds.write(comp.data() + ofs, int(MIN(size_t(1000), comp.size() - ofs)), dst) == OK);
+    }
+    CHECK(ds.is_frame_finished() && dst == src);
+    print_line(FormatVE("Stream: %d -> %d bytes", int(src.size()), int(comp.size())));
+    return passed;
+}
+
+static bool _test_parallel() {
+
+    const Vector<uint8_t> src = _make_payload(32 << 20, 3);
+    OS *os = OS::get_singleton();
+
+    Vector<uint8_t> serial;
+    serial.resize(Compression::get_max_compressed_buffer_size(src.size()));
+    uint64_t t = os->get_ticks_usec();
+    int serial_size = Compression::compress(serial.data(), src.data(), src.size());
+    uint64_t serial_usec = os->get_ticks_usec() - t;
+
+    Vector<uint8_t> parallel;
+    t = os->get_ticks_usec();
+    int parallel_size = Compression::compress_zstd_parallel(parallel, src.data(), src.size());
+    uint64_t parallel_usec = os->get_ticks_usec() - t;
+
+    Vector<uint8_t> dst;
+    dst.resize(src.size());
+    t = os->get_ticks_usec();
+    int out = Compression::decompress_zstd_parallel(dst.data(), dst.size(), parallel.data(), parallel_size);
+    uint64_t decompress_usec = os->get_ticks_usec() - t;
+    bool passed = true;
+    CHECK(out == int(src.size()) && dst == src);
+
+    // the chunked output is plain concatenated frames, readable by the regular path too
+    memset(dst.data(), 0, dst.size());
+    CHECK(Compression::decompress(dst.data(), dst.size(), parallel.data(), parallel_size) == int(src.size()) && dst == src);
+
+    print_line(FormatVE("Parallel (%d threads): serial %d bytes %.1f ms, chunked %d bytes %.1f ms, decompress %.1f ms",
+            WorkerThreadPool::get_singleton()->get_thread_count() + 1, serial_size, serial_usec / 1000.0, parallel_size,
+            parallel_usec / 1000.0, decompress_usec / 1000.0));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Compression");
+    bool passed = true;
+    CHECK(_test_modes());
+    CHECK(_test_dictionary());
+    CHECK(_test_stream());
+    CHECK(_test_parallel());
+    print_line(String("Compression: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestCompression
@@ -0,0 +1,150 @@
+/*************************************************************************/
+/*  test_entity_world.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_entity_world.h"
+#include "test_check.h"
+
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/vector.h"
+#include "scene/3d/entity_world_3d.h"
+#include "scene/3d/mesh_instance_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/primitive_meshes.h"
+#include "scene/resources/world_3d.h"
+
+namespace TestEntityWorld {
+
+enum {
+    OBJECT_COUNT = 100000,
+    FRAME_COUNT = 10
+};
+
+static Vector3 _object_position(int p_index) {
+    return Vector3(p_index % 100, (p_index / 100) % 100, p_index / 10000);
+}
+
+static Vector3 _object_velocity(int p_index) {
+    return Vector3(0, -1.0f - (p_index % 7), 0.5f);
+}
+
+// The same objects as MeshInstance3D nodes, moved by setting their translation every frame.
+static void _benchmark_nodes(SceneTree *p_tree, const Ref<Mesh> &p_mesh, float p_delta) {
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    Node3D *holder = memnew(Node3D);
+    p_tree->get_root()->add_child(holder);
+    Vector<MeshInstance3D *> nodes;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        MeshInstance3D *mi = memnew(MeshInstance3D);
+        mi->set_mesh(p_mesh);
+        mi->set_translation(_object_position(i));
+        holder->add_child(mi);
+        nodes.push_back(mi);
+    }
+    p_tree->flush_transform_notifications();
+    uint64_t create_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+    t = OS::get_singleton()->get_ticks_usec();
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            nodes[i]->set_translation(nodes[i]->get_translation() + _object_velocity(i) * p_delta);
+        }
+        p_tree->flush_transform_notifications();
+    }
+    uint64_t frame_usec = (OS::get_singleton()->get_ticks_usec() - t) / FRAME_COUNT;
+
+    t = OS::get_singleton()->get_ticks_usec();
+    memdelete(holder);
+    uint64_t free_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+    print_line(FormatVE("Node3D:        create %8.2f ms, frame %7.2f ms, free %8.2f ms", create_usec / 1000.0, frame_usec / 1000.0, free_usec / 1000.0));
+}
+
+static bool _benchmark_entities(const Ref<World3D> &p_world, const Ref<Mesh> &p_mesh, float p_delta) {
+
+    EntityWorld3D *world = memnew(EntityWorld3D(p_world));
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    Vector<entt::entity> entities;
+    for (int i = 0; i < OBJECT_COUNT; i++) {
+        entt::entity e = world->create_entity(Transform(Basis(), _object_position(i)));
+        world->set_mesh(e, p_mesh->get_rid());
+        world->set_velocity(e, _object_velocity(i));
+        entities.push_back(e);
+    }
+    world->sync_transforms();
+    uint64_t create_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+    t = OS::get_singleton()->get_ticks_usec();
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        world->integrate(p_delta);
+        world->sync_transforms();
+    }
+    uint64_t frame_usec = (OS::get_singleton()->get_ticks_usec() - t) / FRAME_COUNT;
+
+    bool passed = true;
+    CHECK(world->get_entity_count() == OBJECT_COUNT);
+    for (int i = 0; i < OBJECT_COUNT; i += 997) {
+        Vector3 expected = _object_position(i) + _object_velocity(i) * p_delta * FRAME_COUNT;
+        CHECK(world->get_transform(entities[i]).origin.distance_to(expected) < 0.001f);
+    }
+
+    t = OS::get_singleton()->get_ticks_usec();
+    memdelete(world);
+    uint64_t free_usec = OS::get_singleton()->get_ticks_usec() - t;
+
+    print_line(FormatVE("EntityWorld3D: create %8.2f ms, frame %7.2f ms, free %8.2f ms", create_usec / 1000.0, frame_usec / 1000.0, free_usec / 1000.0));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line(FormatVE("\n*** Entity world, %d moving meshes, %d frames", int(OBJECT_COUNT), int(FRAME_COUNT)));
+
+    SceneTree *tree = memnew(SceneTree);
+    tree->init();
+
+    Ref<CubeMesh> mesh(make_ref_counted<CubeMesh>());
+    const float delta = 1.0f / 60.0f;
+
+    _benchmark_nodes(tree, mesh, delta);
+    bool passed = _benchmark_entities(tree->get_root()->find_world(), mesh, delta);
+
+    tree->finish();
+    memdelete(tree);
+
+    print_line(String("Entity world: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestEntityWorld
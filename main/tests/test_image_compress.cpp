@@ -0,0 +1,125 @@
+/*************************************************************************/
+/*  test_image_compress.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_image_compress.h"
+#include "test_check.h"
+
+#include "core/image.h"
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/vector.h"
+
+namespace TestImageCompress {
+
+static Ref<Image> _make_source(int p_size) {
+
+    PoolVector<uint8_t> data;
+    data.resize(p_size * p_size * 4);
+    {
+        PoolVector<uint8_t>::Write w = data.write();
+        uint32_t seed = 12345;
+        for (int y = 0; y < p_size; y++) {
+            for (int x = 0; x < p_size; x++) {
+                // smooth gradients with a bit of noise, closer to real textures than pure noise
+                uint8_t *px = &w[(y * p_size + x) * 4];
+                seed = seed * 1664525 + 1013904223;
+                int noise = (seed >> 24) & 15;
+                px[0] = uint8_t((x * 255 / p_size + noise) & 255);
+                px[1] = uint8_t((y * 255 / p_size + noise) & 255);
+                px[2] = uint8_t(((x ^ y) & 255));
+                px[3] = uint8_t(128 + 127 * Math::sin(x * 0.05f) * Math::cos(y * 0.05f));
+            }
+        }
+    }
+    Ref<Image> img(make_ref_counted<Image>(p_size, p_size, false, Image::FORMAT_RGBA8, data));
+    img->generate_mipmaps();
+    return img;
+}
+
+static bool _bench_mode(const Ref<Image> &p_source, ImageCompressMode p_mode, const char *p_name) {
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    pool->set_thread_count(-1);
+    const int max_threads = pool->get_thread_count();
+    const double mpix = p_source->get_data().size() / 4 / 1000000.0;
+
+    PoolVector<uint8_t> reference;
+    bool passed = true;
+    // 0 worker threads is the serial baseline, the calling thread always takes part as well
+    FixedVector<int, 8, true> thread_counts;
+    for (int threads = 0; threads < max_threads; threads = threads ? threads * 2 : 1) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (int threads : thread_counts) {
+        pool->set_thread_count(threads);
+
+        Ref<Image> img = dynamic_ref_cast<Image>(p_source->duplicate());
+        uint64_t t = OS::get_singleton()->get_ticks_usec();
+        Error err = img->compress_from_channels(p_mode, ImageUsedChannels::USED_CHANNELS_RGBA);
+        uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+        if (err != OK) {
+            print_line(FormatVE("%-6s unavailable", p_name));
+            pool->set_thread_count(-1);
+            return true;
+        }
+
+        if (threads == 0) {
+            reference = img->get_data();
+        } else {
+            CHECK(img->get_data().size() == reference.size() &&
+                    memcmp(img->get_data().read().ptr(), reference.read().ptr(), reference.size()) == 0);
+        }
+        print_line(FormatVE("%-6s %2d threads %10.3f ms %8.2f MPix/s", p_name, threads + 1, usec / 1000.0, mpix * 1000000.0 / M_MAX(usec, uint64_t(1))));
+    }
+    pool->set_thread_count(-1);
+
+    print_line(FormatVE("%-6s output %s across thread counts", p_name, passed ? "identical" : "DIFFERS"));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Image compression");
+    Ref<Image> source = _make_source(1024);
+
+    bool passed = true;
+    CHECK(_bench_mode(source, COMPRESS_S3TC, "S3TC"));
+    CHECK(_bench_mode(source, COMPRESS_ETC2, "ETC2"));
+    CHECK(_bench_mode(source, COMPRESS_BPTC, "BPTC"));
+    print_line(String("Image compression: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestImageCompress
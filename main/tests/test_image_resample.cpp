@@ -0,0 +1,173 @@
+/*************************************************************************/
+/*  test_image_resample.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+
+#include "test_image_resample.h"
+#include "test_check.h"
+
+#include "core/image.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+
+#include <cstring>
+
+namespace TestImageResample {
+
+static Ref<Image> _make_source(int p_width, int p_height, Image::Format p_format) {
+
+    const bool is_float = p_format == Image::FORMAT_RGBAF;
+    PoolVector<uint8_t> data;
+    data.resize(p_width * p_height * (is_float ? 16 : 4));
+    {
+        PoolVector<uint8_t>::Write w = data.write();
+        uint32_t seed = 777;
+        for (int i = 0; i < p_width * p_height * 4; i++) {
+            seed = seed * 1664525 + 1013904223;
+            if (is_float) {
+                // outside of [0,1] as well, so clamping is compared too
+                float v = (seed >> 8) / float(1 << 24) * 2.0f - 0.5f;
+                memcpy(w.ptr() + i * 4, &v, 4);
+            } else {
+                w[i] = uint8_t(seed >> 24);
+            }
+        }
+    }
+    return make_ref_counted<Image>(p_width, p_height, false, p_format, data);
+}
+
+static bool _same_data(const Ref<Image> &p_a, const Ref<Image> &p_b) {
+
+    PoolVector<uint8_t> a = p_a->get_data();
+    PoolVector<uint8_t> b = p_b->get_data();
+    return p_a->get_width() == p_b->get_width() && p_a->get_height() == p_b->get_height() && a.size() == b.size() &&
+           memcmp(a.read().ptr(), b.read().ptr(), a.size()) == 0;
+}
+
+// Runs p_op on copies of p_source with 0 worker threads (everything on the calling thread) and then with more,
+// the results have to be identical. The serial and the fastest threaded time are printed as well.
+template <class F>
+static bool _compare(const char *p_name, const Ref<Image> &p_source, const F &p_op) {
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    pool->set_thread_count(-1);
+    const int max_threads = pool->get_thread_count();
+    const int thread_counts[] = { 0, 1, 3, max_threads };
+
+    Ref<Image> reference;
+    bool passed = true;
+    uint64_t serial_usec = 0;
+    uint64_t threaded_usec = ~uint64_t(0);
+    for (int threads : thread_counts) {
+        pool->set_thread_count(threads);
+        Ref<Image> img = dynamic_ref_cast<Image>(p_source->duplicate());
+        uint64_t t = OS::get_singleton()->get_ticks_usec();
+        p_op(img);
+        uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+        if (threads == 0) {
+            reference = img;
+            serial_usec = usec;
+        } else {
+            CHECK(_same_data(img, reference));
+            threaded_usec = MIN(threaded_usec, usec);
+        }
+    }
+    pool->set_thread_count(-1);
+
+    print_line(FormatVE("%-36s serial %9.3f ms, threaded %9.3f ms, output %s", p_name, serial_usec / 1000.0,
+            threaded_usec / 1000.0, passed ? "identical" : "DIFFERS"));
+    return passed;
+}
+
+static bool test_resize() {
+
+    bool passed = true;
+
+    struct Interpolation {
+        Image::Interpolation mode;
+        const char *name;
+    };
+    const Interpolation interpolations[] = {
+        { Image::INTERPOLATE_NEAREST, "nearest" },
+        { Image::INTERPOLATE_BILINEAR, "bilinear" },
+        { Image::INTERPOLATE_CUBIC, "cubic" },
+        { Image::INTERPOLATE_TRILINEAR, "trilinear" },
+        { Image::INTERPOLATE_LANCZOS, "lanczos" },
+    };
+    const Image::Format formats[] = { Image::FORMAT_RGBA8, Image::FORMAT_RGBAF };
+
+    for (Image::Format format : formats) {
+        const char *format_name = format == Image::FORMAT_RGBA8 ? "rgba8" : "rgbaf";
+        Ref<Image> up_source = _make_source(640, 480, format);
+        Ref<Image> down_source = _make_source(1600, 1200, format);
+        for (const Interpolation &interp : interpolations) {
+            String up_name = FormatVE("%s %s 640x480 -> 1200x900", format_name, interp.name);
+            CHECK(_compare(up_name.c_str(), up_source, [&](const Ref<Image> &p_img) { p_img->resize(1200, 900, interp.mode); }));
+            String down_name = FormatVE("%s %s 1600x1200 -> 600x450", format_name, interp.name);
+            CHECK(_compare(down_name.c_str(), down_source, [&](const Ref<Image> &p_img) { p_img->resize(600, 450, interp.mode); }));
+        }
+    }
+
+    print_line(String("Threaded resize: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+static bool test_mipmaps() {
+
+    bool passed = true;
+
+    struct Size {
+        int width;
+        int height;
+    };
+    // power of two, odd sizes, and chains that end up one pixel wide or high long before the last level
+    const Size sizes[] = { { 2048, 1024 }, { 1000, 600 }, { 1, 4096 }, { 4096, 3 } };
+    const Image::Format formats[] = { Image::FORMAT_RGBA8, Image::FORMAT_RGBAF };
+
+    for (Image::Format format : formats) {
+        for (const Size &size : sizes) {
+            Ref<Image> source = _make_source(size.width, size.height, format);
+            String name = FormatVE("%s mipmaps %dx%d", format == Image::FORMAT_RGBA8 ? "rgba8" : "rgbaf", size.width, size.height);
+            CHECK(_compare(name.c_str(), source, [](const Ref<Image> &p_img) { p_img->generate_mipmaps(); }));
+        }
+    }
+
+    print_line(String("Threaded mipmaps: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Image resampling");
+    test_resize();
+    test_mipmaps();
+    return nullptr;
+}
+} // namespace TestImageResample
@@ -0,0 +1,236 @@
+/*************************************************************************/
+/*  test_json.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+
+#include "test_json.h"
+#include "test_check.h"
+
+#include "core/array.h"
+#include "core/dictionary.h"
+#include "core/io/json.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/variant.h"
+
+#include <clocale>
+
+namespace TestJSON {
+
+static bool _parse(StringView p_text, Variant &r_value) {
+
+    String err_str;
+    int err_line = 0;
+    Error err = JSON::parse(p_text, r_value, err_str, err_line);
+    if (err != OK) {
+        print_line(FormatVE("\tparse error at line %d: %s", err_line, err_str.c_str()));
+        return false;
+    }
+    return true;
+}
+
+// Expects p_text to fail at p_line with p_message.
+static bool _fails(StringView p_text, int p_line, const char *p_message) {
+
+    Variant v;
+    String err_str;
+    int err_line = -1;
+    if (JSON::parse(p_text, v, err_str, err_line) != ERR_PARSE_ERROR)
+        return false;
+    if (err_line != p_line || err_str != p_message) {
+        print_line(FormatVE("\tgot error at line %d: %s", err_line, err_str.c_str()));
+        return false;
+    }
+    return true;
+}
+
+static bool _is_float(const Variant &p_value, double p_expected) {
+    return p_value.get_type() == VariantType::FLOAT && p_value.as<double>() == p_expected;
+}
+
+static bool test_strings() {
+
+    bool passed = true;
+    Variant v;
+
+    CHECK(_parse("\"plain\"", v) && v.as<String>() == "plain");
+    CHECK(_parse("\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"", v) && v.as<String>() == "\"\\/\b\f\n\r\t");
+    CHECK(_parse("\"\\u0041\\u00e9\\u20AC\"", v) && v.as<String>() == "A\xC3\xA9\xE2\x82\xAC");
+    // surrogate pair, then unpaired halves that become U+FFFD
+    CHECK(_parse("\"\\ud83d\\ude00\"", v) && v.as<String>() == "\xF0\x9F\x98\x80");
+    CHECK(_parse("\"\\ud83dx\"", v) && v.as<String>() == "\xEF\xBF\xBDx");
+    CHECK(_parse("\"\\ude00\"", v) && v.as<String>() == "\xEF\xBF\xBD");
+    CHECK(_parse("\"\\ud83d\\u0041\"", v) && v.as<String>() == "\xEF\xBF\xBD" "A");
+    // UTF-8 input is kept as is
+    CHECK(_parse("\"\xC3\xA9t\xC3\xA9\"", v) && v.as<String>() == "\xC3\xA9t\xC3\xA9");
+
+    CHECK(_fails("\"open", 0, "Unterminated String"));
+    CHECK(_fails("\"\\u12G4\"", 0, "Malformed hex constant in string"));
+    CHECK(_fails("\"\\u12", 0, "Unterminated String"));
+    return passed;
+}
+
+static bool test_numbers() {
+
+    bool passed = true;
+    Variant v;
+
+    // all numbers are floats, integers included
+    CHECK(_parse("42", v) && _is_float(v, 42));
+    CHECK(_parse("-7", v) && _is_float(v, -7));
+    CHECK(_parse("0", v) && _is_float(v, 0));
+    CHECK(_parse("0.1", v) && _is_float(v, 0.1));
+    CHECK(_parse("-2.5e-3", v) && _is_float(v, -2.5e-3));
+    CHECK(_parse("1E+3", v) && _is_float(v, 1000));
+    // beyond the exact fast path
+    CHECK(_parse("9007199254740993", v) && _is_float(v, 9007199254740992.0));
+    CHECK(_parse("123456789012345678901234567890", v) && _is_float(v, 123456789012345678901234567890.0));
+    CHECK(_parse("1.5e300", v) && _is_float(v, 1.5e300));
+
+    CHECK(_fails("-", 0, "Expected digit after '-'."));
+    CHECK(_fails("[1, -]", 0, "Expected digit after '-'."));
+    CHECK(_fails("-x", 0, "Expected digit after '-'."));
+    return passed;
+}
+
+static bool test_locale() {
+
+    bool passed = true;
+    const char *locales[] = { "de_DE.UTF-8", "fr_FR.UTF-8" };
+    for (const char *locale : locales) {
+        if (!setlocale(LC_NUMERIC, locale))
+            continue;
+        Variant v;
+        CHECK(_parse("1.5e300", v) && _is_float(v, 1.5e300));
+        CHECK(_parse("123456789012345678901.25", v) && _is_float(v, 123456789012345678901.25));
+        CHECK(_parse("[0.5, 2.25]", v) && v.as<Array>().size() == 2 && _is_float(v.as<Array>()[1], 2.25));
+    }
+    setlocale(LC_NUMERIC, "C");
+    return passed;
+}
+
+static bool test_structure() {
+
+    bool passed = true;
+    Variant v;
+
+    CHECK(_parse(" {\n\t\"a\": [1, 2, {\"b\": null}],\n\t\"c\": true, \"d\": false\n} ", v));
+    Dictionary d = v.as<Dictionary>();
+    CHECK(d.size() == 3);
+    CHECK(d["a"].as<Array>().size() == 3);
+    CHECK(d["a"].as<Array>()[2].as<Dictionary>()["b"].get_type() == VariantType::NIL);
+    CHECK(d["c"].as<bool>() && !d["d"].as<bool>());
+
+    // trailing commas are accepted in arrays and objects
+    CHECK(_parse("[1, 2,]", v) && v.as<Array>().size() == 2);
+    CHECK(_parse("{\"a\": 1,}", v) && v.as<Dictionary>().size() == 1);
+    CHECK(_parse("[]", v) && v.as<Array>().empty());
+    CHECK(_parse("{}", v) && v.as<Dictionary>().empty());
+
+    // lines are counted from 0
+    CHECK(_fails("{\n\"a\": 1,\n\"b\" 2\n}", 2, "Expected ':'"));
+    CHECK(_fails("[1,\n2\n3]", 2, "Expected ','"));
+    CHECK(_fails("{\"a\": 1", 0, "Expected '}'"));
+    CHECK(_fails("[1, 2", 0, "Expected ']'"));
+    CHECK(_fails("{1: 2}", 0, "Expected key"));
+    CHECK(_fails("\n\n[,]", 2, "Expected value, got ','."));
+    CHECK(_fails("", 0, "Expected value, got EOF."));
+    CHECK(_fails("nope", 0, "Expected 'true','false' or 'null', got 'nope'."));
+    CHECK(_fails("[1 @]", 0, "Unexpected character."));
+    return passed;
+}
+
+static bool test_round_trip() {
+
+    bool passed = true;
+
+    Array list;
+    list.push_back(0.5);
+    list.push_back(-1024.0);
+    list.push_back("tab\tquote\"back\\slash\nnewline");
+    list.push_back(Variant());
+    Dictionary inner;
+    inner["x"] = 1.25;
+    inner["y"] = false;
+    Dictionary doc;
+    doc["list"] = list;
+    doc["inner"] = inner;
+    doc["name"] = "\xC3\xA9t\xC3\xA9";
+
+    // streamed and whole values give the same text as JSON::print
+    const char *indents[] = { "", "\t" };
+    for (const char *indent : indents) {
+        JSONWriter writer(indent);
+        writer.begin_object();
+        writer.key("inner");
+        writer.value(inner);
+        writer.key("list");
+        writer.begin_array();
+        for (int i = 0; i < list.size(); i++) {
+            writer.value(list[i]);
+        }
+        writer.end_array();
+        writer.key("name");
+        writer.value(doc["name"]);
+        writer.end_object();
+        const String text = writer.take_text();
+        CHECK(text == JSON::print(doc, indent));
+
+        Variant parsed;
+        CHECK(_parse(text, parsed));
+        CHECK(JSON::print(parsed, indent) == text);
+        Dictionary pd = parsed.as<Dictionary>();
+        CHECK(pd["name"].as<String>() == doc["name"].as<String>());
+        CHECK(pd["list"].as<Array>()[2].as<String>() == list[2].as<String>());
+        CHECK(_is_float(pd["inner"].as<Dictionary>()["x"], 1.25));
+    }
+
+    // the buffer is reused after clear()
+    JSONWriter writer;
+    writer.value(list);
+    writer.clear();
+    writer.value(1.5);
+    CHECK(writer.get_text() == "1.5");
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** JSON");
+    bool passed = true;
+    passed &= test_strings();
+    passed &= test_numbers();
+    passed &= test_locale();
+    passed &= test_structure();
+    passed &= test_round_trip();
+    print_line(String("JSON: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestJSON
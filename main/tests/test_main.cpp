@@ -35,13 +35,30 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_compression.h"
+#include "test_entity_world.h"
 #include "test_gui.h"
+#include "test_image_compress.h"
+#include "test_image_resample.h"
+#include "test_json.h"
+#include "test_marshalls.h"
 #include "test_math.h"
+#include "test_memory.h"
+#include "test_mesh_optimizer.h"
+#include "test_net_socket_poller.h"
 #include "test_oa_hash_map.h"
+#include "test_parallel_process.h"
+#include "test_payload_streamer.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_pool_vector.h"
 #include "test_render.h"
+#include "test_replication.h"
+#include "test_resource_binary.h"
+#include "test_shader_cache.h"
 #include "test_shader_lang.h"
+#include "test_texture_streaming.h"
+#include "test_variant_parser.h"
 //#include "test_string.h"
 
 const char **tests_get_names() {
@@ -49,18 +66,35 @@ const char **tests_get_names() {
     static const char *test_names[] = {
 //		"string",
         "math",
+        "memory",
         "physics",
         "physics_2d",
         "render",
         "oa_hash_map",
+        "pool_vector",
+        "image_compress",
+        "image_resample",
+        "mesh_optimizer",
+        "entity_world",
         "gui",
         "shaderlang",
+        "shader_cache",
+        "variant_parser",
+        "json",
         "gd_tokenizer",
         "gd_parser",
         "gd_compiler",
         "gd_bytecode",
         "ordered_hash_map",
         "astar",
+        "net_socket_poller",
+        "replication",
+        "parallel_process",
+        "compression",
+        "marshalls",
+        "resource_binary",
+        "payload_streamer",
+        "texture_streaming",
         nullptr
     };
 
@@ -79,6 +113,11 @@ MainLoop *test_main(const String& p_test, const Vector<String> &p_args) {
         return TestMath::test();
     }
 
+    if (p_test == "memory") {
+
+        return TestMemory::test();
+    }
+
     if (p_test == "physics") {
 
         return TestPhysics::test();
@@ -100,22 +139,102 @@ MainLoop *test_main(const String& p_test, const Vector<String> &p_args) {
     }
 
 #ifndef _3D_DISABLED
+    if (p_test == "pool_vector") {
+
+        return TestPoolVector::test();
+    }
+
     if (p_test == "gui") {
 
         return TestGUI::test();
     }
+
+    if (p_test == "entity_world") {
+
+        return TestEntityWorld::test();
+    }
 #endif
 
+    if (p_test == "image_compress") {
+
+        return TestImageCompress::test();
+    }
+
+    if (p_test == "image_resample") {
+
+        return TestImageResample::test();
+    }
+
+    if (p_test == "mesh_optimizer") {
+
+        return TestMeshOptimizer::test();
+    }
+
     if (p_test == "shaderlang") {
 
         return TestShaderLang::test();
     }
 
+    if (p_test == "shader_cache") {
+
+        return TestShaderCache::test();
+    }
+
+    if (p_test == "variant_parser") {
+
+        return TestVariantParser::test();
+    }
+
+    if (p_test == "json") {
+
+        return TestJSON::test();
+    }
+
     if (p_test == "astar") {
 
         return TestAStar::test();
     }
 
+    if (p_test == "net_socket_poller") {
+
+        return TestNetSocketPoller::test();
+    }
+
+    if (p_test == "replication") {
+
+        return TestReplication::test();
+    }
+
+    if (p_test == "parallel_process") {
+
+        return TestParallelProcess::test();
+    }
+
+    if (p_test == "compression") {
+
+        return TestCompression::test();
+    }
+
+    if (p_test == "marshalls") {
+
+        return TestMarshalls::test();
+    }
+
+    if (p_test == "resource_binary") {
+
+        return TestResourceBinary::test();
+    }
+
+    if (p_test == "payload_streamer") {
+
+        return TestPayloadStreamer::test();
+    }
+
+    if (p_test == "texture_streaming") {
+
+        return TestTextureStreaming::test();
+    }
+
     print_line("Unknown test: " + p_test);
     return nullptr;
 }
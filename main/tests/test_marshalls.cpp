@@ -0,0 +1,231 @@
+/*************************************************************************/
+/*  test_marshalls.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_marshalls.h"
+#include "test_check.h"
+
+#include "core/array.h"
+#include "core/color.h"
+#include "core/dictionary.h"
+#include "core/io/marshalls.h"
+#include "core/math/transform.h"
+#include "core/node_path.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/variant.h"
+
+namespace TestMarshalls {
+
+static Vector<Variant> _make_values() {
+
+    Vector<Variant> values;
+    values.push_back(Variant());
+    values.push_back(true);
+    values.push_back(false);
+    values.push_back(7);
+    values.push_back(-123456);
+    values.push_back(int64_t(1) << 40);
+    values.push_back(0.5f);
+    values.push_back(0.1); // needs 64 bits
+    values.push_back(String("hello"));
+    values.push_back(String("four"));
+    values.push_back(StringName("a_string_name"));
+    values.push_back(Vector2(1, 2));
+    values.push_back(Vector3(1, 2, 3));
+    values.push_back(Transform(Basis(Vector3(0, 1, 0), 0.5f), Vector3(4, 5, 6)));
+    values.push_back(Color(0.1f, 0.2f, 0.3f, 1));
+    values.push_back(NodePath("/root/Level/Player:position"));
+
+    PoolVector<uint8_t> bytes;
+    PoolVector<int> ints;
+    PoolVector<Vector3> vertices;
+    PoolVector<String> strings;
+    for (int i = 0; i < 1001; i++) {
+        bytes.push_back(uint8_t(i));
+        ints.push_back(i * i - 500);
+        vertices.push_back(Vector3(i, i * 0.5f, -i));
+    }
+    for (int i = 0; i < 9; i++) {
+        strings.push_back(String(i, 'x'));
+    }
+    values.push_back(bytes);
+    values.push_back(ints);
+    values.push_back(vertices);
+    values.push_back(strings);
+
+    Array arr;
+    Dictionary dict;
+    for (int i = 0; i < 8; i++) {
+        arr.push_back(i);
+        arr.push_back(String("item"));
+        dict[i] = Vector2(i, i);
+    }
+    arr.push_back(Variant(dict));
+    values.push_back(Variant(arr));
+    values.push_back(Variant(dict));
+    return values;
+}
+
+static Vector<uint8_t> _encode_legacy(const Variant &p_value) {
+
+    int len = 0;
+    encode_variant(p_value, nullptr, len);
+    Vector<uint8_t> buf;
+    buf.resize(len);
+    encode_variant(p_value, buf.data(), len);
+    return buf;
+}
+
+static bool _test_round_trip(const Vector<Variant> &p_values) {
+
+    bool passed = true;
+    int standard_total = 0;
+    int compact_total = 0;
+    for (int i = 0; i < int(p_values.size()); i++) {
+        const Variant &value = p_values[i];
+        const bool was_passing = passed;
+
+        Vector<uint8_t> legacy = _encode_legacy(value);
+        Vector<uint8_t> arena;
+        arena.push_back(0xAB); // appending must leave existing content alone
+        CHECK(encode_variant(value, arena) == OK && arena[0] == 0xAB);
+        arena.erase(arena.begin());
+        CHECK(arena == legacy);
+
+        Variant decoded;
+        int used = 0;
+        CHECK(decode_variant(decoded, arena.data(), arena.size(), &used) == OK && used == int(arena.size()));
+        CHECK(_encode_legacy(decoded) == legacy);
+
+        Vector<uint8_t> compact;
+        CHECK(encode_variant_compact(value, compact) == OK);
+        Variant compact_decoded;
+        CHECK(decode_variant_compact(compact_decoded, compact.data(), compact.size(), &used) == OK && used == int(compact.size()));
+        // compare through the standard encoding, which is deep for containers
+        CHECK(_encode_legacy(compact_decoded) == legacy);
+        // truncated input must be rejected, not read past the end
+        CHECK(compact.size() < 2 || decode_variant_compact(compact_decoded, compact.data(), compact.size() - 1) != OK);
+
+        standard_total += arena.size();
+        compact_total += compact.size();
+        if (was_passing && !passed) {
+            print_line(FormatVE("\tfirst failure with value %d (%s)", i, Variant::get_type_name(value.get_type())));
+        }
+    }
+    print_line(FormatVE("Round trip: %d values, standard %d bytes, compact %d bytes", int(p_values.size()), standard_total, compact_total));
+    return passed;
+}
+
+static bool _test_view() {
+
+    PoolVector<Vector3> vertices;
+    for (int i = 0; i < 100; i++) {
+        vertices.push_back(Vector3(i, 2 * i, 3 * i));
+    }
+    Vector<uint8_t> buf;
+    encode_variant(vertices, buf);
+
+    bool passed = true;
+    EncodedPackedArray view;
+    int used = 0;
+    CHECK(decode_packed_array_view(view, buf.data(), buf.size(), &used) == OK);
+    CHECK(used == int(buf.size()) && view.type == VariantType::POOL_VECTOR3_ARRAY && view.count == 100);
+    CHECK(view.data >= buf.data() && view.data + view.count * view.element_size <= buf.data() + buf.size());
+    CHECK(passed && memcmp(view.data, vertices.read().ptr(), view.count * view.element_size) == 0);
+    CHECK(decode_packed_array_view(view, buf.data(), buf.size() - 4) != OK);
+    print_line(String("Packed array view: ") + (passed ? "ok" : "FAILED"));
+    return passed;
+}
+
+static void _bench(const Vector<Variant> &p_args) {
+
+    // a typical RPC: a few small arguments, encoded many times
+    const int iterations = 100000;
+    OS *os = OS::get_singleton();
+    Vector<uint8_t> legacy_buf;
+    uint64_t t = os->get_ticks_usec();
+    for (int i = 0; i < iterations; i++) {
+        size_t ofs = 0;
+        for (const Variant &arg : p_args) {
+            int len;
+            encode_variant(arg, nullptr, len);
+            if (legacy_buf.size() < ofs + len)
+                legacy_buf.resize(ofs + len);
+            encode_variant(arg, &legacy_buf[ofs], len);
+            ofs += len;
+        }
+    }
+    uint64_t legacy_usec = os->get_ticks_usec() - t;
+
+    Vector<uint8_t> arena;
+    t = os->get_ticks_usec();
+    for (int i = 0; i < iterations; i++) {
+        arena.clear();
+        for (const Variant &arg : p_args) {
+            encode_variant(arg, arena);
+        }
+    }
+    uint64_t arena_usec = os->get_ticks_usec() - t;
+    const int standard_size = arena.size();
+
+    t = os->get_ticks_usec();
+    for (int i = 0; i < iterations; i++) {
+        arena.clear();
+        for (const Variant &arg : p_args) {
+            encode_variant_compact(arg, arena);
+        }
+    }
+    uint64_t compact_usec = os->get_ticks_usec() - t;
+
+    print_line(FormatVE("Encode %d RPCs: two pass %.1f ms, single pass %.1f ms (%d bytes), compact %.1f ms (%d bytes)",
+            iterations, legacy_usec / 1000.0, arena_usec / 1000.0, standard_size, compact_usec / 1000.0, int(arena.size())));
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Variant marshalling");
+    bool passed = true;
+    CHECK(_test_round_trip(_make_values()));
+    CHECK(_test_view());
+
+    Vector<Variant> rpc_args;
+    rpc_args.push_back(Vector3(10.5f, 0, -3.25f));
+    rpc_args.push_back(42);
+    rpc_args.push_back(true);
+    rpc_args.push_back(String("jump"));
+    _bench(rpc_args);
+
+    print_line(String("Variant marshalling: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestMarshalls
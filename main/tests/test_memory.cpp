@@ -0,0 +1,133 @@
+/*************************************************************************/
+/*  test_memory.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+
+#include "test_memory.h"
+#include "test_check.h"
+
+#include "core/os/memory.h"
+#include "core/os/thread.h"
+
+#include <cstring>
+
+namespace TestMemory {
+
+static bool test_size_classes() {
+
+    bool passed = true;
+
+    // A freed small block is kept in the thread cache and handed out again for the same size class.
+    void *a = Memory::alloc_static(40);
+    Memory::free_static(a);
+    void *b = Memory::alloc_static(36);
+    CHECK(a == b);
+
+    // Growing within the size class keeps the block in place.
+    memset(b, 0x5a, 36);
+    void *c = Memory::realloc_static(b, 44);
+    CHECK(c == b);
+
+    // Moving to a larger class keeps the contents and the caller's padding.
+    uint8_t *d = (uint8_t *)Memory::alloc_static(20, true);
+    ((uint64_t *)d)[-1] = 0x1234567890ULL;
+    memset(d, 0x7e, 20);
+    d = (uint8_t *)Memory::realloc_static(d, 300, true);
+    CHECK(((uint64_t *)d)[-1] == 0x1234567890ULL);
+    CHECK(d[0] == 0x7e && d[19] == 0x7e);
+    d = (uint8_t *)Memory::realloc_static(d, 4000, true);
+    CHECK(((uint64_t *)d)[-1] == 0x1234567890ULL);
+    CHECK(d[0] == 0x7e && d[19] == 0x7e);
+
+    Memory::free_static(d, true);
+    Memory::free_static(c);
+    Memory::flush_thread_cache();
+
+    print_line(String("Size classes: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+static void *thread_block = nullptr;
+
+static void _alloc_thread(void *) {
+
+    MemoryTagScope mem_tag(MEM_TAG_NETWORK);
+    thread_block = Memory::alloc_static(1000);
+}
+
+static bool test_statistics() {
+
+    bool passed = true;
+
+    const uint64_t usage = Memory::get_tag_usage(MEM_TAG_NETWORK);
+    const uint64_t count = Memory::get_tag_alloc_count(MEM_TAG_NETWORK);
+
+    void *a = Memory::alloc_static(100, MEM_TAG_NETWORK);
+    CHECK(Memory::get_tag_usage(MEM_TAG_NETWORK) == usage + 100);
+    CHECK(Memory::get_tag_alloc_count(MEM_TAG_NETWORK) == count + 1);
+
+    // Resizing keeps the tag the block was allocated with.
+    a = Memory::realloc_static(a, 700);
+    CHECK(Memory::get_tag_usage(MEM_TAG_NETWORK) == usage + 700);
+    CHECK(Memory::get_mem_max_usage() >= Memory::get_mem_usage());
+    Memory::free_static(a);
+    CHECK(Memory::get_tag_usage(MEM_TAG_NETWORK) == usage);
+    CHECK(Memory::get_tag_alloc_count(MEM_TAG_NETWORK) == count);
+
+    {
+        MemoryTagScope outer(MEM_TAG_SCRIPT);
+        {
+            MemoryTagScope inner(MEM_TAG_NETWORK);
+            CHECK(Memory::get_thread_tag() == MEM_TAG_NETWORK);
+        }
+        CHECK(Memory::get_thread_tag() == MEM_TAG_SCRIPT);
+    }
+
+    // Usage of a thread that has exited is kept until its blocks are freed elsewhere.
+    Thread *thread = Thread::create(_alloc_thread, nullptr);
+    Thread::wait_to_finish(thread);
+    memdelete(thread);
+    CHECK(Memory::get_tag_usage(MEM_TAG_NETWORK) == usage + 1000);
+    Memory::free_static(thread_block);
+    CHECK(Memory::get_tag_usage(MEM_TAG_NETWORK) == usage);
+    CHECK(Memory::get_tag_alloc_count(MEM_TAG_NETWORK) == count);
+
+    print_line(String("Statistics: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Memory");
+    test_size_classes();
+    test_statistics();
+    return nullptr;
+}
+} // namespace TestMemory
@@ -0,0 +1,133 @@
+/*************************************************************************/
+/*  test_mesh_optimizer.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_mesh_optimizer.h"
+#include "test_check.h"
+
+#include "core/math/math_funcs.h"
+#include "core/math/mesh_optimizer.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/vector.h"
+
+#include "EASTL/sort.h"
+
+namespace TestMeshOptimizer {
+
+// Closed torus with its triangles shuffled, the worst case for the vertex cache.
+static void _make_torus(int p_rings, int p_sides, Vector<Vector3> &r_positions, Vector<int> &r_indices) {
+
+    for (int i = 0; i < p_rings; i++) {
+        for (int j = 0; j < p_sides; j++) {
+            float u = i * Math_TAU / p_rings;
+            float v = j * Math_TAU / p_sides;
+            float r = 2.0f + 0.7f * Math::cos(v);
+            r_positions.push_back(Vector3(r * Math::cos(u), r * Math::sin(u), 0.7f * Math::sin(v)));
+        }
+    }
+    for (int i = 0; i < p_rings; i++) {
+        for (int j = 0; j < p_sides; j++) {
+            int a = i * p_sides + j;
+            int b = ((i + 1) % p_rings) * p_sides + j;
+            int c = ((i + 1) % p_rings) * p_sides + (j + 1) % p_sides;
+            int d = i * p_sides + (j + 1) % p_sides;
+            r_indices.insert(r_indices.end(), { a, b, c, a, c, d });
+        }
+    }
+
+    uint32_t seed = 12345;
+    for (int t = r_indices.size() / 3 - 1; t > 0; t--) {
+        seed = seed * 1664525 + 1013904223;
+        int other = (seed >> 8) % (t + 1);
+        for (int k = 0; k < 3; k++) {
+            eastl::swap(r_indices[t * 3 + k], r_indices[other * 3 + k]);
+        }
+    }
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Mesh optimizer");
+
+    Vector<Vector3> positions;
+    Vector<int> indices;
+    _make_torus(256, 128, positions, indices);
+    const int vertex_count = positions.size();
+
+    Vector<int> sorted_before(indices);
+    eastl::sort(sorted_before.begin(), sorted_before.end());
+
+    bool passed = true;
+    float acmr_before = MeshOptimizer::get_acmr(indices, vertex_count);
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    MeshOptimizer::optimize_vertex_cache(indices, vertex_count);
+    uint64_t cache_usec = OS::get_singleton()->get_ticks_usec() - t;
+    float acmr_after = MeshOptimizer::get_acmr(indices, vertex_count);
+
+    t = OS::get_singleton()->get_ticks_usec();
+    MeshOptimizer::optimize_overdraw(indices, positions);
+    uint64_t overdraw_usec = OS::get_singleton()->get_ticks_usec() - t;
+    float acmr_overdraw = MeshOptimizer::get_acmr(indices, vertex_count);
+
+    Vector<int> sorted_after(indices);
+    eastl::sort(sorted_after.begin(), sorted_after.end());
+    CHECK(sorted_before == sorted_after);
+
+    print_line(FormatVE("%d triangles, ACMR %.3f -> %.3f (%.2f ms), after overdraw %.3f (%.2f ms)", int(indices.size() / 3),
+            acmr_before, acmr_after, cache_usec / 1000.0, acmr_overdraw, overdraw_usec / 1000.0));
+    CHECK(acmr_after < acmr_before * 0.5f);
+
+    Vector<int> remap;
+    int used = MeshOptimizer::optimize_vertex_fetch(indices, vertex_count, remap);
+    CHECK(used == vertex_count);
+    Vector<Vector3> fetch_positions;
+    fetch_positions.resize(used);
+    for (int v = 0; v < vertex_count; v++) {
+        fetch_positions[remap[v]] = positions[v];
+    }
+
+    int target = indices.size();
+    for (int level = 0; level < 6; level++) {
+        target /= 2;
+        float error;
+        t = OS::get_singleton()->get_ticks_usec();
+        Vector<int> lod = MeshOptimizer::simplify(indices, fetch_positions, target, 1.0f, &error);
+        uint64_t usec = OS::get_singleton()->get_ticks_usec() - t;
+        print_line(FormatVE("LOD %d: %7d triangles, error %.5f (%.2f ms)", level + 1, int(lod.size() / 3), error, usec / 1000.0));
+        CHECK(int(lod.size()) <= target);
+    }
+
+    print_line(String("Mesh optimizer: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestMeshOptimizer
@@ -0,0 +1,283 @@
+/*************************************************************************/
+/*  test_parallel_process.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+
+#include "test_parallel_process.h"
+#include "test_check.h"
+
+#include "core/class_db.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "scene/2d/node_2d.h"
+#include "scene/3d/node_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestParallelProcess {
+
+enum {
+    NODE_COUNT = 1000,
+    FRAME_COUNT = 4,
+};
+
+// Moves itself every frame from a worker thread and counts the transform notifications it gets.
+class TestMover3D : public Node3D {
+    GDCLASS(TestMover3D, Node3D)
+
+public:
+    int transform_changes = 0;
+    Transform global_seen;
+
+    void _notification(int p_what) {
+        if (p_what == NOTIFICATION_PROCESS) {
+            translate(Vector3(1, 0, 0));
+            global_seen = get_global_transform();
+        } else if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+            transform_changes++;
+        }
+    }
+};
+
+class TestMover2D : public Node2D {
+    GDCLASS(TestMover2D, Node2D)
+
+public:
+    int transform_changes = 0;
+    Transform2D global_seen;
+
+    void _notification(int p_what) {
+        if (p_what == NOTIFICATION_PROCESS) {
+            translate(Vector2(1, 0));
+            global_seen = get_global_transform();
+        } else if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+            transform_changes++;
+            get_global_transform(); // validates the cache, or the next move wouldn't notify
+        }
+    }
+};
+
+// A regular child of a mover, its transform changes through the parent only.
+class TestFollower3D : public Node3D {
+    GDCLASS(TestFollower3D, Node3D)
+
+public:
+    int transform_changes = 0;
+
+    void _notification(int p_what) {
+        if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+            transform_changes++;
+        }
+    }
+};
+
+class TestFollower2D : public Node2D {
+    GDCLASS(TestFollower2D, Node2D)
+
+public:
+    int transform_changes = 0;
+
+    void _notification(int p_what) {
+        if (p_what == NOTIFICATION_TRANSFORM_CHANGED) {
+            transform_changes++;
+            get_global_transform();
+        }
+    }
+};
+
+// Tries to stop processing and to join a group from a worker thread, both have to be refused.
+class TestStopper : public Node {
+    GDCLASS(TestStopper, Node)
+
+public:
+    int process_count = 0;
+
+    void _notification(int p_what) {
+        if (p_what == NOTIFICATION_PROCESS) {
+            process_count++;
+            set_process(false);
+            add_to_group("test_parallel_stopped");
+        }
+    }
+};
+
+IMPL_GDCLASS(TestMover3D)
+IMPL_GDCLASS(TestMover2D)
+IMPL_GDCLASS(TestFollower3D)
+IMPL_GDCLASS(TestFollower2D)
+IMPL_GDCLASS(TestStopper)
+
+template <class T>
+static void _reset(const Vector<T *> &p_nodes) {
+    for (T *n : p_nodes) {
+        n->transform_changes = 0;
+    }
+}
+
+template <class T>
+static bool _notified_once(const Vector<T *> &p_nodes) {
+    for (const T *n : p_nodes) {
+        if (n->transform_changes != 1)
+            return false;
+    }
+    return true;
+}
+
+// Every node moves once per frame on the workers; each of them and each child has to be notified exactly once,
+// on the main thread, and see the global transform it moved to.
+static bool _run(SceneTree *p_tree, int p_threads) {
+
+    bool passed = true;
+
+    Vector<TestMover3D *> movers_3d;
+    Vector<TestMover2D *> movers_2d;
+    Vector<TestFollower3D *> followers_3d;
+    Vector<TestFollower2D *> followers_2d;
+
+    Node *root = memnew(Node);
+    p_tree->get_root()->add_child(root);
+    for (int i = 0; i < NODE_COUNT; i++) {
+        TestMover3D *m3 = memnew(TestMover3D);
+        TestFollower3D *f3 = memnew(TestFollower3D);
+        m3->add_child(f3);
+        root->add_child(m3);
+        TestMover2D *m2 = memnew(TestMover2D);
+        TestFollower2D *f2 = memnew(TestFollower2D);
+        m2->add_child(f2);
+        root->add_child(m2);
+
+        m3->set_notify_transform(true);
+        f3->set_notify_transform(true);
+        m2->set_notify_transform(true);
+        f2->set_notify_transform(true);
+        m3->set_process_parallel(true);
+        m2->set_process_parallel(true);
+        m3->set_process(true);
+        m2->set_process(true);
+
+        movers_3d.push_back(m3);
+        movers_2d.push_back(m2);
+        followers_3d.push_back(f3);
+        followers_2d.push_back(f2);
+    }
+    p_tree->flush_transform_notifications();
+    for (TestMover2D *m : movers_2d) {
+        m->get_global_transform();
+    }
+    for (TestFollower2D *f : followers_2d) {
+        f->get_global_transform();
+    }
+
+    for (int frame = 1; frame <= FRAME_COUNT; frame++) {
+        _reset(movers_3d);
+        _reset(movers_2d);
+        _reset(followers_3d);
+        _reset(followers_2d);
+
+        p_tree->idle(0.016f);
+
+        CHECK(_notified_once(movers_3d));
+        CHECK(_notified_once(movers_2d));
+        CHECK(_notified_once(followers_3d));
+        CHECK(_notified_once(followers_2d));
+        for (int i = 0; i < NODE_COUNT; i++) {
+            CHECK(movers_3d[i]->global_seen.origin == Vector3(frame, 0, 0));
+            CHECK(followers_3d[i]->get_global_transform().origin == Vector3(frame, 0, 0));
+            CHECK(movers_2d[i]->global_seen.get_origin() == Vector2(frame, 0));
+            CHECK(followers_2d[i]->get_global_transform().get_origin() == Vector2(frame, 0));
+        }
+    }
+
+    root->queue_delete();
+    p_tree->idle(0.016f);
+
+    print_line(FormatVE("\t%d threads: %s", p_threads, passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+// Group membership can't change while the group arrays are being walked by the workers.
+static bool _run_group_changes(SceneTree *p_tree) {
+
+    bool passed = true;
+
+    Vector<TestStopper *> stoppers;
+    Node *root = memnew(Node);
+    p_tree->get_root()->add_child(root);
+    for (int i = 0; i < NODE_COUNT; i++) {
+        TestStopper *s = memnew(TestStopper);
+        root->add_child(s);
+        s->set_process_parallel(true);
+        s->set_process(true);
+        stoppers.push_back(s);
+    }
+
+    for (int frame = 1; frame <= 2; frame++) {
+        p_tree->idle(0.016f);
+        for (TestStopper *s : stoppers) {
+            CHECK(s->process_count == frame);
+            CHECK(s->is_processing());
+            CHECK(!s->is_in_group("test_parallel_stopped"));
+        }
+    }
+    CHECK(!p_tree->has_group("test_parallel_stopped"));
+
+    root->queue_delete();
+    p_tree->idle(0.016f);
+
+    print_line(String("\tgroup changes: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Transform changes of nodes processed in parallel");
+
+    SceneTree *tree = memnew(SceneTree);
+    tree->init();
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    pool->set_thread_count(-1);
+    const int thread_counts[] = { 0, pool->get_thread_count() };
+    bool passed = true;
+    for (int threads : thread_counts) {
+        pool->set_thread_count(threads);
+        passed &= _run(tree, threads);
+    }
+    passed &= _run_group_changes(tree);
+    pool->set_thread_count(-1);
+
+    tree->finish();
+    memdelete(tree);
+
+    print_line(String("Parallel process: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestParallelProcess
@@ -0,0 +1,260 @@
+/*************************************************************************/
+/*  test_payload_streamer.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_payload_streamer.h"
+#include "test_check.h"
+
+#include "core/io/resource_payload_streamer.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/pool_vector.h"
+#include "core/print_string.h"
+#include "core/resource/resource_manager.h"
+#include "core/string_formatter.h"
+#include "scene/resources/audio_stream_sample.h"
+#include "scene/resources/mesh.h"
+
+namespace TestPayloadStreamer {
+
+// Owner that only counts calls, used to check scheduling and eviction without any files.
+class CountingOwner : public StreamedPayloadOwner {
+public:
+    uint64_t size;
+    bool evictable = true;
+    int reads = 0;
+    int applies = 0;
+    int evictions = 0;
+
+    explicit CountingOwner(uint64_t p_size) :
+            size(p_size) {
+        _payload_defer();
+    }
+    ~CountingOwner() override {
+        _payload_release();
+    }
+
+protected:
+    Error _payload_read() override {
+        reads++;
+        return OK;
+    }
+    uint64_t _payload_apply() override {
+        applies++;
+        return size;
+    }
+    bool _payload_evictable() const override { return true; }
+    bool _payload_evict() override {
+        if (!evictable)
+            return false;
+        evictions++;
+        return true;
+    }
+};
+
+// Owner without eviction support, like meshes and textures.
+class PinnedOwner : public CountingOwner {
+public:
+    int eviction_calls = 0;
+
+    explicit PinnedOwner(uint64_t p_size) :
+            CountingOwner(p_size) {}
+
+protected:
+    bool _payload_evictable() const override { return false; }
+    bool _payload_evict() override {
+        eviction_calls++;
+        return false;
+    }
+};
+
+static bool _test_scheduling() {
+
+    bool passed = true;
+    ResourcePayloadStreamer *streamer = ResourcePayloadStreamer::get_singleton();
+    const uint64_t old_budget = streamer->get_budget();
+    const uint64_t base_size = streamer->get_resident_size();
+    streamer->set_budget(base_size + 300);
+
+    {
+        CountingOwner a(100), b(100), c(100), d(100);
+        streamer->ensure(&a);
+        streamer->ensure(&b);
+        streamer->ensure(&c);
+        CHECK(a.applies == 1 && b.applies == 1 && c.applies == 1);
+        CHECK(streamer->get_resident_size() == base_size + 300);
+
+        // a becomes the most recently used, so b is the one to go
+        streamer->touch(&a);
+        streamer->ensure(&d);
+        streamer->poll();
+        CHECK(b.get_payload_state() == StreamedPayloadOwner::PAYLOAD_UNLOADED);
+        CHECK(a.get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+        CHECK(c.get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+        CHECK(streamer->get_resident_size() == base_size + 300);
+
+        // owners that refuse eviction stay, everything else goes in LRU order
+        d.evictable = false;
+        streamer->set_budget(base_size + 100);
+        streamer->poll();
+        CHECK(c.evictions == 1 && a.evictions == 1 && d.evictions == 0);
+        CHECK(d.get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+        CHECK(streamer->get_resident_size() == base_size + 100);
+
+        // background read, applied by poll()
+        streamer->set_budget(base_size + 200);
+        streamer->request(&b);
+        uint64_t begin = OS::get_singleton()->get_ticks_msec();
+        while (b.get_payload_state() != StreamedPayloadOwner::PAYLOAD_RESIDENT && OS::get_singleton()->get_ticks_msec() - begin < 2000) {
+            OS::get_singleton()->delay_usec(1000);
+            streamer->poll();
+        }
+        CHECK(b.reads == 2 && b.applies == 2);
+    }
+
+    {
+        // other threads can't make data live, it stays unloaded
+        CountingOwner e(100);
+        Thread *thread = Thread::create([](void *p_owner) {
+            ResourcePayloadStreamer::get_singleton()->ensure(static_cast<StreamedPayloadOwner *>(p_owner));
+        }, &e);
+        Thread::wait_to_finish(thread);
+        memdelete(thread);
+        CHECK(e.applies == 0);
+        CHECK(e.get_payload_state() == StreamedPayloadOwner::PAYLOAD_UNLOADED);
+    }
+
+    {
+        // owners that never evict aren't asked, however far over the budget they are
+        CountingOwner f(100);
+        PinnedOwner g(1000);
+        streamer->ensure(&f);
+        streamer->ensure(&g);
+        streamer->set_budget(base_size + 100);
+        streamer->poll();
+        CHECK(f.evictions == 1 && g.eviction_calls == 0);
+        CHECK(g.get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+        streamer->poll();
+        CHECK(g.eviction_calls == 0);
+    }
+
+    CHECK(streamer->get_resident_size() == base_size);
+    streamer->set_budget(old_budget);
+    return passed;
+}
+
+static bool _test_lazy_resources() {
+
+    bool passed = true;
+    ResourcePayloadStreamer *streamer = ResourcePayloadStreamer::get_singleton();
+    const String sample_path("user://test_payload_streamer_sample.res");
+    const String mesh_path("user://test_payload_streamer_mesh.res");
+
+    PoolVector<uint8_t> pcm;
+    pcm.resize(256 * 1024);
+    {
+        PoolVector<uint8_t>::Write w = pcm.write();
+        for (int i = 0; i < pcm.size(); i++) {
+            w[i] = uint8_t(i * 7);
+        }
+    }
+    Ref<AudioStreamSample> sample(make_ref_counted<AudioStreamSample>());
+    sample->set_format(AudioStreamSample::FORMAT_16_BITS);
+    {
+        PoolVector<uint8_t>::Read r = pcm.read();
+        sample->set_data(Span<const uint8_t>(r.ptr(), pcm.size()));
+    }
+    CHECK(gResourceManager().save(sample_path, sample) == OK);
+
+    Vector<Vector3> points;
+    for (int i = 0; i < 16384; i++) {
+        points.push_back(Vector3(i % 101, i % 37, -(i % 53)));
+    }
+    Ref<ArrayMesh> mesh(make_ref_counted<ArrayMesh>());
+    mesh->add_surface_from_arrays(Mesh::PRIMITIVE_POINTS, SurfaceArrays(eastl::move(points)));
+    CHECK(gResourceManager().save(mesh_path, mesh) == OK);
+
+    const bool old_lazy = streamer->is_lazy_loading_enabled();
+    const uint64_t old_min_size = streamer->get_lazy_min_size();
+    streamer->set_lazy_loading(true, 16 * 1024);
+
+    Ref<AudioStreamSample> lazy_sample = dynamic_ref_cast<AudioStreamSample>(gResourceManager().load(sample_path, "", true));
+    Ref<ArrayMesh> lazy_mesh = dynamic_ref_cast<ArrayMesh>(gResourceManager().load(mesh_path, "", true));
+
+    streamer->set_lazy_loading(old_lazy, old_min_size);
+
+    CHECK(lazy_sample && lazy_mesh);
+    if (!lazy_sample || !lazy_mesh) {
+        return false;
+    }
+
+    // metadata is there before the data
+    CHECK(lazy_sample->get_payload_state() == StreamedPayloadOwner::PAYLOAD_UNLOADED);
+    CHECK(lazy_sample->get_length() == sample->get_length());
+    CHECK(lazy_mesh->get_payload_state() == StreamedPayloadOwner::PAYLOAD_UNLOADED);
+    CHECK(lazy_mesh->get_surface_count() == 1);
+    CHECK(lazy_mesh->get_aabb() == mesh->get_aabb());
+
+    // handing the mesh to the renderer only queues its data, poll() applies it
+    CHECK(lazy_mesh->get_rid().is_valid());
+    CHECK(lazy_mesh->get_payload_state() != StreamedPayloadOwner::PAYLOAD_RESIDENT);
+    CHECK(lazy_mesh->has_pending_surfaces());
+    uint64_t begin = OS::get_singleton()->get_ticks_msec();
+    while (lazy_mesh->get_payload_state() != StreamedPayloadOwner::PAYLOAD_RESIDENT && OS::get_singleton()->get_ticks_msec() - begin < 2000) {
+        OS::get_singleton()->delay_usec(1000);
+        streamer->poll();
+    }
+    CHECK(lazy_mesh->get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+    CHECK(!lazy_mesh->has_pending_surfaces());
+
+    streamer->prefetch(lazy_sample);
+    PoolVector<uint8_t> loaded = lazy_sample->get_data();
+    CHECK(lazy_sample->get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+    CHECK(loaded.size() == pcm.size() && memcmp(loaded.read().ptr(), pcm.read().ptr(), pcm.size()) == 0);
+
+    CHECK(lazy_mesh->surface_get_array_len(0) == mesh->surface_get_array_len(0));
+    CHECK(lazy_mesh->get_payload_state() == StreamedPayloadOwner::PAYLOAD_RESIDENT);
+
+    return passed;
+}
+
+
+MainLoop *test() {
+
+    print_line("\n*** Resource payload streamer");
+
+    bool scheduling = _test_scheduling();
+    bool lazy = _test_lazy_resources();
+    print_line(FormatVE("Scheduling and eviction: %s, lazy resources: %s", scheduling ? "ok" : "FAILED", lazy ? "ok" : "FAILED"));
+
+    print_line(String("Resource payload streamer: ") + (scheduling && lazy ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestPayloadStreamer
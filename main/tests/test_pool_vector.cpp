@@ -0,0 +1,169 @@
+/*************************************************************************/
+/*  test_pool_vector.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_pool_vector.h"
+#include "test_check.h"
+
+#include "core/math/vector3.h"
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/pool_vector.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+
+#include <atomic>
+
+namespace TestPoolVector {
+
+static void _report(const char *p_name, uint64_t p_usec, int p_iterations) {
+
+    print_line(FormatVE("%-28s %10.3f ms total, %10.1f ns/iter", p_name, p_usec / 1000.0, p_usec * 1000.0 / p_iterations));
+}
+
+static bool test_semantics() {
+
+    bool passed = true;
+
+    PoolVector<int> a;
+    for (int i = 0; i < 1000; i++) {
+        a.push_back(i);
+    }
+    PoolVector<int> b = a;
+    CHECK(a.get_refcount() == 2);
+    b.set(10, -1);
+    CHECK(a[10] == 10 && b[10] == -1 && a.get_refcount() == 1);
+
+    b.append_array(b);
+    CHECK(b.size() == 2000 && b[1010] == -1);
+    b.resize(5);
+    CHECK(b.size() == 5 && a.size() == 1000);
+
+    PoolVector<int> sub = a.subarray(100, 199);
+    CHECK(sub.size() == 100 && sub[0] == 100 && sub[99] == 199);
+
+    a.insert(0, a[999]);
+    a.remove(1);
+    CHECK(a.size() == 1000 && a[0] == 999 && a[1] == 1);
+
+    // a live Write keeps the buffer where it is, in every build
+    {
+        PoolVector<int>::Write w = a.write();
+        CHECK(a.is_locked());
+        CHECK(a.resize(4000) == ERR_LOCKED && a.reserve(4000) == ERR_LOCKED);
+        a.push_back(1000);
+        CHECK(a.size() == 1000 && w.ptr() == a.ptr());
+    }
+    CHECK(!a.is_locked() && a.resize(4000) == OK);
+
+    print_line(String("Copy-on-write semantics: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+static void bench_cow() {
+
+    const int count = 1 << 16;
+    const int iterations = 2000;
+    PoolVector<Vector3> src;
+    src.resize(count);
+    {
+        PoolVector<Vector3>::Write w = src.write();
+        for (int i = 0; i < count; i++) {
+            w[i] = Vector3(i, i, i);
+        }
+    }
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < iterations; i++) {
+        PoolVector<Vector3> copy = src; // shared, no copy yet
+        (void)copy.read()[i];
+    }
+    _report("share + read", OS::get_singleton()->get_ticks_usec() - t, iterations);
+
+    t = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < iterations; i++) {
+        PoolVector<Vector3> copy = src;
+        copy.write()[i] = Vector3(); // triggers the copy
+    }
+    _report("share + write (COW 768KiB)", OS::get_singleton()->get_ticks_usec() - t, iterations);
+
+    t = OS::get_singleton()->get_ticks_usec();
+    PoolVector<int> pushed;
+    for (int i = 0; i < count * 16; i++) {
+        pushed.push_back(i);
+    }
+    _report("push_back", OS::get_singleton()->get_ticks_usec() - t, count * 16);
+}
+
+static void bench_concurrent_readers() {
+
+    const int count = 1 << 20;
+    PoolVector<float> data;
+    data.resize(count);
+    {
+        PoolVector<float>::Write w = data.write();
+        for (int i = 0; i < count; i++) {
+            w[i] = 1.0f;
+        }
+    }
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    const uint32_t jobs = pool->get_thread_count() + 1;
+    const int passes = 64;
+    std::atomic<bool> valid { true };
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    pool->parallel_for(jobs, [&](uint32_t) {
+        for (int p = 0; p < passes; p++) {
+            // every reader takes its own reference and read view, as threads sharing a buffer would
+            PoolVector<float> mine = data;
+            PoolVector<float>::Read r = mine.read();
+            float sum = 0;
+            for (int i = 0; i < count; i++) {
+                sum += r[i];
+            }
+            if (sum != float(count)) {
+                valid = false;
+            }
+        }
+    });
+    _report("concurrent readers (per MiB)", OS::get_singleton()->get_ticks_usec() - t, jobs * passes * 4);
+    print_line(FormatVE("  %d readers, results %s", jobs, valid ? "valid" : "INVALID"));
+}
+
+MainLoop *test() {
+
+    print_line("\n*** PoolVector");
+    test_semantics();
+    bench_cow();
+    bench_concurrent_readers();
+    return nullptr;
+}
+} // namespace TestPoolVector
@@ -0,0 +1,215 @@
+/*************************************************************************/
+/*  test_replication.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+
+#include "test_replication.h"
+#include "test_check.h"
+
+#include "core/class_db.h"
+#include "core/io/multiplayer_api.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestReplication {
+
+enum {
+    PLAYER_COUNT = 64,
+    TICK_COUNT = 100,
+    PORT = 27500,
+};
+
+static const float POSITION_STEP = 0.01f;
+
+struct Side {
+    Node *root = nullptr;
+    Vector<Node2D *> players;
+    Ref<MultiplayerAPI> multiplayer;
+    Ref<NetworkedMultiplayerPeer> peer;
+};
+
+static void _make_side(SceneTree *p_tree, StringView p_name, Side &r_side) {
+
+    r_side.root = memnew(Node);
+    r_side.root->set_name(p_name);
+    p_tree->get_root()->add_child(r_side.root);
+    for (int i = 0; i < PLAYER_COUNT; i++) {
+        Node2D *player = memnew(Node2D);
+        player->set_name(FormatVE("Player%d", i));
+        r_side.root->add_child(player);
+        r_side.players.push_back(player);
+    }
+    r_side.multiplayer = make_ref_counted<MultiplayerAPI>();
+    r_side.multiplayer->set_root_node(r_side.root);
+    r_side.multiplayer->set_replication_tick_rate(0);
+    for (Node2D *player : r_side.players) {
+        r_side.multiplayer->replicate_property(player, "position", POSITION_STEP);
+        r_side.multiplayer->replicate_property(player, "rotation");
+        r_side.multiplayer->replicate_property(player, "z_index");
+    }
+}
+
+static Ref<NetworkedMultiplayerPeer> _make_enet_peer() {
+    Object *obj = ClassDB::instance("NetworkedMultiplayerENet");
+    return Ref<NetworkedMultiplayerPeer>(object_cast<NetworkedMultiplayerPeer>(obj));
+}
+
+// Polls both sides until p_done returns true or a few seconds passed.
+template <class F>
+static bool _poll_until(Side &p_server, Side &p_client, F &&p_done) {
+    uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 5000;
+    while (OS::get_singleton()->get_ticks_msec() < deadline) {
+        p_server.multiplayer->poll();
+        p_client.multiplayer->poll();
+        if (p_done())
+            return true;
+        OS::get_singleton()->delay_usec(500);
+    }
+    return false;
+}
+
+static bool _synced(const Side &p_server, const Side &p_client) {
+    for (int i = 0; i < PLAYER_COUNT; i++) {
+        const Node2D *s = p_server.players[i];
+        const Node2D *c = p_client.players[i];
+        if (s->get_position().distance_to(c->get_position()) > POSITION_STEP || s->get_rotation() != c->get_rotation() || s->get_z_index() != c->get_z_index())
+            return false;
+    }
+    return true;
+}
+
+static bool _run(SceneTree *p_tree) {
+
+    bool passed = true;
+
+    Side server;
+    Side client;
+    _make_side(p_tree, "Server", server);
+    _make_side(p_tree, "Client", client);
+
+    server.peer = _make_enet_peer();
+    client.peer = _make_enet_peer();
+    if (!server.peer || !client.peer) {
+        print_line("\tENet is not available, skipped.");
+        return true;
+    }
+    CHECK(server.peer->call_va("create_server", PORT, 4).as<int>() == OK);
+    CHECK(client.peer->call_va("create_client", "127.0.0.1", PORT).as<int>() == OK);
+    server.multiplayer->set_network_peer(server.peer);
+    client.multiplayer->set_network_peer(client.peer);
+
+    bool connected = _poll_until(server, client, [&]() {
+        return client.peer->get_connection_status() == NetworkedMultiplayerPeer::CONNECTION_CONNECTED && !server.multiplayer->get_network_connected_peers().empty();
+    });
+    CHECK(connected);
+    if (!connected)
+        return false;
+    int client_id = server.multiplayer->get_network_connected_peers()[0];
+
+    // Full states first: paths get confirmed, then every node arrives.
+    for (int i = 0; i < PLAYER_COUNT; i++) {
+        server.players[i]->set_position(Vector2(i * 3.0f, i * 0.5f));
+        server.players[i]->set_rotation(i * 0.1f);
+        server.players[i]->set_z_index(i);
+    }
+    bool synced = _poll_until(server, client, [&]() {
+        server.multiplayer->send_replication_snapshot();
+        return _synced(server, client);
+    });
+    CHECK(synced);
+
+    // Deltas: a few players move every tick, the client follows.
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    for (int tick = 0; tick < TICK_COUNT; tick++) {
+        for (int i = tick % 8; i < PLAYER_COUNT; i += 8) {
+            Node2D *player = server.players[i];
+            player->set_position(player->get_position() + Vector2(0.25f, -0.125f));
+        }
+        server.multiplayer->send_replication_snapshot();
+        uint32_t sent_tick = server.multiplayer->get_replication_tick();
+        CHECK(_poll_until(server, client, [&]() { return client.multiplayer->get_replication_tick() >= sent_tick; }));
+    }
+    uint64_t delta_usec = OS::get_singleton()->get_ticks_usec() - t;
+    CHECK(_synced(server, client));
+    print_line(FormatVE("\t%d players, %d delta ticks: %.2f ms per tick round trip", int(PLAYER_COUNT), int(TICK_COUNT), delta_usec / 1000.0 / TICK_COUNT));
+
+    // Quantized values arrive rounded to the step.
+    server.players[0]->set_position(Vector2(1.23456f, 0));
+    server.multiplayer->send_replication_snapshot();
+    CHECK(_poll_until(server, client, [&]() { return client.multiplayer->get_replication_tick() == server.multiplayer->get_replication_tick(); }));
+    CHECK(Math::is_equal_approx(client.players[0]->get_position().x, 1.23f, 0.0001f));
+
+    // Interest management: only nodes near the peer's origin are sent.
+    for (Node2D *player : server.players) {
+        server.multiplayer->set_replication_position_property(player, "position");
+    }
+    server.multiplayer->set_replication_interest_radius(10);
+    server.multiplayer->set_peer_interest_origin(client_id, Vector3(0, 0, 0));
+    server.players[1]->set_position(Vector2(2, 2));
+    server.players[PLAYER_COUNT - 1]->set_position(Vector2(1000, 1000));
+    Vector2 far_before = client.players[PLAYER_COUNT - 1]->get_position();
+    server.multiplayer->send_replication_snapshot();
+    CHECK(_poll_until(server, client, [&]() { return client.multiplayer->get_replication_tick() == server.multiplayer->get_replication_tick(); }));
+    CHECK(client.players[1]->get_position() == Vector2(2, 2));
+    CHECK(client.players[PLAYER_COUNT - 1]->get_position() == far_before);
+
+    // Coming back into range sends the current state again.
+    server.players[PLAYER_COUNT - 1]->set_position(Vector2(5, 5));
+    server.multiplayer->send_replication_snapshot();
+    CHECK(_poll_until(server, client, [&]() { return client.players[PLAYER_COUNT - 1]->get_position() == Vector2(5, 5); }));
+
+    server.multiplayer->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+    client.multiplayer->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+    server.peer->call_va("close_connection");
+    client.peer->call_va("close_connection");
+
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Snapshot replication over loopback ENet");
+
+    SceneTree *tree = memnew(SceneTree);
+    tree->init();
+
+    bool passed = _run(tree);
+
+    tree->finish();
+    memdelete(tree);
+
+    print_line(String("Replication: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestReplication
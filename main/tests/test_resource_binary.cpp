@@ -0,0 +1,266 @@
+/*************************************************************************/
+/*  test_resource_binary.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_resource_binary.h"
+#include "test_check.h"
+
+#include "core/array.h"
+#include "core/image.h"
+#include "core/io/marshalls.h"
+#include "core/os/file_access.h"
+#include "core/io/resource_format_binary.h"
+#include "core/math/transform.h"
+#include "core/node_path.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/print_string.h"
+#include "core/resource.h"
+#include "core/resource/resource_manager.h"
+#include "core/string_formatter.h"
+#include "scene/resources/resource_format_text.h"
+
+namespace TestResourceBinary {
+
+static const char *meta_names[] = { "name", "points", "weights", "indices", "transform", "node" };
+
+// Scene-like resource: many sub-resources with small and large packed arrays, a few images and a shared one.
+static RES _make_resource(int p_parts) {
+
+    RES shared(make_ref_counted<Resource>());
+    shared->set_meta("name", String("shared"));
+
+    Array parts;
+    for (int i = 0; i < p_parts; i++) {
+
+        // every eighth part is large enough to go to the payload section
+        int count = (i % 8 == 0) ? 4096 : 64;
+        PoolVector<Vector3> points;
+        PoolVector<real_t> weights;
+        PoolVector<int> indices;
+        points.resize(count);
+        weights.resize(count);
+        indices.resize(count);
+        {
+            PoolVector<Vector3>::Write wp = points.write();
+            PoolVector<real_t>::Write ww = weights.write();
+            PoolVector<int>::Write wi = indices.write();
+            for (int j = 0; j < count; j++) {
+                wp[j] = Vector3(i, j, i * 0.5f - j);
+                ww[j] = j * 0.25f;
+                wi[j] = i * j;
+            }
+        }
+
+        RES part(make_ref_counted<Resource>());
+        part->set_meta("name", String("part_") + ::to_string(i));
+        part->set_meta("points", points);
+        part->set_meta("weights", weights);
+        part->set_meta("indices", indices);
+        part->set_meta("transform", Transform(Basis(Vector3(0, 1, 0), i * 0.1f), Vector3(i, 0, -i)));
+        part->set_meta("node", NodePath("Level/Part" + ::to_string(i) + ":transform"));
+        part->set_meta("shared", shared);
+        parts.push_back(part);
+    }
+
+    Array images;
+    for (int i = 0; i < 4; i++) {
+        PoolVector<uint8_t> data;
+        data.resize(256 * 256 * 4);
+        {
+            PoolVector<uint8_t>::Write w = data.write();
+            for (int j = 0; j < data.size(); j++) {
+                w[j] = uint8_t(i * 31 + j * 7);
+            }
+        }
+        Ref<Image> image(make_ref_counted<Image>(256, 256, false, Image::FORMAT_RGBA8, data));
+        images.push_back(image);
+    }
+
+    RES root(make_ref_counted<Resource>());
+    root->set_meta("parts", parts);
+    root->set_meta("images", images);
+    return root;
+}
+
+static Vector<uint8_t> _encode(const Variant &p_value) {
+
+    Vector<uint8_t> buf;
+    encode_variant(p_value, buf);
+    return buf;
+}
+
+static bool _compare(const RES &p_expected, const RES &p_loaded) {
+
+    if (!p_loaded) {
+        return false;
+    }
+
+    Array parts = p_expected->get_meta("parts").as<Array>();
+    Array loaded_parts = p_loaded->get_meta("parts").as<Array>();
+    if (parts.size() != loaded_parts.size()) {
+        return false;
+    }
+
+    Object *shared = nullptr;
+    for (int i = 0; i < parts.size(); i++) {
+        RES part(refFromVariant<Resource>(parts[i]));
+        RES loaded(refFromVariant<Resource>(loaded_parts[i]));
+        if (!loaded) {
+            return false;
+        }
+        for (const char *name : meta_names) {
+            if (_encode(part->get_meta(name)) != _encode(loaded->get_meta(name))) {
+                return false;
+            }
+        }
+        // sub-resources referenced more than once must stay a single object
+        Object *loaded_shared = loaded->get_meta("shared").as<Object *>();
+        if (!loaded_shared || (shared && shared != loaded_shared)) {
+            return false;
+        }
+        shared = loaded_shared;
+    }
+
+    Array images = p_expected->get_meta("images").as<Array>();
+    Array loaded_images = p_loaded->get_meta("images").as<Array>();
+    if (images.size() != loaded_images.size()) {
+        return false;
+    }
+    for (int i = 0; i < images.size(); i++) {
+        Ref<Image> image(refFromVariant<Image>(images[i]));
+        Ref<Image> loaded(refFromVariant<Image>(loaded_images[i]));
+        if (!loaded || loaded->get_size() != image->get_size() || _encode(loaded->get_data()) != _encode(image->get_data())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t _time_load(StringView p_path, int p_iterations) {
+
+    OS *os = OS::get_singleton();
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < p_iterations; i++) {
+        uint64_t begin = os->get_ticks_usec();
+        RES res(gResourceManager().load(p_path, "", true));
+        best = MIN(best, os->get_ticks_usec() - begin);
+        ERR_FAIL_COND_V(!res, 0);
+    }
+    return best;
+}
+
+// Files cut short or with their block index pointing past the end must fail to load, without allocating for
+// the sizes they claim.
+static bool _test_truncated(StringView p_v4_path) {
+
+    const String truncated_path("user://test_resource_binary_truncated.res");
+    Vector<uint8_t> data = FileAccess::get_file_as_array(p_v4_path);
+    if (data.empty()) {
+        return false;
+    }
+
+    bool passed = true;
+    const int cuts[] = { 2, 4, 16 };
+    for (int cut : cuts) {
+        FileAccess *f = FileAccess::open(truncated_path, FileAccess::WRITE);
+        if (!f) {
+            return false;
+        }
+        f->store_buffer(data.data(), data.size() - data.size() / cut);
+        memdelete(f);
+        CHECK(!gResourceManager().load(truncated_path, "", true));
+    }
+    print_line(FormatVE("Truncated files rejected: %s", passed ? "ok" : "FAILED"));
+    return passed;
+}
+
+// Times format 3 against format 4 for a resource, both written from the same data.
+static bool _time_formats(const RES &p_root, StringView p_name) {
+
+    const String text_path("user://test_resource_binary_bench.tres");
+    const String v3_path("user://test_resource_binary_bench_v3.res");
+    const String v4_path("user://test_resource_binary_bench_v4.res");
+
+    if (gResourceManager().save(v4_path, p_root) != OK || gResourceManager().save(text_path, p_root) != OK ||
+            ResourceFormatLoaderText::convert_file_to_binary(text_path, v3_path) != OK) {
+        return false;
+    }
+    uint64_t v3_usec = _time_load(v3_path, 5);
+    uint64_t v4_usec = _time_load(v4_path, 5);
+    print_line(FormatVE("Load %s: format 3 %.2f ms, format 4 %.2f ms", String(p_name).c_str(), v3_usec / 1000.0, v4_usec / 1000.0));
+    return v3_usec && v4_usec;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Binary resource format");
+
+    const String text_path("user://test_resource_binary.tres");
+    const String v3_path("user://test_resource_binary_v3.res");
+    const String v4_path("user://test_resource_binary_v4.res");
+    const String converted_path("user://test_resource_binary_converted.res");
+
+    bool passed = true;
+    {
+        RES root = _make_resource(512);
+
+        CHECK(gResourceManager().save(v4_path, root) == OK);
+        // the text to binary converter still writes format 3, which makes a reference file for comparison
+        CHECK(gResourceManager().save(text_path, root) == OK);
+        CHECK(ResourceFormatLoaderText::convert_file_to_binary(text_path, v3_path) == OK);
+        CHECK(ResourceFormatLoaderBinary::convert_file_to_current_format(v3_path, converted_path) == OK);
+
+        CHECK(_compare(root, gResourceManager().load(v4_path, "", true)));
+        CHECK(_compare(root, gResourceManager().load(v3_path, "", true)));
+        CHECK(_compare(root, gResourceManager().load(converted_path, "", true)));
+        CHECK(_test_truncated(v4_path));
+
+        if (passed) {
+            CHECK(_time_formats(root, "synthetic scene"));
+        }
+    }
+
+    // the tree ships no scenes, real ones can be given after the test name, e.g. -test resource_binary res://level.scn
+    const Vector<String> &cmdlargs(OS::get_singleton()->get_cmdline_args());
+    if (passed && !cmdlargs.empty() && cmdlargs.back() != "resource_binary") {
+        RES scene(gResourceManager().load(cmdlargs.back(), "", true));
+        CHECK(scene);
+        if (scene) {
+            CHECK(_time_formats(scene, cmdlargs.back()));
+        } else {
+            print_line("\tcould not load " + cmdlargs.back());
+        }
+    }
+
+    print_line(String("Binary resource format: ") + (passed ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestResourceBinary
@@ -0,0 +1,141 @@
+/*************************************************************************/
+/*  test_shader_cache.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_shader_cache.h"
+#include "test_check.h"
+
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/print_string.h"
+#include "drivers/gles3/shader_compiler_gles3.h"
+#include "servers/rendering/shader_cache.h"
+
+namespace TestShaderCache {
+
+static const char *test_shader_code = R"(
+shader_type canvas_item;
+render_mode blend_add, unshaded;
+
+uniform vec4 tint : hint_color = vec4(1.0, 0.5, 0.25, 1.0);
+uniform sampler2D noise;
+
+void fragment() {
+    COLOR = texture(noise, SCREEN_UV) * tint * sin(TIME);
+}
+)";
+
+struct CompileResult {
+    ShaderCompilerGLES3::GeneratedCode gen;
+    HashMap<StringName, ShaderLanguage::ShaderNode::Uniform> uniforms;
+    int blend_mode = 0;
+    int light_mode = 0;
+    bool uses_screen_uv = false;
+    bool uses_time = false;
+};
+
+static Error _compile(ShaderCompilerGLES3 &p_compiler, CompileResult &r_result) {
+
+    ShaderCompilerGLES3::IdentifierActions actions;
+    actions.render_mode_values["blend_add"] = Pair<int *, int>(&r_result.blend_mode, 1);
+    actions.render_mode_values["unshaded"] = Pair<int *, int>(&r_result.light_mode, 1);
+    actions.usage_flag_pointers["SCREEN_UV"] = &r_result.uses_screen_uv;
+    actions.usage_flag_pointers["TIME"] = &r_result.uses_time;
+    actions.uniforms = &r_result.uniforms;
+
+    return p_compiler.compile(RS::ShaderMode::CANVAS_ITEM, test_shader_code, &actions, "test_shader_cache", r_result.gen);
+}
+
+MainLoop *test() {
+
+    bool passed = true;
+
+    const String cache_dir("user://test_shader_cache");
+    {
+        DirAccessRef da(DirAccess::create_for_path(cache_dir));
+        if (da->change_dir(cache_dir) == OK) {
+            da->erase_contents_recursive();
+        }
+    }
+    ShaderCache::set_enabled(true);
+    ShaderCache::set_cache_dir(cache_dir);
+
+    ShaderCompilerGLES3 compiler;
+
+    print_line("\n*** Cold compile (cache miss)");
+    uint64_t hits = ShaderCache::get_hit_count();
+    CompileResult cold;
+    CHECK(_compile(compiler, cold) == OK);
+    CHECK(ShaderCache::get_hit_count() == hits);
+    CHECK(ShaderCache::get_cached_keys().size() == 1);
+    // The exporter finds entries through the backend tag, without access to the compiler.
+    CHECK(ShaderCache::get_cached_keys()[0] == ShaderCache::make_key(ShaderCache::get_backend_tag(), int(RS::ShaderMode::CANVAS_ITEM), test_shader_code));
+
+    print_line("\n*** Warm compile (cache hit)");
+    CompileResult warm;
+    CHECK(_compile(compiler, warm) == OK);
+    CHECK(ShaderCache::get_hit_count() == hits + 1);
+
+    CHECK(warm.gen.defines == cold.gen.defines);
+    CHECK(warm.gen.uniforms == cold.gen.uniforms);
+    CHECK(warm.gen.vertex_global == cold.gen.vertex_global);
+    CHECK(warm.gen.fragment_global == cold.gen.fragment_global);
+    CHECK(warm.gen.fragment == cold.gen.fragment);
+    CHECK(warm.gen.uniform_offsets == cold.gen.uniform_offsets);
+    CHECK(warm.gen.uniform_total_size == cold.gen.uniform_total_size);
+    CHECK(warm.gen.texture_uniforms == cold.gen.texture_uniforms);
+    CHECK(warm.gen.uses_fragment_time == cold.gen.uses_fragment_time);
+
+    // Side effects of the parse have to be replayed on a hit.
+    CHECK(warm.blend_mode == 1 && warm.light_mode == 1);
+    CHECK(warm.uses_screen_uv && warm.uses_time);
+    CHECK(warm.uniforms.size() == 2);
+    CHECK(warm.uniforms.contains("tint") && warm.uniforms["tint"].hint == ShaderLanguage::ShaderNode::Uniform::HINT_COLOR);
+    CHECK(warm.uniforms["tint"].default_value.size() == 4 && warm.uniforms["tint"].default_value[1].real == 0.5f);
+
+    print_line("\n*** Truncated entry falls back to compiling");
+    for (const String &key : ShaderCache::get_cached_keys()) {
+        String path = ShaderCache::get_entry_path(cache_dir, key);
+        Vector<uint8_t> data = FileAccess::get_file_as_array(path);
+        FileAccessRef f(FileAccess::open(path, FileAccess::WRITE));
+        f->store_buffer(data.data(), data.size() / 2);
+    }
+    CompileResult recovered;
+    CHECK(_compile(compiler, recovered) == OK);
+    CHECK(recovered.gen.fragment == cold.gen.fragment);
+    CHECK(recovered.uses_time);
+
+    ShaderCache::set_cache_dir("user://shader_cache");
+
+    print_line(passed ? "\n*** Shader cache test passed" : "\n*** Shader cache test FAILED");
+    return nullptr;
+}
+} // namespace TestShaderCache
@@ -0,0 +1,311 @@
+/*************************************************************************/
+/*  test_texture_streaming.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_texture_streaming.h"
+#include "test_check.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/file_access.h"
+#include "core/print_string.h"
+#include "core/rid.h"
+#include "core/string_formatter.h"
+#include "scene/resources/texture.h"
+#include "servers/rendering/texture_streaming.h"
+#include "servers/rendering/texture_streaming_dummy.h"
+
+namespace TestTextureStreaming {
+
+static const int TEX_WIDTH = 256;
+static const int TEX_HEIGHT = 128;
+
+// Writes a raw RGBA8 .stex whose mip levels are filled with their index.
+static Error _write_stex(StringView p_path, bool p_mipmaps) {
+
+    FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE);
+    ERR_FAIL_COND_V(!f, ERR_CANT_CREATE);
+
+    f->store_buffer((const uint8_t *)"GDST", 4);
+    f->store_16(TEX_WIDTH);
+    f->store_16(0);
+    f->store_16(TEX_HEIGHT);
+    f->store_16(0);
+    f->store_32(Texture::FLAGS_DEFAULT);
+    uint32_t df = Image::FORMAT_RGBA8 | StreamTexture::FORMAT_BIT_STREAM;
+    if (p_mipmaps) {
+        df |= StreamTexture::FORMAT_BIT_HAS_MIPMAPS;
+    }
+    f->store_32(df);
+
+    const int mip_count = p_mipmaps ? Image::get_image_required_mipmaps(TEX_WIDTH, TEX_HEIGHT, Image::FORMAT_RGBA8) + 1 : 1;
+    Vector<uint8_t> level;
+    for (int i = 0; i < mip_count; i++) {
+        level.assign(M_MAX(1, TEX_WIDTH >> i) * M_MAX(1, TEX_HEIGHT >> i) * 4, uint8_t(i));
+        f->store_buffer(level.data(), level.size());
+    }
+    return OK;
+}
+
+static bool _test_layout(StringView p_path, StringView p_flat_path) {
+
+    bool passed = true;
+
+    FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+    CHECK(f);
+    if (!f) {
+        return false;
+    }
+
+    StexMipLayout layout;
+    CHECK(layout.parse(f) == OK);
+    CHECK(layout.width == TEX_WIDTH && layout.height == TEX_HEIGHT && layout.format == Image::FORMAT_RGBA8);
+    CHECK(layout.get_mip_count() == 9);
+    if (layout.get_mip_count() != 9) {
+        return false;
+    }
+    CHECK(layout.offsets[0] == 20 && layout.sizes[0] == TEX_WIDTH * TEX_HEIGHT * 4);
+    CHECK(layout.offsets[1] == layout.offsets[0] + layout.sizes[0] && layout.sizes[1] == TEX_WIDTH * TEX_HEIGHT);
+    CHECK(layout.sizes[8] == 4 && layout.get_mip_width(8) == 1 && layout.get_mip_height(7) == 1);
+
+    Ref<Image> chain = layout.read_chain(f, 3);
+    CHECK(chain && chain->get_width() == 32 && chain->get_height() == 16 && chain->get_mipmap_count() == 5);
+    if (chain) {
+        PoolVector<uint8_t>::Read r = chain->get_data().read();
+        CHECK(r[0] == 3 && r[chain->get_mipmap_offset(1)] == 4 && r[chain->get_data().size() - 1] == 8);
+    }
+
+    // without mipmaps there is nothing to stream
+    FileAccessRef flat = FileAccess::open(p_flat_path, FileAccess::READ);
+    StexMipLayout flat_layout;
+    CHECK(flat && flat_layout.parse(flat) == ERR_UNAVAILABLE);
+
+    return passed;
+}
+
+static bool _test_view() {
+
+    bool passed = true;
+    TextureStreamingView view;
+    CameraMatrix projection;
+
+    projection.set_orthogonal(10, 1, 0.1f, 100);
+    view.setup(Transform(), projection, 100);
+    CHECK(Math::is_equal_approx(view.get_screen_size(AABB(Vector3(-2, -1, -20), Vector3(4, 2, 2))), 40.0f));
+
+    // 90 degrees, so a unit at distance one spans half the viewport
+    projection.set_perspective(90, 1, 0.1f, 100);
+    view.setup(Transform(), projection, 100);
+    const float radius = Math::sqrt(3.0f);
+    CHECK(Math::abs(view.get_screen_size(AABB(Vector3(-1, -1, -11), Vector3(2, 2, 2))) - 100 / (10 - radius)) < 0.01f);
+    CHECK(view.get_screen_size(AABB(Vector3(-1, -1, -1), Vector3(2, 2, 2))) < 0);
+
+    TextureStreamingBackendDummy backend;
+    TextureStreamer streamer(&backend);
+    CHECK(streamer.get_mip_for_screen_size(256, 128, 9, 300) == 0);
+    CHECK(streamer.get_mip_for_screen_size(256, 128, 9, 200) == 0);
+    CHECK(streamer.get_mip_for_screen_size(256, 128, 9, 64) == 2);
+    CHECK(streamer.get_mip_for_screen_size(256, 128, 9, 0.5f) == 8);
+    streamer.set_mip_bias(1);
+    CHECK(streamer.get_mip_for_screen_size(256, 128, 9, 64) == 3);
+
+    return passed;
+}
+
+static bool _test_residency(StringView p_path) {
+
+    bool passed = true;
+
+    RID_Owner<RID_Data> owner;
+    RID_Data a_data, b_data, c_data;
+    RID a = owner.make_rid(&a_data);
+    RID b = owner.make_rid(&b_data);
+    RID c = owner.make_rid(&c_data);
+
+    StexMipLayout layout;
+    {
+        FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+        CHECK(f && layout.parse(f) == OK);
+    }
+    const uint64_t chain0 = layout.get_chain_size(0);
+    const uint64_t chain1 = layout.get_chain_size(1);
+    const uint64_t chain2 = layout.get_chain_size(2);
+    const uint64_t chain3 = layout.get_chain_size(3);
+
+    TextureStreamingBackendDummy backend;
+    TextureStreamer streamer(&backend);
+    streamer.set_min_resident_size(32);
+    streamer.set_keep_frames(2);
+
+    // only the tail is read when the texture is added
+    CHECK(streamer.add(a, p_path) == OK);
+    const TextureStreamingBackendDummy::Upload *upload = backend.get_upload(a);
+    CHECK(upload && upload->base_mip == 3 && upload->width == 32 && upload->height == 16 && upload->mip_count == 6);
+    CHECK(streamer.get_resident_size() == chain3);
+
+    // a request for full detail is read in the background
+    streamer.request(a, 300);
+    streamer.update(1);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(a) == 0 && backend.get_upload(a)->width == TEX_WIDTH);
+    CHECK(streamer.get_resident_size() == chain0 && streamer.get_pending_count() == 0);
+
+    // unused textures keep their detail for keep_frames, then fall back to the tail
+    streamer.update(2);
+    streamer.update(3);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(a) == 0);
+    streamer.update(4);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(a) == 3 && streamer.get_resident_size() == chain3);
+
+    // over budget, visible textures lose a level each
+    CHECK(streamer.add(b, p_path) == OK);
+    streamer.set_budget(chain0 + chain2);
+    streamer.request(a, -1);
+    streamer.request(b, -1);
+    streamer.update(5);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(a) == 1 && streamer.get_resident_mip(b) == 1);
+
+    // the texture not drawn last frame goes first, the other one waits until that memory is free
+    streamer.set_budget(chain0 + chain3);
+    streamer.request(a, -1);
+    streamer.update(6);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(b) == 3 && streamer.get_resident_mip(a) == 1);
+    streamer.request(a, -1);
+    streamer.update(7);
+    streamer.flush();
+    CHECK(streamer.get_resident_mip(a) == 0 && streamer.get_resident_mip(b) == 3);
+    CHECK(streamer.get_resident_size() == chain0 + chain3);
+
+    // reads for removed textures are dropped
+    streamer.set_budget(0);
+    streamer.request(b, -1);
+    const int uploads = backend.get_upload_count();
+    streamer.update(8);
+    streamer.remove(b);
+    streamer.flush();
+    CHECK(backend.get_upload_count() == uploads && backend.get_upload(b)->base_mip == 3);
+    CHECK(!streamer.has(b) && streamer.get_resident_mip(b) == -1);
+    CHECK(streamer.get_resident_size() == chain0);
+
+    // with streaming off the whole chain is uploaded and nothing is tracked
+    streamer.set_enabled(false);
+    CHECK(streamer.add(c, p_path) == OK);
+    CHECK(backend.get_upload(c) && backend.get_upload(c)->base_mip == 0 && backend.get_upload(c)->size == chain0);
+    CHECK(!streamer.has(c));
+
+    streamer.finish();
+    owner.free(a);
+    owner.free(b);
+    owner.free(c);
+    return passed;
+}
+
+
+// Canvas items and sky panoramas are never requested with a screen size by the 3D renderer, they still have to
+// reach full detail instead of staying at their tail.
+static bool _test_untracked_uses(StringView p_path) {
+
+    bool passed = true;
+
+    StexMipLayout layout;
+    {
+        FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+        CHECK(f && layout.parse(f) == OK);
+    }
+
+    // canvas bindings report full detail every frame they draw
+    RID_Owner<RID_Data> owner;
+    RID_Data canvas_data;
+    RID canvas = owner.make_rid(&canvas_data);
+    TextureStreamingBackendDummy backend;
+    TextureStreamer streamer(&backend);
+    streamer.set_min_resident_size(32);
+    streamer.set_keep_frames(2);
+    CHECK(streamer.add(canvas, p_path) == OK);
+    CHECK(streamer.get_resident_mip(canvas) == 3);
+    for (uint64_t frame = 1; frame <= 4; frame++) {
+        streamer.request(canvas, -1);
+        streamer.update(frame);
+        streamer.flush();
+        CHECK(streamer.get_resident_mip(canvas) == 0);
+    }
+    CHECK(backend.get_upload(canvas)->width == TEX_WIDTH && streamer.get_resident_size() == layout.get_chain_size(0));
+    streamer.finish();
+    owner.free(canvas);
+
+    // a sky panorama is read once into the radiance map, so it's loaded whole and left alone afterwards
+    RID_Data panorama_data;
+    RID panorama = owner.make_rid(&panorama_data);
+    TextureStreamingBackendDummy sky_backend;
+    TextureStreamer sky_streamer(&sky_backend);
+    sky_streamer.set_min_resident_size(32);
+    CHECK(sky_streamer.add(panorama, p_path) == OK);
+    CHECK(sky_streamer.get_resident_mip(panorama) == 3);
+    sky_streamer.load_full(panorama);
+    CHECK(!sky_streamer.has(panorama) && sky_streamer.get_resident_mip(panorama) == -1);
+    const TextureStreamingBackendDummy::Upload *upload = sky_backend.get_upload(panorama);
+    CHECK(upload && upload->base_mip == 0 && upload->width == TEX_WIDTH && upload->size == layout.get_chain_size(0));
+    // later frames don't take it back to the tail
+    for (uint64_t frame = 1; frame <= 4; frame++) {
+        sky_streamer.update(frame);
+        sky_streamer.flush();
+    }
+    CHECK(sky_backend.get_upload(panorama)->base_mip == 0);
+    sky_streamer.finish();
+    owner.free(panorama);
+
+    return passed;
+}
+
+MainLoop *test() {
+
+    print_line("\n*** Texture streaming");
+
+    const String path("user://test_texture_streaming.stex");
+    const String flat_path("user://test_texture_streaming_flat.stex");
+    if (_write_stex(path, true) != OK || _write_stex(flat_path, false) != OK) {
+        print_line("Texture streaming: FAILED, can't write test files");
+        return nullptr;
+    }
+
+    bool layout = _test_layout(path, flat_path);
+    bool view = _test_view();
+    bool residency = _test_residency(path);
+    bool untracked = _test_untracked_uses(path);
+    print_line(FormatVE("Layout: %s, screen size: %s, residency: %s, untracked uses: %s", layout ? "ok" : "FAILED",
+            view ? "ok" : "FAILED", residency ? "ok" : "FAILED", untracked ? "ok" : "FAILED"));
+
+    print_line(String("Texture streaming: ") + (layout && view && residency && untracked ? "passed" : "FAILED"));
+    return nullptr;
+}
+} // namespace TestTextureStreaming
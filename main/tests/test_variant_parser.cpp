@@ -0,0 +1,158 @@
+/*************************************************************************/
+/*  test_variant_parser.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_variant_parser.h"
+#include "test_check.h"
+
+#include "core/color.h"
+#include "core/math/vector3.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/variant.h"
+#include "core/variant_parser.h"
+
+#include "EASTL/unique_ptr.h"
+
+#include <clocale>
+
+namespace TestVariantParser {
+
+static bool _parse(const String &p_text, Variant &r_value) {
+
+    eastl::unique_ptr<VariantParserStream, wrap_deleter> stream(VariantParser::get_string_stream(p_text));
+    String err_str;
+    int err_line = 0;
+    Error err = VariantParser::parse(stream.get(), r_value, err_str, err_line);
+    if (err != OK) {
+        print_line(FormatVE("  parse error at line %d: %s", err_line, err_str.c_str()));
+        return false;
+    }
+    return true;
+}
+
+static bool test_values() {
+
+    bool passed = true;
+    Variant v;
+
+    CHECK(_parse("-12345", v) && v.get_type() == VariantType::INT && v.as<int>() == -12345);
+    CHECK(_parse("0.1", v) && v.get_type() == VariantType::FLOAT && v.as<double>() == 0.1);
+    CHECK(_parse("-1.5e-7", v) && v.as<double>() == -1.5e-7);
+    CHECK(_parse("1e300", v) && v.as<double>() == 1e300);
+    CHECK(_parse("\"a \\\"quoted\\\"\\nstring\"", v) && v.as<String>() == "a \"quoted\"\nstring");
+    CHECK(_parse("Vector3( 1, -2.5 ,3e1 )", v) && v.as<Vector3>() == Vector3(1, -2.5, 30));
+
+    CHECK(_parse("PoolVector3Array( 1, 2, 3, ; comment\n 4, 5, 6 )", v));
+    PoolVector<Vector3> arr = v.as<PoolVector<Vector3>>();
+    CHECK(arr.size() == 2 && arr[1] == Vector3(4, 5, 6));
+
+    CHECK(_parse("PoolIntArray(  )", v) && v.as<PoolVector<int>>().size() == 0);
+    CHECK(_parse("PoolColorArray( 1, 0, 0, 1 )", v) && v.as<PoolVector<Color>>()[0] == Color(1, 0, 0, 1));
+
+    // Integers beyond the int64 range turn into floats instead of wrapping around.
+    CHECK(_parse("9223372036854775807", v) && v.get_type() == VariantType::INT && v.as<int64_t>() == INT64_MAX);
+    CHECK(_parse("-9223372036854775808", v) && v.get_type() == VariantType::INT && v.as<int64_t>() == INT64_MIN);
+    CHECK(_parse("9223372036854775808", v) && v.get_type() == VariantType::FLOAT && v.as<double>() == 9223372036854775808.0);
+    CHECK(_parse("-123456789012345678901234", v) && v.get_type() == VariantType::FLOAT && v.as<double>() == -123456789012345678901234.0);
+
+    String err_str;
+    int line = 0;
+    eastl::unique_ptr<VariantParserStream, wrap_deleter> bad(VariantParser::get_string_stream(String("PoolRealArray( 1, 2, )")));
+    CHECK(VariantParser::parse(bad.get(), v, err_str, line) != OK);
+
+    print_line(String("Parsed values: ") + (passed ? "passed" : "FAILED"));
+    return passed;
+}
+
+static bool test_locale() {
+
+    bool passed = true;
+    Variant v;
+
+    // The editor sets the process locale from the environment, parsing must not depend on its decimal separator.
+    String prev_locale(setlocale(LC_NUMERIC, nullptr));
+    const char *comma_locales[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "German_Germany.1252" };
+    bool comma_locale = false;
+    for (const char *locale : comma_locales) {
+        if (setlocale(LC_NUMERIC, locale)) {
+            comma_locale = true;
+            break;
+        }
+    }
+
+    CHECK(_parse("1.5", v) && v.as<double>() == 1.5);
+    CHECK(_parse("0.30000000000000004", v) && v.as<double>() == 0.30000000000000004);
+    CHECK(_parse("-2.5e-320", v) && v.as<double>() == -2.5e-320);
+    CHECK(_parse("Vector3( 1.25, -1024.5, 0.375 )", v) && v.as<Vector3>() == Vector3(1.25f, -1024.5f, 0.375f));
+
+    setlocale(LC_NUMERIC, prev_locale.c_str());
+
+    print_line(String("Parsing under a comma decimal locale: ") + (passed ? "passed" : "FAILED") + (comma_locale ? "" : " (no such locale installed)"));
+    return passed;
+}
+
+static void bench_arrays() {
+
+    // a mesh-sized array, the kind of data that dominates large .tscn/.tres files
+    const int count = 1 << 18;
+    PoolVector<Vector3> src;
+    src.resize(count);
+    {
+        PoolVector<Vector3>::Write w = src.write();
+        for (int i = 0; i < count; i++) {
+            w[i] = Vector3(i * 0.25f, -i * 0.125f, i % 1000);
+        }
+    }
+    String text;
+    VariantWriter::write_to_string(src, text);
+
+    uint64_t t = OS::get_singleton()->get_ticks_usec();
+    Variant v;
+    bool ok = _parse(text, v);
+    uint64_t elapsed = M_MAX(OS::get_singleton()->get_ticks_usec() - t, uint64_t(1));
+
+    PoolVector<Vector3> parsed = v.as<PoolVector<Vector3>>();
+    ok &= parsed.size() == count && parsed[count - 1] == src[count - 1];
+    print_line(FormatVE("PoolVector3Array, %d elements: %10.3f ms, %8.1f MB/s, results %s", count, elapsed / 1000.0,
+            text.size() / double(elapsed), ok ? "valid" : "INVALID"));
+}
+
+MainLoop *test() {
+
+    print_line("\n*** VariantParser");
+    test_values();
+    test_locale();
+    bench_arrays();
+    return nullptr;
+}
+} // namespace TestVariantParser
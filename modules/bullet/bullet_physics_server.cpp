@@ -32,6 +32,7 @@
 
 #include "bullet_utilities.h"
 #include "cone_twist_joint_bullet.h"
+#include "godot_task_scheduler.h"
 #include "generic_6dof_joint_bullet.h"
 #include "hinge_joint_bullet.h"
 #include "pin_joint_bullet.h"
@@ -93,7 +94,8 @@ void BulletPhysicsServer::_bind_methods() {
 
 BulletPhysicsServer::BulletPhysicsServer() :
         active(true),
-        active_spaces_count(0) {}
+        active_spaces_count(0),
+        task_scheduler(nullptr) {}
 
 BulletPhysicsServer::~BulletPhysicsServer() {}
 
@@ -1567,6 +1569,10 @@ void BulletPhysicsServer::free_rid(RID p_rid) {
 void BulletPhysicsServer::init() {
     BulletPhysicsDirectBodyState::initialize_class();
     BulletPhysicsDirectBodyState::initSingleton();
+
+    // needed by spaces using the multithreaded world, the thread calling this becomes Bullet's main thread
+    task_scheduler = bulletnew(GodotTaskScheduler);
+    btSetTaskScheduler(task_scheduler);
 }
 
 void BulletPhysicsServer::step(float p_deltaTime) {
@@ -1589,6 +1595,9 @@ void BulletPhysicsServer::flush_queries() {
 
 void BulletPhysicsServer::finish() {
     BulletPhysicsDirectBodyState::destroySingleton();
+
+    btSetTaskScheduler(nullptr);
+    bulletdelete(task_scheduler);
 }
 
 int BulletPhysicsServer::get_process_info(ProcessInfo p_info) {
@@ -44,6 +44,7 @@ class SoftBodyBullet;
 class JointBullet;
 class CollisionObjectBullet;
 class RigidCollisionObjectBullet;
+class GodotTaskScheduler;
 
 class GODOT_EXPORT BulletPhysicsServer : public PhysicsServer3D {
     GDCLASS(BulletPhysicsServer,PhysicsServer3D)
@@ -53,6 +54,7 @@ class GODOT_EXPORT BulletPhysicsServer : public PhysicsServer3D {
     bool active;
     char active_spaces_count;
     Vector<SpaceBullet *> active_spaces;
+    GodotTaskScheduler *task_scheduler;
 
     mutable RID_Owner<SpaceBullet> space_owner;
     mutable RID_Owner<ShapeBullet> shape_owner;
@@ -33,6 +33,7 @@
 #include <stdint.h>
 
 #include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 
 /**
 	@author AndreaCatania
@@ -40,11 +41,18 @@
 
 /// This class is required to implement custom collision behaviour in the narrowphase
 class GodotCollisionDispatcher : public btCollisionDispatcher {
-private:
+public:
 	static const int CASTED_TYPE_AREA;
 
-public:
 	GodotCollisionDispatcher(btCollisionConfiguration *collisionConfiguration);
 	bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) override;
 	bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1) override;
 };
+
+/// Same narrowphase rules as GodotCollisionDispatcher, pairs are processed in parallel by the task scheduler
+class GodotCollisionDispatcherMt : public btCollisionDispatcherMt {
+public:
+	GodotCollisionDispatcherMt(btCollisionConfiguration *collisionConfiguration);
+	bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) override;
+	bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1) override;
+};
@@ -0,0 +1,92 @@
+/*************************************************************************/
+/*  godot_task_scheduler.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "godot_task_scheduler.h"
+
+#include "core/os/worker_thread_pool.h"
+#include "core/typedefs.h"
+#include "core/vector.h"
+
+GodotTaskScheduler::GodotTaskScheduler() :
+        btITaskScheduler("Godot") {
+}
+
+int GodotTaskScheduler::getMaxNumThreads() const {
+    return BT_MAX_THREAD_COUNT;
+}
+
+int GodotTaskScheduler::getNumThreads() const {
+    // the calling thread takes part in every loop
+    return MIN(WorkerThreadPool::get_singleton()->get_thread_count() + 1, int(BT_MAX_THREAD_COUNT));
+}
+
+void GodotTaskScheduler::setNumThreads(int numThreads) {
+    // the pool is shared with the rest of the engine, its size is not up to the physics
+}
+
+void GodotTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) {
+
+    const int grain = M_MAX(grainSize, 1);
+    const int chunk_count = (iEnd - iBegin + grain - 1) / grain;
+    if (chunk_count <= 1) {
+        if (iEnd > iBegin)
+            body.forLoop(iBegin, iEnd);
+        return;
+    }
+
+    WorkerThreadPool::get_singleton()->parallel_for(chunk_count, [&](uint32_t p_chunk) {
+        const int begin = iBegin + int(p_chunk) * grain;
+        body.forLoop(begin, MIN(begin + grain, iEnd));
+    });
+}
+
+btScalar GodotTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) {
+
+    const int grain = M_MAX(grainSize, 1);
+    const int chunk_count = (iEnd - iBegin + grain - 1) / grain;
+    if (chunk_count <= 1) {
+        return iEnd > iBegin ? body.sumLoop(iBegin, iEnd) : btScalar(0);
+    }
+
+    // summed in chunk order, so the result doesn't depend on which thread finished first
+    Vector<btScalar> sums;
+    sums.resize(chunk_count);
+    WorkerThreadPool::get_singleton()->parallel_for(chunk_count, [&](uint32_t p_chunk) {
+        const int begin = iBegin + int(p_chunk) * grain;
+        sums[p_chunk] = body.sumLoop(begin, MIN(begin + grain, iEnd));
+    });
+
+    btScalar sum = 0;
+    for (btScalar chunk_sum : sums) {
+        sum += chunk_sum;
+    }
+    return sum;
+}
@@ -41,6 +41,7 @@
 #include "shape_bullet.h"
 #include "area_bullet.h"
 #include "core/class_db.h"
+#include "core/external_profiler.h"
 #include "core/object_db.h"
 #include "core/project_settings.h"
 #include "core/ustring.h"
@@ -54,6 +55,8 @@
 #include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <btBulletDynamicsCommon.h>
 
 #include <cassert>
@@ -347,6 +350,7 @@ SpaceBullet::SpaceBullet() :
         collisionConfiguration(nullptr),
         dispatcher(nullptr),
         solver(nullptr),
+        solver_mt(nullptr),
         dynamicsWorld(nullptr),
         soft_body_world_info(nullptr),
         ghostPairCallback(nullptr),
@@ -358,7 +362,12 @@ SpaceBullet::SpaceBullet() :
         contactDebugCount(0),
         delta_time(0.) {
 
-    create_empty_world(T_GLOBAL_DEF("physics/3d/active_soft_world", true));
+    const bool soft_world = T_GLOBAL_DEF("physics/3d/active_soft_world", true);
+    const bool multithreaded = T_GLOBAL_DEF("physics/3d/multithreaded_world", false);
+    if (soft_world && multithreaded) {
+        WARN_PRINT_ONCE("Soft bodies can't be simulated by the multithreaded physics world, disable 'physics/3d/active_soft_world' to use it.");
+    }
+    create_empty_world(soft_world, multithreaded && !soft_world);
     direct_access = memnew(BulletPhysicsDirectSpaceState(this));
 }
 
@@ -375,6 +384,7 @@ void SpaceBullet::flush_queries() {
 }
 
 void SpaceBullet::step(real_t p_delta_time) {
+    SCOPE_PROFILE(bullet_step);
     delta_time = p_delta_time;
     dynamicsWorld->stepSimulation(p_delta_time, 0, 0);
 }
@@ -596,7 +606,7 @@ btScalar calculateGodotCombinedFriction(const btCollisionObject *body0, const bt
     return ABS(MIN(body0->getFriction(), body1->getFriction()));
 }
 
-void SpaceBullet::create_empty_world(bool p_create_soft_world) {
+void SpaceBullet::create_empty_world(bool p_create_soft_world, bool p_multithreaded) {
 
     gjk_epa_pen_solver = bulletnew(btGjkEpaPenetrationDepthSolver);
     gjk_simplex_solver = bulletnew(btVoronoiSimplexSolver);
@@ -604,6 +614,8 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
     void *world_mem;
     if (p_create_soft_world) {
         world_mem = malloc(sizeof(btSoftRigidDynamicsWorld));
+    } else if (p_multithreaded) {
+        world_mem = malloc(sizeof(btDiscreteDynamicsWorldMt));
     } else {
         world_mem = malloc(sizeof(btDiscreteDynamicsWorld));
     }
@@ -616,13 +628,23 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
         collisionConfiguration = bulletnew(GodotCollisionConfiguration(static_cast<btDiscreteDynamicsWorld *>(world_mem)));
     }
 
-    dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
     broadphase = bulletnew(btDbvtBroadphase);
-    solver = bulletnew(btSequentialImpulseConstraintSolver);
+
+    if (p_multithreaded) {
+        // islands are solved concurrently, each by a solver of the pool, the largest ones are split by solver_mt
+        dispatcher = bulletnew(GodotCollisionDispatcherMt(collisionConfiguration));
+        solver = bulletnew(btConstraintSolverPoolMt(btGetTaskScheduler()->getNumThreads()));
+        solver_mt = bulletnew(btSequentialImpulseConstraintSolverMt);
+    } else {
+        dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
+        solver = bulletnew(btSequentialImpulseConstraintSolver);
+    }
 
     if (p_create_soft_world) {
         dynamicsWorld = new (world_mem) btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
         soft_body_world_info = bulletnew(btSoftBodyWorldInfo);
+    } else if (p_multithreaded) {
+        dynamicsWorld = new (world_mem) btDiscreteDynamicsWorldMt(dispatcher, broadphase, static_cast<btConstraintSolverPoolMt *>(solver), solver_mt, collisionConfiguration);
     } else {
         dynamicsWorld = new (world_mem) btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
     }
@@ -665,6 +687,7 @@ void SpaceBullet::destroy_world() {
     dynamicsWorld = nullptr;
 
     bulletdelete(solver);
+    bulletdelete(solver_mt);
     bulletdelete(broadphase);
     bulletdelete(dispatcher);
     bulletdelete(collisionConfiguration);
@@ -96,6 +96,7 @@ class SpaceBullet : public RIDBullet {
     btDefaultCollisionConfiguration *collisionConfiguration;
     btCollisionDispatcher *dispatcher;
     btConstraintSolver *solver;
+    btConstraintSolver *solver_mt; // solves large islands in parallel, multithreaded world only
     btDiscreteDynamicsWorld *dynamicsWorld;
     btSoftBodyWorldInfo *soft_body_world_info;
     btGhostPairCallback *ghostPairCallback;
@@ -188,7 +189,7 @@ public:
     int test_ray_separation(RigidBodyBullet *p_body, const Transform &p_transform, bool p_infinite_inertia, Vector3 &r_recover_motion, PhysicsServer3D::SeparationResult *r_results, int p_result_max, float p_margin);
 
 private:
-    void create_empty_world(bool p_create_soft_world);
+    void create_empty_world(bool p_create_soft_world, bool p_multithreaded);
     void destroy_world();
     void check_ghost_overlaps();
     void check_body_collision();
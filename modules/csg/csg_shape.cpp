@@ -32,8 +32,11 @@
 
 #include "core/callable_method_pointer.h"
 #include "core/hashfuncs.h"
+#include "core/message_queue.h"
 #include "core/method_bind.h"
+#include "core/object_db.h"
 #include "core/object_tooling.h"
+#include "core/os/worker_thread_pool.h"
 #include "scene/3d/path_3d.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/world_3d.h"
@@ -168,6 +171,7 @@ void CSGShape::_make_dirty() {
     if (!is_inside_tree())
         return;
 
+    dirty_serial++;
     if (parent) {
         parent->_make_dirty();
     } else if (!dirty) {
@@ -177,72 +181,142 @@ void CSGShape::_make_dirty() {
     dirty = true;
 }
 
-CSGBrush *CSGShape::_get_brush() {
+static eastl::shared_ptr<CSGBrush> _make_shared_brush(CSGBrush *p_brush) {
 
-    if (dirty) {
-        if (brush) {
-            memdelete(brush);
+    return eastl::shared_ptr<CSGBrush>(p_brush, wrap_deleter());
+}
+
+int CSGShape::_collect_build_nodes(BuildTree &r_tree) {
+
+    int index = r_tree.nodes.size();
+    r_tree.nodes.emplace_back();
+    {
+        BuildNode &bn = r_tree.nodes[index];
+        bn.owner = get_instance_id();
+        bn.serial = dirty_serial;
+        bn.snap = snap;
+        bn.dirty = dirty;
+        if (!dirty) {
+            // subtree is unchanged, reuse the cached brush
+            bn.result = brush;
+            bn.aabb = node_aabb;
+            return index;
+        }
+        CSGBrush *own = _build_brush();
+        if (own) {
+            bn.own_brush = _make_shared_brush(own);
         }
-        brush = nullptr;
+    }
 
-        CSGBrush *n = _build_brush();
+    for (int i = 0; i < get_child_count(); i++) {
 
-        for (int i = 0; i < get_child_count(); i++) {
+        CSGShape *child = object_cast<CSGShape>(get_child(i));
+        if (!child)
+            continue;
+        if (!child->is_visible_in_tree())
+            continue;
 
-            CSGShape *child = object_cast<CSGShape>(get_child(i));
-            if (!child)
-                continue;
-            if (!child->is_visible_in_tree())
-                continue;
+        BuildNode::Child c;
+        c.index = child->_collect_build_nodes(r_tree);
+        c.xform = child->get_transform();
+        switch (child->get_operation()) {
+            case CSGShape::OPERATION_UNION: c.operation = CSGBrushOperation::OPERATION_UNION; break;
+            case CSGShape::OPERATION_INTERSECTION: c.operation = CSGBrushOperation::OPERATION_INTERSECTION; break;
+            case CSGShape::OPERATION_SUBTRACTION: c.operation = CSGBrushOperation::OPERATION_SUBSTRACTION; break;
+        }
+        // nodes may have been reallocated by the recursive call
+        r_tree.nodes[index].children.emplace_back(c);
+    }
 
-            CSGBrush *n2 = child->_get_brush();
-            if (!n2)
-                continue;
-            if (!n) {
-                n = memnew(CSGBrush);
+    return index;
+}
 
-                n->copy_from(*n2, child->get_transform());
+void CSGShape::_evaluate_build_node(BuildTree &p_tree, int p_index) {
 
-            } else {
+    BuildNode &bn = p_tree.nodes[p_index];
+    if (!bn.dirty)
+        return;
 
-                CSGBrush *nn = memnew(CSGBrush);
-                CSGBrush *nn2 = memnew(CSGBrush);
-                nn2->copy_from(*n2, child->get_transform());
+    // independent dirty subtrees are evaluated concurrently, the merges below depend on child order
+    FixedVector<int, 16, true> dirty_children;
+    for (const BuildNode::Child &c : bn.children) {
+        if (p_tree.nodes[c.index].dirty)
+            dirty_children.push_back(c.index);
+    }
+    if (dirty_children.size() > 1) {
+        WorkerThreadPool::get_singleton()->parallel_for(dirty_children.size(), [&p_tree, &dirty_children](uint32_t i) {
+            _evaluate_build_node(p_tree, dirty_children[i]);
+        });
+    } else if (!dirty_children.empty()) {
+        _evaluate_build_node(p_tree, dirty_children[0]);
+    }
 
-                CSGBrushOperation bop;
+    eastl::shared_ptr<CSGBrush> n = bn.own_brush;
 
-                switch (child->get_operation()) {
-                    case CSGShape::OPERATION_UNION: bop.merge_brushes(CSGBrushOperation::OPERATION_UNION, *n, *nn2, *nn, snap); break;
-                    case CSGShape::OPERATION_INTERSECTION: bop.merge_brushes(CSGBrushOperation::OPERATION_INTERSECTION, *n, *nn2, *nn, snap); break;
-                    case CSGShape::OPERATION_SUBTRACTION: bop.merge_brushes(CSGBrushOperation::OPERATION_SUBSTRACTION, *n, *nn2, *nn, snap); break;
-                }
-                memdelete(n);
-                memdelete(nn2);
-                n = nn;
-            }
+    for (const BuildNode::Child &c : bn.children) {
+
+        const eastl::shared_ptr<CSGBrush> &n2 = p_tree.nodes[c.index].result;
+        if (!n2)
+            continue;
+        if (!n) {
+            n = _make_shared_brush(memnew(CSGBrush));
+
+            n->copy_from(*n2, c.xform);
+
+        } else {
+
+            eastl::shared_ptr<CSGBrush> nn = _make_shared_brush(memnew(CSGBrush));
+            CSGBrush nn2;
+            nn2.copy_from(*n2, c.xform);
+
+            CSGBrushOperation bop;
+            bop.merge_brushes(c.operation, *n, nn2, *nn, bn.snap);
+            n = nn;
         }
+    }
 
-        if (n) {
-            AABB aabb;
-            for (int i = 0; i < n->faces.size(); i++) {
-                for (int j = 0; j < 3; j++) {
-                    if (i == 0 && j == 0)
-                        aabb.position = n->faces[i].vertices[j];
-                    else
-                        aabb.expand_to(n->faces[i].vertices[j]);
-                }
+    if (n) {
+        AABB aabb;
+        for (int i = 0; i < n->faces.size(); i++) {
+            for (int j = 0; j < 3; j++) {
+                if (i == 0 && j == 0)
+                    aabb.position = n->faces[i].vertices[j];
+                else
+                    aabb.expand_to(n->faces[i].vertices[j]);
             }
-            node_aabb = aabb;
-        } else {
-            node_aabb = AABB();
         }
+        bn.aabb = aabb;
+    } else {
+        bn.aabb = AABB();
+    }
 
-        brush = n;
+    bn.result = n;
+}
+
+void CSGShape::_apply_build_nodes(const BuildTree &p_tree) {
 
-        dirty = false;
+    for (const BuildNode &bn : p_tree.nodes) {
+        if (!bn.dirty)
+            continue;
+        CSGShape *cs = object_cast<CSGShape>(ObjectDB::get_instance(bn.owner));
+        if (!cs || cs->dirty_serial != bn.serial)
+            continue; // node is gone, or was changed after the snapshot was taken
+        cs->brush = bn.result;
+        cs->node_aabb = bn.aabb;
+        cs->dirty = false;
     }
+}
 
-    return brush;
+CSGBrush *CSGShape::_get_brush() {
+
+    if (dirty) {
+        BuildTree tree;
+        _collect_build_nodes(tree);
+        _evaluate_build_node(tree, 0);
+        _apply_build_nodes(tree);
+    }
+
+    return brush.get();
 }
 
 int CSGShape::mikktGetNumFaces(const SMikkTSpaceContext *pContext) {
@@ -304,12 +378,35 @@ void CSGShape::_update_shape() {
 
     if (parent)
         return;
+    if (shape_update_pending)
+        return; // the running update re-queues itself when it completes with outdated data
+
+    BuildTree *tree = memnew(BuildTree);
+    tree->calculate_tangents = calculate_tangents;
+    tree->build_collision = bool(root_collision_shape);
+    _collect_build_nodes(*tree);
+
+    shape_update_pending = true;
+    eastl::shared_ptr<BuildTree> shared_tree(tree, wrap_deleter());
+    ObjectID owner = get_instance_id();
+
+    WorkerThreadPool::get_singleton()->add_task([shared_tree, owner]() {
+        _evaluate_build_node(*shared_tree, 0);
+        _build_surfaces(*shared_tree);
+        MessageQueue::get_singleton()->push_call(owner, [shared_tree, owner]() {
+            CSGShape *cs = object_cast<CSGShape>(ObjectDB::get_instance(owner));
+            if (cs) {
+                cs->_commit_shape(*shared_tree);
+            }
+        });
+    });
+}
 
-    set_base(RID());
-    root_mesh.unref(); //byebye root mesh
+void CSGShape::_build_surfaces(BuildTree &p_tree) {
 
-    CSGBrush *n = _get_brush();
-    ERR_FAIL_COND_MSG(!n, "Cannot get CSGBrush.");
+    const CSGBrush *n = p_tree.nodes[0].result.get();
+    if (!n)
+        return;
 
     OAHashMap<Vector3, Vector3> vec_map;
 
@@ -336,7 +433,7 @@ void CSGShape::_update_shape() {
         face_count[idx]++;
     }
 
-    Vector<ShapeUpdateSurface> surfaces;
+    Vector<ShapeUpdateSurface> &surfaces(p_tree.surfaces);
 
     surfaces.resize(face_count.size());
 
@@ -346,7 +443,7 @@ void CSGShape::_update_shape() {
         surfaces[i].vertices.resize(face_count[i] * 3);
         surfaces[i].normals.resize(face_count[i] * 3);
         surfaces[i].uvs.resize(face_count[i] * 3);
-        if (calculate_tangents) {
+        if (p_tree.calculate_tangents) {
             surfaces[i].tans.resize(face_count[i] * 3 * 4);
         }
         surfaces[i].last_added = 0;
@@ -357,9 +454,9 @@ void CSGShape::_update_shape() {
     }
 
     // Update collision faces.
-    if (root_collision_shape) {
+    if (p_tree.build_collision) {
 
-        PoolVector<Vector3> physics_faces;
+        PoolVector<Vector3> &physics_faces(p_tree.physics_faces);
         physics_faces.resize(n->faces.size() * 3);
         PoolVector<Vector3>::Write physicsw = physics_faces.write();
 
@@ -375,8 +472,6 @@ void CSGShape::_update_shape() {
             physicsw[i * 3 + 1] = n->faces[i].vertices[order[1]];
             physicsw[i * 3 + 2] = n->faces[i].vertices[order[2]];
         }
-
-        root_collision_shape->set_faces(physics_faces);
     }
     //fill arrays
     {
@@ -416,7 +511,7 @@ void CSGShape::_update_shape() {
                 surfaces[idx].uvs[k] = n->faces[i].uvs[j];
                 surfaces[idx].normals[k] = normal;
 
-                if (calculate_tangents) {
+                if (p_tree.calculate_tangents) {
                     // zero out our tangents for now
                     k *= 4;
                     surfaces[idx].tans[k++] = 0.0;
@@ -430,13 +525,10 @@ void CSGShape::_update_shape() {
         }
     }
 
-    root_mesh = make_ref_counted<ArrayMesh>();
-    //create surfaces
-
+    // calculate tangents for each surface
     for (int i = 0; i < surfaces.size(); i++) {
-        // calculate tangents for this surface
-        bool have_tangents = calculate_tangents;
-        if (have_tangents) {
+        surfaces[i].have_tangents = p_tree.calculate_tangents;
+        if (surfaces[i].have_tangents) {
             SMikkTSpaceInterface mkif;
             mkif.m_getNormal = mikktGetNormal;
             mkif.m_getNumFaces = mikktGetNumFaces;
@@ -449,25 +541,56 @@ void CSGShape::_update_shape() {
             SMikkTSpaceContext msc;
             msc.m_pInterface = &mkif;
             msc.m_pUserData = &surfaces[i];
-            have_tangents = genTangSpaceDefault(&msc);
+            surfaces[i].have_tangents = genTangSpaceDefault(&msc);
         }
+    }
+}
+
+void CSGShape::_commit_shape(BuildTree &p_tree) {
 
-        if (surfaces[i].last_added == 0)
+    shape_update_pending = false;
+    _apply_build_nodes(p_tree);
+
+    if (parent || !is_inside_tree())
+        return; // became a child or left the tree while evaluating
+
+    if (p_tree.nodes[0].serial != dirty_serial) {
+        // changed while evaluating, unchanged subtrees were cached above so the next pass is cheaper; the stale
+        // result isn't shown, the current mesh stays until that pass commits
+        call_deferred("_update_shape");
+        return;
+    }
+
+    set_base(RID());
+    root_mesh.unref(); //byebye root mesh
+
+    ERR_FAIL_COND_MSG(!p_tree.nodes[0].result, "Cannot get CSGBrush.");
+
+    if (root_collision_shape && p_tree.build_collision) {
+        root_collision_shape->set_faces(p_tree.physics_faces);
+    }
+
+    root_mesh = make_ref_counted<ArrayMesh>();
+    //create surfaces
+
+    for (ShapeUpdateSurface &surface : p_tree.surfaces) {
+
+        if (surface.last_added == 0)
             continue;
 
         // and convert to surface array
         SurfaceArrays array;
 
-        array.set_positions(eastl::move(surfaces[i].vertices));
-        array.m_normals = eastl::move(surfaces[i].normals);
-        array.m_uv_1 = eastl::move(surfaces[i].uvs);
-        if (have_tangents) {
-            array.m_tangents = eastl::move(surfaces[i].tans);
+        array.set_positions(eastl::move(surface.vertices));
+        array.m_normals = eastl::move(surface.normals);
+        array.m_uv_1 = eastl::move(surface.uvs);
+        if (surface.have_tangents) {
+            array.m_tangents = eastl::move(surface.tans);
         }
 
         int idx = root_mesh->get_surface_count();
         root_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, eastl::move(array));
-        root_mesh->surface_set_material(idx, surfaces[i].material);
+        root_mesh->surface_set_material(idx, surface.material);
     }
 
     set_base(root_mesh->get_rid());
@@ -648,8 +771,9 @@ void CSGShape::_bind_methods() {
 CSGShape::CSGShape() {
     operation = OPERATION_UNION;
     parent = nullptr;
-    brush = nullptr;
     dirty = false;
+    shape_update_pending = false;
+    dirty_serial = 0;
     snap = 0.001f;
     use_collision = false;
     collision_layer = 1;
@@ -658,12 +782,7 @@ CSGShape::CSGShape() {
     set_notify_local_transform(true);
 }
 
-CSGShape::~CSGShape() {
-    if (brush) {
-        memdelete(brush);
-        brush = nullptr;
-    }
-}
+CSGShape::~CSGShape() = default;
 //////////////////////////////////
 
 CSGBrush *CSGCombiner::_build_brush() {
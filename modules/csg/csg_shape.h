@@ -37,6 +37,8 @@
 #include "scene/resources/concave_polygon_shape_3d.h"
 #include "thirdparty/misc/mikktspace.h"
 
+#include "EASTL/shared_ptr.h"
+
 class Mesh;
 
 
@@ -55,11 +57,13 @@ private:
     Operation operation;
     CSGShape *parent;
 
-    CSGBrush *brush;
+    eastl::shared_ptr<CSGBrush> brush; // cached result of this node's subtree, in local space
 
     AABB node_aabb;
 
     bool dirty;
+    bool shape_update_pending;
+    uint64_t dirty_serial; // bumped on every change, used to reject results of outdated evaluations
     float snap;
 
     bool use_collision;
@@ -88,6 +92,35 @@ private:
         Vector<float> tans;
         Ref<Material> material;
         int last_added;
+        bool have_tangents;
+    };
+
+    /**
+     * @brief Snapshot of a CSG node taken on the main thread, evaluated on worker threads.
+     * Clean nodes only carry their cached brush, dirty ones their own brush and their children.
+     */
+    struct BuildNode {
+        struct Child {
+            int index;
+            Transform xform;
+            CSGBrushOperation::Operation operation;
+        };
+        eastl::shared_ptr<CSGBrush> own_brush;
+        eastl::shared_ptr<CSGBrush> result;
+        Vector<Child> children;
+        AABB aabb;
+        ObjectID owner;
+        uint64_t serial;
+        float snap;
+        bool dirty;
+    };
+
+    struct BuildTree {
+        Vector<BuildNode> nodes; // nodes[0] is the root of the evaluation
+        Vector<ShapeUpdateSurface> surfaces;
+        PoolVector<Vector3> physics_faces;
+        bool calculate_tangents = false;
+        bool build_collision = false;
     };
 
     //mikktspace callbacks
@@ -100,6 +133,11 @@ private:
             const tbool bIsOrientationPreserving, const int iFace, const int iVert);
 
     void _update_shape();
+    int _collect_build_nodes(BuildTree &r_tree);
+    static void _evaluate_build_node(BuildTree &p_tree, int p_index);
+    static void _build_surfaces(BuildTree &p_tree);
+    void _apply_build_nodes(const BuildTree &p_tree);
+    void _commit_shape(BuildTree &p_tree);
 
 protected:
     void _notification(int p_what);
@@ -34,14 +34,21 @@
 #include "core/pair.h"
 #include "core/message_queue.h"
 #include "core/method_bind.h"
+#include "core/object_db.h"
+#include "core/os/worker_thread_pool.h"
+#include "scene/3d/camera_3d.h"
 #include "scene/3d/light_3d.h"
 #include "scene/resources/mesh_library.h"
 #include "scene/resources/surface_tool.h"
+#include "scene/main/viewport.h"
 #include "scene/scene_string_names.h"
 #include "servers/navigation_server.h"
 #include "scene/main/scene_tree.h"
 #include "servers/rendering_server.h"
 #include "core/string.h"
+
+#include "EASTL/sort.h"
+
 IMPL_GDCLASS(GridMap)
 
 using namespace eastl;
@@ -411,11 +418,7 @@ void GridMap::_octant_transform(const OctantKey &p_key) {
     }
 }
 
-bool GridMap::_octant_update(const OctantKey &p_key) {
-    ERR_FAIL_COND_V(!octant_map.contains(p_key), false);
-    Octant &g = *octant_map[p_key];
-    if (!g.dirty)
-        return false;
+void GridMap::_octant_clear_geometry(Octant &g) {
 
     //erase body shapes
     PhysicsServer3D::get_singleton()->body_clear_shapes(g.static_body);
@@ -441,130 +444,175 @@ bool GridMap::_octant_update(const OctantKey &p_key) {
         RenderingServer::get_singleton()->free_rid(g.multimesh_instances[i].multimesh);
     }
     g.multimesh_instances.clear();
+}
 
-    if (g.cells.empty()) {
-        //octant no longer needed
-        _octant_clean_up(p_key);
-        return true;
-    }
+void GridMap::_octant_queue_bake(const OctantKey &p_key, OctantBakeData *p_data) {
 
-    Vector<Vector3> col_debug;
+    // Ownership of p_data passes to the bake task, and from it to the commit call queued on the main thread.
+    eastl::shared_ptr<OctantBakeData> data(p_data, wrap_deleter());
+    ObjectID owner = get_instance_id();
 
-    /*
-     * foreach item in this octant,
-     * set item's multimesh's instance count to number of cells which have this item
-     * and set said multimesh bounding box to one containing all cells which have this item
-     */
+    WorkerThreadPool::get_singleton()->add_task([data, owner, p_key]() {
+        _octant_bake(*data);
+        MessageQueue::get_singleton()->push_call(owner, [data, owner, p_key]() {
+            GridMap *gm = object_cast<GridMap>(ObjectDB::get_instance(owner));
+            if (gm) {
+                gm->_octant_commit(p_key, *data);
+            }
+        });
+    });
+}
 
-    Map<int, Vector<Pair<Transform, IndexKey> > > multimesh_items;
+/*
+ * Runs on a worker thread, only reads the snapshot in p_data and writes its outputs.
+ * foreach item in this octant,
+ * collect the transforms of the cells which use the item's mesh, shapes and navmesh
+ */
+void GridMap::_octant_bake(OctantBakeData &p_data) {
 
-    for (IndexKey E : g.cells) {
+    const HashMap<int, OctantItemInfo> &items(*p_data.items);
+    const Vector3 scale(p_data.cell_scale, p_data.cell_scale, p_data.cell_scale);
 
-        ERR_CONTINUE(!cell_map.contains(E));
-        const Cell &c = cell_map[E];
+    for (const Pair<IndexKey, Cell> &E : p_data.cells) {
 
-        if (not mesh_library || !mesh_library->has_item(c.item))
+        auto iter = items.find(E.second.item);
+        if (iter == items.end())
             continue;
+        const OctantItemInfo &info = iter->second;
 
-        Vector3 cellpos = Vector3(E.x, E.y, E.z);
-        Vector3 ofs = _get_offset();
-
+        Vector3 cellpos = Vector3(E.first.x, E.first.y, E.first.z);
         Transform xform;
 
-        xform.basis.set_orthogonal_index(c.rot);
-        xform.set_origin(cellpos * cell_size + ofs);
-        xform.basis.scale(Vector3(cell_scale, cell_scale, cell_scale));
-        if (baked_meshes.empty()) {
-            if (mesh_library->get_item_mesh(c.item)) {
-                multimesh_items[c.item].emplace_back(xform,E);
-            }
+        xform.basis.set_orthogonal_index(E.second.rot);
+        xform.set_origin(cellpos * p_data.cell_size + p_data.offset);
+        xform.basis.scale(scale);
+
+        if (p_data.build_multimeshes && info.mesh.is_valid()) {
+            OctantBakeData::MultimeshData &mm = p_data.multimeshes[E.second.item];
+            mm.mesh = info.mesh;
+            mm.transforms.emplace_back(xform);
+            mm.keys.emplace_back(E.first);
         }
 
-        PoolVector<MeshLibrary::ShapeData> shapes = mesh_library->get_item_shapes(c.item);
-        auto wr(shapes.write());
-        // add the item's shape at given xform to octant's static_body
-        for (int i = 0; i < shapes.size(); i++) {
-            // add the item's shape
-            if (not wr[i].shape)
-                continue;
-            PhysicsServer3D::get_singleton()->body_add_shape(g.static_body, wr[i].shape->get_rid(), xform * wr[i].local_transform);
-            if (g.collision_debug.is_valid()) {
-                wr[i].shape->add_vertices_to_array(col_debug, xform * wr[i].local_transform);
+        for (const Pair<RID, Transform> &shape : info.shapes) {
+            p_data.shapes.emplace_back(shape.first, xform * shape.second);
+        }
+        if (p_data.build_debug_lines) {
+            for (const Vector3 &v : info.debug_lines) {
+                p_data.debug_lines.emplace_back(xform.xform(v));
             }
         }
 
-        // add the item's navmesh at given xform to GridMap's Navigation3D ancestor
-        Ref<NavigationMesh> navmesh = mesh_library->get_item_navmesh(c.item);
-        if (navmesh) {
-            Octant::NavMesh nm;
-            nm.xform = xform * mesh_library->get_item_navmesh_transform(c.item);
+        if (info.has_navmesh) {
+            p_data.navmeshes.emplace_back(OctantBakeData::NavMeshData { E.first, int(E.second.item), xform * info.navmesh_transform });
+        }
+    }
+
+    // pre-pack multimesh transforms in the layout expected by multimesh_set_as_bulk_array
+    for (auto &E : p_data.multimeshes) {
+        OctantBakeData::MultimeshData &mm = E.second;
+        mm.bulk.resize(mm.transforms.size() * 12);
+        PoolVector<float>::Write w = mm.bulk.write();
+        float *dataptr = w.ptr();
+        for (const Transform &t : mm.transforms) {
+            dataptr[0] = t.basis.elements[0][0];
+            dataptr[1] = t.basis.elements[0][1];
+            dataptr[2] = t.basis.elements[0][2];
+            dataptr[3] = t.origin.x;
+            dataptr[4] = t.basis.elements[1][0];
+            dataptr[5] = t.basis.elements[1][1];
+            dataptr[6] = t.basis.elements[1][2];
+            dataptr[7] = t.origin.y;
+            dataptr[8] = t.basis.elements[2][0];
+            dataptr[9] = t.basis.elements[2][1];
+            dataptr[10] = t.basis.elements[2][2];
+            dataptr[11] = t.origin.z;
+            dataptr += 12;
+        }
+    }
+}
+
+void GridMap::_octant_commit(const OctantKey &p_key, const OctantBakeData &p_data) {
+
+    auto iter = octant_map.find(p_key);
+    if (iter == octant_map.end())
+        return; // octant was removed while baking
+    Octant &g = *iter->second;
+    if (g.pending_bake != p_data.serial)
+        return; // superseded by a newer bake, or octant recreated
+
+    g.pending_bake = 0;
+    _octant_clear_geometry(g);
+
+    RenderingServer *rs = RenderingServer::get_singleton();
+
+    for (const Pair<RID, Transform> &shape : p_data.shapes) {
+        PhysicsServer3D::get_singleton()->body_add_shape(g.static_body, shape.first, shape.second);
+    }
+
+    // add the item's navmesh at given xform to GridMap's Navigation3D ancestor
+    for (const OctantBakeData::NavMeshData &nd : p_data.navmeshes) {
+        Octant::NavMesh nm;
+        nm.xform = nd.xform;
 
-            if (navigation) {
+        if (navigation && mesh_library) {
+            Ref<NavigationMesh> navmesh = mesh_library->get_item_navmesh(nd.item);
+            if (navmesh) {
                 RID region = NavigationServer::get_singleton()->region_create();
                 NavigationServer::get_singleton()->region_set_navmesh(region, navmesh);
                 NavigationServer::get_singleton()->region_set_transform(region, navigation->get_global_transform() * nm.xform);
                 NavigationServer::get_singleton()->region_set_map(region, navigation->get_rid());
                 nm.region = region;
             }
-            g.navmesh_ids[E] = nm;
         }
+        g.navmesh_ids[nd.key] = nm;
     }
 
-    //update multimeshes, only if not baked
-    if (baked_meshes.empty()) {
-
-        for (auto &E : multimesh_items) {
-            Octant::MultimeshInstance mmi;
-
-            RID mm = RenderingServer::get_singleton()->multimesh_create();
-            RenderingServer::get_singleton()->multimesh_allocate(mm, E.second.size(), RS::MULTIMESH_TRANSFORM_3D, RS::MULTIMESH_COLOR_NONE);
-            RenderingServer::get_singleton()->multimesh_set_mesh(mm, mesh_library->get_item_mesh(E.first)->get_rid());
+    for (const auto &E : p_data.multimeshes) {
+        const OctantBakeData::MultimeshData &mmd = E.second;
+        Octant::MultimeshInstance mmi;
 
-            int idx = 0;
-            for (const Pair<Transform, IndexKey> &F : E.second) {
-                RenderingServer::get_singleton()->multimesh_instance_set_transform(mm, idx, F.first);
+        RID mm = rs->multimesh_create();
+        rs->multimesh_allocate(mm, mmd.transforms.size(), RS::MULTIMESH_TRANSFORM_3D, RS::MULTIMESH_COLOR_NONE);
+        rs->multimesh_set_mesh(mm, mmd.mesh);
+        rs->multimesh_set_as_bulk_array(mm, mmd.bulk);
 #ifdef TOOLS_ENABLED
-
-                Octant::MultimeshInstance::Item it;
-                it.index = idx;
-                it.transform = F.first;
-                it.key = F.second;
-                mmi.items.emplace_back(eastl::move(it));
+        mmi.items.reserve(mmd.transforms.size());
+        for (int idx = 0; idx < mmd.transforms.size(); idx++) {
+            Octant::MultimeshInstance::Item it;
+            it.index = idx;
+            it.transform = mmd.transforms[idx];
+            it.key = mmd.keys[idx];
+            mmi.items.emplace_back(eastl::move(it));
+        }
 #endif
 
-                idx++;
-            }
-
-            RID instance = RenderingServer::get_singleton()->instance_create();
-            RenderingServer::get_singleton()->instance_set_base(instance, mm);
+        RID instance = rs->instance_create();
+        rs->instance_set_base(instance, mm);
 
-            if (is_inside_tree()) {
-                RenderingServer::get_singleton()->instance_set_scenario(instance, get_world()->get_scenario());
-                RenderingServer::get_singleton()->instance_set_transform(instance, get_global_transform());
-            }
+        if (is_inside_tree()) {
+            rs->instance_set_scenario(instance, get_world()->get_scenario());
+            rs->instance_set_transform(instance, get_global_transform());
+            rs->instance_set_visible(instance, is_visible());
+        }
 
-            mmi.multimesh = mm;
-            mmi.instance = instance;
+        mmi.multimesh = mm;
+        mmi.instance = instance;
 
-            g.multimesh_instances.push_back(mmi);
-        }
+        g.multimesh_instances.push_back(mmi);
     }
 
-    if (!col_debug.empty()) {
+    if (!p_data.debug_lines.empty() && g.collision_debug.is_valid()) {
 
         SurfaceArrays arr;
-        arr.set_positions(eastl::move(col_debug));
+        arr.set_positions(Vector<Vector3>(p_data.debug_lines));
 
-        RenderingServer::get_singleton()->mesh_add_surface_from_arrays(g.collision_debug, RS::PRIMITIVE_LINES, eastl::move(arr));
+        rs->mesh_add_surface_from_arrays(g.collision_debug, RS::PRIMITIVE_LINES, eastl::move(arr));
         SceneTree *st = SceneTree::get_singleton();
         if (st) {
-            RenderingServer::get_singleton()->mesh_surface_set_material(g.collision_debug, 0, st->get_debug_collision_material()->get_rid());
+            rs->mesh_surface_set_material(g.collision_debug, 0, st->get_debug_collision_material()->get_rid());
         }
     }
-
-    g.dirty = false;
-
-    return false;
 }
 
 void GridMap::_reset_physic_bodies_collision_filters() {
@@ -797,18 +845,108 @@ void GridMap::_update_octants_callback() {
     if (!awaiting_update)
         return;
 
+    // Octants closest to the camera are submitted first, the worker pool runs them in submission order.
+    Vector3 camera_pos;
+    bool has_camera = false;
+    if (is_inside_tree() && get_viewport()->get_camera()) {
+        camera_pos = get_global_transform().affine_inverse().xform(get_viewport()->get_camera()->get_global_transform().origin);
+        has_camera = true;
+    }
+    const Vector3 octant_half_extents = cell_size * octant_size * 0.5f;
+
+    auto items = eastl::make_shared<HashMap<int, OctantItemInfo> >();
+    HashSet<int> missing_items;
+    const bool debug_collisions = SceneTree::get_singleton() && SceneTree::get_singleton()->is_debugging_collisions_hint();
+
     Vector<OctantKey> to_delete;
-    //TODO: consider if we can use iter=octant_map.erase(iter) here?
+    Vector<Pair<float, OctantKey> > to_bake;
+
     for (eastl::pair<const OctantKey,Octant *> &E : octant_map) {
 
-        if (_octant_update(E.first)) {
+        Octant &g = *E.second;
+        if (!g.dirty)
+            continue;
+
+        if (g.cells.empty()) {
+            //octant no longer needed
+            _octant_clean_up(E.first);
             to_delete.emplace_back(E.first);
+            continue;
         }
+
+        float distance = 0;
+        if (has_camera) {
+            distance = camera_pos.distance_squared_to(_octant_get_offset(E.first) + octant_half_extents);
+        }
+        to_bake.emplace_back(distance, E.first);
+    }
+
+    eastl::sort(to_bake.begin(), to_bake.end(), [](const Pair<float, OctantKey> &a, const Pair<float, OctantKey> &b) {
+        return a.first < b.first;
+    });
+
+    Vector<Pair<OctantKey, OctantBakeData *> > bakes;
+    bakes.reserve(to_bake.size());
+
+    for (const Pair<float, OctantKey> &B : to_bake) {
+
+        Octant &g = *octant_map[B.second];
+        OctantBakeData *data = memnew(OctantBakeData);
+        data->items = items;
+        data->cell_size = cell_size;
+        data->offset = _get_offset();
+        data->cell_scale = cell_scale;
+        data->serial = ++last_bake_serial;
+        data->build_multimeshes = baked_meshes.empty();
+        data->build_debug_lines = g.collision_debug.is_valid();
+        data->cells.reserve(g.cells.size());
+
+        for (IndexKey K : g.cells) {
+
+            ERR_CONTINUE(!cell_map.contains(K));
+            const Cell &c = cell_map[K];
+            data->cells.emplace_back(K, c);
+
+            if (not mesh_library || items->contains(c.item) || missing_items.contains(c.item))
+                continue;
+            if (!mesh_library->has_item(c.item)) {
+                missing_items.insert(c.item);
+                continue;
+            }
+
+            OctantItemInfo &info = (*items)[c.item];
+            Ref<Mesh> mesh = mesh_library->get_item_mesh(c.item);
+            if (mesh) {
+                info.mesh = mesh->get_rid();
+            }
+            PoolVector<MeshLibrary::ShapeData> shapes = mesh_library->get_item_shapes(c.item);
+            PoolVector<MeshLibrary::ShapeData>::Read rd = shapes.read();
+            for (int i = 0; i < shapes.size(); i++) {
+                if (not rd[i].shape)
+                    continue;
+                info.shapes.emplace_back(rd[i].shape->get_rid(), rd[i].local_transform);
+                if (debug_collisions) {
+                    rd[i].shape->add_vertices_to_array(info.debug_lines, rd[i].local_transform);
+                }
+            }
+            info.has_navmesh = mesh_library->get_item_navmesh(c.item);
+            info.navmesh_transform = mesh_library->get_item_navmesh_transform(c.item);
+        }
+
+        g.dirty = false;
+        g.pending_bake = data->serial;
+        bakes.emplace_back(B.second, data);
+    }
+
+    // the item table is complete, it is only read from here on
+    for (const Pair<OctantKey, OctantBakeData *> &B : bakes) {
+        _octant_queue_bake(B.first, B.second);
     }
 
-    while (!to_delete.empty()) {
-        octant_map.erase(to_delete.front());
-        to_delete.pop_back();
+    for (const OctantKey &K : to_delete) {
+        auto iter = octant_map.find(K);
+        memdelete(iter->second);
+        octant_map.erase(iter);
     }
 
     _update_visibility();
@@ -1130,6 +1268,7 @@ GridMap::GridMap() {
     cell_size = Vector3(2, 2, 2);
     octant_size = 8;
     awaiting_update = false;
+    last_bake_serial = 0;
     _in_tree = false;
     center_x = true;
     center_y = true;
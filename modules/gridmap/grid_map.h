@@ -30,11 +30,14 @@
 
 #pragma once
 
+#include "core/pair.h"
 #include "scene/3d/navigation_3d.h"
 #include "scene/3d/node_3d.h"
 #include "scene/resources/mesh_library.h"
 #include "scene/resources/multimesh.h"
 
+#include "EASTL/shared_ptr.h"
+
 //heh heh, godotsphir!! this shares no code and the design is completely different with previous projects i've done..
 //should scale better with hardware that supports instancing
 
@@ -116,10 +119,53 @@ class GODOT_EXPORT GridMap : public Node3D {
         RID collision_debug_instance;
 
         bool dirty;
+        uint64_t pending_bake = 0; // serial of the bake whose results will be accepted, 0 if none
         RID static_body;
         HashMap<IndexKey, NavMesh> navmesh_ids;
     };
 
+    /**
+     * @brief Per-item data captured on the main thread, so octant bakes never touch the MeshLibrary.
+     */
+    struct OctantItemInfo {
+        RID mesh;
+        Vector<Pair<RID, Transform> > shapes;
+        Vector<Vector3> debug_lines; // in item space
+        Transform navmesh_transform;
+        bool has_navmesh = false;
+    };
+
+    /**
+     * @brief Snapshot of an octant's cells and the geometry built from it on a worker thread.
+     */
+    struct OctantBakeData {
+        struct MultimeshData {
+            RID mesh;
+            Vector<Transform> transforms;
+            Vector<IndexKey> keys;
+            PoolVector<float> bulk;
+        };
+        struct NavMeshData {
+            IndexKey key;
+            int item;
+            Transform xform;
+        };
+        // inputs
+        eastl::shared_ptr<const HashMap<int, OctantItemInfo> > items;
+        Vector<Pair<IndexKey, Cell> > cells;
+        Vector3 cell_size;
+        Vector3 offset;
+        float cell_scale;
+        uint64_t serial;
+        bool build_multimeshes;
+        bool build_debug_lines;
+        // outputs
+        Map<int, MultimeshData> multimeshes;
+        Vector<Pair<RID, Transform> > shapes;
+        Vector<Vector3> debug_lines;
+        Vector<NavMeshData> navmeshes;
+    };
+
     union OctantKey {
 
         struct {
@@ -163,6 +209,7 @@ class GODOT_EXPORT GridMap : public Node3D {
 
     Map<OctantKey, Octant *> octant_map;
     HashMap<IndexKey, Cell> cell_map;
+    uint64_t last_bake_serial;
 
     void _recreate_octant_data();
 
@@ -188,7 +235,10 @@ class GODOT_EXPORT GridMap : public Node3D {
     void _reset_physic_bodies_collision_filters();
     void _octant_enter_world(const OctantKey &p_key);
     void _octant_exit_world(const OctantKey &p_key);
-    bool _octant_update(const OctantKey &p_key);
+    void _octant_clear_geometry(Octant &g);
+    void _octant_queue_bake(const OctantKey &p_key, OctantBakeData *p_data);
+    static void _octant_bake(OctantBakeData &p_data);
+    void _octant_commit(const OctantKey &p_key, const OctantBakeData &p_data);
     void _octant_clean_up(const OctantKey &p_key);
     void _octant_transform(const OctantKey &p_key);
     bool awaiting_update;
@@ -226,6 +226,18 @@ WSLPeer::WriteMode WSLPeer::get_write_mode() const {
     return write_mode;
 }
 
+bool WSLPeer::is_write_pending() const {
+    return _data && wslay_event_want_write(_data->ctx);
+}
+
+void WSLPeer::_notify_write_pending() {
+    // The server only polls peers with activity, make sure it gets back to us once the socket is writable.
+    if (_data && _data->is_server && wslay_event_want_write(_data->ctx)) {
+        WSLServer *helper = (WSLServer *)_data->obj;
+        helper->_on_peer_write_pending(_data->id);
+    }
+}
+
 void WSLPeer::poll() {
     if (!_data)
         return;
@@ -249,6 +261,7 @@ Error WSLPeer::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
         close_now();
         return FAILED;
     }
+    _notify_write_pending();
     return OK;
 }
 
@@ -291,7 +304,13 @@ bool WSLPeer::is_connected_to_host() const {
 
 void WSLPeer::close_now() {
     close(1000, "");
+    WSLServer *helper = _data && _data->is_server ? (WSLServer *)_data->obj : nullptr;
+    int id = _data ? _data->id : 0;
     _wsl_destroy(&_data);
+    if (helper && !_data) {
+        // Not destroyed by a poll, so the server won't see it go through the socket.
+        helper->_on_peer_closed(id);
+    }
 }
 
 void WSLPeer::close(int p_code, StringView p_reason) {
@@ -299,6 +318,7 @@ void WSLPeer::close(int p_code, StringView p_reason) {
         wslay_event_queue_close(_data->ctx, p_code, (const uint8_t *)p_reason.data(), p_reason.size());
         wslay_event_send(_data->ctx);
         _data->closing = true;
+        _notify_write_pending();
     }
 
     _in_buffer.clear();
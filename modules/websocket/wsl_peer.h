@@ -80,6 +80,7 @@ public:
 private:
     static bool _wsl_poll(struct PeerData *p_data);
     static void _wsl_destroy(struct PeerData **p_data);
+    void _notify_write_pending();
 
     struct PeerData *_data;
     uint8_t _is_string;
@@ -94,6 +95,7 @@ public:
     int close_code;
     String close_reason;
     void poll(); // Used by client and server.
+    bool is_write_pending() const;
 
     int get_available_packet_count() const override;
     Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) override;
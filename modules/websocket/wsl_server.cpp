@@ -32,6 +32,7 @@
 
 #include "wsl_server.h"
 #include "core/os/os.h"
+#include "core/print_string.h"
 #include "core/project_settings.h"
 #include "core/string_utils.h"
 
@@ -172,26 +173,124 @@ Error WSLServer::listen(int p_port, const PoolVector<String> &p_protocols, bool
 
     _protocols.append_array(p_protocols);
 
-    return _server->listen(p_port, bind_ip);
+    Error err = _server->listen(p_port, bind_ip);
+    if (err != OK)
+        return err;
+
+    if (!_poller) {
+        _poller = Ref<NetSocketPoller>(NetSocketPoller::create());
+    }
+    if (_poller && _server->add_to_poller(_poller, nullptr) != OK) {
+        _poller.unref();
+    }
+    return OK;
+}
+
+void WSLServer::_set_write_pending(int p_id, bool p_pending) {
+
+    if (p_pending == _write_pending.contains(p_id))
+        return;
+    auto iter = _peer_sockets.find(p_id);
+    if (iter == _peer_sockets.end())
+        return;
+
+    if (p_pending) {
+        _write_pending.insert(p_id);
+    } else {
+        _write_pending.erase(p_id);
+    }
+    iter->second->add_to_poller(_poller, (void *)intptr_t(p_id), p_pending ? NetSocket::POLL_TYPE_IN_OUT : NetSocket::POLL_TYPE_IN);
+}
+
+void WSLServer::_on_peer_write_pending(int p_id) {
+
+    if (_poller) {
+        _set_write_pending(p_id, true);
+    }
+}
+
+void WSLServer::_on_peer_closed(int p_id) {
+
+    if (_poller) {
+        _dead_peers.push_back(p_id);
+    }
+}
+
+void WSLServer::_poll_peer(int p_id) {
+
+    auto iter = _peer_map.find(p_id);
+    if (iter == _peer_map.end())
+        return;
+
+    Ref<WSLPeer> peer((WSLPeer *)iter->second.get());
+    peer->poll();
+    if (!peer->is_connected_to_host()) {
+        _remove_peer(p_id);
+        return;
+    }
+    _set_write_pending(p_id, peer->is_write_pending());
+}
+
+void WSLServer::_remove_peer(int p_id) {
+
+    auto iter = _peer_map.find(p_id);
+    if (iter == _peer_map.end())
+        return;
+
+    Ref<WSLPeer> peer((WSLPeer *)iter->second.get());
+    _on_disconnect(p_id, peer->close_code != -1);
+    _peer_map.erase(p_id);
+    _write_pending.erase(p_id);
+    _peer_sockets.erase(p_id); // Closes the socket, which also unregisters it.
 }
 
 void WSLServer::poll() {
 
-    for (auto iter=_peer_map.begin(); iter!=_peer_map.end(); ) {
-        Ref<WSLPeer> peer((WSLPeer *)iter->second.get());
-        peer->poll();
-        if (!peer->is_connected_to_host()) {
-            _on_disconnect(iter->first, peer->close_code != -1);
-            iter=_peer_map.erase(iter);
+    bool accept_ready = true;
+    if (_poller) {
+        accept_ready = false;
+        _events.clear();
+        _poller->wait(_events, 0);
+        for (const NetSocketPoller::Event &ev : _events) {
+            int id = int(intptr_t(ev.userdata));
+            if (id == 0) {
+                accept_ready = true;
+            } else {
+                _poll_peer(id);
+            }
+        }
+
+        // Disconnect handlers may close more peers, so take them one at a time.
+        while (!_dead_peers.empty()) {
+            int id = _dead_peers.back();
+            _dead_peers.pop_back();
+            if (has_peer(id) && !_peer_map[id]->is_connected_to_host()) {
+                _remove_peer(id);
+            }
+        }
+    } else {
+        for (auto iter=_peer_map.begin(); iter!=_peer_map.end(); ) {
+            Ref<WSLPeer> peer((WSLPeer *)iter->second.get());
+            peer->poll();
+            if (!peer->is_connected_to_host()) {
+                _on_disconnect(iter->first, peer->close_code != -1);
+                iter=_peer_map.erase(iter);
+            }
+            else
+                ++iter;
         }
-        else
-            ++iter;
     }
-    
+
     for (auto iter = _pending.begin(); iter!= _pending.end(); ) {
         Ref<PendingPeer> ppeer = *iter;
+        if (OS::get_singleton()->get_ticks_msec() - ppeer->time > WSL_SERVER_TIMEOUT) {
+            print_verbose("WebSocket handshake timed out.");
+            iter = _pending.erase(iter);
+            continue;
+        }
         Error err = ppeer->do_handshake(_protocols);
         if (err == ERR_BUSY) {
+            ++iter;
             continue;
         }
         if (err != OK) {
@@ -213,11 +312,15 @@ void WSLServer::poll() {
         ws_peer->set_no_delay(true);
 
         _peer_map[id] = ws_peer;
+        if (_poller) {
+            _peer_sockets[id] = ppeer->tcp;
+            ppeer->tcp->add_to_poller(_poller, (void *)intptr_t(id));
+        }
         iter = _pending.erase(iter);
         _on_connect(id, ppeer->protocol);
     }
 
-    if (!_server->is_listening())
+    if (!_server->is_listening() || !accept_ready)
         return;
 
     while (_server->is_connection_available()) {
@@ -257,6 +360,9 @@ void WSLServer::stop() {
     }
     _pending.clear();
     _peer_map.clear();
+    _peer_sockets.clear();
+    _write_pending.clear();
+    _dead_peers.clear();
     _protocols = {};
 }
 
@@ -35,6 +35,8 @@
 #include "websocket_server.h"
 #include "wsl_peer.h"
 
+#include "core/hash_map.h"
+#include "core/hash_set.h"
 #include "core/io/stream_peer_ssl.h"
 #include "core/io/stream_peer_tcp.h"
 #include "core/io/tcp_server.h"
@@ -79,7 +81,24 @@ private:
     Ref<TCP_Server> _server;
     PoolVector<String> _protocols;
 
+    // When the platform has a socket poller, only peers reported ready (or with queued output) are polled.
+    // Userdata is the peer id, 0 stands for the listening socket.
+    Ref<NetSocketPoller> _poller;
+    Vector<NetSocketPoller::Event> _events;
+    HashMap<int, Ref<StreamPeerTCP> > _peer_sockets;
+    HashSet<int> _write_pending; // Peers also waiting for their socket to become writable.
+    Vector<int> _dead_peers; // Peers destroyed outside of their own poll, reaped by the next poll.
+
+    void _poll_peer(int p_id);
+    void _remove_peer(int p_id);
+    void _set_write_pending(int p_id, bool p_pending);
+
 public:
+    //! Called by peers that could not send all queued data right away.
+    void _on_peer_write_pending(int p_id);
+    //! Called by peers destroyed outside of their own poll, no further socket event will report them.
+    void _on_peer_closed(int p_id);
+
     Error set_buffers(int p_in_buffer, int p_in_packets, int p_out_buffer, int p_out_packets) override;
     Error listen(int p_port, const PoolVector<String> &p_protocols = PoolVector<String>(), bool gd_mp_api = false) override;
     void stop() override;
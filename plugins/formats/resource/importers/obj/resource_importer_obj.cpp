@@ -352,6 +352,9 @@ static Error _parse_obj(StringView p_path, Vector<Ref<Mesh>> &r_meshes, bool p_s
                 }
 
                 surf_tool->index();
+                if (p_optimize) {
+                    surf_tool->optimize();
+                }
 
                 print_verbose("OBJ: Current material library " + current_material_library + " has " + itos(material_map.contains(current_material_library)));
                 print_verbose("OBJ: Current material " + current_material + " has " + itos(material_map.contains(current_material_library) && material_map[current_material_library].contains(current_material)));
@@ -502,6 +505,7 @@ void ResourceImporterOBJ::get_import_options(Vector<ResourceImporterInterface::I
     r_options->emplace_back(PropertyInfo(VariantType::VECTOR3, "scale_mesh"), Vector3(1, 1, 1));
     r_options->emplace_back(PropertyInfo(VariantType::VECTOR3, "offset_mesh"), Vector3(0, 0, 0));
     r_options->emplace_back(PropertyInfo(VariantType::BOOL, "optimize_mesh"), true);
+    r_options->emplace_back(PropertyInfo(VariantType::BOOL, "generate_lods"), true);
 }
 bool ResourceImporterOBJ::get_option_visibility(const StringName &p_option, const HashMap<StringName, Variant> &p_options) const {
 
@@ -519,6 +523,13 @@ Error ResourceImporterOBJ::import(StringView p_source_file, StringView p_save_pa
     ERR_FAIL_COND_V(err != OK, err);
     ERR_FAIL_COND_V(meshes.size() != 1, ERR_BUG);
 
+    if (p_options.at("generate_lods").as<bool>()) {
+        Ref<ArrayMesh> mesh = dynamic_ref_cast<ArrayMesh>(meshes.front());
+        ERR_FAIL_COND_V(!mesh, ERR_BUG);
+        err = mesh->optimize_surfaces(true);
+        ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot generate LODs for '" + String(p_source_file) + "'.");
+    }
+
     String save_path = String(p_save_path) + ".mesh";
 
     err = gResourceManager().save(save_path, meshes.front());
@@ -32,6 +32,7 @@
 
 #include "core/image.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/print_string.h"
 #include "core/string_utils.h"
 
@@ -39,6 +40,17 @@
 #include "EtcFilter.h"
 
 namespace {
+// Pixel rows per compression tile, fixed so the output doesn't depend on the number of threads.
+constexpr int ETC_TILE_ROWS = 32;
+
+struct EtcTile {
+    const uint8_t *src;
+    int width;
+    int height;
+    unsigned char *etc_data;
+    unsigned int etc_data_len;
+};
+
 static Image::Format _get_etc2_mode(ImageUsedChannels format) {
     switch (format) {
         case ImageUsedChannels::USED_CHANNELS_R:
@@ -156,8 +168,6 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
     PoolVector<uint8_t>::Write w = dst_data.write();
 
     // prepare parameters to be passed to etc2comp
-    int num_cpus = OS::get_singleton()->get_processor_count();
-    int encoding_time = 0;
     float effort = 0.0; //default, reasonable time
 
     if (p_lossy_quality > 0.75f)
@@ -170,34 +180,43 @@ static void _compress_etc(Image *p_img, float p_lossy_quality, bool force_etc1_f
     Etc::ErrorMetric error_metric = Etc::ErrorMetric::RGBX; // NOTE: we can experiment with other error metrics
     Etc::Image::Format etc2comp_etc_format = _image_format_to_etc2comp_format(etc_format);
 
-    int wofs = 0;
+    // Mipmaps are split in tiles of whole block rows which are encoded independently on the worker pool, etc2comp
+    // lays blocks out row by row, so the tiles concatenate to the same layout as a single encode of the mipmap.
+    Vector<EtcTile> tiles;
+    for (int i = 0; i < mmc; i++) {
+        int mipmap_ofs = 0, mipmap_size = 0, mipmap_w = 0, mipmap_h = 0;
+        img->get_mipmap_offset_size_and_dimensions(i, mipmap_ofs, mipmap_size, mipmap_w, mipmap_h);
+        for (int y = 0; y < mipmap_h; y += ETC_TILE_ROWS) {
+            tiles.push_back({ &r[mipmap_ofs + y * mipmap_w * 4], mipmap_w, MIN(ETC_TILE_ROWS, mipmap_h - y), nullptr, 0 });
+        }
+    }
 
     print_verbose("ETC: Begin encoding, format: " + Image::get_format_name(etc_format));
     uint64_t t = OS::get_singleton()->get_ticks_msec();
-    for (int i = 0; i < mmc; i++) {
+
+    WorkerThreadPool::get_singleton()->parallel_for(tiles.size(), [&](uint32_t p_index) {
+        EtcTile &tile = tiles[p_index];
         // convert source image to internal etc2comp format (which is equivalent to Image::FORMAT_RGBAF)
         // NOTE: We can alternatively add a case to Image::convert to handle Image::FORMAT_RGBAF conversion.
-        int mipmap_ofs = 0, mipmap_size = 0, mipmap_w = 0, mipmap_h = 0;
-        img->get_mipmap_offset_size_and_dimensions(i, mipmap_ofs, mipmap_size, mipmap_w, mipmap_h);
-        const uint8_t *src = &r[mipmap_ofs];
-
-        Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[mipmap_w * mipmap_h];
-        for (int j = 0; j < mipmap_w * mipmap_h; j++) {
+        int pixel_count = tile.width * tile.height;
+        Etc::ColorFloatRGBA *src_rgba_f = new Etc::ColorFloatRGBA[pixel_count];
+        for (int j = 0; j < pixel_count; j++) {
             int si = j * 4; // RGBA8
-            src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(src[si], src[si + 1], src[si + 2], src[si + 3]);
+            src_rgba_f[j] = Etc::ColorFloatRGBA::ConvertFromRGBA8(tile.src[si], tile.src[si + 1], tile.src[si + 2], tile.src[si + 3]);
         }
 
-        unsigned char *etc_data = nullptr;
-        unsigned int etc_data_len = 0;
         unsigned int extended_width = 0, extended_height = 0;
-        Etc::Encode((float *)src_rgba_f, mipmap_w, mipmap_h, etc2comp_etc_format, error_metric, effort, num_cpus, num_cpus, &etc_data, &etc_data_len, &extended_width, &extended_height, &encoding_time);
-
-        CRASH_COND(wofs + etc_data_len > target_size);
-                memcpy(&w[wofs], etc_data, etc_data_len);
-        wofs += etc_data_len;
-
-        delete[] etc_data;
+        int encoding_time = 0;
+        Etc::Encode((float *)src_rgba_f, tile.width, tile.height, etc2comp_etc_format, error_metric, effort, 1, 1, &tile.etc_data, &tile.etc_data_len, &extended_width, &extended_height, &encoding_time);
         delete[] src_rgba_f;
+    });
+
+    unsigned int wofs = 0;
+    for (EtcTile &tile : tiles) {
+        CRASH_COND(wofs + tile.etc_data_len > target_size);
+        memcpy(&w[wofs], tile.etc_data, tile.etc_data_len);
+        wofs += tile.etc_data_len;
+        delete[] tile.etc_data;
     }
 
     print_verbose("ETC: Time encoding: " + rtos(OS::get_singleton()->get_ticks_msec() - t));
@@ -29,9 +29,24 @@
 /*************************************************************************/
 
 #include "image_compress_squish.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/ustring.h"
 #include <squish.h>
 
+namespace {
+
+// Pixel rows per compression tile, fixed so the output doesn't depend on the number of threads.
+constexpr int SQUISH_TILE_ROWS = 64;
+
+struct SquishTile {
+    const uint8_t *src;
+    uint8_t *dst;
+    int width;
+    int height;
+};
+
+} // namespace
+
 Error image_decompress_squish(Image *p_image) {
     int w = p_image->get_width();
     int h = p_image->get_height();
@@ -146,6 +161,8 @@ void image_compress_squish(Image *p_image, float p_lossy_quality, ImageUsedChann
         PoolVector<uint8_t>::Read rb = p_image->get_data().read();
         PoolVector<uint8_t>::Write wb = data.write();
 
+        // Every mipmap is split in tiles of whole block rows, each tile is an independent sub-image for squish.
+        Vector<SquishTile> tiles;
         int dst_ofs = 0;
 
         for (int i = 0; i <= mm_count; i++) {
@@ -154,12 +171,22 @@ void image_compress_squish(Image *p_image, float p_lossy_quality, ImageUsedChann
             int bh = h % 4 != 0 ? h + (4 - h % 4) : h;
 
             int src_ofs = p_image->get_mipmap_offset(i);
-            squish::CompressImage(&rb[src_ofs], w, h, &wb[dst_ofs], squish_comp);
+            int tile_dst_ofs = dst_ofs;
+            for (int y = 0; y < h; y += SQUISH_TILE_ROWS) {
+                int tile_h = MIN(SQUISH_TILE_ROWS, h - y);
+                tiles.push_back({ &rb[src_ofs + y * w * 4], &wb[tile_dst_ofs], w, tile_h });
+                tile_dst_ofs += squish::GetStorageRequirements(w, tile_h, squish_comp);
+            }
             dst_ofs += (M_MAX(4, bw) * M_MAX(4, bh)) >> shift;
             w = M_MAX(w / 2, 1);
             h = M_MAX(h / 2, 1);
         }
 
+        WorkerThreadPool::get_singleton()->parallel_for(tiles.size(), [&tiles, squish_comp](uint32_t p_index) {
+            const SquishTile &tile = tiles[p_index];
+            squish::CompressImage(tile.src, tile.width, tile.height, tile.dst, squish_comp);
+        });
+
         rb.release();
         wb.release();
 
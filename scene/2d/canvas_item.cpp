@@ -998,6 +998,30 @@ void CanvasItem::_notify_transform(CanvasItem *p_node) {
     }
 }
 
+bool CanvasItem::_defer_notify_transform() {
+
+    if (xform_change_deferred)
+        return true; // already queued in this parallel phase
+    if (global_invalid)
+        return false; // nothing to propagate, same as _notify_transform
+
+    if (!SceneTree::defer_transform_change(this, &CanvasItem::_notify_deferred_transform))
+        return false;
+    // processed on a worker thread, children and the notification list are updated on the main thread
+    xform_change_deferred = true;
+    global_invalid = true;
+    return true;
+}
+
+void CanvasItem::_notify_deferred_transform(Node *p_node) {
+
+    CanvasItem *ci = static_cast<CanvasItem *>(p_node);
+    ci->xform_change_deferred = false;
+    // invalidated early so the worker could read its new global transform, clear it or the propagation stops here
+    ci->global_invalid = false;
+    ci->_notify_transform(ci);
+}
+
 Rect2 CanvasItem::get_viewport_rect() const {
 
     ERR_FAIL_COND_V(!is_inside_tree(), Rect2());
@@ -1397,6 +1421,7 @@ CanvasItem::CanvasItem() :
     canvas_layer = nullptr;
     use_parent_material = false;
     global_invalid = true;
+    xform_change_deferred = false;
     notify_local_transform = false;
     notify_transform = false;
     light_mask = 1;
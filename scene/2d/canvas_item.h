@@ -207,6 +207,8 @@ private:
 
     mutable Transform2D global_transform;
     mutable bool global_invalid;
+    // changed while processed in parallel, propagation is queued on the scene tree
+    bool xform_change_deferred;
     static CanvasItem *current_item_drawn;
 public:
     /*Q_INVOKABLE*/ void _toplevel_raise_self();
@@ -217,6 +219,8 @@ private:
     void _exit_canvas();
 
     void _notify_transform(CanvasItem *p_node);
+    bool _defer_notify_transform();
+    static void _notify_deferred_transform(Node *p_node);
 public:
     void _set_on_top(bool p_on_top) { set_draw_behind_parent(!p_on_top); }
     bool _is_on_top() const { return !is_draw_behind_parent_enabled(); }
@@ -225,7 +229,7 @@ public:
 protected:
     void _notify_transform() {
         if (!is_inside_tree()) return;
-        _notify_transform(this);
+        if (!_defer_notify_transform()) _notify_transform(this);
         if (!block_transform_notify && notify_local_transform) notification(NOTIFICATION_LOCAL_TRANSFORM_CHANGED);
     }
 
@@ -0,0 +1,222 @@
+/*************************************************************************/
+/*  entity_world_3d.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "entity_world_3d.h"
+
+#include "core/os/worker_thread_pool.h"
+#include "scene/resources/world_3d.h"
+#include "servers/physics_server_3d.h"
+#include "servers/rendering_server.h"
+
+void EntityWorld3D::_free_server_objects(entt::entity p_entity) {
+
+    auto &reg = ecs.registry;
+    if (EntityRenderInstance3D *render = reg.try_get<EntityRenderInstance3D>(p_entity)) {
+        RenderingServer::get_singleton()->free_rid(render->instance);
+    }
+    if (EntityCollisionShape3D *collision = reg.try_get<EntityCollisionShape3D>(p_entity)) {
+        PhysicsServer3D::get_singleton()->free_rid(collision->body);
+    }
+}
+
+entt::entity EntityWorld3D::create_entity(const Transform &p_transform) {
+
+    entt::entity entity = ecs.registry.create();
+    ecs.registry.emplace<EntityTransform3D>(entity, p_transform);
+    return entity;
+}
+
+void EntityWorld3D::destroy_entity(entt::entity p_entity) {
+
+    ERR_FAIL_COND(!is_entity_valid(p_entity));
+    _free_server_objects(p_entity);
+    ecs.registry.destroy(p_entity);
+}
+
+bool EntityWorld3D::is_entity_valid(entt::entity p_entity) const {
+
+    return ecs.registry.valid(p_entity);
+}
+
+int EntityWorld3D::get_entity_count() const {
+
+    return ecs.registry.alive();
+}
+
+void EntityWorld3D::set_transform(entt::entity p_entity, const Transform &p_transform) {
+
+    ERR_FAIL_COND(!is_entity_valid(p_entity));
+    EntityTransform3D &xform = ecs.registry.get<EntityTransform3D>(p_entity);
+    xform.transform = p_transform;
+    xform.dirty = true;
+}
+
+Transform EntityWorld3D::get_transform(entt::entity p_entity) const {
+
+    ERR_FAIL_COND_V(!is_entity_valid(p_entity), Transform());
+    return ecs.registry.get<EntityTransform3D>(p_entity).transform;
+}
+
+void EntityWorld3D::set_velocity(entt::entity p_entity, const Vector3 &p_linear, const Vector3 &p_angular) {
+
+    ERR_FAIL_COND(!is_entity_valid(p_entity));
+    if (p_linear == Vector3() && p_angular == Vector3()) {
+        // resting entities are skipped by integrate() entirely
+        ecs.registry.remove_if_exists<EntityVelocity3D>(p_entity);
+        return;
+    }
+    ecs.registry.emplace_or_replace<EntityVelocity3D>(p_entity, p_linear, p_angular);
+}
+
+void EntityWorld3D::set_mesh(entt::entity p_entity, RID p_mesh) {
+
+    ERR_FAIL_COND(!is_entity_valid(p_entity));
+    RenderingServer *rs = RenderingServer::get_singleton();
+    auto &reg = ecs.registry;
+
+    if (EntityRenderInstance3D *render = reg.try_get<EntityRenderInstance3D>(p_entity)) {
+        if (p_mesh.is_valid()) {
+            rs->instance_set_base(render->instance, p_mesh);
+        } else {
+            rs->free_rid(render->instance);
+            reg.remove<EntityRenderInstance3D>(p_entity);
+        }
+        return;
+    }
+    if (!p_mesh.is_valid())
+        return;
+
+    RID instance = rs->instance_create2(p_mesh, scenario);
+    rs->instance_set_transform(instance, reg.get<EntityTransform3D>(p_entity).transform);
+    reg.emplace<EntityRenderInstance3D>(p_entity, instance);
+}
+
+void EntityWorld3D::set_collision_shape(entt::entity p_entity, RID p_shape, uint32_t p_layer, uint32_t p_mask) {
+
+    ERR_FAIL_COND(!is_entity_valid(p_entity));
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    auto &reg = ecs.registry;
+
+    if (EntityCollisionShape3D *collision = reg.try_get<EntityCollisionShape3D>(p_entity)) {
+        ps->free_rid(collision->body);
+        reg.remove<EntityCollisionShape3D>(p_entity);
+    }
+    if (!p_shape.is_valid())
+        return;
+
+    RID body = ps->body_create(PhysicsServer3D::BODY_MODE_KINEMATIC);
+    ps->body_set_space(body, space);
+    ps->body_add_shape(body, p_shape);
+    ps->body_set_collision_layer(body, p_layer);
+    ps->body_set_collision_mask(body, p_mask);
+    ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, reg.get<EntityTransform3D>(p_entity).transform);
+    reg.emplace<EntityCollisionShape3D>(p_entity, body);
+}
+
+void EntityWorld3D::integrate(float p_delta) {
+
+    // enough entities per task to amortize scheduling
+    const int batch_size = 256;
+
+    auto &reg = ecs.registry;
+    auto velocities = reg.view<EntityVelocity3D>();
+    auto transforms = reg.view<EntityTransform3D>();
+    const int count = velocities.size();
+    if (count == 0)
+        return;
+
+    const EntityVelocity3D *velocity_data = velocities.raw();
+    const entt::entity *entities = velocities.data();
+
+    // each batch writes the transforms of its own entities only, the pools are not resized meanwhile
+    WorkerThreadPool::get_singleton()->parallel_for((count + batch_size - 1) / batch_size, [&](uint32_t p_batch) {
+        const int end = MIN(count, int(p_batch + 1) * batch_size);
+        for (int i = p_batch * batch_size; i < end; i++) {
+            const EntityVelocity3D &velocity = velocity_data[i];
+            EntityTransform3D &xform = transforms.get(entities[i]);
+
+            xform.transform.origin += velocity.linear * p_delta;
+            const real_t angular_speed = velocity.angular.length();
+            if (angular_speed > CMP_EPSILON) {
+                xform.transform.basis.rotate(velocity.angular / angular_speed, angular_speed * p_delta);
+            }
+            xform.dirty = true;
+        }
+    });
+}
+
+void EntityWorld3D::sync_transforms() {
+
+    RenderingServer *rs = RenderingServer::get_singleton();
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    auto &reg = ecs.registry;
+
+    // one batched call, so the threaded server queues a single command instead of one per entity
+    dirty_instances.clear();
+    dirty_instance_transforms.clear();
+    reg.view<EntityTransform3D, EntityRenderInstance3D>().each([this](EntityTransform3D &p_xform, EntityRenderInstance3D &p_render) {
+        if (p_xform.dirty) {
+            dirty_instances.push_back(p_render.instance);
+            dirty_instance_transforms.push_back(p_xform.transform);
+        }
+    });
+    if (!dirty_instances.empty()) {
+        rs->instances_set_transform(dirty_instances, dirty_instance_transforms);
+    }
+    reg.view<EntityTransform3D, EntityCollisionShape3D>().each([ps](EntityTransform3D &p_xform, EntityCollisionShape3D &p_collision) {
+        if (p_xform.dirty) {
+            ps->body_set_state(p_collision.body, PhysicsServer3D::BODY_STATE_TRANSFORM, p_xform.transform);
+        }
+    });
+    reg.view<EntityTransform3D>().each([](EntityTransform3D &p_xform) {
+        p_xform.dirty = false;
+    });
+}
+
+EntityWorld3D::EntityWorld3D(const Ref<World3D> &p_world) :
+        world(p_world) {
+
+    ERR_FAIL_COND(!world);
+    scenario = world->get_scenario();
+    space = world->get_space();
+}
+
+EntityWorld3D::~EntityWorld3D() {
+
+    RenderingServer *rs = RenderingServer::get_singleton();
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    ecs.registry.view<EntityRenderInstance3D>().each([rs](EntityRenderInstance3D &p_render) {
+        rs->free_rid(p_render.instance);
+    });
+    ecs.registry.view<EntityCollisionShape3D>().each([ps](EntityCollisionShape3D &p_collision) {
+        ps->free_rid(p_collision.body);
+    });
+}
@@ -0,0 +1,108 @@
+/*************************************************************************/
+/*  entity_world_3d.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/ecs_registry.h"
+#include "core/math/transform.h"
+#include "core/reference.h"
+#include "core/rid.h"
+#include "core/vector.h"
+
+class World3D;
+
+struct EntityTransform3D {
+    Transform transform;
+    bool dirty = true; // changed since it was last sent to the servers
+};
+
+struct EntityVelocity3D {
+    Vector3 linear;
+    Vector3 angular; // axis scaled by radians per second
+};
+
+//! Visual instance in the world's scenario, owned by the entity.
+struct EntityRenderInstance3D {
+    RID instance;
+};
+
+//! Kinematic body in the world's physics space, owned by the entity.
+struct EntityCollisionShape3D {
+    RID body;
+};
+
+/**
+ * Node-free storage for large numbers of simple 3D objects, like debris, crowds or projectiles.
+ *
+ * Every entity has an EntityTransform3D, the other components are optional. Components live in EnTT pools, so the
+ * systems below walk contiguous arrays instead of Node trees. Game code can keep its own components in the same
+ * registry (get_registry()) and iterate them together with these.
+ *
+ * A frame usually calls integrate() and then sync_transforms(), from the main thread.
+ */
+class GODOT_EXPORT EntityWorld3D {
+
+    ECS_Registry ecs;
+    Ref<World3D> world; // keeps the scenario and space alive
+    RID scenario;
+    RID space;
+    // changed visual instances of the current sync_transforms() call, kept to reuse the allocations
+    Vector<RID> dirty_instances;
+    Vector<Transform> dirty_instance_transforms;
+
+    void _free_server_objects(entt::entity p_entity);
+
+public:
+    entt::basic_registry<entt::entity, wrap_allocator> &get_registry() { return ecs.registry; }
+
+    entt::entity create_entity(const Transform &p_transform = Transform());
+    void destroy_entity(entt::entity p_entity);
+    bool is_entity_valid(entt::entity p_entity) const;
+    int get_entity_count() const;
+
+    void set_transform(entt::entity p_entity, const Transform &p_transform);
+    Transform get_transform(entt::entity p_entity) const;
+    void set_velocity(entt::entity p_entity, const Vector3 &p_linear, const Vector3 &p_angular = Vector3());
+    //! Shows p_mesh at the entity's transform, an invalid RID removes the visual instance.
+    void set_mesh(entt::entity p_entity, RID p_mesh);
+    //! Makes the entity collide as a kinematic body with p_shape, an invalid RID removes the body.
+    void set_collision_shape(entt::entity p_entity, RID p_shape, uint32_t p_layer = 1, uint32_t p_mask = 1);
+
+    //! Moves every entity that has a velocity by p_delta seconds, in parallel on the worker threads.
+    void integrate(float p_delta);
+    //! Sends the transforms that changed since the last call to the rendering and physics servers.
+    void sync_transforms();
+
+    explicit EntityWorld3D(const Ref<World3D> &p_world);
+    EntityWorld3D(const EntityWorld3D &) = delete;
+    EntityWorld3D &operator=(const EntityWorld3D &) = delete;
+    ~EntityWorld3D();
+};
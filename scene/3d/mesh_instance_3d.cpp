@@ -304,6 +304,11 @@ void MeshInstance3D::set_surface_material(int p_surface, const Ref<Material> &p_
 
     materials[p_surface] = p_material;
 
+    // the surface doesn't exist on the server yet, _mesh_changed() sends the material once it does
+    Ref<ArrayMesh> array_mesh = dynamic_ref_cast<ArrayMesh>(mesh);
+    if (array_mesh && array_mesh->has_pending_surfaces())
+        return;
+
     if (materials[p_surface])
         RenderingServer::get_singleton()->instance_set_surface_material(get_instance(), p_surface, materials[p_surface]->get_rid());
     else
@@ -320,6 +325,15 @@ Ref<Material> MeshInstance3D::get_surface_material(int p_surface) const {
 void MeshInstance3D::_mesh_changed() {
 
     materials.resize(mesh->get_surface_count());
+
+    // overrides set while the surfaces were still loading haven't been sent yet
+    Ref<ArrayMesh> array_mesh = dynamic_ref_cast<ArrayMesh>(mesh);
+    if (array_mesh && array_mesh->has_pending_surfaces())
+        return;
+    for (int i = 0; i < materials.size(); i++) {
+        if (materials[i])
+            RenderingServer::get_singleton()->instance_set_surface_material(get_instance(), i, materials[i]->get_rid());
+    }
 }
 
 void MeshInstance3D::create_debug_tangents() {
@@ -102,6 +102,14 @@ void Node3D::_propagate_transform_changed(Node3D *p_origin) {
         return;
     }
 
+    if (p_origin == this && (data.transform_change_deferred ||
+                                    SceneTree::defer_transform_change(this, &Node3D::_propagate_deferred_transform_change))) {
+        // processed on a worker thread, children and the notification list are updated on the main thread
+        data.transform_change_deferred = true;
+        data.dirty |= DIRTY_GLOBAL;
+        return;
+    }
+
     /*
     if (data.dirty&DIRTY_GLOBAL)
         return; //already dirty
@@ -127,6 +135,13 @@ void Node3D::_propagate_transform_changed(Node3D *p_origin) {
     data.children_lock--;
 }
 
+void Node3D::_propagate_deferred_transform_change(Node *p_node) {
+
+    Node3D *n = static_cast<Node3D *>(p_node);
+    n->data.transform_change_deferred = false;
+    n->_propagate_transform_changed(n);
+}
+
 void Node3D::_notification(int p_what) {
 
     switch (p_what) {
@@ -841,6 +856,7 @@ Node3D::Node3D() :
 #endif
     data.notify_local_transform = false;
     data.notify_transform = false;
+    data.transform_change_deferred = false;
     data.parent = nullptr;
 }
 
@@ -97,6 +97,8 @@ class GODOT_EXPORT Node3D : public Node {
         bool ignore_notification;
         bool notify_local_transform;
         bool notify_transform;
+        // changed while processed in parallel, propagation is queued on the scene tree
+        bool transform_change_deferred;
 
         bool visible;
         bool disable_scale;
@@ -112,6 +114,7 @@ class GODOT_EXPORT Node3D : public Node {
     void _update_gizmo();
     void _notify_dirty();
     void _propagate_transform_changed(Node3D *p_origin);
+    static void _propagate_deferred_transform_change(Node *p_node);
 
     void _propagate_visibility_changed();
 public:
@@ -118,6 +118,8 @@ struct Node::PrivData {
 
     bool physics_process_internal;
     bool idle_process_internal;
+    // _process/_physics_process run on worker threads, see SceneTree::_notify_group_parallel
+    bool process_parallel;
 
     bool input;
     bool unhandled_input;
@@ -510,13 +512,15 @@ void Node::set_physics_process(bool p_process) {
 
     if (priv_data->physics_process == p_process)
         return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't change processing while nodes are processed in parallel. Consider using call_deferred(\"set_physics_process\", enable) instead.");
 
     priv_data->physics_process = p_process;
 
+    StringName group(priv_data->process_parallel ? "physics_process_parallel" : "physics_process");
     if (priv_data->physics_process)
-        add_to_group("physics_process", false);
+        add_to_group(group, false);
     else
-        remove_from_group("physics_process");
+        remove_from_group(group);
 
     Object_change_notify(this,"physics_process");
 }
@@ -530,6 +534,7 @@ void Node::set_physics_process_internal(bool p_process_internal) {
 
     if (priv_data->physics_process_internal == p_process_internal)
         return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't change processing while nodes are processed in parallel. Consider using call_deferred(\"set_physics_process_internal\", enable) instead.");
 
     priv_data->physics_process_internal = p_process_internal;
 
@@ -949,13 +954,15 @@ void Node::set_process(bool p_idle_process) {
 
     if (priv_data->idle_process == p_idle_process)
         return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't change processing while nodes are processed in parallel. Consider using call_deferred(\"set_process\", enable) instead.");
 
     priv_data->idle_process = p_idle_process;
 
+    StringName group(priv_data->process_parallel ? "idle_process_parallel" : "idle_process");
     if (priv_data->idle_process)
-        add_to_group("idle_process", false);
+        add_to_group(group, false);
     else
-        remove_from_group("idle_process");
+        remove_from_group(group);
 
     Object_change_notify(this,"idle_process");
 }
@@ -969,6 +976,7 @@ void Node::set_process_internal(bool p_idle_process_internal) {
 
     if (priv_data->idle_process_internal == p_idle_process_internal)
         return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't change processing while nodes are processed in parallel. Consider using call_deferred(\"set_process_internal\", enable) instead.");
 
     priv_data->idle_process_internal = p_idle_process_internal;
 
@@ -993,7 +1001,8 @@ void Node::set_process_priority(int p_priority) {
         return;
     }
 
-    if (is_processing()) {
+    // parallel groups have no order to update
+    if (is_processing() && !priv_data->process_parallel) {
         tree->make_group_changed("idle_process");
     }
 
@@ -1001,7 +1010,7 @@ void Node::set_process_priority(int p_priority) {
         tree->make_group_changed("idle_process_internal");
     }
 
-    if (is_physics_processing()) {
+    if (is_physics_processing() && !priv_data->process_parallel) {
         tree->make_group_changed("physics_process");
     }
 
@@ -1015,6 +1024,29 @@ int Node::get_process_priority() const {
     return process_priority;
 }
 
+void Node::set_process_parallel(bool p_enable) {
+
+    if (priv_data->process_parallel == p_enable)
+        return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't change process_parallel while nodes are processed in parallel.");
+
+    // move the node between the serial and the parallel groups
+    bool idle = priv_data->idle_process;
+    bool physics = priv_data->physics_process;
+    set_process(false);
+    set_physics_process(false);
+    priv_data->process_parallel = p_enable;
+    set_process(idle);
+    set_physics_process(physics);
+
+    Object_change_notify(this, "process_parallel");
+}
+
+bool Node::is_process_parallel() const {
+
+    return priv_data->process_parallel;
+}
+
 void Node::set_process_input(bool p_enable) {
 
     if (p_enable == priv_data->input)
@@ -1331,6 +1363,7 @@ void Node::add_child(Node *p_child, bool p_legible_unique_name) {
                                                     "'."); // Fail if node has a parent
     ERR_FAIL_COND_MSG(blocked > 0, "Parent node is busy setting up children, add_node() failed. Consider using "
                                          "call_deferred(\"add_child\", child) instead.");
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't add children while nodes are processed in parallel. Consider using call_deferred(\"add_child\", child) instead.");
 
     /* Validate name */
     _validate_child_name(p_child, p_legible_unique_name);
@@ -1388,6 +1421,7 @@ void Node::remove_child(Node *p_child) {
 
     ERR_FAIL_NULL(p_child);
     ERR_FAIL_COND_MSG(blocked > 0, "Parent node is busy setting up children, remove_node() failed. Consider using call_deferred(\"remove_child\", child) instead.");
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't remove children while nodes are processed in parallel. Consider using call_deferred(\"remove_child\", child) or queue_free() instead.");
 
     int child_count = priv_data->children.size();
     Node **children = priv_data->children.data();
@@ -1835,6 +1869,7 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 
     if (priv_data->grouped.contains(p_identifier))
         return;
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't add to groups while nodes are processed in parallel. Consider using call_deferred(\"add_to_group\", group) instead.");
 
     GroupData gd;
 
@@ -1852,6 +1887,7 @@ void Node::add_to_group(const StringName &p_identifier, bool p_persistent) {
 void Node::remove_from_group(const StringName &p_identifier) {
 
     ERR_FAIL_COND(!priv_data->grouped.contains(p_identifier));
+    ERR_FAIL_COND_MSG(tree && tree->is_in_parallel_process(), "Can't remove from groups while nodes are processed in parallel. Consider using call_deferred(\"remove_from_group\", group) instead.");
 
     HashMap<StringName, GroupData>::iterator E = priv_data->grouped.find(p_identifier);
 
@@ -2919,6 +2955,8 @@ void Node::_bind_methods() {
     MethodBinder::bind_method(D_METHOD("set_process", {"enable"}), &Node::set_process);
     MethodBinder::bind_method(D_METHOD("set_process_priority", {"priority"}), &Node::set_process_priority);
     MethodBinder::bind_method(D_METHOD("get_process_priority"), &Node::get_process_priority);
+    MethodBinder::bind_method(D_METHOD("set_process_parallel", {"enable"}), &Node::set_process_parallel);
+    MethodBinder::bind_method(D_METHOD("is_process_parallel"), &Node::is_process_parallel);
     MethodBinder::bind_method(D_METHOD("is_processing"), &Node::is_processing);
     MethodBinder::bind_method(D_METHOD("set_process_input", {"enable"}), &Node::set_process_input);
     MethodBinder::bind_method(D_METHOD("is_processing_input"), &Node::is_processing_input);
@@ -3061,6 +3099,7 @@ void Node::_bind_methods() {
     ADD_PROPERTY(PropertyInfo(VariantType::OBJECT, "multiplayer", PropertyHint::ResourceType, "MultiplayerAPI", 0), "", "get_multiplayer");
     ADD_PROPERTY(PropertyInfo(VariantType::OBJECT, "custom_multiplayer", PropertyHint::ResourceType, "MultiplayerAPI", 0), "set_custom_multiplayer", "get_custom_multiplayer");
     ADD_PROPERTY(PropertyInfo(VariantType::INT, "process_priority"), "set_process_priority", "get_process_priority");
+    ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "process_parallel"), "set_process_parallel", "is_process_parallel");
 
 
     BIND_VMETHOD(MethodInfo("_process", PropertyInfo(VariantType::FLOAT, "delta")));
@@ -3087,6 +3126,7 @@ Node::Node() {
     process_priority = 0;
     priv_data->physics_process_internal = false;
     priv_data->idle_process_internal = false;
+    priv_data->process_parallel = false;
     inside_tree = false;
     priv_data->ready_notified = false;
 
@@ -310,6 +310,9 @@ public:
     void set_process_priority(int p_priority);
     int get_process_priority() const;
 
+    void set_process_parallel(bool p_enable);
+    bool is_process_parallel() const;
+
     void set_process_input(bool p_enable);
     bool is_processing_input() const;
 
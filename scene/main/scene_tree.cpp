@@ -46,6 +46,7 @@
 #include "core/os/keyboard.h"
 #include "core/os/mutex.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "core/resource/resource_manager.h"
@@ -69,6 +70,11 @@ VARIANT_ENUM_CAST(SceneTree::StretchMode);
 VARIANT_ENUM_CAST(SceneTree::StretchAspect);
 VARIANT_ENUM_CAST(SceneTree::GroupCallFlags);
 
+namespace {
+// transform changes of the parallel batch the calling thread is running, null outside of one
+thread_local Vector<SceneTree::DeferredTransformChange> *t_xform_changes = nullptr;
+} // namespace
+
 #ifdef DEBUG_ENABLED
 struct SceneTreeDebugAccessor final : public ISceneTreeDebugAccessor{
     SceneTree *m_parent;
@@ -484,8 +490,6 @@ void SceneTree::node_removed(Node *p_node) {
         current_scene = nullptr;
     }
     emit_signal(node_removed_name, Variant(p_node));
-    if (call_lock > 0)
-        call_skip.insert(p_node);
 }
 
 void SceneTree::node_renamed(Node *p_node) {
@@ -511,9 +515,20 @@ void SceneTree::remove_from_group(const StringName &p_group, Node *p_node) {
 
     HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
     ERR_FAIL_COND(E==group_map.end());
+    SceneTreeGroup &g = E->second;
 
-    E->second.nodes.erase_first(p_node);
-    if (E->second.nodes.empty())
+    if (g.iteration_lock) {
+        // the group is being walked, keep the other nodes where they are
+        auto iter = eastl::find(g.nodes.begin(), g.nodes.end(), p_node);
+        if (iter != g.nodes.end()) {
+            *iter = nullptr;
+            g.tombstones++;
+        }
+        return;
+    }
+
+    g.nodes.erase_first(p_node);
+    if (g.nodes.empty())
         group_map.erase(E);
 }
 
@@ -562,6 +577,8 @@ void SceneTree::_update_group_order(SceneTreeGroup &g, bool p_use_priority) {
         return;
     if (g.nodes.empty())
         return;
+    if (g.iteration_lock)
+        return; // sorted once nothing walks it anymore
 
     Node **nodes = g.nodes.data();
     int node_count = g.nodes.size();
@@ -576,6 +593,38 @@ void SceneTree::_update_group_order(SceneTreeGroup &g, bool p_use_priority) {
     g.changed = false;
 }
 
+/**
+ * Starts walking p_group, returns nullptr if there is nothing to walk. Until the matching _unlock_group the nodes
+ * keep their slots, so dispatch goes over the group itself instead of a copy of it.
+ */
+SceneTreeGroup *SceneTree::_lock_group(const StringName &p_group, bool p_use_priority) {
+
+    HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
+    if (E == group_map.end())
+        return nullptr;
+    SceneTreeGroup &g = E->second;
+    if (int(g.nodes.size()) == g.tombstones)
+        return nullptr;
+
+    _update_group_order(g, p_use_priority);
+    g.iteration_lock++;
+    return &g;
+}
+
+void SceneTree::_unlock_group(const StringName &p_group, SceneTreeGroup &g) {
+
+    ERR_FAIL_COND(g.iteration_lock <= 0);
+    if (--g.iteration_lock > 0)
+        return;
+
+    if (g.tombstones) {
+        g.nodes.erase(eastl::remove(g.nodes.begin(), g.nodes.end(), nullptr), g.nodes.end());
+        g.tombstones = 0;
+    }
+    if (g.nodes.empty())
+        group_map.erase(p_group);
+}
+
 void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
 
     HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
@@ -609,143 +658,33 @@ void SceneTree::call_group_flags(uint32_t p_call_flags, const StringName &p_grou
         return;
     }
 
-    _update_group_order(g);
-
-    Vector<Node *> nodes_copy = g.nodes;
-    Node **nodes = nodes_copy.data();
-    int node_count = nodes_copy.size();
-
-    call_lock++;
-
-    if (p_call_flags & GROUP_CALL_REVERSE) {
-        for (int i = node_count - 1; i >= 0; i--) {
-            if (call_lock && call_skip.contains(nodes[i])) {
-                continue;
-            }
-
-            if (p_call_flags & GROUP_CALL_REALTIME) {
-                nodes[i]->call_va(p_function, VARIANT_ARG_PASS);
-            } else {
-                MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
-            }
-        }
-
-    }  else {
-
-        for (int i = 0; i < node_count; i++) {
-            if (call_lock && call_skip.contains(nodes[i])) {
-                continue;
-            }
-
-            if (p_call_flags & GROUP_CALL_REALTIME) {
-                nodes[i]->call_va(p_function, VARIANT_ARG_PASS);
-            } else {
-                MessageQueue::get_singleton()->push_call(nodes[i], p_function, VARIANT_ARG_PASS);
-            }
+    _for_each_in_group(p_group, p_call_flags & GROUP_CALL_REVERSE, false, [&](Node *p_node) {
+        if (p_call_flags & GROUP_CALL_REALTIME) {
+            p_node->call_va(p_function, VARIANT_ARG_PASS);
+        } else {
+            MessageQueue::get_singleton()->push_call(p_node, p_function, VARIANT_ARG_PASS);
         }
-    }
-
-    call_lock--;
-    if (call_lock == 0)
-        call_skip.clear();
+    });
 }
 
 void SceneTree::notify_group_flags(uint32_t p_call_flags, const StringName &p_group, int p_notification) {
 
-    HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
-    if (E==group_map.end())
-        return;
-    SceneTreeGroup &g = E->second;
-    if (g.nodes.empty())
-        return;
-
-    _update_group_order(g);
-
-    Vector<Node *> nodes_copy = g.nodes;
-    Node **nodes = nodes_copy.data();
-    int node_count = nodes_copy.size();
-
-    call_lock++;
-
-    if (p_call_flags & GROUP_CALL_REVERSE) {
-
-        for (int i = node_count - 1; i >= 0; i--) {
-
-            if (call_lock && call_skip.contains(nodes[i]))
-                continue;
-
-            if (p_call_flags & GROUP_CALL_REALTIME)
-                nodes[i]->notification(p_notification);
-            else
-                MessageQueue::get_singleton()->push_notification(nodes[i], p_notification);
-        }
-
-    } else {
-
-        for (int i = 0; i < node_count; i++) {
-
-            if (call_lock && call_skip.contains(nodes[i]))
-                continue;
-
-            if (p_call_flags & GROUP_CALL_REALTIME)
-                nodes[i]->notification(p_notification);
-            else
-                MessageQueue::get_singleton()->push_notification(nodes[i], p_notification);
-        }
-    }
-
-    call_lock--;
-    if (call_lock == 0)
-        call_skip.clear();
+    _for_each_in_group(p_group, p_call_flags & GROUP_CALL_REVERSE, false, [&](Node *p_node) {
+        if (p_call_flags & GROUP_CALL_REALTIME)
+            p_node->notification(p_notification);
+        else
+            MessageQueue::get_singleton()->push_notification(p_node, p_notification);
+    });
 }
 
 void SceneTree::set_group_flags(uint32_t p_call_flags, const StringName &p_group, const StringName &p_name, const Variant &p_value) {
 
-    HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
-    if (E==group_map.end())
-        return;
-    SceneTreeGroup &g = E->second;
-    if (g.nodes.empty())
-        return;
-
-    _update_group_order(g);
-
-    Vector<Node *> nodes_copy = g.nodes;
-    Node **nodes = nodes_copy.data();
-    int node_count = nodes_copy.size();
-
-    call_lock++;
-
-    if (p_call_flags & GROUP_CALL_REVERSE) {
-
-        for (int i = node_count - 1; i >= 0; i--) {
-
-            if (call_lock && call_skip.contains(nodes[i]))
-                continue;
-
-            if (p_call_flags & GROUP_CALL_REALTIME)
-                nodes[i]->set(p_name, p_value);
-            else
-                MessageQueue::get_singleton()->push_set(nodes[i], p_name, p_value);
-        }
-
-    } else {
-
-        for (int i = 0; i < node_count; i++) {
-
-            if (call_lock && call_skip.contains(nodes[i]))
-                continue;
-
-            if (p_call_flags & GROUP_CALL_REALTIME)
-                nodes[i]->set(p_name, p_value);
-            else
-                MessageQueue::get_singleton()->push_set(nodes[i], p_name, p_value);
-        }
-    }
-
-    call_lock--;
-    if (call_lock == 0)
-        call_skip.clear();
+    _for_each_in_group(p_group, p_call_flags & GROUP_CALL_REVERSE, false, [&](Node *p_node) {
+        if (p_call_flags & GROUP_CALL_REALTIME)
+            p_node->set(p_name, p_value);
+        else
+            MessageQueue::get_singleton()->push_set(p_node, p_name, p_value);
+    });
 }
 
 void SceneTree::call_group(const StringName &p_group, const StringName &p_function, VARIANT_ARG_DECLARE) {
@@ -833,6 +772,7 @@ void SceneTree::init() {
 }
 
 bool SceneTree::iteration(float p_time) {
+    SCOPE_AUTONAMED
 
     root_lock++;
 
@@ -847,6 +787,7 @@ bool SceneTree::iteration(float p_time) {
 
     _notify_group_pause("physics_process_internal", Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
     _notify_group_pause("physics_process", Node::NOTIFICATION_PHYSICS_PROCESS);
+    _notify_group_parallel("physics_process_parallel", Node::NOTIFICATION_PHYSICS_PROCESS);
     _flush_ugc();
     MessageQueue::get_singleton()->flush(); //small little hack
     flush_transform_notifications();
@@ -891,6 +832,7 @@ bool SceneTree::idle(float p_time) {
 
     _notify_group_pause("idle_process_internal", Node::NOTIFICATION_INTERNAL_PROCESS);
     _notify_group_pause("idle_process", Node::NOTIFICATION_PROCESS);
+    _notify_group_parallel("idle_process_parallel", Node::NOTIFICATION_PROCESS);
 
     Size2 win_size = Size2(OS::get_singleton()->get_window_size().width, OS::get_singleton()->get_window_size().height);
 
@@ -1264,43 +1206,15 @@ bool SceneTree::is_paused() const {
 
 void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input) {
 
-    HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
-
-    if (E==group_map.end()) {
-        return;
-    }
-
-    SceneTreeGroup &g = E->second;
-
-    if (g.nodes.empty()) {
-        return;
-    }
-
-    _update_group_order(g);
-
-    //copy, so copy on write happens in case something is removed from process while being called
-    //performance is not lost because only if something is added/removed the vector is copied.
-    Vector<Node *> nodes_copy = g.nodes;
-
-    int node_count = nodes_copy.size();
-    Node **nodes = nodes_copy.data();
-
     Variant arg = p_input;
     const Variant *v[1] = { &arg };
 
-    call_lock++;
-
-    for (int i = node_count - 1; i >= 0; i--) {
-
+    _for_each_in_group(p_group, true, false, [&](Node *n) {
         if (input_handled)
-            break;
-
-        Node *n = nodes[i];
-        if (call_lock && call_skip.contains(n))
-            continue;
+            return;
 
         if (!n->can_process())
-            continue;
+            return;
 
         Callable::CallError err;
         // Call both script and native method.
@@ -1311,49 +1225,91 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
         if (method) {
             method->call(n, (const Variant **)v, 1, err);
         }
-        //ERR_FAIL_COND();
-    }
-
-    call_lock--;
-    if (call_lock == 0) {
-        call_skip.clear();
-    }
+    });
 }
 
 void SceneTree::_notify_group_pause(const StringName &p_group, int p_notification) {
 
+    const bool use_priority = p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS ||
+                              p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS;
+
+    _for_each_in_group(p_group, false, use_priority, [&](Node *n) {
+        if (!n->can_process())
+            return;
+        if (!n->can_process_notification(p_notification))
+            return;
+
+        n->notification(p_notification);
+    });
+}
+
+/**
+ * Sends p_notification to the nodes of p_group from worker threads, in batches. Unlike the serial groups there
+ * is no order between these nodes; all of them are done before this returns, so the serial groups of the same
+ * frame always run before and everything after sees their results.
+ *
+ * While this runs the tree can't be restructured: adding or removing children fails, changes have to go through
+ * call_deferred, set_deferred or queue_free, which are flushed on the main thread afterwards.
+ * Transform changes touch the parent-child chain and the shared notification list, so the nodes only mark
+ * themselves and their propagation runs here once all batches are done.
+ */
+void SceneTree::_notify_group_parallel(const StringName &p_group, int p_notification) {
+
+    // enough work per task to amortize scheduling, small enough to balance uneven node costs
+    const int batch_size = 32;
+
     HashMap<StringName, SceneTreeGroup>::iterator E = group_map.find(p_group);
-    if (E==group_map.end())
+    if (E == group_map.end())
         return;
     SceneTreeGroup &g = E->second;
     if (g.nodes.empty())
         return;
 
-    _update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
-
-    //copy, so copy on write happens in case something is removed from process while being called
-    //performance is not lost because only if something is added/removed the vector is copied.
-    Vector<Node *> nodes_copy = g.nodes;
-
-    call_lock++;
-
-    for (Node *n : nodes_copy) {
-
-        if (call_lock && call_skip.contains(n))
-            continue;
+    // pause state is checked up front, it depends on ancestors that may be processed concurrently
+    parallel_process_nodes.clear();
+    for (Node *n : g.nodes) {
+        if (n && n->can_process() && n->can_process_notification(p_notification)) {
+            parallel_process_nodes.push_back(n);
+        }
+    }
+    if (parallel_process_nodes.empty())
+        return;
 
-        if (!n->can_process())
-            continue;
-        if (!n->can_process_notification(p_notification))
-            continue;
+    const int node_count = parallel_process_nodes.size();
+    Node **nodes = parallel_process_nodes.data();
+
+    const int batch_count = (node_count + batch_size - 1) / batch_size;
+    if (int(parallel_xform_changes.size()) < batch_count)
+        parallel_xform_changes.resize(batch_count);
+    Vector<DeferredTransformChange> *changes = parallel_xform_changes.data();
+
+    in_parallel_process = true;
+    WorkerThreadPool::get_singleton()->parallel_for(batch_count, [=](uint32_t p_batch) {
+        // a worker waiting inside a node may run another batch meanwhile, so restore instead of clearing
+        Vector<DeferredTransformChange> *prev_changes = t_xform_changes;
+        t_xform_changes = &changes[p_batch];
+        const int end = MIN(node_count, int(p_batch + 1) * batch_size);
+        for (int i = p_batch * batch_size; i < end; i++) {
+            nodes[i]->notification(p_notification);
+        }
+        t_xform_changes = prev_changes;
+    });
+    in_parallel_process = false;
 
-        n->notification(p_notification);
-        //ERR_FAIL_COND();
+    for (int i = 0; i < batch_count; i++) {
+        for (const DeferredTransformChange &c : changes[i]) {
+            c.propagate(c.node);
+        }
+        changes[i].clear();
     }
+}
+
+bool SceneTree::defer_transform_change(Node *p_node, TransformChangeFunc p_propagate) {
 
-    call_lock--;
-    if (call_lock == 0)
-        call_skip.clear();
+    if (!t_xform_changes)
+        return false;
+    t_xform_changes->push_back({ p_node, p_propagate });
+    return true;
 }
 
 /*
@@ -1432,12 +1388,13 @@ Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
     if (nc == 0)
         return ret;
 
-    ret.resize(nc);
+    ret.reserve(nc - E->second.tombstones);
 
     Node **ptr = E->second.nodes.data();
     for (int i = 0; i < nc; i++) {
 
-        ret[i] = Variant(ptr[i]);
+        if (ptr[i])
+            ret.push_back(Variant(ptr[i]));
     }
 
     return ret;
@@ -1445,7 +1402,9 @@ Array SceneTree::_get_nodes_in_group(const StringName &p_group) {
 
 bool SceneTree::has_group(const StringName &p_identifier) const {
 
-    return group_map.contains(p_identifier);
+    auto E = group_map.find(p_identifier);
+    // a group emptied while being walked is only erased afterwards
+    return E != group_map.end() && int(E->second.nodes.size()) > E->second.tombstones;
 }
 void SceneTree::get_nodes_in_group(const StringName &p_group, Deque<Node *> *p_list) {
 
@@ -1460,7 +1419,8 @@ void SceneTree::get_nodes_in_group(const StringName &p_group, Deque<Node *> *p_l
     Node **ptr = E->second.nodes.data();
     for (int i = 0; i < nc; i++) {
 
-        p_list->push_back(ptr[i]);
+        if (ptr[i])
+            p_list->push_back(ptr[i]);
     }
 }
 
@@ -2039,7 +1999,6 @@ SceneTree::SceneTree() {
     node_removed_name = "node_removed";
     node_renamed_name = "node_renamed";
     ugc_locked = false;
-    call_lock = 0;
     root_lock = 0;
     node_count = 0;
 
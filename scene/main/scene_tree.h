@@ -100,6 +100,10 @@ struct SceneTreeGroup
 {
     Vector<Node *> nodes;
     //uint64_t last_tree_version;
+    //! Number of dispatches currently walking nodes. While it's not zero removed nodes leave a null slot behind
+    //! instead of shifting the array, those are compacted when the outermost dispatch ends.
+    int iteration_lock = 0;
+    int tombstones = 0;
     bool changed=false;
 };
 
@@ -176,9 +180,18 @@ private:
 
     };
 
-    //safety for when a node is deleted while a group is being called
-    int call_lock;
-    HashSet<Node *> call_skip; //skip erased nodes
+    // nodes of the parallel group that are processed this frame, reused to avoid allocations
+    Vector<Node *> parallel_process_nodes;
+public:
+    using TransformChangeFunc = void (*)(Node *);
+    struct DeferredTransformChange {
+        Node *node;
+        TransformChangeFunc propagate;
+    };
+private:
+    // transform changes made by the parallel nodes, one list per batch, propagated on the main thread afterwards
+    Vector<Vector<DeferredTransformChange>> parallel_xform_changes;
+    bool in_parallel_process = false;
 
     StretchMode stretch_mode;
     StretchAspect stretch_aspect;
@@ -195,6 +208,29 @@ private:
     void _flush_ugc();
 
     _FORCE_INLINE_ void _update_group_order(SceneTreeGroup &g, bool p_use_priority = false);
+    SceneTreeGroup *_lock_group(const StringName &p_group, bool p_use_priority);
+    void _unlock_group(const StringName &p_group, SceneTreeGroup &g);
+    template <class F>
+    void _for_each_in_group(const StringName &p_group, bool p_reverse, bool p_use_priority, F &&p_func) {
+        SceneTreeGroup *g = _lock_group(p_group, p_use_priority);
+        if (!g)
+            return;
+        // the array is read through g on every step, it may grow (and move) while iterating; nodes added meanwhile
+        // are not visited
+        const int node_count = g->nodes.size();
+        if (p_reverse) {
+            for (int i = node_count - 1; i >= 0; i--) {
+                if (Node *n = g->nodes[i])
+                    p_func(n);
+            }
+        } else {
+            for (int i = 0; i < node_count; i++) {
+                if (Node *n = g->nodes[i])
+                    p_func(n);
+            }
+        }
+        _unlock_group(p_group, *g);
+    }
     void _update_listener();
 
 
@@ -248,6 +284,7 @@ private:
     void make_group_changed(const StringName &p_group);
 
     void _notify_group_pause(const StringName &p_group, int p_notification);
+    void _notify_group_parallel(const StringName &p_group, int p_notification);
     void _call_input_pause(const StringName &p_group, const StringName &p_method, const Ref<InputEvent> &p_input);
 
     void _flush_delete_queue();
@@ -292,6 +329,15 @@ public:
     void call_group(const StringName &p_group, const StringName &p_function, VARIANT_ARG_LIST);
     void notify_group(const StringName &p_group, int p_notification);
     void set_group(const StringName &p_group, const StringName &p_name, const Variant &p_value);
+    /**
+     * Calls p_func(Node *) on every node of p_group right away, in group order (reversed with GROUP_CALL_REVERSE),
+     * without packing arguments into Variants. Nodes removed from the group during the walk are skipped, nodes
+     * added to it are not visited.
+     */
+    template <class F>
+    void for_each_in_group(uint32_t p_call_flags, const StringName &p_group, F &&p_func) {
+        _for_each_in_group(p_group, p_call_flags & GROUP_CALL_REVERSE, false, p_func);
+    }
 
     void flush_transform_notifications();
 
@@ -322,6 +368,11 @@ public:
 
     void set_pause(bool p_enabled);
     bool is_paused() const;
+    //! True while the nodes that opted into parallel processing are running on worker threads.
+    bool is_in_parallel_process() const { return in_parallel_process; }
+    //! When called from a node processed in parallel, queues p_propagate to run on the main thread once the
+    //! parallel phase is done and returns true; returns false anywhere else, the change is then propagated directly.
+    static bool defer_transform_change(Node *p_node, TransformChangeFunc p_propagate);
 
     void set_camera(const RID &p_camera);
     RID get_camera() const;
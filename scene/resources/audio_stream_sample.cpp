@@ -412,6 +412,13 @@ AudioStreamPlaybackSample::AudioStreamPlaybackSample() {
     sign = 1;
 }
 
+AudioStreamPlaybackSample::~AudioStreamPlaybackSample() {
+
+    if (base) {
+        base->playback_count--;
+    }
+}
+
 /////////////////////
 
 void AudioStreamSample::set_format(Format p_format) {
@@ -484,7 +491,7 @@ float AudioStreamSample::get_length() const {
     return float(len) / mix_rate;
 }
 
-void AudioStreamSample::set_data(Span<const uint8_t> p_data) {
+void AudioStreamSample::_set_data(Span<const uint8_t> p_data) {
 
     AudioServer::get_singleton()->lock();
     if (data) {
@@ -505,8 +512,19 @@ void AudioStreamSample::set_data(Span<const uint8_t> p_data) {
 
     AudioServer::get_singleton()->unlock();
 }
+
+void AudioStreamSample::set_data(Span<const uint8_t> p_data) {
+
+    _payload_release();
+    streamed_data.unref();
+    staged_data = PoolVector<uint8_t>();
+    _set_data(p_data);
+}
+
 PoolVector<uint8_t> AudioStreamSample::get_data() const {
 
+    ResourcePayloadStreamer::get_singleton()->ensure(const_cast<AudioStreamSample *>(this));
+
     PoolVector<uint8_t> pv;
 
     if (data) {
@@ -600,9 +618,56 @@ Ref<AudioStreamPlayback> AudioStreamSample::instance_playback() {
 
     Ref<AudioStreamPlaybackSample> sample(make_ref_counted<AudioStreamPlaybackSample>());
     sample->base = Ref<AudioStreamSample>(this);
+    playback_count++;
+    ResourcePayloadStreamer::get_singleton()->ensure(this);
     return sample;
 }
 
+bool AudioStreamSample::_set_streamed_property(const StringName &p_name, const Variant &p_value) {
+
+    if (p_name != "data") {
+        return false;
+    }
+    Ref<StreamedPayload> payload = refFromVariant<StreamedPayload>(p_value);
+    if (!payload || payload->get_array_type() != VariantType::POOL_BYTE_ARRAY) {
+        return false;
+    }
+
+    set_data(Span<const uint8_t>());
+    streamed_data = payload;
+    data_bytes = payload->get_count(); // keeps get_length() working before the data is read
+    _payload_defer();
+    return true;
+}
+
+Error AudioStreamSample::_payload_read() {
+
+    staged_data = streamed_data->load().as<PoolVector<uint8_t>>();
+    return staged_data.size() == int(streamed_data->get_count()) ? OK : ERR_FILE_CORRUPT;
+}
+
+uint64_t AudioStreamSample::_payload_apply() {
+
+    {
+        PoolVector<uint8_t>::Read r = staged_data.read();
+        _set_data(Span<const uint8_t>(r.ptr(), staged_data.size()));
+    }
+    staged_data = PoolVector<uint8_t>();
+    return data_bytes + DATA_PAD * 2;
+}
+
+bool AudioStreamSample::_payload_evict() {
+
+    AudioServer::get_singleton()->lock();
+    bool idle = playback_count == 0;
+    if (idle && data) {
+        AudioServer::get_singleton()->audio_data_free(data);
+        data = nullptr; // data_bytes is kept, the data is read again by the next playback
+    }
+    AudioServer::get_singleton()->unlock();
+    return idle;
+}
+
 String AudioStreamSample::get_stream_name() const {
 
     return String();
@@ -663,6 +728,7 @@ AudioStreamSample::AudioStreamSample() {
 }
 AudioStreamSample::~AudioStreamSample() {
 
+    _payload_release();
     if (data) {
         AudioServer::get_singleton()->audio_data_free(data);
         data = nullptr;
@@ -30,8 +30,11 @@
 
 #pragma once
 
+#include "core/io/resource_payload_streamer.h"
 #include "servers/audio/audio_stream.h"
 
+#include <atomic>
+
 class AudioStreamSample;
 
 class AudioStreamPlaybackSample : public AudioStreamPlayback {
@@ -78,9 +81,10 @@ public:
     void mix(AudioFrame *p_buffer, float p_rate_scale, int p_frames) override;
 
     AudioStreamPlaybackSample();
+    ~AudioStreamPlaybackSample() override;
 };
 
-class GODOT_EXPORT AudioStreamSample : public AudioStream {
+class GODOT_EXPORT AudioStreamSample : public AudioStream, public StreamedPayloadOwner {
     GDCLASS(AudioStreamSample,AudioStream)
 
     RES_BASE_EXTENSION("sample")
@@ -115,9 +119,22 @@ private:
     void *data;
     uint32_t data_bytes;
 
+    // sample data left on disk by the loader, data_bytes already holds its size
+    Ref<StreamedPayload> streamed_data;
+    PoolVector<uint8_t> staged_data;
+    // playbacks mixing this sample, its data is only evicted while there are none
+    std::atomic<int> playback_count { 0 };
+
+    void _set_data(Span<const uint8_t> p_data);
+
 protected:
     static void _bind_methods();
 
+    Error _payload_read() override;
+    uint64_t _payload_apply() override;
+    bool _payload_evictable() const override { return true; }
+    bool _payload_evict() override;
+
 public:
     void set_format(Format p_format);
     Format get_format() const;
@@ -147,6 +164,8 @@ public:
     Ref<AudioStreamPlayback> instance_playback() override;
     String get_stream_name() const override;
 
+    bool _set_streamed_property(const StringName &p_name, const Variant &p_value) override;
+
     AudioStreamSample();
     ~AudioStreamSample() override;
 };
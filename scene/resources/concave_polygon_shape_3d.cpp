@@ -67,7 +67,7 @@ Vector<Vector3> ConcavePolygonShape3D::get_debug_mesh_lines() {
     int datalen = data.size();
     ERR_FAIL_COND_V((datalen % 3) != 0, Vector<Vector3>());
 
-    PoolVector<Vector3>::Read r = data.read();
+    const Vector3 *r = data.ptr();
 
     for (int i = 0; i < datalen; i += 3) {
 
@@ -97,10 +97,9 @@ void ConcavePolygonShape3D::_update_shape() {
 
 real_t ConcavePolygonShape3D::get_enclosing_radius() const {
     PoolVector<Vector3> data = get_faces();
-    PoolVector<Vector3>::Read read = data.read();
     real_t r = 0;
-    for (int i(0); i < data.size(); i++) {
-        r = M_MAX(read[i].length_squared(), r);
+    for (const Vector3 &v : data.toSpan()) {
+        r = M_MAX(v.length_squared(), r);
     }
     return Math::sqrt(r);
 }
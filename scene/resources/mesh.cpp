@@ -31,6 +31,7 @@
 #include "mesh.h"
 
 #include "core/map.h"
+#include "core/math/mesh_optimizer.h"
 #include "core/method_bind.h"
 #include "core/object_tooling.h"
 #include "core/pair.h"
@@ -132,7 +133,7 @@ void Mesh::generate_debug_mesh_lines(Vector<Vector3> &r_lines) {
 
     debug_lines.resize(tm->get_triangles().size() * 6); // 3 lines x 2 points each line
 
-    PoolVector<int>::Read ind_r = triangle_indices.read();
+    const int *ind_r = triangle_indices.ptr();
     for (int j = 0, x = 0, i = 0; i < triangles_num; j += 6, x += 3, ++i) {
         // Triangle line 1
         debug_lines[j + 0] = vertices[ind_r[x + 0]];
@@ -594,12 +595,83 @@ bool ArrayMesh::_set(const StringName &p_name, const Variant &p_value) {
     int idx = StringUtils::to_int(StringUtils::get_slice(p_name,'/', 1));
     StringName what(StringUtils::get_slice(p_name,'/', 2));
 
-    if (idx != surfaces.size()) {
+    if (idx != surfaces.size() + pending_surfaces.size()) {
         return false;
     }
 
-    //create
     Dictionary d = p_value.as<Dictionary>();
+    if (!pending_surfaces.empty()) {
+        //keep the order, surfaces after a deferred one are created with it
+        pending_surfaces.push_back(d);
+        _recompute_aabb();
+        return true;
+    }
+    return _create_surface(idx, d);
+}
+
+bool ArrayMesh::_set_streamed_property(const StringName &p_name, const Variant &p_value) {
+
+    if (!StringUtils::begins_with(p_name, "surfaces/") || p_value.get_type() != VariantType::DICTIONARY)
+        return false;
+
+    int idx = StringUtils::to_int(StringUtils::get_slice(p_name, '/', 1));
+    if (idx != surfaces.size() + pending_surfaces.size())
+        return false;
+
+    Dictionary d = p_value.as<Dictionary>();
+    if (!d.has("array_data") || !d.has("primitive") || !d.has("aabb"))
+        return false;
+
+    pending_surfaces.push_back(d);
+    _recompute_aabb();
+    _payload_defer();
+    return true;
+}
+
+Error ArrayMesh::_payload_read() {
+
+    staged_surfaces.clear();
+    staged_size = 0;
+    for (const Dictionary &pending : pending_surfaces) {
+        Variant d = pending.duplicate(true);
+        Error err = StreamedPayload::resolve(d);
+        if (err != OK)
+            return err;
+        Dictionary resolved = d.as<Dictionary>();
+        staged_size += resolved["array_data"].as<PoolVector<uint8_t>>().size();
+        if (resolved.has("array_index_data"))
+            staged_size += resolved["array_index_data"].as<PoolVector<uint8_t>>().size();
+        staged_surfaces.emplace_back(eastl::move(resolved));
+    }
+    return OK;
+}
+
+uint64_t ArrayMesh::_payload_apply() {
+
+    Vector<Dictionary> ready = eastl::move(staged_surfaces);
+    staged_surfaces.clear();
+    // cleared first, so the surface setters used below don't wait for this apply
+    pending_surfaces.clear();
+
+    for (const Dictionary &d : ready) {
+        _create_surface(surfaces.size(), d);
+    }
+
+    clear_cache();
+    Object_change_notify(this);
+    emit_changed();
+    return staged_size;
+}
+
+void ArrayMesh::_ensure_surfaces() const {
+
+    if (!pending_surfaces.empty()) {
+        ResourcePayloadStreamer::get_singleton()->ensure(const_cast<ArrayMesh *>(this));
+    }
+}
+
+bool ArrayMesh::_create_surface(int idx, const Dictionary &d) {
+
     ERR_FAIL_COND_V(!d.has("primitive"), false);
 
     if (d.has("arrays")) {
@@ -656,6 +728,24 @@ bool ArrayMesh::_set(const StringName &p_name, const Variant &p_value) {
         }
 
         add_surface(format, PrimitiveType(primitive), array_data, vertex_count, array_index_data, index_count, aabb, blend_shapes, bone_aabb);
+
+        if (d.has("lod_errors")) {
+            ERR_FAIL_COND_V(!d.has("lod_index_data"), false);
+            PoolVector<float> lod_errors = d["lod_errors"].as<PoolVector<float>>();
+            Array lod_index_data = d["lod_index_data"].as<Array>();
+            ERR_FAIL_COND_V(lod_errors.size() != lod_index_data.size(), false);
+
+            Vector<float> errors;
+            Vector<PoolVector<uint8_t> > lods;
+            errors.reserve(lod_errors.size());
+            lods.reserve(lod_errors.size());
+            PoolVector<float>::Read r = lod_errors.read();
+            for (int i = 0; i < lod_errors.size(); i++) {
+                errors.push_back(r[i]);
+                lods.emplace_back(lod_index_data[i].as<PoolVector<uint8_t>>());
+            }
+            RenderingServer::get_singleton()->mesh_surface_set_lods(mesh, idx, errors, lods);
+        }
     } else {
         ERR_FAIL_V(false);
     }
@@ -702,6 +792,8 @@ bool ArrayMesh::_get(const StringName &p_name, Variant &r_ret) const {
     } else if (!StringUtils::begins_with(p_name,"surfaces"))
         return false;
 
+    _ensure_surfaces();
+
     int idx = StringUtils::to_int(StringUtils::get_slice(p_name,'/', 1));
     ERR_FAIL_INDEX_V(idx, surfaces.size(), false);
 
@@ -731,6 +823,18 @@ bool ArrayMesh::_get(const StringName &p_name, Variant &r_ret) const {
     }
     d["blend_shape_data"] = eastl::move(md);
 
+    int lod_count = RenderingServer::get_singleton()->mesh_surface_get_lod_count(mesh, idx);
+    if (lod_count > 0) {
+        PoolVector<float> lod_errors;
+        Array lod_index_data;
+        for (int i = 0; i < lod_count; i++) {
+            lod_errors.push_back(RenderingServer::get_singleton()->mesh_surface_get_lod_error(mesh, idx, i));
+            lod_index_data.push_back(RenderingServer::get_singleton()->mesh_surface_get_lod_index_array(mesh, idx, i));
+        }
+        d["lod_errors"] = lod_errors;
+        d["lod_index_data"] = eastl::move(lod_index_data);
+    }
+
     Ref<Material> m = surface_get_material(idx);
     if (m)
         d["material"] = m;
@@ -754,11 +858,13 @@ void ArrayMesh::_get_property_list(Vector<PropertyInfo> *p_list) const {
         p_list->push_back(PropertyInfo(VariantType::INT, "blend_shape/mode", PropertyHint::Enum, "Normalized,Relative"));
     }
 
-    for (int i = 0; i < surfaces.size(); i++) {
+    for (int i = 0; i < get_surface_count(); i++) {
+
+        bool is_2d = i < surfaces.size() ? surfaces[i].is_2d : pending_surfaces[i - surfaces.size()]["format"].as<uint32_t>() & ARRAY_FLAG_USE_2D_VERTICES;
 
         p_list->push_back(PropertyInfo(VariantType::DICTIONARY, StringName("surfaces/" + itos(i)), PropertyHint::None, "", PROPERTY_USAGE_NOEDITOR | PROPERTY_USAGE_INTERNAL));
         p_list->push_back(PropertyInfo(VariantType::STRING, StringName("surface_" + itos(i + 1) + "/name"), PropertyHint::None, "", PROPERTY_USAGE_EDITOR));
-        if (surfaces[i].is_2d) {
+        if (is_2d) {
             p_list->push_back(PropertyInfo(VariantType::OBJECT, StringName("surface_" + itos(i + 1) + "/material"), PropertyHint::ResourceType, "ShaderMaterial,CanvasItemMaterial", PROPERTY_USAGE_EDITOR));
         } else {
             p_list->push_back(PropertyInfo(VariantType::OBJECT, StringName("surface_" + itos(i + 1) + "/material"), PropertyHint::ResourceType, "ShaderMaterial,SpatialMaterial", PROPERTY_USAGE_EDITOR));
@@ -778,10 +884,20 @@ void ArrayMesh::_recompute_aabb() {
         else
             aabb.merge_with(surfaces[i].aabb);
     }
+    // deferred surfaces already know their bounds
+    for (int i = 0; i < pending_surfaces.size(); i++) {
+
+        if (i == 0 && surfaces.empty())
+            aabb = pending_surfaces[i]["aabb"].as<AABB>();
+        else
+            aabb.merge_with(pending_surfaces[i]["aabb"].as<AABB>());
+    }
 }
 
 void ArrayMesh::add_surface(uint32_t p_format, PrimitiveType p_primitive, const PoolVector<uint8_t> &p_array, int p_vertex_count, const PoolVector<uint8_t> &p_index_array, int p_index_count, const AABB &p_aabb, const Vector<PoolVector<uint8_t> > &p_blend_shapes, const PoolVector<AABB> &p_bone_aabbs) {
 
+    _ensure_surfaces();
+
     Surface s;
     s.aabb = p_aabb;
     s.is_2d = p_format & ARRAY_FLAG_USE_2D_VERTICES;
@@ -802,6 +918,8 @@ void ArrayMesh::_add_surface_from_arrays(PrimitiveType p_primitive, const Array
 
 void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, SurfaceArrays &&p_arrays, Vector<SurfaceArrays> &&p_blend_shapes, uint32_t p_flags) {
 
+    _ensure_surfaces();
+
     Surface s;
     // Update AABB
     {
@@ -850,22 +968,28 @@ void ArrayMesh::add_surface_from_arrays(PrimitiveType p_primitive, SurfaceArrays
 }
 SurfaceArrays ArrayMesh::surface_get_arrays(int p_surface) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_surface, surfaces.size(), SurfaceArrays());
     return RenderingServer::get_singleton()->mesh_surface_get_arrays(mesh, p_surface);
 }
 Vector<SurfaceArrays> ArrayMesh::surface_get_blend_shape_arrays(int p_surface) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_surface, surfaces.size(), Vector<SurfaceArrays>());
     return RenderingServer::get_singleton()->mesh_surface_get_blend_shape_arrays(mesh, p_surface);
 }
 
 int ArrayMesh::get_surface_count() const {
 
-    return surfaces.size();
+    return surfaces.size() + pending_surfaces.size();
 }
 
 void ArrayMesh::add_blend_shape(const StringName &p_name) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_COND_MSG(surfaces.size(), "Can't add a shape key count if surfaces are already created.");
 
     StringName name = p_name;
@@ -894,6 +1018,8 @@ StringName ArrayMesh::get_blend_shape_name(int p_index) const {
 }
 void ArrayMesh::clear_blend_shapes() {
 
+    _ensure_surfaces();
+
     ERR_FAIL_COND_MSG(surfaces.size(), "Can't set shape key count if surfaces are already created.");
 
     blend_shapes.clear();
@@ -912,6 +1038,8 @@ ArrayMesh::BlendShapeMode ArrayMesh::get_blend_shape_mode() const {
 
 void ArrayMesh::surface_remove(int p_idx) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX(p_idx, surfaces.size());
     RenderingServer::get_singleton()->mesh_remove_surface(mesh, p_idx);
     surfaces.erase_at(p_idx);
@@ -924,30 +1052,40 @@ void ArrayMesh::surface_remove(int p_idx) {
 
 int ArrayMesh::surface_get_array_len(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), -1);
     return RenderingServer::get_singleton()->mesh_surface_get_array_len(mesh, p_idx);
 }
 
 int ArrayMesh::surface_get_array_index_len(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), -1);
     return RenderingServer::get_singleton()->mesh_surface_get_array_index_len(mesh, p_idx);
 }
 
 uint32_t ArrayMesh::surface_get_format(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), 0);
     return RenderingServer::get_singleton()->mesh_surface_get_format(mesh, p_idx);
 }
 
 ArrayMesh::PrimitiveType ArrayMesh::surface_get_primitive_type(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), PRIMITIVE_LINES);
     return (PrimitiveType)RenderingServer::get_singleton()->mesh_surface_get_primitive_type(mesh, p_idx);
 }
 
 void ArrayMesh::surface_set_material(int p_idx, const Ref<Material> &p_material) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX(p_idx, surfaces.size());
     if (surfaces[p_idx].material == p_material)
         return;
@@ -959,6 +1097,8 @@ void ArrayMesh::surface_set_material(int p_idx, const Ref<Material> &p_material)
 }
 
 int ArrayMesh::surface_find_by_name(const String &p_name) const {
+
+    _ensure_surfaces();
     for (int i = 0; i < surfaces.size(); i++) {
         if (surfaces[i].name == p_name) {
             return i;
@@ -970,6 +1110,8 @@ int ArrayMesh::surface_find_by_name(const String &p_name) const {
 
 void ArrayMesh::surface_set_name(int p_idx, StringView p_name) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX(p_idx, surfaces.size());
 
     surfaces[p_idx].name = p_name;
@@ -978,12 +1120,16 @@ void ArrayMesh::surface_set_name(int p_idx, StringView p_name) {
 
 String ArrayMesh::surface_get_name(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), String());
     return surfaces[p_idx].name;
 }
 
 void ArrayMesh::surface_update_region(int p_surface, int p_offset, const PoolVector<uint8_t> &p_data) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX(p_surface, surfaces.size());
     RenderingServer::get_singleton()->mesh_surface_update_region(mesh, p_surface, p_offset, p_data);
     emit_changed();
@@ -991,20 +1137,70 @@ void ArrayMesh::surface_update_region(int p_surface, int p_offset, const PoolVec
 
 void ArrayMesh::surface_set_custom_aabb(int p_idx, const AABB &p_aabb) {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX(p_idx, surfaces.size());
     surfaces[p_idx].aabb = p_aabb;
     // set custom aabb too?
     emit_changed();
 }
 
+void ArrayMesh::surface_set_lods(int p_idx, Span<const float> p_lod_errors, const Vector<Vector<int> > &p_lod_indices) {
+
+    _ensure_surfaces();
+
+    ERR_FAIL_INDEX(p_idx, surfaces.size());
+    ERR_FAIL_COND(p_lod_errors.size() != p_lod_indices.size());
+
+    // packed the same way as the surface indices, 16 bits when every vertex can be addressed with them
+    const int vertex_count = surface_get_array_len(p_idx);
+    const int index_size = vertex_count < (1 << 16) ? 2 : 4;
+
+    Vector<float> errors(p_lod_errors.begin(), p_lod_errors.end());
+    Vector<PoolVector<uint8_t> > lods;
+    lods.reserve(p_lod_indices.size());
+    for (const Vector<int> &indices : p_lod_indices) {
+        PoolVector<uint8_t> data;
+        data.resize(indices.size() * index_size);
+        PoolVector<uint8_t>::Write w = data.write();
+        for (size_t i = 0; i < indices.size(); i++) {
+            ERR_FAIL_INDEX(indices[i], vertex_count);
+            if (index_size == 2) {
+                uint16_t v = indices[i];
+                memcpy(&w[i * 2], &v, 2);
+            } else {
+                uint32_t v = indices[i];
+                memcpy(&w[i * 4], &v, 4);
+            }
+        }
+        w.release();
+        lods.emplace_back(eastl::move(data));
+    }
+
+    RenderingServer::get_singleton()->mesh_surface_set_lods(mesh, p_idx, errors, lods);
+    emit_changed();
+}
+
+int ArrayMesh::surface_get_lod_count(int p_idx) const {
+
+    _ensure_surfaces();
+
+    ERR_FAIL_INDEX_V(p_idx, surfaces.size(), 0);
+    return RenderingServer::get_singleton()->mesh_surface_get_lod_count(mesh, p_idx);
+}
+
 Ref<Material> ArrayMesh::surface_get_material(int p_idx) const {
 
+    _ensure_surfaces();
+
     ERR_FAIL_INDEX_V(p_idx, surfaces.size(), Ref<Material>());
     return surfaces[p_idx].material;
 }
 
 void ArrayMesh::add_surface_from_mesh_data(Geometry::MeshData &&p_mesh_data) {
 
+    _ensure_surfaces();
+
     AABB aabb;
     for (int i = 0; i < p_mesh_data.vertices.size(); i++) {
 
@@ -1032,6 +1228,10 @@ void ArrayMesh::add_surface_from_mesh_data(Geometry::MeshData &&p_mesh_data) {
 
 RID ArrayMesh::get_rid() const {
 
+    // the RID exists from the start, deferred surfaces are added to it once poll() applies the payload
+    if (!pending_surfaces.empty()) {
+        ResourcePayloadStreamer::get_singleton()->request(const_cast<ArrayMesh *>(this), true);
+    }
     return mesh;
 }
 AABB ArrayMesh::get_aabb() const {
@@ -1258,6 +1458,138 @@ Error ArrayMesh::lightmap_unwrap(const Transform &p_base_transform, float p_texe
     return OK;
 }
 
+namespace {
+
+// Moves the per vertex values of p_array to their new positions, dropping vertices mapped to -1.
+template <class T>
+void _remap_vertex_array(Vector<T> &r_array, Span<const int> p_remap, int p_new_vertex_count) {
+
+    if (r_array.empty())
+        return;
+    const size_t components = r_array.size() / p_remap.size();
+    Vector<T> remapped;
+    remapped.resize(p_new_vertex_count * components);
+    for (size_t v = 0; v < p_remap.size(); v++) {
+        if (p_remap[v] < 0)
+            continue;
+        for (size_t c = 0; c < components; c++) {
+            remapped[p_remap[v] * components + c] = r_array[v * components + c];
+        }
+    }
+    r_array = eastl::move(remapped);
+}
+
+void _remap_surface_arrays(SurfaceArrays &r_arrays, Span<const int> p_remap, int p_new_vertex_count) {
+
+    _remap_vertex_array(r_arrays.m_position_data, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_normals, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_tangents, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_colors, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_uv_1, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_uv_2, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_weights, p_remap, p_new_vertex_count);
+    _remap_vertex_array(r_arrays.m_bones, p_remap, p_new_vertex_count);
+}
+
+struct ArrayMeshOptimizedSurface {
+    SurfaceArrays arrays;
+    Vector<SurfaceArrays> blend_shapes;
+    uint32_t format;
+    String name;
+    Ref<Material> material;
+    Vector<float> lod_errors;
+    Vector<Vector<int> > lod_indices;
+};
+
+} // namespace
+
+Error ArrayMesh::optimize_surfaces(bool p_generate_lods) {
+
+    // every level aims for half the triangles of the previous one
+    const int max_lods = 8;
+    const int min_lod_triangles = 16;
+
+    Vector<ArrayMeshOptimizedSurface> optimized;
+    optimized.reserve(get_surface_count());
+
+    for (int i = 0; i < get_surface_count(); i++) {
+        ERR_FAIL_COND_V_MSG(surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES, ERR_UNAVAILABLE, "Only triangles are supported for mesh optimization.");
+        ERR_FAIL_COND_V_MSG(surfaces[i].is_2d, ERR_UNAVAILABLE, "2D meshes can't be optimized.");
+
+        ArrayMeshOptimizedSurface s;
+        s.arrays = surface_get_arrays(i);
+        s.blend_shapes = surface_get_blend_shape_arrays(i);
+        s.format = surface_get_format(i);
+        s.name = surface_get_name(i);
+        s.material = surface_get_material(i);
+
+        const int vertex_count = s.arrays.positions3().size();
+        Vector<int> &indices = s.arrays.m_indices;
+        if (indices.empty()) {
+            indices.resize(vertex_count - vertex_count % 3);
+            for (size_t j = 0; j < indices.size(); j++) {
+                indices[j] = j;
+            }
+        }
+
+        MeshOptimizer::optimize_vertex_cache(indices, vertex_count);
+        MeshOptimizer::optimize_overdraw(indices, s.arrays.positions3());
+
+        Vector<int> remap;
+        int new_vertex_count = MeshOptimizer::optimize_vertex_fetch(indices, vertex_count, remap);
+        _remap_surface_arrays(s.arrays, remap, new_vertex_count);
+        for (SurfaceArrays &shape : s.blend_shapes) {
+            shape.m_indices.clear(); // blend shapes share the surface indices
+            _remap_surface_arrays(shape, remap, new_vertex_count);
+        }
+
+        if (p_generate_lods) {
+            Span<const Vector3> positions = s.arrays.positions3();
+            const float max_error = surfaces[i].aabb.get_longest_axis_size();
+            size_t previous_count = indices.size();
+            float previous_error = 0;
+            int target = indices.size();
+            for (int l = 0; l < max_lods; l++) {
+                target /= 2;
+                target -= target % 3;
+                if (target < min_lod_triangles * 3)
+                    break;
+
+                float error;
+                Vector<int> lod = MeshOptimizer::simplify(indices, positions, target, max_error, &error);
+                if (lod.size() * 10 > previous_count * 9)
+                    break; // simplification got stuck on locked borders or the error limit
+                MeshOptimizer::optimize_vertex_cache(lod, new_vertex_count);
+
+                previous_count = lod.size();
+                previous_error = M_MAX(previous_error, error);
+                s.lod_errors.push_back(previous_error);
+                s.lod_indices.emplace_back(eastl::move(lod));
+            }
+        }
+
+        optimized.emplace_back(eastl::move(s));
+    }
+
+    while (get_surface_count()) {
+        surface_remove(0);
+    }
+
+    for (ArrayMeshOptimizedSurface &s : optimized) {
+        int idx = get_surface_count();
+        add_surface_from_arrays(PRIMITIVE_TRIANGLES, eastl::move(s.arrays), eastl::move(s.blend_shapes), s.format & ~((1 << ARRAY_COMPRESS_BASE) - 1));
+        surface_set_name(idx, s.name);
+        if (s.material) {
+            surface_set_material(idx, s.material);
+        }
+        if (!s.lod_errors.empty()) {
+            surface_set_lods(idx, s.lod_errors, s.lod_indices);
+        }
+    }
+
+    return OK;
+}
+
 void ArrayMesh::_bind_methods() {
 
     MethodBinder::bind_method(D_METHOD("add_blend_shape", {"name"}), &ArrayMesh::add_blend_shape);
@@ -1282,6 +1614,8 @@ void ArrayMesh::_bind_methods() {
     MethodBinder::bind_method(D_METHOD("create_outline", {"margin"}), &ArrayMesh::create_outline);
     MethodBinder::bind_method(D_METHOD("regen_normalmaps"), &ArrayMesh::regen_normalmaps,METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
     MethodBinder::bind_method(D_METHOD("lightmap_unwrap", {"transform", "texel_size"}), &ArrayMesh::lightmap_unwrap,METHOD_FLAGS_DEFAULT | METHOD_FLAG_EDITOR);
+    MethodBinder::bind_method(D_METHOD("optimize_surfaces", {"generate_lods"}), &ArrayMesh::optimize_surfaces, {DEFVAL(true)});
+    MethodBinder::bind_method(D_METHOD("surface_get_lod_count", {"surf_idx"}), &ArrayMesh::surface_get_lod_count);
     MethodBinder::bind_method(D_METHOD("get_faces"), &ArrayMesh::get_faces);
     MethodBinder::bind_method(D_METHOD("generate_triangle_mesh"), &ArrayMesh::generate_triangle_mesh);
 
@@ -1293,6 +1627,8 @@ void ArrayMesh::_bind_methods() {
 }
 
 void ArrayMesh::reload_from_file() {
+    _payload_release();
+    pending_surfaces.clear();
     RenderingServer::get_singleton()->mesh_clear(mesh);
     surfaces.clear();
     clear_blend_shapes();
@@ -1311,5 +1647,6 @@ ArrayMesh::ArrayMesh() {
 
 ArrayMesh::~ArrayMesh() {
 
+    _payload_release();
     RenderingServer::get_singleton()->free_rid(mesh);
 }
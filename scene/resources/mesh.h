@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "core/io/resource_payload_streamer.h"
 #include "core/math/geometry.h"
 #include "core/math/face3.h"
 #include "core/math/triangle_mesh.h"
@@ -162,7 +163,7 @@ public:
     Mesh();
 };
 
-class GODOT_EXPORT ArrayMesh : public Mesh {
+class GODOT_EXPORT ArrayMesh : public Mesh, public StreamedPayloadOwner {
 
     GDCLASS(ArrayMesh,Mesh)
 
@@ -181,8 +182,14 @@ private:
     BlendShapeMode blend_shape_mode;
     Vector<StringName> blend_shapes;
     AABB custom_aabb;
+    // surfaces whose data the loader left on disk, created in order once it is read
+    Vector<Dictionary> pending_surfaces;
+    Vector<Dictionary> staged_surfaces;
+    uint64_t staged_size = 0;
 
     void _recompute_aabb();
+    bool _create_surface(int idx, const Dictionary &d);
+    void _ensure_surfaces() const;
 
 protected:
     virtual bool _is_generated() const { return false; }
@@ -192,7 +199,12 @@ protected:
     void _get_property_list(Vector<PropertyInfo> *p_list) const;
 
     static void _bind_methods();
+
+    Error _payload_read() override;
+    uint64_t _payload_apply() override;
 public:
+    bool _set_streamed_property(const StringName &p_name, const Variant &p_value) override;
+
     // Accessed from scripting glue
     void _add_surface_from_arrays(PrimitiveType p_primitive, const Array &p_arrays, const Array &p_blend_shapes = Array(), uint32_t p_flags = ARRAY_COMPRESS_DEFAULT);
 public:
@@ -217,10 +229,16 @@ public:
     void surface_update_region(int p_surface, int p_offset, const PoolVector<uint8_t> &p_data);
 
     int get_surface_count() const override;
+    //! True while surfaces counted by get_surface_count() wait for the payload streamer, the RID doesn't have them yet.
+    bool has_pending_surfaces() const { return !pending_surfaces.empty(); }
     void surface_remove(int p_idx);
 
     void surface_set_custom_aabb(int p_idx, const AABB &p_aabb); //only recognized by driver
 
+    //! Levels of detail go from finest to coarsest, p_lod_errors are their object space deviations.
+    void surface_set_lods(int p_idx, Span<const float> p_lod_errors, const Vector<Vector<int>> &p_lod_indices);
+    int surface_get_lod_count(int p_idx) const;
+
     int surface_get_array_len(int p_idx) const override;
     int surface_get_array_index_len(int p_idx) const override;
     uint32_t surface_get_format(int p_idx) const override;
@@ -245,6 +263,8 @@ public:
     void regen_normalmaps();
 
     Error lightmap_unwrap(const Transform &p_base_transform = Transform(), float p_texel_size = 0.05f);
+    //! Reorders triangles and vertices of all surfaces for the GPU caches, optionally generating simplified LODs.
+    Error optimize_surfaces(bool p_generate_lods = true);
 
     void reload_from_file() override;
 
@@ -43,6 +43,7 @@
 #include "scene/gui/control.h"
 #include "scene/main/instance_placeholder.h"
 #include "core/method_bind.h"
+#include "core/object_tooling.h"
 #include "core/resource/resource_manager.h"
 
 #include "EASTL/sort.h"
@@ -108,11 +109,91 @@ IMPL_GDCLASS(PackedScene)
 RES_BASE_EXTENSION_IMPL(PackedScene,"scn")
 VARIANT_ENUM_CAST(PackedGenEditState)
 
+/**
+ * Per node and property results of the lookups instance() needs, they only depend on the state, so they are made
+ * once instead of for every instance. Laid out parallel to nodes, NodeData::properties and connections.
+ */
+struct SceneState::InstancePlan {
+    struct Property {
+        // native setter, used while the node has no script instance; nullptr when only Object::set can handle it
+        const ClassDB::PropertySetGet *setget = nullptr;
+        bool is_script = false;
+        bool is_object = false; // may be a resource that is local to scene
+    };
+    struct NodeData {
+        Object *(*create)() = nullptr; // nullptr when the node is not made from its type alone
+        int first_property = 0;
+    };
+
+    Vector<NodeData> nodes;
+    Vector<Property> properties;
+    Vector<Vector<Variant>> connection_binds;
+};
+
+const SceneState::InstancePlan &SceneState::_get_instance_plan() const {
+
+    MutexLock lock(instance_plan_mutex);
+    if (instance_plan)
+        return *instance_plan;
+
+    InstancePlan *plan = memnew(InstancePlan);
+    plan->nodes.reserve(nodes.size());
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const NodeData &n = nodes[i];
+        InstancePlan::NodeData planned;
+        planned.first_property = plan->properties.size();
+
+        StringName type;
+        const bool inherited_root = i == 0 && base_scene_idx >= 0;
+        if (!inherited_root && n.instance < 0 && n.type != TYPE_INSTANCED && n.type >= 0 && n.type < int(names.size())) {
+            type = names[n.type];
+            if (ClassDB::class_exists(type) && ClassDB::is_parent_class(type, "Node")) {
+                planned.create = ClassDB::get_creation_func(type);
+            }
+        }
+
+        for (const NodeData::Property &property : n.properties) {
+            InstancePlan::Property planned_property;
+            if (property.name >= 0 && property.name < int(names.size())) {
+                planned_property.is_script = names[property.name] == CoreStringNames::get_singleton()->_script;
+                if (planned.create && !planned_property.is_script) {
+                    planned_property.setget = ClassDB::get_property_setget(type, names[property.name]);
+                }
+            }
+            if (property.value >= 0 && property.value < int(variants.size())) {
+                planned_property.is_object = variants[property.value].get_type() == VariantType::OBJECT;
+            }
+            plan->properties.push_back(planned_property);
+        }
+        plan->nodes.push_back(planned);
+    }
+
+    plan->connection_binds.resize(connections.size());
+    for (size_t i = 0; i < connections.size(); i++) {
+        for (int b : connections[i].bind_indices) {
+            plan->connection_binds[i].emplace_back(variants[b]);
+        }
+    }
+
+    instance_plan = plan;
+    return *plan;
+}
+
+void SceneState::_clear_instance_plan() {
+
+    MutexLock lock(instance_plan_mutex);
+    if (instance_plan) {
+        memdelete(instance_plan);
+        instance_plan = nullptr;
+    }
+}
+
 bool SceneState::can_instance() const {
 
     return !nodes.empty();
 }
-bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Span<Node *> ret_nodes, const SceneState::NodeData &n, Map<Ref<Resource>, Ref<Resource> > & resources_local_to_scene) const {
+bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Span<Node *> ret_nodes, const SceneState::NodeData &n, const InstancePlan &plan, Map<Ref<Resource>, Ref<Resource> > & resources_local_to_scene) const {
     int nprop_count = n.properties.size();
     if (!nprop_count)
         return true;
@@ -123,14 +204,17 @@ bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Sp
     if (prop_count)
         props = &variants[0];
     int i = eastl::distance(nodes.data(),&n); // find out which not are we on
+    const InstancePlan::Property *planned_properties = &plan.properties[plan.nodes[i].first_property];
 
-    for (const auto &property : n.properties) {
+    for (int p = 0; p < nprop_count; p++) {
+        const NodeData::Property &property = n.properties[p];
+        const InstancePlan::Property &planned = planned_properties[p];
 
         bool valid;
         ERR_FAIL_INDEX_V(property.name, sname_count, false);
         ERR_FAIL_INDEX_V(property.value, prop_count, false);
 
-        if (names[property.name] == CoreStringNames::get_singleton()->_script) {
+        if (planned.is_script) {
             //work around to avoid old script variables from disappearing, should be the proper fix to:
             //https://github.com/godotengine/godot/issues/2958
 
@@ -148,16 +232,19 @@ bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Sp
             }
             continue;
         }
-        Variant value = props[property.value];
+        // the stored value is used in place unless this instance needs its own copy
+        const Variant *value = &props[property.value];
+        Variant local_value;
 
-        if (value.get_type() == VariantType::OBJECT) {
+        if (planned.is_object) {
             //handle resources that are local to scene by duplicating them if needed
-            Ref<Resource> res(value);
+            Ref<Resource> res(*value);
             if (res && res->is_local_to_scene()) {
                 Map<Ref<Resource>, Ref<Resource> >::const_iterator E = resources_local_to_scene.find(res);
 
                 if (E != resources_local_to_scene.end()) {
-                    value = E->second;
+                    local_value = E->second;
+                    value = &local_value;
                 }
                 else {
 
@@ -175,43 +262,67 @@ bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Sp
                         Ref<Resource> local_dupe = res->duplicate_for_local_scene(base2, resources_local_to_scene);
                         resources_local_to_scene[res] = local_dupe;
                         res = local_dupe;
-                        value = local_dupe;
+                        local_value = local_dupe;
+                        value = &local_value;
                     }
                 }
                 //must make a copy, because this res is local to scene
             }
         }
         else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
-            value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
+            local_value = value->duplicate(true); // Duplicate arrays and dictionaries for the editor
+            value = &local_value;
+        }
+
+        if (planned.setget && !node->get_script_instance()) {
+            // what Object::set ends up doing for native properties, minus the lookups
+            Object_set_edited(node, true, false);
+            ClassDB::set_property_direct(node, *planned.setget, *value, &valid);
+        } else {
+            node->set(names[property.name], *value, &valid);
         }
-        node->set(names[property.name], value, &valid);
     }
     return true;
 }
 
-void SceneState::handleConnections(int nc, Span<Node*> ret_nodes) const {
+void SceneState::handleConnections(int nc, Span<Node*> ret_nodes, const InstancePlan &plan) const {
 
-    for (const ConnectionData& c : connections) {
+    for (size_t i = 0; i < connections.size(); i++) {
+        const ConnectionData &c = connections[i];
         Node* cfrom = nodeFromId(node_paths, ret_nodes, nc, c.from);
         Node* cto = nodeFromId(node_paths, ret_nodes, nc, c.to);
 
         if (!cfrom || !cto)
             continue;
 
-        Vector<Variant> binds;
-        if (!c.bind_indices.empty()) {
-            binds.reserve(c.bind_indices.size());
-            for (int b : c.bind_indices)
-                binds.emplace_back(variants[b]);
-        }
-
-        cfrom->connect(names[c.signal], Callable(cto, names[c.method]), binds, ObjectNS::CONNECT_PERSIST | c.flags);
+        cfrom->connect(names[c.signal], Callable(cto, names[c.method]), plan.connection_binds[i], ObjectNS::CONNECT_PERSIST | c.flags);
 
     }
 }
 
 Node *SceneState::instance(PackedGenEditState p_edit_state) const {
 
+    ERR_FAIL_COND_V(nodes.empty(), nullptr);
+    return _instance(p_edit_state, _get_instance_plan());
+}
+
+void SceneState::instance_many(int p_count, PackedGenEditState p_edit_state, Vector<Node *> &r_nodes) const {
+
+    ERR_FAIL_COND(nodes.empty());
+    ERR_FAIL_COND(p_count < 0);
+
+    const InstancePlan &plan = _get_instance_plan();
+    r_nodes.reserve(r_nodes.size() + p_count);
+    for (int i = 0; i < p_count; i++) {
+        Node *node = _instance(p_edit_state, plan);
+        ERR_FAIL_COND(!node);
+        r_nodes.push_back(node);
+    }
+}
+
+Node *SceneState::_instance(PackedGenEditState p_edit_state, const InstancePlan &plan) const {
+
+    MemoryTagScope mem_tag(MEM_TAG_SCENE);
     // nodes where instancing failed (because something is missing)
     Vector<Node *> stray_instances;
 
@@ -294,6 +405,9 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
                 }
 #endif
             }
+        } else if (plan.nodes[node_data_idx].create) {
+            // same as below, with the class looked up already
+            node = static_cast<Node *>(plan.nodes[node_data_idx].create());
         } else if (ClassDB::is_class_enabled(snames[n.type])) {
             //node belongs to this scene and must be created
             Object *obj = ClassDB::instance(snames[n.type]);
@@ -330,7 +444,7 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
             // if found all is good, otherwise ignore
 
             //properties
-            if(not handleProperties(p_edit_state,node,ret_nodes,n,resources_local_to_scene))
+            if(not handleProperties(p_edit_state,node,ret_nodes,n,plan,resources_local_to_scene))
                 return nullptr;
 
             //name
@@ -386,7 +500,7 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
 
     //do connections
 
-    handleConnections(nc, ret_nodes);
+    handleConnections(nc, ret_nodes, plan);
 
     //Node *s = ret_nodes[0];
 
@@ -940,6 +1054,7 @@ const String &SceneState::get_path() const {
 
 void SceneState::clear() {
 
+    _clear_instance_plan();
     names.clear();
     variants.clear();
     nodes.clear();
@@ -1114,6 +1229,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 
     ERR_FAIL_COND_MSG(version > PACKED_SCENE_VERSION, "Save format version too new.");
 
+    _clear_instance_plan();
+
     const int node_count = p_dictionary["node_count"].as<int>();
     const PoolVector<int> snodes = p_dictionary["nodes"].as<PoolVector<int>>();
     ERR_FAIL_COND(snodes.size() < node_count);
@@ -1577,6 +1694,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
     nd.instance = p_instance;
     nd.index = p_index;
 
+    _clear_instance_plan();
     nodes.push_back(nd);
 
     return nodes.size() - 1;
@@ -1588,6 +1706,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
     ERR_FAIL_INDEX(p_value, variants.size());
 
     NodeData::Property prop { p_name,p_value };
+    _clear_instance_plan();
     nodes[p_node].properties.emplace_back(prop);
 }
 void SceneState::add_node_group(int p_node, int p_group) {
@@ -1599,6 +1718,7 @@ void SceneState::add_node_group(int p_node, int p_group) {
 void SceneState::set_base_scene(int p_idx) {
 
     ERR_FAIL_INDEX(p_idx, variants.size());
+    _clear_instance_plan();
     base_scene_idx = p_idx;
 }
 void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags, Vector<int> &&p_binds) {
@@ -1616,6 +1736,7 @@ void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method
     c.method = p_method;
     c.flags = p_flags;
     c.bind_indices = eastl::move(p_binds);
+    _clear_instance_plan();
     connections.emplace_back(c);
 }
 void SceneState::add_editable_instance(const NodePath &p_path) {
@@ -1667,6 +1788,11 @@ SceneState::SceneState() {
     last_modified_time = 0;
 }
 
+SceneState::~SceneState() {
+
+    _clear_instance_plan();
+}
+
 ////////////////
 
 void PackedScene::_set_bundled_scene(const Dictionary &p_scene) {
@@ -1716,6 +1842,39 @@ Node *PackedScene::instance(PackedGenEditState p_edit_state) const {
     return s;
 }
 
+Vector<Node *> PackedScene::instance_many(int p_count, PackedGenEditState p_edit_state) const {
+
+    Vector<Node *> nodes;
+#ifndef TOOLS_ENABLED
+    ERR_FAIL_COND_V_MSG(p_edit_state != GEN_EDIT_STATE_DISABLED, nodes, "Edit state is only for editors, does not work without tools compiled.");
+#endif
+
+    state->instance_many(p_count, p_edit_state, nodes);
+
+    const String &path = get_path();
+    const bool set_filename = !path.empty() && !StringUtils::contains(path, "::");
+    for (Node *s : nodes) {
+        if (p_edit_state != GEN_EDIT_STATE_DISABLED) {
+            s->set_scene_instance_state(state);
+        }
+        if (set_filename)
+            s->set_filename(path);
+
+        s->notification(Node::NOTIFICATION_INSTANCED);
+    }
+
+    return nodes;
+}
+
+Array PackedScene::_instance_many(int p_count, PackedGenEditState p_edit_state) const {
+
+    Array ret;
+    for (Node *s : instance_many(p_count, p_edit_state)) {
+        ret.push_back(Variant(s));
+    }
+    return ret;
+}
+
 void PackedScene::replace_state(Ref<SceneState> p_by) {
 
     state = eastl::move(p_by);
@@ -1744,6 +1903,7 @@ void PackedScene::_bind_methods() {
 
     MethodBinder::bind_method(D_METHOD("pack", {"path"}), &PackedScene::pack);
     MethodBinder::bind_method(D_METHOD("instance", {"edit_state"}), &PackedScene::instance, {DEFVAL(GEN_EDIT_STATE_DISABLED)});
+    MethodBinder::bind_method(D_METHOD("instance_many", {"count", "edit_state"}), &PackedScene::_instance_many, {DEFVAL(GEN_EDIT_STATE_DISABLED)});
     MethodBinder::bind_method(D_METHOD("can_instance"), &PackedScene::can_instance);
     MethodBinder::bind_method(D_METHOD("_set_bundled_scene"), &PackedScene::_set_bundled_scene);
     MethodBinder::bind_method(D_METHOD("_get_bundled_scene"), &PackedScene::_get_bundled_scene);
@@ -34,6 +34,7 @@
 #include "core/string.h"
 #include "core/map.h"
 #include "core/hash_map.h"
+#include "core/os/mutex.h"
 #include "scene/main/node.h"
 
 class PackedScene;
@@ -99,6 +100,15 @@ class GODOT_EXPORT SceneState : public RefCounted {
 
     Vector<ConnectionData> connections;
 
+    // what instance() resolves by name, built on first use and dropped when the state changes
+    struct InstancePlan;
+    mutable InstancePlan *instance_plan = nullptr;
+    mutable Mutex instance_plan_mutex;
+
+    const InstancePlan &_get_instance_plan() const;
+    void _clear_instance_plan();
+    Node *_instance(PackedGenEditState p_edit_state, const InstancePlan &p_plan) const;
+
     Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, Hasher<Variant>, VariantComparator> &variant_map, HashMap<Node *, int> &node_map, HashMap<Node *, int> &nodepath_map);
     Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, Hasher<Variant>, VariantComparator> &variant_map, HashMap<Node *, int> &node_map, HashMap<Node *, int> &nodepath_map);
 
@@ -123,8 +133,8 @@ public:
 
 protected:
     static void _bind_methods();
-    bool handleProperties(PackedGenEditState p_edit_state, Node* node, Span<Node*> ret_nodes,const NodeData& n, Map<Ref<Resource>, Ref<Resource> >& resources_local_to_scene) const;
-    void handleConnections(int nc, Span<Node*> ret_nodes) const;
+    bool handleProperties(PackedGenEditState p_edit_state, Node* node, Span<Node*> ret_nodes,const NodeData& n, const InstancePlan &plan, Map<Ref<Resource>, Ref<Resource> >& resources_local_to_scene) const;
+    void handleConnections(int nc, Span<Node*> ret_nodes, const InstancePlan &plan) const;
 
 public:
 
@@ -148,6 +158,8 @@ public:
 
     bool can_instance() const;
     Node *instance(PackedGenEditState p_edit_state) const;
+    //! Same as calling instance() p_count times, appends the root nodes to r_nodes.
+    void instance_many(int p_count, PackedGenEditState p_edit_state, Vector<Node *> &r_nodes) const;
 
     //unbuild API
 
@@ -195,6 +207,7 @@ public:
     uint64_t get_last_modified_time() const { return last_modified_time; }
 
     SceneState();
+    ~SceneState() override;
 };
 
 
@@ -208,6 +221,7 @@ class GODOT_EXPORT PackedScene : public Resource {
 public:
     void _set_bundled_scene(const Dictionary &p_scene);
     Dictionary _get_bundled_scene() const;
+    Array _instance_many(int p_count, PackedGenEditState p_edit_state) const;
 
 protected:
     bool editor_can_reload_from_file() override { return false; } // this is handled by editor better
@@ -222,6 +236,8 @@ public:
 
     bool can_instance() const;
     Node *instance(PackedGenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
+    //! Instances the scene p_count times, cheaper than separate instance() calls when spawning in bulk.
+    Vector<Node *> instance_many(int p_count, PackedGenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
 
     void recreate_state();
     void replace_state(Ref<SceneState> p_by);
@@ -786,7 +786,7 @@ Error ResourceInteractiveLoaderText::rename_dependencies(FileAccess *p_f, String
 
     StringView base_path = PathUtils::get_base_dir(local_path);
 
-    uint64_t tag_end = f->get_position();
+    uint64_t tag_end = stream->get_position();
 
     while (true) {
 
@@ -848,7 +848,7 @@ Error ResourceInteractiveLoaderText::rename_dependencies(FileAccess *p_f, String
 
             fw->store_line("[ext_resource path=\"" + path + "\" type=\"" + type + "\" id=" + itos(index) + "]");
 
-            tag_end = f->get_position();
+            tag_end = stream->get_position();
         }
     }
 
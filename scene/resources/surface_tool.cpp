@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "surface_tool.h"
+#include "core/math/mesh_optimizer.h"
 #include "core/method_bind.h"
 #include "scene/resources/material.h"
 #include "scene/resources/mesh_enum_casters.h"
@@ -492,6 +493,32 @@ void SurfaceTool::deindex() {
     index_array.clear();
 }
 
+void SurfaceTool::optimize() {
+
+    ERR_FAIL_COND_MSG(primitive != Mesh::PRIMITIVE_TRIANGLES, "Only triangles can be optimized.");
+    ERR_FAIL_COND_MSG(index_array.empty(), "Call index() before optimize().");
+
+    Vector<Vector3> positions;
+    positions.reserve(vertex_array.size());
+    for (const Vertex &v : vertex_array) {
+        positions.push_back(v.vertex);
+    }
+
+    MeshOptimizer::optimize_vertex_cache(index_array, vertex_array.size());
+    MeshOptimizer::optimize_overdraw(index_array, positions);
+
+    Vector<int> remap;
+    int vertex_count = MeshOptimizer::optimize_vertex_fetch(index_array, vertex_array.size(), remap);
+    Vector<Vertex> new_vertices;
+    new_vertices.resize(vertex_count);
+    for (size_t i = 0; i < remap.size(); i++) {
+        if (remap[i] >= 0) {
+            new_vertices[remap[i]] = eastl::move(vertex_array[i]);
+        }
+    }
+    vertex_array = eastl::move(new_vertices);
+}
+
 void SurfaceTool::_create_list(const Ref<Mesh> &p_existing, int p_surface, Vector<Vertex> *r_vertex, Vector<int> *r_index, int &lformat) {
 
     SurfaceArrays arr = p_existing->surface_get_arrays(p_surface);
@@ -961,6 +988,7 @@ void SurfaceTool::_bind_methods() {
 
     MethodBinder::bind_method(D_METHOD("index"), &SurfaceTool::index);
     MethodBinder::bind_method(D_METHOD("deindex"), &SurfaceTool::deindex);
+    MethodBinder::bind_method(D_METHOD("optimize"), &SurfaceTool::optimize);
     MethodBinder::bind_method(D_METHOD("generate_normals", {"flip"}), &SurfaceTool::generate_normals, {DEFVAL(false)});
     MethodBinder::bind_method(D_METHOD("generate_tangents"), &SurfaceTool::generate_tangents);
 
@@ -121,6 +121,7 @@ public:
 
     void index();
     void deindex();
+    void optimize();
     void generate_normals(bool p_flip = false);
     void generate_tangents();
 
@@ -37,6 +37,7 @@
 
 #include "core/callable_method_pointer.h"
 #include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/image_enum_casters.h"
 #include "core/io/image_loader.h"
 #include "core/io/image_saver.h"
@@ -46,10 +47,14 @@
 #include "core/object_tooling.h"
 #include "core/os/os.h"
 #include "core/plugin_interfaces/ImageLoaderInterface.h"
+#include "core/project_settings.h"
 #include "core/resource/resource_manager.h"
 #include "scene/resources/bit_map.h"
 #include "scene/resources/mesh.h"
 #include "servers/rendering_server.h"
+#include "servers/rendering/texture_streaming.h"
+
+#include <atomic>
 
 IMPL_GDCLASS(Texture)
 IMPL_GDCLASS(ImageTexture)
@@ -520,10 +525,36 @@ struct StreamTexture::StreamTextureData {
     RID texture;
     Image::Format format;
     uint32_t flags;
+    uint32_t data_format = 0;
     int w, h;
+    int w_custom = 0, h_custom = 0;
     mutable eastl::unique_ptr<BitMap> alpha_cache;
+    // set while the image is still in the file, requested once on first use
+    std::atomic<bool> data_pending { false };
+    mutable std::atomic<bool> data_requested { false };
+    Ref<Image> staged_image;
+    // mips are read by the rendering server, which only keeps the visible ones
+    bool mips_streamed = false;
 };
 
+static bool _read_stex_header(FileAccess *f, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, uint32_t &r_data_format) {
+
+    uint8_t header[4];
+    f->get_buffer(header, 4);
+    if (header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T') {
+        return false;
+    }
+
+    tw = f->get_16();
+    tw_custom = f->get_16();
+    th = f->get_16();
+    th_custom = f->get_16();
+
+    flags = f->get_32(); //texture flags!
+    r_data_format = f->get_32(); //data format
+    return true;
+}
+
 void StreamTexture::set_path(StringView p_path, bool p_take_over) {
 
     if (m_impl_data->texture.is_valid()) {
@@ -570,62 +601,19 @@ Image::Format StreamTexture::get_format() const {
     return m_impl_data->format;
 }
 
-Error StreamTexture::_load_data(StringView p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit) {
-
-    m_impl_data->alpha_cache.reset(nullptr); // TODO: memory de-allocation, check if actually needed ?
+Error StreamTexture::_load_data(StringView p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, uint32_t &r_data_format, Ref<Image> &image, int p_size_limit) {
 
     ERR_FAIL_COND_V(not image, ERR_INVALID_PARAMETER);
 
     FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
     ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
 
-    uint8_t header[4];
-    f->get_buffer(header, 4);
-    if (header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T') {
+    if (!_read_stex_header(f, tw, th, tw_custom, th_custom, flags, r_data_format)) {
         memdelete(f);
-        ERR_FAIL_COND_V(header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T', ERR_FILE_CORRUPT);
+        ERR_FAIL_V(ERR_FILE_CORRUPT);
     }
+    uint32_t df = r_data_format;
 
-    tw = f->get_16();
-    tw_custom = f->get_16();
-    th = f->get_16();
-    th_custom = f->get_16();
-
-    flags = f->get_32(); //texture flags!
-    uint32_t df = f->get_32(); //data format
-
-    /*
-    print_line("width: " + itos(tw));
-    print_line("height: " + itos(th));
-    print_line("flags: " + itos(flags));
-    print_line("df: " + itos(df));
-    */
-#ifdef TOOLS_ENABLED
-    RID texture = m_impl_data->texture;
-    if (request_3d_callback && df & FORMAT_BIT_DETECT_3D) {
-        //print_line("request detect 3D at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_3d_callback(texture, _requested_3d, this);
-    } else {
-        //print_line("not requesting detect 3D at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_3d_callback(texture, nullptr, nullptr);
-    }
-
-    if (request_srgb_callback && df & FORMAT_BIT_DETECT_SRGB) {
-        //print_line("request detect srgb at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_srgb_callback(texture, _requested_srgb, this);
-    } else {
-        //print_line("not requesting detect srgb at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_srgb_callback(texture, nullptr, nullptr);
-    }
-
-    if (request_srgb_callback && df & FORMAT_BIT_DETECT_NORMAL) {
-        //print_line("request detect srgb at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_normal_callback(texture, _requested_normal, this);
-    } else {
-        //print_line("not requesting detect normal at " + p_path);
-        RenderingServer::get_singleton()->texture_set_detect_normal_callback(texture, nullptr, nullptr);
-    }
-#endif
     if (!(df & FORMAT_BIT_STREAM)) {
         p_size_limit = 0;
     }
@@ -788,36 +776,162 @@ Error StreamTexture::_load_data(StringView p_path, int &tw, int &th, int &tw_cus
     return ERR_BUG; //unreachable
 }
 
-Error StreamTexture::load(StringView p_path) {
+Error StreamTexture::_load(StringView p_path, bool p_lazy) {
+
+    _payload_release();
+    m_impl_data->alpha_cache.reset(nullptr);
 
     int lw, lh, lwc, lhc, lflags;
-    Ref<Image> image(make_ref_counted<Image>());
-    Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, image);
-    if (err)
-        return err;
+    uint32_t df;
+    Ref<Image> image;
+    StexMipLayout mip_layout;
+    bool stream_mips = false;
+    // the editor needs every texture complete, for thumbnails and reimports
+    const bool can_stream = !Engine::get_singleton()->is_editor_hint() && GLOBAL_GET("rendering/misc/texture_streaming/enabled").as<bool>();
+
+    if (p_lazy || can_stream) {
+        FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+        ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
+        ERR_FAIL_COND_V(!_read_stex_header(f, lw, lh, lwc, lhc, lflags, df), ERR_FILE_CORRUPT);
+        if (can_stream && df & FORMAT_BIT_STREAM) {
+            f->seek(0);
+            stream_mips = mip_layout.parse(f) == OK;
+        }
+        // small textures are cheaper to load right away than to track
+        p_lazy = p_lazy && !stream_mips && f->get_len() >= ResourcePayloadStreamer::get_singleton()->get_lazy_min_size();
+    }
+    if (!p_lazy && !stream_mips) {
+        image = make_ref_counted<Image>();
+        Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, df, image);
+        if (err)
+            return err;
+    }
     RID texture = m_impl_data->texture;
 
     if (get_path().empty()) {
         //temporarily set path if no path set for resource, helps find errors
         RenderingServer::get_singleton()->texture_set_path(texture, p_path);
     }
-    RenderingServer::get_singleton()->texture_allocate(texture, image->get_width(), image->get_height(), 0, image->get_format(), RS::TEXTURE_TYPE_2D, lflags);
-    RenderingServer::get_singleton()->texture_set_data(texture, image);
-    if (lwc || lhc) {
-        RenderingServer::get_singleton()->texture_set_size_override(texture, lwc, lhc, 0);
-    } else {
-    }
 
     m_impl_data->w = lwc ? lwc : lw;
     m_impl_data->h = lhc ? lhc : lh;
+    m_impl_data->w_custom = lwc;
+    m_impl_data->h_custom = lhc;
     m_impl_data->flags = lflags;
+    m_impl_data->data_format = df;
     m_impl_data->path_to_file = p_path;
-    m_impl_data->format = image->get_format();
+    m_impl_data->mips_streamed = stream_mips;
+
+    if (stream_mips) {
+        m_impl_data->data_pending = false;
+        m_impl_data->format = mip_layout.format;
+        RenderingServer::get_singleton()->texture_allocate(texture, mip_layout.width, mip_layout.height, 0, mip_layout.format, RS::TEXTURE_TYPE_2D, lflags);
+        RenderingServer::get_singleton()->texture_set_mip_streaming(texture, p_path);
+        _setup_texture();
+    } else if (p_lazy) {
+        // compressed images only know their format once decoded
+        bool compressed = df & (FORMAT_BIT_LOSSLESS | FORMAT_BIT_LOSSY);
+        m_impl_data->format = compressed ? Image::FORMAT_MAX : Image::Format(df & FORMAT_MASK_IMAGE_FORMAT);
+        m_impl_data->data_requested = false;
+        m_impl_data->data_pending = true;
+        // a complete 1x1 stand-in, reporting the real size so canvas UVs and pixel sizes are right meanwhile
+        Ref<Image> placeholder(make_ref_counted<Image>(1, 1, false, Image::FORMAT_RGBA8));
+        RenderingServer::get_singleton()->texture_allocate(texture, 1, 1, 0, Image::FORMAT_RGBA8, RS::TEXTURE_TYPE_2D, lflags);
+        RenderingServer::get_singleton()->texture_set_data(texture, placeholder);
+        RenderingServer::get_singleton()->texture_set_size_override(texture, m_impl_data->w, m_impl_data->h, 0);
+        _payload_defer();
+    } else {
+        m_impl_data->data_pending = false;
+        _upload(image);
+    }
 
     Object_change_notify(this);
     emit_changed();
     return OK;
 }
+
+void StreamTexture::_upload(const Ref<Image> &p_image) {
+
+    RID texture = m_impl_data->texture;
+
+    RenderingServer::get_singleton()->texture_allocate(texture, p_image->get_width(), p_image->get_height(), 0, p_image->get_format(), RS::TEXTURE_TYPE_2D, m_impl_data->flags);
+    RenderingServer::get_singleton()->texture_set_data(texture, p_image);
+    m_impl_data->format = p_image->get_format();
+    _setup_texture();
+}
+
+void StreamTexture::_setup_texture() {
+
+    RID texture = m_impl_data->texture;
+
+    if (m_impl_data->w_custom || m_impl_data->h_custom) {
+        RenderingServer::get_singleton()->texture_set_size_override(texture, m_impl_data->w_custom, m_impl_data->h_custom, 0);
+    }
+
+#ifdef TOOLS_ENABLED
+    uint32_t df = m_impl_data->data_format;
+    if (request_3d_callback && df & FORMAT_BIT_DETECT_3D) {
+        //print_line("request detect 3D at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_3d_callback(texture, _requested_3d, this);
+    } else {
+        //print_line("not requesting detect 3D at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_3d_callback(texture, nullptr, nullptr);
+    }
+
+    if (request_srgb_callback && df & FORMAT_BIT_DETECT_SRGB) {
+        //print_line("request detect srgb at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_srgb_callback(texture, _requested_srgb, this);
+    } else {
+        //print_line("not requesting detect srgb at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_srgb_callback(texture, nullptr, nullptr);
+    }
+
+    if (request_srgb_callback && df & FORMAT_BIT_DETECT_NORMAL) {
+        //print_line("request detect srgb at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_normal_callback(texture, _requested_normal, this);
+    } else {
+        //print_line("not requesting detect normal at " + p_path);
+        RenderingServer::get_singleton()->texture_set_detect_normal_callback(texture, nullptr, nullptr);
+    }
+#endif
+}
+
+void StreamTexture::_request_data() const {
+
+    if (m_impl_data->data_pending && !m_impl_data->data_requested.exchange(true)) {
+        ResourcePayloadStreamer::get_singleton()->request(const_cast<StreamTexture *>(this), true);
+    }
+}
+
+Error StreamTexture::_payload_read() {
+
+    int lw, lh, lwc, lhc, lflags;
+    uint32_t df;
+    Ref<Image> image(make_ref_counted<Image>());
+    Error err = _load_data(m_impl_data->path_to_file, lw, lh, lwc, lhc, lflags, df, image);
+    if (err != OK)
+        return err;
+    m_impl_data->staged_image = image;
+    return OK;
+}
+
+uint64_t StreamTexture::_payload_apply() {
+
+    Ref<Image> image = eastl::move(m_impl_data->staged_image);
+    m_impl_data->staged_image.unref();
+    _upload(image);
+    m_impl_data->data_pending = false;
+
+    Object_change_notify(this);
+    emit_changed();
+    return image->get_data().size();
+}
+
+Error StreamTexture::load(StringView p_path) {
+
+    return _load(p_path, false);
+}
+
 String StreamTexture::get_load_path() const {
 
     return m_impl_data->path_to_file;
@@ -833,11 +947,13 @@ int StreamTexture::get_height() const {
 }
 RID StreamTexture::get_rid() const {
 
+    _request_data();
     return m_impl_data->texture;
 }
 
 void StreamTexture::draw(RID p_canvas_item, const Point2 &p_pos, const Color &p_modulate, bool p_transpose, const Ref<Texture> &p_normal_map) const {
 
+    _request_data();
     if ((m_impl_data->w | m_impl_data->h) == 0)
         return;
     RID normal_rid = p_normal_map ? p_normal_map->get_rid() : RID();
@@ -845,6 +961,7 @@ void StreamTexture::draw(RID p_canvas_item, const Point2 &p_pos, const Color &p_
 }
 void StreamTexture::draw_rect(RID p_canvas_item, const Rect2 &p_rect, bool p_tile, const Color &p_modulate, bool p_transpose, const Ref<Texture> &p_normal_map) const {
 
+    _request_data();
     if ((m_impl_data->w | m_impl_data->h) == 0)
         return;
     RID normal_rid = p_normal_map ? p_normal_map->get_rid() : RID();
@@ -852,6 +969,7 @@ void StreamTexture::draw_rect(RID p_canvas_item, const Rect2 &p_rect, bool p_til
 }
 void StreamTexture::draw_rect_region(RID p_canvas_item, const Rect2 &p_rect, const Rect2 &p_src_rect, const Color &p_modulate, bool p_transpose, const Ref<Texture> &p_normal_map, bool p_clip_uv) const {
 
+    _request_data();
     if ((m_impl_data->w | m_impl_data->h) == 0)
         return;
     RID normal_rid = p_normal_map ? p_normal_map->get_rid() : RID();
@@ -865,6 +983,16 @@ bool StreamTexture::has_alpha() const {
 
 Ref<Image> StreamTexture::get_data() const {
 
+    if (m_impl_data->mips_streamed) {
+        // the rendering server may only hold the smaller mips
+        int lw, lh, lwc, lhc, lflags;
+        uint32_t df;
+        Ref<Image> image(make_ref_counted<Image>());
+        Error err = const_cast<StreamTexture *>(this)->_load_data(m_impl_data->path_to_file, lw, lh, lwc, lhc, lflags, df, image);
+        ERR_FAIL_COND_V(err != OK, Ref<Image>());
+        return image;
+    }
+    ResourcePayloadStreamer::get_singleton()->ensure(const_cast<StreamTexture *>(this));
     return RenderingServer::get_singleton()->texture_get_data(m_impl_data->texture);
 }
 
@@ -949,6 +1077,7 @@ StreamTexture::StreamTexture() {
 }
 
 StreamTexture::~StreamTexture() {
+    _payload_release();
     RenderingServer::get_singleton()->free_rid(m_impl_data->texture);
     delete m_impl_data;
 }
@@ -956,7 +1085,7 @@ StreamTexture::~StreamTexture() {
 RES ResourceFormatLoaderStreamTexture::load(StringView p_path, StringView p_original_path, Error *r_error) {
 
     Ref<StreamTexture> st(make_ref_counted<StreamTexture>());
-    Error err = st->load(p_path);
+    Error err = st->_load(p_path, ResourcePayloadStreamer::get_singleton()->is_lazy_loading_enabled());
     if (r_error)
         *r_error = err;
     if (err != OK)
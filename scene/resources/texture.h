@@ -32,6 +32,7 @@
 
 #include "core/math/rect2.h"
 #include "core/image.h"
+#include "core/io/resource_payload_streamer.h"
 #include "core/rid.h"
 #include "core/resource.h"
 #include "scene/resources/gradient.h"
@@ -159,10 +160,12 @@ public:
     ~ImageTexture() override;
 };
 
-class GODOT_EXPORT StreamTexture : public Texture {
+class GODOT_EXPORT StreamTexture : public Texture, public StreamedPayloadOwner {
 
     GDCLASS(StreamTexture,Texture)
 
+    friend class ResourceFormatLoaderStreamTexture;
+
 public:
     enum DataFormat {
         DATA_FORMAT_IMAGE,
@@ -182,7 +185,13 @@ public:
     };
 
 private:
-    Error _load_data(StringView p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit = 0);
+    Error _load_data(StringView p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, uint32_t &r_data_format, Ref<Image> &image, int p_size_limit = 0);
+    //! With p_lazy only the header is read, the image is streamed in once the texture is used. Textures
+    //! imported for streaming leave reading their mipmaps to the rendering server.
+    Error _load(StringView p_path, bool p_lazy);
+    void _upload(const Ref<Image> &p_image);
+    void _setup_texture();
+    void _request_data() const;
     struct StreamTextureData;
     StreamTextureData *m_impl_data;
 
@@ -196,6 +205,9 @@ protected:
     static void _bind_methods();
     void _validate_property(PropertyInfo &property) const override;
 
+    Error _payload_read() override;
+    uint64_t _payload_apply() override;
+
 public:
     using TextureFormatRequestCallback = void (*)(StringName);
 
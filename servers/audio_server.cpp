@@ -30,6 +30,7 @@
 
 #include "audio_server.h"
 #include "core/debugger/script_debugger.h"
+#include "core/external_profiler.h"
 #include "core/io/resource_loader.h"
 #include "core/method_bind.h"
 #include "core/method_arg_casters.h"
@@ -288,6 +289,8 @@ AudioDriver *AudioDriverManager::get_driver(int p_driver) {
 
 void AudioServer::_driver_process(int p_frames, int32_t *p_buffer) {
 
+    SCOPE_PROFILE(audio_mix);
+    MemoryTagScope mem_tag(MEM_TAG_AUDIO);
     int todo = p_frames;
 
 #ifdef DEBUG_ENABLED
@@ -114,6 +114,7 @@ public:
         bool redraw_if_visible : 4;
 
         float depth; //used for sorting
+        float lod_max_error; // object space error that is still invisible from the current camera, 0 draws full detail
 
         IntrusiveListNode<InstanceBase> dependency_item;
 
@@ -137,6 +138,8 @@ public:
             dynamic_gi = false;
             redraw_if_visible = false;
             lightmap_capture = nullptr;
+            depth = 0;
+            lod_max_error = 0;
         }
     };
 
@@ -211,6 +214,7 @@ public:
 
     virtual void texture_set_path(RID p_texture, StringView p_path) = 0;
     virtual const String &texture_get_path(RID p_texture) const = 0;
+    virtual void texture_set_mip_streaming(RID p_texture, StringView p_path) = 0;
 
     virtual void texture_set_shrink_all_x2_on_set_data(bool p_enable) = 0;
 
@@ -301,6 +305,11 @@ public:
     virtual Vector<Vector<uint8_t>> mesh_surface_get_blend_shapes(RID p_mesh, int p_surface) const = 0;
     virtual const Vector<AABB> &mesh_surface_get_skeleton_aabb(RID p_mesh, int p_surface) const = 0;
 
+    virtual void mesh_surface_set_lods(RID p_mesh, int p_surface, const Vector<float> &p_lod_errors, const Vector<PoolVector<uint8_t>> &p_lod_index_arrays) = 0;
+    virtual int mesh_surface_get_lod_count(RID p_mesh, int p_surface) const = 0;
+    virtual float mesh_surface_get_lod_error(RID p_mesh, int p_surface, int p_lod) const = 0;
+    virtual PoolVector<uint8_t> mesh_surface_get_lod_index_array(RID p_mesh, int p_surface, int p_lod) const = 0;
+
     virtual void mesh_remove_surface(RID p_mesh, int p_index) = 0;
     virtual int mesh_get_surface_count(RID p_mesh) const = 0;
 
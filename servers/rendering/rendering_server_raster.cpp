@@ -104,16 +104,19 @@ void VisualServerRaster::draw(bool p_swap_buffers, double frame_step) {
 
     changes = 0;
 
-    VSG::rasterizer->begin_frame(frame_step);
-    PROFILER_STARTFRAME("viewport");
-
-    VSG::scene->update_dirty_instances(); //update scene stuff
-
-    VSG::viewport->draw_viewports();
-    VSG::scene->render_probes();
-    _draw_margins();
-    VSG::rasterizer->end_frame(p_swap_buffers);
-    PROFILER_ENDFRAME("viewport");
+    {
+        MemoryTagScope mem_tag(MEM_TAG_RENDERING);
+        VSG::rasterizer->begin_frame(frame_step);
+        PROFILER_STARTFRAME("viewport");
+
+        VSG::scene->update_dirty_instances(); //update scene stuff
+
+        VSG::viewport->draw_viewports();
+        VSG::scene->render_probes();
+        _draw_margins();
+        VSG::rasterizer->end_frame(p_swap_buffers);
+        PROFILER_ENDFRAME("viewport");
+    }
 
     while (!frame_drawn_callbacks.empty()) {
 
@@ -163,6 +163,7 @@ public:
 
     void texture_set_path(RID arg1, StringView arg2) override { DISPLAY_CHANGED BINDBASE->texture_set_path(arg1, arg2); }
     const String & texture_get_path(RID arg1) const override { return BINDBASE->texture_get_path(arg1); }
+    void texture_set_mip_streaming(RID arg1, StringView arg2) override { DISPLAY_CHANGED BINDBASE->texture_set_mip_streaming(arg1, arg2); }
     void texture_set_shrink_all_x2_on_set_data(bool arg1) override { DISPLAY_CHANGED BINDBASE->texture_set_shrink_all_x2_on_set_data(arg1); }
     void texture_debug_usage(Vector<TextureInfo> * arg1) override { DISPLAY_CHANGED BINDBASE->texture_debug_usage(arg1); }
 
@@ -245,6 +246,11 @@ public:
     BIND2RC(Vector<Vector<uint8_t> >, mesh_surface_get_blend_shapes, RID, int)
     BIND2RC(const Vector<AABB> &, mesh_surface_get_skeleton_aabb, RID, int)
 
+    BIND4(mesh_surface_set_lods, RID, int, const Vector<float> &, const Vector<PoolVector<uint8_t>> &)
+    BIND2RC(int, mesh_surface_get_lod_count, RID, int)
+    BIND3RC(float, mesh_surface_get_lod_error, RID, int, int)
+    BIND3RC(PoolVector<uint8_t>, mesh_surface_get_lod_index_array, RID, int, int)
+
     void mesh_remove_surface(RID arg1, int arg2) override { DISPLAY_CHANGED BINDBASE->mesh_remove_surface(arg1, arg2); }
     int mesh_get_surface_count(RID arg1) const override { return BINDBASE->mesh_get_surface_count(arg1); }
 
@@ -38,6 +38,7 @@
 #include "core/os/mutex.h"
 #include "core/os/os.h"
 #include "core/map.h"
+#include "core/project_settings.h"
 #include <new>
 
 namespace {
@@ -1901,7 +1902,7 @@ void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_view
         } break;
     }
 
-    _prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+    _prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), lod_threshold_pixels / p_viewport_size.height);
     _render_scene(camera->transform, camera_matrix, ortho, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 #endif
 }
@@ -1980,17 +1981,17 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVREyes
         mono_transform *= apply_z_shift;
 
         // now prepare our scene with our adjusted transform projection matrix
-        _prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+        _prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), lod_threshold_pixels / p_viewport_size.height);
     } else if (p_eye == ARVREyes::EYE_MONO) {
         // For mono render, prepare as per usual
-        _prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+        _prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), lod_threshold_pixels / p_viewport_size.height);
     }
 
     // And render our scene...
     _render_scene(cam_transform, camera_matrix, false, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
-void VisualServerScene::_prepare_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe) {
+void VisualServerScene::_prepare_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, float p_lod_threshold) {
     SCOPE_AUTONAMED
 
     // Note, in stereo rendering:
@@ -2010,6 +2011,9 @@ void VisualServerScene::_prepare_scene(const Transform &p_cam_transform, const C
 
     Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
     float z_far = p_cam_projection.get_z_far();
+    float z_near = p_cam_projection.get_z_near();
+    // world space height of the threshold at unit distance (perspective) or anywhere (orthogonal)
+    float lod_extent = p_lod_threshold * 2.0f / p_cam_projection.matrix[1][1];
 
     /* STEP 2 - CULL */
     instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
@@ -2163,6 +2167,24 @@ void VisualServerScene::_prepare_scene(const Transform &p_cam_transform, const C
 
             ins->depth = near_plane.distance_to(ins->transform.origin);
             ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
+
+            ins->lod_max_error = 0;
+            if (lod_extent > 0 && ins->base_type == RS::INSTANCE_MESH) {
+                float world_error = lod_extent;
+                if (!p_cam_orthogonal) {
+                    const AABB &aabb = get_component<InstanceBoundsComponent>(ins->self).transformed_aabb;
+                    const Vector3 &eye = p_cam_transform.origin;
+                    Vector3 closest(CLAMP(eye.x, aabb.position.x, aabb.position.x + aabb.size.x),
+                            CLAMP(eye.y, aabb.position.y, aabb.position.y + aabb.size.y),
+                            CLAMP(eye.z, aabb.position.z, aabb.position.z + aabb.size.z));
+                    world_error *= M_MAX(eye.distance_to(closest), z_near);
+                }
+                Vector3 scale = ins->transform.basis.get_scale_abs();
+                float max_scale = M_MAX(M_MAX(scale.x, scale.y), scale.z);
+                if (max_scale > 0) {
+                    ins->lod_max_error = world_error / max_scale;
+                }
+            }
         }
 
         if (!keep) {
@@ -2414,7 +2436,7 @@ bool VisualServerScene::_render_reflection_probe_step(Instance *p_instance, int
             shadow_atlas = scenario->reflection_probe_shadow_atlas;
         }
 
-        _prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance);
+        _prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, 0.0f);
         _render_scene(xform, cm, false, RID(), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step);
 
     } else {
@@ -3675,6 +3697,7 @@ VisualServerScene::VisualServerScene() {
     probe_bake_thread_exit = false;
 
     render_pass = 1;
+    lod_threshold_pixels = T_GLOBAL_GET<float>("rendering/quality/lod/threshold_pixels");
     singleton = this;
 }
 
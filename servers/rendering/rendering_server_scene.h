@@ -358,6 +358,8 @@ public:
 
     int instance_cull_count;
     Instance *instance_cull_result[MAX_INSTANCE_CULL];
+    // screen space error, in pixels of viewport height, allowed when picking mesh LODs
+    float lod_threshold_pixels;
     Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
     Instance *light_cull_result[MAX_LIGHTS_CULLED];
     RID light_instance_cull_result[MAX_LIGHTS_CULLED];
@@ -409,7 +411,7 @@ public:
 
     void _prepare_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal,
             RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas,
-            RID p_reflection_probe);
+            RID p_reflection_probe, float p_lod_threshold);
     void _render_scene(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal,
             RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe,
             int p_reflection_probe_pass);
@@ -62,6 +62,7 @@ void VisualServerWrapMT::_thread_callback(void *_instance) {
 void VisualServerWrapMT::thread_loop() {
 
     server_thread = Thread::get_caller_id();
+    Memory::set_thread_tag(MEM_TAG_RENDERING); // everything this thread allocates belongs to the renderer
 
     OS::get_singleton()->make_rendering_thread();
 
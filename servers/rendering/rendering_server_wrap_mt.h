@@ -117,6 +117,14 @@ public:
             return server_name->texture_get_path(p1);
         }
     }
+    void texture_set_mip_streaming(RID p1, StringView p2) override {
+        if (Thread::get_caller_id() != server_thread) {
+            String by_val(p2);
+            command_queue.push( [this,p1,by_val]() { server_name->texture_set_mip_streaming(p1, by_val);});
+        } else {
+            server_name->texture_set_mip_streaming(p1, p2);
+        }
+    }
     FUNC1(texture_set_shrink_all_x2_on_set_data, bool)
     FUNC1S(texture_debug_usage, Vector<TextureInfo> *)
 
@@ -204,6 +212,11 @@ public:
         }
     }
 
+    FUNC4(mesh_surface_set_lods, RID, int, const Vector<float> &, const Vector<PoolVector<uint8_t>> &)
+    FUNC2RC(int, mesh_surface_get_lod_count, RID, int)
+    FUNC3RC(float, mesh_surface_get_lod_error, RID, int, int)
+    FUNC3RC(PoolVector<uint8_t>, mesh_surface_get_lod_index_array, RID, int, int)
+
     FUNC2(mesh_remove_surface, RID, int)
     FUNC1RC(int, mesh_get_surface_count, RID)
 
@@ -517,6 +530,48 @@ public:
     FUNC5(instance_geometry_set_draw_range, RID, float, float, float, float)
     FUNC2(instance_geometry_set_as_instance_lod, RID, RID)
 
+    /* BULK INSTANCING API */
+
+    void instances_create(Span<RID> r_instances) override {
+        if (Thread::get_caller_id() != server_thread) {
+            instance_take_ids(r_instances);
+        } else {
+            rendering_server->instances_create(r_instances);
+        }
+    }
+
+#define FUNC_INSTANCES1(m_type, m_arg1)                                                             \
+    void m_type(Span<const RID> p_instances, m_arg1 p1) override {                                  \
+        if (Thread::get_caller_id() != server_thread) {                                             \
+            Vector<RID> instances(p_instances.begin(), p_instances.end());                           \
+            command_queue.push([this, instances = eastl::move(instances), p1]() {                    \
+                rendering_server->m_type(instances, p1);                                             \
+            });                                                                                      \
+        } else {                                                                                     \
+            rendering_server->m_type(p_instances, p1);                                               \
+        }                                                                                            \
+    }
+
+    FUNC_INSTANCES1(instances_set_base, RID)
+    FUNC_INSTANCES1(instances_set_scenario, RID)
+    FUNC_INSTANCES1(instances_set_visible, bool)
+    FUNC_INSTANCES1(instances_geometry_set_material_override, RID)
+#undef FUNC_INSTANCES1
+
+    void instances_set_transform(Span<const RID> p_instances, Span<const Transform> p_transforms) override {
+        ERR_FAIL_COND(p_instances.size() != p_transforms.size());
+        if (Thread::get_caller_id() != server_thread) {
+            // the spans belong to the caller, the queued command works on its own copies
+            Vector<RID> instances(p_instances.begin(), p_instances.end());
+            Vector<Transform> transforms(p_transforms.begin(), p_transforms.end());
+            command_queue.push([this, instances = eastl::move(instances), transforms = eastl::move(transforms)]() {
+                rendering_server->instances_set_transform(instances, transforms);
+            });
+        } else {
+            rendering_server->instances_set_transform(p_instances, p_transforms);
+        }
+    }
+
     /* CANVAS (2D) */
 
     FUNCRID(canvas)
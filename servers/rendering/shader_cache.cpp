@@ -0,0 +1,260 @@
+/*************************************************************************/
+/*  shader_cache.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "shader_cache.h"
+
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/mutex.h"
+#include "core/string_utils.h"
+#include "core/version.h"
+
+#include <atomic>
+
+namespace {
+// Bump when the container layout changes, backends version their own payloads through the key.
+constexpr uint32_t SHADER_CACHE_FORMAT = 1;
+constexpr char SHADER_CACHE_MAGIC[4] = { 'G', 'S', 'H', 'C' };
+
+Mutex s_shader_cache_lock;
+String s_shader_cache_dir("user://shader_cache");
+String s_shader_cache_backend_tag;
+bool s_shader_cache_enabled = true;
+std::atomic<uint64_t> s_shader_cache_hits { 0 };
+std::atomic<uint64_t> s_shader_cache_misses { 0 };
+
+bool _read_entry(StringView p_path, StringView p_key, Vector<uint8_t> &r_data) {
+
+    Error err;
+    FileAccessRef f(FileAccess::open(p_path, FileAccess::READ, &err));
+    if (!f) {
+        return false;
+    }
+    uint8_t magic[4];
+    if (f->get_buffer(magic, 4) != 4 || memcmp(magic, SHADER_CACHE_MAGIC, 4) != 0) {
+        return false;
+    }
+    if (f->get_32() != SHADER_CACHE_FORMAT) {
+        return false;
+    }
+    // Guard against hash collisions and renamed files.
+    if (StringView(f->get_pascal_string()) != p_key) {
+        return false;
+    }
+    uint32_t size = f->get_32();
+    if (size > f->get_len() - f->get_position()) {
+        return false; // truncated
+    }
+    r_data.resize(size);
+    return f->get_buffer(r_data.data(), size) == int(size);
+}
+} // namespace
+
+void ShaderCache::Writer::put_u32(uint32_t p_value) {
+
+    for (int i = 0; i < 4; i++) {
+        data.push_back(uint8_t(p_value >> (i * 8)));
+    }
+}
+
+void ShaderCache::Writer::put_float(float p_value) {
+
+    uint32_t bits;
+    memcpy(&bits, &p_value, sizeof(bits));
+    put_u32(bits);
+}
+
+void ShaderCache::Writer::put_string(StringView p_str) {
+
+    put_u32(p_str.size());
+    data.insert(data.end(), p_str.begin(), p_str.end());
+}
+
+uint32_t ShaderCache::Reader::get_u32() {
+
+    if (failed || data.size() - pos < 4) {
+        failed = true;
+        return 0;
+    }
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        v |= uint32_t(data[pos++]) << (i * 8);
+    }
+    return v;
+}
+
+float ShaderCache::Reader::get_float() {
+
+    uint32_t bits = get_u32();
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+String ShaderCache::Reader::get_string() {
+
+    uint32_t len = get_u32();
+    if (failed || data.size() - pos < len) {
+        failed = true;
+        return String();
+    }
+    String res((const char *)data.data() + pos, len);
+    pos += len;
+    return res;
+}
+
+String ShaderCache::make_key(StringView p_backend, int p_mode, StringView p_code) {
+
+    String src;
+    src.reserve(p_code.size() + 64);
+    src.append(p_backend);
+    src.append("\n" VERSION_FULL_BUILD "\n");
+    src.append(::to_string(p_mode));
+    src.push_back('\n');
+    src.append(p_code);
+    return StringUtils::sha256_text(src);
+}
+
+void ShaderCache::set_backend_tag(StringView p_tag) {
+
+    MutexLock lock(s_shader_cache_lock);
+    s_shader_cache_backend_tag = p_tag;
+}
+
+String ShaderCache::get_backend_tag() {
+
+    MutexLock lock(s_shader_cache_lock);
+    return s_shader_cache_backend_tag;
+}
+
+void ShaderCache::set_enabled(bool p_enabled) {
+
+    MutexLock lock(s_shader_cache_lock);
+    s_shader_cache_enabled = p_enabled;
+}
+
+bool ShaderCache::is_enabled() {
+
+    MutexLock lock(s_shader_cache_lock);
+    return s_shader_cache_enabled;
+}
+
+void ShaderCache::set_cache_dir(StringView p_dir) {
+
+    MutexLock lock(s_shader_cache_lock);
+    s_shader_cache_dir = p_dir;
+}
+
+String ShaderCache::get_cache_dir() {
+
+    MutexLock lock(s_shader_cache_lock);
+    return s_shader_cache_dir;
+}
+
+String ShaderCache::get_entry_path(StringView p_dir, StringView p_key) {
+
+    return PathUtils::plus_file(p_dir, String(p_key) + ".shc");
+}
+
+bool ShaderCache::load(StringView p_key, Vector<uint8_t> &r_data) {
+
+    MutexLock lock(s_shader_cache_lock);
+    if (!s_shader_cache_enabled) {
+        return false;
+    }
+    if (_read_entry(get_entry_path(s_shader_cache_dir, p_key), p_key, r_data) ||
+            _read_entry(get_entry_path(EXPORT_DIR, p_key), p_key, r_data)) {
+        s_shader_cache_hits++;
+        return true;
+    }
+    s_shader_cache_misses++;
+    return false;
+}
+
+void ShaderCache::save(StringView p_key, const Vector<uint8_t> &p_data) {
+
+    MutexLock lock(s_shader_cache_lock);
+    if (!s_shader_cache_enabled) {
+        return;
+    }
+
+    DirAccessRef da(DirAccess::create_for_path(s_shader_cache_dir));
+    ERR_FAIL_COND(!da);
+    if (!da->dir_exists(s_shader_cache_dir)) {
+        Error err = da->make_dir_recursive(s_shader_cache_dir);
+        ERR_FAIL_COND_MSG(err != OK, "Cannot create shader cache directory '" + s_shader_cache_dir + "'.");
+    }
+
+    // Write to a temporary file first, so that an interrupted write never leaves a truncated entry behind.
+    String path = get_entry_path(s_shader_cache_dir, p_key);
+    String tmp_path = path + ".tmp";
+    {
+        Error err;
+        FileAccessRef f(FileAccess::open(tmp_path, FileAccess::WRITE, &err));
+        ERR_FAIL_COND_MSG(!f, "Cannot write shader cache entry '" + tmp_path + "'.");
+        f->store_buffer((const uint8_t *)SHADER_CACHE_MAGIC, 4);
+        f->store_32(SHADER_CACHE_FORMAT);
+        f->store_pascal_string(p_key);
+        f->store_32(p_data.size());
+        f->store_buffer(p_data.data(), p_data.size());
+    }
+    if (da->file_exists(path)) {
+        da->remove(path);
+    }
+    Error err = da->rename(tmp_path, path);
+    ERR_FAIL_COND_MSG(err != OK, "Cannot store shader cache entry '" + path + "'.");
+}
+
+Vector<String> ShaderCache::get_cached_keys() {
+
+    MutexLock lock(s_shader_cache_lock);
+    Vector<String> keys;
+    DirAccessRef da(DirAccess::open(s_shader_cache_dir));
+    if (!da) {
+        return keys;
+    }
+    da->list_dir_begin();
+    for (String f = da->get_next(); !f.empty(); f = da->get_next()) {
+        if (!da->current_is_dir() && PathUtils::get_extension(f) == "shc") {
+            keys.emplace_back(PathUtils::get_basename(f));
+        }
+    }
+    da->list_dir_end();
+    return keys;
+}
+
+uint64_t ShaderCache::get_hit_count() {
+    return s_shader_cache_hits;
+}
+
+uint64_t ShaderCache::get_miss_count() {
+    return s_shader_cache_misses;
+}
@@ -0,0 +1,97 @@
+/*************************************************************************/
+/*  shader_cache.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/string.h"
+#include "core/vector.h"
+
+/**
+ * Content addressed on-disk cache for generated shader code.
+ *
+ * Entries are keyed by a hash of the backend, the engine version, the shader mode and the shader source, so an
+ * entry never needs invalidation; a changed shader simply produces a different key. The payload format is owned
+ * by the backend, which uses the Writer/Reader helpers below to (de)serialize its generated code.
+ *
+ * Lookups check the writable cache directory first and then the read-only directory shipped with exported
+ * projects.
+ */
+class GODOT_EXPORT ShaderCache {
+public:
+    //! Directory inside the exported pack that holds pre-populated entries.
+    static constexpr const char *EXPORT_DIR = "res://.shader_cache";
+
+    class Writer {
+        Vector<uint8_t> data;
+
+    public:
+        void put_u32(uint32_t p_value);
+        void put_float(float p_value);
+        void put_string(StringView p_str);
+        const Vector<uint8_t> &get_data() const { return data; }
+    };
+
+    class Reader {
+        const Vector<uint8_t> &data;
+        size_t pos = 0;
+        bool failed = false;
+
+    public:
+        uint32_t get_u32();
+        float get_float();
+        String get_string();
+        //! True when any read went past the end of the payload.
+        bool has_failed() const { return failed; }
+        bool is_at_end() const { return pos == data.size(); }
+
+        explicit Reader(const Vector<uint8_t> &p_data) : data(p_data) {}
+    };
+
+    static String make_key(StringView p_backend, int p_mode, StringView p_code);
+    //! Set by the active backend to the p_backend it passes to make_key, so tools can find entries without compiling.
+    static void set_backend_tag(StringView p_tag);
+    static String get_backend_tag();
+
+    static void set_enabled(bool p_enabled);
+    static bool is_enabled();
+    //! Sets the writable cache directory, defaults to user://shader_cache
+    static void set_cache_dir(StringView p_dir);
+    static String get_cache_dir();
+
+    static bool load(StringView p_key, Vector<uint8_t> &r_data);
+    static void save(StringView p_key, const Vector<uint8_t> &p_data);
+    //! Keys of all entries in the writable cache directory.
+    static Vector<String> get_cached_keys();
+    static String get_entry_path(StringView p_dir, StringView p_key);
+
+    static uint64_t get_hit_count();
+    static uint64_t get_miss_count();
+};
@@ -0,0 +1,525 @@
+/*************************************************************************/
+/*  texture_streaming.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "texture_streaming.h"
+
+#include "core/error_macros.h"
+#include "core/external_profiler.h"
+#include "core/os/file_access.h"
+#include "core/os/memory.h"
+#include "core/os/thread.h"
+#include "core/pool_vector.h"
+
+#include "EASTL/sort.h"
+
+#include <cmath>
+
+// Data format bits of the .stex header, they match StreamTexture::FormatBits.
+enum {
+    STEX_MASK_IMAGE_FORMAT = (1 << 20) - 1,
+    STEX_BIT_LOSSLESS = 1 << 20,
+    STEX_BIT_LOSSY = 1 << 21,
+    STEX_BIT_HAS_MIPMAPS = 1 << 23,
+};
+
+uint64_t StexMipLayout::get_chain_size(int p_base_mip) const {
+
+    uint64_t size = 0;
+    for (int i = p_base_mip; i < sizes.size(); i++) {
+        size += sizes[i];
+    }
+    return size;
+}
+
+Error StexMipLayout::parse(FileAccess *p_f) {
+
+    uint8_t header[4];
+    p_f->get_buffer(header, 4);
+    ERR_FAIL_COND_V(header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T', ERR_FILE_CORRUPT);
+
+    // custom sizes and texture flags only matter to StreamTexture
+    width = p_f->get_16();
+    p_f->get_16();
+    height = p_f->get_16();
+    p_f->get_16();
+    p_f->get_32();
+    uint32_t df = p_f->get_32();
+
+    if (df & (STEX_BIT_LOSSLESS | STEX_BIT_LOSSY) || !(df & STEX_BIT_HAS_MIPMAPS)) {
+        return ERR_UNAVAILABLE;
+    }
+    format = Image::Format(df & STEX_MASK_IMAGE_FORMAT);
+    ERR_FAIL_COND_V(format >= Image::FORMAT_MAX || width <= 0 || height <= 0, ERR_FILE_CORRUPT);
+
+    const uint64_t data_start = p_f->get_position();
+    const int total_size = Image::get_image_data_size(width, height, format, true);
+    if (data_start + total_size > p_f->get_len()) {
+        // older files saved fewer mipmaps, the regular loader pads those
+        return ERR_UNAVAILABLE;
+    }
+
+    const int mip_count = Image::get_image_required_mipmaps(width, height, format) + 1;
+    offsets.resize(mip_count);
+    sizes.resize(mip_count);
+    for (int i = 0; i < mip_count; i++) {
+        int ofs = Image::get_image_mipmap_offset(width, height, format, i);
+        int next = i + 1 < mip_count ? Image::get_image_mipmap_offset(width, height, format, i + 1) : total_size;
+        offsets[i] = data_start + ofs;
+        sizes[i] = next - ofs;
+    }
+    return OK;
+}
+
+Ref<Image> StexMipLayout::read_chain(FileAccess *p_f, int p_base_mip) const {
+
+    ERR_FAIL_INDEX_V(p_base_mip, get_mip_count(), Ref<Image>());
+
+    const int size = get_chain_size(p_base_mip);
+    PoolVector<uint8_t> data;
+    data.resize(size);
+    {
+        PoolVector<uint8_t>::Write w = data.write();
+        p_f->seek(offsets[p_base_mip]);
+        ERR_FAIL_COND_V(p_f->get_buffer(w.ptr(), size) != size, Ref<Image>());
+    }
+
+    return make_ref_counted<Image>(get_mip_width(p_base_mip), get_mip_height(p_base_mip), p_base_mip + 1 < get_mip_count(), format, data);
+}
+
+void TextureStreamingView::setup(const Transform &p_cam_transform, const CameraMatrix &p_projection, int p_viewport_height) {
+
+    origin = p_cam_transform.origin;
+    orthogonal = p_projection.is_orthogonal();
+
+    // half extents are taken at the near plane
+    Vector2 half_extents = p_projection.get_viewport_half_extents();
+    if (half_extents.y <= 0) {
+        pixels_per_unit = 0;
+        return;
+    }
+    pixels_per_unit = p_viewport_height / (2 * half_extents.y);
+    if (!orthogonal) {
+        pixels_per_unit *= p_projection.get_z_near();
+    }
+}
+
+float TextureStreamingView::get_screen_size(const AABB &p_aabb) const {
+
+    if (pixels_per_unit <= 0) {
+        return -1;
+    }
+    const float extent = p_aabb.get_longest_axis_size();
+    if (orthogonal) {
+        return extent * pixels_per_unit;
+    }
+
+    // distance to the bounding sphere, so the closest part of the instance decides
+    float distance = origin.distance_to(p_aabb.position + p_aabb.size * 0.5f) - p_aabb.size.length() * 0.5f;
+    if (distance <= CMP_EPSILON) {
+        return -1; // camera inside the bounds
+    }
+    return extent * pixels_per_unit / distance;
+}
+
+/////////////////////////////////////
+
+void TextureStreamer::_thread_function(void *p_user) {
+
+    TextureStreamer *streamer = (TextureStreamer *)p_user;
+    Thread::set_name("TextureStreamer");
+
+    std::unique_lock<std::mutex> lock(streamer->mutex);
+    while (!streamer->exit_thread) {
+        if (streamer->queue.empty()) {
+            streamer->work_available.wait(lock);
+            continue;
+        }
+        ReadJob *job = streamer->queue.front();
+        streamer->queue.pop_front();
+        streamer->reading++;
+        lock.unlock();
+        _read_job(job);
+        lock.lock();
+        streamer->reading--;
+        streamer->finished.push_back(job);
+        streamer->state_changed.notify_all();
+    }
+}
+
+void TextureStreamer::_read_job(ReadJob *p_job) {
+
+    SCOPE_PROFILE(texture_stream_read);
+    FileAccessRef f = FileAccess::open(p_job->path, FileAccess::READ);
+    if (f) {
+        p_job->mips = p_job->layout.read_chain(f, p_job->base_mip);
+    }
+}
+
+void TextureStreamer::_queue_read(RID p_texture, StreamedTexture &p_st, int p_base_mip) {
+
+    ReadJob *job = memnew(ReadJob);
+    job->texture = p_texture;
+    job->serial = p_st.serial;
+    job->path = p_st.path;
+    job->layout = p_st.layout;
+    job->base_mip = p_base_mip;
+    p_st.target_mip = p_base_mip;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (!thread && !thread_failed) {
+        exit_thread = false;
+        thread = Thread::create(&TextureStreamer::_thread_function, this);
+        thread_failed = thread == nullptr;
+    }
+
+    if (!thread) {
+        // no threads on this platform, read right away and apply on the next update
+        lock.unlock();
+        _read_job(job);
+        lock.lock();
+        finished.push_back(job);
+        return;
+    }
+
+    queue.push_back(job);
+    lock.unlock();
+    work_available.notify_one();
+}
+
+void TextureStreamer::_apply_finished() {
+
+    Vector<ReadJob *> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.swap(finished);
+    }
+
+    for (ReadJob *job : jobs) {
+        auto iter = textures.find(job->texture);
+        // the texture may have been removed or added again while reading
+        if (iter != textures.end() && iter->second.serial == job->serial) {
+            StreamedTexture &st = iter->second;
+            st.target_mip = -1;
+            if (!job->mips) {
+                ERR_PRINT("Failed to read the mipmaps of streamed texture: " + job->path);
+                st.failed = true;
+            } else {
+                backend->_texture_stream_apply(job->texture, job->base_mip, job->mips);
+                resident_size -= st.layout.get_chain_size(st.resident_mip);
+                st.resident_mip = job->base_mip;
+                resident_size += st.layout.get_chain_size(st.resident_mip);
+            }
+        }
+        memdelete(job);
+    }
+}
+
+void TextureStreamer::_schedule() {
+
+    struct Candidate {
+        RID texture;
+        StreamedTexture *st;
+        int mip;
+    };
+
+    Vector<Candidate> candidates;
+    candidates.reserve(textures.size());
+    uint64_t total = 0;
+    uint64_t committed = 0; // resident now or once the running reads land
+
+    for (auto &E : textures) {
+        StreamedTexture &st = E.second;
+        const int held_mip = st.target_mip >= 0 ? MIN(st.target_mip, st.resident_mip) : st.resident_mip;
+        committed += st.layout.get_chain_size(held_mip);
+        if (st.failed) {
+            total += st.layout.get_chain_size(st.resident_mip);
+            continue;
+        }
+        bool recent = st.used && frame - st.last_used <= uint64_t(keep_frames);
+        int mip = recent ? MIN(st.wanted_mip, st.min_mip) : st.min_mip;
+        candidates.push_back({ E.first, &st, mip });
+        total += st.layout.get_chain_size(mip);
+    }
+
+    if (budget && total > budget) {
+        // least recently used first, the most detailed first among equally recent ones
+        eastl::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+            if (a.st->last_used != b.st->last_used) {
+                return a.st->last_used < b.st->last_used;
+            }
+            return a.mip < b.mip;
+        });
+
+        // textures that weren't drawn last frame give up all their detail first
+        for (Candidate &c : candidates) {
+            if (total <= budget || (c.st->used && c.st->last_used == frame)) {
+                break;
+            }
+            total -= c.st->layout.get_chain_size(c.mip) - c.st->layout.get_chain_size(c.st->min_mip);
+            c.mip = c.st->min_mip;
+        }
+
+        // then visible ones lose a level at a time, the most detailed levels go first
+        for (int level = 0; total > budget; level++) {
+            bool droppable = false;
+            for (Candidate &c : candidates) {
+                if (c.mip < level || c.mip >= c.st->min_mip) {
+                    continue;
+                }
+                droppable = true;
+                if (c.mip == level && total > budget) {
+                    total -= c.st->layout.get_chain_size(c.mip) - c.st->layout.get_chain_size(c.mip + 1);
+                    c.mip++;
+                }
+            }
+            if (!droppable) {
+                break;
+            }
+        }
+    }
+
+    int in_flight = get_pending_count();
+    Vector<Candidate *> upgrades;
+
+    // dropping levels frees memory, so those reads go first
+    for (Candidate &c : candidates) {
+        StreamedTexture &st = *c.st;
+        if (st.target_mip >= 0 || c.mip == st.resident_mip) {
+            continue;
+        }
+        if (c.mip < st.resident_mip) {
+            upgrades.push_back(&c);
+            continue;
+        }
+        if (in_flight >= max_reads) {
+            continue;
+        }
+        _queue_read(c.texture, st, c.mip);
+        in_flight++;
+    }
+
+    // the textures missing the most detail first
+    eastl::sort(upgrades.begin(), upgrades.end(), [](const Candidate *a, const Candidate *b) {
+        return a->st->resident_mip - a->mip > b->st->resident_mip - b->mip;
+    });
+
+    for (Candidate *c : upgrades) {
+        if (in_flight >= max_reads) {
+            break;
+        }
+        StreamedTexture &st = *c->st;
+        uint64_t growth = st.layout.get_chain_size(c->mip) - st.layout.get_chain_size(st.resident_mip);
+        if (budget && committed + growth > budget) {
+            continue; // wait for the levels being dropped to free their memory
+        }
+        committed += growth;
+        _queue_read(c->texture, st, c->mip);
+        in_flight++;
+    }
+}
+
+int TextureStreamer::_get_min_mip(const StexMipLayout &p_layout) const {
+
+    int mip = 0;
+    while (mip + 1 < p_layout.get_mip_count() && (p_layout.get_mip_width(mip) > min_resident_size || p_layout.get_mip_height(mip) > min_resident_size)) {
+        mip++;
+    }
+    return mip;
+}
+
+Error TextureStreamer::add(RID p_texture, StringView p_path) {
+
+    remove(p_texture);
+
+    FileAccessRef f = FileAccess::open(p_path, FileAccess::READ);
+    ERR_FAIL_COND_V_MSG(!f, ERR_CANT_OPEN, "Can't open streamed texture: " + String(p_path) + ".");
+
+    StexMipLayout layout;
+    Error err = layout.parse(f);
+    if (err != OK) {
+        return err;
+    }
+
+    const int base_mip = enabled ? _get_min_mip(layout) : 0;
+    Ref<Image> mips = layout.read_chain(f, base_mip);
+    ERR_FAIL_COND_V(!mips, ERR_FILE_CORRUPT);
+    backend->_texture_stream_apply(p_texture, base_mip, mips);
+
+    if (!enabled) {
+        return OK;
+    }
+
+    StreamedTexture &st = textures[p_texture];
+    st.layout = eastl::move(layout);
+    st.path = p_path;
+    st.serial = ++serial_counter;
+    st.min_mip = base_mip;
+    st.resident_mip = base_mip;
+    st.wanted_mip = base_mip;
+    resident_size += st.layout.get_chain_size(base_mip);
+    return OK;
+}
+
+void TextureStreamer::remove(RID p_texture) {
+
+    auto iter = textures.find(p_texture);
+    if (iter == textures.end()) {
+        return;
+    }
+    resident_size -= iter->second.layout.get_chain_size(iter->second.resident_mip);
+    textures.erase(iter);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto job = queue.begin(); job != queue.end();) {
+        if ((*job)->texture == p_texture) {
+            memdelete(*job);
+            job = queue.erase(job);
+        } else {
+            ++job;
+        }
+    }
+}
+
+void TextureStreamer::load_full(RID p_texture) {
+
+    auto iter = textures.find(p_texture);
+    if (iter == textures.end()) {
+        return;
+    }
+
+    const StreamedTexture &st = iter->second;
+    if (st.resident_mip != 0) {
+        FileAccessRef f = FileAccess::open(st.path, FileAccess::READ);
+        Ref<Image> mips = f ? st.layout.read_chain(f, 0) : Ref<Image>();
+        ERR_FAIL_COND_MSG(!mips, "Can't read streamed texture: " + st.path + ".");
+        backend->_texture_stream_apply(p_texture, 0, mips);
+    }
+    remove(p_texture);
+}
+
+void TextureStreamer::request(RID p_texture, float p_screen_size) {
+
+    if (textures.empty()) {
+        return;
+    }
+    auto iter = textures.find(p_texture);
+    if (iter == textures.end()) {
+        return;
+    }
+
+    StreamedTexture &st = iter->second;
+    int mip = p_screen_size < 0 ? 0 : get_mip_for_screen_size(st.layout.width, st.layout.height, st.layout.get_mip_count(), p_screen_size);
+    if (!st.used || st.last_used != frame) {
+        st.used = true;
+        st.last_used = frame;
+        st.wanted_mip = mip;
+    } else {
+        st.wanted_mip = MIN(st.wanted_mip, mip);
+    }
+}
+
+int TextureStreamer::get_resident_mip(RID p_texture) const {
+
+    auto iter = textures.find(p_texture);
+    return iter == textures.end() ? -1 : iter->second.resident_mip;
+}
+
+int TextureStreamer::get_mip_for_screen_size(int p_width, int p_height, int p_mip_count, float p_screen_size) const {
+
+    // never pick a level with fewer texels than the pixels it covers
+    float mip = std::log2(M_MAX(p_width, p_height) / M_MAX(p_screen_size, 1.0f)) + mip_bias;
+    return CLAMP(int(Math::floor(mip)), 0, p_mip_count - 1);
+}
+
+void TextureStreamer::update(uint64_t p_frame) {
+
+    _apply_finished();
+    if (p_frame == frame) {
+        return; // levels were already picked this frame
+    }
+    if (!textures.empty()) {
+        _schedule();
+    }
+    // requests from now on belong to the new frame
+    frame = p_frame;
+}
+
+void TextureStreamer::flush() {
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!queue.empty() || reading) {
+            state_changed.wait(lock);
+        }
+    }
+    _apply_finished();
+}
+
+int TextureStreamer::get_pending_count() const {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size() + reading + finished.size();
+}
+
+void TextureStreamer::finish() {
+
+    Thread *to_join = nullptr;
+    Vector<ReadJob *> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exit_thread = true;
+        eastl::swap(to_join, thread);
+        dropped.assign(queue.begin(), queue.end());
+        queue.clear();
+    }
+    work_available.notify_all();
+
+    if (to_join) {
+        Thread::wait_to_finish(to_join);
+        memdelete(to_join);
+    }
+
+    for (ReadJob *job : dropped) {
+        auto iter = textures.find(job->texture);
+        if (iter != textures.end() && iter->second.serial == job->serial) {
+            iter->second.target_mip = -1;
+        }
+        memdelete(job);
+    }
+    _apply_finished();
+}
+
+TextureStreamer::~TextureStreamer() {
+
+    textures.clear();
+    finish();
+}
@@ -0,0 +1,215 @@
+/*************************************************************************/
+/*  texture_streaming.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/deque.h"
+#include "core/hash_map.h"
+#include "core/image.h"
+#include "core/math/aabb.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/transform.h"
+#include "core/rid.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+#include <condition_variable>
+#include <mutex>
+
+class FileAccess;
+class Thread;
+
+/**
+ * Location of every mip level inside a .stex file with raw (uncompressed or VRAM compressed) data.
+ * Levels are stored most detailed first and back to back, so any tail of the chain is one contiguous read.
+ */
+struct GODOT_EXPORT StexMipLayout {
+    int width = 0;
+    int height = 0;
+    Image::Format format = Image::FORMAT_MAX;
+    //! File offset and size in bytes of each level, level 0 first.
+    Vector<uint64_t> offsets;
+    Vector<uint32_t> sizes;
+
+    int get_mip_count() const { return offsets.size(); }
+    int get_mip_width(int p_mip) const { return M_MAX(1, width >> p_mip); }
+    int get_mip_height(int p_mip) const { return M_MAX(1, height >> p_mip); }
+    //! Bytes taken by levels p_base_mip and below.
+    uint64_t get_chain_size(int p_base_mip) const;
+
+    //! Fills the layout from the header of the .stex file at the current position of p_f.
+    //! Fails with ERR_UNAVAILABLE for files that can't be streamed: without mipmaps or stored as PNG/WebP.
+    Error parse(FileAccess *p_f);
+    //! Reads levels p_base_mip and below into an image the size of level p_base_mip.
+    Ref<Image> read_chain(FileAccess *p_f, int p_base_mip) const;
+};
+
+/**
+ * Projects world space bounds of an instance to the pixels they cover, which tells how detailed the mips of its
+ * textures need to be. Assumes the textures are mapped once across the instance.
+ */
+struct GODOT_EXPORT TextureStreamingView {
+    Vector3 origin;
+    //! Pixels covered by one world unit at distance one, or at any distance for orthogonal cameras.
+    float pixels_per_unit = 0;
+    bool orthogonal = false;
+
+    void setup(const Transform &p_cam_transform, const CameraMatrix &p_projection, int p_viewport_height);
+    //! Size in pixels of the longest axis of p_aabb.
+    float get_screen_size(const AABB &p_aabb) const;
+};
+
+/**
+ * Receives the mips read by TextureStreamer, implemented by rasterizer storages. Called on the thread that calls
+ * TextureStreamer::update.
+ */
+class GODOT_EXPORT TextureStreamingBackend {
+public:
+    //! Replaces the mips of p_texture with p_mips, which holds level p_base_mip and all less detailed levels.
+    virtual void _texture_stream_apply(RID p_texture, int p_base_mip, const Ref<Image> &p_mips) = 0;
+
+    virtual ~TextureStreamingBackend() = default;
+};
+
+/**
+ * Keeps only the mips of streamed textures that are visible resident, within a memory budget.
+ *
+ * The renderer reports the mip level each texture needs while building its render lists, update() then picks the
+ * level to keep for every texture once per frame. Uses without a known screen size, like canvas items, report
+ * full detail. Textures not used for a while fall back to their tail, the levels no larger than the minimum
+ * resident size which always stay loaded. When the wanted levels exceed the
+ * budget, textures used least recently lose detail first, then all visible ones lose a level at a time.
+ *
+ * Mip chains are read on a background thread and handed to the backend by update(). Dropping levels reads the
+ * smaller chain again instead of copying it on the GPU, which keeps the backend to a single upload entry point.
+ */
+class GODOT_EXPORT TextureStreamer {
+
+    struct StreamedTexture {
+        StexMipLayout layout;
+        String path;
+        uint32_t serial = 0;
+        int min_mip = 0; // least detailed level that stays resident
+        int resident_mip = 0;
+        int target_mip = -1; // level being read, -1 when idle
+        int wanted_mip = 0;
+        uint64_t last_used = 0;
+        bool used = false;
+        bool failed = false;
+    };
+
+    struct ReadJob {
+        RID texture;
+        uint32_t serial = 0;
+        String path;
+        StexMipLayout layout;
+        int base_mip = 0;
+        Ref<Image> mips;
+    };
+
+    TextureStreamingBackend *backend;
+    HashMap<RID, StreamedTexture> textures;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable state_changed;
+    Deque<ReadJob *> queue;
+    Vector<ReadJob *> finished;
+    int reading = 0;
+    Thread *thread = nullptr;
+    bool exit_thread = false;
+    bool thread_failed = false;
+
+    uint64_t frame = 0;
+    uint64_t budget = 0;
+    uint64_t resident_size = 0;
+    uint32_t serial_counter = 0;
+    int min_resident_size = 64;
+    int keep_frames = 60;
+    int max_reads = 4;
+    float mip_bias = 0;
+    bool enabled = true;
+
+    static void _thread_function(void *p_user);
+    static void _read_job(ReadJob *p_job);
+    void _queue_read(RID p_texture, StreamedTexture &p_st, int p_base_mip);
+    void _apply_finished();
+    void _schedule();
+    int _get_min_mip(const StexMipLayout &p_layout) const;
+
+public:
+    //! Registers p_texture as streamed from the .stex file at p_path and uploads its tail right away. When
+    //! streaming is disabled the whole chain is uploaded and the texture isn't tracked.
+    Error add(RID p_texture, StringView p_path);
+    //! Stops streaming p_texture, reads still in flight for it are dropped.
+    void remove(RID p_texture);
+    //! Uploads every level of p_texture right away and stops streaming it, for uses that read the texture once
+    //! instead of drawing it every frame, like sky panoramas baked into radiance maps.
+    void load_full(RID p_texture);
+    bool has(RID p_texture) const { return textures.contains(p_texture); }
+
+    //! Asks for the mip level of p_texture fitting p_screen_size pixels for this frame, a negative size asks for
+    //! full detail. Cheap for textures that aren't streamed.
+    void request(RID p_texture, float p_screen_size);
+    //! Most detailed level p_texture keeps resident, -1 if it isn't streamed.
+    int get_resident_mip(RID p_texture) const;
+    //! Level the policy picks for a texture of p_width x p_height covering p_screen_size pixels.
+    int get_mip_for_screen_size(int p_width, int p_height, int p_mip_count, float p_screen_size) const;
+
+    //! Applies finished reads, then picks the levels to keep and queues their reads once per p_frame.
+    void update(uint64_t p_frame);
+    //! Waits until no reads are queued or running, then applies them.
+    void flush();
+
+    void set_enabled(bool p_enabled) { enabled = p_enabled; }
+    bool is_enabled() const { return enabled; }
+    //! Bytes of streamed mips allowed to stay resident, 0 for no limit.
+    void set_budget(uint64_t p_bytes) { budget = p_bytes; }
+    uint64_t get_budget() const { return budget; }
+    //! Levels whose width and height are both at most p_size stay resident as long as the texture exists.
+    void set_min_resident_size(int p_size) { min_resident_size = M_MAX(p_size, 1); }
+    //! Frames a texture keeps its detail after it was last requested.
+    void set_keep_frames(int p_frames) { keep_frames = M_MAX(p_frames, 0); }
+    //! Reads queued or running at the same time.
+    void set_max_reads(int p_reads) { max_reads = M_MAX(p_reads, 1); }
+    //! Added to the computed level, positive values trade detail for memory.
+    void set_mip_bias(float p_bias) { mip_bias = p_bias; }
+
+    uint64_t get_resident_size() const { return resident_size; }
+    int get_texture_count() const { return textures.size(); }
+    int get_pending_count() const;
+
+    //! Stops the reading thread, reads not started yet are dropped.
+    void finish();
+
+    explicit TextureStreamer(TextureStreamingBackend *p_backend) : backend(p_backend) {}
+    ~TextureStreamer();
+};
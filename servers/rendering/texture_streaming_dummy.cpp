@@ -0,0 +1,51 @@
+/*************************************************************************/
+/*  texture_streaming_dummy.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "texture_streaming_dummy.h"
+
+void TextureStreamingBackendDummy::_texture_stream_apply(RID p_texture, int p_base_mip, const Ref<Image> &p_mips) {
+
+    ERR_FAIL_COND(!p_mips);
+
+    Upload &upload = uploads[p_texture];
+    upload.base_mip = p_base_mip;
+    upload.width = p_mips->get_width();
+    upload.height = p_mips->get_height();
+    upload.mip_count = p_mips->get_mipmap_count() + 1;
+    upload.size = p_mips->get_data().size();
+    upload_count++;
+}
+
+const TextureStreamingBackendDummy::Upload *TextureStreamingBackendDummy::get_upload(RID p_texture) const {
+
+    auto iter = uploads.find(p_texture);
+    return iter == uploads.end() ? nullptr : &iter->second;
+}
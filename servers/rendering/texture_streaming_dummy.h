@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  texture_streaming_dummy.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEXTURE_STREAMING_DUMMY_H
+#define TEXTURE_STREAMING_DUMMY_H
+
+#include "core/hash_map.h"
+#include "servers/rendering/texture_streaming.h"
+
+/**
+ * Texture streaming backend that only records what would be uploaded, so the residency policy and read
+ * scheduling run without a GPU.
+ */
+class GODOT_EXPORT TextureStreamingBackendDummy : public TextureStreamingBackend {
+public:
+    struct Upload {
+        int base_mip;
+        int width;
+        int height;
+        int mip_count;
+        uint64_t size;
+    };
+
+private:
+    HashMap<RID, Upload> uploads;
+    int upload_count = 0;
+
+public:
+    void _texture_stream_apply(RID p_texture, int p_base_mip, const Ref<Image> &p_mips) override;
+
+    //! Last upload made for p_texture, nullptr if there was none.
+    const Upload *get_upload(RID p_texture) const;
+    //! Uploads made since the backend was created, for every texture.
+    int get_upload_count() const { return upload_count; }
+    void forget(RID p_texture) { uploads.erase(p_texture); }
+};
+
+#endif // TEXTURE_STREAMING_DUMMY_H
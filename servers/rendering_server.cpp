@@ -2267,6 +2267,49 @@ RID RenderingServer::instance_create2(RID p_base, RID p_scenario) {
     return instance;
 }
 
+void RenderingServer::instances_create(Span<RID> r_instances) {
+
+    for (RID &instance : r_instances) {
+        instance = instance_create();
+    }
+}
+
+void RenderingServer::instances_set_base(Span<const RID> p_instances, RID p_base) {
+
+    for (RID instance : p_instances) {
+        instance_set_base(instance, p_base);
+    }
+}
+
+void RenderingServer::instances_set_scenario(Span<const RID> p_instances, RID p_scenario) {
+
+    for (RID instance : p_instances) {
+        instance_set_scenario(instance, p_scenario);
+    }
+}
+
+void RenderingServer::instances_set_transform(Span<const RID> p_instances, Span<const Transform> p_transforms) {
+
+    ERR_FAIL_COND(p_instances.size() != p_transforms.size());
+    for (size_t i = 0; i < p_instances.size(); i++) {
+        instance_set_transform(p_instances[i], p_transforms[i]);
+    }
+}
+
+void RenderingServer::instances_set_visible(Span<const RID> p_instances, bool p_visible) {
+
+    for (RID instance : p_instances) {
+        instance_set_visible(instance, p_visible);
+    }
+}
+
+void RenderingServer::instances_geometry_set_material_override(Span<const RID> p_instances, RID p_material) {
+
+    for (RID instance : p_instances) {
+        instance_geometry_set_material_override(instance, p_material);
+    }
+}
+
 RenderingServer::RenderingServer() {
 
     //ERR_FAIL_COND();
@@ -2278,6 +2321,14 @@ RenderingServer::RenderingServer() {
     GLOBAL_DEF_RST("rendering/vram_compression/import_etc2", true);
     GLOBAL_DEF_RST("rendering/vram_compression/import_pvrtc", false);
 
+    GLOBAL_DEF("rendering/misc/shader_cache/enabled", true);
+
+    GLOBAL_DEF("rendering/misc/texture_streaming/enabled", true);
+    GLOBAL_DEF("rendering/misc/texture_streaming/budget_mb", 512);
+    ProjectSettings::get_singleton()->set_custom_property_info("rendering/misc/texture_streaming/budget_mb", PropertyInfo(VariantType::INT, "rendering/misc/texture_streaming/budget_mb", PropertyHint::Range, "0,8192,1,or_greater"));
+    GLOBAL_DEF("rendering/misc/texture_streaming/min_resident_size", 64);
+    ProjectSettings::get_singleton()->set_custom_property_info("rendering/misc/texture_streaming/min_resident_size", PropertyInfo(VariantType::INT, "rendering/misc/texture_streaming/min_resident_size", PropertyHint::Range, "1,4096,1"));
+
     GLOBAL_DEF("rendering/limits/time/time_rollover_secs", 3600);
     ProjectSettings::get_singleton()->set_custom_property_info("rendering/limits/time/time_rollover_secs", PropertyInfo(VariantType::FLOAT, "rendering/limits/time/time_rollover_secs", PropertyHint::Range, "0,10000,1,or_greater"));
 
@@ -2301,6 +2352,9 @@ RenderingServer::RenderingServer() {
     GLOBAL_DEF("rendering/quality/shadows/filter_mode.mobile", 0);
     ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/shadows/filter_mode", PropertyInfo(VariantType::INT, "rendering/quality/shadows/filter_mode", PropertyHint::Enum, "Disabled,PCF5,PCF13"));
 
+    GLOBAL_DEF("rendering/quality/lod/threshold_pixels", 1.0f);
+    ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/lod/threshold_pixels", PropertyInfo(VariantType::FLOAT, "rendering/quality/lod/threshold_pixels", PropertyHint::Range, "0,16,0.1"));
+
     GLOBAL_DEF("rendering/quality/reflections/texture_array_reflections", true);
     GLOBAL_DEF("rendering/quality/reflections/texture_array_reflections.mobile", false);
     GLOBAL_DEF("rendering/quality/reflections/high_quality_ggx", true);
@@ -268,6 +268,9 @@ public:
 
     virtual void texture_set_path(RID p_texture, StringView p_path) = 0;
     virtual const String &texture_get_path(RID p_texture) const = 0;
+    //! Streams the mips of an allocated texture from the .stex file at p_path, keeping only the levels the
+    //! screen needs resident. An empty path stops streaming.
+    virtual void texture_set_mip_streaming(RID p_texture, StringView p_path) = 0;
 
     virtual void texture_set_shrink_all_x2_on_set_data(bool p_enable) = 0;
 
@@ -370,6 +373,13 @@ public:
     virtual const Vector<AABB> &mesh_surface_get_skeleton_aabb(RID p_mesh, int p_surface) const = 0;
     Array _mesh_surface_get_skeleton_aabb_bind(RID p_mesh, int p_surface) const;
 
+    // Simplified index arrays drawn instead of the full surface when the instance is small on screen. Levels go
+    // from finest to coarsest, every error is the object space deviation from the full surface.
+    virtual void mesh_surface_set_lods(RID p_mesh, int p_surface, const Vector<float> &p_lod_errors, const Vector<PoolVector<uint8_t>> &p_lod_index_arrays) = 0;
+    virtual int mesh_surface_get_lod_count(RID p_mesh, int p_surface) const = 0;
+    virtual float mesh_surface_get_lod_error(RID p_mesh, int p_surface, int p_lod) const = 0;
+    virtual PoolVector<uint8_t> mesh_surface_get_lod_index_array(RID p_mesh, int p_surface, int p_lod) const = 0;
+
     virtual void mesh_remove_surface(RID p_mesh, int p_index) = 0;
     virtual int mesh_get_surface_count(RID p_mesh) const = 0;
 
@@ -698,6 +708,17 @@ public:
     virtual void instance_geometry_set_draw_range(RID p_instance, float p_min, float p_max, float p_min_margin, float p_max_margin) = 0;
     virtual void instance_geometry_set_as_instance_lod(RID p_instance, RID p_as_lod_of_instance) = 0;
 
+    /* BULK INSTANCING API */
+    // Each call applies to a whole set of instances, in multi-threaded mode it is queued as a single command.
+
+    virtual void instances_create(Span<RID> r_instances);
+    virtual void instances_set_base(Span<const RID> p_instances, RID p_base);
+    virtual void instances_set_scenario(Span<const RID> p_instances, RID p_scenario);
+    //! p_transforms holds one transform per instance.
+    virtual void instances_set_transform(Span<const RID> p_instances, Span<const Transform> p_transforms);
+    virtual void instances_set_visible(Span<const RID> p_instances, bool p_visible);
+    virtual void instances_geometry_set_material_override(Span<const RID> p_instances, RID p_material);
+
     /* CANVAS (2D) */
 
     virtual RID canvas_create() = 0;
@@ -39,13 +39,44 @@
         }                                                                       \
     }
 
+// RIDs are handed out from a pool that is refilled on the server thread in the background once it runs half
+// empty, so creating resources only has to wait for the server when a burst drains the whole pool.
 #define FUNCRID(m_type)                                                                    \
     Vector<RID> m_type##_id_pool;                                                          \
-    int m_type##allocn() {                                                                 \
-        for (int i = 0; i < pool_max_size; i++) {                                          \
-            m_type##_id_pool.emplace_back(server_name->m_type##_create());                 \
+    bool m_type##_refill_pending = false;                                                  \
+    void m_type##_alloc_ids(int p_count) {                                                 \
+        Vector<RID> ids;                                                                   \
+        ids.reserve(p_count);                                                              \
+        for (int i = 0; i < p_count; i++) {                                                \
+            ids.emplace_back(server_name->m_type##_create());                              \
+        }                                                                                  \
+        MutexLock lock(*alloc_mutex);                                                      \
+        m_type##_id_pool.insert(m_type##_id_pool.end(), ids.begin(), ids.end());           \
+        m_type##_refill_pending = false;                                                   \
+    }                                                                                      \
+    void m_type##_take_ids(Span<RID> r_ids) {                                              \
+        size_t taken = 0;                                                                  \
+        alloc_mutex->lock();                                                               \
+        while (taken < r_ids.size()) {                                                     \
+            if (m_type##_id_pool.empty()) {                                                \
+                int missing = int(r_ids.size() - taken);                                   \
+                alloc_mutex->unlock();                                                     \
+                command_queue.push_and_sync([this, missing]() {                            \
+                    m_type##_alloc_ids(M_MAX(missing, pool_max_size));                     \
+                });                                                                        \
+                SYNC_DEBUG                                                                 \
+                alloc_mutex->lock();                                                       \
+                continue;                                                                  \
+            }                                                                              \
+            r_ids[taken++] = m_type##_id_pool.back();                                      \
+            m_type##_id_pool.pop_back();                                                   \
+        }                                                                                  \
+        bool refill = !m_type##_refill_pending && int(m_type##_id_pool.size()) < pool_max_size / 2; \
+        m_type##_refill_pending |= refill;                                                 \
+        alloc_mutex->unlock();                                                             \
+        if (refill) {                                                                      \
+            command_queue.push([this]() { m_type##_alloc_ids(pool_max_size); });           \
         }                                                                                  \
-        return 0;                                                                          \
     }                                                                                      \
     void m_type##_free_cached_ids() {                                                      \
         for(auto v : m_type##_id_pool) {                                                   \
@@ -56,15 +87,7 @@
     RID m_type##_create() override {                                                       \
         if (Thread::get_caller_id() != server_thread) {                                    \
             RID rid;                                                                       \
-            alloc_mutex->lock();                                                           \
-            if (m_type##_id_pool.empty()) {                                                \
-                int ret;                                                                   \
-                command_queue.push_and_sync([this,&ret]() {ret=this->m_type##allocn();}); \
-                SYNC_DEBUG                                                                 \
-            }                                                                              \
-            rid = m_type##_id_pool.back();                                                 \
-            m_type##_id_pool.pop_back();                                                   \
-            alloc_mutex->unlock();                                                         \
+            m_type##_take_ids(Span<RID>(&rid, 1));                                         \
             return rid;                                                                    \
         } else {                                                                           \
             return server_name->m_type##_create();                                         \
@@ -182,7 +182,7 @@ class basic_view<Entity, Allocator, exclude_t<Exclude...>, Component...> {
         if constexpr(eastl::disjunction_v<eastl::is_same<Comp, Type>...>) {
             auto it = eastl::get<pool_type<Comp> *>(pools)->begin();
 
-            for(const auto entt: static_cast<const sparse_set<entity_type> &>(*eastl::get<pool_type<Comp> *>(pools))) {
+            for(const auto entt: static_cast<const sparse_set<entity_type,Allocator> &>(*eastl::get<pool_type<Comp> *>(pools))) {
                 auto curr = it++;
 
                 if(((eastl::is_same_v<Comp, Component> || eastl::get<pool_type<Component> *>(pools)->contains(entt)) && ...) && (!eastl::get<pool_type<Exclude> *>(pools)->contains(entt) && ...)) {
@@ -562,7 +562,7 @@ public:
     /*! @brief Unsigned integer type. */
     using size_type = std::size_t;
     /*! @brief Input iterator type. */
-    using iterator = typename sparse_set<Entity>::iterator;
+    using iterator = typename sparse_set<Entity,Allocator>::iterator;
 
     /**
      * @brief Returns the number of entities that have the given component.
@@ -627,7 +627,7 @@ public:
      * @return An iterator to the first entity that has the given component.
      */
     iterator begin() const ENTT_NOEXCEPT {
-        return pool->sparse_set<Entity>::begin();
+        return pool->sparse_set<Entity,Allocator>::begin();
     }
 
     /**
@@ -646,7 +646,7 @@ public:
      * given component.
      */
     iterator end() const ENTT_NOEXCEPT {
-        return pool->sparse_set<Entity>::end();
+        return pool->sparse_set<Entity,Allocator>::end();
     }
 
     /**